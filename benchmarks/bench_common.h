@@ -0,0 +1,395 @@
+#pragma once
+
+// Shared pieces of the per-subsystem benchmark targets: random operands, a
+// cache flush for cold runs, the machine roofline and the counters that
+// compare a result against it.
+
+#include <benchmark/benchmark.h>
+#include "matrixops/matrix.h"
+#include "matrixops/numa.h"
+#include "matrixops/parallel.h"
+#include "matrixops/simd.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(__linux__)
+#include <unistd.h>
+#endif
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#include <immintrin.h>
+#define MATRIXOPS_BENCH_X86 1
+#endif
+
+namespace bench {
+
+using namespace matrixops;
+
+// Elements uniform in [-1, 1), the same for a given seed on every run.
+template <typename T>
+BasicMatrix<T> random_matrix(size_t rows, size_t cols, uint64_t seed) {
+    std::mt19937_64 engine(seed);
+    std::uniform_real_distribution<double> uniform(-1.0, 1.0);
+    BasicMatrix<T> m(rows, cols, UNINITIALIZED);
+    for (size_t i = 0; i < rows; ++i) {
+        for (size_t j = 0; j < cols; ++j) {
+            m(i, j) = static_cast<T>(uniform(engine));
+        }
+    }
+    return m;
+}
+
+// Size of the last-level cache, or 32 MiB where the OS does not say.
+inline size_t last_level_cache_bytes() {
+#if defined(__linux__) && defined(_SC_LEVEL3_CACHE_SIZE)
+    const long l3 = sysconf(_SC_LEVEL3_CACHE_SIZE);
+    if (l3 > 0) {
+        return static_cast<size_t>(l3);
+    }
+#endif
+    return size_t{32} << 20;
+}
+
+// Evicts the operands of a cold-cache run by writing twice the last-level
+// cache, on every pool thread so that private caches are flushed as well.
+class CacheFlusher {
+public:
+    CacheFlusher()
+        : size_(2 * last_level_cache_bytes()), buffer_(new char[size_]) {}
+
+    void flush() {
+        const size_t chunk = size_t{1} << 20;
+        const char value = static_cast<char>(++pass_ & 0x7f);
+        parallel_for(0, size_, chunk, [&](size_t lo, size_t hi) {
+            std::fill(buffer_.get() + lo, buffer_.get() + hi, value);
+        });
+        benchmark::ClobberMemory();
+    }
+
+private:
+    size_t size_;
+    std::unique_ptr<char[]> buffer_;
+    unsigned pass_ = 0;
+};
+
+// In a cold run, flushes the caches outside of the timed region.
+inline void prepare_iteration(benchmark::State& state, bool cold) {
+    if (!cold) {
+        return;
+    }
+    static CacheFlusher flusher;
+    state.PauseTiming();
+    flusher.flush();
+    state.ResumeTiming();
+}
+
+struct Roofline {
+    double flops_per_second = 0.0;
+    double bytes_per_second = 0.0;
+};
+
+namespace detail {
+
+// Independent multiply-adds on twelve accumulators, enough to hide the
+// FMA latency of current cores. Each returns the flops executed and
+// leaves a checksum in sink.
+constexpr size_t PEAK_ACCUMULATORS = 12;
+
+inline double peak_portable(size_t iterations, double& sink) {
+    double acc[PEAK_ACCUMULATORS];
+    for (size_t j = 0; j < PEAK_ACCUMULATORS; ++j) {
+        acc[j] = 1.0 + static_cast<double>(j);
+    }
+    for (size_t it = 0; it < iterations; ++it) {
+        for (double& a : acc) {
+            a = a * 0.999999 + 1e-7;
+        }
+    }
+    for (double a : acc) {
+        sink += a;
+    }
+    return 2.0 * PEAK_ACCUMULATORS * static_cast<double>(iterations);
+}
+
+#ifdef MATRIXOPS_BENCH_X86
+inline double peak_sse2(size_t iterations, double& sink) {
+    __m128d acc[PEAK_ACCUMULATORS];
+    for (size_t j = 0; j < PEAK_ACCUMULATORS; ++j) {
+        acc[j] = _mm_set1_pd(1.0 + static_cast<double>(j));
+    }
+    const __m128d a = _mm_set1_pd(0.999999);
+    const __m128d b = _mm_set1_pd(1e-7);
+    for (size_t it = 0; it < iterations; ++it) {
+        for (__m128d& v : acc) {
+            v = _mm_add_pd(_mm_mul_pd(v, a), b);
+        }
+    }
+    for (const __m128d& v : acc) {
+        sink += _mm_cvtsd_f64(v);
+    }
+    return 4.0 * PEAK_ACCUMULATORS * static_cast<double>(iterations);
+}
+
+__attribute__((target("avx2,fma"))) inline double
+peak_avx2(size_t iterations, double& sink) {
+    __m256d acc[PEAK_ACCUMULATORS];
+    for (size_t j = 0; j < PEAK_ACCUMULATORS; ++j) {
+        acc[j] = _mm256_set1_pd(1.0 + static_cast<double>(j));
+    }
+    const __m256d a = _mm256_set1_pd(0.999999);
+    const __m256d b = _mm256_set1_pd(1e-7);
+    for (size_t it = 0; it < iterations; ++it) {
+        for (__m256d& v : acc) {
+            v = _mm256_fmadd_pd(v, a, b);
+        }
+    }
+    for (const __m256d& v : acc) {
+        sink += _mm256_cvtsd_f64(v);
+    }
+    return 8.0 * PEAK_ACCUMULATORS * static_cast<double>(iterations);
+}
+
+__attribute__((target("avx512f"))) inline double
+peak_avx512(size_t iterations, double& sink) {
+    __m512d acc[PEAK_ACCUMULATORS];
+    for (size_t j = 0; j < PEAK_ACCUMULATORS; ++j) {
+        acc[j] = _mm512_set1_pd(1.0 + static_cast<double>(j));
+    }
+    const __m512d a = _mm512_set1_pd(0.999999);
+    const __m512d b = _mm512_set1_pd(1e-7);
+    for (size_t it = 0; it < iterations; ++it) {
+        for (__m512d& v : acc) {
+            v = _mm512_fmadd_pd(v, a, b);
+        }
+    }
+    for (const __m512d& v : acc) {
+        sink += _mm512_reduce_add_pd(v);
+    }
+    return 16.0 * PEAK_ACCUMULATORS * static_cast<double>(iterations);
+}
+#endif
+
+// Peak double-precision multiply-adds of one core with the instruction set
+// the library kernels use; NEON and scalar builds run the portable loop.
+inline double peak_burst(size_t iterations, double& sink) {
+#ifdef MATRIXOPS_BENCH_X86
+    switch (simd_isa()) {
+    case SimdIsa::AVX512:
+        return peak_avx512(iterations, sink);
+    case SimdIsa::AVX2:
+        return peak_avx2(iterations, sink);
+    case SimdIsa::SSE2:
+        return peak_sse2(iterations, sink);
+    default:
+        break;
+    }
+#endif
+    return peak_portable(iterations, sink);
+}
+
+template <typename F>
+double best_seconds(int trials, F&& run) {
+    double best = 0.0;
+    for (int t = 0; t < trials; ++t) {
+        const auto start = std::chrono::steady_clock::now();
+        run();
+        const double seconds =
+            std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                          start)
+                .count();
+        if (t == 0 || seconds < best) {
+            best = seconds;
+        }
+    }
+    return best;
+}
+
+inline Roofline measure_roofline() {
+    const size_t threads = num_threads();
+    Roofline roof;
+
+    // Compute roof: one burst per pool thread, run concurrently.
+    const size_t iterations = size_t{1} << 22;
+    double flops = 0.0;
+    double sink = 0.0;
+    const double compute = best_seconds(3, [&] {
+        std::vector<double> done(threads);
+        std::vector<double> sinks(threads);
+        parallel_for(0, threads, 1, [&](size_t lo, size_t hi) {
+            for (size_t t = lo; t < hi; ++t) {
+                done[t] = peak_burst(iterations, sinks[t]);
+            }
+        });
+        flops = 0.0;
+        for (size_t t = 0; t < threads; ++t) {
+            flops += done[t];
+            sink += sinks[t];
+        }
+    });
+    benchmark::DoNotOptimize(sink);
+    roof.flops_per_second = flops / compute;
+
+    // Memory roof: the STREAM triad, with each array the size of the
+    // last-level cache and 24 bytes counted per element.
+    const size_t n =
+        std::max(last_level_cache_bytes(), size_t{16} << 20) / sizeof(double);
+    std::unique_ptr<double[]> a(new double[n]);
+    std::unique_ptr<double[]> b(new double[n]);
+    std::unique_ptr<double[]> c(new double[n]);
+    const size_t grain = size_t{1} << 16;
+    // First touch from the threads that run the triad.
+    parallel_for(0, n, grain, [&](size_t lo, size_t hi) {
+        std::fill(a.get() + lo, a.get() + hi, 0.0);
+        std::fill(b.get() + lo, b.get() + hi, 1.0);
+        std::fill(c.get() + lo, c.get() + hi, 2.0);
+    });
+    const double stream = best_seconds(5, [&] {
+        parallel_for(0, n, grain, [&](size_t lo, size_t hi) {
+            for (size_t i = lo; i < hi; ++i) {
+                a[i] = b[i] + 3.0 * c[i];
+            }
+        });
+        benchmark::ClobberMemory();
+    });
+    roof.bytes_per_second = 3.0 * sizeof(double) * n / stream;
+    return roof;
+}
+
+} // namespace detail
+
+// The roofline at the current thread count, measured on first use.
+inline const Roofline& roofline() {
+    static std::map<size_t, Roofline> measured;
+    const size_t threads = num_threads();
+    auto it = measured.find(threads);
+    if (it == measured.end()) {
+        it = measured.emplace(threads, detail::measure_roofline()).first;
+    }
+    return it->second;
+}
+
+// Reports the work of one iteration as FLOPS and bytes_per_second, and as
+// fractions of the roofline: peak_fraction of the compute roof,
+// bandwidth_fraction of the memory roof, and roofline_fraction of the
+// bound the two set together for this arithmetic intensity.
+inline void report_roofline(benchmark::State& state, double flops,
+                            double bytes) {
+    const Roofline& roof = roofline();
+    const auto rate = benchmark::Counter::kIsIterationInvariantRate;
+    state.counters["FLOPS"] = benchmark::Counter(flops, rate);
+    state.counters["bytes_per_second"] = benchmark::Counter(
+        bytes, rate, benchmark::Counter::OneK::kIs1024);
+    state.counters["peak_fraction"] =
+        benchmark::Counter(flops / roof.flops_per_second, rate);
+    state.counters["bandwidth_fraction"] =
+        benchmark::Counter(bytes / roof.bytes_per_second, rate);
+    const double bound = std::max(flops / roof.flops_per_second,
+                                  bytes / roof.bytes_per_second);
+    state.counters["roofline_fraction"] = benchmark::Counter(bound, rate);
+}
+
+// Thread counts for scaling sweeps: powers of two up to the hardware
+// concurrency, and the hardware concurrency itself.
+inline void thread_sweep(benchmark::internal::Benchmark* b,
+                         const std::vector<int64_t>& sizes) {
+    const int64_t hardware =
+        std::max<int64_t>(1, std::thread::hardware_concurrency());
+    for (int64_t n : sizes) {
+        for (int64_t t = 1; t < hardware; t *= 2) {
+            b->Args({n, t});
+        }
+        b->Args({n, hardware});
+    }
+}
+
+// Sets the pool size for the scope of a benchmark; 0 keeps the default.
+class ScopedThreads {
+public:
+    explicit ScopedThreads(size_t n) {
+        if (n != 0) {
+            set_num_threads(n);
+        }
+    }
+    ~ScopedThreads() { set_num_threads(0); }
+
+    ScopedThreads(const ScopedThreads&) = delete;
+    ScopedThreads& operator=(const ScopedThreads&) = delete;
+};
+
+// Sets the NUMA placement for the scope of a benchmark: range(1) is the
+// policy, 0 for first-touch, 1 for interleave and 2 for binding to node
+// 0, and range(2) pins the pool threads if non-zero. Operands must be
+// created inside the scope, and in parallel so that first-touch spreads
+// them: filled with a constant rather than by random_matrix().
+class ScopedNuma {
+public:
+    explicit ScopedNuma(const benchmark::State& state)
+        : saved_(numa_settings()) {
+        const NumaPolicy policies[] = {NumaPolicy::FIRST_TOUCH,
+                                       NumaPolicy::INTERLEAVE,
+                                       NumaPolicy::BIND};
+        NumaSettings settings;
+        settings.policy = policies[state.range(1)];
+        settings.pin_threads = state.range(2) != 0;
+        set_numa_settings(settings);
+    }
+    ~ScopedNuma() { set_numa_settings(saved_); }
+
+    ScopedNuma(const ScopedNuma&) = delete;
+    ScopedNuma& operator=(const ScopedNuma&) = delete;
+
+private:
+    NumaSettings saved_;
+};
+
+// Registers a ScopedNuma benchmark over every policy, pinned and not, on
+// n x n operands. Only done on multi-node hosts, where placement matters.
+inline bool register_numa(const char* name,
+                          void (*function)(benchmark::State&), int64_t n) {
+    if (numa_nodes() > 1) {
+        benchmark::RegisterBenchmark(name, function)
+            ->ArgsProduct({{n}, {0, 1, 2}, {0, 1}})
+            ->ArgNames({"n", "policy", "pinned"})
+            ->UseRealTime();
+    }
+    return true;
+}
+
+} // namespace bench
+
+// main() for the per-subsystem targets: records the instruction set, the
+// NUMA placement and the roofline at the default thread count in the
+// report context.
+#define MATRIXOPS_BENCHMARK_MAIN()                                             \
+    int main(int argc, char** argv) {                                          \
+        benchmark::Initialize(&argc, argv);                                    \
+        if (benchmark::ReportUnrecognizedArguments(argc, argv)) {              \
+            return 1;                                                          \
+        }                                                                      \
+        const bench::Roofline& roof = bench::roofline();                       \
+        benchmark::AddCustomContext(                                           \
+            "simd_isa", matrixops::simd_isa_name(matrixops::simd_isa()));      \
+        benchmark::AddCustomContext(                                           \
+            "roofline_gflops", std::to_string(roof.flops_per_second / 1e9));   \
+        benchmark::AddCustomContext(                                           \
+            "roofline_gbytes_per_second",                                      \
+            std::to_string(roof.bytes_per_second / 1e9));                      \
+        const matrixops::NumaSettings numa = matrixops::numa_settings();       \
+        benchmark::AddCustomContext("numa_nodes",                              \
+                                    std::to_string(matrixops::numa_nodes()));  \
+        benchmark::AddCustomContext(                                           \
+            "numa_policy", matrixops::numa_policy_name(numa.policy));          \
+        benchmark::AddCustomContext("numa_pinned",                             \
+                                    numa.pin_threads ? "yes" : "no");          \
+        benchmark::RunSpecifiedBenchmarks();                                   \
+        benchmark::Shutdown();                                                 \
+        return 0;                                                              \
+    }                                                                          \
+    int main(int, char**)
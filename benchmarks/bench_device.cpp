@@ -0,0 +1,75 @@
+#include <benchmark/benchmark.h>
+#include "matrixops/device.h"
+
+// Built into matrixops_benchmarks when a device backend is enabled. Each
+// iteration waits for the device, so the times cover the queued work.
+
+using namespace matrixops;
+
+// Compare with BM_MatrixMultiplication
+static void BM_DeviceMultiplication(benchmark::State& state) {
+    const size_t n = state.range(0);
+    const DeviceMatrix a(Matrix(n, n, 1.0));
+    const DeviceMatrix b(Matrix(n, n, 2.0));
+
+    for (auto _ : state) {
+        DeviceMatrix c = a * b;
+        device_synchronize();
+        benchmark::DoNotOptimize(c.data());
+    }
+
+    state.counters["FLOPS"] = benchmark::Counter(
+        2.0 * n * n * n, benchmark::Counter::kIsIterationInvariantRate);
+}
+
+BENCHMARK(BM_DeviceMultiplication)
+    ->RangeMultiplier(2)
+    ->Range(256, 8192)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+// Host to device and back, which bounds what offloading a single
+// operation can gain
+static void BM_DeviceRoundTrip(benchmark::State& state) {
+    const size_t n = state.range(0);
+    const Matrix m(n, n, 1.5);
+
+    for (auto _ : state) {
+        const DeviceMatrix d(m);
+        Matrix back = d.to_matrix();
+        benchmark::DoNotOptimize(back);
+    }
+
+    state.SetBytesProcessed(state.iterations() * 2 * n * n * sizeof(double));
+}
+
+BENCHMARK(BM_DeviceRoundTrip)
+    ->RangeMultiplier(4)
+    ->Range(256, 4096)
+    ->UseRealTime();
+
+// ((a * b + c) * 0.5)^T with operands and intermediates resident on the
+// device, so only the norm reaches the host
+static void BM_DeviceChain(benchmark::State& state) {
+    const size_t n = state.range(0);
+    const DeviceMatrix a(Matrix(n, n, 1.0));
+    const DeviceMatrix b(Matrix(n, n, 2.0));
+    const DeviceMatrix c(Matrix(n, n, 3.0));
+
+    for (auto _ : state) {
+        DeviceMatrix r = a * b;
+        r += c;
+        r *= 0.5;
+        double norm = r.transpose().norm();
+        benchmark::DoNotOptimize(norm);
+    }
+
+    state.counters["FLOPS"] = benchmark::Counter(
+        2.0 * n * n * n, benchmark::Counter::kIsIterationInvariantRate);
+}
+
+BENCHMARK(BM_DeviceChain)
+    ->RangeMultiplier(4)
+    ->Range(256, 4096)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
@@ -0,0 +1,99 @@
+#include <benchmark/benchmark.h>
+#include "matrixops/distributed.h"
+
+#include <memory>
+#include <vector>
+
+// Run under mpiexec. Every process runs every benchmark, with fixed
+// iteration counts so the collectives match; rank 0 reports.
+
+using namespace matrixops;
+
+namespace {
+
+std::shared_ptr<const ProcessGrid> world_grid() {
+    static const auto grid =
+        std::make_shared<const ProcessGrid>(MPI_COMM_WORLD);
+    return grid;
+}
+
+class NullReporter : public benchmark::BenchmarkReporter {
+public:
+    bool ReportContext(const Context&) override { return true; }
+    void ReportRuns(const std::vector<Run>&) override {}
+};
+
+} // namespace
+
+// SUMMA product of n x n matrices; compare with BM_MatrixMultiplication
+// on one process
+static void BM_DistributedMultiplication(benchmark::State& state) {
+    const size_t n = state.range(0);
+    const DistributedMatrix a(world_grid(), n, n);
+    const DistributedMatrix b(world_grid(), n, n);
+
+    for (auto _ : state) {
+        DistributedMatrix c = a * b;
+        benchmark::DoNotOptimize(c.local().data());
+    }
+
+    state.counters["FLOPS"] = benchmark::Counter(
+        2.0 * n * n * n, benchmark::Counter::kIsIterationInvariantRate);
+}
+
+BENCHMARK(BM_DistributedMultiplication)
+    ->RangeMultiplier(2)
+    ->Range(512, 4096)
+    ->Iterations(5)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+static void BM_DistributedTranspose(benchmark::State& state) {
+    const size_t n = state.range(0);
+    const DistributedMatrix m(world_grid(), n, n);
+
+    for (auto _ : state) {
+        DistributedMatrix t = m.transpose();
+        benchmark::DoNotOptimize(t.local().data());
+    }
+
+    state.SetBytesProcessed(state.iterations() * 2 * n * n * sizeof(double));
+}
+
+BENCHMARK(BM_DistributedTranspose)
+    ->RangeMultiplier(4)
+    ->Range(512, 8192)
+    ->Iterations(10)
+    ->UseRealTime();
+
+static void BM_DistributedNorm(benchmark::State& state) {
+    const size_t n = state.range(0);
+    const DistributedMatrix m(world_grid(), n, n);
+
+    for (auto _ : state) {
+        double norm = m.norm();
+        benchmark::DoNotOptimize(norm);
+    }
+}
+
+BENCHMARK(BM_DistributedNorm)
+    ->RangeMultiplier(4)
+    ->Range(512, 8192)
+    ->Iterations(20)
+    ->UseRealTime();
+
+int main(int argc, char** argv) {
+    MPI_Init(&argc, &argv);
+    benchmark::Initialize(&argc, argv);
+    int rank = 0;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    if (rank == 0) {
+        benchmark::RunSpecifiedBenchmarks();
+    } else {
+        NullReporter quiet;
+        benchmark::RunSpecifiedBenchmarks(&quiet);
+    }
+    benchmark::Shutdown();
+    MPI_Finalize();
+    return 0;
+}
@@ -0,0 +1,224 @@
+#include "bench_common.h"
+#include "matrixops/reduction.h"
+#include "matrixops/vector.h"
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+// Memory-bound operations on random n x n operands, reported against the
+// machine roofline: bandwidth_fraction is the figure to watch. range(1) ==
+// 1 flushes the caches before every iteration.
+
+using namespace matrixops;
+
+namespace {
+
+const std::vector<int64_t> SIZES = {256, 1024, 4096, 8192};
+
+// Sets the reduction mode for the scope of a benchmark, from range(1)
+class ScopedReductionMode {
+public:
+    explicit ScopedReductionMode(const benchmark::State& state)
+        : saved_(reduction_mode()) {
+        const ReductionMode modes[] = {
+            ReductionMode::FAST, ReductionMode::REPRODUCIBLE,
+            ReductionMode::COMPENSATED, ReductionMode::EXACT};
+        set_reduction_mode(modes[state.range(1)]);
+    }
+    ~ScopedReductionMode() { set_reduction_mode(saved_); }
+
+    ScopedReductionMode(const ScopedReductionMode&) = delete;
+    ScopedReductionMode& operator=(const ScopedReductionMode&) = delete;
+
+private:
+    ReductionMode saved_;
+};
+
+} // namespace
+
+static void BM_Add(benchmark::State& state) {
+    const size_t n = state.range(0);
+    const bool cold = state.range(1) != 0;
+    const Matrix a = bench::random_matrix<double>(n, n, 1);
+    const Matrix b = bench::random_matrix<double>(n, n, 2);
+    Matrix c(n, n, UNINITIALIZED);
+
+    for (auto _ : state) {
+        bench::prepare_iteration(state, cold);
+        add_into(a, b, c);
+        benchmark::DoNotOptimize(c.data());
+    }
+
+    bench::report_roofline(state, 1.0 * n * n, 3.0 * n * n * sizeof(double));
+}
+
+BENCHMARK(BM_Add)->ArgsProduct({SIZES, {0, 1}})->UseRealTime();
+
+static void BM_Scale(benchmark::State& state) {
+    const size_t n = state.range(0);
+    const bool cold = state.range(1) != 0;
+    Matrix a = bench::random_matrix<double>(n, n, 1);
+
+    for (auto _ : state) {
+        bench::prepare_iteration(state, cold);
+        a *= 1.0000001;
+        benchmark::DoNotOptimize(a.data());
+    }
+
+    bench::report_roofline(state, 1.0 * n * n, 2.0 * n * n * sizeof(double));
+}
+
+BENCHMARK(BM_Scale)->ArgsProduct({SIZES, {0, 1}})->UseRealTime();
+
+static void BM_Transpose(benchmark::State& state) {
+    const size_t n = state.range(0);
+    const bool cold = state.range(1) != 0;
+    const Matrix a = bench::random_matrix<double>(n, n, 1);
+
+    for (auto _ : state) {
+        bench::prepare_iteration(state, cold);
+        Matrix t = a.transpose();
+        benchmark::DoNotOptimize(t.data());
+    }
+
+    bench::report_roofline(state, 0.0, 2.0 * n * n * sizeof(double));
+}
+
+BENCHMARK(BM_Transpose)->ArgsProduct({SIZES, {0, 1}})->UseRealTime();
+
+static void BM_TransposeInPlace(benchmark::State& state) {
+    const size_t n = state.range(0);
+    const bool cold = state.range(1) != 0;
+    Matrix a = bench::random_matrix<double>(n, n, 1);
+
+    for (auto _ : state) {
+        bench::prepare_iteration(state, cold);
+        a.transpose_inplace();
+        benchmark::DoNotOptimize(a.data());
+    }
+
+    bench::report_roofline(state, 0.0, 2.0 * n * n * sizeof(double));
+}
+
+BENCHMARK(BM_TransposeInPlace)->ArgsProduct({SIZES, {0, 1}})->UseRealTime();
+
+static void BM_Norm(benchmark::State& state) {
+    const size_t n = state.range(0);
+    const bool cold = state.range(1) != 0;
+    const Matrix a = bench::random_matrix<double>(n, n, 1);
+
+    for (auto _ : state) {
+        bench::prepare_iteration(state, cold);
+        double norm = a.norm();
+        benchmark::DoNotOptimize(norm);
+    }
+
+    bench::report_roofline(state, 2.0 * n * n, 1.0 * n * n * sizeof(double));
+}
+
+BENCHMARK(BM_Norm)->ArgsProduct({SIZES, {0, 1}})->UseRealTime();
+
+// Thread scaling: range(0) is the size, range(1) the pool size
+static void BM_AddThreads(benchmark::State& state) {
+    const size_t n = state.range(0);
+    const bench::ScopedThreads threads(state.range(1));
+    const Matrix a = bench::random_matrix<double>(n, n, 1);
+    const Matrix b = bench::random_matrix<double>(n, n, 2);
+    Matrix c(n, n, UNINITIALIZED);
+
+    for (auto _ : state) {
+        add_into(a, b, c);
+        benchmark::DoNotOptimize(c.data());
+    }
+
+    bench::report_roofline(state, 1.0 * n * n, 3.0 * n * n * sizeof(double));
+}
+
+BENCHMARK(BM_AddThreads)
+    ->Apply([](benchmark::internal::Benchmark* b) {
+        bench::thread_sweep(b, {1024, 4096});
+    })
+    ->UseRealTime();
+
+static void BM_NormThreads(benchmark::State& state) {
+    const size_t n = state.range(0);
+    const bench::ScopedThreads threads(state.range(1));
+    const Matrix a = bench::random_matrix<double>(n, n, 1);
+
+    for (auto _ : state) {
+        double norm = a.norm();
+        benchmark::DoNotOptimize(norm);
+    }
+
+    bench::report_roofline(state, 2.0 * n * n, 1.0 * n * n * sizeof(double));
+}
+
+BENCHMARK(BM_NormThreads)
+    ->Apply([](benchmark::internal::Benchmark* b) {
+        bench::thread_sweep(b, {1024, 4096});
+    })
+    ->UseRealTime();
+
+// Reduction modes against FAST: range(0) is the size, range(1) the mode,
+// from 0 for FAST to 3 for EXACT
+static void BM_NormMode(benchmark::State& state) {
+    const size_t n = state.range(0);
+    const ScopedReductionMode mode(state);
+    const Matrix a = bench::random_matrix<double>(n, n, 1);
+
+    for (auto _ : state) {
+        double norm = a.norm();
+        benchmark::DoNotOptimize(norm);
+    }
+
+    bench::report_roofline(state, 2.0 * n * n, 1.0 * n * n * sizeof(double));
+}
+
+BENCHMARK(BM_NormMode)
+    ->ArgsProduct({{256, 1024, 8192}, {0, 1, 2, 3}})
+    ->ArgNames({"n", "mode"})
+    ->UseRealTime();
+
+// Dot product of two vectors of n * n elements
+static void BM_DotMode(benchmark::State& state) {
+    const size_t n = state.range(0) * state.range(0);
+    const ScopedReductionMode mode(state);
+    Vector x(n, UNINITIALIZED);
+    Vector y(n, UNINITIALIZED);
+    const Matrix values = bench::random_matrix<double>(2, n, 1);
+    std::copy_n(values.data(), n, x.data());
+    std::copy_n(values.data() + n, n, y.data());
+
+    for (auto _ : state) {
+        double d = dot(x, y);
+        benchmark::DoNotOptimize(d);
+    }
+
+    bench::report_roofline(state, 2.0 * n, 2.0 * n * sizeof(double));
+}
+
+BENCHMARK(BM_DotMode)
+    ->ArgsProduct({{256, 1024, 8192}, {0, 1, 2, 3}})
+    ->ArgNames({"n", "mode"})
+    ->UseRealTime();
+
+// NUMA placement, on multi-node hosts only: see bench::ScopedNuma
+static void BM_NumaAdd(benchmark::State& state) {
+    const size_t n = state.range(0);
+    const bench::ScopedNuma numa(state);
+    const Matrix a(n, n, 1.0);
+    const Matrix b(n, n, 2.0);
+    Matrix c(n, n);
+
+    for (auto _ : state) {
+        add_into(a, b, c);
+        benchmark::DoNotOptimize(c.data());
+    }
+
+    bench::report_roofline(state, 1.0 * n * n, 3.0 * n * n * sizeof(double));
+}
+
+[[maybe_unused]] static const bool numa_add_registered =
+    bench::register_numa("BM_NumaAdd", BM_NumaAdd, 8192);
+
+MATRIXOPS_BENCHMARK_MAIN();
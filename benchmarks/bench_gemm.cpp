@@ -0,0 +1,186 @@
+#include "bench_common.h"
+#include "matrixops/gemm.h"
+#include "matrixops/structured.h"
+#include <complex>
+#include <cstdint>
+#include <vector>
+
+// Dense products on random operands, reported against the machine
+// roofline. range(cold) == 1 flushes the caches before every iteration, so
+// the operands start in memory rather than in the last-level cache.
+
+using namespace matrixops;
+
+namespace {
+
+template <typename T>
+double multiply_add_flops() {
+    return 2.0;
+}
+
+template <>
+double multiply_add_flops<std::complex<double>>() {
+    return 8.0;
+}
+
+template <typename T>
+void run_product(benchmark::State& state, size_t m, size_t n, size_t k,
+                 bool cold) {
+    const BasicMatrix<T> a = bench::random_matrix<T>(m, k, 1);
+    const BasicMatrix<T> b = bench::random_matrix<T>(k, n, 2);
+    BasicMatrix<T> c(m, n, UNINITIALIZED);
+
+    for (auto _ : state) {
+        bench::prepare_iteration(state, cold);
+        multiply_into(a, b, c);
+        benchmark::DoNotOptimize(c.data());
+    }
+
+    bench::report_roofline(
+        state, multiply_add_flops<T>() * m * n * k,
+        static_cast<double>(m * k + k * n + m * n) * sizeof(T));
+}
+
+// Shapes as (m, n, k): tall-skinny and short-fat operands, a long inner
+// dimension, and the low-rank update of a large result.
+void shapes(benchmark::internal::Benchmark* b) {
+    const std::vector<std::vector<int64_t>> mnk = {
+        {4096, 64, 64},  {8192, 256, 256}, {64, 4096, 64},
+        {256, 8192, 256}, {256, 256, 8192}, {4096, 4096, 32},
+    };
+    for (const auto& shape : mnk) {
+        for (int64_t cold : {0, 1}) {
+            b->Args({shape[0], shape[1], shape[2], cold});
+        }
+    }
+}
+
+} // namespace
+
+// Square products: range(0) is the size, range(1) cold
+template <typename T>
+static void BM_GemmSquare(benchmark::State& state) {
+    const size_t n = state.range(0);
+    run_product<T>(state, n, n, n, state.range(1) != 0);
+}
+
+BENCHMARK_TEMPLATE(BM_GemmSquare, double)
+    ->ArgsProduct({{64, 256, 1024, 2048, 4096, 8192}, {0, 1}})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+BENCHMARK_TEMPLATE(BM_GemmSquare, float)
+    ->ArgsProduct({{256, 1024, 4096}, {0, 1}})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+BENCHMARK_TEMPLATE(BM_GemmSquare, std::complex<double>)
+    ->ArgsProduct({{256, 1024}, {0, 1}})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+// Non-square products: range(0..2) are m, n and k, range(3) cold
+static void BM_GemmShape(benchmark::State& state) {
+    run_product<double>(state, state.range(0), state.range(1),
+                        state.range(2), state.range(3) != 0);
+}
+
+BENCHMARK(BM_GemmShape)
+    ->Apply(shapes)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+// Thread scaling: range(0) is the size, range(1) the pool size. The
+// roofline is measured at each pool size.
+static void BM_GemmThreads(benchmark::State& state) {
+    const size_t n = state.range(0);
+    const bench::ScopedThreads threads(state.range(1));
+    run_product<double>(state, n, n, n, false);
+}
+
+BENCHMARK(BM_GemmThreads)
+    ->Apply([](benchmark::internal::Benchmark* b) {
+        bench::thread_sweep(b, {1024, 4096});
+    })
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+// Products with a structured n x n left operand, against the dense one:
+// range(0) is n, range(1) the structure. GRAM is gram(b) rather than a
+// product with b.
+enum Structure : int64_t { DENSE, IDENTITY, DIAGONAL, TRIANGULAR, SYMMETRIC,
+                           GRAM };
+
+static void BM_StructuredProduct(benchmark::State& state) {
+    const size_t n = state.range(0);
+    const int64_t structure = state.range(1);
+    const Matrix dense = bench::random_matrix<double>(n, n, 1);
+    const Matrix b = bench::random_matrix<double>(n, n, 2);
+    const IdentityMatrix identity_matrix(n);
+    const DiagonalMatrix diagonal(n, 0.5);
+    const TriangularMatrix triangular(dense, Triangle::LOWER);
+    const SymmetricMatrix symmetric(dense);
+
+    for (auto _ : state) {
+        switch (structure) {
+        case DENSE:
+            benchmark::DoNotOptimize((dense * b).data());
+            break;
+        case IDENTITY:
+            benchmark::DoNotOptimize((identity_matrix * b).data());
+            break;
+        case DIAGONAL:
+            benchmark::DoNotOptimize((diagonal * b).data());
+            break;
+        case TRIANGULAR:
+            benchmark::DoNotOptimize((triangular * b).data());
+            break;
+        case SYMMETRIC:
+            benchmark::DoNotOptimize((symmetric * b).data());
+            break;
+        default:
+            benchmark::DoNotOptimize(gram(b).packed());
+            break;
+        }
+    }
+
+    // Multiply-adds and elements moved by each structure
+    const double square = 1.0 * n * n;
+    const double packed = 0.5 * n * (n + 1);
+    const double multiply_adds[] = {square * n, 0.0, square, packed * n,
+                                    square * n, packed * n};
+    const double elements[] = {3 * square, 2 * square, 2 * square + n,
+                               packed + 2 * square, packed + 2 * square,
+                               packed + square};
+    bench::report_roofline(state, 2.0 * multiply_adds[structure],
+                           elements[structure] * sizeof(double));
+}
+
+BENCHMARK(BM_StructuredProduct)
+    ->ArgsProduct({{1024, 4096}, {DENSE, IDENTITY, DIAGONAL, TRIANGULAR,
+                                  SYMMETRIC, GRAM}})
+    ->ArgNames({"n", "structure"})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+// NUMA placement, on multi-node hosts only: see bench::ScopedNuma
+static void BM_NumaGemm(benchmark::State& state) {
+    const size_t n = state.range(0);
+    const bench::ScopedNuma numa(state);
+    const Matrix a(n, n, 1.0);
+    const Matrix b(n, n, 0.5);
+    Matrix c(n, n);
+
+    for (auto _ : state) {
+        multiply_into(a, b, c);
+        benchmark::DoNotOptimize(c.data());
+    }
+
+    bench::report_roofline(state, 2.0 * n * n * n,
+                           3.0 * n * n * sizeof(double));
+}
+
+[[maybe_unused]] static const bool numa_gemm_registered =
+    bench::register_numa("BM_NumaGemm", BM_NumaGemm, 4096);
+
+MATRIXOPS_BENCHMARK_MAIN();
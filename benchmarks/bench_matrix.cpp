@@ -1,8 +1,93 @@
 #include <benchmark/benchmark.h>
 #include "matrixops/matrix.h"
+#include "matrixops/async.h"
+#include "matrixops/parallel.h"
+#include "matrixops/vector.h"
+#include "matrixops/allocator.h"
+#include "matrixops/fixed_matrix.h"
+#include "matrixops/gemm.h"
+#include "matrixops/batch.h"
+#include "matrixops/decomposition.h"
+#include "matrixops/instrumentation.h"
+#include "matrixops/io.h"
+#include "matrixops/out_of_core.h"
+#include "matrixops/shared_matrix.h"
+#include "matrixops/tiled_matrix.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <complex>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <functional>
+#include <limits>
+#include <new>
+#include <string>
+#include <utility>
+#include <vector>
 
 using namespace matrixops;
 
+// Count heap allocations so the output-parameter benchmarks can report
+// allocs_per_iter; steady-state in-place operations should show 0.
+static std::atomic<size_t> allocation_count{0};
+
+void* operator new(std::size_t size) {
+    allocation_count.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size == 0 ? 1 : size)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+// Matrix storage uses the aligned forms. The block comes from malloc, with
+// the original pointer stored just below the aligned address.
+void* operator new(std::size_t size, std::align_val_t alignment) {
+    allocation_count.fetch_add(1, std::memory_order_relaxed);
+    const std::size_t align = static_cast<std::size_t>(alignment);
+    void* raw = std::malloc(size + align + sizeof(void*));
+    if (raw == nullptr) {
+        throw std::bad_alloc();
+    }
+    const std::uintptr_t base =
+        reinterpret_cast<std::uintptr_t>(raw) + sizeof(void*);
+    const std::uintptr_t aligned = (base + align - 1) & ~(align - 1);
+    reinterpret_cast<void**>(aligned)[-1] = raw;
+    return reinterpret_cast<void*>(aligned);
+}
+
+void operator delete(void* p, std::align_val_t) noexcept {
+    if (p != nullptr) {
+        std::free(static_cast<void**>(p)[-1]);
+    }
+}
+
+void operator delete(void* p, std::size_t,
+                     std::align_val_t alignment) noexcept {
+    operator delete(p, alignment);
+}
+
+// Run the body once outside the timed loop so lazily sized buffers (GEMM
+// packing space, pool queues) are in place, then report the allocations
+// per timed iteration.
+template <typename Body>
+static void run_counting_allocations(benchmark::State& state, Body body) {
+    body();
+    const size_t before = allocation_count.load();
+    for (auto _ : state) {
+        body();
+    }
+    const size_t allocations = allocation_count.load() - before;
+    state.counters["allocs_per_iter"] = benchmark::Counter(
+        static_cast<double>(allocations) /
+        static_cast<double>(state.iterations()));
+}
+
 // Benchmark matrix multiplication for different sizes
 static void BM_MatrixMultiplication(benchmark::State& state) {
     const size_t n = state.range(0);
@@ -15,13 +100,156 @@ static void BM_MatrixMultiplication(benchmark::State& state) {
     }
 
     state.SetComplexityN(n);
+    state.counters["FLOPS"] = benchmark::Counter(
+        2.0 * n * n * n, benchmark::Counter::kIsIterationInvariantRate);
 }
 
 BENCHMARK(BM_MatrixMultiplication)
     ->RangeMultiplier(2)
-    ->Range(8, 128)
+    ->Range(8, 2048)
+    ->Unit(benchmark::kMillisecond)
     ->Complexity();
 
+// Product of the top-left n x n blocks of 2n x 2n matrices, through views
+// (range(1) == 1) or through copies of the blocks (range(1) == 0)
+static void BM_BlockMultiplication(benchmark::State& state) {
+    const size_t n = state.range(0);
+    const bool views = state.range(1) != 0;
+    const Matrix a(2 * n, 2 * n, 1.0);
+    const Matrix b(2 * n, 2 * n, 2.0);
+
+    for (auto _ : state) {
+        if (views) {
+            Matrix c = a.block(0, 0, n, n) * b.block(0, 0, n, n);
+            benchmark::DoNotOptimize(c);
+        } else {
+            const Matrix a_block(a.block(0, 0, n, n));
+            const Matrix b_block(b.block(0, 0, n, n));
+            Matrix c = a_block * b_block;
+            benchmark::DoNotOptimize(c);
+        }
+    }
+
+    state.counters["FLOPS"] = benchmark::Counter(
+        2.0 * n * n * n, benchmark::Counter::kIsIterationInvariantRate);
+}
+
+BENCHMARK(BM_BlockMultiplication)
+    ->ArgsProduct({{64, 256, 1024}, {0, 1}})
+    ->Unit(benchmark::kMillisecond);
+
+// Sum of two blocks: row by row through the SIMD kernel
+static void BM_BlockAddition(benchmark::State& state) {
+    const size_t n = state.range(0);
+    const Matrix a(2 * n, 2 * n, 1.0);
+    const Matrix b(2 * n, 2 * n, 2.0);
+    Matrix c(n, n);
+
+    for (auto _ : state) {
+        c = a.block(0, 0, n, n) + b.block(n, n, n, n);
+        benchmark::DoNotOptimize(c.data());
+    }
+
+    state.SetBytesProcessed(state.iterations() * 3 * n * n * sizeof(double));
+}
+
+BENCHMARK(BM_BlockAddition)->RangeMultiplier(4)->Range(64, 4096);
+
+// Product of a column-major buffer and a Matrix: read in place by gemm()
+// (range(1) == 1) or converted to row-major first (range(1) == 0)
+static void BM_ColumnMajorMultiplication(benchmark::State& state) {
+    const size_t n = state.range(0);
+    const bool in_place = state.range(1) != 0;
+    const std::vector<double> buffer(n * n, 1.0);
+    const ConstMatrixView a(buffer.data(), n, n, Layout::COLUMN_MAJOR);
+    const Matrix b(n, n, 2.0);
+
+    for (auto _ : state) {
+        if (in_place) {
+            Matrix c = a * b;
+            benchmark::DoNotOptimize(c);
+        } else {
+            const Matrix row_major(a);
+            Matrix c = row_major * b;
+            benchmark::DoNotOptimize(c);
+        }
+    }
+
+    state.counters["FLOPS"] = benchmark::Counter(
+        2.0 * n * n * n, benchmark::Counter::kIsIterationInvariantRate);
+}
+
+BENCHMARK(BM_ColumnMajorMultiplication)
+    ->ArgsProduct({{64, 256, 1024}, {0, 1}})
+    ->Unit(benchmark::kMillisecond);
+
+// Conversion of a Matrix to a column-major buffer
+static void BM_ColumnMajorExport(benchmark::State& state) {
+    const size_t n = state.range(0);
+    const Matrix m(n, n, 1.5);
+    std::vector<double> buffer(n * n);
+    const MatrixView out(buffer.data(), n, n, Layout::COLUMN_MAJOR);
+
+    for (auto _ : state) {
+        out.copy_from(m);
+        benchmark::DoNotOptimize(buffer.data());
+    }
+
+    state.SetBytesProcessed(state.iterations() * 2 * n * n * sizeof(double));
+}
+
+BENCHMARK(BM_ColumnMajorExport)->RangeMultiplier(4)->Range(64, 4096);
+
+// Conversion of a Matrix to Morton-ordered tiles
+static void BM_TiledConversion(benchmark::State& state) {
+    const size_t n = state.range(0);
+    const Matrix m(n, n, 1.5);
+
+    for (auto _ : state) {
+        TiledMatrix t(m);
+        benchmark::DoNotOptimize(t);
+    }
+
+    state.SetBytesProcessed(state.iterations() * 2 * n * n * sizeof(double));
+}
+
+BENCHMARK(BM_TiledConversion)->RangeMultiplier(4)->Range(64, 4096);
+
+// Compare with BM_MatrixTranspose
+static void BM_TiledTranspose(benchmark::State& state) {
+    const size_t n = state.range(0);
+    const TiledMatrix m(n, n, 1.5);
+
+    for (auto _ : state) {
+        TiledMatrix t = m.transpose();
+        benchmark::DoNotOptimize(t);
+    }
+
+    state.SetBytesProcessed(state.iterations() * 2 * n * n * sizeof(double));
+}
+
+BENCHMARK(BM_TiledTranspose)->RangeMultiplier(4)->Range(64, 4096);
+
+// Compare with BM_MatrixMultiplication
+static void BM_TiledMultiplication(benchmark::State& state) {
+    const size_t n = state.range(0);
+    const TiledMatrix a(n, n, 1.0);
+    const TiledMatrix b(n, n, 2.0);
+
+    for (auto _ : state) {
+        TiledMatrix c = a * b;
+        benchmark::DoNotOptimize(c);
+    }
+
+    state.counters["FLOPS"] = benchmark::Counter(
+        2.0 * n * n * n, benchmark::Counter::kIsIterationInvariantRate);
+}
+
+BENCHMARK(BM_TiledMultiplication)
+    ->RangeMultiplier(4)
+    ->Range(64, 1024)
+    ->Unit(benchmark::kMillisecond);
+
 // Benchmark matrix transpose
 static void BM_MatrixTranspose(benchmark::State& state) {
     const size_t n = state.range(0);
@@ -33,11 +261,30 @@ static void BM_MatrixTranspose(benchmark::State& state) {
     }
 
     state.SetComplexityN(n);
+    state.SetBytesProcessed(state.iterations() * 2 * n * n * sizeof(double));
 }
 
 BENCHMARK(BM_MatrixTranspose)
     ->RangeMultiplier(2)
-    ->Range(8, 512)
+    ->Range(8, 4096)
+    ->Complexity();
+
+static void BM_MatrixTransposeInPlace(benchmark::State& state) {
+    const size_t n = state.range(0);
+    Matrix m(n, n, 1.5);
+
+    for (auto _ : state) {
+        m.transpose_inplace();
+        benchmark::DoNotOptimize(m);
+    }
+
+    state.SetComplexityN(n);
+    state.SetBytesProcessed(state.iterations() * 2 * n * n * sizeof(double));
+}
+
+BENCHMARK(BM_MatrixTransposeInPlace)
+    ->RangeMultiplier(2)
+    ->Range(8, 4096)
     ->Complexity();
 
 // Benchmark matrix addition
@@ -77,4 +324,1065 @@ BENCHMARK(BM_MatrixNorm)
     ->Range(8, 1024)
     ->Complexity();
 
+// Fused vs. eager evaluation of element-wise expressions
+static void BM_ExpressionFused3(benchmark::State& state) {
+    const size_t n = state.range(0);
+    Matrix a(n, n, 1.0);
+    Matrix b(n, n, 2.0);
+    Matrix c(n, n, 3.0);
+
+    for (auto _ : state) {
+        Matrix r = a + b * 2.0 + c;
+        benchmark::DoNotOptimize(r);
+    }
+
+    state.SetBytesProcessed(state.iterations() * 4 * n * n * sizeof(double));
+}
+
+BENCHMARK(BM_ExpressionFused3)->RangeMultiplier(4)->Range(64, 2048);
+
+static void BM_ExpressionEager3(benchmark::State& state) {
+    const size_t n = state.range(0);
+    Matrix a(n, n, 1.0);
+    Matrix b(n, n, 2.0);
+    Matrix c(n, n, 3.0);
+
+    for (auto _ : state) {
+        Matrix t1 = b * 2.0;
+        Matrix t2 = a + t1;
+        Matrix r = t2 + c;
+        benchmark::DoNotOptimize(r);
+    }
+
+    state.SetBytesProcessed(state.iterations() * 4 * n * n * sizeof(double));
+}
+
+BENCHMARK(BM_ExpressionEager3)->RangeMultiplier(4)->Range(64, 2048);
+
+static void BM_ExpressionFused5(benchmark::State& state) {
+    const size_t n = state.range(0);
+    Matrix a(n, n, 1.0);
+    Matrix b(n, n, 2.0);
+    Matrix c(n, n, 3.0);
+    Matrix d(n, n, 4.0);
+    Matrix e(n, n, 5.0);
+
+    for (auto _ : state) {
+        Matrix r = a + b * 2.0 + c + d * 0.5 + e;
+        benchmark::DoNotOptimize(r);
+    }
+
+    state.SetBytesProcessed(state.iterations() * 6 * n * n * sizeof(double));
+}
+
+BENCHMARK(BM_ExpressionFused5)->RangeMultiplier(4)->Range(64, 2048);
+
+static void BM_ExpressionEager5(benchmark::State& state) {
+    const size_t n = state.range(0);
+    Matrix a(n, n, 1.0);
+    Matrix b(n, n, 2.0);
+    Matrix c(n, n, 3.0);
+    Matrix d(n, n, 4.0);
+    Matrix e(n, n, 5.0);
+
+    for (auto _ : state) {
+        Matrix t1 = b * 2.0;
+        Matrix t2 = a + t1;
+        Matrix t3 = t2 + c;
+        Matrix t4 = d * 0.5;
+        Matrix t5 = t3 + t4;
+        Matrix r = t5 + e;
+        benchmark::DoNotOptimize(r);
+    }
+
+    state.SetBytesProcessed(state.iterations() * 6 * n * n * sizeof(double));
+}
+
+BENCHMARK(BM_ExpressionEager5)->RangeMultiplier(4)->Range(64, 2048);
+
+// Backend comparison: range(1) = 0 keeps every product on the native
+// kernels, 1 sends every product to the vendor BLAS configured with
+// MATRIXOPS_BLAS_BACKEND. The small sizes show where the threshold belongs.
+template <typename T>
+static void BM_MultiplicationBackend(benchmark::State& state) {
+    const size_t n = state.range(0);
+    const bool vendor = state.range(1) != 0;
+    if (vendor && std::string(blas_backend()) == "none") {
+        state.SkipWithError("Built with MATRIXOPS_BLAS_BACKEND=none");
+        return;
+    }
+    const size_t saved = blas_threshold();
+    set_blas_threshold(vendor ? 0 : std::numeric_limits<size_t>::max());
+    BasicMatrix<T> a(n, n, T(1));
+    BasicMatrix<T> b(n, n, T(2));
+    BasicMatrix<T> c(n, n);
+
+    for (auto _ : state) {
+        multiply_into(a, b, c);
+        benchmark::DoNotOptimize(c.data());
+    }
+
+    set_blas_threshold(saved);
+    state.SetLabel(vendor ? blas_backend() : "native");
+    state.counters["FLOPS"] = benchmark::Counter(
+        2.0 * n * n * n, benchmark::Counter::kIsIterationInvariantRate);
+}
+
+BENCHMARK_TEMPLATE(BM_MultiplicationBackend, double)
+    ->ArgsProduct({{16, 32, 64, 128, 256, 512, 1024, 2048}, {0, 1}})
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK_TEMPLATE(BM_MultiplicationBackend, float)
+    ->ArgsProduct({{64, 512, 2048}, {0, 1}})
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK_TEMPLATE(BM_MultiplicationBackend, std::complex<double>)
+    ->ArgsProduct({{64, 512}, {0, 1}})
+    ->Unit(benchmark::kMicrosecond);
+
+// Strassen-Winograd: range(1) is the number of recursion levels, 0 for the
+// classic product. FLOPS counts 2n^3 either way, so the effective rates
+// compare directly.
+static void BM_Strassen(benchmark::State& state) {
+    const size_t n = state.range(0);
+    const size_t levels = state.range(1);
+    const StrassenSettings saved = strassen_settings();
+    set_strassen_settings({levels > 0, n >> levels});
+    Matrix a(n, n, 1.0);
+    Matrix b(n, n, 2.0);
+    Matrix c(n, n);
+
+    for (auto _ : state) {
+        multiply_into(a, b, c);
+        benchmark::DoNotOptimize(c.data());
+    }
+
+    set_strassen_settings(saved);
+    state.counters["FLOPS"] = benchmark::Counter(
+        2.0 * n * n * n, benchmark::Counter::kIsIterationInvariantRate);
+}
+
+BENCHMARK(BM_Strassen)
+    ->ArgsProduct({{512, 1024, 2048, 4096}, {0, 1, 2}})
+    ->Unit(benchmark::kMillisecond);
+
+// Best of three runs of a * b, in seconds.
+static double time_product(const Matrix& a, const Matrix& b, Matrix& c) {
+    double best = 0.0;
+    for (int run = 0; run < 3; ++run) {
+        const auto start = std::chrono::steady_clock::now();
+        multiply_into(a, b, c);
+        const std::chrono::duration<double> elapsed =
+            std::chrono::steady_clock::now() - start;
+        best = run == 0 ? elapsed.count() : std::min(best, elapsed.count());
+    }
+    return best;
+}
+
+// Report the crossover for this host: the smallest size, stepping by 128,
+// at which one level of Strassen-Winograd beats the classic product. That
+// size / 2 is the setting for StrassenSettings::crossover.
+static void BM_StrassenCrossover(benchmark::State& state) {
+    const StrassenSettings saved = strassen_settings();
+    size_t crossover = 0;
+
+    for (auto _ : state) {
+        crossover = 0;
+        for (size_t n = 256; n <= 4096 && crossover == 0; n += 128) {
+            Matrix a(n, n, 1.0);
+            Matrix b(n, n, 2.0);
+            Matrix c(n, n);
+            set_strassen_settings({false, n / 2});
+            const double classic = time_product(a, b, c);
+            set_strassen_settings({true, n / 2});
+            if (time_product(a, b, c) < classic) {
+                crossover = n;
+            }
+        }
+    }
+
+    set_strassen_settings(saved);
+    state.counters["crossover"] = static_cast<double>(crossover);
+}
+
+BENCHMARK(BM_StrassenCrossover)
+    ->Iterations(1)
+    ->Unit(benchmark::kSecond);
+
+// Thread-scaling variants: range(0) is the size, range(1) the pool size
+static void BM_MatrixMultiplicationThreads(benchmark::State& state) {
+    const size_t n = state.range(0);
+    set_num_threads(state.range(1));
+    Matrix a(n, n, 1.0);
+    Matrix b(n, n, 2.0);
+
+    for (auto _ : state) {
+        Matrix c = a * b;
+        benchmark::DoNotOptimize(c);
+    }
+
+    state.counters["FLOPS"] = benchmark::Counter(
+        2.0 * n * n * n, benchmark::Counter::kIsIterationInvariantRate);
+    set_num_threads(0);
+}
+
+BENCHMARK(BM_MatrixMultiplicationThreads)
+    ->ArgsProduct({{512, 1024}, {1, 2, 4, 8}})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+static void BM_MatrixTransposeThreads(benchmark::State& state) {
+    const size_t n = state.range(0);
+    set_num_threads(state.range(1));
+    Matrix m(n, n, 1.5);
+
+    for (auto _ : state) {
+        Matrix t = m.transpose();
+        benchmark::DoNotOptimize(t);
+    }
+
+    set_num_threads(0);
+}
+
+BENCHMARK(BM_MatrixTransposeThreads)
+    ->ArgsProduct({{1024, 2048}, {1, 2, 4, 8}})
+    ->UseRealTime();
+
+static void BM_MatrixAdditionThreads(benchmark::State& state) {
+    const size_t n = state.range(0);
+    set_num_threads(state.range(1));
+    Matrix a(n, n, 1.0);
+    Matrix b(n, n, 2.0);
+
+    for (auto _ : state) {
+        Matrix c = a + b;
+        benchmark::DoNotOptimize(c);
+    }
+
+    set_num_threads(0);
+}
+
+BENCHMARK(BM_MatrixAdditionThreads)
+    ->ArgsProduct({{1024, 2048}, {1, 2, 4, 8}})
+    ->UseRealTime();
+
+static void BM_MatrixNormThreads(benchmark::State& state) {
+    const size_t n = state.range(0);
+    set_num_threads(state.range(1));
+    Matrix m(n, n, 3.14);
+
+    for (auto _ : state) {
+        double norm = m.norm();
+        benchmark::DoNotOptimize(norm);
+    }
+
+    set_num_threads(0);
+}
+
+BENCHMARK(BM_MatrixNormThreads)
+    ->ArgsProduct({{1024, 2048}, {1, 2, 4, 8}})
+    ->UseRealTime();
+
+// Eight independent (a^T * b) + c pipelines of small matrices, one after
+// the other (range(1) == 0) or as async jobs (range(1) == 1), with a pool
+// of four threads: the sizes are below the parallel grain, so only the
+// async version uses more than one thread
+static void BM_AsyncPipeline(benchmark::State& state) {
+    constexpr size_t PIPELINES = 8;
+    const size_t n = state.range(0);
+    const bool async = state.range(1) != 0;
+    set_num_threads(4);
+    const Matrix a(n, n, 1.0);
+    const Matrix b(n, n, 2.0);
+    const Matrix c(n, n, 3.0);
+
+    for (auto _ : state) {
+        if (async) {
+            std::vector<Future<Matrix>> results;
+            for (size_t i = 0; i < PIPELINES; ++i) {
+                const Future<Matrix> at = async_transpose(std::cref(a));
+                results.push_back(async_add(
+                    async_multiply(at, std::cref(b)), std::cref(c)));
+            }
+            for (const Future<Matrix>& result : results) {
+                benchmark::DoNotOptimize(result.get().data());
+            }
+        } else {
+            for (size_t i = 0; i < PIPELINES; ++i) {
+                Matrix result = a.transpose() * b + c;
+                benchmark::DoNotOptimize(result);
+            }
+        }
+    }
+
+    state.counters["FLOPS"] =
+        benchmark::Counter(PIPELINES * 2.0 * n * n * n,
+                           benchmark::Counter::kIsIterationInvariantRate);
+    set_num_threads(0);
+}
+
+BENCHMARK(BM_AsyncPipeline)
+    ->ArgsProduct({{32, 64, 128}, {0, 1}})
+    ->UseRealTime();
+
+// Allocation-free output-parameter and in-place APIs, with the allocating
+// operator+ for comparison
+static void BM_AddAllocating(benchmark::State& state) {
+    const size_t n = state.range(0);
+    Matrix a(n, n, 1.0);
+    Matrix b(n, n, 2.0);
+
+    run_counting_allocations(state, [&] {
+        Matrix c = a + b;
+        benchmark::DoNotOptimize(c);
+    });
+}
+
+BENCHMARK(BM_AddAllocating)->RangeMultiplier(4)->Range(64, 1024);
+
+static void BM_AddInto(benchmark::State& state) {
+    const size_t n = state.range(0);
+    Matrix a(n, n, 1.0);
+    Matrix b(n, n, 2.0);
+    Matrix c(n, n, UNINITIALIZED);
+
+    run_counting_allocations(state, [&] {
+        add_into(a, b, c);
+        benchmark::DoNotOptimize(c);
+    });
+}
+
+BENCHMARK(BM_AddInto)->RangeMultiplier(4)->Range(64, 1024);
+
+static void BM_AddInPlace(benchmark::State& state) {
+    const size_t n = state.range(0);
+    Matrix a(n, n, 1.0);
+    Matrix b(n, n, 1e-9);
+
+    run_counting_allocations(state, [&] {
+        a += b;
+        benchmark::DoNotOptimize(a);
+    });
+}
+
+BENCHMARK(BM_AddInPlace)->RangeMultiplier(4)->Range(64, 1024);
+
+static void BM_ScaleInPlace(benchmark::State& state) {
+    const size_t n = state.range(0);
+    Matrix a(n, n, 1.0);
+
+    run_counting_allocations(state, [&] {
+        a *= 1.0000001;
+        benchmark::DoNotOptimize(a);
+    });
+}
+
+BENCHMARK(BM_ScaleInPlace)->RangeMultiplier(4)->Range(64, 1024);
+
+static void BM_MultiplyInto(benchmark::State& state) {
+    const size_t n = state.range(0);
+    Matrix a(n, n, 1.0);
+    Matrix b(n, n, 2.0);
+    Matrix c(n, n, UNINITIALIZED);
+
+    run_counting_allocations(state, [&] {
+        multiply_into(a, b, c);
+        benchmark::DoNotOptimize(c);
+    });
+
+    state.counters["FLOPS"] = benchmark::Counter(
+        2.0 * n * n * n, benchmark::Counter::kIsIterationInvariantRate);
+}
+
+BENCHMARK(BM_MultiplyInto)
+    ->RangeMultiplier(4)
+    ->Range(16, 1024)
+    ->Unit(benchmark::kMillisecond);
+
+// Copies, moves and shared copies of n x n matrices; up to 4 x 4 the
+// elements are stored inline and allocs_per_iter is 0
+static void BM_MatrixCopy(benchmark::State& state) {
+    const size_t n = state.range(0);
+    const Matrix m(n, n, 1.5);
+
+    run_counting_allocations(state, [&] {
+        Matrix copy = m;
+        benchmark::DoNotOptimize(copy.data());
+    });
+
+    state.SetBytesProcessed(state.iterations() * n * n * sizeof(double));
+}
+
+BENCHMARK(BM_MatrixCopy)->RangeMultiplier(2)->Range(2, 1024);
+
+static void BM_MatrixMove(benchmark::State& state) {
+    const size_t n = state.range(0);
+    Matrix a(n, n, 1.5);
+    Matrix b(n, n, 1.5);
+
+    run_counting_allocations(state, [&] {
+        Matrix moved = std::move(a);
+        a = std::move(b);
+        b = std::move(moved);
+        benchmark::DoNotOptimize(a.data());
+    });
+}
+
+BENCHMARK(BM_MatrixMove)->RangeMultiplier(2)->Range(2, 1024);
+
+static void BM_SharedMatrixCopy(benchmark::State& state) {
+    const size_t n = state.range(0);
+    const SharedMatrix m(Matrix(n, n, 1.5));
+
+    run_counting_allocations(state, [&] {
+        SharedMatrix copy = m;
+        benchmark::DoNotOptimize(copy.data());
+    });
+}
+
+BENCHMARK(BM_SharedMatrixCopy)->RangeMultiplier(4)->Range(4, 1024);
+
+// Copy followed by a write: the price of the first write to a shared copy
+static void BM_SharedMatrixCopyWrite(benchmark::State& state) {
+    const size_t n = state.range(0);
+    const SharedMatrix m(Matrix(n, n, 1.5));
+
+    run_counting_allocations(state, [&] {
+        SharedMatrix copy = m;
+        copy.write()(0, 0) = 2.0;
+        benchmark::DoNotOptimize(copy.data());
+    });
+
+    state.SetBytesProcessed(state.iterations() * n * n * sizeof(double));
+}
+
+BENCHMARK(BM_SharedMatrixCopyWrite)->RangeMultiplier(4)->Range(4, 1024);
+
+// Short-lived operator+ temporaries from the heap vs. from an arena that is
+// reset once per iteration, as a solver step would
+constexpr int TEMPORARIES_PER_ITERATION = 100;
+
+static void BM_TemporariesHeap(benchmark::State& state) {
+    const size_t n = state.range(0);
+    Matrix a(n, n, 1.0);
+    Matrix b(n, n, 2.0);
+
+    for (auto _ : state) {
+        for (int t = 0; t < TEMPORARIES_PER_ITERATION; ++t) {
+            Matrix c = a + b;
+            benchmark::DoNotOptimize(c.data());
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations() * TEMPORARIES_PER_ITERATION);
+}
+
+BENCHMARK(BM_TemporariesHeap)->RangeMultiplier(4)->Range(4, 256);
+
+static void BM_TemporariesArena(benchmark::State& state) {
+    const size_t n = state.range(0);
+    Matrix a(n, n, 1.0);
+    Matrix b(n, n, 2.0);
+    Arena arena;
+    ScopedResource scope(arena);
+
+    for (auto _ : state) {
+        for (int t = 0; t < TEMPORARIES_PER_ITERATION; ++t) {
+            Matrix c = a + b;
+            benchmark::DoNotOptimize(c.data());
+        }
+        arena.reset();
+    }
+
+    state.SetItemsProcessed(state.iterations() * TEMPORARIES_PER_ITERATION);
+}
+
+BENCHMARK(BM_TemporariesArena)->RangeMultiplier(4)->Range(4, 256);
+
+// Checked vs. unchecked element access in a user-written inner loop
+static void BM_ElementAccessChecked(benchmark::State& state) {
+    const size_t n = state.range(0);
+    Matrix m(n, n, 1.0);
+
+    for (auto _ : state) {
+        double sum = 0.0;
+        for (size_t i = 0; i < n; ++i) {
+            for (size_t j = 0; j < n; ++j) {
+                sum += m(i, j);
+            }
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+
+    state.SetBytesProcessed(state.iterations() * n * n * sizeof(double));
+}
+
+BENCHMARK(BM_ElementAccessChecked)->RangeMultiplier(4)->Range(64, 1024);
+
+static void BM_ElementAccessUnchecked(benchmark::State& state) {
+    const size_t n = state.range(0);
+    Matrix m(n, n, 1.0);
+
+    for (auto _ : state) {
+        double sum = 0.0;
+        for (size_t i = 0; i < n; ++i) {
+            for (size_t j = 0; j < n; ++j) {
+                sum += m.unchecked(i, j);
+            }
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+
+    state.SetBytesProcessed(state.iterations() * n * n * sizeof(double));
+}
+
+BENCHMARK(BM_ElementAccessUnchecked)->RangeMultiplier(4)->Range(64, 1024);
+
+static void BM_ElementAccessRowPointer(benchmark::State& state) {
+    const size_t n = state.range(0);
+    Matrix m(n, n, 1.0);
+
+    for (auto _ : state) {
+        double sum = 0.0;
+        for (size_t i = 0; i < n; ++i) {
+            const double* row = m.data() + i * m.stride();
+            for (size_t j = 0; j < n; ++j) {
+                sum += row[j];
+            }
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+
+    state.SetBytesProcessed(state.iterations() * n * n * sizeof(double));
+}
+
+BENCHMARK(BM_ElementAccessRowPointer)->RangeMultiplier(4)->Range(64, 1024);
+
+// Element types: the same product and reductions for float, double,
+// complex and half precision
+template <typename T>
+static void BM_MultiplicationByType(benchmark::State& state) {
+    const size_t n = state.range(0);
+    BasicMatrix<T> a(n, n, T(1));
+    BasicMatrix<T> b(n, n, T(2));
+    BasicMatrix<T> c(n, n, UNINITIALIZED);
+
+    for (auto _ : state) {
+        multiply_into(a, b, c);
+        benchmark::DoNotOptimize(c.data());
+    }
+
+    state.counters["FLOPS"] = benchmark::Counter(
+        2.0 * n * n * n, benchmark::Counter::kIsIterationInvariantRate);
+}
+
+BENCHMARK_TEMPLATE(BM_MultiplicationByType, float)
+    ->RangeMultiplier(4)
+    ->Range(64, 1024)
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_MultiplicationByType, double)
+    ->RangeMultiplier(4)
+    ->Range(64, 1024)
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_MultiplicationByType, std::complex<double>)
+    ->RangeMultiplier(4)
+    ->Range(64, 256)
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_MultiplicationByType, Half)
+    ->RangeMultiplier(4)
+    ->Range(64, 1024)
+    ->Unit(benchmark::kMillisecond);
+
+// Half-precision operands accumulated straight into a float result
+static void BM_MultiplicationHalfToFloat(benchmark::State& state) {
+    const size_t n = state.range(0);
+    BasicMatrix<Half> a(n, n, 1.0F);
+    BasicMatrix<Half> b(n, n, 2.0F);
+    BasicMatrix<float> c(n, n, UNINITIALIZED);
+
+    for (auto _ : state) {
+        multiply_into(a, b, c);
+        benchmark::DoNotOptimize(c.data());
+    }
+
+    state.counters["FLOPS"] = benchmark::Counter(
+        2.0 * n * n * n, benchmark::Counter::kIsIterationInvariantRate);
+}
+
+BENCHMARK(BM_MultiplicationHalfToFloat)
+    ->RangeMultiplier(4)
+    ->Range(64, 1024)
+    ->Unit(benchmark::kMillisecond);
+
+template <typename T>
+static void BM_AdditionByType(benchmark::State& state) {
+    const size_t n = state.range(0);
+    BasicMatrix<T> a(n, n, T(1));
+    BasicMatrix<T> b(n, n, T(2));
+    BasicMatrix<T> c(n, n, UNINITIALIZED);
+
+    for (auto _ : state) {
+        add_into(a, b, c);
+        benchmark::DoNotOptimize(c.data());
+    }
+
+    state.SetBytesProcessed(state.iterations() * 3 * n * n * sizeof(T));
+}
+
+BENCHMARK_TEMPLATE(BM_AdditionByType, float)
+    ->RangeMultiplier(4)
+    ->Range(64, 2048);
+BENCHMARK_TEMPLATE(BM_AdditionByType, double)
+    ->RangeMultiplier(4)
+    ->Range(64, 2048);
+BENCHMARK_TEMPLATE(BM_AdditionByType, Half)
+    ->RangeMultiplier(4)
+    ->Range(64, 2048);
+
+template <typename T>
+static void BM_NormByType(benchmark::State& state) {
+    const size_t n = state.range(0);
+    BasicMatrix<T> a(n, n, T(1));
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(a.norm());
+    }
+
+    state.SetBytesProcessed(state.iterations() * n * n * sizeof(T));
+}
+
+BENCHMARK_TEMPLATE(BM_NormByType, float)
+    ->RangeMultiplier(4)
+    ->Range(64, 2048);
+BENCHMARK_TEMPLATE(BM_NormByType, double)
+    ->RangeMultiplier(4)
+    ->Range(64, 2048);
+
+// Small fixed sizes: the unrolled FixedMatrix product against a dynamic
+// Matrix of the same size, which goes through dispatch and the GEMM driver
+template <size_t N>
+static void BM_FixedMultiplication(benchmark::State& state) {
+    FixedMatrix<double, N, N> a(1.0);
+    FixedMatrix<double, N, N> b(2.0);
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(a);
+        benchmark::DoNotOptimize(b);
+        auto c = a * b;
+        benchmark::DoNotOptimize(c);
+    }
+
+    state.counters["FLOPS"] = benchmark::Counter(
+        2.0 * N * N * N, benchmark::Counter::kIsIterationInvariantRate);
+}
+
+BENCHMARK_TEMPLATE(BM_FixedMultiplication, 2);
+BENCHMARK_TEMPLATE(BM_FixedMultiplication, 3);
+BENCHMARK_TEMPLATE(BM_FixedMultiplication, 4);
+BENCHMARK_TEMPLATE(BM_FixedMultiplication, 6);
+BENCHMARK_TEMPLATE(BM_FixedMultiplication, 8);
+
+static void BM_SmallDynamicMultiplication(benchmark::State& state) {
+    const size_t n = state.range(0);
+    Matrix a(n, n, 1.0);
+    Matrix b(n, n, 2.0);
+    Matrix c(n, n, UNINITIALIZED);
+
+    for (auto _ : state) {
+        multiply_into(a, b, c);
+        benchmark::DoNotOptimize(c.data());
+    }
+
+    state.counters["FLOPS"] = benchmark::Counter(
+        2.0 * n * n * n, benchmark::Counter::kIsIterationInvariantRate);
+}
+
+BENCHMARK(BM_SmallDynamicMultiplication)->DenseRange(2, 4)->Arg(6)->Arg(8);
+
+template <size_t N>
+static void BM_FixedTranspose(benchmark::State& state) {
+    FixedMatrix<double, N, N> a(1.0);
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(a);
+        auto t = a.transpose();
+        benchmark::DoNotOptimize(t);
+    }
+}
+
+BENCHMARK_TEMPLATE(BM_FixedTranspose, 3);
+BENCHMARK_TEMPLATE(BM_FixedTranspose, 4);
+BENCHMARK_TEMPLATE(BM_FixedTranspose, 8);
+
+// Matrix-vector product: gemv on a Vector against the n x 1 Matrix that
+// was the only way to write it before
+static void BM_Gemv(benchmark::State& state) {
+    const size_t n = state.range(0);
+    Matrix a(n, n, 1.0);
+    Vector x(n, 2.0);
+    Vector y(n, UNINITIALIZED);
+
+    for (auto _ : state) {
+        multiply_into(a, x, y);
+        benchmark::DoNotOptimize(y.data());
+    }
+
+    state.SetBytesProcessed(state.iterations() * n * n * sizeof(double));
+}
+
+BENCHMARK(BM_Gemv)->RangeMultiplier(4)->Range(64, 4096);
+
+static void BM_GemvAsMatrix(benchmark::State& state) {
+    const size_t n = state.range(0);
+    Matrix a(n, n, 1.0);
+    Matrix x(n, 1, 2.0);
+
+    for (auto _ : state) {
+        Matrix y = a * x;
+        benchmark::DoNotOptimize(y.data());
+    }
+
+    state.SetBytesProcessed(state.iterations() * n * n * sizeof(double));
+}
+
+BENCHMARK(BM_GemvAsMatrix)->RangeMultiplier(4)->Range(64, 4096);
+
+static void BM_Dot(benchmark::State& state) {
+    const size_t n = state.range(0);
+    Vector x(n, 1.0);
+    Vector y(n, 2.0);
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(dot(x, y));
+    }
+
+    state.SetBytesProcessed(state.iterations() * 2 * n * sizeof(double));
+}
+
+BENCHMARK(BM_Dot)->RangeMultiplier(8)->Range(1 << 10, 1 << 22);
+
+static void BM_Axpy(benchmark::State& state) {
+    const size_t n = state.range(0);
+    Vector x(n, 1.0);
+    Vector y(n, 2.0);
+
+    for (auto _ : state) {
+        axpy(1e-9, x, y);
+        benchmark::DoNotOptimize(y.data());
+    }
+
+    state.SetBytesProcessed(state.iterations() * 3 * n * sizeof(double));
+}
+
+BENCHMARK(BM_Axpy)->RangeMultiplier(8)->Range(1 << 10, 1 << 22);
+
+// The overflow check costs nothing on the fast path; range(1) = 1 uses
+// 1e200 elements, which take the rescaled path.
+static void BM_Nrm2(benchmark::State& state) {
+    const size_t n = state.range(0);
+    Vector x(n, state.range(1) != 0 ? 1e200 : 1.0);
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(nrm2(x));
+    }
+
+    state.SetBytesProcessed(state.iterations() * n * sizeof(double));
+}
+
+BENCHMARK(BM_Nrm2)->ArgsProduct({{1 << 10, 1 << 16, 1 << 22}, {0, 1}});
+
+// Batched small products: range(0) is the size, range(1) the batch count.
+// The interleaved batch, the pointer-array form over separate matrices, and
+// a loop of single products over the same matrices.
+static void BM_BatchGemm(benchmark::State& state) {
+    const size_t n = state.range(0);
+    const size_t count = state.range(1);
+    MatrixBatch a(count, n, n, 1.0);
+    MatrixBatch b(count, n, n, 2.0);
+    MatrixBatch c(count, n, n);
+
+    for (auto _ : state) {
+        multiply_into(a, b, c);
+        benchmark::DoNotOptimize(c.data());
+    }
+
+    state.counters["FLOPS"] = benchmark::Counter(
+        2.0 * n * n * n * count, benchmark::Counter::kIsIterationInvariantRate);
+}
+
+BENCHMARK(BM_BatchGemm)->ArgsProduct({{4, 8, 16, 32, 64}, {1024, 4096}});
+
+static void BM_BatchGemmPointers(benchmark::State& state) {
+    const size_t n = state.range(0);
+    const size_t count = state.range(1);
+    std::vector<Matrix> a(count, Matrix(n, n, 1.0));
+    std::vector<Matrix> b(count, Matrix(n, n, 2.0));
+    std::vector<Matrix> c(count, Matrix(n, n));
+    std::vector<const Matrix*> pa, pb;
+    std::vector<Matrix*> pc;
+    for (size_t i = 0; i < count; ++i) {
+        pa.push_back(&a[i]);
+        pb.push_back(&b[i]);
+        pc.push_back(&c[i]);
+    }
+
+    for (auto _ : state) {
+        multiply_into(pa.data(), pb.data(), pc.data(), count);
+        benchmark::DoNotOptimize(c.data());
+    }
+
+    state.counters["FLOPS"] = benchmark::Counter(
+        2.0 * n * n * n * count, benchmark::Counter::kIsIterationInvariantRate);
+}
+
+BENCHMARK(BM_BatchGemmPointers)
+    ->ArgsProduct({{4, 8, 16, 32, 64}, {1024, 4096}});
+
+static void BM_BatchGemmLoop(benchmark::State& state) {
+    const size_t n = state.range(0);
+    const size_t count = state.range(1);
+    std::vector<Matrix> a(count, Matrix(n, n, 1.0));
+    std::vector<Matrix> b(count, Matrix(n, n, 2.0));
+    std::vector<Matrix> c(count, Matrix(n, n));
+
+    for (auto _ : state) {
+        for (size_t i = 0; i < count; ++i) {
+            multiply_into(a[i], b[i], c[i]);
+        }
+        benchmark::DoNotOptimize(c.data());
+    }
+
+    state.counters["FLOPS"] = benchmark::Counter(
+        2.0 * n * n * n * count, benchmark::Counter::kIsIterationInvariantRate);
+}
+
+BENCHMARK(BM_BatchGemmLoop)->ArgsProduct({{4, 8, 16, 32, 64}, {1024, 4096}});
+
+// Factorizations of n x n matrices, with the conventional flop counts:
+// 2n^3/3 for LU, n^3/3 for Cholesky and 4n^3/3 for QR.
+static Matrix diagonally_dominant(size_t n) {
+    Matrix a(n, n);
+    for (size_t i = 0; i < n; ++i) {
+        for (size_t j = 0; j < n; ++j) {
+            a(i, j) = static_cast<double>((i * 31 + j * 17) % 23) / 23.0;
+        }
+        a(i, i) += static_cast<double>(n);
+    }
+    return a;
+}
+
+static void BM_LU(benchmark::State& state) {
+    const size_t n = state.range(0);
+    const Matrix a = diagonally_dominant(n);
+
+    for (auto _ : state) {
+        LU lu(a);
+        benchmark::DoNotOptimize(lu.packed().data());
+    }
+
+    state.counters["FLOPS"] = benchmark::Counter(
+        2.0 * n * n * n / 3.0, benchmark::Counter::kIsIterationInvariantRate);
+}
+
+BENCHMARK(BM_LU)
+    ->RangeMultiplier(2)
+    ->Range(256, 2048)
+    ->Unit(benchmark::kMillisecond);
+
+static void BM_Cholesky(benchmark::State& state) {
+    const size_t n = state.range(0);
+    const Matrix g = diagonally_dominant(n);
+    const Matrix a = g * g.transpose();
+
+    for (auto _ : state) {
+        Cholesky chol(a);
+        benchmark::DoNotOptimize(chol.lower().data());
+    }
+
+    state.counters["FLOPS"] = benchmark::Counter(
+        1.0 * n * n * n / 3.0, benchmark::Counter::kIsIterationInvariantRate);
+}
+
+BENCHMARK(BM_Cholesky)
+    ->RangeMultiplier(2)
+    ->Range(256, 2048)
+    ->Unit(benchmark::kMillisecond);
+
+static void BM_QR(benchmark::State& state) {
+    const size_t n = state.range(0);
+    const Matrix a = diagonally_dominant(n);
+
+    for (auto _ : state) {
+        QR qr(a);
+        benchmark::DoNotOptimize(qr.packed().data());
+    }
+
+    state.counters["FLOPS"] = benchmark::Counter(
+        4.0 * n * n * n / 3.0, benchmark::Counter::kIsIterationInvariantRate);
+}
+
+BENCHMARK(BM_QR)
+    ->RangeMultiplier(2)
+    ->Range(256, 2048)
+    ->Unit(benchmark::kMillisecond);
+
+// Solve with 64 right-hand sides against an existing factorization.
+static void BM_LUSolve(benchmark::State& state) {
+    const size_t n = state.range(0);
+    const LU lu(diagonally_dominant(n));
+    const Matrix b(n, 64, 1.0);
+
+    for (auto _ : state) {
+        Matrix x = lu.solve(b);
+        benchmark::DoNotOptimize(x.data());
+    }
+
+    state.counters["FLOPS"] = benchmark::Counter(
+        2.0 * n * n * 64, benchmark::Counter::kIsIterationInvariantRate);
+}
+
+BENCHMARK(BM_LUSolve)->RangeMultiplier(4)->Range(256, 4096);
+
+// Matrix files: saving, loading into a Matrix, and mapping, here from a
+// warm page cache. BM_MapMatrix sums the mapped elements so that every
+// page is touched.
+static std::string bench_file(size_t n) {
+    return (std::filesystem::temp_directory_path() /
+            ("matrixops_bench_" + std::to_string(n) + ".mat"))
+        .string();
+}
+
+static void BM_SaveMatrix(benchmark::State& state) {
+    const size_t n = state.range(0);
+    const Matrix m(n, n, 1.5);
+    const std::string path = bench_file(n);
+
+    for (auto _ : state) {
+        save_matrix(path, m);
+    }
+
+    state.SetBytesProcessed(state.iterations() * n * n * sizeof(double));
+    std::filesystem::remove(path);
+}
+
+BENCHMARK(BM_SaveMatrix)
+    ->RangeMultiplier(4)
+    ->Range(256, 4096)
+    ->Unit(benchmark::kMillisecond);
+
+static void BM_LoadMatrix(benchmark::State& state) {
+    const size_t n = state.range(0);
+    const std::string path = bench_file(n);
+    save_matrix(path, Matrix(n, n, 1.5));
+
+    for (auto _ : state) {
+        Matrix m = load_matrix<double>(path);
+        benchmark::DoNotOptimize(m.data());
+    }
+
+    state.SetBytesProcessed(state.iterations() * n * n * sizeof(double));
+    std::filesystem::remove(path);
+}
+
+BENCHMARK(BM_LoadMatrix)
+    ->RangeMultiplier(4)
+    ->Range(256, 4096)
+    ->Unit(benchmark::kMillisecond);
+
+static void BM_MapMatrix(benchmark::State& state) {
+    const size_t n = state.range(0);
+    const std::string path = bench_file(n);
+    save_matrix(path, Matrix(n, n, 1.5));
+
+    for (auto _ : state) {
+        MappedMatrix m(path);
+        double sum = 0.0;
+        for (size_t k = 0; k < n * n; k += 512) {
+            sum += m.coeff(k);
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+
+    state.SetBytesProcessed(state.iterations() * n * n * sizeof(double));
+    std::filesystem::remove(path);
+}
+
+BENCHMARK(BM_MapMatrix)
+    ->RangeMultiplier(4)
+    ->Range(256, 4096)
+    ->Unit(benchmark::kMillisecond);
+
+// Out-of-core products under a budget of range(1) MiB, against the
+// in-memory BM_MatrixMultiplication; the inputs stay in the page cache.
+static void BM_OutOfCoreMultiply(benchmark::State& state) {
+    const size_t n = state.range(0);
+    const std::string a = bench_file(n) + ".a";
+    const std::string b = bench_file(n) + ".b";
+    const std::string out = bench_file(n) + ".out";
+    save_matrix(a, Matrix(n, n, 1.5));
+    save_matrix(b, Matrix(n, n, 0.5));
+    const size_t saved = out_of_core_budget();
+    set_out_of_core_budget(static_cast<size_t>(state.range(1)) << 20);
+
+    for (auto _ : state) {
+        multiply_files(a, b, out);
+    }
+
+    set_out_of_core_budget(saved);
+    state.counters["FLOPS"] = benchmark::Counter(
+        2.0 * n * n * n, benchmark::Counter::kIsIterationInvariantRate);
+    for (const std::string& path : {a, b, out}) {
+        std::filesystem::remove(path);
+    }
+}
+
+BENCHMARK(BM_OutOfCoreMultiply)
+    ->ArgsProduct({{1024, 2048}, {4, 16, 1024}})
+    ->Unit(benchmark::kMillisecond);
+
+static void BM_OutOfCoreTranspose(benchmark::State& state) {
+    const size_t n = state.range(0);
+    const std::string a = bench_file(n) + ".a";
+    const std::string out = bench_file(n) + ".out";
+    save_matrix(a, Matrix(n, n, 1.5));
+    const size_t saved = out_of_core_budget();
+    set_out_of_core_budget(size_t{16} << 20);
+
+    for (auto _ : state) {
+        transpose_file(a, out);
+    }
+
+    set_out_of_core_budget(saved);
+    state.SetBytesProcessed(state.iterations() * 2 * n * n * sizeof(double));
+    std::filesystem::remove(a);
+    std::filesystem::remove(out);
+}
+
+BENCHMARK(BM_OutOfCoreTranspose)
+    ->RangeMultiplier(4)
+    ->Range(1024, 4096)
+    ->Unit(benchmark::kMillisecond);
+
+// Instrumentation overhead on small products, where the fixed cost of a
+// recorded call shows most: compare arg 1 (recording) with arg 0, and a
+// build without MATRIXOPS_ENABLE_INSTRUMENTATION, where both are equal.
+static void BM_InstrumentationOverhead(benchmark::State& state) {
+    const size_t n = state.range(0);
+    const bool saved = instrumentation_enabled();
+    set_instrumentation_enabled(state.range(1) != 0);
+    const Matrix a(n, n, 1.5);
+    const Matrix b(n, n, 2.5);
+    Matrix c(n, n);
+
+    for (auto _ : state) {
+        multiply_into(a, b, c);
+        benchmark::DoNotOptimize(c.data());
+    }
+
+    set_instrumentation_enabled(saved);
+    reset_instrumentation();
+    state.counters["FLOPS"] = benchmark::Counter(
+        2.0 * n * n * n, benchmark::Counter::kIsIterationInvariantRate);
+}
+
+BENCHMARK(BM_InstrumentationOverhead)->ArgsProduct({{4, 16, 64}, {0, 1}});
+
 BENCHMARK_MAIN();
@@ -0,0 +1,263 @@
+#include <benchmark/benchmark.h>
+#include "matrixops/sparse.h"
+#include <cstdint>
+#include <map>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace matrixops;
+
+// Sparsity patterns of the workloads the sparse subsystem is meant for:
+// finite difference and finite element discretizations, whose rows have a
+// handful of entries near the diagonal, and power-law graphs, whose
+// degrees vary over orders of magnitude.
+enum Pattern : int64_t {
+    LAPLACIAN_2D, // 5-point stencil on a 1024 x 1024 grid
+    HEX_FEM_3D,   // trilinear hexahedra on a 64^3 grid, 27 entries per row
+    RMAT_GRAPH    // R-MAT graph, 2^18 nodes, 16 edges per node
+};
+
+static const char* pattern_name(int64_t pattern) {
+    switch (pattern) {
+    case LAPLACIAN_2D:
+        return "laplacian_2d";
+    case HEX_FEM_3D:
+        return "hex_fem_3d";
+    default:
+        return "rmat_graph";
+    }
+}
+
+static void add_laplacian_2d(SparseBuilder& builder, size_t n) {
+    for (size_t i = 0; i < n; ++i) {
+        for (size_t j = 0; j < n; ++j) {
+            const size_t row = i * n + j;
+            builder.add(row, row, 4.0);
+            if (i > 0) {
+                builder.add(row, row - n, -1.0);
+            }
+            if (i + 1 < n) {
+                builder.add(row, row + n, -1.0);
+            }
+            if (j > 0) {
+                builder.add(row, row - 1, -1.0);
+            }
+            if (j + 1 < n) {
+                builder.add(row, row + 1, -1.0);
+            }
+        }
+    }
+}
+
+// Element-by-element assembly, as a finite element code does it: each of
+// the (n - 1)^3 elements adds an 8 x 8 block over its corner nodes, so
+// every interior entry is the sum of up to 8 duplicates.
+static void add_hex_fem_3d(SparseBuilder& builder, size_t n) {
+    for (size_t x = 0; x + 1 < n; ++x) {
+        for (size_t y = 0; y + 1 < n; ++y) {
+            for (size_t z = 0; z + 1 < n; ++z) {
+                size_t nodes[8];
+                for (size_t c = 0; c < 8; ++c) {
+                    nodes[c] = ((x + (c & 1)) * n + y + ((c >> 1) & 1)) * n +
+                               z + (c >> 2);
+                }
+                for (size_t a = 0; a < 8; ++a) {
+                    for (size_t b = 0; b < 8; ++b) {
+                        builder.add(nodes[a], nodes[b], a == b ? 1.0 : -0.1);
+                    }
+                }
+            }
+        }
+    }
+}
+
+// Recursive matrix (R-MAT) edges with the Graph500 probabilities, which
+// give a power-law degree distribution.
+static void add_rmat_graph(SparseBuilder& builder, size_t scale,
+                           size_t edges_per_node) {
+    std::mt19937_64 rng(42);
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+    const size_t edges = (size_t{1} << scale) * edges_per_node;
+    for (size_t e = 0; e < edges; ++e) {
+        size_t row = 0;
+        size_t col = 0;
+        for (size_t bit = 0; bit < scale; ++bit) {
+            const double r = uniform(rng);
+            row = row * 2 + (r >= 0.76 ? 1 : 0);
+            col = col * 2 + ((r >= 0.57 && r < 0.76) || r >= 0.95 ? 1 : 0);
+        }
+        builder.add(row, col, 1.0);
+    }
+}
+
+static SparseBuilder make_builder(int64_t pattern) {
+    switch (pattern) {
+    case LAPLACIAN_2D: {
+        SparseBuilder builder(1024 * 1024, 1024 * 1024);
+        add_laplacian_2d(builder, 1024);
+        return builder;
+    }
+    case HEX_FEM_3D: {
+        SparseBuilder builder(64 * 64 * 64, 64 * 64 * 64);
+        add_hex_fem_3d(builder, 64);
+        return builder;
+    }
+    default: {
+        SparseBuilder builder(size_t{1} << 18, size_t{1} << 18);
+        add_rmat_graph(builder, 18, 16);
+        return builder;
+    }
+    }
+}
+
+// Assembled once per pattern and layout and shared by the benchmarks.
+static const SparseMatrix& get_matrix(int64_t pattern, SparseLayout layout) {
+    static std::map<std::pair<int64_t, SparseLayout>, SparseMatrix> cache;
+    const auto key = std::make_pair(pattern, layout);
+    auto it = cache.find(key);
+    if (it == cache.end()) {
+        it = cache.emplace(key, make_builder(pattern).build(layout)).first;
+    }
+    return it->second;
+}
+
+static void set_pattern_label(benchmark::State& state,
+                              SparseLayout layout) {
+    state.SetLabel(std::string(pattern_name(state.range(0))) +
+                   (layout == SparseLayout::CSR ? "/csr" : "/csc"));
+}
+
+// Sparse matrix-vector product. Bytes counts one pass over the values,
+// indices and offsets plus the two vectors, the floor set by memory
+// bandwidth.
+static void BM_SpMV(benchmark::State& state, SparseLayout layout) {
+    const SparseMatrix& a = get_matrix(state.range(0), layout);
+    const std::vector<double> x(a.cols(), 1.0);
+    std::vector<double> y(a.rows());
+
+    for (auto _ : state) {
+        multiply_into(a, x, y);
+        benchmark::DoNotOptimize(y.data());
+    }
+
+    const size_t outer = layout == SparseLayout::CSR ? a.rows() : a.cols();
+    const size_t bytes = a.nnz() * (sizeof(double) + sizeof(size_t)) +
+                         (outer + 1) * sizeof(size_t) +
+                         (a.rows() + a.cols()) * sizeof(double);
+    state.SetBytesProcessed(state.iterations() * bytes);
+    state.counters["FLOPS"] = benchmark::Counter(
+        2.0 * a.nnz(), benchmark::Counter::kIsIterationInvariantRate);
+    set_pattern_label(state, layout);
+}
+
+BENCHMARK_CAPTURE(BM_SpMV, csr, SparseLayout::CSR)
+    ->DenseRange(LAPLACIAN_2D, RMAT_GRAPH)
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_SpMV, csc, SparseLayout::CSC)
+    ->DenseRange(LAPLACIAN_2D, RMAT_GRAPH)
+    ->Unit(benchmark::kMillisecond);
+
+// Sparse times dense with range(1) right-hand sides, e.g. a block Krylov
+// solver or the feature matrix of a graph neural network
+static void BM_SpMM(benchmark::State& state, SparseLayout layout) {
+    const SparseMatrix& a = get_matrix(state.range(0), layout);
+    const size_t n = state.range(1);
+    const Matrix b(a.cols(), n, 1.0);
+    Matrix c(a.rows(), n, UNINITIALIZED);
+
+    for (auto _ : state) {
+        multiply_into(a, b, c);
+        benchmark::DoNotOptimize(c.data());
+    }
+
+    state.counters["FLOPS"] = benchmark::Counter(
+        2.0 * a.nnz() * n, benchmark::Counter::kIsIterationInvariantRate);
+    set_pattern_label(state, layout);
+}
+
+BENCHMARK_CAPTURE(BM_SpMM, csr, SparseLayout::CSR)
+    ->ArgsProduct({{LAPLACIAN_2D, HEX_FEM_3D, RMAT_GRAPH}, {8, 32}})
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_SpMM, csc, SparseLayout::CSC)
+    ->ArgsProduct({{LAPLACIAN_2D, HEX_FEM_3D, RMAT_GRAPH}, {8, 32}})
+    ->Unit(benchmark::kMillisecond);
+
+// COO assembly, including the duplicate summing of the FEM pattern; the
+// triplets are generated outside the timed region.
+static void BM_Assembly(benchmark::State& state) {
+    const SparseBuilder builder = make_builder(state.range(0));
+    size_t nnz = 0;
+
+    for (auto _ : state) {
+        SparseMatrix a = builder.build();
+        nnz = a.nnz();
+        benchmark::DoNotOptimize(a.values());
+    }
+
+    state.counters["triplets"] = static_cast<double>(builder.size());
+    state.counters["nnz"] = static_cast<double>(nnz);
+    state.SetItemsProcessed(state.iterations() * builder.size());
+    set_pattern_label(state, SparseLayout::CSR);
+}
+
+BENCHMARK(BM_Assembly)
+    ->DenseRange(LAPLACIAN_2D, RMAT_GRAPH)
+    ->Unit(benchmark::kMillisecond);
+
+static void BM_SparseTranspose(benchmark::State& state) {
+    const SparseMatrix& a = get_matrix(state.range(0), SparseLayout::CSR);
+
+    for (auto _ : state) {
+        SparseMatrix t = a.transpose();
+        benchmark::DoNotOptimize(t.values());
+    }
+
+    state.SetItemsProcessed(state.iterations() * a.nnz());
+    set_pattern_label(state, SparseLayout::CSR);
+}
+
+BENCHMARK(BM_SparseTranspose)
+    ->DenseRange(LAPLACIAN_2D, RMAT_GRAPH)
+    ->Unit(benchmark::kMillisecond);
+
+static void BM_SparseNorm(benchmark::State& state) {
+    const SparseMatrix& a = get_matrix(state.range(0), SparseLayout::CSR);
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(a.norm());
+    }
+
+    state.SetBytesProcessed(state.iterations() * a.nnz() * sizeof(double));
+    set_pattern_label(state, SparseLayout::CSR);
+}
+
+BENCHMARK(BM_SparseNorm)->DenseRange(LAPLACIAN_2D, RMAT_GRAPH);
+
+// The same 2D Laplacian product, sparse and dense, at a size where the
+// dense matrix still fits in memory (4096 x 4096, 128 MiB)
+static void BM_LaplacianSparseVsDense(benchmark::State& state) {
+    const bool dense = state.range(0) != 0;
+    SparseBuilder builder(64 * 64, 64 * 64);
+    add_laplacian_2d(builder, 64);
+    const SparseMatrix a = builder.build();
+    const Matrix a_dense = a.to_dense();
+    const Matrix x(a.cols(), 1, 1.0);
+    Matrix y(a.rows(), 1, UNINITIALIZED);
+
+    for (auto _ : state) {
+        if (dense) {
+            multiply_into(a_dense, x, y);
+        } else {
+            multiply_into(a, x, y);
+        }
+        benchmark::DoNotOptimize(y.data());
+    }
+
+    state.SetLabel(dense ? "dense" : "sparse");
+}
+
+BENCHMARK(BM_LaplacianSparseVsDense)->Arg(0)->Arg(1);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,221 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace matrixops {
+
+/**
+ * @brief Alignment of every Matrix buffer, one cache line
+ */
+constexpr size_t STORAGE_ALIGNMENT = 64;
+
+/**
+ * @brief Source of Matrix element storage
+ *
+ * Implementations return blocks aligned to STORAGE_ALIGNMENT. deallocate()
+ * receives the size that was passed to allocate().
+ */
+class MemoryResource {
+public:
+    virtual ~MemoryResource() = default;
+
+    /**
+     * @brief Allocate bytes of storage
+     * @throws std::bad_alloc if the memory cannot be obtained
+     */
+    virtual void* allocate(size_t bytes) = 0;
+
+    /**
+     * @brief Release storage obtained from allocate()
+     */
+    virtual void deallocate(void* p, size_t bytes) noexcept = 0;
+};
+
+/**
+ * @brief The global heap, with 64-byte alignment
+ *
+ * Buffers of at least 2 MiB are aligned to 2 MiB so that they can be
+ * backed by transparent huge pages, see set_huge_pages(), and placed on
+ * NUMA nodes by page, see NumaSettings.
+ */
+MemoryResource& heap_resource();
+
+/**
+ * @brief Check if large heap buffers are backed by huge pages
+ *
+ * Defaults to the MATRIXOPS_HUGE_PAGES environment variable (1 enables
+ * them), or off if it is unset.
+ */
+bool huge_pages();
+
+/**
+ * @brief Request transparent huge pages for heap buffers of 2 MiB or more
+ *
+ * Only has an effect on Linux; elsewhere the setting is recorded and
+ * ignored.
+ */
+void set_huge_pages(bool enabled);
+
+/**
+ * @brief Get the resource new matrices on this thread allocate from
+ *
+ * This is heap_resource() unless a ScopedResource is active.
+ */
+MemoryResource& current_resource();
+
+/**
+ * @brief Route the allocations of this thread to a resource for a scope
+ *
+ * Every Matrix created on the thread while the scope is alive, including
+ * the temporaries of expressions such as `a * b + c`, takes its storage
+ * from the resource. Scopes nest; the previous resource is restored on
+ * destruction. A matrix keeps the resource it was allocated from, so it
+ * must not outlive it.
+ */
+class ScopedResource {
+public:
+    explicit ScopedResource(MemoryResource& resource);
+    ~ScopedResource();
+
+    ScopedResource(const ScopedResource&) = delete;
+    ScopedResource& operator=(const ScopedResource&) = delete;
+
+private:
+    MemoryResource* previous_;
+};
+
+/**
+ * @brief Bump allocator whose memory is released all at once
+ *
+ * Allocation advances a pointer through chunks obtained from an upstream
+ * resource; deallocate() only reclaims the most recent allocation. reset()
+ * makes the whole capacity available again in O(1), keeping the chunks for
+ * reuse, so a solver can run every iteration out of the same memory. Not
+ * thread-safe.
+ */
+class Arena : public MemoryResource {
+public:
+    /**
+     * @brief Create an empty arena
+     * @param chunk_bytes Size of the chunks requested from upstream;
+     * larger allocations get a chunk of their own
+     * @param upstream Resource the chunks come from
+     * @throws std::invalid_argument if chunk_bytes is 0
+     */
+    explicit Arena(size_t chunk_bytes = size_t{1} << 20,
+                   MemoryResource& upstream = heap_resource());
+    ~Arena() override;
+
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    void* allocate(size_t bytes) override;
+    void deallocate(void* p, size_t bytes) noexcept override;
+
+    /**
+     * @brief Release every allocation at once
+     *
+     * Matrices allocated from the arena must be gone, or never be touched
+     * again, by the time this is called.
+     */
+    void reset() noexcept;
+
+    /**
+     * @brief Bytes in use since construction or the last reset()
+     */
+    size_t bytes_used() const { return used_; }
+
+    /**
+     * @brief Total size of the chunks held
+     */
+    size_t capacity() const { return capacity_; }
+
+private:
+    struct Chunk {
+        char* data;
+        size_t size;
+    };
+
+    MemoryResource* upstream_;
+    size_t chunk_bytes_;
+    std::vector<Chunk> chunks_;
+    size_t current_ = 0;
+    size_t offset_ = 0;
+    size_t used_ = 0;
+    size_t capacity_ = 0;
+};
+
+namespace detail {
+
+/**
+ * @brief std::allocator replacement drawing from a MemoryResource
+ *
+ * Elements are default-initialized, so std::vector<double,
+ * StorageAllocator<double>>(n) leaves them uninitialized rather than
+ * zero-filling them. Copies allocate from the current resource of the
+ * copying thread; moves keep the source's resource.
+ */
+template <typename T>
+class StorageAllocator {
+public:
+    using value_type = T;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+    using is_always_equal = std::false_type;
+
+    StorageAllocator() noexcept : resource_(&current_resource()) {}
+
+    explicit StorageAllocator(MemoryResource& resource) noexcept
+        : resource_(&resource) {}
+
+    template <typename U>
+    StorageAllocator(const StorageAllocator<U>& other) noexcept
+        : resource_(other.resource()) {}
+
+    T* allocate(size_t n) {
+        return static_cast<T*>(resource_->allocate(n * sizeof(T)));
+    }
+
+    void deallocate(T* p, size_t n) noexcept {
+        resource_->deallocate(p, n * sizeof(T));
+    }
+
+    template <typename U>
+    void construct(U* p) noexcept(std::is_nothrow_default_constructible_v<U>) {
+        ::new (static_cast<void*>(p)) U;
+    }
+
+    template <typename U, typename... Args>
+    void construct(U* p, Args&&... args) {
+        ::new (static_cast<void*>(p)) U(std::forward<Args>(args)...);
+    }
+
+    StorageAllocator select_on_container_copy_construction() const {
+        return StorageAllocator();
+    }
+
+    MemoryResource* resource() const noexcept { return resource_; }
+
+    template <typename U>
+    friend bool operator==(const StorageAllocator& a,
+                           const StorageAllocator<U>& b) noexcept {
+        return a.resource() == b.resource();
+    }
+
+    template <typename U>
+    friend bool operator!=(const StorageAllocator& a,
+                           const StorageAllocator<U>& b) noexcept {
+        return !(a == b);
+    }
+
+private:
+    MemoryResource* resource_;
+};
+
+} // namespace detail
+} // namespace matrixops
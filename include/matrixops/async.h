@@ -0,0 +1,331 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "matrixops/matrix.h"
+
+namespace matrixops {
+
+template <typename T>
+class Future;
+
+namespace detail {
+
+/**
+ * @brief Completion state shared by a Future and the job producing it
+ */
+class AsyncState {
+public:
+    bool is_ready() const { return ready_.load(std::memory_order_acquire); }
+
+    /**
+     * @brief Block until the state is complete
+     *
+     * On a pool worker this runs queued work meanwhile, since the job it
+     * waits for may be queued behind the one the worker is running.
+     */
+    void wait() const;
+
+    /**
+     * @brief Call f once the state is complete: right away, on the calling
+     * thread, if it already is, otherwise on the thread completing it
+     */
+    void on_ready(std::function<void()> f);
+
+    const std::exception_ptr& error() const { return error_; }
+
+protected:
+    void complete(std::exception_ptr error);
+
+private:
+    mutable std::mutex mutex_;
+    mutable std::condition_variable completed_;
+    std::atomic<bool> ready_{false};
+    std::exception_ptr error_;
+    std::vector<std::function<void()>> continuations_;
+};
+
+template <typename T>
+class FutureState : public AsyncState {
+public:
+    void set_value(T value) {
+        value_.emplace(std::move(value));
+        complete(nullptr);
+    }
+
+    void set_error(std::exception_ptr error) { complete(std::move(error)); }
+
+    const T& value() const { return *value_; }
+
+private:
+    std::optional<T> value_;
+};
+
+/**
+ * @brief Queue job on the library thread pool after the jobs queued
+ * before it, or run it right away when operations are single-threaded
+ */
+void submit_job(std::function<void()> job);
+
+struct FutureAccess {
+    template <typename T>
+    static const std::shared_ptr<FutureState<T>>&
+    state(const Future<T>& future) {
+        future.check();
+        return future.state_;
+    }
+
+    template <typename T>
+    static Future<T> make(std::shared_ptr<FutureState<T>> state) {
+        return Future<T>(std::move(state));
+    }
+};
+
+template <typename A>
+struct IsFuture : std::false_type {};
+
+template <typename T>
+struct IsFuture<Future<T>> : std::true_type {};
+
+// What a job receives for each of its arguments.
+template <typename T>
+const T& unwrap(const Future<T>& future) {
+    return future.get();
+}
+
+template <typename T>
+T& unwrap(const std::reference_wrapper<T>& ref) {
+    return ref.get();
+}
+
+template <typename A>
+const A& unwrap(const A& arg) {
+    return arg;
+}
+
+template <typename F, typename... Args>
+using AsyncResult = std::decay_t<std::invoke_result_t<
+    const F&, decltype(unwrap(std::declval<const Args&>()))...>>;
+
+} // namespace detail
+
+/**
+ * @brief Shared handle to the result of an asynchronous operation
+ *
+ * Returned by async_call() and the async_* operations. Copies refer to
+ * the same result, so one future can feed several later operations and
+ * be read from several threads. A default-constructed future has no
+ * result; every member but valid() then throws std::future_error.
+ */
+template <typename T>
+class Future {
+public:
+    using value_type = T;
+
+    Future() = default;
+
+    /**
+     * @brief Check if the future refers to an operation
+     */
+    bool valid() const { return state_ != nullptr; }
+
+    /**
+     * @brief Check, without blocking, if the result is available
+     */
+    bool ready() const {
+        check();
+        return state_->is_ready();
+    }
+
+    /**
+     * @brief Block until the result is available
+     */
+    void wait() const {
+        check();
+        state_->wait();
+    }
+
+    /**
+     * @brief The result, once available
+     *
+     * The reference is valid for as long as a copy of the future exists.
+     * @throws the exception of the operation, if it threw one
+     */
+    const T& get() const {
+        wait();
+        if (state_->error()) {
+            std::rethrow_exception(state_->error());
+        }
+        return state_->value();
+    }
+
+private:
+    friend struct detail::FutureAccess;
+
+    explicit Future(std::shared_ptr<detail::FutureState<T>> state)
+        : state_(std::move(state)) {}
+
+    void check() const {
+        if (!state_) {
+            throw std::future_error(std::future_errc::no_state);
+        }
+    }
+
+    std::shared_ptr<detail::FutureState<T>> state_;
+};
+
+/**
+ * @brief Run f(args...) as a job on the library thread pool
+ *
+ * Each argument is a Future, which is passed on as its result, a
+ * std::reference_wrapper, passed on as the reference, or any other
+ * value, moved into the job and passed as a const reference. The job
+ * starts once every Future argument is ready, so chains of calls form a
+ * dependency graph in which independent operations run concurrently.
+ * Waiting jobs take no thread. An exception thrown by f, or stored in a
+ * Future argument, is stored in the returned future.
+ *
+ * Jobs start in the order they become ready, after the parallel work of
+ * the jobs already running: under load, the latency of a job is bounded
+ * by the work submitted before it. When the library is single-threaded,
+ * see set_num_threads(), jobs run on the submitting thread before
+ * async_call() returns.
+ *
+ * Referenced objects must outlive the job and must not be modified until
+ * it is done.
+ * @throws std::future_error if a Future argument has no result
+ */
+template <typename F, typename... Args>
+Future<detail::AsyncResult<F, Args...>> async_call(F f, Args... args) {
+    using R = detail::AsyncResult<F, Args...>;
+    static_assert(!std::is_void_v<R>,
+                  "async_call() needs a function returning a value");
+
+    struct Job {
+        Job(F function, std::tuple<Args...> arguments,
+            std::shared_ptr<detail::FutureState<R>> state)
+            : f(std::move(function)), args(std::move(arguments)),
+              result(std::move(state)) {}
+
+        F f;
+        std::tuple<Args...> args;
+        std::shared_ptr<detail::FutureState<R>> result;
+        std::atomic<size_t> waiting{0};
+
+        void run() {
+            std::optional<R> value;
+            std::exception_ptr error;
+            try {
+                value.emplace(std::apply(
+                    [this](const auto&... a) {
+                        return std::invoke(f, detail::unwrap(a)...);
+                    },
+                    args));
+            } catch (...) {
+                error = std::current_exception();
+            }
+            if (error) {
+                result->set_error(std::move(error));
+            } else {
+                result->set_value(std::move(*value));
+            }
+        }
+    };
+
+    // Validated up front, so that an invalid argument leaves nothing
+    // registered.
+    auto dependencies = [](const auto&... a) {
+        size_t count = 0;
+        (([&] {
+             if constexpr (detail::IsFuture<std::decay_t<decltype(a)>>::value) {
+                 detail::FutureAccess::state(a);
+                 ++count;
+             }
+         }()),
+         ...);
+        return count;
+    };
+    const size_t count = dependencies(args...);
+
+    auto result = std::make_shared<detail::FutureState<R>>();
+    auto job = std::make_shared<Job>(
+        std::move(f), std::tuple<Args...>(std::move(args)...), result);
+    auto start = [job] { detail::submit_job([job] { job->run(); }); };
+    if (count == 0) {
+        start();
+        return detail::FutureAccess::make(std::move(result));
+    }
+
+    job->waiting.store(count, std::memory_order_relaxed);
+    auto arrive = [job, start] {
+        if (job->waiting.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            start();
+        }
+    };
+    std::apply(
+        [&](const auto&... a) {
+            (([&] {
+                 if constexpr (detail::IsFuture<
+                                   std::decay_t<decltype(a)>>::value) {
+                     detail::FutureAccess::state(a)->on_ready(arrive);
+                 }
+             }()),
+             ...);
+        },
+        job->args);
+    return detail::FutureAccess::make(std::move(result));
+}
+
+/**
+ * @brief Product of two matrices, views or futures of them, as a job
+ *
+ * See async_call() for the arguments: pass std::cref(m) to use a matrix
+ * without copying it into the job.
+ */
+template <typename A, typename B>
+auto async_multiply(A a, B b) {
+    return async_call(
+        [](const auto& x, const auto& y) {
+            using M =
+                BasicMatrix<typename std::decay_t<decltype(x)>::value_type>;
+            return M(x * y);
+        },
+        std::move(a), std::move(b));
+}
+
+/**
+ * @brief Sum of two matrices, views or futures of them, as a job
+ */
+template <typename A, typename B>
+auto async_add(A a, B b) {
+    return async_call(
+        [](const auto& x, const auto& y) {
+            using M =
+                BasicMatrix<typename std::decay_t<decltype(x)>::value_type>;
+            return M(x + y);
+        },
+        std::move(a), std::move(b));
+}
+
+/**
+ * @brief Transpose of a matrix, view or future of one, as a job
+ */
+template <typename A>
+auto async_transpose(A a) {
+    return async_call([](const auto& x) { return x.transpose(); },
+                      std::move(a));
+}
+
+} // namespace matrixops
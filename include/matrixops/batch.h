@@ -0,0 +1,224 @@
+#pragma once
+
+#include <cassert>
+#include <complex>
+#include <cstddef>
+#include <vector>
+
+#include "matrixops/allocator.h"
+#include "matrixops/matrix.h"
+
+namespace matrixops {
+
+namespace detail {
+
+/**
+ * @brief Matrices per interleaved group of a BasicMatrixBatch: one
+ * element of each fills a 64-byte line, a single AVX-512 register
+ */
+template <typename T>
+constexpr size_t BATCH_LANES = 64 / sizeof(T);
+
+} // namespace detail
+
+/**
+ * @brief Batch of equally sized small matrices in an interleaved layout
+ *
+ * The batch is stored in groups of LANES matrices. Within a group the
+ * matrices are interleaved element by element: element (i, j) of matrix b
+ * is at
+ *
+ *     data()[(b / LANES * rows * cols + i * cols + j) * LANES + b % LANES]
+ *
+ * so one vector register holds the same element of LANES matrices, and
+ * the SIMD kernels process a whole group as a single matrix of vectors.
+ * This pays off for sizes up to about 64 x 64, where a single product is
+ * too small to fill the registers by itself. The last group is padded
+ * with zero matrices. The element type T is float, double,
+ * std::complex<float> or std::complex<double>; MatrixBatch is the double
+ * version.
+ */
+template <typename T>
+class BasicMatrixBatch {
+public:
+    using value_type = T;
+
+    /// Matrices per interleaved group
+    static constexpr size_t LANES = detail::BATCH_LANES<T>;
+
+    /**
+     * @brief Construct count matrices of rows x cols
+     * @param init_value Initial value for all elements (default: 0.0)
+     * @throws std::invalid_argument if any dimension is 0
+     */
+    BasicMatrixBatch(size_t count, size_t rows, size_t cols,
+                     T init_value = T(0));
+
+    /**
+     * @brief Get number of matrices
+     */
+    size_t count() const { return count_; }
+
+    /**
+     * @brief Get number of rows of each matrix
+     */
+    size_t rows() const { return rows_; }
+
+    /**
+     * @brief Get number of columns of each matrix
+     */
+    size_t cols() const { return cols_; }
+
+    /**
+     * @brief Access element (i, j) of matrix b
+     * @throws std::out_of_range if an index is out of range
+     */
+    T& operator()(size_t b, size_t i, size_t j);
+
+    /**
+     * @brief Access element (i, j) of matrix b (const version)
+     */
+    T operator()(size_t b, size_t i, size_t j) const;
+
+    /**
+     * @brief Access element (i, j) of matrix b without bounds checking
+     */
+    T& unchecked(size_t b, size_t i, size_t j) {
+        assert(b < count_ && i < rows_ && j < cols_);
+        return data_[offset(b, i, j)];
+    }
+
+    /**
+     * @brief Access element (i, j) of matrix b without bounds checking
+     * (const version)
+     */
+    T unchecked(size_t b, size_t i, size_t j) const {
+        assert(b < count_ && i < rows_ && j < cols_);
+        return data_[offset(b, i, j)];
+    }
+
+    /**
+     * @brief Copy matrix b out of the batch
+     * @throws std::out_of_range if b is out of range
+     */
+    BasicMatrix<T> matrix(size_t b) const;
+
+    /**
+     * @brief Overwrite matrix b with m
+     * @throws std::out_of_range if b is out of range
+     * @throws std::invalid_argument if m is not rows() x cols()
+     */
+    void set_matrix(size_t b, const BasicMatrix<T>& m);
+
+    /**
+     * @brief Pointer to the interleaved storage, including the padding of
+     * the last group
+     */
+    T* data() { return data_.data(); }
+
+    /**
+     * @brief Pointer to the interleaved storage (const version)
+     */
+    const T* data() const { return data_.data(); }
+
+    /**
+     * @brief Number of interleaved groups, count() / LANES rounded up
+     */
+    size_t groups() const { return (count_ + LANES - 1) / LANES; }
+
+private:
+    size_t count_;
+    size_t rows_;
+    size_t cols_;
+    std::vector<T, detail::StorageAllocator<T>> data_;
+
+    size_t offset(size_t b, size_t i, size_t j) const {
+        return (b / LANES * rows_ * cols_ + i * cols_ + j) * LANES +
+               b % LANES;
+    }
+};
+
+/**
+ * @brief Batch of double matrices, the default element type
+ */
+using MatrixBatch = BasicMatrixBatch<double>;
+
+/**
+ * @brief Compute c = alpha * a * b + beta * c for every matrix of the
+ * batches
+ *
+ * The groups are split across the thread pool. c is not read when beta is
+ * zero.
+ * @throws std::invalid_argument if the counts differ, the dimensions are
+ * incompatible, or c is a or b
+ */
+template <typename T>
+void gemm(T alpha, const BasicMatrixBatch<T>& a, const BasicMatrixBatch<T>& b,
+          T beta, BasicMatrixBatch<T>& c);
+
+/**
+ * @brief Compute out = a * b for every matrix of the batches
+ * @throws std::invalid_argument as gemm()
+ */
+template <typename T>
+void multiply_into(const BasicMatrixBatch<T>& a, const BasicMatrixBatch<T>& b,
+                   BasicMatrixBatch<T>& out);
+
+/**
+ * @brief Compute out = a + b for every matrix of the batches
+ *
+ * out may be a or b.
+ * @throws std::invalid_argument if the counts or dimensions differ
+ */
+template <typename T>
+void add_into(const BasicMatrixBatch<T>& a, const BasicMatrixBatch<T>& b,
+              BasicMatrixBatch<T>& out);
+
+/**
+ * @brief Transpose every matrix of a into out
+ * @throws std::invalid_argument if out is not a batch of as many
+ * a.cols() x a.rows() matrices, or out is a
+ */
+template <typename T>
+void transpose_into(const BasicMatrixBatch<T>& a, BasicMatrixBatch<T>& out);
+
+/**
+ * @brief Compute out[i] = a[i] * b[i] for count existing matrices
+ *
+ * The pointer-array form of the batched product, for matrices that live
+ * elsewhere and would otherwise have to be copied into a batch; the sizes
+ * may differ from one product to the next. The products are split across
+ * the thread pool and do not allocate in the steady state.
+ * @throws std::invalid_argument if any product is invalid for
+ * multiply_into(); no output is written then
+ */
+template <typename T>
+void multiply_into(const BasicMatrix<T>* const* a,
+                   const BasicMatrix<T>* const* b, BasicMatrix<T>* const* out,
+                   size_t count);
+
+/**
+ * @brief Compute out[i] = a[i] + b[i] for count existing matrices
+ * @throws std::invalid_argument if any sum is invalid for add_into(); no
+ * output is written then
+ */
+template <typename T>
+void add_into(const BasicMatrix<T>* const* a, const BasicMatrix<T>* const* b,
+              BasicMatrix<T>* const* out, size_t count);
+
+/**
+ * @brief Transpose count existing matrices, out[i] = a[i]^T
+ * @throws std::invalid_argument if any out[i] does not have the
+ * transposed dimensions of a[i], or is a[i]; no output is written then
+ */
+template <typename T>
+void transpose_into(const BasicMatrix<T>* const* a, BasicMatrix<T>* const* out,
+                    size_t count);
+
+// Compiled into the library for these element types.
+extern template class BasicMatrixBatch<float>;
+extern template class BasicMatrixBatch<double>;
+extern template class BasicMatrixBatch<std::complex<float>>;
+extern template class BasicMatrixBatch<std::complex<double>>;
+
+} // namespace matrixops
@@ -0,0 +1,270 @@
+#pragma once
+
+#include <complex>
+#include <cstddef>
+#include <vector>
+
+#include "matrixops/matrix.h"
+#include "matrixops/vector.h"
+
+namespace matrixops {
+
+/**
+ * @brief Get the panel width of the blocked factorizations
+ *
+ * BasicLU, BasicCholesky and BasicQR factor panels of this many columns
+ * and apply each one to the trailing matrix with gemm(), so the bulk of
+ * the work runs on the GEMM kernel and thread pool. The default is 128.
+ */
+size_t decomposition_block_size();
+
+/**
+ * @brief Set the panel width of the blocked factorizations
+ * @throws std::invalid_argument if block is zero
+ */
+void set_decomposition_block_size(size_t block);
+
+/**
+ * @brief LU factorization with partial pivoting, P A = L U
+ *
+ * Blocked and right-looking: each panel is factored recursively, with the
+ * pivot search and row updates of its leaves split across the thread
+ * pool, and the trailing matrix is updated with gemm(). L is unit lower
+ * triangular and U upper triangular; both are stored in packed(). The
+ * element type T is float, double, std::complex<float> or
+ * std::complex<double>; LU is the double version.
+ */
+template <typename T>
+class BasicLU {
+public:
+    using value_type = T;
+
+    /**
+     * @brief Factor the square matrix a
+     *
+     * A singular matrix is factored all the same, see is_singular().
+     * @throws std::invalid_argument if a is not square
+     */
+    explicit BasicLU(const BasicMatrix<T>& a);
+
+    /**
+     * @brief Get the order of the factored matrix
+     */
+    size_t size() const { return lu_.rows(); }
+
+    /**
+     * @brief L below the diagonal, without its unit diagonal, and U on and
+     * above it
+     */
+    const BasicMatrix<T>& packed() const { return lu_; }
+
+    /**
+     * @brief Row interchanges: row i was swapped with row pivots()[i] at
+     * step i, as the LAPACK ipiv but 0-based
+     */
+    const std::vector<size_t>& pivots() const { return pivots_; }
+
+    /**
+     * @brief Check if U has an exactly zero diagonal element
+     */
+    bool is_singular() const { return singular_; }
+
+    /**
+     * @brief Copy out the unit lower triangular factor L
+     */
+    BasicMatrix<T> lower() const;
+
+    /**
+     * @brief Copy out the upper triangular factor U
+     */
+    BasicMatrix<T> upper() const;
+
+    /**
+     * @brief Determinant of the factored matrix
+     */
+    T determinant() const;
+
+    /**
+     * @brief Solve A X = B for every column of b
+     * @throws std::invalid_argument if b.rows() is not size()
+     * @throws std::domain_error if the matrix is singular
+     */
+    BasicMatrix<T> solve(const BasicMatrix<T>& b) const;
+
+    /**
+     * @brief Solve A x = b
+     * @throws std::invalid_argument if b.size() is not size()
+     * @throws std::domain_error if the matrix is singular
+     */
+    BasicVector<T> solve(const BasicVector<T>& b) const;
+
+    /**
+     * @brief Solve A X = B, overwriting b with X
+     * @throws as solve()
+     */
+    void solve_inplace(BasicMatrix<T>& b) const;
+
+private:
+    BasicMatrix<T> lu_;
+    std::vector<size_t> pivots_;
+    bool singular_ = false;
+};
+
+/**
+ * @brief LU factorization of double matrices
+ */
+using LU = BasicLU<double>;
+
+/**
+ * @brief Cholesky factorization of a Hermitian positive definite matrix,
+ * A = L L^H
+ *
+ * Blocked and right-looking like BasicLU: the off-diagonal part of each
+ * panel is a triangular solve, and the trailing update L21 L21^H is done
+ * with gemm() on the lower triangle only. Half the work of BasicLU and no
+ * pivoting. Only the lower triangle of the input is read.
+ */
+template <typename T>
+class BasicCholesky {
+public:
+    using value_type = T;
+
+    /**
+     * @brief Factor the square matrix a
+     * @throws std::invalid_argument if a is not square
+     * @throws std::domain_error if a is not positive definite
+     */
+    explicit BasicCholesky(const BasicMatrix<T>& a);
+
+    /**
+     * @brief Get the order of the factored matrix
+     */
+    size_t size() const { return l_.rows(); }
+
+    /**
+     * @brief The lower triangular factor L, zero above the diagonal
+     */
+    const BasicMatrix<T>& lower() const { return l_; }
+
+    /**
+     * @brief Solve A X = B for every column of b
+     * @throws std::invalid_argument if b.rows() is not size()
+     */
+    BasicMatrix<T> solve(const BasicMatrix<T>& b) const;
+
+    /**
+     * @brief Solve A x = b
+     * @throws std::invalid_argument if b.size() is not size()
+     */
+    BasicVector<T> solve(const BasicVector<T>& b) const;
+
+    /**
+     * @brief Solve A X = B, overwriting b with X
+     * @throws as solve()
+     */
+    void solve_inplace(BasicMatrix<T>& b) const;
+
+private:
+    BasicMatrix<T> l_;
+};
+
+/**
+ * @brief Cholesky factorization of double matrices
+ */
+using Cholesky = BasicCholesky<double>;
+
+/**
+ * @brief Householder QR factorization, A = Q R
+ *
+ * A is m x n with m >= n. Each panel is factored recursively and its
+ * reflectors are accumulated into the compact WY form H = I - V T V^H
+ * (Schreiber and Van Loan), so that applying Q or Q^H to the trailing
+ * matrix, or to right-hand sides, is three gemm() calls per panel. Q is
+ * kept implicitly as the Householder vectors below the diagonal of
+ * packed().
+ */
+template <typename T>
+class BasicQR {
+public:
+    using value_type = T;
+
+    /**
+     * @brief Factor the m x n matrix a
+     * @throws std::invalid_argument if a has more columns than rows
+     */
+    explicit BasicQR(const BasicMatrix<T>& a);
+
+    /**
+     * @brief Get number of rows of the factored matrix
+     */
+    size_t rows() const { return qr_.rows(); }
+
+    /**
+     * @brief Get number of columns of the factored matrix
+     */
+    size_t cols() const { return qr_.cols(); }
+
+    /**
+     * @brief R on and above the diagonal, the Householder vectors without
+     * their unit first element below it
+     */
+    const BasicMatrix<T>& packed() const { return qr_; }
+
+    /**
+     * @brief Form the first cols() columns of Q, which are orthonormal
+     */
+    BasicMatrix<T> q() const;
+
+    /**
+     * @brief Copy out the cols() x cols() upper triangular factor R
+     */
+    BasicMatrix<T> r() const;
+
+    /**
+     * @brief Least-squares solution of A X = B for every column of b
+     *
+     * Minimizes the 2-norm of each column of A X - B; for a square A this
+     * is the solution of the system.
+     * @throws std::invalid_argument if b.rows() is not rows()
+     * @throws std::domain_error if R has an exactly zero diagonal element
+     */
+    BasicMatrix<T> solve(const BasicMatrix<T>& b) const;
+
+    /**
+     * @brief Least-squares solution of A x = b
+     * @throws std::invalid_argument if b.size() is not rows()
+     * @throws std::domain_error if R has an exactly zero diagonal element
+     */
+    BasicVector<T> solve(const BasicVector<T>& b) const;
+
+private:
+    BasicMatrix<T> qr_;
+    // The triangular factor T of each panel, at rows 0..width and the
+    // panel's columns.
+    BasicMatrix<T> t_;
+    size_t block_;
+
+    // b = Q^H b on all rows() rows of b.
+    void apply_adjoint(T* b, size_t ldb, size_t ncols) const;
+};
+
+/**
+ * @brief QR factorization of double matrices
+ */
+using QR = BasicQR<double>;
+
+// Compiled into the library for these element types.
+extern template class BasicLU<float>;
+extern template class BasicLU<double>;
+extern template class BasicLU<std::complex<float>>;
+extern template class BasicLU<std::complex<double>>;
+extern template class BasicCholesky<float>;
+extern template class BasicCholesky<double>;
+extern template class BasicCholesky<std::complex<float>>;
+extern template class BasicCholesky<std::complex<double>>;
+extern template class BasicQR<float>;
+extern template class BasicQR<double>;
+extern template class BasicQR<std::complex<float>>;
+extern template class BasicQR<std::complex<double>>;
+
+} // namespace matrixops
@@ -0,0 +1,178 @@
+#pragma once
+
+#include <cstddef>
+#include <type_traits>
+
+#include "matrixops/matrix.h"
+
+namespace matrixops {
+
+/**
+ * @brief Name of the device backend DeviceMatrix runs on
+ *
+ * "cuda" or "hip", as selected with MATRIXOPS_DEVICE_BACKEND at configure
+ * time, or "none" when the library was built without one.
+ */
+const char* device_backend();
+
+/**
+ * @brief Number of devices the backend can use: 0 without a backend, or
+ * when the machine has no usable device
+ */
+size_t device_count();
+
+/**
+ * @brief Block until every operation queued on the device is done
+ *
+ * Needed after the asynchronous transfers of BasicDeviceMatrix only; the
+ * other operations queue work that uses device memory alone, and results
+ * reach the host through synchronous transfers or norm(), which wait.
+ * @throws std::runtime_error if the device reports an error
+ */
+void device_synchronize();
+
+/**
+ * @brief Dense row-major matrix resident in device memory
+ *
+ * Elements live on the current device of the calling thread when the
+ * backend is first used; operations run there and their results stay
+ * there, so chains such as (a * b + c).transpose() never go through host
+ * memory. Every operation is queued, in order, on one stream of the
+ * library: it returns as soon as the work is queued, and later operations
+ * see its result.
+ *
+ * Products go through cuBLAS or hipBLAS; sums, scaling and transposes run
+ * on native kernels. Only float and double are supported.
+ *
+ * Data moves between host and device through the constructor from a view
+ * and to_matrix(), which wait for the copy, or through upload_async() and
+ * download_async(), which only queue it.
+ * @throws std::runtime_error from every constructor if the library was
+ * built without a device backend or the device reports an error
+ */
+template <typename T>
+class BasicDeviceMatrix {
+    static_assert(std::is_same_v<T, float> || std::is_same_v<T, double>,
+                  "Device matrices hold float or double");
+
+public:
+    using value_type = T;
+
+    /**
+     * @brief Allocate a rows x cols matrix with uninitialized elements
+     * @throws std::invalid_argument if rows or cols is 0
+     */
+    BasicDeviceMatrix(size_t rows, size_t cols);
+
+    /**
+     * @brief Copy a matrix or view of any layout to the device, waiting for
+     * the copy to finish
+     */
+    explicit BasicDeviceMatrix(BasicMatrixView<const T> m);
+
+    BasicDeviceMatrix(const BasicDeviceMatrix& other);
+    BasicDeviceMatrix(BasicDeviceMatrix&& other) noexcept;
+    BasicDeviceMatrix& operator=(const BasicDeviceMatrix& other);
+    BasicDeviceMatrix& operator=(BasicDeviceMatrix&& other) noexcept;
+    ~BasicDeviceMatrix();
+
+    /**
+     * @brief Get number of rows
+     */
+    size_t rows() const { return rows_; }
+
+    /**
+     * @brief Get number of columns
+     */
+    size_t cols() const { return cols_; }
+
+    /**
+     * @brief Device pointer to the elements, rows packed one after the
+     * other, for use with the backend's own libraries
+     */
+    T* data() { return data_; }
+
+    /**
+     * @brief Read-only device pointer to the elements
+     */
+    const T* data() const { return data_; }
+
+    /**
+     * @brief Copy the matrix to the host, waiting for the copy to finish
+     */
+    BasicMatrix<T> to_matrix() const;
+
+    /**
+     * @brief Queue a copy of src into the matrix
+     *
+     * src must stay alive and unchanged until device_synchronize()
+     * returns. The copy only overlaps with host work when src is in
+     * page-locked memory; otherwise the backend may copy synchronously.
+     * @throws std::invalid_argument if the dimensions differ or src is not
+     * row-major
+     */
+    void upload_async(BasicMatrixView<const T> src);
+
+    /**
+     * @brief Queue a copy of the matrix into dst, complete once
+     * device_synchronize() returns
+     * @throws std::invalid_argument if the dimensions differ or dst is not
+     * row-major
+     */
+    void download_async(BasicMatrixView<T> dst) const;
+
+    /**
+     * @brief Matrix addition
+     * @throws std::invalid_argument if the dimensions differ
+     */
+    BasicDeviceMatrix operator+(const BasicDeviceMatrix& other) const;
+
+    /**
+     * @brief In-place matrix addition
+     * @throws std::invalid_argument if the dimensions differ
+     */
+    BasicDeviceMatrix& operator+=(const BasicDeviceMatrix& other);
+
+    /**
+     * @brief Matrix multiplication
+     * @throws std::invalid_argument if the inner dimensions differ
+     */
+    BasicDeviceMatrix operator*(const BasicDeviceMatrix& other) const;
+
+    /**
+     * @brief Scalar multiplication
+     */
+    BasicDeviceMatrix operator*(T scalar) const;
+
+    /**
+     * @brief In-place scalar multiplication
+     */
+    BasicDeviceMatrix& operator*=(T scalar);
+
+    /**
+     * @brief Transpose
+     */
+    BasicDeviceMatrix transpose() const;
+
+    /**
+     * @brief Calculate Frobenius norm, waiting for the queued work
+     */
+    T norm() const;
+
+private:
+    size_t rows_;
+    size_t cols_;
+    T* data_;
+
+    size_t size() const { return rows_ * cols_; }
+};
+
+/**
+ * @brief Device matrix of double, the default element type
+ */
+using DeviceMatrix = BasicDeviceMatrix<double>;
+
+extern template class BasicDeviceMatrix<float>;
+extern template class BasicDeviceMatrix<double>;
+
+} // namespace matrixops
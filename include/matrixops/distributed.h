@@ -0,0 +1,271 @@
+#pragma once
+
+#include <complex>
+#include <cstddef>
+#include <memory>
+#include <optional>
+
+#include <mpi.h>
+
+#include "matrixops/matrix.h"
+#include "matrixops/storage.h"
+
+namespace matrixops {
+
+/**
+ * @brief Default side, in elements, of the blocks of a distributed matrix
+ */
+constexpr size_t DISTRIBUTED_BLOCK = 128;
+
+/**
+ * @brief Two-dimensional grid of the processes of an MPI communicator
+ *
+ * Rank r is at grid row r / cols() and column r % cols(). The grid works
+ * on duplicates of the communicator, so its traffic never matches the
+ * application's messages, with errors returned rather than fatal: MPI
+ * failures throw std::runtime_error.
+ *
+ * Distributed operations are collective: every process of the grid calls
+ * them, in the same order. They call MPI from the calling thread only, so
+ * MPI_THREAD_FUNNELED is enough, and run their local work on the library
+ * thread pool.
+ */
+class ProcessGrid {
+public:
+    /**
+     * @brief Arrange the processes of comm in a near-square grid, as
+     * MPI_Dims_create() does
+     */
+    explicit ProcessGrid(MPI_Comm comm);
+
+    /**
+     * @brief Arrange the processes of comm in a rows x cols grid
+     * @throws std::invalid_argument if rows * cols is not the size of comm
+     */
+    ProcessGrid(MPI_Comm comm, int rows, int cols);
+
+    ProcessGrid(const ProcessGrid&) = delete;
+    ProcessGrid& operator=(const ProcessGrid&) = delete;
+    ~ProcessGrid();
+
+    /**
+     * @brief Number of process rows
+     */
+    int rows() const { return rows_; }
+
+    /**
+     * @brief Number of process columns
+     */
+    int cols() const { return cols_; }
+
+    /**
+     * @brief Grid row of the calling process
+     */
+    int row() const { return row_; }
+
+    /**
+     * @brief Grid column of the calling process
+     */
+    int col() const { return col_; }
+
+    /**
+     * @brief The whole grid, with ranks in row-major grid order
+     */
+    MPI_Comm comm() const { return comm_; }
+
+    /**
+     * @brief The processes of the caller's grid row, ranked by column
+     */
+    MPI_Comm row_comm() const { return row_comm_; }
+
+    /**
+     * @brief The processes of the caller's grid column, ranked by row
+     */
+    MPI_Comm col_comm() const { return col_comm_; }
+
+private:
+    MPI_Comm comm_ = MPI_COMM_NULL;
+    MPI_Comm row_comm_ = MPI_COMM_NULL;
+    MPI_Comm col_comm_ = MPI_COMM_NULL;
+    int rows_ = 0;
+    int cols_ = 0;
+    int row_ = 0;
+    int col_ = 0;
+};
+
+/**
+ * @brief Dense matrix distributed 2D block-cyclically over a ProcessGrid
+ *
+ * The matrix is cut into block x block tiles; tile (I, J) belongs to the
+ * process at grid row I % rows() and column J % cols(), as in ScaLAPACK.
+ * Each process keeps its tiles in one row-major local matrix, tile
+ * (I, J) at local tile (I / rows(), J / cols()), so a process row holds
+ * the same local rows and a process column the same local columns: that
+ * is what lets products broadcast whole panels.
+ *
+ * Every member but the accessors is collective over the grid.
+ */
+template <typename T>
+class BasicDistributedMatrix {
+public:
+    using value_type = T;
+    using real_type = typename detail::ScalarTraits<T>::real_type;
+
+    /**
+     * @brief Construct a rows x cols matrix of zeros
+     * @throws std::invalid_argument if a dimension or block is 0
+     */
+    BasicDistributedMatrix(std::shared_ptr<const ProcessGrid> grid,
+                           size_t rows, size_t cols,
+                           size_t block = DISTRIBUTED_BLOCK);
+
+    /**
+     * @brief Distribute a matrix every process holds a copy of; each keeps
+     * its own tiles, without communication
+     */
+    static BasicDistributedMatrix
+    from_global(std::shared_ptr<const ProcessGrid> grid,
+                BasicMatrixView<const T> m, size_t block = DISTRIBUTED_BLOCK);
+
+    /**
+     * @brief Send the tiles of a matrix held by the root process to their
+     * owners
+     * @param m The matrix, read on root only: other processes may pass
+     * nullptr
+     */
+    static BasicDistributedMatrix
+    scatter(std::shared_ptr<const ProcessGrid> grid, const BasicMatrix<T>* m,
+            int root = 0, size_t block = DISTRIBUTED_BLOCK);
+
+    /**
+     * @brief Collect the matrix on the root process, with its rank in
+     * grid().comm(); the other processes get std::nullopt
+     */
+    std::optional<BasicMatrix<T>> gather(int root = 0) const;
+
+    /**
+     * @brief Collect the whole matrix on every process
+     */
+    BasicMatrix<T> to_matrix() const;
+
+    /**
+     * @brief Get number of rows
+     */
+    size_t rows() const { return rows_; }
+
+    /**
+     * @brief Get number of columns
+     */
+    size_t cols() const { return cols_; }
+
+    /**
+     * @brief Side of the tiles
+     */
+    size_t block_size() const { return block_; }
+
+    const ProcessGrid& grid() const { return *grid_; }
+
+    /**
+     * @brief Rows of the local matrix of the calling process; may be 0
+     */
+    size_t local_rows() const { return local_rows_; }
+
+    /**
+     * @brief Columns of the local matrix of the calling process; may be 0
+     */
+    size_t local_cols() const { return local_cols_; }
+
+    /**
+     * @brief The tiles of the calling process, as one row-major matrix
+     */
+    BasicMatrixView<T> local() {
+        return BasicMatrixView<T>(local_.data(), local_rows_, local_cols_,
+                                  local_cols_);
+    }
+
+    /**
+     * @brief Read-only view of the tiles of the calling process
+     */
+    BasicMatrixView<const T> local() const {
+        return BasicMatrixView<const T>(local_.data(), local_rows_,
+                                        local_cols_, local_cols_);
+    }
+
+    /**
+     * @brief Global row of local row li
+     */
+    size_t global_row(size_t li) const {
+        return global_index(li, grid_->rows(), grid_->row());
+    }
+
+    /**
+     * @brief Global column of local column lj
+     */
+    size_t global_col(size_t lj) const {
+        return global_index(lj, grid_->cols(), grid_->col());
+    }
+
+    /**
+     * @brief Transpose, with the same block size, exchanging each tile
+     * with its mirror's owner in one all-to-all
+     */
+    BasicDistributedMatrix transpose() const;
+
+    /**
+     * @brief Matrix multiplication, SUMMA-style
+     *
+     * One k-panel of tiles at a time, A's broadcast along process rows and
+     * B's along process columns, each process accumulating the product of
+     * the panels into its tiles of C with gemm(). The broadcasts of the
+     * next panels are posted before that product, so communication
+     * overlaps with it as far as the MPI library progresses nonblocking
+     * collectives in the background.
+     * @throws std::invalid_argument if the inner dimensions differ or the
+     * operands have different grids or block sizes
+     */
+    BasicDistributedMatrix operator*(const BasicDistributedMatrix& other)
+        const;
+
+    /**
+     * @brief Calculate Frobenius norm: local sums of squares, combined by
+     * one allreduce
+     *
+     * In ReductionMode::EXACT the local sums are exact and combined as
+     * integers, so the norm is the same for every process grid and block
+     * size; in the other modes it depends on them.
+     */
+    real_type norm() const;
+
+private:
+    std::shared_ptr<const ProcessGrid> grid_;
+    size_t rows_;
+    size_t cols_;
+    size_t block_;
+    size_t local_rows_;
+    size_t local_cols_;
+    detail::MatrixStorage<T> local_;
+
+    // Local elements left uninitialized.
+    BasicDistributedMatrix(std::shared_ptr<const ProcessGrid> grid,
+                           size_t rows, size_t cols, size_t block,
+                           UninitializedTag);
+
+    size_t global_index(size_t local, int processes, int coordinate) const {
+        const size_t p = static_cast<size_t>(processes);
+        return (local / block_ * p + static_cast<size_t>(coordinate)) *
+                   block_ +
+               local % block_;
+    }
+};
+
+/**
+ * @brief Distributed matrix of double, the default element type
+ */
+using DistributedMatrix = BasicDistributedMatrix<double>;
+
+extern template class BasicDistributedMatrix<float>;
+extern template class BasicDistributedMatrix<double>;
+extern template class BasicDistributedMatrix<std::complex<float>>;
+extern template class BasicDistributedMatrix<std::complex<double>>;
+
+} // namespace matrixops
@@ -0,0 +1,124 @@
+#pragma once
+
+#include <cstddef>
+#include <stdexcept>
+#include <type_traits>
+
+namespace matrixops {
+
+template <typename T>
+class BasicMatrix;
+
+/**
+ * @brief CRTP base of every lazily evaluated matrix expression
+ *
+ * An expression type E provides value_type, rows(), cols() and coeff(k),
+ * the value of the k-th element in row-major order. Expressions are
+ * evaluated in a single fused loop when assigned to a BasicMatrix of the
+ * same value_type.
+ *
+ * Expression nodes hold Matrix operands by reference, so an expression
+ * must not outlive its operands: store results in a Matrix rather than
+ * in an `auto` variable.
+ */
+template <typename Derived>
+class MatrixExpression {
+public:
+    const Derived& derived() const {
+        return static_cast<const Derived&>(*this);
+    }
+};
+
+namespace detail {
+
+// Leaves are held by reference, intermediate nodes by value.
+template <typename E>
+struct ExpressionRef {
+    using type = const E;
+};
+
+template <typename T>
+struct ExpressionRef<BasicMatrix<T>> {
+    using type = const BasicMatrix<T>&;
+};
+
+} // namespace detail
+
+/**
+ * @brief Lazy element-wise sum of two expressions
+ */
+template <typename L, typename R>
+class MatrixSum : public MatrixExpression<MatrixSum<L, R>> {
+public:
+    static_assert(std::is_same_v<typename L::value_type,
+                                 typename R::value_type>,
+                  "Matrix expressions must have the same element type");
+
+    using value_type = typename L::value_type;
+
+    MatrixSum(const L& lhs, const R& rhs) : lhs_(lhs), rhs_(rhs) {
+        if (lhs.rows() != rhs.rows() || lhs.cols() != rhs.cols()) {
+            throw std::invalid_argument(
+                "Matrix dimensions must match for addition");
+        }
+    }
+
+    size_t rows() const { return lhs_.rows(); }
+    size_t cols() const { return lhs_.cols(); }
+    value_type coeff(size_t k) const {
+        return lhs_.coeff(k) + rhs_.coeff(k);
+    }
+
+    const L& lhs() const { return lhs_; }
+    const R& rhs() const { return rhs_; }
+
+private:
+    typename detail::ExpressionRef<L>::type lhs_;
+    typename detail::ExpressionRef<R>::type rhs_;
+};
+
+/**
+ * @brief Lazy product of an expression and a scalar
+ */
+template <typename E>
+class MatrixScaled : public MatrixExpression<MatrixScaled<E>> {
+public:
+    using value_type = typename E::value_type;
+
+    MatrixScaled(const E& expr, value_type scalar)
+        : expr_(expr), scalar_(scalar) {}
+
+    size_t rows() const { return expr_.rows(); }
+    size_t cols() const { return expr_.cols(); }
+    value_type coeff(size_t k) const { return expr_.coeff(k) * scalar_; }
+
+    const E& expression() const { return expr_; }
+    value_type scalar() const { return scalar_; }
+
+private:
+    typename detail::ExpressionRef<E>::type expr_;
+    value_type scalar_;
+};
+
+/**
+ * @brief Matrix addition
+ * @throws std::invalid_argument if the dimensions differ
+ */
+template <typename L, typename R>
+MatrixSum<L, R> operator+(const MatrixExpression<L>& lhs,
+                          const MatrixExpression<R>& rhs) {
+    return MatrixSum<L, R>(lhs.derived(), rhs.derived());
+}
+
+/**
+ * @brief Scalar multiplication
+ *
+ * The scalar is converted to the element type of the expression.
+ */
+template <typename E>
+MatrixScaled<E> operator*(const MatrixExpression<E>& expr,
+                          typename E::value_type scalar) {
+    return MatrixScaled<E>(expr.derived(), scalar);
+}
+
+} // namespace matrixops
@@ -0,0 +1,315 @@
+#pragma once
+
+#include <cassert>
+#include <cmath>
+#include <complex>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include "matrixops/expression.h"
+#include "matrixops/matrix.h"
+
+namespace matrixops {
+
+namespace detail {
+
+template <typename T>
+constexpr auto abs_squared(const T& x) {
+    return x * x;
+}
+
+template <typename R>
+constexpr R abs_squared(const std::complex<R>& z) {
+    return z.real() * z.real() + z.imag() * z.imag();
+}
+
+} // namespace detail
+
+/**
+ * @brief Matrix with compile-time dimensions and inline storage
+ *
+ * For the many tiny products of transforms and small covariance updates:
+ * no allocation, no dispatch, and every operation below is unrolled over
+ * the R x C elements at compile time. Operations whose dimensions do not
+ * match fail to compile instead of throwing.
+ *
+ * A FixedMatrix is also a MatrixExpression, so it converts to a
+ * BasicMatrix<T> (`Matrix m = f;`) and can appear in expressions with
+ * dynamic matrices, which are checked at run time as usual.
+ */
+template <typename T, size_t R, size_t C>
+class FixedMatrix : public MatrixExpression<FixedMatrix<T, R, C>> {
+public:
+    static_assert(R > 0 && C > 0, "Matrix dimensions must be positive");
+
+    using value_type = T;
+    using real_type = typename detail::ScalarTraits<T>::real_type;
+
+    /**
+     * @brief Construct a zero matrix
+     */
+    constexpr FixedMatrix() : data_{} {}
+
+    /**
+     * @brief Construct a matrix with every element set to init_value
+     */
+    constexpr explicit FixedMatrix(T init_value) : data_{} {
+        fill(init_value, std::make_index_sequence<R * C>{});
+    }
+
+    /**
+     * @brief Construct from all R * C elements in row-major order, e.g.
+     * `FixedMatrix<double, 2, 2> m(1, 2, 3, 4)`
+     */
+    template <typename... Values,
+              typename = std::enable_if_t<(sizeof...(Values) == R * C) &&
+                                          (R * C > 1)>>
+    constexpr FixedMatrix(Values... values)
+        : data_{static_cast<T>(values)...} {}
+
+    /**
+     * @brief Copy a dynamic matrix of the same dimensions
+     * @throws std::invalid_argument if m is not R x C
+     */
+    explicit FixedMatrix(const BasicMatrix<T>& m) : data_{} {
+        if (m.rows() != R || m.cols() != C) {
+            throw std::invalid_argument(
+                "Matrix dimensions must match the fixed size");
+        }
+        for (size_t i = 0; i < R; ++i) {
+            for (size_t j = 0; j < C; ++j) {
+                data_[i * C + j] = m.unchecked(i, j);
+            }
+        }
+    }
+
+    /**
+     * @brief Create an identity matrix
+     */
+    static constexpr FixedMatrix identity() {
+        static_assert(R == C, "Identity matrix must be square");
+        FixedMatrix result;
+        for (size_t i = 0; i < R; ++i) {
+            result.data_[i * C + i] = T(1);
+        }
+        return result;
+    }
+
+    /**
+     * @brief Get number of rows
+     */
+    static constexpr size_t rows() { return R; }
+
+    /**
+     * @brief Get number of columns
+     */
+    static constexpr size_t cols() { return C; }
+
+    /**
+     * @brief Check if matrix is square
+     */
+    static constexpr bool is_square() { return R == C; }
+
+    /**
+     * @brief Access element at (i, j)
+     *
+     * Like BasicMatrix::unchecked(), the indices are only checked, with
+     * assert(), in debug builds; get<I, J>() checks them at compile time.
+     */
+    constexpr T& operator()(size_t i, size_t j) {
+        assert(i < R && j < C);
+        return data_[i * C + j];
+    }
+
+    /**
+     * @brief Access element at (i, j) (const version)
+     */
+    constexpr T operator()(size_t i, size_t j) const {
+        assert(i < R && j < C);
+        return data_[i * C + j];
+    }
+
+    /**
+     * @brief Access element (I, J), with the indices checked at compile
+     * time
+     */
+    template <size_t I, size_t J>
+    constexpr T& get() {
+        static_assert(I < R && J < C, "Matrix indices out of range");
+        return data_[I * C + J];
+    }
+
+    /**
+     * @brief Access element (I, J) (const version)
+     */
+    template <size_t I, size_t J>
+    constexpr T get() const {
+        static_assert(I < R && J < C, "Matrix indices out of range");
+        return data_[I * C + J];
+    }
+
+    /**
+     * @brief Pointer to the elements, stored row-major with stride C
+     */
+    constexpr T* data() { return data_; }
+
+    /**
+     * @brief Pointer to the elements (const version)
+     */
+    constexpr const T* data() const { return data_; }
+
+    /**
+     * @brief Element k in row-major order
+     *
+     * Part of the MatrixExpression interface.
+     */
+    constexpr T coeff(size_t k) const { return data_[k]; }
+
+    /**
+     * @brief Matrix addition
+     */
+    template <size_t R2, size_t C2>
+    constexpr FixedMatrix
+    operator+(const FixedMatrix<T, R2, C2>& other) const {
+        static_assert(R2 == R && C2 == C,
+                      "Matrix dimensions must match for addition");
+        FixedMatrix result;
+        add(other, result, std::make_index_sequence<R * C>{});
+        return result;
+    }
+
+    /**
+     * @brief In-place addition
+     */
+    template <size_t R2, size_t C2>
+    constexpr FixedMatrix& operator+=(const FixedMatrix<T, R2, C2>& other) {
+        static_assert(R2 == R && C2 == C,
+                      "Matrix dimensions must match for addition");
+        add(other, *this, std::make_index_sequence<R * C>{});
+        return *this;
+    }
+
+    /**
+     * @brief Scalar multiplication
+     */
+    constexpr FixedMatrix operator*(T scalar) const {
+        FixedMatrix result;
+        scale(scalar, result, std::make_index_sequence<R * C>{});
+        return result;
+    }
+
+    /**
+     * @brief In-place scalar multiplication
+     */
+    constexpr FixedMatrix& operator*=(T scalar) {
+        scale(scalar, *this, std::make_index_sequence<R * C>{});
+        return *this;
+    }
+
+    /**
+     * @brief Matrix multiplication
+     */
+    template <size_t K, size_t N>
+    constexpr FixedMatrix<T, R, N>
+    operator*(const FixedMatrix<T, K, N>& other) const {
+        static_assert(K == C,
+                      "Matrix dimensions incompatible for multiplication");
+        FixedMatrix<T, R, N> result;
+        multiply(other, result, std::make_index_sequence<R * N>{});
+        return result;
+    }
+
+    /**
+     * @brief Transpose matrix
+     */
+    constexpr FixedMatrix<T, C, R> transpose() const {
+        FixedMatrix<T, C, R> result;
+        transpose_into(result, std::make_index_sequence<R * C>{});
+        return result;
+    }
+
+    /**
+     * @brief Transpose a square matrix in place
+     */
+    constexpr FixedMatrix& transpose_inplace() {
+        static_assert(R == C, "In-place transpose requires a square matrix");
+        *this = transpose();
+        return *this;
+    }
+
+    /**
+     * @brief Sum of the squared magnitudes of the elements
+     */
+    constexpr real_type squared_norm() const {
+        return sum_squares(std::make_index_sequence<R * C>{});
+    }
+
+    /**
+     * @brief Calculate Frobenius norm
+     */
+    real_type norm() const { return std::sqrt(squared_norm()); }
+
+private:
+    template <typename, size_t, size_t>
+    friend class FixedMatrix;
+
+    T data_[R * C];
+
+    template <size_t... Ks>
+    constexpr void fill(T value, std::index_sequence<Ks...>) {
+        ((data_[Ks] = value), ...);
+    }
+
+    template <size_t... Ks>
+    constexpr void add(const FixedMatrix& other, FixedMatrix& out,
+                       std::index_sequence<Ks...>) const {
+        ((out.data_[Ks] = data_[Ks] + other.data_[Ks]), ...);
+    }
+
+    template <size_t... Ks>
+    constexpr void scale(T scalar, FixedMatrix& out,
+                         std::index_sequence<Ks...>) const {
+        ((out.data_[Ks] = data_[Ks] * scalar), ...);
+    }
+
+    // Dot product of row i with column j of other.
+    template <size_t N, size_t... Ps>
+    constexpr T dot(const FixedMatrix<T, C, N>& other, size_t i, size_t j,
+                    std::index_sequence<Ps...>) const {
+        return ((data_[i * C + Ps] * other.data_[Ps * N + j]) + ...);
+    }
+
+    template <size_t N, size_t... Ks>
+    constexpr void multiply(const FixedMatrix<T, C, N>& other,
+                            FixedMatrix<T, R, N>& out,
+                            std::index_sequence<Ks...>) const {
+        ((out.data_[Ks] =
+              dot(other, Ks / N, Ks % N, std::make_index_sequence<C>{})),
+         ...);
+    }
+
+    // Element k of the C x R result is element (k % R, k / R) here.
+    template <size_t... Ks>
+    constexpr void transpose_into(FixedMatrix<T, C, R>& out,
+                                  std::index_sequence<Ks...>) const {
+        ((out.data_[Ks] = data_[(Ks % R) * C + Ks / R]), ...);
+    }
+
+    template <size_t... Ks>
+    constexpr real_type sum_squares(std::index_sequence<Ks...>) const {
+        return (real_type(detail::abs_squared(data_[Ks])) + ...);
+    }
+};
+
+namespace detail {
+
+// Held by reference in expressions, like BasicMatrix leaves.
+template <typename T, size_t R, size_t C>
+struct ExpressionRef<FixedMatrix<T, R, C>> {
+    using type = const FixedMatrix<T, R, C>&;
+};
+
+} // namespace detail
+
+} // namespace matrixops
@@ -0,0 +1,182 @@
+#pragma once
+
+#include <complex>
+#include <cstddef>
+
+#include "matrixops/half.h"
+#include "matrixops/layout.h"
+
+namespace matrixops {
+
+/**
+ * @brief Cache blocking parameters of the packed GEMM kernel
+ *
+ * The kernel follows the Goto/BLIS loop structure: an nc-wide panel of B is
+ * packed once per kc-deep slice and reused from L3, an mc x kc block of A is
+ * packed into L2, and the register-tiled micro-kernel streams kc-long
+ * micro-panels of both through L1.
+ */
+struct GemmBlocking {
+    size_t mc = 96;   ///< Rows of A packed per block (L2)
+    size_t kc = 256;  ///< Depth of the packed panels (L1)
+    size_t nc = 4096; ///< Columns of B packed per panel (L3)
+};
+
+/**
+ * @brief Get the blocking parameters currently used by gemm()
+ */
+GemmBlocking gemm_blocking();
+
+/**
+ * @brief Set the blocking parameters used by gemm()
+ *
+ * mc and nc are rounded up to multiples of the micro-kernel tile.
+ * @throws std::invalid_argument if any parameter is zero
+ */
+void set_gemm_blocking(const GemmBlocking& blocking);
+
+/**
+ * @brief Settings of the Strassen-Winograd mode of gemm()
+ *
+ * When enabled, products whose smallest dimension exceeds crossover are
+ * split in half along every dimension, recursively, and done with 7
+ * half-size products instead of 8, down to the crossover: O(n^2.81)
+ * instead of O(n^3). Odd dimensions are peeled off rather than padded.
+ * The temporaries take about 2/3 of n^2 elements for an n x n product,
+ * plus n^2 more when alpha is not 1 or beta is not 0.
+ *
+ * The error bound is normwise rather than elementwise. With l levels of
+ * recursion, n0 = n / 2^l and unit roundoff u (Higham, Accuracy and
+ * Stability of Numerical Algorithms, 2nd ed., section 23.2.2):
+ *
+ *     ||C - fl(C)|| <= [(n/n0)^log2(18) (n0^2 + 6 n0) - 6n] u ||A|| ||B||
+ *
+ * up to O(u^2), in the max-norm, against n u |A| |B| elementwise for
+ * classic multiplication. Each level multiplies the bound by about 4.5,
+ * and small elements of C can lose all their relative accuracy, so the
+ * mode is off by default.
+ */
+struct StrassenSettings {
+    bool enabled = false;    ///< Use Strassen-Winograd for large products
+    size_t crossover = 1024; ///< Largest dimension left to classic GEMM
+};
+
+/**
+ * @brief Get the current Strassen-Winograd settings
+ */
+StrassenSettings strassen_settings();
+
+/**
+ * @brief Set the Strassen-Winograd settings used by gemm()
+ * @throws std::invalid_argument if crossover is zero
+ */
+void set_strassen_settings(const StrassenSettings& settings);
+
+/**
+ * @brief Name of the vendor BLAS that large products are forwarded to
+ *
+ * "openblas", "mkl" or "blis", as selected with MATRIXOPS_BLAS_BACKEND at
+ * configure time, or "none" when every product uses the native kernels.
+ */
+const char* blas_backend();
+
+/**
+ * @brief Get the product size, in multiply-adds (m * n * k), from which
+ * gemm() calls the vendor BLAS
+ *
+ * The default is MATRIXOPS_BLAS_THRESHOLD, set at configure time. It only
+ * applies to float, double and the complex types.
+ */
+size_t blas_threshold();
+
+/**
+ * @brief Set the product size from which gemm() calls the vendor BLAS
+ *
+ * 0 forwards every product and SIZE_MAX none. Without a backend this has
+ * no effect.
+ */
+void set_blas_threshold(size_t flops);
+
+/**
+ * @brief General matrix multiply on row-major or column-major buffers
+ *
+ * Computes C = alpha * A * B + beta * C, where A is m x k, B is k x n and
+ * C is m x n, each with the given leading dimension. C is row-major; A
+ * and B are in layout_a and layout_b, and only their packing differs, so
+ * column-major operands cost no copy. For a column-major C, compute
+ * C^T = B^T * A^T: swap the operands and flip both layouts. When beta is
+ * zero C is not read, so it may hold uninitialized values. Products from
+ * blas_threshold() up go to the vendor BLAS, if one was configured, which
+ * uses its own threads rather than the MatrixOps pool. See
+ * StrassenSettings for the fast mode.
+ */
+void gemm(size_t m, size_t n, size_t k, double alpha, const double* a,
+          size_t lda, const double* b, size_t ldb, double beta, double* c,
+          size_t ldc, Layout layout_a = Layout::ROW_MAJOR,
+          Layout layout_b = Layout::ROW_MAJOR);
+
+/**
+ * @brief General matrix multiply, single precision
+ */
+void gemm(size_t m, size_t n, size_t k, float alpha, const float* a,
+          size_t lda, const float* b, size_t ldb, float beta, float* c,
+          size_t ldc, Layout layout_a = Layout::ROW_MAJOR,
+          Layout layout_b = Layout::ROW_MAJOR);
+
+/**
+ * @brief General matrix multiply, single-precision complex
+ */
+void gemm(size_t m, size_t n, size_t k, std::complex<float> alpha,
+          const std::complex<float>* a, size_t lda,
+          const std::complex<float>* b, size_t ldb, std::complex<float> beta,
+          std::complex<float>* c, size_t ldc,
+          Layout layout_a = Layout::ROW_MAJOR,
+          Layout layout_b = Layout::ROW_MAJOR);
+
+/**
+ * @brief General matrix multiply, double-precision complex
+ */
+void gemm(size_t m, size_t n, size_t k, std::complex<double> alpha,
+          const std::complex<double>* a, size_t lda,
+          const std::complex<double>* b, size_t ldb,
+          std::complex<double> beta, std::complex<double>* c, size_t ldc,
+          Layout layout_a = Layout::ROW_MAJOR,
+          Layout layout_b = Layout::ROW_MAJOR);
+
+/**
+ * @brief General matrix multiply on half-precision buffers
+ *
+ * The panels of A and B are widened to float as they are packed and the
+ * products are accumulated in float; each element of C is rounded to half
+ * precision once, at the end.
+ */
+void gemm(size_t m, size_t n, size_t k, float alpha, const Half* a,
+          size_t lda, const Half* b, size_t ldb, float beta, Half* c,
+          size_t ldc, Layout layout_a = Layout::ROW_MAJOR,
+          Layout layout_b = Layout::ROW_MAJOR);
+
+/**
+ * @brief Mixed-precision multiply: half-precision inputs, float output
+ */
+void gemm(size_t m, size_t n, size_t k, float alpha, const Half* a,
+          size_t lda, const Half* b, size_t ldb, float beta, float* c,
+          size_t ldc, Layout layout_a = Layout::ROW_MAJOR,
+          Layout layout_b = Layout::ROW_MAJOR);
+
+/**
+ * @brief General matrix multiply on bfloat16 buffers, accumulated in float
+ */
+void gemm(size_t m, size_t n, size_t k, float alpha, const BFloat16* a,
+          size_t lda, const BFloat16* b, size_t ldb, float beta, BFloat16* c,
+          size_t ldc, Layout layout_a = Layout::ROW_MAJOR,
+          Layout layout_b = Layout::ROW_MAJOR);
+
+/**
+ * @brief Mixed-precision multiply: bfloat16 inputs, float output
+ */
+void gemm(size_t m, size_t n, size_t k, float alpha, const BFloat16* a,
+          size_t lda, const BFloat16* b, size_t ldb, float beta, float* c,
+          size_t ldc, Layout layout_a = Layout::ROW_MAJOR,
+          Layout layout_b = Layout::ROW_MAJOR);
+
+} // namespace matrixops
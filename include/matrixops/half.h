@@ -0,0 +1,162 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+
+namespace matrixops {
+
+namespace detail {
+
+inline uint32_t float_bits(float value) {
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+inline float bits_float(uint32_t bits) {
+    float value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+// Round-to-nearest-even conversion to IEEE 754 binary16.
+inline uint16_t float_to_half(float value) {
+    const uint32_t x = float_bits(value);
+    const uint32_t sign = (x >> 16) & 0x8000U;
+    const uint32_t magnitude = x & 0x7FFFFFFFU;
+    if (magnitude >= 0x7F800000U) {
+        // Infinity, or NaN kept quiet with its top payload bits.
+        const uint32_t nan =
+            magnitude > 0x7F800000U ? 0x200U | ((magnitude >> 13) & 0x3FFU)
+                                    : 0U;
+        return static_cast<uint16_t>(sign | 0x7C00U | nan);
+    }
+    if (magnitude >= 0x477FF000U) {
+        // 65520 and up round past the largest finite half, 65504.
+        return static_cast<uint16_t>(sign | 0x7C00U);
+    }
+    if (magnitude >= 0x38800000U) {
+        // Normal: rebias the exponent from 127 to 15, round 13 bits away.
+        uint32_t result = (magnitude - 0x38000000U) >> 13;
+        const uint32_t rest = magnitude & 0x1FFFU;
+        if (rest > 0x1000U || (rest == 0x1000U && (result & 1U) != 0)) {
+            ++result;
+        }
+        return static_cast<uint16_t>(sign | result);
+    }
+    if (magnitude <= 0x33000000U) {
+        // At most half the smallest subnormal, 2^-24: rounds to zero.
+        return static_cast<uint16_t>(sign);
+    }
+    // Subnormal: shift the significand, with its implicit bit, into units
+    // of 2^-24. Rounding up may carry into the smallest normal, which has
+    // the right encoding.
+    const uint32_t significand = (magnitude & 0x7FFFFFU) | 0x800000U;
+    const uint32_t shift = 126U - (magnitude >> 23);
+    uint32_t result = significand >> shift;
+    const uint32_t rest = significand & ((1U << shift) - 1U);
+    const uint32_t halfway = 1U << (shift - 1U);
+    if (rest > halfway || (rest == halfway && (result & 1U) != 0)) {
+        ++result;
+    }
+    return static_cast<uint16_t>(sign | result);
+}
+
+inline float half_to_float(uint16_t half) {
+    const uint32_t sign = static_cast<uint32_t>(half & 0x8000U) << 16;
+    const uint32_t exponent = (half >> 10) & 0x1FU;
+    const uint32_t mantissa = half & 0x3FFU;
+    if (exponent == 0x1FU) {
+        return bits_float(sign | 0x7F800000U | (mantissa << 13));
+    }
+    if (exponent == 0) {
+        // Zero or subnormal; both products are exact.
+        const float magnitude = static_cast<float>(mantissa) * 0x1p-24F;
+        return sign != 0 ? -magnitude : magnitude;
+    }
+    return bits_float(sign | ((exponent + 112U) << 23) | (mantissa << 13));
+}
+
+// Round-to-nearest-even truncation of a float to its upper 16 bits.
+inline uint16_t float_to_bfloat16(float value) {
+    const uint32_t x = float_bits(value);
+    if ((x & 0x7FFFFFFFU) > 0x7F800000U) {
+        return static_cast<uint16_t>((x >> 16) | 0x40U);
+    }
+    const uint32_t rounding = 0x7FFFU + ((x >> 16) & 1U);
+    return static_cast<uint16_t>((x + rounding) >> 16);
+}
+
+inline float bfloat16_to_float(uint16_t bits) {
+    return bits_float(static_cast<uint32_t>(bits) << 16);
+}
+
+} // namespace detail
+
+/**
+ * @brief IEEE 754 half-precision (binary16) element type
+ *
+ * A storage format: values convert implicitly to float for arithmetic and
+ * are rounded to nearest even when stored back. Half matrices take a
+ * quarter of the memory of double ones, and their products accumulate in
+ * float, see gemm().
+ */
+class Half {
+public:
+    Half() = default;
+
+    Half(float value) : bits_(detail::float_to_half(value)) {}
+
+    operator float() const { return detail::half_to_float(bits_); }
+
+    /**
+     * @brief Reinterpret a binary16 bit pattern
+     */
+    static Half from_bits(uint16_t bits) {
+        Half h;
+        h.bits_ = bits;
+        return h;
+    }
+
+    /**
+     * @brief Get the binary16 bit pattern
+     */
+    uint16_t bits() const { return bits_; }
+
+private:
+    uint16_t bits_;
+};
+
+/**
+ * @brief bfloat16 element type: the upper half of a float
+ *
+ * Keeps the range of float with an 8-bit significand. Like Half it is a
+ * storage format whose arithmetic happens in float.
+ */
+class BFloat16 {
+public:
+    BFloat16() = default;
+
+    BFloat16(float value) : bits_(detail::float_to_bfloat16(value)) {}
+
+    operator float() const { return detail::bfloat16_to_float(bits_); }
+
+    /**
+     * @brief Reinterpret a bfloat16 bit pattern
+     */
+    static BFloat16 from_bits(uint16_t bits) {
+        BFloat16 b;
+        b.bits_ = bits;
+        return b;
+    }
+
+    /**
+     * @brief Get the bfloat16 bit pattern
+     */
+    uint16_t bits() const { return bits_; }
+
+private:
+    uint16_t bits_;
+};
+
+} // namespace matrixops
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace matrixops {
+
+/**
+ * @brief Totals for one operation over one size bucket
+ *
+ * Operations are "multiply", "gemm", "add", "scale", "transpose" and
+ * "norm"; heap allocations made outside of them are reported as
+ * "allocate", with only calls and bytes_allocated set. The bucket holds
+ * the calls whose result has from min_elements up to, but excluding,
+ * twice that many elements (0 for empty results).
+ */
+struct OperationStats {
+    std::string operation;
+    size_t min_elements = 0;
+    uint64_t calls = 0;
+    double seconds = 0.0;
+    double flops = 0.0;
+    double bytes = 0.0;
+    uint64_t bytes_allocated = 0;
+
+    /**
+     * @brief Achieved GFLOP/s over the recorded calls
+     */
+    double gflops() const {
+        return seconds > 0.0 ? flops / seconds / 1e9 : 0.0;
+    }
+
+    /**
+     * @brief Achieved memory throughput, in GB/s, counting every operand
+     * read and result written once
+     */
+    double gbytes_per_second() const {
+        return seconds > 0.0 ? bytes / seconds / 1e9 : 0.0;
+    }
+};
+
+/**
+ * @brief Callbacks around every recorded operation, to mirror them as
+ * zones of an external profiler such as Tracy
+ *
+ * begin(name, user) is called when an operation starts, on its thread,
+ * and its result is passed back to end(zone, user) when it finishes.
+ */
+struct ZoneHooks {
+    void* (*begin)(const char* name, void* user) = nullptr;
+    void (*end)(void* zone, void* user) = nullptr;
+    void* user = nullptr;
+};
+
+/**
+ * @brief Check if the library was built with MATRIXOPS_INSTRUMENTATION
+ *
+ * Without it the functions below do nothing and report no operations, and
+ * the operations carry no instrumentation code at all.
+ */
+bool instrumentation_available();
+
+/**
+ * @brief Check if operations are being recorded; true by default when
+ * instrumentation is available
+ */
+bool instrumentation_enabled();
+
+/**
+ * @brief Start or stop recording operations
+ */
+void set_instrumentation_enabled(bool enabled);
+
+/**
+ * @brief The totals recorded since the start or the last reset, by
+ * operation and then size
+ *
+ * Only the outermost operation of a thread is recorded: the gemm() called
+ * by operator* counts as part of "multiply". Times are wall-clock times
+ * of the calling thread, parallel work included.
+ */
+std::vector<OperationStats> instrumentation_stats();
+
+/**
+ * @brief Clear the recorded totals
+ */
+void reset_instrumentation();
+
+/**
+ * @brief instrumentation_stats() as a JSON document
+ */
+std::string instrumentation_json();
+
+/**
+ * @brief Install zone callbacks; pass default ZoneHooks to remove them
+ *
+ * Set them while no operation is running. Builds with MATRIXOPS_ITT also
+ * emit every operation as an ITT task, which VTune and other ITT
+ * collectors show on their timelines.
+ */
+void set_zone_hooks(const ZoneHooks& hooks);
+
+} // namespace matrixops
@@ -0,0 +1,232 @@
+#pragma once
+
+#include <cassert>
+#include <complex>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "matrixops/expression.h"
+#include "matrixops/half.h"
+#include "matrixops/matrix.h"
+
+namespace matrixops {
+
+/**
+ * @brief Element type code stored in the header of a matrix file
+ */
+enum class ElementType : uint32_t {
+    FLOAT32 = 1,
+    FLOAT64 = 2,
+    COMPLEX64 = 3,  ///< std::complex<float>
+    COMPLEX128 = 4, ///< std::complex<double>
+    FLOAT16 = 5,    ///< Half
+    BFLOAT16 = 6,
+};
+
+/**
+ * @brief Current version of the matrix file format
+ *
+ * A file is a 64-byte header followed, at data_offset, by the rows x cols
+ * elements in row-major order and the byte order of the machine that
+ * wrote it. All header fields are in that byte order too:
+ *
+ *     offset  size  field
+ *          0     8  magic "MATRIXOP"
+ *          8     4  version
+ *         12     4  byte-order mark 0x01020304
+ *         16     4  element type, see ElementType
+ *         20     4  element size in bytes
+ *         24     8  rows
+ *         32     8  cols
+ *         40     8  data_offset, a multiple of STORAGE_ALIGNMENT
+ *         48     8  data size in bytes, rows * cols * element size
+ *         56     8  reserved, zero
+ *
+ * The data offset keeps the elements of a mapped file as aligned as Matrix
+ * storage. Readers reject files from a newer version.
+ */
+constexpr uint32_t MATRIX_FILE_VERSION = 1;
+
+/**
+ * @brief Shape and element type of a matrix file, from its header
+ */
+struct MatrixFileInfo {
+    uint32_t version;
+    ElementType element_type;
+    size_t rows;
+    size_t cols;
+    size_t data_offset;
+};
+
+/**
+ * @brief Read and check the header of a matrix file
+ * @throws std::runtime_error if the file cannot be read, is not a matrix
+ * file, has a newer version or the other byte order, or is shorter than
+ * its header says
+ */
+MatrixFileInfo read_matrix_file_info(const std::string& path);
+
+/**
+ * @brief Write m to path in the matrix file format
+ *
+ * The header and the elements are streamed straight from the matrix
+ * storage, without an intermediate buffer. An existing file is replaced.
+ * @throws std::runtime_error if the file cannot be written
+ */
+template <typename T>
+void save_matrix(const std::string& path, const BasicMatrix<T>& m);
+
+/**
+ * @brief Read a matrix file into a new Matrix
+ *
+ * One bulk read into the matrix storage, after the header is checked.
+ * @throws std::runtime_error as read_matrix_file_info(), or if the
+ * element type of the file is not T
+ */
+template <typename T>
+BasicMatrix<T> load_matrix(const std::string& path);
+
+namespace detail {
+
+/**
+ * @brief Read-only memory mapping of a whole file
+ *
+ * mmap() on POSIX systems and a file mapping object on Windows; the
+ * pages are read in on first access.
+ */
+class MappedFile {
+public:
+    /**
+     * @throws std::runtime_error if the file cannot be opened or mapped
+     */
+    explicit MappedFile(const std::string& path);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const unsigned char* data() const { return data_; }
+    size_t size() const { return size_; }
+
+private:
+    const unsigned char* data_ = nullptr;
+    size_t size_ = 0;
+#if defined(_WIN32)
+    void* mapping_ = nullptr;
+#endif
+};
+
+} // namespace detail
+
+/**
+ * @brief Read-only matrix backed directly by a memory-mapped matrix file
+ *
+ * Nothing is copied when the file is opened: elements are paged in from
+ * the file as they are first read, and the pages are shared with the page
+ * cache and other processes mapping the same file. The matrix is an
+ * expression, so it can be an operand of `+` and `*` or be copied into a
+ * Matrix with `Matrix m(mapped)`. The file must not be truncated while it
+ * is mapped.
+ */
+template <typename T>
+class BasicMappedMatrix : public MatrixExpression<BasicMappedMatrix<T>> {
+public:
+    using value_type = T;
+
+    /**
+     * @brief Map the matrix file at path
+     * @throws std::runtime_error as load_matrix()
+     */
+    explicit BasicMappedMatrix(const std::string& path);
+
+    /**
+     * @brief Get number of rows
+     */
+    size_t rows() const { return rows_; }
+
+    /**
+     * @brief Get number of columns
+     */
+    size_t cols() const { return cols_; }
+
+    /**
+     * @brief Leading dimension: distance, in elements, between rows
+     */
+    size_t stride() const { return cols_; }
+
+    /**
+     * @brief Pointer to the mapped elements, stored row-major and aligned
+     * to STORAGE_ALIGNMENT
+     */
+    const T* data() const { return data_; }
+
+    /**
+     * @brief Read element (i, j)
+     * @throws std::out_of_range if an index is out of range
+     */
+    T operator()(size_t i, size_t j) const;
+
+    /**
+     * @brief Read element (i, j) without bounds checking
+     */
+    T unchecked(size_t i, size_t j) const {
+        assert(i < rows_ && j < cols_);
+        return data_[i * cols_ + j];
+    }
+
+    /**
+     * @brief Element k in row-major order, without bounds checking
+     *
+     * Part of the MatrixExpression interface.
+     */
+    T coeff(size_t k) const { return data_[k]; }
+
+    /**
+     * @brief View of the whole matrix, e.g. for its norm()
+     */
+    BasicMatrixView<const T> view() const {
+        return {data_, rows_, cols_, cols_};
+    }
+
+    /**
+     * @brief View of the rows x cols block with top-left corner (i, j)
+     * @throws std::out_of_range if the block does not fit in the matrix
+     */
+    BasicMatrixView<const T> block(size_t i, size_t j, size_t rows,
+                                   size_t cols) const {
+        return view().block(i, j, rows, cols);
+    }
+
+private:
+    std::unique_ptr<detail::MappedFile> file_;
+    size_t rows_;
+    size_t cols_;
+    const T* data_;
+};
+
+/**
+ * @brief Memory-mapped matrix of double, the default element type
+ */
+using MappedMatrix = BasicMappedMatrix<double>;
+
+namespace detail {
+
+// Expressions hold mapped operands by reference, like Matrix operands.
+template <typename T>
+struct ExpressionRef<BasicMappedMatrix<T>> {
+    using type = const BasicMappedMatrix<T>&;
+};
+
+} // namespace detail
+
+// Compiled into the library for these element types.
+extern template class BasicMappedMatrix<float>;
+extern template class BasicMappedMatrix<double>;
+extern template class BasicMappedMatrix<std::complex<float>>;
+extern template class BasicMappedMatrix<std::complex<double>>;
+extern template class BasicMappedMatrix<Half>;
+extern template class BasicMappedMatrix<BFloat16>;
+
+} // namespace matrixops
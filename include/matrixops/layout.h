@@ -0,0 +1,17 @@
+#pragma once
+
+namespace matrixops {
+
+/**
+ * @brief Order of the elements of a dense matrix in memory
+ *
+ * BasicMatrix is always row-major; column-major buffers, as exchanged
+ * with Fortran and LAPACK codes, are read in place through gemm() and
+ * BasicMatrixView. See BasicTiledMatrix for the blocked layout.
+ */
+enum class Layout {
+    ROW_MAJOR,   ///< Element (i, j) at i * ld + j: rows are contiguous
+    COLUMN_MAJOR ///< Element (i, j) at j * ld + i: columns are contiguous
+};
+
+} // namespace matrixops
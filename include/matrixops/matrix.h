@@ -3,23 +3,130 @@
 #include <vector>
 #include <stdexcept>
 #include <cmath>
+#include <cassert>
+#include <complex>
+#include <functional>
+#include <type_traits>
+#include <utility>
+
+#include "matrixops/allocator.h"
+#include "matrixops/expression.h"
+#include "matrixops/half.h"
+#include "matrixops/matrix_view.h"
+#include "matrixops/parallel.h"
+#include "matrixops/scalar_traits.h"
+#include "matrixops/storage.h"
+#include "matrixops/strided_span.h"
 
 namespace matrixops {
 
+namespace detail {
+
+// Block size of the reductions, fixed so that their results do not depend
+// on the tuning, and the default task size of the element-wise kernels.
+constexpr size_t ELEMENTWISE_GRAIN = size_t{1} << 15;
+
+// Elements per task for the memory-bound element-wise kernels and the
+// transposes, as tuned (see tuning.h); smaller matrices run on the calling
+// thread.
+size_t elementwise_grain();
+
+} // namespace detail
+
+/**
+ * @brief Tag selecting the Matrix constructor that skips initialization
+ */
+struct UninitializedTag {
+    explicit UninitializedTag() = default;
+};
+
+/**
+ * @brief Pass to Matrix(rows, cols, UNINITIALIZED) for result buffers
+ * that are about to be overwritten
+ */
+constexpr UninitializedTag UNINITIALIZED{};
+
 /**
  * @brief A simple matrix class for demonstrating CI/CD workflows
- * 
+ *
  * This class provides basic matrix operations for educational purposes.
+ * The element type T is float, double, std::complex<float>,
+ * std::complex<double>, Half or BFloat16; Matrix is the double version.
+ * The float and double kernels are vectorized, the others use portable
+ * loops, and Half and BFloat16 multiply with float accumulation.
  */
-class Matrix {
+template <typename T>
+class BasicMatrix : public MatrixExpression<BasicMatrix<T>> {
 public:
+    using value_type = T;
+
+    /// Type of norm(): the element type, or its real part for complex
+    /// types, or float for Half and BFloat16
+    using real_type = typename detail::ScalarTraits<T>::real_type;
+
     /**
      * @brief Construct a matrix with given dimensions
      * @param rows Number of rows
      * @param cols Number of columns
      * @param init_value Initial value for all elements (default: 0.0)
      */
-    Matrix(size_t rows, size_t cols, double init_value = 0.0);
+    BasicMatrix(size_t rows, size_t cols, T init_value = T(0));
+
+    /**
+     * @brief Construct a matrix without initializing its elements
+     *
+     * Every element must be written before it is read.
+     */
+    BasicMatrix(size_t rows, size_t cols, UninitializedTag);
+
+    /**
+     * @brief Evaluate an expression such as `a + b * 2.0` in one pass
+     */
+    template <typename E>
+    BasicMatrix(const MatrixExpression<E>& expr);
+
+    BasicMatrix(const BasicMatrix& other) = default;
+    BasicMatrix& operator=(const BasicMatrix& other) = default;
+
+    /**
+     * @brief Take the elements of other, which is left 0 x 0, without
+     * storage, until it is assigned again
+     */
+    BasicMatrix(BasicMatrix&& other) noexcept
+        : rows_(std::exchange(other.rows_, 0)),
+          cols_(std::exchange(other.cols_, 0)),
+          data_(std::move(other.data_)) {}
+
+    /**
+     * @brief Take the elements of other, which is left 0 x 0
+     */
+    BasicMatrix& operator=(BasicMatrix&& other) noexcept {
+        if (this != &other) {
+            rows_ = std::exchange(other.rows_, 0);
+            cols_ = std::exchange(other.cols_, 0);
+            data_ = std::move(other.data_);
+        }
+        return *this;
+    }
+
+    /**
+     * @brief Convert every element of a matrix of another type, e.g. to
+     * store a double matrix in half precision
+     */
+    template <typename U>
+    explicit BasicMatrix(const BasicMatrix<U>& other);
+
+    /**
+     * @brief Evaluate an expression into this matrix
+     *
+     * The storage is reused when the dimensions match. The expression may
+     * refer to this matrix, e.g. `a = a + b`, or view it, e.g.
+     * `a = a + MatrixView(a).transposed()`; views that do not line up with
+     * this matrix element for element are evaluated into a temporary
+     * first.
+     */
+    template <typename E>
+    BasicMatrix& operator=(const MatrixExpression<E>& expr);
 
     /**
      * @brief Get number of rows
@@ -34,37 +141,148 @@ public:
     /**
      * @brief Access element at (i, j)
      */
-    double& operator()(size_t i, size_t j);
+    T& operator()(size_t i, size_t j);
 
     /**
      * @brief Access element at (i, j) (const version)
      */
-    double operator()(size_t i, size_t j) const;
+    T operator()(size_t i, size_t j) const;
 
     /**
-     * @brief Matrix addition
+     * @brief Access element at (i, j) without bounds checking
+     *
+     * For inner loops; the indices are only checked, with assert(), in
+     * debug builds.
      */
-    Matrix operator+(const Matrix& other) const;
+    T& unchecked(size_t i, size_t j) {
+        assert(i < rows_ && j < cols_);
+        return data()[index(i, j)];
+    }
+
+    /**
+     * @brief Access element at (i, j) without bounds checking (const
+     * version)
+     */
+    T unchecked(size_t i, size_t j) const {
+        assert(i < rows_ && j < cols_);
+        return data()[index(i, j)];
+    }
+
+    /**
+     * @brief Pointer to the elements, stored row-major
+     *
+     * Element (i, j) is at data()[i * stride() + j]. The buffer is aligned
+     * to STORAGE_ALIGNMENT. Up to SMALL_MATRIX_BYTES are stored inside the
+     * matrix object, so a move copies them and the pointer changes; larger
+     * buffers come from the current_resource() of the thread that created
+     * the matrix and move with it.
+     */
+    T* data() { return data_.data(); }
+
+    /**
+     * @brief Pointer to the elements, stored row-major (const version)
+     */
+    const T* data() const { return data_.data(); }
+
+    /**
+     * @brief Leading dimension: distance, in elements, between rows
+     */
+    size_t stride() const { return cols_; }
+
+    /**
+     * @brief View of row i
+     * @throws std::out_of_range if i is not a valid row
+     */
+    StridedSpan<T> row(size_t i);
+
+    /**
+     * @brief View of row i (const version)
+     */
+    StridedSpan<const T> row(size_t i) const;
+
+    /**
+     * @brief View of column j
+     * @throws std::out_of_range if j is not a valid column
+     */
+    StridedSpan<T> col(size_t j);
+
+    /**
+     * @brief View of column j (const version)
+     */
+    StridedSpan<const T> col(size_t j) const;
+
+    /**
+     * @brief View of the rows x cols block with top-left corner (i, j),
+     * sharing the elements
+     * @throws std::out_of_range if the block does not fit in the matrix
+     */
+    BasicMatrixView<T> block(size_t i, size_t j, size_t rows, size_t cols);
+
+    /**
+     * @brief View of a block (const version)
+     */
+    BasicMatrixView<const T> block(size_t i, size_t j, size_t rows,
+                                   size_t cols) const;
+
+    /**
+     * @brief Element k in row-major order, without bounds checking
+     *
+     * Part of the MatrixExpression interface.
+     */
+    T coeff(size_t k) const { return data()[k]; }
 
     /**
      * @brief Matrix multiplication
      */
-    Matrix operator*(const Matrix& other) const;
+    BasicMatrix operator*(const BasicMatrix& other) const;
 
     /**
-     * @brief Scalar multiplication
+     * @brief Matrix multiplication by an expression
+     *
+     * Views and mapped matrices are multiplied in place, other expressions
+     * are evaluated first. Without it `m * expr` would be ambiguous between
+     * the overload above, through the implicit conversion of expr, and the
+     * free operator*.
      */
-    Matrix operator*(double scalar) const;
+    template <typename E>
+    BasicMatrix operator*(const MatrixExpression<E>& other) const;
+
+    /**
+     * @brief In-place addition
+     * @throws std::invalid_argument if the dimensions differ
+     */
+    BasicMatrix& operator+=(const BasicMatrix& other);
+
+    /**
+     * @brief In-place addition of an expression, fused into one pass
+     * @throws std::invalid_argument if the dimensions differ
+     */
+    template <typename E>
+    BasicMatrix& operator+=(const MatrixExpression<E>& expr);
+
+    /**
+     * @brief In-place scalar multiplication
+     */
+    BasicMatrix& operator*=(T scalar);
 
     /**
      * @brief Transpose matrix
      */
-    Matrix transpose() const;
+    BasicMatrix transpose() const;
+
+    /**
+     * @brief Transpose a square matrix in place, without a second buffer
+     * @throws std::invalid_argument if the matrix is not square
+     */
+    BasicMatrix& transpose_inplace();
 
     /**
      * @brief Calculate Frobenius norm
+     *
+     * The squares are summed in double precision for every element type,
+     * and rescaled when that would overflow or underflow.
      */
-    double norm() const;
+    real_type norm() const;
 
     /**
      * @brief Check if matrix is square
@@ -74,17 +292,291 @@ public:
 private:
     size_t rows_;
     size_t cols_;
-    std::vector<double> data_;
+    detail::MatrixStorage<T> data_;
 
     size_t index(size_t i, size_t j) const {
         return i * cols_ + j;
     }
+
+    // Plain sums and scalings go to the runtime-dispatched SIMD kernels,
+    // as do copies and sums of views, row by row; everything else is
+    // evaluated by the generic fused loop.
+    void assign(const MatrixSum<BasicMatrix, BasicMatrix>& expr);
+    void assign(const MatrixScaled<BasicMatrix>& expr);
+
+    template <typename L, typename R>
+    void assign(const MatrixSum<L, R>& expr);
+
+    template <typename E>
+    void assign(const E& expr);
+
+    template <typename E>
+    void assign_elementwise(const E& expr);
 };
 
+/**
+ * @brief Matrix of double, the default element type
+ */
+using Matrix = BasicMatrix<double>;
+
+namespace detail {
+
+// Expressions with data() and stride(), such as Matrix, views and mapped
+// matrices, are read in place through a view.
+template <typename E, typename = void>
+struct HasStorage : std::false_type {};
+
+template <typename E>
+struct HasStorage<E, std::void_t<decltype(std::declval<const E&>().data()),
+                                 decltype(std::declval<const E&>().stride())>>
+    : std::true_type {};
+
+template <typename E>
+BasicMatrixView<const typename E::value_type> storage_view(const E& e) {
+    return {e.data(), e.rows(), e.cols(), e.stride()};
+}
+
+template <typename T>
+BasicMatrixView<const T> storage_view(const BasicMatrixView<T>& v) {
+    return v;
+}
+
+// Whether e reads the rows x cols buffer out, leading dimension ldo, other
+// than element (i, j) at element (i, j), as a transposed view of it does:
+// writing the result into out would then overwrite elements not yet read.
+template <typename T, typename E>
+bool reads_shifted(const E& e, const T* out, size_t ldo);
+
+template <typename T, typename L, typename R>
+bool reads_shifted(const MatrixSum<L, R>& e, const T* out, size_t ldo);
+
+template <typename T, typename E>
+bool reads_shifted(const MatrixScaled<E>& e, const T* out, size_t ldo);
+
+template <typename T, typename E>
+bool reads_shifted(const E& e, const T* out, size_t ldo) {
+    if constexpr (HasStorage<E>::value) {
+        const BasicMatrixView<const T> v = storage_view(e);
+        if (v.data() == out && (v.stride() == ldo || v.rows() == 1) &&
+            v.col_stride() == 1) {
+            return false;
+        }
+        const T* v_last = v.data() + (v.rows() - 1) * v.stride() +
+                          (v.cols() - 1) * v.col_stride();
+        const T* out_last = out + (e.rows() - 1) * ldo + e.cols() - 1;
+        const std::less_equal<const T*> before;
+        return before(v.data(), out_last) && before(out, v_last);
+    } else {
+        return false;
+    }
+}
+
+template <typename T, typename L, typename R>
+bool reads_shifted(const MatrixSum<L, R>& e, const T* out, size_t ldo) {
+    return reads_shifted(e.lhs(), out, ldo) ||
+           reads_shifted(e.rhs(), out, ldo);
+}
+
+template <typename T, typename E>
+bool reads_shifted(const MatrixScaled<E>& e, const T* out, size_t ldo) {
+    return reads_shifted(e.expression(), out, ldo);
+}
+
+// Instantiated in matrix_view.cpp for every Matrix element type. out is
+// a row-major buffer with leading dimension ldo and the shape of the
+// result; the views must not overlap it.
+template <typename T>
+void copy_view(BasicMatrixView<const T> a, T* out, size_t ldo);
+
+// out may be a or b exactly, as add_into().
+template <typename T>
+void add_views(BasicMatrixView<const T> a, BasicMatrixView<const T> b,
+               T* out, size_t ldo);
+
+template <typename T>
+BasicMatrix<T> multiply_views(BasicMatrixView<const T> a,
+                              BasicMatrixView<const T> b);
+
+// Product of two expressions, evaluating those without storage.
+template <typename L, typename R>
+BasicMatrix<typename L::value_type> multiply(const L& lhs, const R& rhs) {
+    static_assert(std::is_same_v<typename L::value_type,
+                                 typename R::value_type>,
+                  "Matrix expressions must have the same element type");
+    using T = typename L::value_type;
+    if constexpr (!HasStorage<L>::value) {
+        return multiply(BasicMatrix<T>(lhs), rhs);
+    } else if constexpr (!HasStorage<R>::value) {
+        return multiply(lhs, BasicMatrix<T>(rhs));
+    } else {
+        return multiply_views<T>(storage_view(lhs), storage_view(rhs));
+    }
+}
+
+} // namespace detail
+
+template <typename T>
+template <typename E>
+BasicMatrix<T>::BasicMatrix(const MatrixExpression<E>& expr)
+    : BasicMatrix(expr.derived().rows(), expr.derived().cols(),
+                  UNINITIALIZED) {
+    static_assert(std::is_same_v<typename E::value_type, T>,
+                  "Convert between element types explicitly");
+    assign(expr.derived());
+}
+
+template <typename T>
+template <typename U>
+BasicMatrix<T>::BasicMatrix(const BasicMatrix<U>& other)
+    : BasicMatrix(other.rows(), other.cols(), UNINITIALIZED) {
+    const U* in = other.data();
+    T* out = data();
+    for (size_t k = 0; k < data_.size(); ++k) {
+        out[k] = static_cast<T>(in[k]);
+    }
+}
+
+template <typename T>
+template <typename E>
+BasicMatrix<T>& BasicMatrix<T>::operator=(const MatrixExpression<E>& expr) {
+    static_assert(std::is_same_v<typename E::value_type, T>,
+                  "Convert between element types explicitly");
+    const E& e = expr.derived();
+    // A moved-from matrix keeps no storage, whatever its dimensions. The
+    // expression may still view this matrix, e.g. a block of it, so it is
+    // evaluated before the storage is replaced; and into a temporary when
+    // it views this matrix other than element for element, e.g.
+    // transposed.
+    if (e.rows() != rows_ || e.cols() != cols_ ||
+        data_.size() != e.rows() * e.cols() ||
+        detail::reads_shifted(e, data(), stride())) {
+        BasicMatrix result(e);
+        return *this = std::move(result);
+    }
+    assign(e);
+    return *this;
+}
+
+template <typename T>
+template <typename E>
+BasicMatrix<T> BasicMatrix<T>::operator*(
+    const MatrixExpression<E>& other) const {
+    return detail::multiply(*this, other.derived());
+}
+
+template <typename T>
+template <typename E>
+BasicMatrix<T>& BasicMatrix<T>::operator+=(const MatrixExpression<E>& expr) {
+    return *this = *this + expr.derived();
+}
+
+template <typename T>
+template <typename L, typename R>
+void BasicMatrix<T>::assign(const MatrixSum<L, R>& expr) {
+    if constexpr (detail::HasStorage<L>::value &&
+                  detail::HasStorage<R>::value) {
+        detail::add_views(detail::storage_view(expr.lhs()),
+                          detail::storage_view(expr.rhs()), data(), stride());
+    } else {
+        assign_elementwise(expr);
+    }
+}
+
+template <typename T>
+template <typename E>
+void BasicMatrix<T>::assign(const E& expr) {
+    if constexpr (detail::HasStorage<E>::value) {
+        // operator= evaluates shifted views of this matrix elsewhere, so a
+        // view at data() is this matrix itself.
+        const auto view = detail::storage_view(expr);
+        if (view.data() == data()) {
+            return;
+        }
+        detail::copy_view(view, data(), stride());
+    } else {
+        assign_elementwise(expr);
+    }
+}
+
+template <typename T>
+template <typename E>
+void BasicMatrix<T>::assign_elementwise(const E& expr) {
+    T* out = data();
+    const size_t n = data_.size();
+    const size_t grain = detail::elementwise_grain();
+    if (n <= grain) {
+        for (size_t k = 0; k < n; ++k) {
+            out[k] = expr.coeff(k);
+        }
+        return;
+    }
+    parallel_for(0, n, grain, [&](size_t lo, size_t hi) {
+        for (size_t k = lo; k < hi; ++k) {
+            out[k] = expr.coeff(k);
+        }
+    });
+}
+
+/**
+ * @brief Matrix multiplication with expression operands
+ *
+ * Matrices, views and mapped matrices are read in place, other operands
+ * are evaluated first; the product itself is never lazy.
+ */
+template <typename L, typename R>
+BasicMatrix<typename L::value_type> operator*(const MatrixExpression<L>& lhs,
+                                              const MatrixExpression<R>& rhs) {
+    return detail::multiply(lhs.derived(), rhs.derived());
+}
+
+/**
+ * @brief Compute out = a + b without allocating
+ *
+ * out may be a or b.
+ * @throws std::invalid_argument if the dimensions of a, b and out differ
+ */
+template <typename T>
+void add_into(const BasicMatrix<T>& a, const BasicMatrix<T>& b,
+              BasicMatrix<T>& out);
+
+/**
+ * @brief Compute out = a * b into caller-owned storage
+ *
+ * Steady-state calls with the same shapes do not allocate.
+ * @throws std::invalid_argument if the dimensions are incompatible, out
+ * is not a.rows() x b.cols(), or out is a or b
+ */
+template <typename T>
+void multiply_into(const BasicMatrix<T>& a, const BasicMatrix<T>& b,
+                   BasicMatrix<T>& out);
+
+/**
+ * @brief Mixed-precision product: half-precision operands, float result
+ * @throws std::invalid_argument if the dimensions are incompatible
+ */
+void multiply_into(const BasicMatrix<Half>& a, const BasicMatrix<Half>& b,
+                   BasicMatrix<float>& out);
+
+/**
+ * @brief Mixed-precision product: bfloat16 operands, float result
+ * @throws std::invalid_argument if the dimensions are incompatible
+ */
+void multiply_into(const BasicMatrix<BFloat16>& a,
+                   const BasicMatrix<BFloat16>& b, BasicMatrix<float>& out);
+
 /**
  * @brief Create an identity matrix
  * @param n Dimension of the square identity matrix
  */
-Matrix identity(size_t n);
+template <typename T = double>
+BasicMatrix<T> identity(size_t n);
+
+// The members are compiled into the library for these element types.
+extern template class BasicMatrix<float>;
+extern template class BasicMatrix<double>;
+extern template class BasicMatrix<std::complex<float>>;
+extern template class BasicMatrix<std::complex<double>>;
+extern template class BasicMatrix<Half>;
+extern template class BasicMatrix<BFloat16>;
 
 } // namespace matrixops
@@ -0,0 +1,272 @@
+#pragma once
+
+#include <cassert>
+#include <complex>
+#include <cstddef>
+#include <stdexcept>
+#include <type_traits>
+
+#include "matrixops/expression.h"
+#include "matrixops/half.h"
+#include "matrixops/layout.h"
+#include "matrixops/scalar_traits.h"
+#include "matrixops/strided_span.h"
+
+namespace matrixops {
+
+template <typename T>
+class BasicMatrixView;
+
+namespace detail {
+
+/**
+ * @brief Copy src into dst, of the same dimensions and not overlapping it
+ * @throws std::invalid_argument if the dimensions differ
+ */
+template <typename T>
+void copy_views(BasicMatrixView<const T> src, BasicMatrixView<T> dst);
+
+} // namespace detail
+
+/**
+ * @brief Non-owning view of a rows x cols matrix in existing memory
+ *
+ * Element (i, j) is at data()[i * stride() + j * col_stride()]: a block
+ * of a Matrix, see BasicMatrix::block(), a transposed view of one, see
+ * transposed(), or external memory such as a NumPy buffer or a mapped
+ * file. T is the element type for mutable views and its const version
+ * for read-only ones; a Matrix converts to either implicitly.
+ *
+ * Views are expressions, so they are operands of `+` and `*` wherever a
+ * Matrix is: sums of views with unit column stride take the SIMD add
+ * kernels row by row, and products pass row-major and column-major views
+ * to gemm() through their leading dimension, without a copy. Like
+ * expressions, a view must not outlive the memory it refers to. An
+ * expression assigned to a matrix may view that matrix: views that do not
+ * line up with it element for element, such as transposed ones, are
+ * evaluated into a temporary first.
+ *
+ * Included by matrix.h.
+ */
+template <typename T>
+class BasicMatrixView : public MatrixExpression<BasicMatrixView<T>> {
+public:
+    using value_type = std::remove_const_t<T>;
+
+    /// Type of norm(), as for BasicMatrix
+    using real_type = typename detail::ScalarTraits<value_type>::real_type;
+
+    /**
+     * @brief View rows x cols elements at data, rows stride elements
+     * apart and columns col_stride apart
+     * @throws std::invalid_argument if a dimension is zero
+     */
+    BasicMatrixView(T* data, size_t rows, size_t cols, size_t stride,
+                    size_t col_stride = 1)
+        : data_(data), rows_(rows), cols_(cols), stride_(stride),
+          col_stride_(col_stride) {
+        if (rows == 0 || cols == 0) {
+            throw std::invalid_argument("Matrix dimensions must be positive");
+        }
+    }
+
+    /**
+     * @brief View a packed rows x cols matrix in the given layout
+     *
+     * A column-major buffer, as from Fortran, LAPACK or a NumPy array
+     * with order='F', is read and written in place.
+     * @throws std::invalid_argument if a dimension is zero
+     */
+    BasicMatrixView(T* data, size_t rows, size_t cols, Layout layout)
+        : BasicMatrixView(data, rows, cols,
+                          layout == Layout::ROW_MAJOR ? cols : 1,
+                          layout == Layout::ROW_MAJOR ? 1 : rows) {}
+
+    /**
+     * @brief View a whole matrix
+     */
+    BasicMatrixView(std::conditional_t<std::is_const_v<T>,
+                                       const BasicMatrix<value_type>,
+                                       BasicMatrix<value_type>>& m)
+        : BasicMatrixView(m.data(), m.rows(), m.cols(), m.stride()) {}
+
+    /**
+     * @brief Allow a mutable view to be passed where a const one is expected
+     */
+    template <typename U,
+              typename = std::enable_if_t<std::is_same_v<const U, T> &&
+                                          !std::is_same_v<U, T>>>
+    BasicMatrixView(const BasicMatrixView<U>& other)
+        : BasicMatrixView(other.data(), other.rows(), other.cols(),
+                          other.stride(), other.col_stride()) {}
+
+    /**
+     * @brief Get number of rows
+     */
+    size_t rows() const { return rows_; }
+
+    /**
+     * @brief Get number of columns
+     */
+    size_t cols() const { return cols_; }
+
+    /**
+     * @brief Pointer to element (0, 0)
+     */
+    T* data() const { return data_; }
+
+    /**
+     * @brief Leading dimension: distance, in elements, between rows
+     */
+    size_t stride() const { return stride_; }
+
+    /**
+     * @brief Distance, in elements, between columns; 1 unless strided
+     */
+    size_t col_stride() const { return col_stride_; }
+
+    /**
+     * @brief Check if the elements form one row-major block like a Matrix
+     */
+    bool is_contiguous() const {
+        return col_stride_ == 1 && (stride_ == cols_ || rows_ == 1);
+    }
+
+    /**
+     * @brief Access element (i, j)
+     * @throws std::out_of_range if an index is out of range
+     */
+    T& operator()(size_t i, size_t j) const {
+        if (i >= rows_ || j >= cols_) {
+            throw std::out_of_range("Matrix indices out of range");
+        }
+        return unchecked(i, j);
+    }
+
+    /**
+     * @brief Access element (i, j) without bounds checking
+     */
+    T& unchecked(size_t i, size_t j) const {
+        assert(i < rows_ && j < cols_);
+        return data_[i * stride_ + j * col_stride_];
+    }
+
+    /**
+     * @brief Element k in row-major order, without bounds checking
+     *
+     * Part of the MatrixExpression interface. It costs a division, so
+     * the assignments that can work row by row do.
+     */
+    value_type coeff(size_t k) const {
+        return unchecked(k / cols_, k % cols_);
+    }
+
+    /**
+     * @brief View of the rows x cols block with top-left corner (i, j)
+     * @throws std::out_of_range if the block does not fit in the view
+     */
+    BasicMatrixView block(size_t i, size_t j, size_t rows,
+                          size_t cols) const {
+        if (i >= rows_ || j >= cols_ || rows > rows_ - i ||
+            cols > cols_ - j) {
+            throw std::out_of_range("Matrix block out of range");
+        }
+        return BasicMatrixView(data_ + i * stride_ + j * col_stride_, rows,
+                               cols, stride_, col_stride_);
+    }
+
+    /**
+     * @brief View of the transpose, sharing the elements; see transpose()
+     * for a copy
+     */
+    BasicMatrixView transposed() const {
+        return BasicMatrixView(data_, cols_, rows_, col_stride_, stride_);
+    }
+
+    /**
+     * @brief View of row i
+     * @throws std::out_of_range if i is not a valid row
+     */
+    StridedSpan<T> row(size_t i) const {
+        if (i >= rows_) {
+            throw std::out_of_range("Matrix row index out of range");
+        }
+        return {data_ + i * stride_, cols_, col_stride_};
+    }
+
+    /**
+     * @brief View of column j
+     * @throws std::out_of_range if j is not a valid column
+     */
+    StridedSpan<T> col(size_t j) const {
+        if (j >= cols_) {
+            throw std::out_of_range("Matrix column index out of range");
+        }
+        return {data_ + j * col_stride_, rows_, stride_};
+    }
+
+    /**
+     * @brief Copy the elements of src, which has the same dimensions and
+     * does not overlap this view, into it
+     *
+     * Between a row-major and a column-major view this is a transpose of
+     * the memory, done with the cache-blocked transpose kernel, so a
+     * Matrix is exported to or imported from a column-major buffer at
+     * about the cost of a copy.
+     * @throws std::invalid_argument if the dimensions differ
+     */
+    template <typename U = T,
+              typename = std::enable_if_t<!std::is_const_v<U>>>
+    void copy_from(BasicMatrixView<const value_type> src) const {
+        detail::copy_views(src, *this);
+    }
+
+    /**
+     * @brief Copy of the transpose
+     */
+    BasicMatrix<value_type> transpose() const;
+
+    /**
+     * @brief Calculate Frobenius norm, as BasicMatrix::norm()
+     */
+    real_type norm() const;
+
+    /**
+     * @brief Check if the view is square
+     */
+    bool is_square() const { return rows_ == cols_; }
+
+private:
+    T* data_;
+    size_t rows_;
+    size_t cols_;
+    size_t stride_;
+    size_t col_stride_;
+};
+
+/**
+ * @brief Mutable view of double elements
+ */
+using MatrixView = BasicMatrixView<double>;
+
+/**
+ * @brief Read-only view of double elements
+ */
+using ConstMatrixView = BasicMatrixView<const double>;
+
+// The members are compiled into the library for the Matrix element types,
+// mutable and const.
+extern template class BasicMatrixView<float>;
+extern template class BasicMatrixView<const float>;
+extern template class BasicMatrixView<double>;
+extern template class BasicMatrixView<const double>;
+extern template class BasicMatrixView<std::complex<float>>;
+extern template class BasicMatrixView<const std::complex<float>>;
+extern template class BasicMatrixView<std::complex<double>>;
+extern template class BasicMatrixView<const std::complex<double>>;
+extern template class BasicMatrixView<Half>;
+extern template class BasicMatrixView<const Half>;
+extern template class BasicMatrixView<BFloat16>;
+extern template class BasicMatrixView<const BFloat16>;
+
+} // namespace matrixops
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstddef>
+
+namespace matrixops {
+
+/**
+ * @brief Where the pages of large Matrix buffers are placed on a NUMA host
+ */
+enum class NumaPolicy {
+    FIRST_TOUCH, ///< On the node of the thread that first writes each page
+    INTERLEAVE,  ///< Spread page by page over every node
+    BIND         ///< All on NumaSettings::node
+};
+
+/**
+ * @brief Memory and thread placement on NUMA hosts
+ *
+ * Buffers of 2 MiB or more are initialized and copied in parallel on the
+ * thread pool, so that with first-touch placement their pages are spread
+ * over the nodes the pool runs on instead of landing on the node of the
+ * constructing thread. INTERLEAVE and BIND apply to the heap buffers of
+ * that size allocated after the policy is set.
+ *
+ * With pin_threads, every pool worker is pinned to a core of its own, the
+ * workers spread over the nodes in contiguous groups in proportion to
+ * their cores, and parallel_for() gives every thread the same share of
+ * each range on every call, taking from the others only once its own is
+ * done. A buffer first touched by a parallel operation is
+ * then mostly read and written by threads of the node it lives on, by the
+ * element-wise operations and the rows of products alike. The calling
+ * thread is never pinned; it takes the first share.
+ *
+ * Defaults come from MATRIXOPS_NUMA ("first-touch", "interleave" or
+ * "bind:<node>") and MATRIXOPS_PIN_THREADS (1 pins). Placement is only
+ * implemented on Linux; elsewhere the settings are recorded and ignored.
+ */
+struct NumaSettings {
+    NumaPolicy policy = NumaPolicy::FIRST_TOUCH; ///< Page placement
+    size_t node = 0;          ///< Node of NumaPolicy::BIND
+    bool pin_threads = false; ///< Pin pool workers to cores, node by node
+};
+
+/**
+ * @brief Number of NUMA nodes the process may use, 1 on single-socket
+ * hosts and where the OS does not say
+ */
+size_t numa_nodes();
+
+/**
+ * @brief Get the current placement settings
+ */
+NumaSettings numa_settings();
+
+/**
+ * @brief Set the placement of new buffers and of the pool threads
+ *
+ * Changing pin_threads restarts the thread pool, like set_num_threads().
+ * @throws std::invalid_argument if policy is BIND and node is not below
+ * numa_nodes()
+ */
+void set_numa_settings(const NumaSettings& settings);
+
+/**
+ * @brief Name of a policy, as accepted by MATRIXOPS_NUMA
+ */
+const char* numa_policy_name(NumaPolicy policy);
+
+} // namespace matrixops
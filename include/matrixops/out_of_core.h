@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+namespace matrixops {
+
+/**
+ * @brief Smallest budget accepted by set_out_of_core_budget(), 1 MiB
+ */
+constexpr size_t MIN_OUT_OF_CORE_BUDGET = size_t{1} << 20;
+
+/**
+ * @brief Get the memory budget of the out-of-core operations, in bytes
+ *
+ * multiply_files(), transpose_file() and add_files() size their tile
+ * buffers, two per operand so that the next tile can be read while the
+ * current one is processed, to fit in the budget. The default is 1 GiB.
+ * The inputs are mapped, and the pages read from them are page cache that
+ * the system can reclaim at any time; they do not count against the
+ * budget.
+ */
+size_t out_of_core_budget();
+
+/**
+ * @brief Set the memory budget of the out-of-core operations
+ * @throws std::invalid_argument if bytes is below MIN_OUT_OF_CORE_BUDGET
+ */
+void set_out_of_core_budget(size_t bytes);
+
+/**
+ * @brief Multiply two matrix files, out = a * b, in tiles
+ *
+ * For operands too large for memory, in the format of save_matrix(). The
+ * tiles of a and b are read on a background thread one step ahead of the
+ * gemm() that consumes them, and each finished tile of the result is
+ * written on another while the next one is computed. Half and BFloat16
+ * products are accumulated in float across the tiles and rounded once.
+ * An existing out file is replaced.
+ * @throws std::runtime_error if a file cannot be read or written, see
+ * read_matrix_file_info()
+ * @throws std::invalid_argument if the element types differ, the
+ * dimensions are incompatible, or out is a or b
+ */
+void multiply_files(const std::string& a, const std::string& b,
+                    const std::string& out);
+
+/**
+ * @brief Transpose a matrix file into out, in tiles
+ *
+ * Square tiles are read, transposed and written with the same overlap as
+ * multiply_files().
+ * @throws std::runtime_error if a file cannot be read or written
+ * @throws std::invalid_argument if out is a
+ */
+void transpose_file(const std::string& a, const std::string& out);
+
+/**
+ * @brief Add two matrix files, out = a + b, in contiguous chunks
+ * @throws std::runtime_error if a file cannot be read or written
+ * @throws std::invalid_argument if the element types or dimensions differ,
+ * or out is a or b
+ */
+void add_files(const std::string& a, const std::string& b,
+               const std::string& out);
+
+} // namespace matrixops
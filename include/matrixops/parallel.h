@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+
+namespace matrixops {
+
+/**
+ * @brief Non-owning reference to a callable taking a chunk (begin, end)
+ *
+ * Unlike std::function it never allocates, whatever the callable
+ * captures. The callable must outlive the reference, which holds for a
+ * lambda passed straight to parallel_for.
+ */
+class RangeFunction {
+public:
+    template <typename F,
+              typename = std::enable_if_t<
+                  !std::is_same_v<std::decay_t<F>, RangeFunction>>>
+    RangeFunction(F&& f) noexcept
+        : object_(const_cast<void*>(
+              static_cast<const void*>(std::addressof(f)))),
+          call_(&invoke<std::remove_reference_t<F>>) {}
+
+    void operator()(size_t begin, size_t end) const {
+        call_(object_, begin, end);
+    }
+
+private:
+    template <typename F>
+    static void invoke(void* object, size_t begin, size_t end) {
+        (*static_cast<F*>(object))(begin, end);
+    }
+
+    void* object_;
+    void (*call_)(void*, size_t, size_t);
+};
+
+/**
+ * @brief Get the number of threads used by parallel operations
+ *
+ * Defaults to the MATRIXOPS_NUM_THREADS environment variable, or the
+ * hardware concurrency if it is unset. The calling thread counts as one
+ * of them.
+ */
+size_t num_threads();
+
+/**
+ * @brief Set the number of threads used by parallel operations
+ *
+ * Resizes the library thread pool. Passing 0 restores the default; passing
+ * 1 runs every operation on the calling thread.
+ */
+void set_num_threads(size_t n);
+
+/**
+ * @brief Run body over [begin, end) split into chunks on the thread pool
+ *
+ * body(chunk_begin, chunk_end) is called for disjoint chunks covering the
+ * range, each at least grain long (except maybe the last). Ranges no
+ * longer than grain run inline on the calling thread. The calling thread
+ * takes part in the work, and may run other queued pool tasks while it
+ * waits, so parallel_for may be nested. The first exception thrown by
+ * body is rethrown once all chunks have finished. With pinned workers,
+ * each thread starts on the same share of the chunks on every call, see
+ * NumaSettings.
+ */
+void parallel_for(size_t begin, size_t end, size_t grain,
+                  RangeFunction body);
+
+} // namespace matrixops
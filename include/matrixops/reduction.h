@@ -0,0 +1,50 @@
+#pragma once
+
+namespace matrixops {
+
+/**
+ * @brief How norm(), nrm2() and dot() accumulate
+ *
+ * The sums are split into fixed blocks of ELEMENTWISE_GRAIN terms whatever
+ * the thread count and tuning, so every mode gives the same result for any
+ * number of threads. FAST sums each block with the vector kernels of the
+ * active instruction set, whose lane count, and so rounding, changes with
+ * it. The other modes give the same bits on every instruction set,
+ * compiler and thread count, as long as the library is not built with
+ * -ffast-math: blocks are summed in eight fixed lanes, and the block sums
+ * combined in a fixed pairwise tree. float, Half and BFloat16 terms are
+ * accumulated in double in every mode but FAST.
+ *
+ * BM_NormMode and BM_DotMode compare the modes. On 8192 x 8192 double
+ * operands, bound by memory bandwidth, one AVX-512 core measures
+ * REPRODUCIBLE about 1.3-1.6x, COMPENSATED 2-4x and EXACT 10-12x slower
+ * than FAST. Operands that fit in cache lose the vector kernels instead:
+ * there REPRODUCIBLE is up to 10x slower.
+ */
+enum class ReductionMode {
+    FAST,         ///< Vector kernels of the active instruction set
+    REPRODUCIBLE, ///< Fixed lanes and tree: error bound of pairwise sums
+    COMPENSATED,  ///< REPRODUCIBLE with error-free sums and products:
+                  ///< about as accurate as twice the working precision
+    EXACT         ///< Exact accumulation, rounded once to double
+};
+
+/**
+ * @brief Get the mode of the reductions
+ *
+ * Defaults to the MATRIXOPS_REDUCTION environment variable ("fast",
+ * "reproducible", "compensated" or "exact"), or FAST if it is unset.
+ */
+ReductionMode reduction_mode();
+
+/**
+ * @brief Set the mode of the reductions, for every thread
+ */
+void set_reduction_mode(ReductionMode mode);
+
+/**
+ * @brief Lowercase name of a mode, as accepted by MATRIXOPS_REDUCTION
+ */
+const char* reduction_mode_name(ReductionMode mode);
+
+} // namespace matrixops
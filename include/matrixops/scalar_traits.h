@@ -0,0 +1,37 @@
+#pragma once
+
+#include <complex>
+
+#include "matrixops/half.h"
+
+namespace matrixops {
+namespace detail {
+
+// real_type is the type of norm(); compute_type is the type arithmetic is
+// carried out in, float for the 16-bit storage formats.
+template <typename T>
+struct ScalarTraits {
+    using real_type = T;
+    using compute_type = T;
+};
+
+template <typename R>
+struct ScalarTraits<std::complex<R>> {
+    using real_type = R;
+    using compute_type = std::complex<R>;
+};
+
+template <>
+struct ScalarTraits<Half> {
+    using real_type = float;
+    using compute_type = float;
+};
+
+template <>
+struct ScalarTraits<BFloat16> {
+    using real_type = float;
+    using compute_type = float;
+};
+
+} // namespace detail
+} // namespace matrixops
@@ -0,0 +1,128 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <utility>
+
+#include "matrixops/expression.h"
+#include "matrixops/matrix.h"
+
+namespace matrixops {
+
+/**
+ * @brief Copy-on-write handle to a matrix shared between its copies
+ *
+ * For read-mostly matrices, such as configuration fanned out to many
+ * worker threads: copying a SharedMatrix only counts a reference, and
+ * copies may be made concurrently from the same handle. Reads go
+ * straight to the shared Matrix; write() gives the handle a private copy
+ * first if other handles still refer to it, so no copy observes another's
+ * writes. Plain Matrix keeps value semantics and pays nothing for this.
+ *
+ * A SharedMatrix is an expression and converts to `const Matrix&`, so it
+ * can be an operand of `+` and `*` or be passed wherever a read-only
+ * matrix is expected.
+ */
+template <typename T>
+class BasicSharedMatrix : public MatrixExpression<BasicSharedMatrix<T>> {
+public:
+    using value_type = T;
+    using real_type = typename BasicMatrix<T>::real_type;
+
+    /**
+     * @brief Take over m; pass std::move(m) to avoid a copy
+     */
+    explicit BasicSharedMatrix(BasicMatrix<T> m)
+        : matrix_(std::make_shared<BasicMatrix<T>>(std::move(m))) {}
+
+    /**
+     * @brief The shared matrix, read-only
+     */
+    const BasicMatrix<T>& get() const { return *matrix_; }
+
+    operator const BasicMatrix<T>&() const { return *matrix_; }
+
+    /**
+     * @brief The matrix of this handle for writing
+     *
+     * Copies the elements first, from the current_resource(), if another
+     * handle refers to them. The reference is valid until this handle is
+     * next copied from, assigned or destroyed.
+     */
+    BasicMatrix<T>& write() {
+        if (matrix_.use_count() != 1) {
+            matrix_ = std::make_shared<BasicMatrix<T>>(*matrix_);
+        } else {
+            // Orders the reads of handles released by other threads before
+            // the writes through this one.
+            std::atomic_thread_fence(std::memory_order_acquire);
+        }
+        return *matrix_;
+    }
+
+    /**
+     * @brief Check if other handles refer to the same elements
+     */
+    bool is_shared() const { return matrix_.use_count() > 1; }
+
+    /**
+     * @brief Get number of rows
+     */
+    size_t rows() const { return matrix_->rows(); }
+
+    /**
+     * @brief Get number of columns
+     */
+    size_t cols() const { return matrix_->cols(); }
+
+    /**
+     * @brief Leading dimension, as BasicMatrix::stride()
+     */
+    size_t stride() const { return matrix_->stride(); }
+
+    /**
+     * @brief Pointer to the shared elements
+     */
+    const T* data() const { return matrix_->data(); }
+
+    /**
+     * @brief Read element (i, j)
+     * @throws std::out_of_range if an index is out of range
+     */
+    T operator()(size_t i, size_t j) const { return (*matrix_)(i, j); }
+
+    /**
+     * @brief Read element (i, j) without bounds checking
+     */
+    T unchecked(size_t i, size_t j) const {
+        return matrix_->unchecked(i, j);
+    }
+
+    /**
+     * @brief Element k in row-major order, without bounds checking
+     *
+     * Part of the MatrixExpression interface.
+     */
+    T coeff(size_t k) const { return matrix_->coeff(k); }
+
+private:
+    std::shared_ptr<BasicMatrix<T>> matrix_;
+};
+
+/**
+ * @brief Shared matrix of double, the default element type
+ */
+using SharedMatrix = BasicSharedMatrix<double>;
+
+namespace detail {
+
+// Expressions hold shared operands by reference, like Matrix operands.
+template <typename T>
+struct ExpressionRef<BasicSharedMatrix<T>> {
+    using type = const BasicSharedMatrix<T>&;
+};
+
+} // namespace detail
+
+} // namespace matrixops
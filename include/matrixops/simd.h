@@ -0,0 +1,43 @@
+#pragma once
+
+namespace matrixops {
+
+/**
+ * @brief Instruction set variants of the vectorized kernels
+ */
+enum class SimdIsa {
+    SCALAR, ///< Portable C++ loops
+    SSE2,   ///< x86-64 baseline, 128-bit
+    AVX2,   ///< 256-bit with FMA
+    AVX512, ///< 512-bit AVX-512F
+    NEON    ///< AArch64 Advanced SIMD, 128-bit
+};
+
+/**
+ * @brief Get the instruction set used by the element-wise, norm and GEMM
+ * kernels
+ *
+ * The best variant supported by the host CPU and OS is selected once when
+ * the library is loaded. The MATRIXOPS_SIMD environment variable (scalar,
+ * sse2, avx2, avx512 or neon) caps the selection.
+ */
+SimdIsa simd_isa();
+
+/**
+ * @brief Check whether kernels for the given instruction set are available
+ * on this host
+ */
+bool simd_isa_supported(SimdIsa isa);
+
+/**
+ * @brief Force the kernels of a given instruction set
+ * @throws std::invalid_argument if the host cannot run them
+ */
+void set_simd_isa(SimdIsa isa);
+
+/**
+ * @brief Get the lowercase name of an instruction set, e.g. "avx2"
+ */
+const char* simd_isa_name(SimdIsa isa);
+
+} // namespace matrixops
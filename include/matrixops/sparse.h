@@ -0,0 +1,278 @@
+#pragma once
+
+#include <complex>
+#include <cstddef>
+#include <vector>
+
+#include "matrixops/matrix.h"
+#include "matrixops/vector.h"
+
+namespace matrixops {
+
+/**
+ * @brief Storage order of a BasicSparseMatrix
+ */
+enum class SparseLayout {
+    CSR, ///< Compressed sparse row: the entries of each row are contiguous
+    CSC  ///< Compressed sparse column
+};
+
+/**
+ * @brief Sparse matrix in compressed row (CSR) or column (CSC) form
+ *
+ * Only the stored entries take memory: the outer dimension (rows for
+ * CSR, columns for CSC) indexes offsets(), and the entries of outer slice
+ * o are indices()[k] and values()[k] for k in [offsets()[o],
+ * offsets()[o + 1]). Inner indices are strictly increasing within each
+ * slice. Entries that are not stored are zero.
+ *
+ * Use a BasicSparseBuilder to assemble one from (i, j, value) triplets.
+ * CSR is the layout of choice for products, which are split across the
+ * thread pool by nonzero count; CSC makes column access cheap. The element
+ * type T is float, double, std::complex<float> or std::complex<double>;
+ * SparseMatrix is the double version.
+ */
+template <typename T>
+class BasicSparseMatrix {
+public:
+    using value_type = T;
+    using real_type = typename detail::ScalarTraits<T>::real_type;
+
+    /**
+     * @brief Construct a matrix with no stored entries
+     * @throws std::invalid_argument if rows or cols is 0
+     */
+    BasicSparseMatrix(size_t rows, size_t cols,
+                      SparseLayout layout = SparseLayout::CSR);
+
+    /**
+     * @brief Take ownership of compressed arrays
+     * @param offsets Start of each outer slice, plus nnz at the end
+     * @param indices Inner index of each entry
+     * @param values Value of each entry
+     * @throws std::invalid_argument if the arrays are not a valid
+     * rows x cols matrix in the given layout
+     */
+    BasicSparseMatrix(size_t rows, size_t cols, SparseLayout layout,
+                      std::vector<size_t> offsets,
+                      std::vector<size_t> indices, std::vector<T> values);
+
+    /**
+     * @brief Store the nonzero elements of a dense matrix
+     */
+    explicit BasicSparseMatrix(const BasicMatrix<T>& dense,
+                               SparseLayout layout = SparseLayout::CSR);
+
+    /**
+     * @brief Get number of rows
+     */
+    size_t rows() const { return rows_; }
+
+    /**
+     * @brief Get number of columns
+     */
+    size_t cols() const { return cols_; }
+
+    /**
+     * @brief Number of stored entries
+     */
+    size_t nnz() const { return values_.size(); }
+
+    /**
+     * @brief Get the storage order
+     */
+    SparseLayout layout() const { return layout_; }
+
+    /**
+     * @brief Start of each outer slice: rows() + 1 entries for CSR,
+     * cols() + 1 for CSC
+     */
+    const size_t* offsets() const { return offsets_.data(); }
+
+    /**
+     * @brief Inner index (column for CSR, row for CSC) of each entry
+     */
+    const size_t* indices() const { return indices_.data(); }
+
+    /**
+     * @brief Value of each entry
+     *
+     * Writable, so that a matrix with a fixed pattern can be refilled
+     * without rebuilding it.
+     */
+    T* values() { return values_.data(); }
+
+    /**
+     * @brief Value of each entry (const version)
+     */
+    const T* values() const { return values_.data(); }
+
+    /**
+     * @brief Get element (i, j), zero if it is not stored
+     *
+     * A binary search over the slice; iterate over the arrays instead in
+     * loops.
+     * @throws std::out_of_range if the indices are out of range
+     */
+    T operator()(size_t i, size_t j) const;
+
+    /**
+     * @brief Expand into a dense matrix
+     */
+    BasicMatrix<T> to_dense() const;
+
+    /**
+     * @brief Copy into the given layout
+     */
+    BasicSparseMatrix convert(SparseLayout layout) const;
+
+    /**
+     * @brief Transpose matrix, keeping the layout
+     */
+    BasicSparseMatrix transpose() const;
+
+    /**
+     * @brief Calculate Frobenius norm
+     *
+     * Accumulated in double and safe from overflow, as for BasicMatrix.
+     */
+    real_type norm() const;
+
+    /**
+     * @brief Sparse matrix-vector product
+     * @throws std::invalid_argument if x.size() is not cols()
+     */
+    std::vector<T> operator*(const std::vector<T>& x) const;
+
+    /**
+     * @brief Sparse matrix-vector product
+     * @throws std::invalid_argument if x.size() is not cols()
+     */
+    BasicVector<T> operator*(const BasicVector<T>& x) const;
+
+    /**
+     * @brief Sparse times dense product
+     * @throws std::invalid_argument if dense.rows() is not cols()
+     */
+    BasicMatrix<T> operator*(const BasicMatrix<T>& dense) const;
+
+private:
+    size_t rows_;
+    size_t cols_;
+    SparseLayout layout_;
+    std::vector<size_t> offsets_;
+    std::vector<size_t> indices_;
+    std::vector<T> values_;
+
+    size_t outer_size() const {
+        return layout_ == SparseLayout::CSR ? rows_ : cols_;
+    }
+
+    size_t inner_size() const {
+        return layout_ == SparseLayout::CSR ? cols_ : rows_;
+    }
+
+    void validate() const;
+};
+
+/**
+ * @brief Sparse matrix of double, the default element type
+ */
+using SparseMatrix = BasicSparseMatrix<double>;
+
+/**
+ * @brief Compute y = a * x
+ *
+ * y is resized to a.rows(), which does not allocate once it has the
+ * capacity. A CSC matrix is split across the thread pool by column, each
+ * chunk with its own partial result, which costs a temporary per chunk.
+ * @throws std::invalid_argument if x.size() is not a.cols() or y is x
+ */
+template <typename T>
+void multiply_into(const BasicSparseMatrix<T>& a, const std::vector<T>& x,
+                   std::vector<T>& y);
+
+/**
+ * @brief Compute y = a * x, as for std::vector
+ * @throws std::invalid_argument if x.size() is not a.cols(), y.size() is
+ * not a.rows(), or y is x
+ */
+template <typename T>
+void multiply_into(const BasicSparseMatrix<T>& a, const BasicVector<T>& x,
+                   BasicVector<T>& y);
+
+/**
+ * @brief Compute out = a * b into caller-owned storage
+ * @throws std::invalid_argument if the dimensions are incompatible or out
+ * is b
+ */
+template <typename T>
+void multiply_into(const BasicSparseMatrix<T>& a, const BasicMatrix<T>& b,
+                   BasicMatrix<T>& out);
+
+/**
+ * @brief Coordinate-format (COO) assembly of a BasicSparseMatrix
+ *
+ * add() appends a triplet in O(1), in any order; build() sorts them with
+ * two counting passes, O(nnz + rows + cols), and sums the duplicates, as
+ * finite element assembly needs. Summed entries are kept even when they
+ * cancel to zero, so the pattern only depends on the calls to add().
+ */
+template <typename T>
+class BasicSparseBuilder {
+public:
+    /**
+     * @throws std::invalid_argument if rows or cols is 0
+     */
+    BasicSparseBuilder(size_t rows, size_t cols);
+
+    /**
+     * @brief Reserve room for n triplets
+     */
+    void reserve(size_t n);
+
+    /**
+     * @brief Add value to element (i, j)
+     * @throws std::out_of_range if the indices are out of range
+     */
+    void add(size_t i, size_t j, T value);
+
+    /**
+     * @brief Number of triplets added, counting duplicates
+     */
+    size_t size() const { return values_.size(); }
+
+    /**
+     * @brief Remove every triplet, keeping the storage
+     */
+    void clear();
+
+    /**
+     * @brief Assemble the matrix; the builder is left unchanged
+     */
+    BasicSparseMatrix<T> build(SparseLayout layout = SparseLayout::CSR) const;
+
+private:
+    size_t rows_;
+    size_t cols_;
+    std::vector<size_t> row_indices_;
+    std::vector<size_t> col_indices_;
+    std::vector<T> values_;
+};
+
+/**
+ * @brief Builder of SparseMatrix
+ */
+using SparseBuilder = BasicSparseBuilder<double>;
+
+// The members are compiled into the library for these element types.
+extern template class BasicSparseMatrix<float>;
+extern template class BasicSparseMatrix<double>;
+extern template class BasicSparseMatrix<std::complex<float>>;
+extern template class BasicSparseMatrix<std::complex<double>>;
+extern template class BasicSparseBuilder<float>;
+extern template class BasicSparseBuilder<double>;
+extern template class BasicSparseBuilder<std::complex<float>>;
+extern template class BasicSparseBuilder<std::complex<double>>;
+
+} // namespace matrixops
@@ -0,0 +1,185 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+
+#include "matrixops/allocator.h"
+#include "matrixops/parallel.h"
+
+namespace matrixops {
+
+/**
+ * @brief Largest element storage, in bytes, kept inside a Matrix object
+ *
+ * A 4 x 4 matrix of double fits. Matrices this small are created, copied
+ * and destroyed without touching a memory resource.
+ */
+constexpr size_t SMALL_MATRIX_BYTES = 128;
+
+/**
+ * @brief Smallest element storage, in bytes, filled and copied in parallel
+ *
+ * The pool threads write such buffers page by page, so that first-touch
+ * placement spreads them over the NUMA nodes, see NumaSettings.
+ */
+constexpr size_t PARALLEL_INIT_BYTES = size_t{2} << 20;
+
+namespace detail {
+
+/**
+ * @brief Call f(first, last) over the n elements of a T buffer, in
+ * page-aligned pieces on the thread pool from PARALLEL_INIT_BYTES on
+ */
+template <typename T, typename F>
+void for_each_page(size_t n, const F& f) {
+    constexpr size_t PAGE_ELEMENTS = std::max<size_t>(4096 / sizeof(T), 1);
+    constexpr size_t PAGES_PER_TASK = 64;
+    if (n * sizeof(T) < PARALLEL_INIT_BYTES) {
+        f(size_t{0}, n);
+        return;
+    }
+    const size_t pages = (n + PAGE_ELEMENTS - 1) / PAGE_ELEMENTS;
+    parallel_for(0, pages, PAGES_PER_TASK, [&](size_t first, size_t last) {
+        f(first * PAGE_ELEMENTS, std::min(n, last * PAGE_ELEMENTS));
+    });
+}
+
+#if defined(_MSC_VER)
+#pragma warning(push)
+#pragma warning(disable : 4324) // padded due to the aligned inline buffer
+#endif
+
+/**
+ * @brief Element storage of BasicMatrix
+ *
+ * Up to SMALL_MATRIX_BYTES live in an inline buffer aligned to
+ * STORAGE_ALIGNMENT; larger arrays come from the current_resource() of
+ * the constructing or copying thread, and moves keep them.
+ */
+template <typename T>
+class MatrixStorage {
+    static_assert(std::is_trivially_copyable_v<T> &&
+                      std::is_trivially_destructible_v<T>,
+                  "Matrix elements are copied as plain bytes");
+
+public:
+    static constexpr size_t INLINE_CAPACITY = SMALL_MATRIX_BYTES / sizeof(T);
+
+    /**
+     * @brief Default-initialized storage: zero for complex types,
+     * indeterminate for the others
+     */
+    explicit MatrixStorage(size_t n) : size_(n) {
+        allocate();
+        if constexpr (!std::is_trivially_default_constructible_v<T>) {
+            for_each_page<T>(n, [this](size_t first, size_t last) {
+                std::uninitialized_default_construct_n(data_ + first,
+                                                       last - first);
+            });
+        }
+    }
+
+    MatrixStorage(size_t n, const T& value) : size_(n) {
+        allocate();
+        for_each_page<T>(n, [this, &value](size_t first, size_t last) {
+            std::uninitialized_fill_n(data_ + first, last - first, value);
+        });
+    }
+
+    MatrixStorage(const MatrixStorage& other) : size_(other.size_) {
+        allocate();
+        copy_from(other);
+    }
+
+    MatrixStorage(MatrixStorage&& other) noexcept : size_(other.size_) {
+        take(other);
+    }
+
+    MatrixStorage& operator=(const MatrixStorage& other) {
+        if (this == &other) {
+            return *this;
+        }
+        if (size_ == other.size_) {
+            // Same size: reuse this buffer, as std::vector would.
+            copy_from(other);
+            return *this;
+        }
+        MatrixStorage copy(other);
+        return *this = std::move(copy);
+    }
+
+    MatrixStorage& operator=(MatrixStorage&& other) noexcept {
+        if (this != &other) {
+            release();
+            size_ = other.size_;
+            take(other);
+        }
+        return *this;
+    }
+
+    ~MatrixStorage() { release(); }
+
+    size_t size() const { return size_; }
+
+    T* data() { return data_; }
+    const T* data() const { return data_; }
+
+private:
+    T* data_ = nullptr;
+    size_t size_;
+    // Owner of a heap buffer, or null for the inline buffer.
+    MemoryResource* resource_ = nullptr;
+    alignas(STORAGE_ALIGNMENT) unsigned char inline_[SMALL_MATRIX_BYTES];
+
+    T* inline_data() { return reinterpret_cast<T*>(inline_); }
+
+    void allocate() {
+        if (size_ <= INLINE_CAPACITY) {
+            data_ = inline_data();
+            return;
+        }
+        if (size_ > std::numeric_limits<size_t>::max() / sizeof(T)) {
+            throw std::length_error("Matrix storage size overflows");
+        }
+        resource_ = &current_resource();
+        data_ = static_cast<T*>(resource_->allocate(size_ * sizeof(T)));
+    }
+
+    void copy_from(const MatrixStorage& other) {
+        for_each_page<T>(size_, [this, &other](size_t first, size_t last) {
+            std::copy_n(other.data_ + first, last - first, data_ + first);
+        });
+    }
+
+    // Move other's elements in; other is left empty.
+    void take(MatrixStorage& other) noexcept {
+        if (other.resource_ == nullptr) {
+            data_ = inline_data();
+            resource_ = nullptr;
+            std::copy_n(other.data_, size_, data_);
+        } else {
+            data_ = other.data_;
+            resource_ = other.resource_;
+            other.data_ = other.inline_data();
+            other.resource_ = nullptr;
+        }
+        other.size_ = 0;
+    }
+
+    void release() noexcept {
+        if (resource_ != nullptr) {
+            resource_->deallocate(data_, size_ * sizeof(T));
+        }
+    }
+};
+
+#if defined(_MSC_VER)
+#pragma warning(pop)
+#endif
+
+} // namespace detail
+} // namespace matrixops
@@ -0,0 +1,150 @@
+#pragma once
+
+#include <cstddef>
+#include <iterator>
+#include <type_traits>
+
+namespace matrixops {
+
+/**
+ * @brief Non-owning view of size elements spaced stride elements apart
+ *
+ * A row of a row-major Matrix is a StridedSpan with stride 1, a column one
+ * with stride equal to the leading dimension. T is the element type for
+ * mutable views and its const version for read-only ones. Element access
+ * is unchecked.
+ */
+template <typename T>
+class StridedSpan {
+public:
+    // Iterators keep an index rather than a pointer, so end() of a column
+    // view never points beyond the underlying buffer.
+    class iterator {
+    public:
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = std::remove_cv_t<T>;
+        using difference_type = std::ptrdiff_t;
+        using pointer = T*;
+        using reference = T&;
+
+        iterator() = default;
+        iterator(T* data, size_t index, size_t stride)
+            : data_(data), index_(index), stride_(stride) {}
+
+        reference operator*() const { return data_[index_ * stride_]; }
+        reference operator[](difference_type k) const {
+            return *(*this + k);
+        }
+
+        iterator& operator++() {
+            ++index_;
+            return *this;
+        }
+        iterator operator++(int) {
+            iterator old = *this;
+            ++index_;
+            return old;
+        }
+        iterator& operator--() {
+            --index_;
+            return *this;
+        }
+        iterator operator--(int) {
+            iterator old = *this;
+            --index_;
+            return old;
+        }
+        iterator& operator+=(difference_type k) {
+            index_ = static_cast<size_t>(
+                static_cast<difference_type>(index_) + k);
+            return *this;
+        }
+        iterator& operator-=(difference_type k) { return *this += -k; }
+
+        friend iterator operator+(iterator it, difference_type k) {
+            return it += k;
+        }
+        friend iterator operator+(difference_type k, iterator it) {
+            return it += k;
+        }
+        friend iterator operator-(iterator it, difference_type k) {
+            return it -= k;
+        }
+        friend difference_type operator-(const iterator& a,
+                                         const iterator& b) {
+            return static_cast<difference_type>(a.index_) -
+                   static_cast<difference_type>(b.index_);
+        }
+
+        friend bool operator==(const iterator& a, const iterator& b) {
+            return a.index_ == b.index_;
+        }
+        friend bool operator!=(const iterator& a, const iterator& b) {
+            return a.index_ != b.index_;
+        }
+        friend bool operator<(const iterator& a, const iterator& b) {
+            return a.index_ < b.index_;
+        }
+        friend bool operator>(const iterator& a, const iterator& b) {
+            return b < a;
+        }
+        friend bool operator<=(const iterator& a, const iterator& b) {
+            return !(b < a);
+        }
+        friend bool operator>=(const iterator& a, const iterator& b) {
+            return !(a < b);
+        }
+
+    private:
+        T* data_ = nullptr;
+        size_t index_ = 0;
+        size_t stride_ = 1;
+    };
+
+    StridedSpan(T* data, size_t size, size_t stride = 1)
+        : data_(data), size_(size), stride_(stride) {}
+
+    /**
+     * @brief Allow a mutable view to be passed where a const one is expected
+     */
+    template <typename U,
+              typename = std::enable_if_t<std::is_same_v<const U, T> &&
+                                          !std::is_same_v<U, T>>>
+    StridedSpan(const StridedSpan<U>& other)
+        : data_(other.data()), size_(other.size()), stride_(other.stride()) {}
+
+    /**
+     * @brief Pointer to the first element
+     */
+    T* data() const { return data_; }
+
+    /**
+     * @brief Number of elements in the view
+     */
+    size_t size() const { return size_; }
+
+    /**
+     * @brief Distance, in elements, between consecutive elements
+     */
+    size_t stride() const { return stride_; }
+
+    /**
+     * @brief Check if the elements are adjacent in memory
+     */
+    bool is_contiguous() const { return stride_ == 1 || size_ <= 1; }
+
+    /**
+     * @brief Element k, without bounds checking
+     */
+    T& operator[](size_t k) const { return data_[k * stride_]; }
+
+    iterator begin() const { return iterator(data_, 0, stride_); }
+    iterator end() const { return iterator(data_, size_, stride_); }
+
+private:
+    T* data_;
+    size_t size_;
+    size_t stride_;
+};
+
+} // namespace matrixops
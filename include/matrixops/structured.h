@@ -0,0 +1,553 @@
+#pragma once
+
+#include <complex>
+#include <cstddef>
+#include <vector>
+
+#include "matrixops/allocator.h"
+#include "matrixops/matrix.h"
+#include "matrixops/vector.h"
+
+namespace matrixops {
+
+/**
+ * @brief Which half of a BasicTriangularMatrix holds its elements
+ */
+enum class Triangle {
+    LOWER, ///< Elements (i, j) with j <= i
+    UPPER  ///< Elements (i, j) with j >= i
+};
+
+/**
+ * @brief Offset of element (i, j), with j <= i, in packed lower-triangle
+ * storage: the rows of the triangle one after the other
+ */
+constexpr size_t packed_index(size_t i, size_t j) {
+    return i * (i + 1) / 2 + j;
+}
+
+/**
+ * @brief Square identity matrix, which stores nothing
+ *
+ * Products with it copy the other operand and sums with it add to the
+ * diagonal, in O(n^2) at most. identity() still returns a dense Matrix;
+ * use this type where the structure should be kept. The element type T
+ * is float, double, std::complex<float> or std::complex<double>;
+ * IdentityMatrix is the double version.
+ */
+template <typename T>
+class BasicIdentityMatrix {
+public:
+    using value_type = T;
+    using real_type = typename detail::ScalarTraits<T>::real_type;
+
+    /**
+     * @throws std::invalid_argument if n is 0
+     */
+    explicit BasicIdentityMatrix(size_t n);
+
+    /**
+     * @brief Get number of rows
+     */
+    size_t rows() const { return n_; }
+
+    /**
+     * @brief Get number of columns
+     */
+    size_t cols() const { return n_; }
+
+    /**
+     * @brief Get element (i, j): 1 on the diagonal, 0 elsewhere
+     * @throws std::out_of_range if the indices are out of range
+     */
+    T operator()(size_t i, size_t j) const;
+
+    /**
+     * @brief Expand into a dense matrix, as identity()
+     */
+    BasicMatrix<T> to_dense() const;
+
+    /**
+     * @brief Transpose matrix: the matrix itself
+     */
+    BasicIdentityMatrix transpose() const { return *this; }
+
+    /**
+     * @brief Calculate Frobenius norm, sqrt(n)
+     */
+    real_type norm() const;
+
+    /**
+     * @brief Matrix multiplication: a copy of other
+     * @throws std::invalid_argument if other.rows() is not cols()
+     */
+    BasicMatrix<T> operator*(const BasicMatrix<T>& other) const;
+
+    /**
+     * @brief Matrix-vector product: a copy of x
+     * @throws std::invalid_argument if x.size() is not cols()
+     */
+    BasicVector<T> operator*(const BasicVector<T>& x) const;
+
+    /**
+     * @brief Addition: other with 1 added to its diagonal
+     * @throws std::invalid_argument if the dimensions differ
+     */
+    BasicMatrix<T> operator+(const BasicMatrix<T>& other) const;
+
+private:
+    size_t n_;
+};
+
+/**
+ * @brief Identity matrix of double, the default element type
+ */
+using IdentityMatrix = BasicIdentityMatrix<double>;
+
+/**
+ * @brief Square diagonal matrix, storing only its diagonal
+ *
+ * Products with a dense matrix scale its rows or columns, in O(n^2)
+ * instead of O(n^3), and sums add to the diagonal only. The element types
+ * are those of BasicIdentityMatrix; DiagonalMatrix is the double version.
+ */
+template <typename T>
+class BasicDiagonalMatrix {
+public:
+    using value_type = T;
+    using real_type = typename detail::ScalarTraits<T>::real_type;
+
+    /**
+     * @brief Construct value times the identity
+     * @throws std::invalid_argument if n is 0
+     */
+    explicit BasicDiagonalMatrix(size_t n, T value = T(1));
+
+    /**
+     * @brief Construct a matrix with the elements of a vector on its
+     * diagonal, e.g. the Jacobi preconditioner of a system
+     */
+    explicit BasicDiagonalMatrix(const BasicVector<T>& diagonal);
+
+    /**
+     * @brief The identity as a diagonal matrix
+     */
+    explicit BasicDiagonalMatrix(const BasicIdentityMatrix<T>& identity)
+        : BasicDiagonalMatrix(identity.rows()) {}
+
+    /**
+     * @brief Get number of rows
+     */
+    size_t rows() const { return data_.size(); }
+
+    /**
+     * @brief Get number of columns
+     */
+    size_t cols() const { return data_.size(); }
+
+    /**
+     * @brief Get element (i, j), zero off the diagonal
+     * @throws std::out_of_range if the indices are out of range
+     */
+    T operator()(size_t i, size_t j) const;
+
+    /**
+     * @brief Pointer to the rows() diagonal elements
+     */
+    T* data() { return data_.data(); }
+
+    /**
+     * @brief Pointer to the diagonal elements (const version)
+     */
+    const T* data() const { return data_.data(); }
+
+    /**
+     * @brief Expand into a dense matrix
+     */
+    BasicMatrix<T> to_dense() const;
+
+    /**
+     * @brief Transpose matrix: a copy of the matrix
+     */
+    BasicDiagonalMatrix transpose() const { return *this; }
+
+    /**
+     * @brief Calculate Frobenius norm, that of the diagonal
+     */
+    real_type norm() const;
+
+    /**
+     * @brief Product of diagonal matrices, element by element
+     * @throws std::invalid_argument if the dimensions differ
+     */
+    BasicDiagonalMatrix operator*(const BasicDiagonalMatrix& other) const;
+
+    /**
+     * @brief Matrix multiplication: row i of other scaled by element i
+     * @throws std::invalid_argument if other.rows() is not cols()
+     */
+    BasicMatrix<T> operator*(const BasicMatrix<T>& other) const;
+
+    /**
+     * @brief Matrix-vector product, element by element
+     * @throws std::invalid_argument if x.size() is not cols()
+     */
+    BasicVector<T> operator*(const BasicVector<T>& x) const;
+
+    /**
+     * @brief Sum of diagonal matrices
+     * @throws std::invalid_argument if the dimensions differ
+     */
+    BasicDiagonalMatrix operator+(const BasicDiagonalMatrix& other) const;
+
+    /**
+     * @brief Addition: other with the diagonal added to its own
+     * @throws std::invalid_argument if the dimensions differ
+     */
+    BasicMatrix<T> operator+(const BasicMatrix<T>& other) const;
+
+private:
+    std::vector<T, detail::StorageAllocator<T>> data_;
+};
+
+/**
+ * @brief Diagonal matrix of double, the default element type
+ */
+using DiagonalMatrix = BasicDiagonalMatrix<double>;
+
+/**
+ * @brief Square symmetric matrix in packed storage
+ *
+ * Only the lower triangle is stored, row by row: element (i, j) is at
+ * packed()[packed_index(max(i, j), min(i, j))], n(n + 1)/2 elements in
+ * all, about half the memory of a dense matrix. Products with dense
+ * matrices unpack it into a temporary of at most 128 MiB, whole up to
+ * n = 4096 in double and in slabs of rows or columns beyond, and multiply
+ * that with gemm(), so they take about the time of a dense product.
+ * gram() computes A^T A directly in this form, with half the multiply-adds
+ * of the dense product. The element types are those of
+ * BasicIdentityMatrix; SymmetricMatrix is the double version. For complex
+ * types the matrix is symmetric, not Hermitian.
+ */
+template <typename T>
+class BasicSymmetricMatrix {
+public:
+    using value_type = T;
+    using real_type = typename detail::ScalarTraits<T>::real_type;
+
+    /**
+     * @brief Construct an n x n matrix with every element init_value
+     * @throws std::invalid_argument if n is 0
+     */
+    explicit BasicSymmetricMatrix(size_t n, T init_value = T(0));
+
+    /**
+     * @brief Store the lower triangle of a square dense matrix; the upper
+     * one is not read
+     * @throws std::invalid_argument if dense is not square
+     */
+    explicit BasicSymmetricMatrix(const BasicMatrix<T>& dense);
+
+    /**
+     * @brief Get number of rows
+     */
+    size_t rows() const { return n_; }
+
+    /**
+     * @brief Get number of columns
+     */
+    size_t cols() const { return n_; }
+
+    /**
+     * @brief Access element (i, j), the same element as (j, i)
+     * @throws std::out_of_range if the indices are out of range
+     */
+    T& operator()(size_t i, size_t j);
+
+    /**
+     * @brief Access element (i, j) (const version)
+     */
+    T operator()(size_t i, size_t j) const;
+
+    /**
+     * @brief Pointer to the packed lower triangle
+     */
+    T* packed() { return data_.data(); }
+
+    /**
+     * @brief Pointer to the packed lower triangle (const version)
+     */
+    const T* packed() const { return data_.data(); }
+
+    /**
+     * @brief Expand into a dense matrix
+     */
+    BasicMatrix<T> to_dense() const;
+
+    /**
+     * @brief Transpose matrix: a copy of the matrix
+     */
+    BasicSymmetricMatrix transpose() const { return *this; }
+
+    /**
+     * @brief Calculate Frobenius norm, counting the off-diagonal elements
+     * twice
+     */
+    real_type norm() const;
+
+    /**
+     * @brief Matrix multiplication
+     * @throws std::invalid_argument if other.rows() is not cols()
+     */
+    BasicMatrix<T> operator*(const BasicMatrix<T>& other) const;
+
+    /**
+     * @brief Matrix-vector product, reading the packed triangle once
+     * @throws std::invalid_argument if x.size() is not cols()
+     */
+    BasicVector<T> operator*(const BasicVector<T>& x) const;
+
+    /**
+     * @brief Sum of symmetric matrices, on the packed triangles
+     * @throws std::invalid_argument if the dimensions differ
+     */
+    BasicSymmetricMatrix operator+(const BasicSymmetricMatrix& other) const;
+
+    /**
+     * @brief Addition of a dense matrix
+     * @throws std::invalid_argument if the dimensions differ
+     */
+    BasicMatrix<T> operator+(const BasicMatrix<T>& other) const;
+
+private:
+    size_t n_;
+    std::vector<T, detail::StorageAllocator<T>> data_;
+};
+
+/**
+ * @brief Symmetric matrix of double, the default element type
+ */
+using SymmetricMatrix = BasicSymmetricMatrix<double>;
+
+/**
+ * @brief Square lower or upper triangular matrix in packed storage
+ *
+ * The triangle is stored as the lower triangle of the matrix or, for
+ * UPPER, of its transpose: element (i, j) of the triangle is at
+ * packed()[packed_index(max(i, j), min(i, j))] either way, so that
+ * transpose() only flips triangle(). Products skip the zero half, in
+ * the manner of TRMM: half the multiply-adds of a dense product with a
+ * dense matrix, and a sixth with a triangular one. The element types are
+ * those of BasicIdentityMatrix; TriangularMatrix is the double version.
+ */
+template <typename T>
+class BasicTriangularMatrix {
+public:
+    using value_type = T;
+    using real_type = typename detail::ScalarTraits<T>::real_type;
+
+    /**
+     * @brief Construct an n x n matrix with every element of the triangle
+     * init_value
+     * @throws std::invalid_argument if n is 0
+     */
+    BasicTriangularMatrix(size_t n, Triangle triangle, T init_value = T(0));
+
+    /**
+     * @brief Store one triangle of a square dense matrix; the elements
+     * outside it are not read
+     * @throws std::invalid_argument if dense is not square
+     */
+    BasicTriangularMatrix(const BasicMatrix<T>& dense, Triangle triangle);
+
+    /**
+     * @brief Get number of rows
+     */
+    size_t rows() const { return n_; }
+
+    /**
+     * @brief Get number of columns
+     */
+    size_t cols() const { return n_; }
+
+    /**
+     * @brief Get the half that holds the elements
+     */
+    Triangle triangle() const { return triangle_; }
+
+    /**
+     * @brief Get element (i, j), zero outside the triangle
+     * @throws std::out_of_range if the indices are out of range
+     */
+    T operator()(size_t i, size_t j) const;
+
+    /**
+     * @brief Pointer to the packed triangle, laid out as described above
+     */
+    T* packed() { return data_.data(); }
+
+    /**
+     * @brief Pointer to the packed triangle (const version)
+     */
+    const T* packed() const { return data_.data(); }
+
+    /**
+     * @brief Expand into a dense matrix
+     */
+    BasicMatrix<T> to_dense() const;
+
+    /**
+     * @brief Transpose matrix: the same packed elements in the other
+     * triangle
+     */
+    BasicTriangularMatrix transpose() const;
+
+    /**
+     * @brief Calculate Frobenius norm
+     */
+    real_type norm() const;
+
+    /**
+     * @brief Product of triangular matrices, itself triangular
+     * @throws std::invalid_argument if the dimensions or the triangles
+     * differ
+     */
+    BasicTriangularMatrix operator*(const BasicTriangularMatrix& other) const;
+
+    /**
+     * @brief Matrix multiplication, skipping the zero half
+     * @throws std::invalid_argument if other.rows() is not cols()
+     */
+    BasicMatrix<T> operator*(const BasicMatrix<T>& other) const;
+
+    /**
+     * @brief Matrix-vector product
+     * @throws std::invalid_argument if x.size() is not cols()
+     */
+    BasicVector<T> operator*(const BasicVector<T>& x) const;
+
+    /**
+     * @brief Sum of triangular matrices, on the packed triangles
+     * @throws std::invalid_argument if the dimensions or the triangles
+     * differ
+     */
+    BasicTriangularMatrix operator+(const BasicTriangularMatrix& other) const;
+
+    /**
+     * @brief Addition of a dense matrix
+     * @throws std::invalid_argument if the dimensions differ
+     */
+    BasicMatrix<T> operator+(const BasicMatrix<T>& other) const;
+
+private:
+    size_t n_;
+    Triangle triangle_;
+    std::vector<T, detail::StorageAllocator<T>> data_;
+};
+
+/**
+ * @brief Triangular matrix of double, the default element type
+ */
+using TriangularMatrix = BasicTriangularMatrix<double>;
+
+/**
+ * @brief Dense times identity: a copy of a
+ * @throws std::invalid_argument if a.cols() is not b.rows()
+ */
+template <typename T>
+BasicMatrix<T> operator*(const BasicMatrix<T>& a,
+                         const BasicIdentityMatrix<T>& b);
+
+/**
+ * @brief Dense times diagonal: column j of a scaled by element j
+ * @throws std::invalid_argument if a.cols() is not b.rows()
+ */
+template <typename T>
+BasicMatrix<T> operator*(const BasicMatrix<T>& a,
+                         const BasicDiagonalMatrix<T>& b);
+
+/**
+ * @brief Dense times symmetric
+ * @throws std::invalid_argument if a.cols() is not b.rows()
+ */
+template <typename T>
+BasicMatrix<T> operator*(const BasicMatrix<T>& a,
+                         const BasicSymmetricMatrix<T>& b);
+
+/**
+ * @brief Dense times triangular, skipping the zero half
+ * @throws std::invalid_argument if a.cols() is not b.rows()
+ */
+template <typename T>
+BasicMatrix<T> operator*(const BasicMatrix<T>& a,
+                         const BasicTriangularMatrix<T>& b);
+
+/**
+ * @brief Addition with the identity on the right
+ * @throws std::invalid_argument if the dimensions differ
+ */
+template <typename T>
+BasicMatrix<T> operator+(const BasicMatrix<T>& a,
+                         const BasicIdentityMatrix<T>& b) {
+    return b + a;
+}
+
+/**
+ * @brief Addition with a diagonal matrix on the right
+ * @throws std::invalid_argument if the dimensions differ
+ */
+template <typename T>
+BasicMatrix<T> operator+(const BasicMatrix<T>& a,
+                         const BasicDiagonalMatrix<T>& b) {
+    return b + a;
+}
+
+/**
+ * @brief Addition with a symmetric matrix on the right
+ * @throws std::invalid_argument if the dimensions differ
+ */
+template <typename T>
+BasicMatrix<T> operator+(const BasicMatrix<T>& a,
+                         const BasicSymmetricMatrix<T>& b) {
+    return b + a;
+}
+
+/**
+ * @brief Addition with a triangular matrix on the right
+ * @throws std::invalid_argument if the dimensions differ
+ */
+template <typename T>
+BasicMatrix<T> operator+(const BasicMatrix<T>& a,
+                         const BasicTriangularMatrix<T>& b) {
+    return b + a;
+}
+
+/**
+ * @brief Gram matrix A^T A, as SYRK: only its lower triangle is computed,
+ * with half the multiply-adds of `a.transpose() * a`
+ *
+ * The covariance of centred samples stored one per row of a is
+ * gram(a) scaled by 1 / (a.rows() - 1).
+ */
+template <typename T>
+BasicSymmetricMatrix<T> gram(const BasicMatrix<T>& a);
+
+// The members are compiled into the library for these element types.
+extern template class BasicIdentityMatrix<float>;
+extern template class BasicIdentityMatrix<double>;
+extern template class BasicIdentityMatrix<std::complex<float>>;
+extern template class BasicIdentityMatrix<std::complex<double>>;
+extern template class BasicDiagonalMatrix<float>;
+extern template class BasicDiagonalMatrix<double>;
+extern template class BasicDiagonalMatrix<std::complex<float>>;
+extern template class BasicDiagonalMatrix<std::complex<double>>;
+extern template class BasicSymmetricMatrix<float>;
+extern template class BasicSymmetricMatrix<double>;
+extern template class BasicSymmetricMatrix<std::complex<float>>;
+extern template class BasicSymmetricMatrix<std::complex<double>>;
+extern template class BasicTriangularMatrix<float>;
+extern template class BasicTriangularMatrix<double>;
+extern template class BasicTriangularMatrix<std::complex<float>>;
+extern template class BasicTriangularMatrix<std::complex<double>>;
+
+} // namespace matrixops
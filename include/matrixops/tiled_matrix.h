@@ -0,0 +1,240 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <complex>
+#include <cstddef>
+#include <stdexcept>
+#include <vector>
+
+#include "matrixops/half.h"
+#include "matrixops/matrix.h"
+#include "matrixops/storage.h"
+
+namespace matrixops {
+
+/**
+ * @brief Side, in elements, of the square tiles of BasicTiledMatrix
+ *
+ * A tile of double is 32 KiB, which fits in L1 for the tile-local
+ * transposes and copies.
+ */
+constexpr size_t MATRIX_TILE = 64;
+
+/**
+ * @brief Dense matrix stored in square tiles laid out in Morton order
+ *
+ * The matrix is cut into MATRIX_TILE x MATRIX_TILE tiles, each stored
+ * row-major in one contiguous block; the tiles follow the Z-order curve
+ * of their (row, column) tile coordinates, so tiles that are close in
+ * the matrix, in either direction, are close in memory. Edge tiles are
+ * padded with zeros to full size, which lets every kernel work on whole
+ * tiles:
+ *
+ * - transpose() transposes each tile in cache and moves it to its mirror
+ *   position, instead of the strided walk a row-major transpose needs;
+ * - products gather rows and columns of tiles into panels for gemm(),
+ *   one 512 x 512 block of the result at a time;
+ * - sums and norms run over the storage as one flat array.
+ *
+ * Converting from and to BasicMatrix, or any row-major or column-major
+ * view, copies tile by tile through the transpose and copy kernels, so it
+ * costs about as much as a copy. Use a tiled matrix for transpose-heavy
+ * or locality-bound workloads and convert at the boundaries; Matrix
+ * remains the row-major type the rest of the library works on.
+ */
+template <typename T>
+class BasicTiledMatrix {
+public:
+    using value_type = T;
+    using real_type = typename detail::ScalarTraits<T>::real_type;
+
+    /**
+     * @brief Construct a rows x cols matrix of zeros
+     * @throws std::invalid_argument if rows or cols is 0
+     */
+    BasicTiledMatrix(size_t rows, size_t cols);
+
+    /**
+     * @brief Construct a rows x cols matrix with every element set to value
+     * @throws std::invalid_argument if rows or cols is 0
+     */
+    BasicTiledMatrix(size_t rows, size_t cols, const T& value);
+
+    /**
+     * @brief Convert from a view in any layout, or from a Matrix
+     */
+    explicit BasicTiledMatrix(BasicMatrixView<const T> m);
+
+    /**
+     * @brief Convert to a row-major Matrix
+     */
+    BasicMatrix<T> to_matrix() const;
+
+    /**
+     * @brief Copy the elements into a view of the same dimensions, such as
+     * a column-major buffer
+     * @throws std::invalid_argument if the dimensions differ
+     */
+    void copy_to(BasicMatrixView<T> dst) const;
+
+    /**
+     * @brief Get number of rows
+     */
+    size_t rows() const { return rows_; }
+
+    /**
+     * @brief Get number of columns
+     */
+    size_t cols() const { return cols_; }
+
+    /**
+     * @brief Number of tiles down the matrix
+     */
+    size_t tile_rows() const { return tile_rows_; }
+
+    /**
+     * @brief Number of tiles across the matrix
+     */
+    size_t tile_cols() const { return tile_cols_; }
+
+    /**
+     * @brief View of tile (ti, tj), without its padding
+     * @throws std::out_of_range if the tile does not exist
+     */
+    BasicMatrixView<T> tile(size_t ti, size_t tj);
+
+    /**
+     * @brief Read-only view of tile (ti, tj), without its padding
+     * @throws std::out_of_range if the tile does not exist
+     */
+    BasicMatrixView<const T> tile(size_t ti, size_t tj) const;
+
+    /**
+     * @brief Access element (i, j)
+     * @throws std::out_of_range if an index is out of range
+     */
+    T& operator()(size_t i, size_t j) {
+        check_index(i, j);
+        return unchecked(i, j);
+    }
+
+    /**
+     * @brief Read element (i, j)
+     * @throws std::out_of_range if an index is out of range
+     */
+    const T& operator()(size_t i, size_t j) const {
+        check_index(i, j);
+        return unchecked(i, j);
+    }
+
+    /**
+     * @brief Access element (i, j) without bounds checking
+     */
+    T& unchecked(size_t i, size_t j) {
+        assert(i < rows_ && j < cols_);
+        return data_.data()[offset(i, j)];
+    }
+
+    /**
+     * @brief Read element (i, j) without bounds checking
+     */
+    const T& unchecked(size_t i, size_t j) const {
+        assert(i < rows_ && j < cols_);
+        return data_.data()[offset(i, j)];
+    }
+
+    /**
+     * @brief Transpose, tile by tile
+     */
+    BasicTiledMatrix transpose() const;
+
+    /**
+     * @brief Matrix addition
+     * @throws std::invalid_argument if the dimensions differ
+     */
+    BasicTiledMatrix operator+(const BasicTiledMatrix& other) const;
+
+    /**
+     * @brief In-place matrix addition
+     * @throws std::invalid_argument if the dimensions differ
+     */
+    BasicTiledMatrix& operator+=(const BasicTiledMatrix& other);
+
+    /**
+     * @brief Matrix multiplication; Half and BFloat16 tiles are accumulated
+     * in float and rounded once
+     * @throws std::invalid_argument if the inner dimensions differ
+     */
+    BasicTiledMatrix operator*(const BasicTiledMatrix& other) const;
+
+    /**
+     * @brief Calculate Frobenius norm, as BasicMatrix::norm()
+     */
+    real_type norm() const;
+
+private:
+    static constexpr size_t TILE_ELEMENTS = MATRIX_TILE * MATRIX_TILE;
+
+    size_t rows_;
+    size_t cols_;
+    size_t tile_rows_;
+    size_t tile_cols_;
+    // Storage position of each tile, by ti * tile_cols_ + tj, and the
+    // tile in each storage position: the Morton order and its inverse.
+    std::vector<size_t> slot_;
+    std::vector<size_t> order_;
+    detail::MatrixStorage<T> data_;
+
+    // Tiles with their padding zeroed and the rest uninitialized.
+    BasicTiledMatrix(size_t rows, size_t cols, UninitializedTag);
+
+    // Call f(ti, tj) for every tile, in storage order, across the pool in
+    // tasks of grain tiles.
+    template <typename F>
+    void for_each_tile(size_t grain, const F& f) const;
+
+    T* tile_data(size_t ti, size_t tj) {
+        return data_.data() + slot_[ti * tile_cols_ + tj] * TILE_ELEMENTS;
+    }
+
+    const T* tile_data(size_t ti, size_t tj) const {
+        return data_.data() + slot_[ti * tile_cols_ + tj] * TILE_ELEMENTS;
+    }
+
+    // Elements of tile (ti, tj) that lie inside the matrix.
+    size_t tile_height(size_t ti) const {
+        return std::min(MATRIX_TILE, rows_ - ti * MATRIX_TILE);
+    }
+
+    size_t tile_width(size_t tj) const {
+        return std::min(MATRIX_TILE, cols_ - tj * MATRIX_TILE);
+    }
+
+    size_t offset(size_t i, size_t j) const {
+        const size_t tile =
+            slot_[i / MATRIX_TILE * tile_cols_ + j / MATRIX_TILE];
+        return tile * TILE_ELEMENTS + i % MATRIX_TILE * MATRIX_TILE +
+               j % MATRIX_TILE;
+    }
+
+    void check_index(size_t i, size_t j) const {
+        if (i >= rows_ || j >= cols_) {
+            throw std::out_of_range("Matrix indices out of range");
+        }
+    }
+};
+
+/**
+ * @brief Tiled matrix of double, the default element type
+ */
+using TiledMatrix = BasicTiledMatrix<double>;
+
+extern template class BasicTiledMatrix<float>;
+extern template class BasicTiledMatrix<double>;
+extern template class BasicTiledMatrix<std::complex<float>>;
+extern template class BasicTiledMatrix<std::complex<double>>;
+extern template class BasicTiledMatrix<Half>;
+extern template class BasicTiledMatrix<BFloat16>;
+
+} // namespace matrixops
@@ -0,0 +1,127 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+#include "matrixops/gemm.h"
+
+namespace matrixops {
+
+/**
+ * @brief Data and unified cache sizes of the host, in bytes
+ *
+ * Read with CPUID on x86 and from the OS elsewhere; sizes it cannot find
+ * keep these defaults.
+ */
+struct CacheTopology {
+    size_t l1d = size_t{32} << 10; ///< Level-1 data cache, per core
+    size_t l2 = size_t{1} << 20;   ///< Level-2 cache, per core
+    size_t l3 = size_t{32} << 20;  ///< Last-level cache, shared
+    size_t cores = 1;              ///< Hardware threads
+};
+
+/**
+ * @brief Get the cache topology of the host, detected once
+ */
+CacheTopology cache_topology();
+
+/**
+ * @brief Machine-dependent parameters of the kernels, as one set
+ *
+ * When the library is loaded, it applies the per-host profile at
+ * tuning_profile_path() if there is a readable one, or else
+ * heuristic_tuning(). Setting MATRIXOPS_AUTOTUNE to "off" keeps the
+ * built-in defaults instead; setting it to "on" runs autotune() at the
+ * first product when there is no profile, and saves the result there.
+ * The defaults below are the built-in ones; start from tuning_profile()
+ * to change only some of the parameters.
+ */
+struct TuningProfile {
+    GemmBlocking blocking;             ///< Packed GEMM block sizes
+    size_t strassen_crossover = 1024;  ///< StrassenSettings::crossover
+    size_t blas_threshold = 32768;     ///< See blas_threshold()
+    size_t elementwise_grain = 32768;  ///< Elements per task of element-wise
+                                       ///< kernels and transposes
+    size_t transpose_block = 32;       ///< Side of in-place transpose blocks
+};
+
+/**
+ * @brief Get the parameters currently in use
+ */
+TuningProfile tuning_profile();
+
+/**
+ * @brief Apply a set of parameters
+ *
+ * Rounding follows set_gemm_blocking(); transpose_block is rounded up to
+ * a multiple of the largest transpose tile, 8. Changing the parameters
+ * while other threads run operations is safe, but an operation may see a
+ * mix of old and new values.
+ * @throws std::invalid_argument if any parameter is zero
+ */
+void set_tuning_profile(const TuningProfile& profile);
+
+/**
+ * @brief Parameters derived from cache sizes: GEMM panels sized to half
+ * of the cache they live in, tasks to half of L2, transpose block pairs
+ * to half of L1
+ *
+ * The Strassen crossover and BLAS threshold are the current values.
+ */
+TuningProfile heuristic_tuning(const CacheTopology& topology);
+
+/**
+ * @brief Options of autotune()
+ */
+struct AutotuneOptions {
+    size_t gemm_size = 1024;         ///< Side of the products timed
+    size_t elementwise_size = 2048;  ///< Side of the element-wise operands
+    int trials = 3;                  ///< Runs per candidate; the best counts
+    bool strassen = false;           ///< Also search the Strassen crossover
+    size_t max_strassen_size = 2048; ///< Largest product tried for it
+};
+
+/**
+ * @brief Time candidate parameters on this host and apply the fastest
+ *
+ * Starts from heuristic_tuning() and searches each parameter in turn:
+ * kc, mc and nc on operator*, the task grain on addition, scaling and
+ * transpose(), and the block of transpose_inplace(). With a vendor BLAS,
+ * the threshold is set to the smallest cube on which it wins. Takes a few
+ * seconds with the default options, and uses the current thread count.
+ * @return The parameters applied
+ */
+TuningProfile autotune(const AutotuneOptions& options = {});
+
+/**
+ * @brief Where the per-host profile is kept
+ *
+ * MATRIXOPS_TUNING_PROFILE if set, otherwise matrixops/<hostname>.profile
+ * under the user cache directory (XDG_CACHE_HOME, ~/.cache or
+ * LOCALAPPDATA). Empty if none of them is known.
+ */
+std::string tuning_profile_path();
+
+/**
+ * @brief Write a profile as "key = value" lines, creating its directory
+ * @throws std::runtime_error if the file cannot be written
+ */
+void save_tuning_profile(const std::string& path,
+                         const TuningProfile& profile);
+
+/**
+ * @brief Read a profile written by save_tuning_profile()
+ *
+ * Parameters missing from the file keep their current values, and
+ * unknown keys are ignored.
+ * @throws std::runtime_error if the file cannot be read or is malformed
+ */
+TuningProfile load_tuning_profile(const std::string& path);
+
+/**
+ * @brief Where the parameters in use came from: "builtin", "heuristic",
+ * "profile", "autotune" or "user", for set_tuning_profile()
+ */
+const char* tuning_source();
+
+} // namespace matrixops
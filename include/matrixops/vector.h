@@ -0,0 +1,208 @@
+#pragma once
+
+#include <cassert>
+#include <complex>
+#include <cstddef>
+#include <initializer_list>
+#include <stdexcept>
+#include <vector>
+
+#include "matrixops/allocator.h"
+#include "matrixops/matrix.h"
+
+namespace matrixops {
+
+/**
+ * @brief Dense vector with the BLAS level 1 and 2 operations
+ *
+ * A first-class alternative to an n x 1 Matrix for iterative methods:
+ * matrix-vector products go through gemv() instead of the GEMM driver. The
+ * storage is aligned and allocated like BasicMatrix storage. The element
+ * type T is float, double, std::complex<float> or std::complex<double>;
+ * Vector is the double version. float and double use the SIMD kernels,
+ * and operations on large vectors are split across the thread pool.
+ */
+template <typename T>
+class BasicVector {
+public:
+    using value_type = T;
+    using real_type = typename detail::ScalarTraits<T>::real_type;
+
+    /**
+     * @brief Construct a vector of size elements
+     * @param init_value Initial value for all elements (default: 0.0)
+     * @throws std::invalid_argument if size is 0
+     */
+    explicit BasicVector(size_t size, T init_value = T(0));
+
+    /**
+     * @brief Construct a vector without initializing its elements
+     *
+     * Every element must be written before it is read.
+     */
+    BasicVector(size_t size, UninitializedTag);
+
+    /**
+     * @brief Construct from a list of elements, e.g. `Vector v{1, 2, 3}`
+     * @throws std::invalid_argument if the list is empty
+     */
+    BasicVector(std::initializer_list<T> values);
+
+    /**
+     * @brief Get number of elements
+     */
+    size_t size() const { return data_.size(); }
+
+    /**
+     * @brief Access element i
+     * @throws std::out_of_range if i is not a valid index
+     */
+    T& operator()(size_t i);
+
+    /**
+     * @brief Access element i (const version)
+     */
+    T operator()(size_t i) const;
+
+    /**
+     * @brief Access element i without bounds checking
+     */
+    T& unchecked(size_t i) {
+        assert(i < data_.size());
+        return data_[i];
+    }
+
+    /**
+     * @brief Access element i without bounds checking (const version)
+     */
+    T unchecked(size_t i) const {
+        assert(i < data_.size());
+        return data_[i];
+    }
+
+    /**
+     * @brief Pointer to the contiguous elements
+     */
+    T* data() { return data_.data(); }
+
+    /**
+     * @brief Pointer to the contiguous elements (const version)
+     */
+    const T* data() const { return data_.data(); }
+
+    /**
+     * @brief Vector addition
+     * @throws std::invalid_argument if the sizes differ
+     */
+    BasicVector operator+(const BasicVector& other) const;
+
+    /**
+     * @brief Vector subtraction
+     * @throws std::invalid_argument if the sizes differ
+     */
+    BasicVector operator-(const BasicVector& other) const;
+
+    /**
+     * @brief Scalar multiplication
+     */
+    BasicVector operator*(T scalar) const;
+
+    /**
+     * @brief In-place addition
+     * @throws std::invalid_argument if the sizes differ
+     */
+    BasicVector& operator+=(const BasicVector& other);
+
+    /**
+     * @brief In-place subtraction
+     * @throws std::invalid_argument if the sizes differ
+     */
+    BasicVector& operator-=(const BasicVector& other);
+
+    /**
+     * @brief In-place scalar multiplication (BLAS scal)
+     */
+    BasicVector& operator*=(T scalar);
+
+    /**
+     * @brief Euclidean norm, see nrm2()
+     */
+    real_type norm() const;
+
+private:
+    std::vector<T, detail::StorageAllocator<T>> data_;
+};
+
+/**
+ * @brief Vector of double, the default element type
+ */
+using Vector = BasicVector<double>;
+
+/**
+ * @brief Dot product: the sum of conj(x[i]) * y[i]
+ *
+ * The first argument is conjugated for complex types, like BLAS dotc.
+ * @throws std::invalid_argument if the sizes differ
+ */
+template <typename T>
+T dot(const BasicVector<T>& x, const BasicVector<T>& y);
+
+/**
+ * @brief Compute y += alpha * x
+ * @throws std::invalid_argument if the sizes differ
+ */
+template <typename T>
+void axpy(T alpha, const BasicVector<T>& x, BasicVector<T>& y);
+
+/**
+ * @brief Euclidean norm
+ *
+ * Safe from overflow and underflow, like BLAS nrm2: the fast sum of
+ * squares is rescaled by the largest magnitude when it leaves the double
+ * range.
+ */
+template <typename T>
+typename BasicVector<T>::real_type nrm2(const BasicVector<T>& x);
+
+/**
+ * @brief Compute y = alpha * a * x + beta * y
+ *
+ * y is not read when beta is zero, as in BLAS.
+ * @throws std::invalid_argument if x.size() is not a.cols(), y.size() is
+ * not a.rows(), or y is x
+ */
+template <typename T>
+void gemv(T alpha, const BasicMatrix<T>& a, const BasicVector<T>& x, T beta,
+          BasicVector<T>& y);
+
+/**
+ * @brief Rank-1 update: compute a += alpha * x * y^T
+ * @throws std::invalid_argument if x.size() is not a.rows() or y.size()
+ * is not a.cols()
+ */
+template <typename T>
+void ger(T alpha, const BasicVector<T>& x, const BasicVector<T>& y,
+         BasicMatrix<T>& a);
+
+/**
+ * @brief Compute y = a * x into caller-owned storage
+ * @throws std::invalid_argument as gemv()
+ */
+template <typename T>
+void multiply_into(const BasicMatrix<T>& a, const BasicVector<T>& x,
+                   BasicVector<T>& y);
+
+/**
+ * @brief Matrix-vector product
+ * @throws std::invalid_argument if x.size() is not a.cols()
+ */
+template <typename T>
+BasicVector<T> operator*(const BasicMatrix<T>& a, const BasicVector<T>& x);
+
+// Compiled into the library for these element types.
+extern template class BasicVector<float>;
+extern template class BasicVector<double>;
+extern template class BasicVector<std::complex<float>>;
+extern template class BasicVector<std::complex<double>>;
+
+} // namespace matrixops
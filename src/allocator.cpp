@@ -0,0 +1,140 @@
+#include "matrixops/allocator.h"
+
+#include <algorithm>
+#include <atomic>
+#include <stdexcept>
+#include <string>
+
+#include "env.h"
+#include "instrumentation.h"
+#include "numa.h"
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
+
+namespace matrixops {
+
+namespace {
+
+// Buffers this large are aligned to, and may be backed by, huge pages.
+constexpr size_t HUGE_PAGE_SIZE = size_t{2} << 20;
+
+size_t round_up(size_t value, size_t multiple) {
+    return (value + multiple - 1) / multiple * multiple;
+}
+
+size_t alignment_for(size_t bytes) {
+    return bytes >= HUGE_PAGE_SIZE ? HUGE_PAGE_SIZE : STORAGE_ALIGNMENT;
+}
+
+std::atomic<bool>& huge_pages_flag() {
+    static std::atomic<bool> enabled{
+        detail::get_env("MATRIXOPS_HUGE_PAGES") == "1"};
+    return enabled;
+}
+
+class HeapResource : public MemoryResource {
+public:
+    void* allocate(size_t bytes) override {
+        const size_t alignment = alignment_for(bytes);
+        // Aligned operator new needs a multiple of the alignment on some
+        // platforms, and madvise works on whole pages.
+        const size_t size = round_up(std::max<size_t>(bytes, 1), alignment);
+        void* p = ::operator new(size, std::align_val_t{alignment});
+        MATRIXOPS_RECORD_ALLOCATION(bytes);
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+        if (alignment == HUGE_PAGE_SIZE && huge_pages()) {
+            // Advisory only: without THP support the call fails harmlessly.
+            madvise(p, size, MADV_HUGEPAGE);
+        }
+#endif
+        if (alignment == HUGE_PAGE_SIZE) {
+            detail::place_pages(p, size);
+        }
+        return p;
+    }
+
+    void deallocate(void* p, size_t bytes) noexcept override {
+        ::operator delete(p, std::align_val_t{alignment_for(bytes)});
+    }
+};
+
+thread_local MemoryResource* active_resource = nullptr;
+
+} // namespace
+
+MemoryResource& heap_resource() {
+    static HeapResource resource;
+    return resource;
+}
+
+bool huge_pages() { return huge_pages_flag().load(); }
+
+void set_huge_pages(bool enabled) { huge_pages_flag().store(enabled); }
+
+MemoryResource& current_resource() {
+    return active_resource ? *active_resource : heap_resource();
+}
+
+ScopedResource::ScopedResource(MemoryResource& resource)
+    : previous_(active_resource) {
+    active_resource = &resource;
+}
+
+ScopedResource::~ScopedResource() { active_resource = previous_; }
+
+Arena::Arena(size_t chunk_bytes, MemoryResource& upstream)
+    : upstream_(&upstream), chunk_bytes_(chunk_bytes) {
+    if (chunk_bytes == 0) {
+        throw std::invalid_argument("Arena chunk size must be positive");
+    }
+}
+
+Arena::~Arena() {
+    for (const Chunk& chunk : chunks_) {
+        upstream_->deallocate(chunk.data, chunk.size);
+    }
+}
+
+void* Arena::allocate(size_t bytes) {
+    const size_t size = round_up(std::max<size_t>(bytes, 1), STORAGE_ALIGNMENT);
+    // Move on through the chunks kept from before the last reset() until
+    // one has room, and only then ask upstream for a new one.
+    while (current_ < chunks_.size() &&
+           chunks_[current_].size - offset_ < size) {
+        ++current_;
+        offset_ = 0;
+    }
+    if (current_ == chunks_.size()) {
+        const size_t chunk_size = std::max(chunk_bytes_, size);
+        chunks_.reserve(chunks_.size() + 1);
+        chunks_.push_back(
+            {static_cast<char*>(upstream_->allocate(chunk_size)), chunk_size});
+        capacity_ += chunk_size;
+        offset_ = 0;
+    }
+    void* p = chunks_[current_].data + offset_;
+    offset_ += size;
+    used_ += size;
+    return p;
+}
+
+void Arena::deallocate(void* p, size_t bytes) noexcept {
+    // Reclaim the most recent allocation, so short-lived temporaries that
+    // die in LIFO order keep reusing the same (cache-hot) memory.
+    const size_t size = round_up(std::max<size_t>(bytes, 1), STORAGE_ALIGNMENT);
+    if (current_ < chunks_.size() && offset_ >= size &&
+        p == chunks_[current_].data + offset_ - size) {
+        offset_ -= size;
+        used_ -= size;
+    }
+}
+
+void Arena::reset() noexcept {
+    current_ = 0;
+    offset_ = 0;
+    used_ = 0;
+}
+
+} // namespace matrixops
@@ -0,0 +1,74 @@
+#include "matrixops/async.h"
+
+#include <chrono>
+
+#include "thread_pool.h"
+
+namespace matrixops {
+namespace detail {
+
+namespace {
+
+// How often a worker waiting for a result, with nothing queued to run
+// meanwhile, checks the queues again.
+constexpr std::chrono::microseconds WAIT_POLL{100};
+
+} // namespace
+
+void AsyncState::wait() const {
+    if (is_ready()) {
+        return;
+    }
+    const std::shared_ptr<ThreadPool> pool = thread_pool();
+    if (pool && pool->on_worker()) {
+        // Sleeping here could leave the job this one waits for queued with
+        // no worker left to run it.
+        while (!is_ready()) {
+            if (!pool->try_run_one(true)) {
+                std::unique_lock<std::mutex> lock(mutex_);
+                completed_.wait_for(lock, WAIT_POLL,
+                                    [this] { return is_ready(); });
+            }
+        }
+        return;
+    }
+    std::unique_lock<std::mutex> lock(mutex_);
+    completed_.wait(lock, [this] { return is_ready(); });
+}
+
+void AsyncState::on_ready(std::function<void()> f) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!ready_.load(std::memory_order_relaxed)) {
+            continuations_.push_back(std::move(f));
+            return;
+        }
+    }
+    f();
+}
+
+void AsyncState::complete(std::exception_ptr error) {
+    std::vector<std::function<void()>> continuations;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        error_ = std::move(error);
+        ready_.store(true, std::memory_order_release);
+        continuations.swap(continuations_);
+    }
+    completed_.notify_all();
+    for (const std::function<void()>& f : continuations) {
+        f();
+    }
+}
+
+void submit_job(std::function<void()> job) {
+    const std::shared_ptr<ThreadPool> pool = thread_pool();
+    if (!pool) {
+        job();
+        return;
+    }
+    pool->submit_job(std::move(job));
+}
+
+} // namespace detail
+} // namespace matrixops
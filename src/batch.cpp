@@ -0,0 +1,325 @@
+#include "matrixops/batch.h"
+
+#include "matrixops/gemm.h"
+#include "matrixops/parallel.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "kernels.h"
+#include "portable_kernels.h"
+#include "transpose.h"
+
+namespace matrixops {
+
+namespace {
+
+// Multiply-adds per task when a batch is split across the pool: enough
+// to amortize the dispatch, small enough to balance millions of 16 x 16
+// products.
+constexpr size_t BATCH_GRAIN_FLOPS = size_t{1} << 18;
+
+// Tasks of at least BATCH_GRAIN_FLOPS for items of work multiply-adds.
+size_t batch_grain(size_t work) {
+    return std::max<size_t>(BATCH_GRAIN_FLOPS / std::max<size_t>(work, 1), 1);
+}
+
+template <typename T>
+void gemm_group(size_t m, size_t n, size_t k, T alpha, const T* a,
+                const T* b, T beta, T* c) {
+    if constexpr (detail::HAS_SIMD_KERNELS<T>) {
+        detail::typed_kernels<T>().gemm_batch(m, n, k, alpha, a, b, beta, c);
+    } else {
+        detail::gemm_batch_scalar<T, detail::BATCH_LANES<T>>(m, n, k, alpha, a,
+                                                             b, beta, c);
+    }
+}
+
+template <typename T>
+void add_block(const T* a, const T* b, T* out, size_t n) {
+    if constexpr (detail::HAS_SIMD_KERNELS<T>) {
+        detail::typed_kernels<T>().add(a, b, out, n);
+    } else {
+        detail::add_scalar(a, b, out, n);
+    }
+}
+
+template <typename T>
+void check_count(const BasicMatrixBatch<T>& a, const BasicMatrixBatch<T>& b) {
+    if (a.count() != b.count()) {
+        throw std::invalid_argument("Batch sizes must match");
+    }
+}
+
+} // namespace
+
+template <typename T>
+BasicMatrixBatch<T>::BasicMatrixBatch(size_t count, size_t rows, size_t cols,
+                                      T init_value)
+    : count_(count), rows_(rows), cols_(cols) {
+    if (count == 0 || rows == 0 || cols == 0) {
+        throw std::invalid_argument("Matrix dimensions must be positive");
+    }
+    data_.assign(groups() * rows * cols * LANES, init_value);
+    // Zero the padding matrices of the last group.
+    T* last = data_.data() + (groups() - 1) * rows * cols * LANES;
+    for (size_t e = 0; e < rows * cols; ++e) {
+        for (size_t lane = (count - 1) % LANES + 1; lane < LANES; ++lane) {
+            last[e * LANES + lane] = T(0);
+        }
+    }
+}
+
+template <typename T>
+T& BasicMatrixBatch<T>::operator()(size_t b, size_t i, size_t j) {
+    if (b >= count_ || i >= rows_ || j >= cols_) {
+        throw std::out_of_range("Matrix indices out of range");
+    }
+    return data_[offset(b, i, j)];
+}
+
+template <typename T>
+T BasicMatrixBatch<T>::operator()(size_t b, size_t i, size_t j) const {
+    if (b >= count_ || i >= rows_ || j >= cols_) {
+        throw std::out_of_range("Matrix indices out of range");
+    }
+    return data_[offset(b, i, j)];
+}
+
+template <typename T>
+BasicMatrix<T> BasicMatrixBatch<T>::matrix(size_t b) const {
+    if (b >= count_) {
+        throw std::out_of_range("Batch index out of range");
+    }
+    BasicMatrix<T> m(rows_, cols_, UNINITIALIZED);
+    for (size_t i = 0; i < rows_; ++i) {
+        for (size_t j = 0; j < cols_; ++j) {
+            m.unchecked(i, j) = data_[offset(b, i, j)];
+        }
+    }
+    return m;
+}
+
+template <typename T>
+void BasicMatrixBatch<T>::set_matrix(size_t b, const BasicMatrix<T>& m) {
+    if (b >= count_) {
+        throw std::out_of_range("Batch index out of range");
+    }
+    if (m.rows() != rows_ || m.cols() != cols_) {
+        throw std::invalid_argument("Matrix dimensions must match the batch");
+    }
+    for (size_t i = 0; i < rows_; ++i) {
+        for (size_t j = 0; j < cols_; ++j) {
+            data_[offset(b, i, j)] = m.unchecked(i, j);
+        }
+    }
+}
+
+template <typename T>
+void gemm(T alpha, const BasicMatrixBatch<T>& a, const BasicMatrixBatch<T>& b,
+          T beta, BasicMatrixBatch<T>& c) {
+    check_count(a, b);
+    check_count(a, c);
+    if (a.cols() != b.rows() || c.rows() != a.rows() ||
+        c.cols() != b.cols()) {
+        throw std::invalid_argument(
+            "Matrix dimensions incompatible for multiplication");
+    }
+    if (&c == &a || &c == &b) {
+        throw std::invalid_argument(
+            "Matrix multiplication output must not alias an operand");
+    }
+    const size_t m = a.rows();
+    const size_t n = b.cols();
+    const size_t k = a.cols();
+    constexpr size_t L = BasicMatrixBatch<T>::LANES;
+    const T* a_data = a.data();
+    const T* b_data = b.data();
+    T* c_data = c.data();
+    const size_t grain = batch_grain(m * n * k * L);
+    parallel_for(0, a.groups(), grain, [&](size_t lo, size_t hi) {
+        for (size_t g = lo; g < hi; ++g) {
+            gemm_group(m, n, k, alpha, a_data + g * m * k * L,
+                       b_data + g * k * n * L, beta,
+                       c_data + g * m * n * L);
+        }
+    });
+}
+
+template <typename T>
+void multiply_into(const BasicMatrixBatch<T>& a, const BasicMatrixBatch<T>& b,
+                   BasicMatrixBatch<T>& out) {
+    gemm(T(1), a, b, T(0), out);
+}
+
+// Matching layouts make the batched sum one element-wise pass over the
+// whole buffer, padding included.
+template <typename T>
+void add_into(const BasicMatrixBatch<T>& a, const BasicMatrixBatch<T>& b,
+              BasicMatrixBatch<T>& out) {
+    check_count(a, b);
+    check_count(a, out);
+    if (b.rows() != a.rows() || b.cols() != a.cols() ||
+        out.rows() != a.rows() || out.cols() != a.cols()) {
+        throw std::invalid_argument(
+            "Matrix dimensions must match for addition");
+    }
+    const size_t n =
+        a.groups() * a.rows() * a.cols() * BasicMatrixBatch<T>::LANES;
+    const T* a_data = a.data();
+    const T* b_data = b.data();
+    T* out_data = out.data();
+    parallel_for(0, n, detail::ELEMENTWISE_GRAIN, [&](size_t lo, size_t hi) {
+        add_block(a_data + lo, b_data + lo, out_data + lo, hi - lo);
+    });
+}
+
+// Each element of a group is LANES contiguous values, so the transpose
+// moves whole lines and never shuffles within one.
+template <typename T>
+void transpose_into(const BasicMatrixBatch<T>& a, BasicMatrixBatch<T>& out) {
+    check_count(a, out);
+    if (out.rows() != a.cols() || out.cols() != a.rows()) {
+        throw std::invalid_argument(
+            "Matrix dimensions incompatible for transpose");
+    }
+    if (&out == &a) {
+        throw std::invalid_argument("Transpose output must not alias input");
+    }
+    const size_t rows = a.rows();
+    const size_t cols = a.cols();
+    constexpr size_t L = BasicMatrixBatch<T>::LANES;
+    const size_t group_size = rows * cols * L;
+    const T* in = a.data();
+    T* dst = out.data();
+    const size_t grain = batch_grain(group_size);
+    parallel_for(0, a.groups(), grain, [&](size_t lo, size_t hi) {
+        for (size_t g = lo; g < hi; ++g) {
+            const T* src_group = in + g * group_size;
+            T* dst_group = dst + g * group_size;
+            for (size_t i = 0; i < rows; ++i) {
+                for (size_t j = 0; j < cols; ++j) {
+                    std::copy_n(src_group + (i * cols + j) * L, L,
+                                dst_group + (j * rows + i) * L);
+                }
+            }
+        }
+    });
+}
+
+template <typename T>
+void multiply_into(const BasicMatrix<T>* const* a,
+                   const BasicMatrix<T>* const* b, BasicMatrix<T>* const* out,
+                   size_t count) {
+    // Validate every product before writing any output.
+    size_t flops = 0;
+    for (size_t i = 0; i < count; ++i) {
+        if (a[i]->cols() != b[i]->rows() || out[i]->rows() != a[i]->rows() ||
+            out[i]->cols() != b[i]->cols()) {
+            throw std::invalid_argument(
+                "Matrix dimensions incompatible for multiplication");
+        }
+        if (out[i] == a[i] || out[i] == b[i]) {
+            throw std::invalid_argument(
+                "Matrix multiplication output must not alias an operand");
+        }
+        flops += a[i]->rows() * b[i]->cols() * a[i]->cols();
+    }
+    if (count == 0) {
+        return;
+    }
+    const size_t grain = batch_grain(flops / count);
+    parallel_for(0, count, grain, [&](size_t lo, size_t hi) {
+        for (size_t i = lo; i < hi; ++i) {
+            const BasicMatrix<T>& x = *a[i];
+            const BasicMatrix<T>& y = *b[i];
+            BasicMatrix<T>& z = *out[i];
+            gemm(x.rows(), y.cols(), x.cols(), T(1), x.data(),
+                 x.stride(), y.data(), y.stride(), T(0),
+                 z.data(), z.stride());
+        }
+    });
+}
+
+template <typename T>
+void add_into(const BasicMatrix<T>* const* a, const BasicMatrix<T>* const* b,
+              BasicMatrix<T>* const* out, size_t count) {
+    size_t elements = 0;
+    for (size_t i = 0; i < count; ++i) {
+        if (b[i]->rows() != a[i]->rows() || b[i]->cols() != a[i]->cols() ||
+            out[i]->rows() != a[i]->rows() ||
+            out[i]->cols() != a[i]->cols()) {
+            throw std::invalid_argument(
+                "Matrix dimensions must match for addition");
+        }
+        elements += a[i]->rows() * a[i]->cols();
+    }
+    if (count == 0) {
+        return;
+    }
+    const size_t grain = batch_grain(elements / count);
+    parallel_for(0, count, grain, [&](size_t lo, size_t hi) {
+        for (size_t i = lo; i < hi; ++i) {
+            add_block(a[i]->data(), b[i]->data(), out[i]->data(),
+                      a[i]->rows() * a[i]->cols());
+        }
+    });
+}
+
+template <typename T>
+void transpose_into(const BasicMatrix<T>* const* a, BasicMatrix<T>* const* out,
+                    size_t count) {
+    size_t elements = 0;
+    for (size_t i = 0; i < count; ++i) {
+        if (out[i]->rows() != a[i]->cols() || out[i]->cols() != a[i]->rows()) {
+            throw std::invalid_argument(
+                "Matrix dimensions incompatible for transpose");
+        }
+        if (out[i] == a[i]) {
+            throw std::invalid_argument(
+                "Transpose output must not alias input");
+        }
+        elements += a[i]->rows() * a[i]->cols();
+    }
+    if (count == 0) {
+        return;
+    }
+    const size_t grain = batch_grain(elements / count);
+    parallel_for(0, count, grain, [&](size_t lo, size_t hi) {
+        for (size_t i = lo; i < hi; ++i) {
+            const BasicMatrix<T>& x = *a[i];
+            detail::transpose(x.rows(), x.cols(), x.data(),
+                              x.stride(), out[i]->data(),
+                              out[i]->stride());
+        }
+    });
+}
+
+#define MATRIXOPS_INSTANTIATE_BATCH(T)                                         \
+    template class BasicMatrixBatch<T>;                                        \
+    template void gemm(T, const BasicMatrixBatch<T>&,                          \
+                       const BasicMatrixBatch<T>&, T, BasicMatrixBatch<T>&);   \
+    template void multiply_into(const BasicMatrixBatch<T>&,                    \
+                                const BasicMatrixBatch<T>&,                    \
+                                BasicMatrixBatch<T>&);                         \
+    template void add_into(const BasicMatrixBatch<T>&,                         \
+                           const BasicMatrixBatch<T>&, BasicMatrixBatch<T>&);  \
+    template void transpose_into(const BasicMatrixBatch<T>&,                   \
+                                 BasicMatrixBatch<T>&);                        \
+    template void multiply_into(const BasicMatrix<T>* const*,                  \
+                                const BasicMatrix<T>* const*,                  \
+                                BasicMatrix<T>* const*, size_t);               \
+    template void add_into(const BasicMatrix<T>* const*,                       \
+                           const BasicMatrix<T>* const*,                       \
+                           BasicMatrix<T>* const*, size_t);                    \
+    template void transpose_into(const BasicMatrix<T>* const*,                 \
+                                 BasicMatrix<T>* const*, size_t);
+
+MATRIXOPS_INSTANTIATE_BATCH(float)
+MATRIXOPS_INSTANTIATE_BATCH(double)
+MATRIXOPS_INSTANTIATE_BATCH(std::complex<float>)
+MATRIXOPS_INSTANTIATE_BATCH(std::complex<double>)
+
+#undef MATRIXOPS_INSTANTIATE_BATCH
+
+} // namespace matrixops
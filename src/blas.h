@@ -0,0 +1,126 @@
+#pragma once
+
+#include <climits>
+#include <complex>
+#include <cstddef>
+
+#include "matrixops/layout.h"
+
+namespace matrixops {
+namespace detail {
+
+#ifdef MATRIXOPS_BLAS_NAME
+
+/**
+ * @brief True when a vendor BLAS was selected at configure time
+ */
+constexpr bool HAS_BLAS = true;
+
+// The Fortran interface (column-major, arguments by pointer, LP64
+// integers) rather than cblas, whose header and name differ between
+// OpenBLAS, MKL and BLIS.
+extern "C" {
+void sgemm_(const char* transa, const char* transb, const int* m,
+            const int* n, const int* k, const float* alpha, const float* a,
+            const int* lda, const float* b, const int* ldb, const float* beta,
+            float* c, const int* ldc);
+void dgemm_(const char* transa, const char* transb, const int* m,
+            const int* n, const int* k, const double* alpha, const double* a,
+            const int* lda, const double* b, const int* ldb,
+            const double* beta, double* c, const int* ldc);
+void cgemm_(const char* transa, const char* transb, const int* m,
+            const int* n, const int* k, const std::complex<float>* alpha,
+            const std::complex<float>* a, const int* lda,
+            const std::complex<float>* b, const int* ldb,
+            const std::complex<float>* beta, std::complex<float>* c,
+            const int* ldc);
+void zgemm_(const char* transa, const char* transb, const int* m,
+            const int* n, const int* k, const std::complex<double>* alpha,
+            const std::complex<double>* a, const int* lda,
+            const std::complex<double>* b, const int* ldb,
+            const std::complex<double>* beta, std::complex<double>* c,
+            const int* ldc);
+}
+
+inline void blas_gemm_fortran(const char* transa, const char* transb,
+                              const int* m, const int* n, const int* k,
+                              const float* alpha, const float* a,
+                              const int* lda, const float* b, const int* ldb,
+                              const float* beta, float* c, const int* ldc) {
+    sgemm_(transa, transb, m, n, k, alpha, a, lda, b, ldb, beta, c, ldc);
+}
+
+inline void blas_gemm_fortran(const char* transa, const char* transb,
+                              const int* m, const int* n, const int* k,
+                              const double* alpha, const double* a,
+                              const int* lda, const double* b,
+                              const int* ldb, const double* beta, double* c,
+                              const int* ldc) {
+    dgemm_(transa, transb, m, n, k, alpha, a, lda, b, ldb, beta, c, ldc);
+}
+
+inline void blas_gemm_fortran(const char* transa, const char* transb,
+                              const int* m, const int* n, const int* k,
+                              const std::complex<float>* alpha,
+                              const std::complex<float>* a, const int* lda,
+                              const std::complex<float>* b, const int* ldb,
+                              const std::complex<float>* beta,
+                              std::complex<float>* c, const int* ldc) {
+    cgemm_(transa, transb, m, n, k, alpha, a, lda, b, ldb, beta, c, ldc);
+}
+
+inline void blas_gemm_fortran(const char* transa, const char* transb,
+                              const int* m, const int* n, const int* k,
+                              const std::complex<double>* alpha,
+                              const std::complex<double>* a, const int* lda,
+                              const std::complex<double>* b, const int* ldb,
+                              const std::complex<double>* beta,
+                              std::complex<double>* c, const int* ldc) {
+    zgemm_(transa, transb, m, n, k, alpha, a, lda, b, ldb, beta, c, ldc);
+}
+
+/**
+ * @brief Row-major C = alpha * A * B + beta * C on the vendor BLAS
+ *
+ * A row-major matrix is its column-major transpose, so this computes
+ * C^T = B^T * A^T with the operands swapped.
+ * @return false, leaving C untouched, if a dimension does not fit the
+ * 32-bit integers of the interface
+ */
+template <typename T>
+bool blas_gemm(size_t m, size_t n, size_t k, T alpha, const T* a, size_t lda,
+               const T* b, size_t ldb, T beta, T* c, size_t ldc,
+               Layout layout_a, Layout layout_b) {
+    const size_t limit = INT_MAX;
+    if (m > limit || n > limit || k > limit || lda > limit || ldb > limit ||
+        ldc > limit) {
+        return false;
+    }
+    const int fm = static_cast<int>(n);
+    const int fn = static_cast<int>(m);
+    const int fk = static_cast<int>(k);
+    const int flda = static_cast<int>(ldb);
+    const int fldb = static_cast<int>(lda);
+    const int fldc = static_cast<int>(ldc);
+    // A column-major operand is the transpose of what Fortran expects.
+    const char* transa = layout_b == Layout::ROW_MAJOR ? "N" : "T";
+    const char* transb = layout_a == Layout::ROW_MAJOR ? "N" : "T";
+    blas_gemm_fortran(transa, transb, &fm, &fn, &fk, &alpha, b, &flda, a,
+                      &fldb, &beta, c, &fldc);
+    return true;
+}
+
+#else
+
+constexpr bool HAS_BLAS = false;
+
+template <typename T>
+bool blas_gemm(size_t, size_t, size_t, T, const T*, size_t, const T*, size_t,
+               T, T*, size_t, Layout, Layout) {
+    return false;
+}
+
+#endif
+
+} // namespace detail
+} // namespace matrixops
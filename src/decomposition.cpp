@@ -0,0 +1,746 @@
+#include "matrixops/decomposition.h"
+
+#include "matrixops/gemm.h"
+#include "matrixops/parallel.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include "kernels.h"
+#include "portable_kernels.h"
+#include "transpose.h"
+
+namespace matrixops {
+
+using detail::ELEMENTWISE_GRAIN;
+
+namespace {
+
+std::atomic<size_t> block_size{128};
+
+// Triangular solves of at most this many rows use substitution; larger
+// ones are split in half around a gemm() update.
+constexpr size_t SUBSTITUTION_ROWS = 64;
+
+// Columns of a panel factored column by column; wider panels recurse.
+constexpr size_t PANEL_LEAF = 16;
+
+template <typename T>
+using Real = typename detail::ScalarTraits<T>::real_type;
+
+template <typename T>
+T conjugate(T x) {
+    return x;
+}
+
+template <typename R>
+std::complex<R> conjugate(std::complex<R> x) {
+    return std::conj(x);
+}
+
+template <typename T>
+Real<T> real_part(T x) {
+    return std::real(x);
+}
+
+// |re| + |im|, the LAPACK pivot magnitude: cheaper than the modulus and
+// as good for choosing pivots.
+template <typename T>
+Real<T> pivot_magnitude(T x) {
+    return std::abs(std::real(x)) + std::abs(std::imag(x));
+}
+
+// y += alpha * x over one contiguous block.
+template <typename T>
+void axpy_block(T alpha, const T* x, T* y, size_t n) {
+    if constexpr (detail::HAS_SIMD_KERNELS<T>) {
+        detail::typed_kernels<T>().axpy(alpha, x, y, n);
+    } else {
+        detail::axpy_scalar(alpha, x, y, n);
+    }
+}
+
+// Tasks of at least ELEMENTWISE_GRAIN elements for items of work each.
+size_t grain_for(size_t work) {
+    return std::max<size_t>(ELEMENTWISE_GRAIN / std::max<size_t>(work, 1), 1);
+}
+
+// dst = src^H for the rows x cols block src; dst is cols x rows.
+template <typename T>
+void adjoint(size_t rows, size_t cols, const T* src, size_t lds, T* dst,
+             size_t ldd) {
+    detail::transpose(rows, cols, src, lds, dst, ldd);
+    if constexpr (!std::is_same_v<T, Real<T>>) {
+        for (size_t i = 0; i < cols; ++i) {
+            for (size_t j = 0; j < rows; ++j) {
+                dst[i * ldd + j] = std::conj(dst[i * ldd + j]);
+            }
+        }
+    }
+}
+
+// Solve L X = B in place in the n x nrhs block b, L lower triangular with
+// an implicit unit diagonal when unit is set. The strict upper triangle of
+// l is not read.
+template <typename T>
+void solve_lower(size_t n, size_t nrhs, const T* l, size_t ldl, bool unit,
+                 T* b, size_t ldb) {
+    if (n > SUBSTITUTION_ROWS) {
+        const size_t h = n / 2;
+        solve_lower(h, nrhs, l, ldl, unit, b, ldb);
+        gemm(n - h, nrhs, h, T(-1), l + h * ldl, ldl, b, ldb, T(1),
+             b + h * ldb, ldb);
+        solve_lower(n - h, nrhs, l + h * ldl + h, ldl, unit, b + h * ldb,
+                    ldb);
+        return;
+    }
+    const size_t grain = grain_for(n * n);
+    parallel_for(0, nrhs, grain, [&](size_t lo, size_t hi) {
+        for (size_t i = 0; i < n; ++i) {
+            T* b_i = b + i * ldb + lo;
+            for (size_t p = 0; p < i; ++p) {
+                axpy_block(-l[i * ldl + p], b + p * ldb + lo, b_i, hi - lo);
+            }
+            if (!unit) {
+                const T d = l[i * ldl + i];
+                for (size_t j = 0; j < hi - lo; ++j) {
+                    b_i[j] /= d;
+                }
+            }
+        }
+    });
+}
+
+// Solve U X = B in place, U upper triangular; the strict lower triangle
+// of u is not read.
+template <typename T>
+void solve_upper(size_t n, size_t nrhs, const T* u, size_t ldu, T* b,
+                 size_t ldb) {
+    if (n > SUBSTITUTION_ROWS) {
+        const size_t h = n / 2;
+        solve_upper(n - h, nrhs, u + h * ldu + h, ldu, b + h * ldb, ldb);
+        gemm(h, nrhs, n - h, T(-1), u + h, ldu, b + h * ldb, ldb, T(1), b,
+             ldb);
+        solve_upper(h, nrhs, u, ldu, b, ldb);
+        return;
+    }
+    const size_t grain = grain_for(n * n);
+    parallel_for(0, nrhs, grain, [&](size_t lo, size_t hi) {
+        for (size_t i = n; i-- > 0;) {
+            T* b_i = b + i * ldb + lo;
+            for (size_t p = i + 1; p < n; ++p) {
+                axpy_block(-u[i * ldu + p], b + p * ldb + lo, b_i, hi - lo);
+            }
+            const T d = u[i * ldu + i];
+            for (size_t j = 0; j < hi - lo; ++j) {
+                b_i[j] /= d;
+            }
+        }
+    });
+}
+
+// Solve L^H X = B in place, L lower triangular. Substitution walks the
+// rows of L, so L^H is never formed except for the off-diagonal block of
+// each split.
+template <typename T>
+void solve_lower_adjoint(size_t n, size_t nrhs, const T* l, size_t ldl,
+                         T* b, size_t ldb) {
+    if (n > SUBSTITUTION_ROWS) {
+        const size_t h = n / 2;
+        solve_lower_adjoint(n - h, nrhs, l + h * ldl + h, ldl, b + h * ldb,
+                            ldb);
+        std::vector<T> l21h(h * (n - h));
+        adjoint(n - h, h, l + h * ldl, ldl, l21h.data(), n - h);
+        gemm(h, nrhs, n - h, T(-1), l21h.data(), n - h, b + h * ldb, ldb,
+             T(1), b, ldb);
+        solve_lower_adjoint(h, nrhs, l, ldl, b, ldb);
+        return;
+    }
+    const size_t grain = grain_for(n * n);
+    parallel_for(0, nrhs, grain, [&](size_t lo, size_t hi) {
+        for (size_t i = n; i-- > 0;) {
+            T* b_i = b + i * ldb + lo;
+            const T d = conjugate(l[i * ldl + i]);
+            for (size_t j = 0; j < hi - lo; ++j) {
+                b_i[j] /= d;
+            }
+            for (size_t p = 0; p < i; ++p) {
+                axpy_block(-conjugate(l[i * ldl + p]), b_i, b + p * ldb + lo,
+                           hi - lo);
+            }
+        }
+    });
+}
+
+// Factor the panel of w columns starting at row and column j of the n x n
+// matrix a. Rows are swapped across the whole matrix as the pivots are
+// chosen, so the factored columns to the left and the trailing columns to
+// the right see the same permutation.
+template <typename T>
+void factor_lu_panel(size_t n, T* a, size_t lda, size_t j, size_t w,
+                     size_t* pivots, bool& singular) {
+    if (w > PANEL_LEAF) {
+        const size_t h = w / 2;
+        factor_lu_panel(n, a, lda, j, h, pivots, singular);
+        T* a11 = a + j * lda + j;
+        T* a12 = a11 + h;
+        solve_lower(h, w - h, a11, lda, true, a12, lda);
+        gemm(n - j - h, w - h, h, T(-1), a11 + h * lda, lda, a12, lda, T(1),
+             a12 + h * lda, lda);
+        factor_lu_panel(n, a, lda, j + h, w - h, pivots, singular);
+        return;
+    }
+    for (size_t p = j; p < j + w; ++p) {
+        size_t best = p;
+        Real<T> largest = pivot_magnitude(a[p * lda + p]);
+        for (size_t i = p + 1; i < n; ++i) {
+            const Real<T> magnitude = pivot_magnitude(a[i * lda + p]);
+            if (magnitude > largest) {
+                best = i;
+                largest = magnitude;
+            }
+        }
+        pivots[p] = best;
+        if (best != p) {
+            std::swap_ranges(a + p * lda, a + p * lda + n, a + best * lda);
+        }
+        const T pivot = a[p * lda + p];
+        if (pivot == T(0)) {
+            // The column is already zero below the diagonal.
+            singular = true;
+            continue;
+        }
+        // Scale the multipliers and update the rest of the panel, by rows.
+        const size_t rest = j + w - p - 1;
+        const T* u = a + p * lda + p + 1;
+        const size_t grain = grain_for(rest + 1);
+        parallel_for(p + 1, n, grain, [&](size_t lo, size_t hi) {
+            for (size_t i = lo; i < hi; ++i) {
+                T* row = a + i * lda + p;
+                row[0] /= pivot;
+                axpy_block(-row[0], u, row + 1, rest);
+            }
+        });
+    }
+}
+
+// Factor the n x n diagonal block a of a Cholesky panel in place, column
+// by column; false if it is not positive definite.
+template <typename T>
+bool factor_cholesky_block(size_t n, T* a, size_t lda) {
+    for (size_t j = 0; j < n; ++j) {
+        T* row_j = a + j * lda;
+        Real<T> d = real_part(row_j[j]);
+        for (size_t p = 0; p < j; ++p) {
+            d -= std::norm(row_j[p]);
+        }
+        // Also rejects NaN.
+        if (!(d > Real<T>(0))) {
+            return false;
+        }
+        const Real<T> l_jj = std::sqrt(d);
+        row_j[j] = T(l_jj);
+        for (size_t i = j + 1; i < n; ++i) {
+            T* row_i = a + i * lda;
+            T sum = row_i[j];
+            for (size_t p = 0; p < j; ++p) {
+                detail::multiply_add(sum, -row_i[p], conjugate(row_j[p]));
+            }
+            row_i[j] = sum / l_jj;
+        }
+    }
+    return true;
+}
+
+// Sum of squared moduli of x[0], x[stride], ... x[(n - 1) * stride],
+// scaled by the largest modulus to avoid overflow and underflow.
+template <typename T>
+Real<T> strided_norm(const T* x, size_t stride, size_t n) {
+    Real<T> scale(0);
+    for (size_t i = 0; i < n; ++i) {
+        scale = std::max(scale, std::abs(x[i * stride]));
+    }
+    if (scale == Real<T>(0)) {
+        return scale;
+    }
+    Real<T> sum(0);
+    for (size_t i = 0; i < n; ++i) {
+        sum += std::norm(x[i * stride] / scale);
+    }
+    return scale * std::sqrt(sum);
+}
+
+// Explicit V (rows x width, unit diagonal, zero above) and V^H of the
+// Householder vectors stored below the diagonal from row and column j of
+// the packed QR factor.
+template <typename T>
+struct Reflectors {
+    size_t rows;
+    size_t width;
+    std::vector<T> v;
+    std::vector<T> vh;
+};
+
+template <typename T>
+Reflectors<T> reflectors(const T* qr, size_t ldq, size_t m, size_t j,
+                         size_t w) {
+    Reflectors<T> r{m - j, w, std::vector<T>((m - j) * w, T(0)), {}};
+    for (size_t i = 0; i < r.rows; ++i) {
+        const T* row = qr + (j + i) * ldq + j;
+        T* v_row = r.v.data() + i * w;
+        const size_t below = std::min(i, w);
+        std::copy(row, row + below, v_row);
+        if (i < w) {
+            v_row[i] = T(1);
+        }
+    }
+    r.vh.resize(w * r.rows);
+    adjoint(r.rows, w, r.v.data(), w, r.vh.data(), r.rows);
+    return r;
+}
+
+// The upper triangular T of H_1 H_2 ... H_w = I - V T V^H from the
+// reflectors and their scalars tau (LAPACK larft, forward columnwise).
+template <typename T>
+void form_triangular_factor(const Reflectors<T>& r, const T* tau, T* t,
+                            size_t ldt) {
+    const size_t w = r.width;
+    std::vector<T> gram(w * w);
+    gemm(w, w, r.rows, T(1), r.vh.data(), r.rows, r.v.data(), w, T(0),
+         gram.data(), w);
+    std::vector<T> z(w);
+    for (size_t i = 0; i < w; ++i) {
+        for (size_t p = 0; p < i; ++p) {
+            z[p] = -tau[i] * gram[p * w + i];
+        }
+        for (size_t p = 0; p < i; ++p) {
+            T sum(0);
+            for (size_t q = p; q < i; ++q) {
+                detail::multiply_add(sum, t[p * ldt + q], z[q]);
+            }
+            t[p * ldt + i] = sum;
+        }
+        t[i * ldt + i] = tau[i];
+        for (size_t p = i + 1; p < w; ++p) {
+            t[p * ldt + i] = T(0);
+        }
+    }
+}
+
+// b = (I - V op(T) V^H) b on the r.rows x ncols block b, with op(T) = T^H
+// when adjoint_t is set (applying H^H) and T otherwise (applying H).
+template <typename T>
+void apply_reflectors(const Reflectors<T>& r, const T* t, size_t ldt,
+                      bool adjoint_t, size_t ncols, T* b, size_t ldb) {
+    const size_t w = r.width;
+    if (ncols == 0) {
+        return;
+    }
+    std::vector<T> op_t(w * w, T(0));
+    for (size_t i = 0; i < w; ++i) {
+        for (size_t p = i; p < w; ++p) {
+            if (adjoint_t) {
+                op_t[p * w + i] = conjugate(t[i * ldt + p]);
+            } else {
+                op_t[i * w + p] = t[i * ldt + p];
+            }
+        }
+    }
+    std::vector<T> vhb(w * ncols);
+    std::vector<T> tvhb(w * ncols);
+    gemm(w, ncols, r.rows, T(1), r.vh.data(), r.rows, b, ldb, T(0),
+         vhb.data(), ncols);
+    gemm(w, ncols, w, T(1), op_t.data(), w, vhb.data(), ncols, T(0),
+         tvhb.data(), ncols);
+    gemm(r.rows, ncols, w, T(-1), r.v.data(), w, tvhb.data(), ncols, T(1), b,
+         ldb);
+}
+
+// Factor the panel of w columns at row and column j of the m-row matrix
+// a, writing the reflector scalars to tau[j...]. Wide panels factor their
+// left half, apply its reflectors to the right half and recurse.
+template <typename T>
+void factor_qr_panel(size_t m, T* a, size_t lda, size_t j, size_t w,
+                     T* tau) {
+    if (w > PANEL_LEAF) {
+        const size_t h = w / 2;
+        factor_qr_panel(m, a, lda, j, h, tau);
+        const Reflectors<T> r = reflectors(a, lda, m, j, h);
+        std::vector<T> t(h * h);
+        form_triangular_factor(r, tau + j, t.data(), h);
+        apply_reflectors(r, t.data(), h, true, w - h, a + j * lda + j + h,
+                         lda);
+        factor_qr_panel(m, a, lda, j + h, w - h, tau);
+        return;
+    }
+    std::vector<T> partial;
+    std::vector<T> proj;
+    for (size_t p = j; p < j + w; ++p) {
+        // Householder reflector H = I - tau v v^H with H^H x = beta e_1,
+        // beta real (LAPACK larfg).
+        T* x = a + p * lda + p;
+        const size_t below = m - p - 1;
+        const Real<T> x_norm = strided_norm(x + lda, lda, below);
+        const Real<T> alpha_re = std::real(*x);
+        const Real<T> alpha_im = std::imag(*x);
+        if (x_norm == Real<T>(0) && alpha_im == Real<T>(0)) {
+            tau[p] = T(0);
+            continue;
+        }
+        const Real<T> beta = -std::copysign(
+            std::hypot(std::hypot(alpha_re, alpha_im), x_norm), alpha_re);
+        tau[p] = (T(beta) - *x) / T(beta);
+        const T scale = T(1) / (*x - T(beta));
+        for (size_t i = 1; i <= below; ++i) {
+            x[i * lda] *= scale;
+        }
+        *x = T(beta);
+
+        // Apply H^H = I - conj(tau) v v^H to the rest of the panel: the
+        // projections v^H a_c are summed over fixed row chunks in order,
+        // so the result does not depend on the thread count.
+        const size_t rest = j + w - p - 1;
+        if (rest == 0) {
+            continue;
+        }
+        const size_t chunk = grain_for(rest);
+        const size_t chunks = (below + chunk - 1) / chunk;
+        partial.assign(chunks * rest, T(0));
+        parallel_for(0, chunks, 1, [&](size_t lo, size_t hi) {
+            for (size_t c = lo; c < hi; ++c) {
+                const size_t end = std::min(below, (c + 1) * chunk);
+                for (size_t i = c * chunk + 1; i <= end; ++i) {
+                    axpy_block(conjugate(x[i * lda]), x + i * lda + 1,
+                               partial.data() + c * rest, rest);
+                }
+            }
+        });
+        proj.assign(x + 1, x + 1 + rest);
+        for (size_t c = 0; c < chunks; ++c) {
+            for (size_t q = 0; q < rest; ++q) {
+                proj[q] += partial[c * rest + q];
+            }
+        }
+        const T factor = -conjugate(tau[p]);
+        axpy_block(factor, proj.data(), x + 1, rest);
+        const size_t grain = grain_for(rest);
+        parallel_for(1, below + 1, grain, [&](size_t lo, size_t hi) {
+            for (size_t i = lo; i < hi; ++i) {
+                axpy_block(factor * x[i * lda], proj.data(), x + i * lda + 1,
+                           rest);
+            }
+        });
+    }
+}
+
+template <typename T>
+void check_square(const BasicMatrix<T>& a) {
+    if (!a.is_square()) {
+        throw std::invalid_argument("Decomposition requires a square matrix");
+    }
+}
+
+template <typename T>
+void check_rhs(size_t rows, size_t expected) {
+    if (rows != expected) {
+        throw std::invalid_argument(
+            "Right-hand side dimensions incompatible for solve");
+    }
+}
+
+// n x 1 matrix holding the elements of v, and back.
+template <typename T>
+BasicMatrix<T> as_column(const BasicVector<T>& v) {
+    BasicMatrix<T> column(v.size(), 1, UNINITIALIZED);
+    std::copy(v.data(), v.data() + v.size(), column.data());
+    return column;
+}
+
+template <typename T>
+BasicVector<T> as_vector(const BasicMatrix<T>& column) {
+    BasicVector<T> v(column.rows(), UNINITIALIZED);
+    std::copy(column.data(), column.data() + column.rows(), v.data());
+    return v;
+}
+
+} // namespace
+
+size_t decomposition_block_size() {
+    return block_size.load(std::memory_order_relaxed);
+}
+
+void set_decomposition_block_size(size_t block) {
+    if (block == 0) {
+        throw std::invalid_argument(
+            "Decomposition block size must be positive");
+    }
+    block_size.store(block, std::memory_order_relaxed);
+}
+
+template <typename T>
+BasicLU<T>::BasicLU(const BasicMatrix<T>& a) : lu_(a), pivots_(a.rows()) {
+    check_square(a);
+    const size_t n = lu_.rows();
+    const size_t nb = decomposition_block_size();
+    T* data = lu_.data();
+    const size_t lda = lu_.stride();
+    for (size_t j = 0; j < n; j += nb) {
+        const size_t jb = std::min(nb, n - j);
+        factor_lu_panel(n, data, lda, j, jb, pivots_.data(), singular_);
+        const size_t rest = n - j - jb;
+        if (rest == 0) {
+            break;
+        }
+        // U12 = L11^-1 A12, then A22 -= L21 U12.
+        T* a11 = data + j * lda + j;
+        solve_lower(jb, rest, a11, lda, true, a11 + jb, lda);
+        gemm(rest, rest, jb, T(-1), a11 + jb * lda, lda, a11 + jb, lda, T(1),
+             a11 + jb * lda + jb, lda);
+    }
+}
+
+template <typename T>
+BasicMatrix<T> BasicLU<T>::lower() const {
+    const size_t n = size();
+    BasicMatrix<T> l(n, n);
+    for (size_t i = 0; i < n; ++i) {
+        for (size_t j = 0; j < i; ++j) {
+            l.unchecked(i, j) = lu_.unchecked(i, j);
+        }
+        l.unchecked(i, i) = T(1);
+    }
+    return l;
+}
+
+template <typename T>
+BasicMatrix<T> BasicLU<T>::upper() const {
+    const size_t n = size();
+    BasicMatrix<T> u(n, n);
+    for (size_t i = 0; i < n; ++i) {
+        for (size_t j = i; j < n; ++j) {
+            u.unchecked(i, j) = lu_.unchecked(i, j);
+        }
+    }
+    return u;
+}
+
+template <typename T>
+T BasicLU<T>::determinant() const {
+    T det(1);
+    for (size_t i = 0; i < size(); ++i) {
+        det *= lu_.unchecked(i, i);
+        if (pivots_[i] != i) {
+            det = -det;
+        }
+    }
+    return det;
+}
+
+template <typename T>
+BasicMatrix<T> BasicLU<T>::solve(const BasicMatrix<T>& b) const {
+    BasicMatrix<T> x(b);
+    solve_inplace(x);
+    return x;
+}
+
+template <typename T>
+BasicVector<T> BasicLU<T>::solve(const BasicVector<T>& b) const {
+    check_rhs<T>(b.size(), size());
+    BasicMatrix<T> x = as_column(b);
+    solve_inplace(x);
+    return as_vector(x);
+}
+
+template <typename T>
+void BasicLU<T>::solve_inplace(BasicMatrix<T>& b) const {
+    check_rhs<T>(b.rows(), size());
+    if (singular_) {
+        throw std::domain_error("Matrix is singular");
+    }
+    const size_t n = size();
+    const size_t nrhs = b.cols();
+    T* data = b.data();
+    const size_t ldb = b.stride();
+    for (size_t i = 0; i < n; ++i) {
+        if (pivots_[i] != i) {
+            std::swap_ranges(data + i * ldb, data + i * ldb + nrhs,
+                             data + pivots_[i] * ldb);
+        }
+    }
+    solve_lower(n, nrhs, lu_.data(), lu_.stride(), true, data, ldb);
+    solve_upper(n, nrhs, lu_.data(), lu_.stride(), data, ldb);
+}
+
+template <typename T>
+BasicCholesky<T>::BasicCholesky(const BasicMatrix<T>& a) : l_(a) {
+    check_square(a);
+    const size_t n = l_.rows();
+    const size_t nb = decomposition_block_size();
+    T* data = l_.data();
+    const size_t lda = l_.stride();
+    std::vector<T> l21h;
+    for (size_t j = 0; j < n; j += nb) {
+        const size_t jb = std::min(nb, n - j);
+        T* a11 = data + j * lda + j;
+        if (!factor_cholesky_block(jb, a11, lda)) {
+            throw std::domain_error("Matrix is not positive definite");
+        }
+        const size_t rest = n - j - jb;
+        if (rest == 0) {
+            break;
+        }
+        // L21 = A21 L11^-H, solved as L11 L21^H = A21^H; the adjoint is
+        // kept for the update A22 -= L21 L21^H.
+        T* a21 = a11 + jb * lda;
+        l21h.resize(jb * rest);
+        adjoint(rest, jb, a21, lda, l21h.data(), rest);
+        solve_lower(jb, rest, a11, lda, false, l21h.data(), rest);
+        adjoint(jb, rest, l21h.data(), rest, a21, lda);
+        // Lower triangle only, one block row at a time.
+        T* a22 = a21 + jb;
+        for (size_t i = 0; i < rest; i += nb) {
+            const size_t ib = std::min(nb, rest - i);
+            gemm(ib, i + ib, jb, T(-1), a21 + i * lda, lda, l21h.data(), rest,
+                 T(1), a22 + i * lda, lda);
+        }
+    }
+    for (size_t i = 0; i < n; ++i) {
+        std::fill(data + i * lda + i + 1, data + i * lda + n, T(0));
+    }
+}
+
+template <typename T>
+BasicMatrix<T> BasicCholesky<T>::solve(const BasicMatrix<T>& b) const {
+    BasicMatrix<T> x(b);
+    solve_inplace(x);
+    return x;
+}
+
+template <typename T>
+BasicVector<T> BasicCholesky<T>::solve(const BasicVector<T>& b) const {
+    check_rhs<T>(b.size(), size());
+    BasicMatrix<T> x = as_column(b);
+    solve_inplace(x);
+    return as_vector(x);
+}
+
+template <typename T>
+void BasicCholesky<T>::solve_inplace(BasicMatrix<T>& b) const {
+    check_rhs<T>(b.rows(), size());
+    solve_lower(size(), b.cols(), l_.data(), l_.stride(), false, b.data(),
+                b.stride());
+    solve_lower_adjoint(size(), b.cols(), l_.data(), l_.stride(), b.data(),
+                        b.stride());
+}
+
+template <typename T>
+BasicQR<T>::BasicQR(const BasicMatrix<T>& a)
+    : qr_(a),
+      t_(std::min(decomposition_block_size(), std::max<size_t>(a.cols(), 1)),
+         a.cols()),
+      block_(t_.rows()) {
+    if (a.rows() < a.cols()) {
+        throw std::invalid_argument(
+            "QR requires at least as many rows as columns");
+    }
+    const size_t m = qr_.rows();
+    const size_t n = qr_.cols();
+    T* data = qr_.data();
+    const size_t lda = qr_.stride();
+    std::vector<T> tau(n);
+    for (size_t j = 0; j < n; j += block_) {
+        const size_t jb = std::min(block_, n - j);
+        factor_qr_panel(m, data, lda, j, jb, tau.data());
+        const Reflectors<T> r = reflectors(data, lda, m, j, jb);
+        T* t = t_.data() + j;
+        form_triangular_factor(r, tau.data() + j, t, t_.stride());
+        apply_reflectors(r, t, t_.stride(), true, n - j - jb,
+                         data + j * lda + j + jb, lda);
+    }
+}
+
+template <typename T>
+void BasicQR<T>::apply_adjoint(T* b, size_t ldb, size_t ncols) const {
+    const size_t m = rows();
+    const size_t n = cols();
+    for (size_t j = 0; j < n; j += block_) {
+        const size_t jb = std::min(block_, n - j);
+        const Reflectors<T> r = reflectors(qr_.data(), qr_.stride(), m, j, jb);
+        apply_reflectors(r, t_.data() + j, t_.stride(), true, ncols,
+                         b + j * ldb, ldb);
+    }
+}
+
+template <typename T>
+BasicMatrix<T> BasicQR<T>::q() const {
+    const size_t m = rows();
+    const size_t n = cols();
+    BasicMatrix<T> q(m, n);
+    for (size_t i = 0; i < n; ++i) {
+        q.unchecked(i, i) = T(1);
+    }
+    // Q [I; 0] = H_1 (H_2 (... [I; 0])); panel j leaves the columns left
+    // of j zero below row j, so only the columns from j on are updated.
+    const size_t panels = (n + block_ - 1) / block_;
+    for (size_t panel = panels; panel-- > 0;) {
+        const size_t j = panel * block_;
+        const size_t jb = std::min(block_, n - j);
+        const Reflectors<T> r = reflectors(qr_.data(), qr_.stride(), m, j, jb);
+        apply_reflectors(r, t_.data() + j, t_.stride(), false, n - j,
+                         q.data() + j * q.stride() + j, q.stride());
+    }
+    return q;
+}
+
+template <typename T>
+BasicMatrix<T> BasicQR<T>::r() const {
+    const size_t n = cols();
+    BasicMatrix<T> r(n, n);
+    for (size_t i = 0; i < n; ++i) {
+        for (size_t j = i; j < n; ++j) {
+            r.unchecked(i, j) = qr_.unchecked(i, j);
+        }
+    }
+    return r;
+}
+
+template <typename T>
+BasicMatrix<T> BasicQR<T>::solve(const BasicMatrix<T>& b) const {
+    check_rhs<T>(b.rows(), rows());
+    const size_t n = cols();
+    for (size_t i = 0; i < n; ++i) {
+        if (qr_.unchecked(i, i) == T(0)) {
+            throw std::domain_error("Matrix does not have full column rank");
+        }
+    }
+    BasicMatrix<T> work(b);
+    apply_adjoint(work.data(), work.stride(), work.cols());
+    BasicMatrix<T> x(n, b.cols(), UNINITIALIZED);
+    std::copy(work.data(), work.data() + n * work.stride(), x.data());
+    solve_upper(n, x.cols(), qr_.data(), qr_.stride(), x.data(), x.stride());
+    return x;
+}
+
+template <typename T>
+BasicVector<T> BasicQR<T>::solve(const BasicVector<T>& b) const {
+    check_rhs<T>(b.size(), rows());
+    return as_vector(solve(as_column(b)));
+}
+
+#define MATRIXOPS_INSTANTIATE_DECOMPOSITION(T)                                 \
+    template class BasicLU<T>;                                                 \
+    template class BasicCholesky<T>;                                           \
+    template class BasicQR<T>;
+
+MATRIXOPS_INSTANTIATE_DECOMPOSITION(float)
+MATRIXOPS_INSTANTIATE_DECOMPOSITION(double)
+MATRIXOPS_INSTANTIATE_DECOMPOSITION(std::complex<float>)
+MATRIXOPS_INSTANTIATE_DECOMPOSITION(std::complex<double>)
+
+#undef MATRIXOPS_INSTANTIATE_DECOMPOSITION
+
+} // namespace matrixops
@@ -0,0 +1,194 @@
+#include "matrixops/device.h"
+#include <stdexcept>
+#include <utility>
+
+#include "device_runtime.h"
+
+namespace matrixops {
+
+namespace {
+
+template <typename T>
+T* allocate_elements(size_t rows, size_t cols) {
+    if (rows == 0 || cols == 0) {
+        throw std::invalid_argument("Matrix dimensions must be positive");
+    }
+    return static_cast<T*>(detail::device::allocate(rows * cols * sizeof(T)));
+}
+
+template <typename View>
+void check_transfer(const View& view, size_t rows, size_t cols) {
+    if (view.rows() != rows || view.cols() != cols) {
+        throw std::invalid_argument(
+            "Matrix dimensions must match for assignment");
+    }
+    if (view.col_stride() != 1) {
+        throw std::invalid_argument(
+            "Asynchronous transfers need a row-major view");
+    }
+}
+
+} // namespace
+
+const char* device_backend() {
+#ifdef MATRIXOPS_DEVICE_NAME
+    return MATRIXOPS_DEVICE_NAME;
+#else
+    return "none";
+#endif
+}
+
+size_t device_count() { return detail::device::count(); }
+
+void device_synchronize() { detail::device::synchronize(); }
+
+template <typename T>
+BasicDeviceMatrix<T>::BasicDeviceMatrix(size_t rows, size_t cols)
+    : rows_(rows), cols_(cols), data_(allocate_elements<T>(rows, cols)) {}
+
+template <typename T>
+BasicDeviceMatrix<T>::BasicDeviceMatrix(BasicMatrixView<const T> m)
+    : BasicDeviceMatrix(m.rows(), m.cols()) {
+    if (m.col_stride() != 1) {
+        // Rows with a column stride are packed on the host first.
+        const BasicMatrix<T> packed(m);
+        detail::device::copy_to_device(data_, cols_ * sizeof(T),
+                                       packed.data(), cols_ * sizeof(T),
+                                       cols_ * sizeof(T), rows_, false);
+        return;
+    }
+    detail::device::copy_to_device(data_, cols_ * sizeof(T), m.data(),
+                                   m.stride() * sizeof(T), cols_ * sizeof(T),
+                                   rows_, false);
+}
+
+template <typename T>
+BasicDeviceMatrix<T>::BasicDeviceMatrix(const BasicDeviceMatrix& other)
+    : BasicDeviceMatrix(other.rows_, other.cols_) {
+    detail::device::copy_on_device(data_, other.data_, size() * sizeof(T));
+}
+
+template <typename T>
+BasicDeviceMatrix<T>::BasicDeviceMatrix(BasicDeviceMatrix&& other) noexcept
+    : rows_(std::exchange(other.rows_, 0)),
+      cols_(std::exchange(other.cols_, 0)),
+      data_(std::exchange(other.data_, nullptr)) {}
+
+template <typename T>
+BasicDeviceMatrix<T>&
+BasicDeviceMatrix<T>::operator=(const BasicDeviceMatrix& other) {
+    if (this == &other) {
+        return *this;
+    }
+    if (rows_ == other.rows_ && cols_ == other.cols_) {
+        detail::device::copy_on_device(data_, other.data_,
+                                       size() * sizeof(T));
+        return *this;
+    }
+    return *this = BasicDeviceMatrix(other);
+}
+
+template <typename T>
+BasicDeviceMatrix<T>&
+BasicDeviceMatrix<T>::operator=(BasicDeviceMatrix&& other) noexcept {
+    std::swap(rows_, other.rows_);
+    std::swap(cols_, other.cols_);
+    std::swap(data_, other.data_);
+    return *this;
+}
+
+template <typename T>
+BasicDeviceMatrix<T>::~BasicDeviceMatrix() {
+    detail::device::deallocate(data_);
+}
+
+template <typename T>
+BasicMatrix<T> BasicDeviceMatrix<T>::to_matrix() const {
+    BasicMatrix<T> result(rows_, cols_, UNINITIALIZED);
+    detail::device::copy_to_host(result.data(), cols_ * sizeof(T), data_,
+                                 cols_ * sizeof(T), cols_ * sizeof(T), rows_,
+                                 false);
+    return result;
+}
+
+template <typename T>
+void BasicDeviceMatrix<T>::upload_async(BasicMatrixView<const T> src) {
+    check_transfer(src, rows_, cols_);
+    detail::device::copy_to_device(data_, cols_ * sizeof(T), src.data(),
+                                   src.stride() * sizeof(T),
+                                   cols_ * sizeof(T), rows_, true);
+}
+
+template <typename T>
+void BasicDeviceMatrix<T>::download_async(BasicMatrixView<T> dst) const {
+    check_transfer(dst, rows_, cols_);
+    detail::device::copy_to_host(dst.data(), dst.stride() * sizeof(T), data_,
+                                 cols_ * sizeof(T), cols_ * sizeof(T), rows_,
+                                 true);
+}
+
+template <typename T>
+BasicDeviceMatrix<T>
+BasicDeviceMatrix<T>::operator+(const BasicDeviceMatrix& other) const {
+    if (rows_ != other.rows_ || cols_ != other.cols_) {
+        throw std::invalid_argument(
+            "Matrix dimensions must match for addition");
+    }
+    BasicDeviceMatrix result(rows_, cols_);
+    detail::device::add(size(), data_, other.data_, result.data_);
+    return result;
+}
+
+template <typename T>
+BasicDeviceMatrix<T>&
+BasicDeviceMatrix<T>::operator+=(const BasicDeviceMatrix& other) {
+    if (rows_ != other.rows_ || cols_ != other.cols_) {
+        throw std::invalid_argument(
+            "Matrix dimensions must match for addition");
+    }
+    detail::device::add(size(), data_, other.data_, data_);
+    return *this;
+}
+
+template <typename T>
+BasicDeviceMatrix<T>
+BasicDeviceMatrix<T>::operator*(const BasicDeviceMatrix& other) const {
+    if (cols_ != other.rows_) {
+        throw std::invalid_argument(
+            "Matrix dimensions incompatible for multiplication");
+    }
+    BasicDeviceMatrix result(rows_, other.cols_);
+    detail::device::gemm(rows_, other.cols_, cols_, data_, other.data_,
+                         result.data_);
+    return result;
+}
+
+template <typename T>
+BasicDeviceMatrix<T> BasicDeviceMatrix<T>::operator*(T scalar) const {
+    BasicDeviceMatrix result(rows_, cols_);
+    detail::device::scale(size(), scalar, data_, result.data_);
+    return result;
+}
+
+template <typename T>
+BasicDeviceMatrix<T>& BasicDeviceMatrix<T>::operator*=(T scalar) {
+    detail::device::scale(size(), scalar, data_, data_);
+    return *this;
+}
+
+template <typename T>
+BasicDeviceMatrix<T> BasicDeviceMatrix<T>::transpose() const {
+    BasicDeviceMatrix result(cols_, rows_);
+    detail::device::transpose(rows_, cols_, data_, result.data_);
+    return result;
+}
+
+template <typename T>
+T BasicDeviceMatrix<T>::norm() const {
+    return detail::device::norm(size(), data_);
+}
+
+template class BasicDeviceMatrix<float>;
+template class BasicDeviceMatrix<double>;
+
+} // namespace matrixops
@@ -0,0 +1,343 @@
+#include "device_runtime.h"
+
+#include <algorithm>
+#include <climits>
+#include <mutex>
+#include <new>
+#include <stdexcept>
+#include <string>
+
+// One source for both backends: CMake compiles it as CUDA, or as HIP with
+// MATRIXOPS_DEVICE_HIP defined. The gpu* names below map to either API.
+#ifdef MATRIXOPS_DEVICE_HIP
+#include <hip/hip_runtime.h>
+#include <hipblas/hipblas.h>
+
+#define gpuError_t hipError_t
+#define gpuSuccess hipSuccess
+#define gpuErrorMemoryAllocation hipErrorOutOfMemory
+#define gpuGetErrorString hipGetErrorString
+#define gpuGetLastError hipGetLastError
+#define gpuGetDeviceCount hipGetDeviceCount
+#define gpuStream_t hipStream_t
+#define gpuStreamCreateWithFlags hipStreamCreateWithFlags
+#define gpuStreamNonBlocking hipStreamNonBlocking
+#define gpuStreamSynchronize hipStreamSynchronize
+#define gpuMallocAsync hipMallocAsync
+#define gpuFreeAsync hipFreeAsync
+#define gpuMemcpyAsync hipMemcpyAsync
+#define gpuMemcpy2DAsync hipMemcpy2DAsync
+#define gpuMemcpyHostToDevice hipMemcpyHostToDevice
+#define gpuMemcpyDeviceToHost hipMemcpyDeviceToHost
+#define gpuMemcpyDeviceToDevice hipMemcpyDeviceToDevice
+#define gpublasHandle_t hipblasHandle_t
+#define gpublasStatus_t hipblasStatus_t
+#define GPUBLAS_STATUS_SUCCESS HIPBLAS_STATUS_SUCCESS
+#define GPUBLAS_OP_N HIPBLAS_OP_N
+#define gpublasCreate hipblasCreate
+#define gpublasSetStream hipblasSetStream
+#define gpublasSgemm hipblasSgemm
+#define gpublasDgemm hipblasDgemm
+#define gpublasSnrm2 hipblasSnrm2
+#define gpublasDnrm2 hipblasDnrm2
+#else
+#include <cublas_v2.h>
+#include <cuda_runtime.h>
+
+#define gpuError_t cudaError_t
+#define gpuSuccess cudaSuccess
+#define gpuErrorMemoryAllocation cudaErrorMemoryAllocation
+#define gpuGetErrorString cudaGetErrorString
+#define gpuGetLastError cudaGetLastError
+#define gpuGetDeviceCount cudaGetDeviceCount
+#define gpuStream_t cudaStream_t
+#define gpuStreamCreateWithFlags cudaStreamCreateWithFlags
+#define gpuStreamNonBlocking cudaStreamNonBlocking
+#define gpuStreamSynchronize cudaStreamSynchronize
+#define gpuMallocAsync cudaMallocAsync
+#define gpuFreeAsync cudaFreeAsync
+#define gpuMemcpyAsync cudaMemcpyAsync
+#define gpuMemcpy2DAsync cudaMemcpy2DAsync
+#define gpuMemcpyHostToDevice cudaMemcpyHostToDevice
+#define gpuMemcpyDeviceToHost cudaMemcpyDeviceToHost
+#define gpuMemcpyDeviceToDevice cudaMemcpyDeviceToDevice
+#define gpublasHandle_t cublasHandle_t
+#define gpublasStatus_t cublasStatus_t
+#define GPUBLAS_STATUS_SUCCESS CUBLAS_STATUS_SUCCESS
+#define GPUBLAS_OP_N CUBLAS_OP_N
+#define gpublasCreate cublasCreate
+#define gpublasSetStream cublasSetStream
+#define gpublasSgemm cublasSgemm
+#define gpublasDgemm cublasDgemm
+#define gpublasSnrm2 cublasSnrm2
+#define gpublasDnrm2 cublasDnrm2
+#endif
+
+namespace matrixops {
+namespace detail {
+namespace device {
+
+namespace {
+
+// Threads per block of the element-wise kernels, and the most blocks they
+// launch: grid-stride loops cover the rest.
+constexpr unsigned ELEMENTWISE_THREADS = 256;
+constexpr size_t MAX_BLOCKS = 4096;
+
+// The transpose goes through TRANSPOSE_TILE square tiles in shared memory,
+// each block of TRANSPOSE_TILE x TRANSPOSE_ROWS threads moving one tile.
+constexpr unsigned TRANSPOSE_TILE = 32;
+constexpr unsigned TRANSPOSE_ROWS = 8;
+constexpr size_t MAX_GRID_Y = 65535;
+
+void check(gpuError_t status) {
+    if (status == gpuErrorMemoryAllocation) {
+        throw std::bad_alloc();
+    }
+    if (status != gpuSuccess) {
+        throw std::runtime_error(std::string("Device error: ") +
+                                 gpuGetErrorString(status));
+    }
+}
+
+void check(gpublasStatus_t status) {
+    if (status != GPUBLAS_STATUS_SUCCESS) {
+        throw std::runtime_error("Device BLAS error " +
+                                 std::to_string(static_cast<int>(status)));
+    }
+}
+
+int blas_int(size_t n) {
+    if (n > static_cast<size_t>(INT_MAX)) {
+        throw std::invalid_argument("Matrix too large for the device BLAS");
+    }
+    return static_cast<int>(n);
+}
+
+// The stream every operation is queued on, and the BLAS handle bound to
+// it. Handles must not be used from several threads at once, hence the
+// mutex. Never destroyed: at exit the runtime may already be gone.
+struct Context {
+    gpuStream_t stream;
+    gpublasHandle_t blas;
+    std::mutex blas_mutex;
+};
+
+Context& context() {
+    static Context* const instance = [] {
+        auto* c = new Context;
+        check(gpuStreamCreateWithFlags(&c->stream, gpuStreamNonBlocking));
+        check(gpublasCreate(&c->blas));
+        check(gpublasSetStream(c->blas, c->stream));
+        return c;
+    }();
+    return *instance;
+}
+
+unsigned elementwise_blocks(size_t n) {
+    return static_cast<unsigned>(std::min(
+        (n + ELEMENTWISE_THREADS - 1) / ELEMENTWISE_THREADS, MAX_BLOCKS));
+}
+
+template <typename T>
+__global__ void add_kernel(size_t n, const T* a, const T* b, T* out) {
+    const size_t step = static_cast<size_t>(gridDim.x) * blockDim.x;
+    for (size_t i = static_cast<size_t>(blockIdx.x) * blockDim.x +
+                    threadIdx.x;
+         i < n; i += step) {
+        out[i] = a[i] + b[i];
+    }
+}
+
+template <typename T>
+__global__ void scale_kernel(size_t n, T alpha, const T* a, T* out) {
+    const size_t step = static_cast<size_t>(gridDim.x) * blockDim.x;
+    for (size_t i = static_cast<size_t>(blockIdx.x) * blockDim.x +
+                    threadIdx.x;
+         i < n; i += step) {
+        out[i] = alpha * a[i];
+    }
+}
+
+// Reads a tile of src by rows and writes it to dst by rows, so that both
+// sides are coalesced; the padding column avoids shared-memory bank
+// conflicts on the transposed read.
+template <typename T>
+__global__ void transpose_kernel(size_t rows, size_t cols, const T* src,
+                                 T* dst) {
+    __shared__ T tile[TRANSPOSE_TILE][TRANSPOSE_TILE + 1];
+    const size_t col = static_cast<size_t>(blockIdx.x) * TRANSPOSE_TILE +
+                       threadIdx.x;
+    const size_t row = static_cast<size_t>(blockIdx.y) * TRANSPOSE_TILE +
+                       threadIdx.y;
+    for (unsigned r = 0; r < TRANSPOSE_TILE; r += TRANSPOSE_ROWS) {
+        if (col < cols && row + r < rows) {
+            tile[threadIdx.y + r][threadIdx.x] = src[(row + r) * cols + col];
+        }
+    }
+    __syncthreads();
+    const size_t out_col = static_cast<size_t>(blockIdx.y) * TRANSPOSE_TILE +
+                           threadIdx.x;
+    const size_t out_row = static_cast<size_t>(blockIdx.x) * TRANSPOSE_TILE +
+                           threadIdx.y;
+    for (unsigned r = 0; r < TRANSPOSE_TILE; r += TRANSPOSE_ROWS) {
+        if (out_col < rows && out_row + r < cols) {
+            dst[(out_row + r) * rows + out_col] =
+                tile[threadIdx.x][threadIdx.y + r];
+        }
+    }
+}
+
+template <typename T>
+void launch_add(size_t n, const T* a, const T* b, T* out) {
+    add_kernel<<<elementwise_blocks(n), ELEMENTWISE_THREADS, 0,
+                 context().stream>>>(n, a, b, out);
+    check(gpuGetLastError());
+}
+
+template <typename T>
+void launch_scale(size_t n, T alpha, const T* a, T* out) {
+    scale_kernel<<<elementwise_blocks(n), ELEMENTWISE_THREADS, 0,
+                   context().stream>>>(n, alpha, a, out);
+    check(gpuGetLastError());
+}
+
+template <typename T>
+void launch_transpose(size_t rows, size_t cols, const T* src, T* dst) {
+    const size_t grid_y = (rows + TRANSPOSE_TILE - 1) / TRANSPOSE_TILE;
+    if (grid_y > MAX_GRID_Y) {
+        throw std::invalid_argument("Matrix too large for the device");
+    }
+    const dim3 grid(
+        static_cast<unsigned>((cols + TRANSPOSE_TILE - 1) / TRANSPOSE_TILE),
+        static_cast<unsigned>(grid_y));
+    const dim3 block(TRANSPOSE_TILE, TRANSPOSE_ROWS);
+    transpose_kernel<<<grid, block, 0, context().stream>>>(rows, cols, src,
+                                                           dst);
+    check(gpuGetLastError());
+}
+
+} // namespace
+
+size_t count() {
+    int devices = 0;
+    if (gpuGetDeviceCount(&devices) != gpuSuccess) {
+        // No driver or no device: clear the error for later calls.
+        (void)gpuGetLastError();
+        return 0;
+    }
+    return static_cast<size_t>(devices);
+}
+
+// Stream-ordered allocations, so that temporaries of chained operations
+// are reused without waiting for the device.
+void* allocate(size_t bytes) {
+    void* p = nullptr;
+    check(gpuMallocAsync(&p, bytes, context().stream));
+    return p;
+}
+
+void deallocate(void* p) noexcept {
+    if (p != nullptr) {
+        (void)gpuFreeAsync(p, context().stream);
+    }
+}
+
+// Copies go through the library stream even when synchronous, so that
+// they are ordered after the operations queued before them.
+void copy_to_device(void* dst, size_t dst_pitch, const void* src,
+                    size_t src_pitch, size_t width, size_t height,
+                    bool async) {
+    const gpuStream_t stream = context().stream;
+    check(gpuMemcpy2DAsync(dst, dst_pitch, src, src_pitch, width, height,
+                           gpuMemcpyHostToDevice, stream));
+    if (!async) {
+        check(gpuStreamSynchronize(stream));
+    }
+}
+
+void copy_to_host(void* dst, size_t dst_pitch, const void* src,
+                  size_t src_pitch, size_t width, size_t height, bool async) {
+    const gpuStream_t stream = context().stream;
+    check(gpuMemcpy2DAsync(dst, dst_pitch, src, src_pitch, width, height,
+                           gpuMemcpyDeviceToHost, stream));
+    if (!async) {
+        check(gpuStreamSynchronize(stream));
+    }
+}
+
+void copy_on_device(void* dst, const void* src, size_t bytes) {
+    check(gpuMemcpyAsync(dst, src, bytes, gpuMemcpyDeviceToDevice,
+                         context().stream));
+}
+
+void synchronize() { check(gpuStreamSynchronize(context().stream)); }
+
+void add(size_t n, const float* a, const float* b, float* out) {
+    launch_add(n, a, b, out);
+}
+
+void add(size_t n, const double* a, const double* b, double* out) {
+    launch_add(n, a, b, out);
+}
+
+void scale(size_t n, float alpha, const float* a, float* out) {
+    launch_scale(n, alpha, a, out);
+}
+
+void scale(size_t n, double alpha, const double* a, double* out) {
+    launch_scale(n, alpha, a, out);
+}
+
+void transpose(size_t rows, size_t cols, const float* src, float* dst) {
+    launch_transpose(rows, cols, src, dst);
+}
+
+void transpose(size_t rows, size_t cols, const double* src, double* dst) {
+    launch_transpose(rows, cols, src, dst);
+}
+
+// The BLAS is column-major: row-major c = a * b is column-major
+// c^T = b^T * a^T, with the operands swapped and no transposition.
+void gemm(size_t m, size_t n, size_t k, const float* a, const float* b,
+          float* c) {
+    const float one = 1.0F;
+    const float zero = 0.0F;
+    Context& ctx = context();
+    std::lock_guard<std::mutex> lock(ctx.blas_mutex);
+    check(gpublasSgemm(ctx.blas, GPUBLAS_OP_N, GPUBLAS_OP_N, blas_int(n),
+                       blas_int(m), blas_int(k), &one, b, blas_int(n), a,
+                       blas_int(k), &zero, c, blas_int(n)));
+}
+
+void gemm(size_t m, size_t n, size_t k, const double* a, const double* b,
+          double* c) {
+    const double one = 1.0;
+    const double zero = 0.0;
+    Context& ctx = context();
+    std::lock_guard<std::mutex> lock(ctx.blas_mutex);
+    check(gpublasDgemm(ctx.blas, GPUBLAS_OP_N, GPUBLAS_OP_N, blas_int(n),
+                       blas_int(m), blas_int(k), &one, b, blas_int(n), a,
+                       blas_int(k), &zero, c, blas_int(n)));
+}
+
+// With the result in host memory, nrm2 waits for the stream.
+float norm(size_t n, const float* a) {
+    float result = 0.0F;
+    Context& ctx = context();
+    std::lock_guard<std::mutex> lock(ctx.blas_mutex);
+    check(gpublasSnrm2(ctx.blas, blas_int(n), a, 1, &result));
+    return result;
+}
+
+double norm(size_t n, const double* a) {
+    double result = 0.0;
+    Context& ctx = context();
+    std::lock_guard<std::mutex> lock(ctx.blas_mutex);
+    check(gpublasDnrm2(ctx.blas, blas_int(n), a, 1, &result));
+    return result;
+}
+
+} // namespace device
+} // namespace detail
+} // namespace matrixops
@@ -0,0 +1,61 @@
+#include "device_runtime.h"
+
+#include <stdexcept>
+
+// Built when MATRIXOPS_DEVICE_BACKEND is "none": device matrices cannot be
+// created, so the operations after allocate() are unreachable.
+
+namespace matrixops {
+namespace detail {
+namespace device {
+
+namespace {
+
+[[noreturn]] void unavailable() {
+    throw std::runtime_error("MatrixOps was built without a device backend");
+}
+
+} // namespace
+
+size_t count() { return 0; }
+
+void* allocate(size_t) { unavailable(); }
+
+void deallocate(void*) noexcept {}
+
+void copy_to_device(void*, size_t, const void*, size_t, size_t, size_t,
+                    bool) {
+    unavailable();
+}
+
+void copy_to_host(void*, size_t, const void*, size_t, size_t, size_t,
+                  bool) {
+    unavailable();
+}
+
+void copy_on_device(void*, const void*, size_t) { unavailable(); }
+
+void synchronize() {}
+
+void add(size_t, const float*, const float*, float*) { unavailable(); }
+void add(size_t, const double*, const double*, double*) { unavailable(); }
+void scale(size_t, float, const float*, float*) { unavailable(); }
+void scale(size_t, double, const double*, double*) { unavailable(); }
+
+void transpose(size_t, size_t, const float*, float*) { unavailable(); }
+void transpose(size_t, size_t, const double*, double*) { unavailable(); }
+
+void gemm(size_t, size_t, size_t, const float*, const float*, float*) {
+    unavailable();
+}
+
+void gemm(size_t, size_t, size_t, const double*, const double*, double*) {
+    unavailable();
+}
+
+float norm(size_t, const float*) { unavailable(); }
+double norm(size_t, const double*) { unavailable(); }
+
+} // namespace device
+} // namespace detail
+} // namespace matrixops
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstddef>
+
+// The backend-neutral layer under BasicDeviceMatrix: device_gpu.cu
+// implements it on CUDA or HIP, device_none.cpp, built without a backend,
+// throws from everything but count().
+
+namespace matrixops {
+namespace detail {
+namespace device {
+
+/**
+ * @brief Number of usable devices
+ */
+size_t count();
+
+/**
+ * @brief Allocate bytes of device memory
+ * @throws std::bad_alloc if the device is out of memory
+ */
+void* allocate(size_t bytes);
+
+void deallocate(void* p) noexcept;
+
+/**
+ * @brief Copy height rows of width bytes, pitch bytes apart on each side,
+ * from host to device; async only queues the copy
+ */
+void copy_to_device(void* dst, size_t dst_pitch, const void* src,
+                    size_t src_pitch, size_t width, size_t height,
+                    bool async);
+
+/**
+ * @brief Copy from device to host, as copy_to_device()
+ */
+void copy_to_host(void* dst, size_t dst_pitch, const void* src,
+                  size_t src_pitch, size_t width, size_t height, bool async);
+
+void copy_on_device(void* dst, const void* src, size_t bytes);
+
+void synchronize();
+
+// Element-wise over n packed elements; out may alias an input.
+void add(size_t n, const float* a, const float* b, float* out);
+void add(size_t n, const double* a, const double* b, double* out);
+void scale(size_t n, float alpha, const float* a, float* out);
+void scale(size_t n, double alpha, const double* a, double* out);
+
+// Row-major rows x cols src into cols x rows dst.
+void transpose(size_t rows, size_t cols, const float* src, float* dst);
+void transpose(size_t rows, size_t cols, const double* src, double* dst);
+
+// Row-major c = a * b, with a m x k and b k x n.
+void gemm(size_t m, size_t n, size_t k, const float* a, const float* b,
+          float* c);
+void gemm(size_t m, size_t n, size_t k, const double* a, const double* b,
+          double* c);
+
+// Frobenius norm of n packed elements; waits for the queued work.
+float norm(size_t n, const float* a);
+double norm(size_t n, const double* a);
+
+} // namespace device
+} // namespace detail
+} // namespace matrixops
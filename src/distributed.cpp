@@ -0,0 +1,520 @@
+#include "matrixops/distributed.h"
+#include "matrixops/gemm.h"
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "reduction.h"
+#include "transpose.h"
+
+namespace matrixops {
+
+namespace {
+
+void check(int code) {
+    if (code != MPI_SUCCESS) {
+        char message[MPI_MAX_ERROR_STRING];
+        int length = 0;
+        MPI_Error_string(code, message, &length);
+        throw std::runtime_error("MPI error: " +
+                                 std::string(message, length));
+    }
+}
+
+int mpi_count(size_t n) {
+    if (n > static_cast<size_t>(INT_MAX)) {
+        throw std::invalid_argument(
+            "Distributed transfer too large for one MPI message");
+    }
+    return static_cast<int>(n);
+}
+
+template <typename T>
+MPI_Datatype mpi_type();
+
+template <>
+MPI_Datatype mpi_type<float>() {
+    return MPI_FLOAT;
+}
+
+template <>
+MPI_Datatype mpi_type<double>() {
+    return MPI_DOUBLE;
+}
+
+template <>
+MPI_Datatype mpi_type<std::complex<float>>() {
+    return MPI_C_FLOAT_COMPLEX;
+}
+
+template <>
+MPI_Datatype mpi_type<std::complex<double>>() {
+    return MPI_C_DOUBLE_COMPLEX;
+}
+
+int comm_size(MPI_Comm comm) {
+    int size = 0;
+    check(MPI_Comm_size(comm, &size));
+    return size;
+}
+
+int near_square_rows(MPI_Comm comm) {
+    int dims[2] = {0, 0};
+    check(MPI_Dims_create(comm_size(comm), 2, dims));
+    return dims[0];
+}
+
+void free_comm(MPI_Comm& comm) {
+    if (comm != MPI_COMM_NULL) {
+        MPI_Comm_free(&comm);
+    }
+}
+
+// Elements of an n-long dimension, cut in blocks, that the process at
+// coordinate coord of p owns: ScaLAPACK's NUMROC.
+size_t local_extent(size_t n, size_t block, int p, int coord) {
+    const size_t processes = static_cast<size_t>(p);
+    const size_t c = static_cast<size_t>(coord);
+    const size_t blocks = (n + block - 1) / block;
+    size_t extent = (blocks / processes + (c < blocks % processes ? 1 : 0)) *
+                    block;
+    if ((blocks - 1) % processes == c) {
+        extent -= blocks * block - n;
+    }
+    return extent;
+}
+
+size_t global_index(size_t local, size_t block, int p, int coord) {
+    return (local / block * static_cast<size_t>(p) +
+            static_cast<size_t>(coord)) *
+               block +
+           local % block;
+}
+
+// Call f(li, lj, gi, gj, width) for every row of every tile of the
+// process at grid (pr, pc): width elements from (li, lj) in its local
+// matrix, which is (gi, gj) in the global one.
+template <typename F>
+void for_each_tile_row(size_t rows, size_t cols, size_t block,
+                       const ProcessGrid& grid, int pr, int pc, const F& f) {
+    const size_t lr = local_extent(rows, block, grid.rows(), pr);
+    const size_t lc = local_extent(cols, block, grid.cols(), pc);
+    for (size_t li = 0; li < lr; ++li) {
+        const size_t gi = global_index(li, block, grid.rows(), pr);
+        for (size_t lj = 0; lj < lc; lj += block) {
+            f(li, lj, gi, global_index(lj, block, grid.cols(), pc),
+              std::min(block, lc - lj));
+        }
+    }
+}
+
+// Copy the tiles of the process at grid (pr, pc) out of m into its
+// packed local matrix at out.
+template <typename T>
+void pack_local(BasicMatrixView<const T> m, size_t block,
+                const ProcessGrid& grid, int pr, int pc, T* out) {
+    const size_t lc = local_extent(m.cols(), block, grid.cols(), pc);
+    for_each_tile_row(
+        m.rows(), m.cols(), block, grid, pr, pc,
+        [&](size_t li, size_t lj, size_t gi, size_t gj, size_t width) {
+            const T* src = m.data() + gi * m.stride() + gj * m.col_stride();
+            T* dst = out + li * lc + lj;
+            for (size_t t = 0; t < width; ++t) {
+                dst[t] = src[t * m.col_stride()];
+            }
+        });
+}
+
+// The reverse of pack_local(), into the row-major result.
+template <typename T>
+void unpack_local(const T* local, const ProcessGrid& grid, int pr, int pc,
+                  size_t block, BasicMatrix<T>& result) {
+    const size_t lc = local_extent(result.cols(), block, grid.cols(), pc);
+    for_each_tile_row(
+        result.rows(), result.cols(), block, grid, pr, pc,
+        [&](size_t li, size_t lj, size_t gi, size_t gj, size_t width) {
+            std::copy_n(local + li * lc + lj, width,
+                        result.data() + gi * result.stride() + gj);
+        });
+}
+
+// Element counts and offsets of every rank's local matrix, for the
+// v-variants of scatter and gather.
+struct LocalSizes {
+    std::vector<int> counts;
+    std::vector<int> offsets;
+    size_t total = 0;
+};
+
+LocalSizes local_sizes(size_t rows, size_t cols, size_t block,
+                       const ProcessGrid& grid) {
+    LocalSizes sizes;
+    for (int pr = 0; pr < grid.rows(); ++pr) {
+        for (int pc = 0; pc < grid.cols(); ++pc) {
+            const size_t n = local_extent(rows, block, grid.rows(), pr) *
+                             local_extent(cols, block, grid.cols(), pc);
+            sizes.counts.push_back(mpi_count(n));
+            sizes.offsets.push_back(mpi_count(sizes.total));
+            sizes.total += n;
+        }
+    }
+    return sizes;
+}
+
+const ProcessGrid& checked_grid(const std::shared_ptr<const ProcessGrid>& grid,
+                                size_t rows, size_t cols, size_t block) {
+    if (!grid) {
+        throw std::invalid_argument("Distributed matrix needs a grid");
+    }
+    if (rows == 0 || cols == 0) {
+        throw std::invalid_argument("Matrix dimensions must be positive");
+    }
+    if (block == 0) {
+        throw std::invalid_argument("Block size must be positive");
+    }
+    return *grid;
+}
+
+} // namespace
+
+ProcessGrid::ProcessGrid(MPI_Comm comm)
+    : ProcessGrid(comm, near_square_rows(comm),
+                  comm_size(comm) / near_square_rows(comm)) {}
+
+ProcessGrid::ProcessGrid(MPI_Comm comm, int rows, int cols) {
+    if (rows <= 0 || cols <= 0 || rows * cols != comm_size(comm)) {
+        throw std::invalid_argument(
+            "Process grid dimensions must match the communicator size");
+    }
+    rows_ = rows;
+    cols_ = cols;
+    check(MPI_Comm_dup(comm, &comm_));
+    try {
+        check(MPI_Comm_set_errhandler(comm_, MPI_ERRORS_RETURN));
+        int rank = 0;
+        check(MPI_Comm_rank(comm_, &rank));
+        row_ = rank / cols_;
+        col_ = rank % cols_;
+        // The split communicators inherit the error handler.
+        check(MPI_Comm_split(comm_, row_, col_, &row_comm_));
+        check(MPI_Comm_split(comm_, col_, row_, &col_comm_));
+    } catch (...) {
+        free_comm(row_comm_);
+        free_comm(comm_);
+        throw;
+    }
+}
+
+ProcessGrid::~ProcessGrid() {
+    int finalized = 0;
+    MPI_Finalized(&finalized);
+    if (!finalized) {
+        free_comm(col_comm_);
+        free_comm(row_comm_);
+        free_comm(comm_);
+    }
+}
+
+template <typename T>
+BasicDistributedMatrix<T>::BasicDistributedMatrix(
+    std::shared_ptr<const ProcessGrid> grid, size_t rows, size_t cols,
+    size_t block, UninitializedTag)
+    : grid_(std::move(grid)), rows_(rows), cols_(cols), block_(block),
+      local_rows_(local_extent(rows, block,
+                               checked_grid(grid_, rows, cols, block).rows(),
+                               grid_->row())),
+      local_cols_(local_extent(cols, block, grid_->cols(), grid_->col())),
+      local_(local_rows_ * local_cols_) {}
+
+template <typename T>
+BasicDistributedMatrix<T>::BasicDistributedMatrix(
+    std::shared_ptr<const ProcessGrid> grid, size_t rows, size_t cols,
+    size_t block)
+    : BasicDistributedMatrix(std::move(grid), rows, cols, block,
+                             UNINITIALIZED) {
+    std::fill_n(local_.data(), local_.size(), T{});
+}
+
+template <typename T>
+BasicDistributedMatrix<T>
+BasicDistributedMatrix<T>::from_global(std::shared_ptr<const ProcessGrid> grid,
+                                       BasicMatrixView<const T> m,
+                                       size_t block) {
+    BasicDistributedMatrix result(std::move(grid), m.rows(), m.cols(), block,
+                                  UNINITIALIZED);
+    const ProcessGrid& g = *result.grid_;
+    pack_local(m, block, g, g.row(), g.col(), result.local_.data());
+    return result;
+}
+
+template <typename T>
+BasicDistributedMatrix<T>
+BasicDistributedMatrix<T>::scatter(std::shared_ptr<const ProcessGrid> grid,
+                                   const BasicMatrix<T>* m, int root,
+                                   size_t block) {
+    if (!grid) {
+        throw std::invalid_argument("Distributed matrix needs a grid");
+    }
+    int rank = 0;
+    check(MPI_Comm_rank(grid->comm(), &rank));
+    unsigned long long shape[2] = {0, 0};
+    if (rank == root && m != nullptr) {
+        shape[0] = m->rows();
+        shape[1] = m->cols();
+    }
+    check(MPI_Bcast(shape, 2, MPI_UNSIGNED_LONG_LONG, root, grid->comm()));
+    BasicDistributedMatrix result(std::move(grid),
+                                  static_cast<size_t>(shape[0]),
+                                  static_cast<size_t>(shape[1]), block,
+                                  UNINITIALIZED);
+    const ProcessGrid& g = *result.grid_;
+    const LocalSizes sizes = local_sizes(result.rows_, result.cols_, block, g);
+
+    std::vector<T> packed;
+    if (rank == root) {
+        packed.resize(sizes.total);
+        for (int r = 0; r < g.rows() * g.cols(); ++r) {
+            pack_local(BasicMatrixView<const T>(*m), block, g, r / g.cols(),
+                       r % g.cols(), packed.data() + sizes.offsets[r]);
+        }
+    }
+    check(MPI_Scatterv(packed.data(), sizes.counts.data(),
+                       sizes.offsets.data(), mpi_type<T>(),
+                       result.local_.data(), mpi_count(result.local_.size()),
+                       mpi_type<T>(), root, g.comm()));
+    return result;
+}
+
+template <typename T>
+std::optional<BasicMatrix<T>>
+BasicDistributedMatrix<T>::gather(int root) const {
+    int rank = 0;
+    check(MPI_Comm_rank(grid_->comm(), &rank));
+    const LocalSizes sizes = local_sizes(rows_, cols_, block_, *grid_);
+    std::vector<T> packed(rank == root ? sizes.total : 0);
+    check(MPI_Gatherv(local_.data(), mpi_count(local_.size()), mpi_type<T>(),
+                      packed.data(), sizes.counts.data(),
+                      sizes.offsets.data(), mpi_type<T>(), root,
+                      grid_->comm()));
+    if (rank != root) {
+        return std::nullopt;
+    }
+    BasicMatrix<T> result(rows_, cols_, UNINITIALIZED);
+    for (int r = 0; r < grid_->rows() * grid_->cols(); ++r) {
+        unpack_local(packed.data() + sizes.offsets[r], *grid_,
+                     r / grid_->cols(), r % grid_->cols(), block_, result);
+    }
+    return result;
+}
+
+template <typename T>
+BasicMatrix<T> BasicDistributedMatrix<T>::to_matrix() const {
+    const LocalSizes sizes = local_sizes(rows_, cols_, block_, *grid_);
+    std::vector<T> packed(sizes.total);
+    check(MPI_Allgatherv(local_.data(), mpi_count(local_.size()),
+                         mpi_type<T>(), packed.data(), sizes.counts.data(),
+                         sizes.offsets.data(), mpi_type<T>(),
+                         grid_->comm()));
+    BasicMatrix<T> result(rows_, cols_, UNINITIALIZED);
+    for (int r = 0; r < grid_->rows() * grid_->cols(); ++r) {
+        unpack_local(packed.data() + sizes.offsets[r], *grid_,
+                     r / grid_->cols(), r % grid_->cols(), block_, result);
+    }
+    return result;
+}
+
+template <typename T>
+BasicDistributedMatrix<T> BasicDistributedMatrix<T>::transpose() const {
+    const ProcessGrid& g = *grid_;
+    const int processes = g.rows() * g.cols();
+    const size_t p = static_cast<size_t>(g.rows());
+    const size_t q = static_cast<size_t>(g.cols());
+    const size_t pr = static_cast<size_t>(g.row());
+    const size_t pc = static_cast<size_t>(g.col());
+    BasicDistributedMatrix result(grid_, cols_, rows_, block_, UNINITIALIZED);
+
+    // Tile (I, J) goes, transposed, to the owner of tile (J, I) of the
+    // result. Both sides walk the tiles of each pair of processes in
+    // increasing (I, J), so the receiver knows where each one goes.
+    auto sender_order = [&](const auto& f) {
+        for (size_t li = 0; li < local_rows_; li += block_) {
+            for (size_t lj = 0; lj < local_cols_; lj += block_) {
+                const size_t ti = li / block_ * p + pr;
+                const size_t tj = lj / block_ * q + pc;
+                f(static_cast<int>(tj % p * q + ti % q), li, lj,
+                  std::min(block_, local_rows_ - li),
+                  std::min(block_, local_cols_ - lj));
+            }
+        }
+    };
+    auto receiver_order = [&](const auto& f) {
+        for (size_t lj = 0; lj < result.local_cols_; lj += block_) {
+            for (size_t li = 0; li < result.local_rows_; li += block_) {
+                const size_t ti = lj / block_ * q + pc;
+                const size_t tj = li / block_ * p + pr;
+                f(static_cast<int>(ti % p * q + tj % q), li, lj,
+                  std::min(block_, result.local_rows_ - li),
+                  std::min(block_, result.local_cols_ - lj));
+            }
+        }
+    };
+
+    std::vector<size_t> send_counts(processes, 0);
+    std::vector<size_t> recv_counts(processes, 0);
+    sender_order([&](int dest, size_t, size_t, size_t h, size_t w) {
+        send_counts[dest] += h * w;
+    });
+    receiver_order([&](int source, size_t, size_t, size_t h, size_t w) {
+        recv_counts[source] += h * w;
+    });
+    std::vector<int> send_sizes(processes);
+    std::vector<int> send_offsets(processes);
+    std::vector<int> recv_sizes(processes);
+    std::vector<int> recv_offsets(processes);
+    size_t send_total = 0;
+    size_t recv_total = 0;
+    for (int r = 0; r < processes; ++r) {
+        send_sizes[r] = mpi_count(send_counts[r]);
+        send_offsets[r] = mpi_count(send_total);
+        recv_sizes[r] = mpi_count(recv_counts[r]);
+        recv_offsets[r] = mpi_count(recv_total);
+        send_total += send_counts[r];
+        recv_total += recv_counts[r];
+    }
+
+    std::vector<T> send(send_total);
+    std::vector<size_t> next(send_offsets.begin(), send_offsets.end());
+    sender_order([&](int dest, size_t li, size_t lj, size_t h, size_t w) {
+        detail::transpose(h, w, local_.data() + li * local_cols_ + lj,
+                          local_cols_, send.data() + next[dest], h);
+        next[dest] += h * w;
+    });
+    std::vector<T> recv(recv_total);
+    check(MPI_Alltoallv(send.data(), send_sizes.data(), send_offsets.data(),
+                        mpi_type<T>(), recv.data(), recv_sizes.data(),
+                        recv_offsets.data(), mpi_type<T>(), g.comm()));
+
+    next.assign(recv_offsets.begin(), recv_offsets.end());
+    T* out = result.local_.data();
+    receiver_order([&](int source, size_t li, size_t lj, size_t h,
+                       size_t w) {
+        for (size_t i = 0; i < h; ++i) {
+            std::copy_n(recv.data() + next[source] + i * w, w,
+                        out + (li + i) * result.local_cols_ + lj);
+        }
+        next[source] += h * w;
+    });
+    return result;
+}
+
+template <typename T>
+BasicDistributedMatrix<T>
+BasicDistributedMatrix<T>::operator*(const BasicDistributedMatrix& other)
+    const {
+    if (cols_ != other.rows_) {
+        throw std::invalid_argument(
+            "Matrix dimensions incompatible for multiplication");
+    }
+    if (grid_ != other.grid_ || block_ != other.block_) {
+        throw std::invalid_argument(
+            "Distributed operands must share their grid and block size");
+    }
+    const ProcessGrid& g = *grid_;
+    BasicDistributedMatrix result(grid_, rows_, other.cols_, block_,
+                                  UNINITIALIZED);
+    const size_t m = local_rows_;
+    const size_t n = other.local_cols_;
+    const size_t k = cols_;
+    const size_t panels = (k + block_ - 1) / block_;
+
+    // Double-buffered panels: those of step s + 1 are in flight while
+    // step s is multiplied. Within a process row every process has the
+    // same m, within a process column the same n, so the counts agree.
+    std::vector<T> a_panel[2] = {std::vector<T>(m * block_),
+                                 std::vector<T>(m * block_)};
+    std::vector<T> b_panel[2] = {std::vector<T>(block_ * n),
+                                 std::vector<T>(block_ * n)};
+    const T* b_data[2] = {nullptr, nullptr};
+    MPI_Request requests[2][2];
+
+    auto post = [&](size_t s) {
+        const int slot = static_cast<int>(s % 2);
+        const size_t w = std::min(block_, k - s * block_);
+        const int a_owner = static_cast<int>(s % g.cols());
+        const int b_owner = static_cast<int>(s % g.rows());
+        T* a = a_panel[slot].data();
+        if (g.col() == a_owner) {
+            const size_t col = s / g.cols() * block_;
+            for (size_t i = 0; i < m; ++i) {
+                std::copy_n(local_.data() + i * local_cols_ + col, w,
+                            a + i * w);
+            }
+        }
+        // B's panel is whole rows of the local matrix: its owner sends it
+        // in place.
+        T* b = b_panel[slot].data();
+        if (g.row() == b_owner) {
+            b = const_cast<T*>(other.local_.data()) +
+                s / g.rows() * block_ * n;
+        }
+        b_data[slot] = b;
+        check(MPI_Ibcast(a, mpi_count(m * w), mpi_type<T>(), a_owner,
+                         g.row_comm(), &requests[slot][0]));
+        check(MPI_Ibcast(b, mpi_count(w * n), mpi_type<T>(), b_owner,
+                         g.col_comm(), &requests[slot][1]));
+    };
+
+    post(0);
+    for (size_t s = 0; s < panels; ++s) {
+        if (s + 1 < panels) {
+            post(s + 1);
+        }
+        const int slot = static_cast<int>(s % 2);
+        check(MPI_Waitall(2, requests[slot], MPI_STATUSES_IGNORE));
+        const size_t w = std::min(block_, k - s * block_);
+        if (m > 0 && n > 0) {
+            gemm(m, n, w, T(1), a_panel[slot].data(), w, b_data[slot], n,
+                 s == 0 ? T(0) : T(1), result.local_.data(), n);
+        }
+    }
+    return result;
+}
+
+template <typename T>
+typename BasicDistributedMatrix<T>::real_type
+BasicDistributedMatrix<T>::norm() const {
+    if (reduction_mode() == ReductionMode::EXACT) {
+        // Normalized digits add as integers, in any order, so the norm
+        // does not depend on the process grid either.
+        detail::ExactSum sum =
+            detail::exact_sum_squares(local_.data(), local_.size());
+        sum.normalize();
+        check(MPI_Allreduce(MPI_IN_PLACE, sum.digits(),
+                            static_cast<int>(detail::ExactSum::DIGITS),
+                            MPI_INT64_T, MPI_SUM, grid_->comm()));
+        check(MPI_Allreduce(MPI_IN_PLACE, &sum.special(), 1, MPI_DOUBLE,
+                            MPI_SUM, grid_->comm()));
+        sum.normalize();
+        return static_cast<real_type>(sum.sqrt());
+    }
+    double sum = detail::sum_squares(local_.data(), local_.size());
+    check(MPI_Allreduce(MPI_IN_PLACE, &sum, 1, MPI_DOUBLE, MPI_SUM,
+                        grid_->comm()));
+    return static_cast<real_type>(std::sqrt(sum));
+}
+
+#define MATRIXOPS_INSTANTIATE_DISTRIBUTED_MATRIX(T)                            \
+    template class BasicDistributedMatrix<T>;
+
+MATRIXOPS_INSTANTIATE_DISTRIBUTED_MATRIX(float)
+MATRIXOPS_INSTANTIATE_DISTRIBUTED_MATRIX(double)
+MATRIXOPS_INSTANTIATE_DISTRIBUTED_MATRIX(std::complex<float>)
+MATRIXOPS_INSTANTIATE_DISTRIBUTED_MATRIX(std::complex<double>)
+
+#undef MATRIXOPS_INSTANTIATE_DISTRIBUTED_MATRIX
+
+} // namespace matrixops
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstdlib>
+#include <string>
+
+namespace matrixops {
+namespace detail {
+
+/**
+ * @brief Read an environment variable, returning an empty string if unset
+ */
+inline std::string get_env(const char* name) {
+#ifdef _MSC_VER
+    char* value = nullptr;
+    size_t length = 0;
+    if (_dupenv_s(&value, &length, name) != 0 || value == nullptr) {
+        return {};
+    }
+    std::string result(value);
+    std::free(value);
+    return result;
+#else
+    const char* value = std::getenv(name);
+    return value != nullptr ? value : "";
+#endif
+}
+
+} // namespace detail
+} // namespace matrixops
@@ -0,0 +1,468 @@
+#include "matrixops/gemm.h"
+
+#include "matrixops/parallel.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <stdexcept>
+
+#include "blas.h"
+#include "instrumentation.h"
+#include "kernels.h"
+#include "portable_kernels.h"
+#include "strassen.h"
+#include "tuning.h"
+#include "workspace.h"
+
+namespace matrixops {
+
+namespace {
+
+// Block sizes are kept multiples of the largest register tile of any
+// kernel variant and element type (see kernels.h).
+constexpr size_t TILE_MULTIPLE = 16;
+
+// Below this many multiply-adds packing costs more than it saves.
+constexpr size_t SMALL_GEMM_FLOPS = 32 * 32 * 32;
+
+// Below this many multiply-adds the product stays on the calling thread.
+constexpr size_t PARALLEL_GEMM_FLOPS = 96 * 96 * 96;
+
+// Smallest number of nr-wide column panels handed to one task.
+constexpr size_t MIN_PANELS_PER_TASK = 8;
+
+// Workspace tags of the packed operands and of the float copy of C.
+struct PackedA;
+struct PackedB;
+struct ReducedC;
+
+// Set by CMake from MATRIXOPS_BLAS_THRESHOLD.
+#ifndef MATRIXOPS_BLAS_THRESHOLD
+#define MATRIXOPS_BLAS_THRESHOLD 32768
+#endif
+
+std::atomic<size_t> blas_threshold_flops{MATRIXOPS_BLAS_THRESHOLD};
+
+std::atomic<bool> strassen_enabled{StrassenSettings{}.enabled};
+std::atomic<size_t> strassen_crossover{StrassenSettings{}.crossover};
+
+std::atomic<size_t> blocking_mc{GemmBlocking{}.mc};
+std::atomic<size_t> blocking_kc{GemmBlocking{}.kc};
+std::atomic<size_t> blocking_nc{GemmBlocking{}.nc};
+
+size_t round_up(size_t value, size_t multiple) {
+    return (value + multiple - 1) / multiple * multiple;
+}
+
+// Offset of element (i, j) of an operand with leading dimension ld.
+size_t offset(Layout layout, size_t i, size_t j, size_t ld) {
+    return layout == Layout::ROW_MAJOR ? i * ld + j : j * ld + i;
+}
+
+// Micro-kernel for the compute type T: the kernel table for double and
+// float, a portable register tile for the complex types.
+template <typename T>
+detail::GemmKernel<T> gemm_kernel() {
+    if constexpr (detail::HAS_SIMD_KERNELS<T>) {
+        return detail::typed_kernels<T>().gemm;
+    } else {
+        return {4, 4, detail::gemm_micro_scalar<T, 4, 4>};
+    }
+}
+
+template <typename T>
+void scale_c(size_t m, size_t n, T beta, T* c, size_t ldc) {
+    if (beta == T(1)) {
+        return;
+    }
+    for (size_t i = 0; i < m; ++i) {
+        T* row = c + i * ldc;
+        if (beta == T(0)) {
+            std::fill(row, row + n, T(0));
+        } else {
+            for (size_t j = 0; j < n; ++j) {
+                row[j] *= beta;
+            }
+        }
+    }
+}
+
+// Unpacked loops for products too small to amortize packing: i-k-j
+// along the rows of a row-major B, dot products down the columns of a
+// column-major one.
+template <typename T, typename In>
+void gemm_small(size_t m, size_t n, size_t k, T alpha, const In* a,
+                size_t lda, Layout layout_a, const In* b, size_t ldb,
+                Layout layout_b, T* c, size_t ldc) {
+    for (size_t i = 0; i < m; ++i) {
+        T* c_row = c + i * ldc;
+        if (layout_b == Layout::ROW_MAJOR) {
+            for (size_t p = 0; p < k; ++p) {
+                const T a_ip =
+                    alpha * static_cast<T>(a[offset(layout_a, i, p, lda)]);
+                const In* b_row = b + p * ldb;
+                for (size_t j = 0; j < n; ++j) {
+                    c_row[j] += a_ip * static_cast<T>(b_row[j]);
+                }
+            }
+        } else {
+            for (size_t j = 0; j < n; ++j) {
+                const In* b_col = b + j * ldb;
+                T sum(0);
+                for (size_t p = 0; p < k; ++p) {
+                    sum += static_cast<T>(a[offset(layout_a, i, p, lda)]) *
+                           static_cast<T>(b_col[p]);
+                }
+                c_row[j] += alpha * sum;
+            }
+        }
+    }
+}
+
+// Pack an mc x kc block of A into mr_tile-row micro-panels, column by
+// column, zero-padding the last panel. Narrower inputs are widened to
+// the compute type here, so the micro-kernels only ever see T. The
+// panels are read down the columns of A: strided when it is row-major,
+// contiguous when it is column-major.
+template <typename T, typename In>
+void pack_a(size_t mc, size_t kc, const In* a, size_t lda, Layout layout,
+            size_t mr_tile, T* packed) {
+    const size_t row_step = layout == Layout::ROW_MAJOR ? lda : 1;
+    const size_t col_step = layout == Layout::ROW_MAJOR ? 1 : lda;
+    for (size_t ir = 0; ir < mc; ir += mr_tile) {
+        const size_t mr = std::min(mr_tile, mc - ir);
+        for (size_t p = 0; p < kc; ++p) {
+            const In* a_col = a + ir * row_step + p * col_step;
+            for (size_t i = 0; i < mr; ++i) {
+                packed[i] = static_cast<T>(a_col[i * row_step]);
+            }
+            for (size_t i = mr; i < mr_tile; ++i) {
+                packed[i] = T(0);
+            }
+            packed += mr_tile;
+        }
+    }
+}
+
+// Pack a kc x nc panel of B into nr_tile-column micro-panels, row by row,
+// zero-padding the last panel. The contiguous copy of a row-major B
+// vectorizes; a column-major one is gathered across its columns.
+template <typename T, typename In>
+void pack_b(size_t kc, size_t nc, const In* b, size_t ldb, Layout layout,
+            size_t nr_tile, T* packed) {
+    for (size_t jr = 0; jr < nc; jr += nr_tile) {
+        const size_t nr = std::min(nr_tile, nc - jr);
+        for (size_t p = 0; p < kc; ++p) {
+            if (layout == Layout::ROW_MAJOR) {
+                const In* b_row = b + p * ldb + jr;
+                for (size_t j = 0; j < nr; ++j) {
+                    packed[j] = static_cast<T>(b_row[j]);
+                }
+            } else {
+                const In* b_row = b + jr * ldb + p;
+                for (size_t j = 0; j < nr; ++j) {
+                    packed[j] = static_cast<T>(b_row[j * ldb]);
+                }
+            }
+            for (size_t j = nr; j < nr_tile; ++j) {
+                packed[j] = T(0);
+            }
+            packed += nr_tile;
+        }
+    }
+}
+
+template <typename T>
+void macro_kernel(const detail::GemmKernel<T>& k, size_t mc, size_t nc,
+                  size_t kc, T alpha, const T* packed_a, const T* packed_b,
+                  T* c, size_t ldc) {
+    for (size_t jr = 0; jr < nc; jr += k.nr) {
+        const size_t nr = std::min(k.nr, nc - jr);
+        for (size_t ir = 0; ir < mc; ir += k.mr) {
+            const size_t mr = std::min(k.mr, mc - ir);
+            k.micro(kc, alpha, packed_a + ir * kc, packed_b + jr * kc,
+                    c + ir * ldc + jr, ldc, mr, nr);
+        }
+    }
+}
+
+// C = alpha * A * B + beta * C with A and B of type In, computed and
+// accumulated in T.
+template <typename T, typename In>
+void gemm_packed(size_t m, size_t n, size_t k, T alpha, const In* a,
+                 size_t lda, const In* b, size_t ldb, T beta, T* c,
+                 size_t ldc, Layout layout_a, Layout layout_b) {
+    if (m == 0 || n == 0) {
+        return;
+    }
+    scale_c(m, n, beta, c, ldc);
+    if (k == 0 || alpha == T(0)) {
+        return;
+    }
+    if (m * n * k <= SMALL_GEMM_FLOPS) {
+        gemm_small(m, n, k, alpha, a, lda, layout_a, b, ldb, layout_b, c,
+                   ldc);
+        return;
+    }
+
+    const detail::GemmKernel<T> kern = gemm_kernel<T>();
+    const GemmBlocking blocking = gemm_blocking();
+    const size_t nc_max = round_up(std::min(blocking.nc, n), kern.nr);
+    const size_t kc_max = std::min(blocking.kc, k);
+    const size_t mc_max = round_up(std::min(blocking.mc, m), kern.mr);
+
+    // Reused across calls so that steady-state products do not allocate.
+    detail::Workspace<T, PackedB> b_workspace;
+    T* const packed_b = b_workspace.data(kc_max * nc_max);
+
+    // Work is split into (mc row block) x (group of nr column panels)
+    // tasks; column groups only matter when there are fewer row blocks
+    // than threads, as for short-fat products.
+    const size_t ic_blocks = (m + blocking.mc - 1) / blocking.mc;
+    const bool parallel = m * n * k >= PARALLEL_GEMM_FLOPS;
+    const size_t threads = parallel ? num_threads() : 1;
+    const size_t task_grain = parallel ? 1 : SIZE_MAX;
+
+    for (size_t jc = 0; jc < n; jc += blocking.nc) {
+        const size_t nc = std::min(blocking.nc, n - jc);
+        const size_t panels = (nc + kern.nr - 1) / kern.nr;
+        const size_t groups =
+            ic_blocks >= threads
+                ? 1
+                : std::max<size_t>(
+                      1, std::min((threads + ic_blocks - 1) / ic_blocks,
+                                  panels / MIN_PANELS_PER_TASK));
+        const size_t panels_per_group = (panels + groups - 1) / groups;
+
+        for (size_t pc = 0; pc < k; pc += blocking.kc) {
+            const size_t kc = std::min(blocking.kc, k - pc);
+            const In* b_block = b + offset(layout_b, pc, jc, ldb);
+            T* const packed = packed_b;
+
+            auto pack_panels = [&](size_t lo, size_t hi) {
+                const size_t j0 = lo * kern.nr;
+                const size_t j1 = std::min(nc, hi * kern.nr);
+                pack_b(kc, j1 - j0, b_block + offset(layout_b, 0, j0, ldb),
+                       ldb, layout_b, kern.nr, packed + j0 * kc);
+            };
+            parallel_for(0, panels, parallel ? MIN_PANELS_PER_TASK : SIZE_MAX,
+                         pack_panels);
+
+            auto run_tasks = [&](size_t lo, size_t hi) {
+                detail::Workspace<T, PackedA> a_workspace;
+                T* const packed_a = a_workspace.data(mc_max * kc_max);
+                size_t packed_ic = SIZE_MAX;
+                for (size_t task = lo; task < hi; ++task) {
+                    const size_t ic = task / groups * blocking.mc;
+                    const size_t jr =
+                        task % groups * panels_per_group * kern.nr;
+                    if (jr >= nc) {
+                        continue;
+                    }
+                    const size_t mc = std::min(blocking.mc, m - ic);
+                    const size_t width =
+                        std::min(panels_per_group * kern.nr, nc - jr);
+                    // Consecutive tasks share a row block; pack it once.
+                    if (ic != packed_ic) {
+                        pack_a(mc, kc, a + offset(layout_a, ic, pc, lda),
+                               lda, layout_a, kern.mr, packed_a);
+                        packed_ic = ic;
+                    }
+                    macro_kernel(kern, mc, width, kc, alpha, packed_a,
+                                 packed + jr * kc, c + ic * ldc + jc + jr,
+                                 ldc);
+                }
+            };
+            parallel_for(0, ic_blocks * groups, task_grain, run_tasks);
+        }
+    }
+}
+
+// Half and bfloat16 products: accumulate into a float copy of C and round
+// each element once at the end.
+template <typename In>
+void gemm_reduced(size_t m, size_t n, size_t k, float alpha, const In* a,
+                  size_t lda, const In* b, size_t ldb, float beta, In* c,
+                  size_t ldc, Layout layout_a, Layout layout_b) {
+    if (m == 0 || n == 0) {
+        return;
+    }
+    detail::Workspace<float, ReducedC> c_workspace;
+    float* const c32 = c_workspace.data(m * n);
+    if (beta != 0.0F) {
+        for (size_t i = 0; i < m; ++i) {
+            for (size_t j = 0; j < n; ++j) {
+                c32[i * n + j] = c[i * ldc + j];
+            }
+        }
+    }
+    gemm_packed(m, n, k, alpha, a, lda, b, ldb, beta, c32, n,
+                layout_a, layout_b);
+    for (size_t i = 0; i < m; ++i) {
+        for (size_t j = 0; j < n; ++j) {
+            c[i * ldc + j] = c32[i * n + j];
+        }
+    }
+}
+
+// Full-precision products go to the vendor BLAS from the threshold up,
+// where its call overhead no longer shows. In Strassen mode the large
+// ones are split first, and the half-size products come back here;
+// Strassen splits row-major operands only.
+template <typename T>
+void gemm_dispatch(size_t m, size_t n, size_t k, T alpha, const T* a,
+                   size_t lda, const T* b, size_t ldb, T beta, T* c,
+                   size_t ldc, Layout layout_a, Layout layout_b) {
+    detail::tune_on_first_use();
+    if (layout_a == Layout::ROW_MAJOR && layout_b == Layout::ROW_MAJOR &&
+        strassen_enabled.load(std::memory_order_relaxed)) {
+        const size_t crossover =
+            strassen_crossover.load(std::memory_order_relaxed);
+        if (std::min({m, n, k}) > crossover) {
+            detail::strassen_gemm(m, n, k, alpha, a, lda, b, ldb, beta, c,
+                                  ldc, crossover);
+            return;
+        }
+    }
+    if (detail::HAS_BLAS && m != 0 && n != 0 && k != 0 &&
+        m * n * k >= blas_threshold() &&
+        detail::blas_gemm(m, n, k, alpha, a, lda, b, ldb, beta, c, ldc,
+                          layout_a, layout_b)) {
+        return;
+    }
+    gemm_packed(m, n, k, alpha, a, lda, b, ldb, beta, c, ldc, layout_a,
+                layout_b);
+}
+
+} // namespace
+
+const char* blas_backend() {
+#ifdef MATRIXOPS_BLAS_NAME
+    return MATRIXOPS_BLAS_NAME;
+#else
+    return "none";
+#endif
+}
+
+StrassenSettings strassen_settings() {
+    StrassenSettings settings;
+    settings.enabled = strassen_enabled.load(std::memory_order_relaxed);
+    settings.crossover = strassen_crossover.load(std::memory_order_relaxed);
+    return settings;
+}
+
+void set_strassen_settings(const StrassenSettings& settings) {
+    if (settings.crossover == 0) {
+        throw std::invalid_argument("Strassen crossover must be positive");
+    }
+    strassen_crossover.store(settings.crossover, std::memory_order_relaxed);
+    strassen_enabled.store(settings.enabled, std::memory_order_relaxed);
+}
+
+size_t blas_threshold() {
+    return blas_threshold_flops.load(std::memory_order_relaxed);
+}
+
+void set_blas_threshold(size_t flops) {
+    blas_threshold_flops.store(flops, std::memory_order_relaxed);
+}
+
+GemmBlocking gemm_blocking() {
+    GemmBlocking blocking;
+    blocking.mc = blocking_mc.load(std::memory_order_relaxed);
+    blocking.kc = blocking_kc.load(std::memory_order_relaxed);
+    blocking.nc = blocking_nc.load(std::memory_order_relaxed);
+    return blocking;
+}
+
+void set_gemm_blocking(const GemmBlocking& blocking) {
+    if (blocking.mc == 0 || blocking.kc == 0 || blocking.nc == 0) {
+        throw std::invalid_argument("GEMM block sizes must be positive");
+    }
+    blocking_mc.store(round_up(blocking.mc, TILE_MULTIPLE),
+                      std::memory_order_relaxed);
+    blocking_kc.store(blocking.kc, std::memory_order_relaxed);
+    blocking_nc.store(round_up(blocking.nc, TILE_MULTIPLE),
+                      std::memory_order_relaxed);
+}
+
+// Records a public gemm() call; c is read as well as written unless beta
+// is zero, which the byte count ignores.
+#define MATRIXOPS_INSTRUMENT_GEMM(a, c)                                        \
+    MATRIXOPS_INSTRUMENT(GEMM, m * n,                                          \
+                         detail::multiply_add_flops(c) * m * n * k,            \
+                         (m * k + k * n) * sizeof(*(a)) +                      \
+                             m * n * sizeof(*(c)))
+
+void gemm(size_t m, size_t n, size_t k, double alpha, const double* a,
+          size_t lda, const double* b, size_t ldb, double beta, double* c,
+          size_t ldc, Layout layout_a, Layout layout_b) {
+    MATRIXOPS_INSTRUMENT_GEMM(a, c);
+    gemm_dispatch(m, n, k, alpha, a, lda, b, ldb, beta, c, ldc, layout_a,
+                  layout_b);
+}
+
+void gemm(size_t m, size_t n, size_t k, float alpha, const float* a,
+          size_t lda, const float* b, size_t ldb, float beta, float* c,
+          size_t ldc, Layout layout_a, Layout layout_b) {
+    MATRIXOPS_INSTRUMENT_GEMM(a, c);
+    gemm_dispatch(m, n, k, alpha, a, lda, b, ldb, beta, c, ldc, layout_a,
+                  layout_b);
+}
+
+void gemm(size_t m, size_t n, size_t k, std::complex<float> alpha,
+          const std::complex<float>* a, size_t lda,
+          const std::complex<float>* b, size_t ldb, std::complex<float> beta,
+          std::complex<float>* c, size_t ldc, Layout layout_a,
+          Layout layout_b) {
+    MATRIXOPS_INSTRUMENT_GEMM(a, c);
+    gemm_dispatch(m, n, k, alpha, a, lda, b, ldb, beta, c, ldc, layout_a,
+                  layout_b);
+}
+
+void gemm(size_t m, size_t n, size_t k, std::complex<double> alpha,
+          const std::complex<double>* a, size_t lda,
+          const std::complex<double>* b, size_t ldb,
+          std::complex<double> beta, std::complex<double>* c, size_t ldc,
+          Layout layout_a, Layout layout_b) {
+    MATRIXOPS_INSTRUMENT_GEMM(a, c);
+    gemm_dispatch(m, n, k, alpha, a, lda, b, ldb, beta, c, ldc, layout_a,
+                  layout_b);
+}
+
+void gemm(size_t m, size_t n, size_t k, float alpha, const Half* a,
+          size_t lda, const Half* b, size_t ldb, float beta, Half* c,
+          size_t ldc, Layout layout_a, Layout layout_b) {
+    MATRIXOPS_INSTRUMENT_GEMM(a, c);
+    gemm_reduced(m, n, k, alpha, a, lda, b, ldb, beta, c, ldc, layout_a,
+                 layout_b);
+}
+
+void gemm(size_t m, size_t n, size_t k, float alpha, const Half* a,
+          size_t lda, const Half* b, size_t ldb, float beta, float* c,
+          size_t ldc, Layout layout_a, Layout layout_b) {
+    MATRIXOPS_INSTRUMENT_GEMM(a, c);
+    gemm_packed(m, n, k, alpha, a, lda, b, ldb, beta, c, ldc, layout_a,
+                layout_b);
+}
+
+void gemm(size_t m, size_t n, size_t k, float alpha, const BFloat16* a,
+          size_t lda, const BFloat16* b, size_t ldb, float beta, BFloat16* c,
+          size_t ldc, Layout layout_a, Layout layout_b) {
+    MATRIXOPS_INSTRUMENT_GEMM(a, c);
+    gemm_reduced(m, n, k, alpha, a, lda, b, ldb, beta, c, ldc, layout_a,
+                 layout_b);
+}
+
+void gemm(size_t m, size_t n, size_t k, float alpha, const BFloat16* a,
+          size_t lda, const BFloat16* b, size_t ldb, float beta, float* c,
+          size_t ldc, Layout layout_a, Layout layout_b) {
+    MATRIXOPS_INSTRUMENT_GEMM(a, c);
+    gemm_packed(m, n, k, alpha, a, lda, b, ldb, beta, c, ldc, layout_a,
+                layout_b);
+}
+
+#undef MATRIXOPS_INSTRUMENT_GEMM
+
+} // namespace matrixops
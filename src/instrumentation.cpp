@@ -0,0 +1,268 @@
+#include "matrixops/instrumentation.h"
+#include <array>
+#include <atomic>
+#include <locale>
+#include <sstream>
+
+#include "instrumentation.h"
+
+#ifdef MATRIXOPS_ITT
+#include <ittnotify.h>
+#endif
+
+namespace matrixops {
+
+namespace {
+
+constexpr const char* OPERATION_NAMES[] = {
+    "multiply", "gemm", "add", "scale", "transpose", "norm",
+};
+static_assert(sizeof(OPERATION_NAMES) / sizeof(OPERATION_NAMES[0]) ==
+                  static_cast<size_t>(detail::Operation::COUNT),
+              "Every operation needs a name");
+
+std::atomic<bool> enabled{true};
+std::atomic<void* (*)(const char*, void*)> zone_begin{nullptr};
+std::atomic<void (*)(void*, void*)> zone_end{nullptr};
+std::atomic<void*> zone_user{nullptr};
+
+#ifdef MATRIXOPS_INSTRUMENTATION
+
+// One bucket per bit length of the element count: bucket b holds counts
+// in [2^(b - 1), 2^b), bucket 0 empty results.
+constexpr size_t BUCKETS = 65;
+
+struct Totals {
+    std::atomic<uint64_t> calls{0};
+    std::atomic<uint64_t> nanoseconds{0};
+    std::atomic<uint64_t> flops{0};
+    std::atomic<uint64_t> bytes{0};
+    std::atomic<uint64_t> allocated{0};
+};
+
+struct Table {
+    std::array<std::array<Totals, BUCKETS>,
+               static_cast<size_t>(detail::Operation::COUNT)>
+        operations;
+    // Allocations outside of any operation.
+    Totals unattributed;
+};
+
+Table& table() {
+    static Table instance;
+    return instance;
+}
+
+size_t bucket(size_t elements) {
+    size_t bits = 0;
+    while (elements != 0) {
+        elements >>= 1;
+        ++bits;
+    }
+    return bits;
+}
+
+// The scope recording on this thread, if any.
+thread_local detail::OperationScope* current_scope = nullptr;
+
+#ifdef MATRIXOPS_ITT
+__itt_domain* itt_domain() {
+    static __itt_domain* const domain = __itt_domain_create("MatrixOps");
+    return domain;
+}
+
+__itt_string_handle* itt_name(detail::Operation operation) {
+    static const auto handles = [] {
+        std::array<__itt_string_handle*,
+                   static_cast<size_t>(detail::Operation::COUNT)>
+            result{};
+        for (size_t i = 0; i < result.size(); ++i) {
+            result[i] = __itt_string_handle_create(OPERATION_NAMES[i]);
+        }
+        return result;
+    }();
+    return handles[static_cast<size_t>(operation)];
+}
+#endif
+
+void append_stats(std::vector<OperationStats>& stats, const char* name,
+                  size_t min_elements, uint64_t calls, uint64_t nanoseconds,
+                  uint64_t flops, uint64_t bytes, uint64_t allocated) {
+    if (calls == 0 && allocated == 0) {
+        return;
+    }
+    OperationStats s;
+    s.operation = name;
+    s.min_elements = min_elements;
+    s.calls = calls;
+    s.seconds = static_cast<double>(nanoseconds) * 1e-9;
+    s.flops = static_cast<double>(flops);
+    s.bytes = static_cast<double>(bytes);
+    s.bytes_allocated = allocated;
+    stats.push_back(s);
+}
+
+#endif
+
+} // namespace
+
+namespace detail {
+
+#ifdef MATRIXOPS_INSTRUMENTATION
+
+OperationScope::OperationScope(Operation operation, size_t elements,
+                               double flops, double bytes)
+    : operation_(operation), elements_(elements), flops_(flops),
+      bytes_(bytes) {
+    if (current_scope != nullptr ||
+        !enabled.load(std::memory_order_relaxed)) {
+        return;
+    }
+    active_ = true;
+    current_scope = this;
+    const auto begin = zone_begin.load(std::memory_order_acquire);
+    if (begin != nullptr) {
+        zone_ = begin(OPERATION_NAMES[static_cast<size_t>(operation)],
+                      zone_user.load(std::memory_order_relaxed));
+    }
+#ifdef MATRIXOPS_ITT
+    __itt_task_begin(itt_domain(), __itt_null, __itt_null,
+                     itt_name(operation));
+#endif
+    start_ = std::chrono::steady_clock::now();
+}
+
+OperationScope::~OperationScope() {
+    if (!active_) {
+        return;
+    }
+    const auto elapsed = std::chrono::steady_clock::now() - start_;
+#ifdef MATRIXOPS_ITT
+    __itt_task_end(itt_domain());
+#endif
+    const auto end = zone_end.load(std::memory_order_acquire);
+    if (end != nullptr) {
+        end(zone_, zone_user.load(std::memory_order_relaxed));
+    }
+    current_scope = nullptr;
+
+    Totals& totals = table().operations[static_cast<size_t>(operation_)]
+                                       [bucket(elements_)];
+    totals.calls.fetch_add(1, std::memory_order_relaxed);
+    totals.nanoseconds.fetch_add(
+        static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed)
+                .count()),
+        std::memory_order_relaxed);
+    totals.flops.fetch_add(static_cast<uint64_t>(flops_),
+                           std::memory_order_relaxed);
+    totals.bytes.fetch_add(static_cast<uint64_t>(bytes_),
+                           std::memory_order_relaxed);
+    totals.allocated.fetch_add(allocated_, std::memory_order_relaxed);
+}
+
+void OperationScope::record_allocation(size_t bytes) {
+    if (current_scope != nullptr) {
+        current_scope->allocated_ += bytes;
+        return;
+    }
+    if (!enabled.load(std::memory_order_relaxed)) {
+        return;
+    }
+    Totals& totals = table().unattributed;
+    totals.calls.fetch_add(1, std::memory_order_relaxed);
+    totals.allocated.fetch_add(bytes, std::memory_order_relaxed);
+}
+
+#endif
+
+} // namespace detail
+
+bool instrumentation_available() {
+#ifdef MATRIXOPS_INSTRUMENTATION
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool instrumentation_enabled() {
+    return instrumentation_available() &&
+           enabled.load(std::memory_order_relaxed);
+}
+
+void set_instrumentation_enabled(bool on) {
+    enabled.store(on, std::memory_order_relaxed);
+}
+
+std::vector<OperationStats> instrumentation_stats() {
+    std::vector<OperationStats> stats;
+#ifdef MATRIXOPS_INSTRUMENTATION
+    Table& t = table();
+    for (size_t op = 0; op < t.operations.size(); ++op) {
+        for (size_t b = 0; b < BUCKETS; ++b) {
+            const Totals& totals = t.operations[op][b];
+            append_stats(stats, OPERATION_NAMES[op],
+                         b == 0 ? 0 : size_t{1} << (b - 1),
+                         totals.calls.load(std::memory_order_relaxed),
+                         totals.nanoseconds.load(std::memory_order_relaxed),
+                         totals.flops.load(std::memory_order_relaxed),
+                         totals.bytes.load(std::memory_order_relaxed),
+                         totals.allocated.load(std::memory_order_relaxed));
+        }
+    }
+    append_stats(stats, "allocate", 0,
+                 t.unattributed.calls.load(std::memory_order_relaxed), 0, 0,
+                 0, t.unattributed.allocated.load(std::memory_order_relaxed));
+#endif
+    return stats;
+}
+
+void reset_instrumentation() {
+#ifdef MATRIXOPS_INSTRUMENTATION
+    Table& t = table();
+    auto clear = [](Totals& totals) {
+        totals.calls.store(0, std::memory_order_relaxed);
+        totals.nanoseconds.store(0, std::memory_order_relaxed);
+        totals.flops.store(0, std::memory_order_relaxed);
+        totals.bytes.store(0, std::memory_order_relaxed);
+        totals.allocated.store(0, std::memory_order_relaxed);
+    };
+    for (auto& buckets : t.operations) {
+        for (Totals& totals : buckets) {
+            clear(totals);
+        }
+    }
+    clear(t.unattributed);
+#endif
+}
+
+std::string instrumentation_json() {
+    std::ostringstream out;
+    out.imbue(std::locale::classic());
+    out.precision(12);
+    out << "{\n  \"available\": "
+        << (instrumentation_available() ? "true" : "false")
+        << ",\n  \"operations\": [";
+    const std::vector<OperationStats> stats = instrumentation_stats();
+    for (size_t i = 0; i < stats.size(); ++i) {
+        const OperationStats& s = stats[i];
+        out << (i == 0 ? "\n" : ",\n") << "    {\"operation\": \""
+            << s.operation << "\", \"min_elements\": " << s.min_elements
+            << ", \"calls\": " << s.calls << ", \"seconds\": " << s.seconds
+            << ", \"flops\": " << s.flops << ", \"bytes\": " << s.bytes
+            << ", \"bytes_allocated\": " << s.bytes_allocated
+            << ", \"gflops\": " << s.gflops()
+            << ", \"gbytes_per_second\": " << s.gbytes_per_second() << "}";
+    }
+    out << (stats.empty() ? "]\n}\n" : "\n  ]\n}\n");
+    return out.str();
+}
+
+void set_zone_hooks(const ZoneHooks& hooks) {
+    zone_user.store(hooks.user, std::memory_order_relaxed);
+    zone_end.store(hooks.end, std::memory_order_release);
+    zone_begin.store(hooks.begin, std::memory_order_release);
+}
+
+} // namespace matrixops
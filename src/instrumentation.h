@@ -0,0 +1,88 @@
+#pragma once
+
+#include <chrono>
+#include <complex>
+#include <cstddef>
+#include <cstdint>
+
+// Hot-path instrumentation. With MATRIXOPS_INSTRUMENTATION undefined, the
+// default, MATRIXOPS_INSTRUMENT() expands to nothing and its arguments are
+// not evaluated.
+
+namespace matrixops {
+namespace detail {
+
+enum class Operation {
+    MULTIPLY,
+    GEMM,
+    ADD,
+    SCALE,
+    TRANSPOSE,
+    NORM,
+    COUNT
+};
+
+// Floating-point operations per multiply-add of T.
+template <typename T>
+constexpr double multiply_add_flops(const T*) {
+    return 2.0;
+}
+
+template <typename R>
+constexpr double multiply_add_flops(const std::complex<R>*) {
+    return 8.0;
+}
+
+#ifdef MATRIXOPS_INSTRUMENTATION
+
+/**
+ * @brief Records one operation, from construction to destruction
+ *
+ * Only the outermost scope of a thread records, so nested operations, such
+ * as the gemm() of operator*, are accounted to the operation that called
+ * them. Heap allocations made meanwhile by the thread are added to it.
+ */
+class OperationScope {
+public:
+    OperationScope(Operation operation, size_t elements, double flops,
+                   double bytes);
+    ~OperationScope();
+
+    OperationScope(const OperationScope&) = delete;
+    OperationScope& operator=(const OperationScope&) = delete;
+
+    /**
+     * @brief Account bytes allocated to the operation running on this
+     * thread, if any
+     */
+    static void record_allocation(size_t bytes);
+
+private:
+    bool active_ = false;
+    Operation operation_;
+    size_t elements_;
+    double flops_;
+    double bytes_;
+    uint64_t allocated_ = 0;
+    void* zone_ = nullptr;
+    std::chrono::steady_clock::time_point start_;
+};
+
+#define MATRIXOPS_INSTRUMENT(operation, elements, flops, bytes)                \
+    const ::matrixops::detail::OperationScope matrixops_operation_scope_(     \
+        ::matrixops::detail::Operation::operation,                             \
+        static_cast<size_t>(elements), static_cast<double>(flops),             \
+        static_cast<double>(bytes))
+
+#define MATRIXOPS_RECORD_ALLOCATION(bytes)                                     \
+    ::matrixops::detail::OperationScope::record_allocation(bytes)
+
+#else
+
+#define MATRIXOPS_INSTRUMENT(operation, elements, flops, bytes) ((void)0)
+#define MATRIXOPS_RECORD_ALLOCATION(bytes) ((void)0)
+
+#endif
+
+} // namespace detail
+} // namespace matrixops
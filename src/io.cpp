@@ -0,0 +1,311 @@
+#include "matrixops/io.h"
+
+#include "matrixops/allocator.h"
+
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+#include <string>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "matrix_file.h"
+
+namespace matrixops {
+
+namespace {
+
+using detail::MATRIX_FILE_HEADER_SIZE;
+using detail::MatrixFileHeader;
+using detail::element_type_of;
+using detail::matrix_file_error;
+
+constexpr char MAGIC[8] = {'M', 'A', 'T', 'R', 'I', 'X', 'O', 'P'};
+constexpr uint32_t BYTE_ORDER_MARK = 0x01020304;
+constexpr uint32_t SWAPPED_BYTE_ORDER_MARK = 0x04030201;
+
+static_assert(MATRIX_FILE_HEADER_SIZE % STORAGE_ALIGNMENT == 0,
+              "Matrix file data must stay aligned after the header");
+
+// Bytes per element, or 0 for an unknown code.
+size_t element_size(uint32_t code) {
+    switch (static_cast<ElementType>(code)) {
+    case ElementType::FLOAT32:
+        return sizeof(float);
+    case ElementType::FLOAT64:
+        return sizeof(double);
+    case ElementType::COMPLEX64:
+        return sizeof(std::complex<float>);
+    case ElementType::COMPLEX128:
+        return sizeof(std::complex<double>);
+    case ElementType::FLOAT16:
+        return sizeof(Half);
+    case ElementType::BFLOAT16:
+        return sizeof(BFloat16);
+    }
+    return 0;
+}
+
+// Open path and check its header; the stream is left after the header.
+MatrixFileInfo open_matrix_file(std::ifstream& in, const std::string& path) {
+    in.open(path, std::ios::binary);
+    if (!in) {
+        matrix_file_error(path, "cannot open for reading");
+    }
+    in.seekg(0, std::ios::end);
+    const auto file_size = static_cast<uint64_t>(in.tellg());
+    in.seekg(0, std::ios::beg);
+    MatrixFileHeader header;
+    if (file_size < MATRIX_FILE_HEADER_SIZE ||
+        !in.read(reinterpret_cast<char*>(&header), sizeof(header))) {
+        matrix_file_error(path, "truncated header");
+    }
+    return detail::check_matrix_file_header(header, file_size, path);
+}
+
+template <typename T>
+void check_element_type(const MatrixFileInfo& info, const std::string& path) {
+    if (info.element_type != element_type_of<T>()) {
+        matrix_file_error(path,
+                          "element type does not match the requested matrix");
+    }
+}
+
+} // namespace
+
+MatrixFileInfo read_matrix_file_info(const std::string& path) {
+    std::ifstream in;
+    return open_matrix_file(in, path);
+}
+
+template <typename T>
+void save_matrix(const std::string& path, const BasicMatrix<T>& m) {
+    const MatrixFileHeader header =
+        detail::make_matrix_file_header(element_type_of<T>(), m.rows(),
+                                        m.cols());
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        matrix_file_error(path, "cannot open for writing");
+    }
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(m.data()),
+              static_cast<std::streamsize>(header.data_bytes));
+    out.close();
+    if (!out) {
+        matrix_file_error(path, "write failed");
+    }
+}
+
+template <typename T>
+BasicMatrix<T> load_matrix(const std::string& path) {
+    std::ifstream in;
+    const MatrixFileInfo info = open_matrix_file(in, path);
+    check_element_type<T>(info, path);
+    BasicMatrix<T> m(info.rows, info.cols, UNINITIALIZED);
+    in.seekg(static_cast<std::streamoff>(info.data_offset));
+    if (!in.read(reinterpret_cast<char*>(m.data()),
+                 static_cast<std::streamsize>(info.rows * info.cols *
+                                              sizeof(T)))) {
+        matrix_file_error(path, "read failed");
+    }
+    return m;
+}
+
+namespace detail {
+
+void matrix_file_error(const std::string& path, const char* reason) {
+    throw std::runtime_error("Matrix file '" + path + "': " + reason);
+}
+
+MatrixFileInfo check_matrix_file_header(const MatrixFileHeader& h,
+                                        uint64_t file_size,
+                                        const std::string& path) {
+    if (std::memcmp(h.magic, MAGIC, sizeof(MAGIC)) != 0) {
+        matrix_file_error(path, "not a matrix file");
+    }
+    if (h.byte_order == SWAPPED_BYTE_ORDER_MARK) {
+        matrix_file_error(path, "written with the other byte order");
+    }
+    if (h.byte_order != BYTE_ORDER_MARK) {
+        matrix_file_error(path, "corrupt header");
+    }
+    if (h.version == 0 || h.version > MATRIX_FILE_VERSION) {
+        matrix_file_error(path, "unsupported format version");
+    }
+    const size_t size = element_size(h.element_type);
+    if (size == 0) {
+        matrix_file_error(path, "unknown element type");
+    }
+    if (h.element_size != size) {
+        matrix_file_error(path, "element size does not match the element type");
+    }
+    if (h.rows == 0 || h.cols == 0) {
+        matrix_file_error(path, "dimensions must be positive");
+    }
+    const uint64_t max = std::numeric_limits<size_t>::max();
+    if (h.rows > max / h.cols || h.rows * h.cols > max / size) {
+        matrix_file_error(path, "dimensions too large");
+    }
+    if (h.data_bytes != h.rows * h.cols * size) {
+        matrix_file_error(path, "data size does not match the dimensions");
+    }
+    if (h.data_offset < MATRIX_FILE_HEADER_SIZE ||
+        h.data_offset % STORAGE_ALIGNMENT != 0) {
+        matrix_file_error(path, "misaligned data");
+    }
+    if (file_size < h.data_offset ||
+        file_size - h.data_offset < h.data_bytes) {
+        matrix_file_error(path, "truncated");
+    }
+    return {h.version, static_cast<ElementType>(h.element_type),
+            static_cast<size_t>(h.rows), static_cast<size_t>(h.cols),
+            static_cast<size_t>(h.data_offset)};
+}
+
+MatrixFileHeader make_matrix_file_header(ElementType type, size_t rows,
+                                         size_t cols) {
+    MatrixFileHeader header{};
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = MATRIX_FILE_VERSION;
+    header.byte_order = BYTE_ORDER_MARK;
+    header.element_type = static_cast<uint32_t>(type);
+    header.element_size = static_cast<uint32_t>(
+        element_size(static_cast<uint32_t>(type)));
+    header.rows = rows;
+    header.cols = cols;
+    header.data_offset = MATRIX_FILE_HEADER_SIZE;
+    header.data_bytes = uint64_t{rows} * cols * header.element_size;
+    return header;
+}
+
+MatrixFileInfo mapped_matrix_file_info(const MappedFile& file,
+                                       const std::string& path) {
+    if (file.size() < MATRIX_FILE_HEADER_SIZE) {
+        matrix_file_error(path, "truncated header");
+    }
+    MatrixFileHeader header;
+    std::memcpy(&header, file.data(), sizeof(header));
+    return check_matrix_file_header(header, file.size(), path);
+}
+
+#if defined(_WIN32)
+
+MappedFile::MappedFile(const std::string& path) {
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ,
+                              nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL,
+                              nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        matrix_file_error(path, "cannot open for reading");
+    }
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size)) {
+        CloseHandle(file);
+        matrix_file_error(path, "cannot get the file size");
+    }
+    size_ = static_cast<size_t>(size.QuadPart);
+    if (size_ == 0) {
+        CloseHandle(file);
+        return;
+    }
+    mapping_ = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    CloseHandle(file);
+    if (mapping_ == nullptr) {
+        matrix_file_error(path, "cannot map");
+    }
+    data_ = static_cast<const unsigned char*>(
+        MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0));
+    if (data_ == nullptr) {
+        CloseHandle(mapping_);
+        matrix_file_error(path, "cannot map");
+    }
+}
+
+MappedFile::~MappedFile() {
+    if (data_ != nullptr) {
+        UnmapViewOfFile(data_);
+        CloseHandle(mapping_);
+    }
+}
+
+#else
+
+MappedFile::MappedFile(const std::string& path) {
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        matrix_file_error(path, "cannot open for reading");
+    }
+    struct stat st;
+    if (::fstat(fd, &st) != 0) {
+        ::close(fd);
+        matrix_file_error(path, "cannot get the file size");
+    }
+    size_ = static_cast<size_t>(st.st_size);
+    if (size_ == 0) {
+        ::close(fd);
+        return;
+    }
+    void* p = ::mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (p == MAP_FAILED) {
+        matrix_file_error(path, "cannot map");
+    }
+    data_ = static_cast<const unsigned char*>(p);
+}
+
+MappedFile::~MappedFile() {
+    if (data_ != nullptr) {
+        ::munmap(const_cast<unsigned char*>(data_), size_);
+    }
+}
+
+#endif
+
+} // namespace detail
+
+template <typename T>
+BasicMappedMatrix<T>::BasicMappedMatrix(const std::string& path)
+    : file_(std::make_unique<detail::MappedFile>(path)) {
+    const MatrixFileInfo info = detail::mapped_matrix_file_info(*file_, path);
+    check_element_type<T>(info, path);
+    rows_ = info.rows;
+    cols_ = info.cols;
+    data_ = reinterpret_cast<const T*>(file_->data() + info.data_offset);
+}
+
+template <typename T>
+T BasicMappedMatrix<T>::operator()(size_t i, size_t j) const {
+    if (i >= rows_ || j >= cols_) {
+        throw std::out_of_range("Matrix indices out of range");
+    }
+    return data_[i * cols_ + j];
+}
+
+#define MATRIXOPS_INSTANTIATE_IO(T)                                            \
+    template class BasicMappedMatrix<T>;                                       \
+    template void save_matrix(const std::string&, const BasicMatrix<T>&);      \
+    template BasicMatrix<T> load_matrix(const std::string&);
+
+MATRIXOPS_INSTANTIATE_IO(float)
+MATRIXOPS_INSTANTIATE_IO(double)
+MATRIXOPS_INSTANTIATE_IO(std::complex<float>)
+MATRIXOPS_INSTANTIATE_IO(std::complex<double>)
+MATRIXOPS_INSTANTIATE_IO(Half)
+MATRIXOPS_INSTANTIATE_IO(BFloat16)
+
+#undef MATRIXOPS_INSTANTIATE_IO
+
+} // namespace matrixops
@@ -0,0 +1,102 @@
+#pragma once
+
+#include "matrixops/simd.h"
+
+#include <cstddef>
+#include <type_traits>
+
+namespace matrixops {
+namespace detail {
+
+/**
+ * @brief Register-tiled GEMM micro-kernel and its tile
+ */
+template <typename T>
+struct GemmKernel {
+    /// Register tile of micro
+    size_t mr;
+    size_t nr;
+
+    /**
+     * C[0:mr, 0:nr] += alpha * A * B over kc-deep packed micro-panels: A
+     * holds mr values per step, B holds nr values per step.
+     */
+    void (*micro)(size_t kc, T alpha, const T* a, const T* b, T* c,
+                  size_t ldc, size_t mr, size_t nr);
+};
+
+/**
+ * @brief Kernels for one floating-point element type
+ */
+template <typename T>
+struct TypedKernels {
+    /// out[i] = a[i] + b[i]
+    void (*add)(const T* a, const T* b, T* out, size_t n);
+
+    /// out[i] = a[i] * scalar
+    void (*scale)(const T* a, T scalar, T* out, size_t n);
+
+    /// Sum of a[i]^2, accumulated in double
+    double (*sum_squares)(const T* a, size_t n);
+
+    /// Sum of a[i] * b[i], accumulated in T
+    T (*dot)(const T* a, const T* b, size_t n);
+
+    /// y[i] += alpha * x[i]
+    void (*axpy)(T alpha, const T* x, T* y, size_t n);
+
+    GemmKernel<T> gemm;
+
+    /// c = alpha * a * b + beta * c on one group of BATCH_LANES<T>
+    /// interleaved matrices (see batch.h), m x k times k x n; c is not
+    /// read when beta is zero
+    void (*gemm_batch)(size_t m, size_t n, size_t k, T alpha, const T* a,
+                       const T* b, T beta, T* c);
+};
+
+/**
+ * @brief Table of ISA-specific kernels selected at load time
+ */
+struct Kernels {
+    SimdIsa isa;
+
+    TypedKernels<double> f64;
+    TypedKernels<float> f32;
+
+    /// Side of the square register tile of transpose_micro
+    size_t transpose_tile;
+
+    /// dst[j * ldd + i] = src[i * lds + j] over one full tile; the two
+    /// tiles must not overlap
+    void (*transpose_micro)(const double* src, size_t lds, double* dst,
+                            size_t ldd);
+};
+
+/**
+ * @brief Get the active kernel table
+ */
+const Kernels& kernels();
+
+/**
+ * @brief Element types with an entry in the kernel table; the others use
+ * the portable templates of portable_kernels.h
+ */
+template <typename T>
+constexpr bool HAS_SIMD_KERNELS =
+    std::is_same_v<T, double> || std::is_same_v<T, float>;
+
+/**
+ * @brief Get the active kernels for double or float
+ */
+template <typename T>
+const TypedKernels<T>& typed_kernels() {
+    static_assert(HAS_SIMD_KERNELS<T>, "No SIMD kernels for this type");
+    if constexpr (std::is_same_v<T, double>) {
+        return kernels().f64;
+    } else {
+        return kernels().f32;
+    }
+}
+
+} // namespace detail
+} // namespace matrixops
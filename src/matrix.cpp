@@ -1,91 +1,418 @@
 #include "matrixops/matrix.h"
+#include "matrixops/gemm.h"
+#include "matrixops/parallel.h"
 #include <algorithm>
+#include <limits>
 #include <numeric>
 
+#include "instrumentation.h"
+#include "kernels.h"
+#include "portable_kernels.h"
+#include "reduction.h"
+#include "transpose.h"
+
 namespace matrixops {
 
-Matrix::Matrix(size_t rows, size_t cols, double init_value)
-    : rows_(rows), cols_(cols), data_(rows * cols, init_value) {
+using detail::ELEMENTWISE_GRAIN;
+
+namespace {
+
+// Elements without SIMD kernels go through the portable templates.
+// out may alias a or b: the kernels read each element before writing it.
+template <typename T>
+void add_arrays(const T* a, const T* b, T* out, size_t n) {
+    parallel_for(0, n, detail::elementwise_grain(), [&](size_t lo,
+                                                         size_t hi) {
+        if constexpr (detail::HAS_SIMD_KERNELS<T>) {
+            detail::typed_kernels<T>().add(a + lo, b + lo, out + lo, hi - lo);
+        } else {
+            detail::add_scalar(a + lo, b + lo, out + lo, hi - lo);
+        }
+    });
+}
+
+template <typename T>
+void scale_array(const T* a, T scalar, T* out, size_t n) {
+    parallel_for(0, n, detail::elementwise_grain(), [&](size_t lo,
+                                                         size_t hi) {
+        if constexpr (detail::HAS_SIMD_KERNELS<T>) {
+            detail::typed_kernels<T>().scale(a + lo, scalar, out + lo,
+                                             hi - lo);
+        } else {
+            detail::scale_scalar(a + lo, scalar, out + lo, hi - lo);
+        }
+    });
+}
+
+template <typename R>
+double sum_squares_block(const std::complex<R>* a, size_t n) {
+    double sum = 0.0;
+    for (size_t k = 0; k < n; ++k) {
+        const double re = a[k].real();
+        const double im = a[k].imag();
+        sum += re * re + im * im;
+    }
+    return sum;
+}
+
+template <typename T>
+double sum_squares_block(const T* a, size_t n) {
+    if constexpr (detail::HAS_SIMD_KERNELS<T>) {
+        return detail::typed_kernels<T>().sum_squares(a, n);
+    } else {
+        return detail::sum_squares_scalar(a, n);
+    }
+}
+
+// Sums of squares below this may have lost digits to underflow.
+constexpr double SMALL_SUM_SQUARES = std::numeric_limits<double>::min() /
+                                     std::numeric_limits<double>::epsilon();
+
+// sqrt(sum of a[k]^2) computed as scale * sqrt(sum of (a[k] / scale)^2),
+// with scale the largest magnitude, so that no square overflows.
+double scaled_norm(const double* a, size_t n) {
+    double scale = 0.0;
+    for (size_t k = 0; k < n; ++k) {
+        scale = std::max(scale, std::abs(a[k]));
+    }
+    if (scale == 0.0 || std::isinf(scale)) {
+        return scale;
+    }
+    double sum = 0.0;
+    for (size_t k = 0; k < n; ++k) {
+        const double v = a[k] / scale;
+        sum += v * v;
+    }
+    return scale * std::sqrt(sum);
+}
+
+using detail::ScalarTraits;
+
+template <typename T>
+using ComputeType = typename ScalarTraits<T>::compute_type;
+
+} // namespace
+
+namespace detail {
+
+template <typename T>
+double sum_squares(const T* a, size_t n) {
+    const ReductionMode mode = reduction_mode();
+    if (mode != ReductionMode::FAST) {
+        return ordered_sum_squares(a, n, mode);
+    }
+    const size_t blocks = (n + ELEMENTWISE_GRAIN - 1) / ELEMENTWISE_GRAIN;
+    if (blocks <= 1) {
+        return sum_squares_block(a, n);
+    }
+
+    std::vector<double> partial(blocks);
+    parallel_for(0, blocks, 1, [&](size_t lo, size_t hi) {
+        for (size_t block = lo; block < hi; ++block) {
+            const size_t offset = block * ELEMENTWISE_GRAIN;
+            partial[block] = sum_squares_block(
+                a + offset, std::min(ELEMENTWISE_GRAIN, n - offset));
+        }
+    });
+    return std::accumulate(partial.begin(), partial.end(), 0.0);
+}
+
+template <typename T>
+double euclidean_norm(const T* a, size_t n) {
+    if (reduction_mode() == ReductionMode::EXACT) {
+        return exact_sum_squares(a, n).sqrt();
+    }
+    const double sum = sum_squares(a, n);
+    // Squares of float, Half and BFloat16 values cannot leave the double
+    // range; NaN propagates from the plain sum.
+    if constexpr (std::is_same_v<T, double> ||
+                  std::is_same_v<T, std::complex<double>>) {
+        if (!std::isnan(sum) &&
+            !(sum >= SMALL_SUM_SQUARES &&
+              sum <= std::numeric_limits<double>::max())) {
+            if constexpr (std::is_same_v<T, double>) {
+                return scaled_norm(a, n);
+            } else {
+                // std::complex<double> is laid out as double[2].
+                return scaled_norm(reinterpret_cast<const double*>(a),
+                                   2 * n);
+            }
+        }
+    }
+    return std::sqrt(sum);
+}
+
+} // namespace detail
+
+namespace {
+
+// rows * cols, checked before the storage is sized from it.
+size_t element_count(size_t rows, size_t cols) {
+    if (cols != 0 && rows > std::numeric_limits<size_t>::max() / cols) {
+        throw std::length_error("Matrix dimensions overflow");
+    }
+    return rows * cols;
+}
+
+} // namespace
+
+template <typename T>
+BasicMatrix<T>::BasicMatrix(size_t rows, size_t cols, T init_value)
+    : rows_(rows), cols_(cols), data_(element_count(rows, cols), init_value) {
     if (rows == 0 || cols == 0) {
         throw std::invalid_argument("Matrix dimensions must be positive");
     }
 }
 
-double& Matrix::operator()(size_t i, size_t j) {
+template <typename T>
+BasicMatrix<T>::BasicMatrix(size_t rows, size_t cols, UninitializedTag)
+    : rows_(rows), cols_(cols), data_(element_count(rows, cols)) {
+    if (rows == 0 || cols == 0) {
+        throw std::invalid_argument("Matrix dimensions must be positive");
+    }
+}
+
+template <typename T>
+T& BasicMatrix<T>::operator()(size_t i, size_t j) {
     if (i >= rows_ || j >= cols_) {
         throw std::out_of_range("Matrix indices out of range");
     }
-    return data_[index(i, j)];
+    return data()[index(i, j)];
 }
 
-double Matrix::operator()(size_t i, size_t j) const {
+template <typename T>
+T BasicMatrix<T>::operator()(size_t i, size_t j) const {
     if (i >= rows_ || j >= cols_) {
         throw std::out_of_range("Matrix indices out of range");
     }
-    return data_[index(i, j)];
+    return data()[index(i, j)];
 }
 
-Matrix Matrix::operator+(const Matrix& other) const {
-    if (rows_ != other.rows_ || cols_ != other.cols_) {
-        throw std::invalid_argument("Matrix dimensions must match for addition");
+template <typename T>
+StridedSpan<T> BasicMatrix<T>::row(size_t i) {
+    if (i >= rows_) {
+        throw std::out_of_range("Matrix row index out of range");
+    }
+    return {data() + i * stride(), cols_};
+}
+
+template <typename T>
+StridedSpan<const T> BasicMatrix<T>::row(size_t i) const {
+    if (i >= rows_) {
+        throw std::out_of_range("Matrix row index out of range");
     }
+    return {data() + i * stride(), cols_};
+}
 
-    Matrix result(rows_, cols_);
-    for (size_t i = 0; i < data_.size(); ++i) {
-        result.data_[i] = data_[i] + other.data_[i];
+template <typename T>
+StridedSpan<T> BasicMatrix<T>::col(size_t j) {
+    if (j >= cols_) {
+        throw std::out_of_range("Matrix column index out of range");
     }
-    return result;
+    return {data() + j, rows_, stride()};
+}
+
+template <typename T>
+StridedSpan<const T> BasicMatrix<T>::col(size_t j) const {
+    if (j >= cols_) {
+        throw std::out_of_range("Matrix column index out of range");
+    }
+    return {data() + j, rows_, stride()};
 }
 
-Matrix Matrix::operator*(const Matrix& other) const {
+template <typename T>
+BasicMatrixView<T> BasicMatrix<T>::block(size_t i, size_t j, size_t rows,
+                                         size_t cols) {
+    return BasicMatrixView<T>(*this).block(i, j, rows, cols);
+}
+
+template <typename T>
+BasicMatrixView<const T> BasicMatrix<T>::block(size_t i, size_t j,
+                                               size_t rows,
+                                               size_t cols) const {
+    return BasicMatrixView<const T>(*this).block(i, j, rows, cols);
+}
+
+template <typename T>
+BasicMatrix<T> BasicMatrix<T>::operator*(const BasicMatrix& other) const {
     if (cols_ != other.rows_) {
         throw std::invalid_argument(
             "Matrix dimensions incompatible for multiplication");
     }
+    MATRIXOPS_INSTRUMENT(MULTIPLY, rows_ * other.cols_,
+                         detail::multiply_add_flops(data()) * rows_ *
+                             other.cols_ * cols_,
+                         (data_.size() + other.data_.size() +
+                          rows_ * other.cols_) *
+                             sizeof(T));
 
-    Matrix result(rows_, other.cols_, 0.0);
-    for (size_t i = 0; i < rows_; ++i) {
-        for (size_t j = 0; j < other.cols_; ++j) {
-            for (size_t k = 0; k < cols_; ++k) {
-                result(i, j) += (*this)(i, k) * other(k, j);
-            }
-        }
-    }
+    BasicMatrix result(rows_, other.cols_, UNINITIALIZED);
+    gemm(rows_, other.cols_, cols_, ComputeType<T>(1), data(), stride(),
+         other.data(), other.stride(), ComputeType<T>(0), result.data(),
+         result.stride());
     return result;
 }
 
-Matrix Matrix::operator*(double scalar) const {
-    Matrix result(rows_, cols_);
-    for (size_t i = 0; i < data_.size(); ++i) {
-        result.data_[i] = data_[i] * scalar;
+template <typename T>
+BasicMatrix<T>& BasicMatrix<T>::operator+=(const BasicMatrix& other) {
+    if (rows_ != other.rows_ || cols_ != other.cols_) {
+        throw std::invalid_argument(
+            "Matrix dimensions must match for addition");
     }
+    MATRIXOPS_INSTRUMENT(ADD, data_.size(), data_.size(),
+                         3 * data_.size() * sizeof(T));
+    add_arrays(data(), other.data(), data(), data_.size());
+    return *this;
+}
+
+template <typename T>
+BasicMatrix<T>& BasicMatrix<T>::operator*=(T scalar) {
+    MATRIXOPS_INSTRUMENT(SCALE, data_.size(), data_.size(),
+                         2 * data_.size() * sizeof(T));
+    scale_array(data(), scalar, data(), data_.size());
+    return *this;
+}
+
+template <typename T>
+void BasicMatrix<T>::assign(const MatrixSum<BasicMatrix, BasicMatrix>& expr) {
+    MATRIXOPS_INSTRUMENT(ADD, data_.size(), data_.size(),
+                         3 * data_.size() * sizeof(T));
+    add_arrays(expr.lhs().data(), expr.rhs().data(), data(), data_.size());
+}
+
+template <typename T>
+void BasicMatrix<T>::assign(const MatrixScaled<BasicMatrix>& expr) {
+    MATRIXOPS_INSTRUMENT(SCALE, data_.size(), data_.size(),
+                         2 * data_.size() * sizeof(T));
+    scale_array(expr.expression().data(), expr.scalar(), data(),
+                data_.size());
+}
+
+template <typename T>
+BasicMatrix<T> BasicMatrix<T>::transpose() const {
+    MATRIXOPS_INSTRUMENT(TRANSPOSE, data_.size(), 0,
+                         2 * data_.size() * sizeof(T));
+    BasicMatrix result(cols_, rows_, UNINITIALIZED);
+    detail::transpose(rows_, cols_, data(), stride(), result.data(),
+                      result.stride());
     return result;
 }
 
-Matrix Matrix::transpose() const {
-    Matrix result(cols_, rows_);
-    for (size_t i = 0; i < rows_; ++i) {
-        for (size_t j = 0; j < cols_; ++j) {
-            result(j, i) = (*this)(i, j);
-        }
+template <typename T>
+BasicMatrix<T>& BasicMatrix<T>::transpose_inplace() {
+    if (!is_square()) {
+        throw std::invalid_argument(
+            "In-place transpose requires a square matrix");
     }
-    return result;
+    MATRIXOPS_INSTRUMENT(TRANSPOSE, data_.size(), 0,
+                         2 * data_.size() * sizeof(T));
+    detail::transpose_inplace(rows_, data(), stride());
+    return *this;
 }
 
-double Matrix::norm() const {
-    double sum = 0.0;
-    for (double val : data_) {
-        sum += val * val;
+template <typename T>
+typename BasicMatrix<T>::real_type BasicMatrix<T>::norm() const {
+    MATRIXOPS_INSTRUMENT(NORM, data_.size(), 2 * data_.size(),
+                         data_.size() * sizeof(T));
+    return static_cast<real_type>(
+        detail::euclidean_norm(data(), data_.size()));
+}
+
+template <typename T>
+void add_into(const BasicMatrix<T>& a, const BasicMatrix<T>& b,
+              BasicMatrix<T>& out) {
+    if (a.rows() != b.rows() || a.cols() != b.cols() ||
+        out.rows() != a.rows() || out.cols() != a.cols()) {
+        throw std::invalid_argument(
+            "Matrix dimensions must match for addition");
     }
-    return std::sqrt(sum);
+    MATRIXOPS_INSTRUMENT(ADD, out.rows() * out.cols(),
+                         out.rows() * out.cols(),
+                         3 * out.rows() * out.cols() * sizeof(T));
+    add_arrays(a.data(), b.data(), out.data(), out.rows() * out.cols());
+}
+
+template <typename T>
+void multiply_into(const BasicMatrix<T>& a, const BasicMatrix<T>& b,
+                   BasicMatrix<T>& out) {
+    if (a.cols() != b.rows() || out.rows() != a.rows() ||
+        out.cols() != b.cols()) {
+        throw std::invalid_argument(
+            "Matrix dimensions incompatible for multiplication");
+    }
+    if (&out == &a || &out == &b) {
+        throw std::invalid_argument(
+            "Matrix multiplication output must not alias an operand");
+    }
+    MATRIXOPS_INSTRUMENT(MULTIPLY, out.rows() * out.cols(),
+                         detail::multiply_add_flops(a.data()) * out.rows() *
+                             out.cols() * a.cols(),
+                         (a.rows() * a.cols() + b.rows() * b.cols() +
+                          out.rows() * out.cols()) *
+                             sizeof(T));
+    gemm(a.rows(), b.cols(), a.cols(), ComputeType<T>(1), a.data(),
+         a.stride(), b.data(), b.stride(), ComputeType<T>(0), out.data(),
+         out.stride());
+}
+
+namespace {
+
+template <typename T>
+void multiply_widening(const BasicMatrix<T>& a, const BasicMatrix<T>& b,
+                       BasicMatrix<float>& out) {
+    if (a.cols() != b.rows() || out.rows() != a.rows() ||
+        out.cols() != b.cols()) {
+        throw std::invalid_argument(
+            "Matrix dimensions incompatible for multiplication");
+    }
+    MATRIXOPS_INSTRUMENT(MULTIPLY, out.rows() * out.cols(),
+                         2.0 * out.rows() * out.cols() * a.cols(),
+                         (a.rows() * a.cols() + b.rows() * b.cols()) *
+                                 sizeof(T) +
+                             out.rows() * out.cols() * sizeof(float));
+    gemm(a.rows(), b.cols(), a.cols(), 1.0F, a.data(), a.stride(), b.data(),
+         b.stride(), 0.0F, out.data(), out.stride());
 }
 
-Matrix identity(size_t n) {
-    Matrix result(n, n, 0.0);
+} // namespace
+
+void multiply_into(const BasicMatrix<Half>& a, const BasicMatrix<Half>& b,
+                   BasicMatrix<float>& out) {
+    multiply_widening(a, b, out);
+}
+
+void multiply_into(const BasicMatrix<BFloat16>& a,
+                   const BasicMatrix<BFloat16>& b, BasicMatrix<float>& out) {
+    multiply_widening(a, b, out);
+}
+
+template <typename T>
+BasicMatrix<T> identity(size_t n) {
+    BasicMatrix<T> result(n, n, T(0));
+    T* diagonal = result.data();
     for (size_t i = 0; i < n; ++i) {
-        result(i, i) = 1.0;
+        diagonal[i * (n + 1)] = T(1);
     }
     return result;
 }
 
+#define MATRIXOPS_INSTANTIATE_MATRIX(T)                                        \
+    template class BasicMatrix<T>;                                             \
+    template void add_into(const BasicMatrix<T>&, const BasicMatrix<T>&,      \
+                           BasicMatrix<T>&);                                   \
+    template void multiply_into(const BasicMatrix<T>&, const BasicMatrix<T>&, \
+                                BasicMatrix<T>&);                              \
+    template BasicMatrix<T> identity<T>(size_t);                               \
+    template double detail::sum_squares(const T*, size_t);                     \
+    template double detail::euclidean_norm(const T*, size_t);
+
+MATRIXOPS_INSTANTIATE_MATRIX(float)
+MATRIXOPS_INSTANTIATE_MATRIX(double)
+MATRIXOPS_INSTANTIATE_MATRIX(std::complex<float>)
+MATRIXOPS_INSTANTIATE_MATRIX(std::complex<double>)
+MATRIXOPS_INSTANTIATE_MATRIX(Half)
+MATRIXOPS_INSTANTIATE_MATRIX(BFloat16)
+
+#undef MATRIXOPS_INSTANTIATE_MATRIX
+
 } // namespace matrixops
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <complex>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <type_traits>
+
+#include "matrixops/half.h"
+#include "matrixops/io.h"
+
+namespace matrixops {
+namespace detail {
+
+// Layout of the header documented at MATRIX_FILE_VERSION.
+struct MatrixFileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t byte_order;
+    uint32_t element_type;
+    uint32_t element_size;
+    uint64_t rows;
+    uint64_t cols;
+    uint64_t data_offset;
+    uint64_t data_bytes;
+    uint64_t reserved;
+};
+
+constexpr size_t MATRIX_FILE_HEADER_SIZE = 64;
+
+static_assert(sizeof(MatrixFileHeader) == MATRIX_FILE_HEADER_SIZE,
+              "The matrix file header must be 64 bytes");
+
+template <typename T>
+constexpr ElementType element_type_of() {
+    if constexpr (std::is_same_v<T, float>) {
+        return ElementType::FLOAT32;
+    } else if constexpr (std::is_same_v<T, double>) {
+        return ElementType::FLOAT64;
+    } else if constexpr (std::is_same_v<T, std::complex<float>>) {
+        return ElementType::COMPLEX64;
+    } else if constexpr (std::is_same_v<T, std::complex<double>>) {
+        return ElementType::COMPLEX128;
+    } else if constexpr (std::is_same_v<T, Half>) {
+        return ElementType::FLOAT16;
+    } else {
+        static_assert(std::is_same_v<T, BFloat16>,
+                      "Unsupported matrix file element type");
+        return ElementType::BFLOAT16;
+    }
+}
+
+/**
+ * @brief Throw std::runtime_error naming the file and the reason
+ */
+[[noreturn]] void matrix_file_error(const std::string& path,
+                                    const char* reason);
+
+/**
+ * @brief Header of a new file of rows x cols elements of type, with the
+ * data right after the header
+ */
+MatrixFileHeader make_matrix_file_header(ElementType type, size_t rows,
+                                         size_t cols);
+
+/**
+ * @brief Check a header read from a file of file_size bytes
+ * @throws std::runtime_error as read_matrix_file_info()
+ */
+MatrixFileInfo check_matrix_file_header(const MatrixFileHeader& header,
+                                        uint64_t file_size,
+                                        const std::string& path);
+
+/**
+ * @brief Check the header at the start of a mapped file
+ * @throws std::runtime_error as read_matrix_file_info()
+ */
+MatrixFileInfo mapped_matrix_file_info(const MappedFile& file,
+                                       const std::string& path);
+
+} // namespace detail
+} // namespace matrixops
@@ -0,0 +1,251 @@
+#include "matrixops/matrix.h"
+#include "matrixops/gemm.h"
+#include "matrixops/parallel.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#include "instrumentation.h"
+#include "kernels.h"
+#include "portable_kernels.h"
+#include "reduction.h"
+#include "transpose.h"
+
+namespace matrixops {
+
+using detail::ELEMENTWISE_GRAIN;
+
+namespace {
+
+// Rows per task, about elementwise_grain() elements.
+size_t row_grain(size_t cols) {
+    return std::max<size_t>(detail::elementwise_grain() / cols, 1);
+}
+
+template <typename T>
+void add_row(const T* a, const T* b, T* out, size_t n) {
+    if constexpr (detail::HAS_SIMD_KERNELS<T>) {
+        detail::typed_kernels<T>().add(a, b, out, n);
+    } else {
+        detail::add_scalar(a, b, out, n);
+    }
+}
+
+template <typename T>
+using ComputeType = typename detail::ScalarTraits<T>::compute_type;
+
+// Layout of a view with unit row or column stride, as gemm() reads it.
+// A single row or column counts as row-major.
+template <typename T>
+Layout layout(BasicMatrixView<const T> a) {
+    return a.col_stride() == 1 ? Layout::ROW_MAJOR : Layout::COLUMN_MAJOR;
+}
+
+template <typename T>
+size_t leading_dimension(BasicMatrixView<const T> a) {
+    return a.col_stride() == 1 ? a.stride() : a.col_stride();
+}
+
+} // namespace
+
+namespace detail {
+
+template <typename T>
+void copy_view(BasicMatrixView<const T> a, T* out, size_t ldo) {
+    if (a.col_stride() != 1 && a.stride() == 1) {
+        // A column-major view is the row-major transpose of its memory.
+        detail::transpose(a.cols(), a.rows(), a.data(), a.col_stride(), out,
+                          ldo);
+        return;
+    }
+    parallel_for(0, a.rows(), row_grain(a.cols()), [&](size_t lo,
+                                                        size_t hi) {
+        for (size_t i = lo; i < hi; ++i) {
+            T* row = out + i * ldo;
+            if (a.col_stride() == 1) {
+                const T* in = a.data() + i * a.stride();
+                std::copy(in, in + a.cols(), row);
+            } else {
+                for (size_t j = 0; j < a.cols(); ++j) {
+                    row[j] = a.unchecked(i, j);
+                }
+            }
+        }
+    });
+}
+
+template <typename T>
+void copy_views(BasicMatrixView<const T> src, BasicMatrixView<T> dst) {
+    if (src.rows() != dst.rows() || src.cols() != dst.cols()) {
+        throw std::invalid_argument(
+            "Matrix dimensions must match for assignment");
+    }
+    if (dst.col_stride() == 1) {
+        copy_view(src, dst.data(), dst.stride());
+    } else if (dst.stride() == 1) {
+        // Fill the rows of the transpose of a column-major destination.
+        copy_view(src.transposed(), dst.data(), dst.col_stride());
+    } else {
+        parallel_for(0, dst.rows(), row_grain(dst.cols()), [&](size_t lo,
+                                                                size_t hi) {
+            for (size_t i = lo; i < hi; ++i) {
+                for (size_t j = 0; j < dst.cols(); ++j) {
+                    dst.unchecked(i, j) = src.unchecked(i, j);
+                }
+            }
+        });
+    }
+}
+
+template <typename T>
+void add_views(BasicMatrixView<const T> a, BasicMatrixView<const T> b,
+               T* out, size_t ldo) {
+    if (a.rows() != b.rows() || a.cols() != b.cols()) {
+        throw std::invalid_argument(
+            "Matrix dimensions must match for addition");
+    }
+    MATRIXOPS_INSTRUMENT(ADD, a.rows() * a.cols(), a.rows() * a.cols(),
+                         3 * a.rows() * a.cols() * sizeof(T));
+    const bool unit = a.col_stride() == 1 && b.col_stride() == 1;
+    if (unit && a.is_contiguous() && b.is_contiguous() &&
+        ldo == a.cols()) {
+        // One flat run, split as add_into() splits it.
+        const size_t n = a.rows() * a.cols();
+        parallel_for(0, n, detail::elementwise_grain(), [&](size_t lo,
+                                                             size_t hi) {
+            add_row(a.data() + lo, b.data() + lo, out + lo, hi - lo);
+        });
+        return;
+    }
+    parallel_for(0, a.rows(), row_grain(a.cols()), [&](size_t lo,
+                                                        size_t hi) {
+        for (size_t i = lo; i < hi; ++i) {
+            T* row = out + i * ldo;
+            if (unit) {
+                add_row(a.data() + i * a.stride(), b.data() + i * b.stride(),
+                        row, a.cols());
+            } else {
+                for (size_t j = 0; j < a.cols(); ++j) {
+                    row[j] = a.unchecked(i, j) + b.unchecked(i, j);
+                }
+            }
+        }
+    });
+}
+
+template <typename T>
+BasicMatrix<T> multiply_views(BasicMatrixView<const T> a,
+                              BasicMatrixView<const T> b) {
+    if (a.cols() != b.rows()) {
+        throw std::invalid_argument(
+            "Matrix dimensions incompatible for multiplication");
+    }
+    MATRIXOPS_INSTRUMENT(MULTIPLY, a.rows() * b.cols(),
+                         detail::multiply_add_flops(a.data()) * a.rows() *
+                             b.cols() * a.cols(),
+                         (a.rows() * a.cols() + b.rows() * b.cols() +
+                          a.rows() * b.cols()) *
+                             sizeof(T));
+    // gemm() reads row-major and column-major operands, such as
+    // transposed views, in place; views strided both ways are packed
+    // first.
+    if (a.col_stride() != 1 && a.stride() != 1) {
+        const BasicMatrix<T> packed(a);
+        return multiply_views<T>(packed, b);
+    }
+    if (b.col_stride() != 1 && b.stride() != 1) {
+        const BasicMatrix<T> packed(b);
+        return multiply_views<T>(a, packed);
+    }
+    BasicMatrix<T> result(a.rows(), b.cols(), UNINITIALIZED);
+    gemm(a.rows(), b.cols(), a.cols(), ComputeType<T>(1), a.data(),
+         leading_dimension(a), b.data(), leading_dimension(b),
+         ComputeType<T>(0), result.data(), result.stride(), layout(a),
+         layout(b));
+    return result;
+}
+
+} // namespace detail
+
+template <typename T>
+BasicMatrix<typename BasicMatrixView<T>::value_type>
+BasicMatrixView<T>::transpose() const {
+    MATRIXOPS_INSTRUMENT(TRANSPOSE, rows_ * cols_, 0,
+                         2 * rows_ * cols_ * sizeof(value_type));
+    BasicMatrix<value_type> result(cols_, rows_, UNINITIALIZED);
+    if (col_stride_ == 1) {
+        detail::transpose(rows_, cols_, data_, stride_, result.data(),
+                          result.stride());
+    } else {
+        // The rows of the transpose are the columns of this view.
+        detail::copy_view<value_type>(transposed(), result.data(),
+                                      result.stride());
+    }
+    return result;
+}
+
+template <typename T>
+typename BasicMatrixView<T>::real_type BasicMatrixView<T>::norm() const {
+    MATRIXOPS_INSTRUMENT(NORM, rows_ * cols_, 2 * rows_ * cols_,
+                         rows_ * cols_ * sizeof(value_type));
+    if (is_contiguous()) {
+        return static_cast<real_type>(
+            detail::euclidean_norm(data_, rows_ * cols_));
+    }
+    // A packed copy also keeps the reproducible modes to the same bits as
+    // the norm of a matrix.
+    if (col_stride_ != 1 || reduction_mode() != ReductionMode::FAST) {
+        return BasicMatrix<value_type>(*this).norm();
+    }
+    // Row sums in fixed blocks of rows, added in order, so the result does
+    // not depend on the thread count or the tuning.
+    const size_t grain = std::max<size_t>(ELEMENTWISE_GRAIN / cols_, 1);
+    const size_t blocks = (rows_ + grain - 1) / grain;
+    std::vector<double> partial(blocks);
+    parallel_for(0, blocks, 1, [&](size_t lo, size_t hi) {
+        for (size_t block = lo; block < hi; ++block) {
+            double sum = 0.0;
+            const size_t last = std::min(rows_, (block + 1) * grain);
+            for (size_t i = block * grain; i < last; ++i) {
+                sum += detail::sum_squares(data_ + i * stride_, cols_);
+            }
+            partial[block] = sum;
+        }
+    });
+    double sum = 0.0;
+    for (double p : partial) {
+        sum += p;
+    }
+    // Outside the safe range of the plain sum, euclidean_norm() rescales
+    // a packed copy.
+    if (!std::isnan(sum) &&
+        !(sum >= std::numeric_limits<double>::min() /
+                     std::numeric_limits<double>::epsilon() &&
+          sum <= std::numeric_limits<double>::max())) {
+        return BasicMatrix<value_type>(*this).norm();
+    }
+    return static_cast<real_type>(std::sqrt(sum));
+}
+
+#define MATRIXOPS_INSTANTIATE_MATRIX_VIEW(T)                                   \
+    template class BasicMatrixView<T>;                                         \
+    template class BasicMatrixView<const T>;                                   \
+    template void detail::copy_view(BasicMatrixView<const T>, T*, size_t);     \
+    template void detail::copy_views(BasicMatrixView<const T>,                 \
+                                     BasicMatrixView<T>);                      \
+    template void detail::add_views(BasicMatrixView<const T>,                  \
+                                    BasicMatrixView<const T>, T*, size_t);     \
+    template BasicMatrix<T> detail::multiply_views(BasicMatrixView<const T>,   \
+                                                   BasicMatrixView<const T>);
+
+MATRIXOPS_INSTANTIATE_MATRIX_VIEW(float)
+MATRIXOPS_INSTANTIATE_MATRIX_VIEW(double)
+MATRIXOPS_INSTANTIATE_MATRIX_VIEW(std::complex<float>)
+MATRIXOPS_INSTANTIATE_MATRIX_VIEW(std::complex<double>)
+MATRIXOPS_INSTANTIATE_MATRIX_VIEW(Half)
+MATRIXOPS_INSTANTIATE_MATRIX_VIEW(BFloat16)
+
+#undef MATRIXOPS_INSTANTIATE_MATRIX_VIEW
+
+} // namespace matrixops
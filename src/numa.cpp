@@ -0,0 +1,277 @@
+#include "matrixops/numa.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "env.h"
+#include "numa.h"
+#include "thread_pool.h"
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace matrixops {
+
+namespace {
+
+// Usable nodes and, for each, the cores of the process affinity mask on
+// it, in the order the OS lists them: physical cores before their SMT
+// siblings on the usual numberings.
+struct Topology {
+    std::vector<int> nodes;
+    std::vector<std::vector<int>> cpus;
+};
+
+#if defined(__linux__)
+
+std::string read_first_line(const std::string& path) {
+    std::ifstream in(path);
+    std::string line;
+    std::getline(in, line);
+    return line;
+}
+
+// Parses the "0-3,8,10-11" lists of sysfs; stops at the first malformed
+// entry.
+std::vector<int> parse_list(const std::string& text) {
+    std::vector<int> values;
+    size_t pos = 0;
+    while (pos < text.size()) {
+        char* end = nullptr;
+        const long first = std::strtol(text.c_str() + pos, &end, 10);
+        if (end == text.c_str() + pos || first < 0) {
+            break;
+        }
+        long last = first;
+        if (*end == '-') {
+            const char* start = end + 1;
+            last = std::strtol(start, &end, 10);
+            if (end == start || last < first) {
+                break;
+            }
+        }
+        for (long v = first; v <= last; ++v) {
+            values.push_back(static_cast<int>(v));
+        }
+        pos = static_cast<size_t>(end - text.c_str());
+        if (pos >= text.size() || text[pos] != ',') {
+            break;
+        }
+        ++pos;
+    }
+    return values;
+}
+
+Topology detect_topology() {
+    Topology topology;
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+    const bool masked = sched_getaffinity(0, sizeof(allowed), &allowed) == 0;
+    const auto usable = [&](int cpu) {
+        return !masked || (cpu < CPU_SETSIZE && CPU_ISSET(cpu, &allowed));
+    };
+
+    const std::string root = "/sys/devices/system/node/";
+    for (int node : parse_list(read_first_line(root + "online"))) {
+        std::vector<int> cpus = parse_list(read_first_line(
+            root + "node" + std::to_string(node) + "/cpulist"));
+        cpus.erase(std::remove_if(cpus.begin(), cpus.end(),
+                                  [&](int cpu) { return !usable(cpu); }),
+                   cpus.end());
+        // Memory-only nodes and nodes outside the mask have no cores to
+        // pin to, and are not counted.
+        if (!cpus.empty()) {
+            topology.nodes.push_back(node);
+            topology.cpus.push_back(std::move(cpus));
+        }
+    }
+    if (topology.nodes.empty()) {
+        std::vector<int> cpus;
+        for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+            if (masked && CPU_ISSET(cpu, &allowed)) {
+                cpus.push_back(cpu);
+            }
+        }
+        topology.nodes.push_back(0);
+        topology.cpus.push_back(std::move(cpus));
+    }
+    return topology;
+}
+
+#else
+
+Topology detect_topology() {
+    Topology topology;
+    topology.nodes.push_back(0);
+    topology.cpus.emplace_back();
+    return topology;
+}
+
+#endif
+
+const Topology& topology() {
+    static const Topology detected = detect_topology();
+    return detected;
+}
+
+// Settings from the environment; unknown values keep the defaults.
+NumaSettings default_settings() {
+    NumaSettings settings;
+    const std::string policy = detail::get_env("MATRIXOPS_NUMA");
+    if (policy == "interleave") {
+        settings.policy = NumaPolicy::INTERLEAVE;
+    } else if (policy.compare(0, 5, "bind:") == 0 && policy.size() > 5) {
+        char* end = nullptr;
+        const unsigned long long node =
+            std::strtoull(policy.c_str() + 5, &end, 10);
+        if (end != nullptr && *end == '\0' && node < numa_nodes()) {
+            settings.policy = NumaPolicy::BIND;
+            settings.node = static_cast<size_t>(node);
+        }
+    }
+    settings.pin_threads = detail::get_env("MATRIXOPS_PIN_THREADS") == "1";
+    return settings;
+}
+
+struct SettingsState {
+    std::atomic<NumaPolicy> policy;
+    std::atomic<size_t> node;
+    std::atomic<bool> pin_threads;
+
+    explicit SettingsState(const NumaSettings& settings)
+        : policy(settings.policy), node(settings.node),
+          pin_threads(settings.pin_threads) {}
+};
+
+SettingsState& settings_state() {
+    static SettingsState state(default_settings());
+    return state;
+}
+
+} // namespace
+
+size_t numa_nodes() { return topology().nodes.size(); }
+
+NumaSettings numa_settings() {
+    const SettingsState& state = settings_state();
+    NumaSettings settings;
+    settings.policy = state.policy.load(std::memory_order_relaxed);
+    settings.node = state.node.load(std::memory_order_relaxed);
+    settings.pin_threads = state.pin_threads.load(std::memory_order_relaxed);
+    return settings;
+}
+
+void set_numa_settings(const NumaSettings& settings) {
+    if (settings.policy == NumaPolicy::BIND && settings.node >= numa_nodes()) {
+        throw std::invalid_argument("NUMA node " +
+                                    std::to_string(settings.node) +
+                                    " does not exist");
+    }
+    SettingsState& state = settings_state();
+    state.node.store(settings.node, std::memory_order_relaxed);
+    state.policy.store(settings.policy, std::memory_order_relaxed);
+    if (state.pin_threads.exchange(settings.pin_threads) !=
+        settings.pin_threads) {
+        detail::restart_thread_pool();
+    }
+}
+
+const char* numa_policy_name(NumaPolicy policy) {
+    switch (policy) {
+    case NumaPolicy::FIRST_TOUCH:
+        return "first-touch";
+    case NumaPolicy::INTERLEAVE:
+        return "interleave";
+    case NumaPolicy::BIND:
+        return "bind";
+    }
+    return "unknown";
+}
+
+namespace detail {
+
+bool pin_threads() {
+    return settings_state().pin_threads.load(std::memory_order_relaxed);
+}
+
+void pin_to_slot(size_t slot, size_t threads) {
+#if defined(__linux__)
+    const Topology& t = topology();
+    size_t total = 0;
+    for (const std::vector<int>& cpus : t.cpus) {
+        total += cpus.size();
+    }
+    if (total == 0 || threads == 0) {
+        return;
+    }
+    // Slot s goes to the node holding core s * total / threads of the
+    // node-by-node core list, and within it to the next core in order, so
+    // that slots fill each node's physical cores before its siblings.
+    size_t before = 0;
+    size_t node = 0;
+    while (node + 1 < t.cpus.size() &&
+           (before + t.cpus[node].size()) * threads <= slot * total) {
+        before += t.cpus[node].size();
+        ++node;
+    }
+    const size_t first_slot = (before * threads + total - 1) / total;
+    const std::vector<int>& cpus = t.cpus[node];
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpus[(slot - first_slot) % cpus.size()], &set);
+    pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+#else
+    (void)slot;
+    (void)threads;
+#endif
+}
+
+void place_pages(void* p, size_t bytes) {
+#if defined(__linux__) && defined(SYS_mbind)
+    const NumaSettings settings = numa_settings();
+    if (settings.policy == NumaPolicy::FIRST_TOUCH) {
+        return;
+    }
+    // Values of <linux/mempolicy.h>, which not every toolchain ships.
+    constexpr int MPOL_BIND_MODE = 2;
+    constexpr int MPOL_INTERLEAVE_MODE = 3;
+    constexpr size_t WORD_BITS = 8 * sizeof(unsigned long);
+
+    const Topology& t = topology();
+    const int max_node = *std::max_element(t.nodes.begin(), t.nodes.end());
+    std::vector<unsigned long> mask(static_cast<size_t>(max_node) /
+                                        WORD_BITS + 1);
+    const auto add = [&](int node) {
+        mask[static_cast<size_t>(node) / WORD_BITS] |=
+            1UL << (static_cast<size_t>(node) % WORD_BITS);
+    };
+    int mode = MPOL_INTERLEAVE_MODE;
+    if (settings.policy == NumaPolicy::BIND) {
+        mode = MPOL_BIND_MODE;
+        add(t.nodes[std::min(settings.node, t.nodes.size() - 1)]);
+    } else {
+        for (int node : t.nodes) {
+            add(node);
+        }
+    }
+    // Advisory, as for huge pages: on failure the pages stay first-touch.
+    // The kernel counts one bit less than maxnode.
+    syscall(SYS_mbind, p, bytes, mode, mask.data(),
+            mask.size() * WORD_BITS + 1, 0U);
+#else
+    (void)p;
+    (void)bytes;
+#endif
+}
+
+} // namespace detail
+} // namespace matrixops
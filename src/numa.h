@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstddef>
+
+namespace matrixops {
+namespace detail {
+
+/**
+ * @brief Check if pool workers are pinned, see NumaSettings::pin_threads
+ */
+bool pin_threads();
+
+/**
+ * @brief Pin the calling thread to the core of pool slot `slot` out of
+ * `threads`, slot 0 being the caller of parallel operations
+ *
+ * Slots are spread over the nodes in contiguous groups, in proportion to
+ * the cores the process may use on each. Does nothing if the OS refuses.
+ */
+void pin_to_slot(size_t slot, size_t threads);
+
+/**
+ * @brief Apply the NUMA policy to a fresh, page-aligned heap block
+ *
+ * Only called for blocks aligned to a huge page; does nothing under
+ * FIRST_TOUCH, or if the OS refuses.
+ */
+void place_pages(void* p, size_t bytes);
+
+} // namespace detail
+} // namespace matrixops
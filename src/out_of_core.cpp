@@ -0,0 +1,453 @@
+#include "matrixops/out_of_core.h"
+
+#include "matrixops/gemm.h"
+#include "matrixops/io.h"
+#include "matrixops/matrix.h"
+#include "matrixops/parallel.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <complex>
+#include <filesystem>
+#include <fstream>
+#include <future>
+#include <stdexcept>
+#include <vector>
+
+#include "kernels.h"
+#include "matrix_file.h"
+#include "portable_kernels.h"
+#include "transpose.h"
+
+namespace matrixops {
+
+namespace {
+
+std::atomic<size_t> budget_bytes{size_t{1} << 30};
+
+// Tile edges are rounded down to a multiple of this.
+constexpr size_t TILE_MULTIPLE = 16;
+
+template <typename T>
+using Accumulator = typename detail::ScalarTraits<T>::compute_type;
+
+template <typename T>
+struct TypeTag {
+    using type = T;
+};
+
+// Call f(TypeTag<T>()) for the element type of a file.
+template <typename F>
+void dispatch(ElementType type, F&& f) {
+    switch (type) {
+    case ElementType::FLOAT32:
+        f(TypeTag<float>());
+        return;
+    case ElementType::FLOAT64:
+        f(TypeTag<double>());
+        return;
+    case ElementType::COMPLEX64:
+        f(TypeTag<std::complex<float>>());
+        return;
+    case ElementType::COMPLEX128:
+        f(TypeTag<std::complex<double>>());
+        return;
+    case ElementType::FLOAT16:
+        f(TypeTag<Half>());
+        return;
+    case ElementType::BFLOAT16:
+        f(TypeTag<BFloat16>());
+        return;
+    }
+}
+
+// A mapped input and its checked header.
+struct InputFile {
+    detail::MappedFile file;
+    MatrixFileInfo info;
+
+    explicit InputFile(const std::string& path)
+        : file(path), info(detail::mapped_matrix_file_info(file, path)) {}
+
+    template <typename T>
+    const T* data() const {
+        return reinterpret_cast<const T*>(file.data() + info.data_offset);
+    }
+};
+
+// A new matrix file of the full size, written block by block.
+template <typename T>
+class OutputFile {
+public:
+    OutputFile(const std::string& path, size_t rows, size_t cols)
+        : path_(path), cols_(cols) {
+        const detail::MatrixFileHeader header =
+            detail::make_matrix_file_header(detail::element_type_of<T>(),
+                                            rows, cols);
+        {
+            std::ofstream create(path, std::ios::binary | std::ios::trunc);
+            create.write(reinterpret_cast<const char*>(&header),
+                         sizeof(header));
+            if (!create) {
+                detail::matrix_file_error(path, "cannot open for writing");
+            }
+        }
+        offset_ = header.data_offset;
+        std::error_code error;
+        std::filesystem::resize_file(path, offset_ + header.data_bytes,
+                                     error);
+        out_.open(path, std::ios::binary | std::ios::in | std::ios::out);
+        if (error || !out_) {
+            detail::matrix_file_error(path, "cannot open for writing");
+        }
+    }
+
+    // Write the rows x cols block src, with leading dimension lds, at
+    // (row, col), rounding accumulators back to T.
+    template <typename S>
+    void write_block(size_t row, size_t col, size_t rows, size_t cols,
+                     const S* src, size_t lds) {
+        std::vector<T> converted;
+        for (size_t i = 0; i < rows; ++i) {
+            const S* line = src + i * lds;
+            const T* bytes;
+            if constexpr (std::is_same_v<S, T>) {
+                bytes = line;
+            } else {
+                converted.resize(cols);
+                for (size_t j = 0; j < cols; ++j) {
+                    converted[j] = static_cast<T>(line[j]);
+                }
+                bytes = converted.data();
+            }
+            out_.seekp(static_cast<std::streamoff>(
+                offset_ + ((row + i) * cols_ + col) * sizeof(T)));
+            out_.write(reinterpret_cast<const char*>(bytes),
+                       static_cast<std::streamsize>(cols * sizeof(T)));
+        }
+        if (!out_) {
+            detail::matrix_file_error(path_, "write failed");
+        }
+    }
+
+    void close() {
+        out_.close();
+        if (!out_) {
+            detail::matrix_file_error(path_, "write failed");
+        }
+    }
+
+private:
+    std::string path_;
+    size_t cols_;
+    size_t offset_ = 0;
+    std::fstream out_;
+};
+
+// One write in flight on a background thread; submitting waits for the
+// previous one, so the writes never overlap each other.
+class AsyncWriter {
+public:
+    template <typename F>
+    void submit(F&& write) {
+        wait();
+        pending_ = std::async(std::launch::async, std::forward<F>(write));
+    }
+
+    void wait() {
+        if (pending_.valid()) {
+            pending_.get();
+        }
+    }
+
+private:
+    std::future<void> pending_;
+};
+
+// Run count steps with load(s, slot) on a background thread one step
+// ahead of compute(s, slot) on the calling thread; the two buffer slots
+// alternate.
+template <typename Load, typename Compute>
+void pipeline(size_t count, Load load, Compute compute) {
+    std::future<void> next =
+        std::async(std::launch::async, [&] { load(0, 0); });
+    for (size_t s = 0; s < count; ++s) {
+        next.get();
+        if (s + 1 < count) {
+            next = std::async(std::launch::async,
+                              [&load, s] { load(s + 1, (s + 1) % 2); });
+        }
+        compute(s, s % 2);
+    }
+}
+
+// Largest square tile edge with bytes_per_element of buffers per element
+// of a tile inside the budget, and no larger than needed.
+size_t tile_edge(size_t bytes_per_element, size_t largest_dim) {
+    const double elements = static_cast<double>(out_of_core_budget()) /
+                            static_cast<double>(bytes_per_element);
+    size_t edge = static_cast<size_t>(std::sqrt(elements));
+    edge = std::max(edge / TILE_MULTIPLE * TILE_MULTIPLE, TILE_MULTIPLE);
+    return std::min(edge, largest_dim);
+}
+
+size_t tiles(size_t n, size_t edge) {
+    return (n + edge - 1) / edge;
+}
+
+// Copy the rows x cols block at (row, col) of a row-major matrix with ld
+// columns into dst, packed.
+template <typename T>
+void read_block(const T* src, size_t ld, size_t row, size_t col,
+                size_t rows, size_t cols, T* dst) {
+    for (size_t i = 0; i < rows; ++i) {
+        const T* line = src + (row + i) * ld + col;
+        std::copy(line, line + cols, dst + i * cols);
+    }
+}
+
+template <typename T>
+void add_block(const T* a, const T* b, T* out, size_t n) {
+    if constexpr (detail::HAS_SIMD_KERNELS<T>) {
+        detail::typed_kernels<T>().add(a, b, out, n);
+    } else {
+        detail::add_scalar(a, b, out, n);
+    }
+}
+
+void check_types(const InputFile& a, const InputFile& b) {
+    if (a.info.element_type != b.info.element_type) {
+        throw std::invalid_argument(
+            "Matrix files must have the same element type");
+    }
+}
+
+void check_distinct(const std::string& out, const std::string& in) {
+    std::error_code error;
+    if (std::filesystem::equivalent(out, in, error)) {
+        throw std::invalid_argument(
+            "Out-of-core output must not be an input file");
+    }
+}
+
+template <typename T>
+void multiply_tiles(const InputFile& a, const InputFile& b,
+                    const std::string& path) {
+    using Acc = Accumulator<T>;
+    const size_t m = a.info.rows;
+    const size_t k = a.info.cols;
+    const size_t n = b.info.cols;
+    // Two tiles each of A, B and the accumulated C.
+    const size_t edge =
+        tile_edge(4 * sizeof(T) + 2 * sizeof(Acc), std::max({m, n, k}));
+    const size_t mt = tiles(m, edge);
+    const size_t nt = tiles(n, edge);
+    const size_t kt = tiles(k, edge);
+    std::vector<T> a_tile[2];
+    std::vector<T> b_tile[2];
+    std::vector<Acc> c_tile[2];
+    for (size_t slot = 0; slot < 2; ++slot) {
+        a_tile[slot].resize(edge * edge);
+        b_tile[slot].resize(edge * edge);
+        c_tile[slot].resize(edge * edge);
+    }
+    OutputFile<T> out(path, m, n);
+    AsyncWriter writer;
+
+    // Step s is tile (i, j) of C and tile p of the sum, p innermost.
+    struct Step {
+        size_t i, j, p, rows, cols, depth;
+    };
+    auto step = [&](size_t s) {
+        const size_t p = s % kt;
+        const size_t j = s / kt % nt;
+        const size_t i = s / (kt * nt);
+        return Step{i, j, p, std::min(edge, m - i * edge),
+                    std::min(edge, n - j * edge), std::min(edge, k - p * edge)};
+    };
+    pipeline(
+        mt * nt * kt,
+        [&](size_t s, size_t slot) {
+            const Step t = step(s);
+            read_block(a.data<T>(), k, t.i * edge, t.p * edge, t.rows,
+                       t.depth, a_tile[slot].data());
+            read_block(b.data<T>(), n, t.p * edge, t.j * edge, t.depth,
+                       t.cols, b_tile[slot].data());
+        },
+        [&](size_t s, size_t slot) {
+            const Step t = step(s);
+            // C tiles alternate per (i, j): submitting the previous tile
+            // waited for the write of the one before, the last user of
+            // this slot.
+            std::vector<Acc>& c = c_tile[s / kt % 2];
+            gemm(t.rows, t.cols, t.depth, Acc(1), a_tile[slot].data(),
+                 t.depth, b_tile[slot].data(), t.cols,
+                 t.p == 0 ? Acc(0) : Acc(1), c.data(), t.cols);
+            if (t.p + 1 == kt) {
+                writer.submit([&out, &c, t, edge] {
+                    out.write_block(t.i * edge, t.j * edge, t.rows, t.cols,
+                                    c.data(), t.cols);
+                });
+            }
+        });
+    writer.wait();
+    out.close();
+}
+
+template <typename T>
+void transpose_tiles(const InputFile& a, const std::string& path) {
+    const size_t rows = a.info.rows;
+    const size_t cols = a.info.cols;
+    // Two tiles each of the input and the transposed output.
+    const size_t edge = tile_edge(4 * sizeof(T), std::max(rows, cols));
+    const size_t rt = tiles(rows, edge);
+    const size_t ct = tiles(cols, edge);
+    std::vector<T> in_tile[2];
+    std::vector<T> out_tile[2];
+    for (size_t slot = 0; slot < 2; ++slot) {
+        in_tile[slot].resize(edge * edge);
+        out_tile[slot].resize(edge * edge);
+    }
+    OutputFile<T> out(path, cols, rows);
+    AsyncWriter writer;
+
+    auto origin = [&](size_t s, size_t& i, size_t& j, size_t& h,
+                      size_t& w) {
+        i = s / ct * edge;
+        j = s % ct * edge;
+        h = std::min(edge, rows - i);
+        w = std::min(edge, cols - j);
+    };
+    pipeline(
+        rt * ct,
+        [&](size_t s, size_t slot) {
+            size_t i, j, h, w;
+            origin(s, i, j, h, w);
+            read_block(a.data<T>(), cols, i, j, h, w, in_tile[slot].data());
+        },
+        [&](size_t s, size_t slot) {
+            size_t i, j, h, w;
+            origin(s, i, j, h, w);
+            // submit() below waited for the write of two steps ago, the
+            // last user of this output slot.
+            detail::transpose(h, w, in_tile[slot].data(), w,
+                              out_tile[slot].data(), h);
+            const T* tile = out_tile[slot].data();
+            writer.submit([&out, tile, i, j, h, w] {
+                out.write_block(j, i, w, h, tile, h);
+            });
+        });
+    writer.wait();
+    out.close();
+}
+
+template <typename T>
+void add_chunks(const InputFile& a, const InputFile& b,
+                const std::string& path) {
+    const size_t rows = a.info.rows;
+    const size_t cols = a.info.cols;
+    const size_t total = rows * cols;
+    // Two chunks each of a, b and the sum, whole rows where possible.
+    size_t chunk = std::max<size_t>(out_of_core_budget() / (6 * sizeof(T)),
+                                    1);
+    if (chunk >= cols) {
+        chunk = chunk / cols * cols;
+    }
+    chunk = std::min(chunk, total);
+    std::vector<T> a_chunk[2];
+    std::vector<T> b_chunk[2];
+    std::vector<T> out_chunk[2];
+    for (size_t slot = 0; slot < 2; ++slot) {
+        a_chunk[slot].resize(chunk);
+        b_chunk[slot].resize(chunk);
+        out_chunk[slot].resize(chunk);
+    }
+    OutputFile<T> out(path, rows, cols);
+    AsyncWriter writer;
+
+    pipeline(
+        tiles(total, chunk),
+        [&](size_t s, size_t slot) {
+            const size_t lo = s * chunk;
+            const size_t n = std::min(chunk, total - lo);
+            std::copy(a.data<T>() + lo, a.data<T>() + lo + n,
+                      a_chunk[slot].data());
+            std::copy(b.data<T>() + lo, b.data<T>() + lo + n,
+                      b_chunk[slot].data());
+        },
+        [&](size_t s, size_t slot) {
+            const size_t lo = s * chunk;
+            const size_t n = std::min(chunk, total - lo);
+            const T* x = a_chunk[slot].data();
+            const T* y = b_chunk[slot].data();
+            T* sum = out_chunk[slot].data();
+            parallel_for(0, n, detail::ELEMENTWISE_GRAIN,
+                         [&](size_t first, size_t last) {
+                             add_block(x + first, y + first, sum + first,
+                                       last - first);
+                         });
+            // The file is written as one row of total elements.
+            writer.submit([&out, sum, lo, n] {
+                out.write_block(0, lo, 1, n, sum, n);
+            });
+        });
+    writer.wait();
+    out.close();
+}
+
+} // namespace
+
+size_t out_of_core_budget() {
+    return budget_bytes.load(std::memory_order_relaxed);
+}
+
+void set_out_of_core_budget(size_t bytes) {
+    if (bytes < MIN_OUT_OF_CORE_BUDGET) {
+        throw std::invalid_argument("Out-of-core budget must be at least "
+                                    "MIN_OUT_OF_CORE_BUDGET");
+    }
+    budget_bytes.store(bytes, std::memory_order_relaxed);
+}
+
+void multiply_files(const std::string& a, const std::string& b,
+                    const std::string& out) {
+    const InputFile lhs(a);
+    const InputFile rhs(b);
+    check_types(lhs, rhs);
+    if (lhs.info.cols != rhs.info.rows) {
+        throw std::invalid_argument(
+            "Matrix dimensions incompatible for multiplication");
+    }
+    check_distinct(out, a);
+    check_distinct(out, b);
+    dispatch(lhs.info.element_type, [&](auto tag) {
+        multiply_tiles<typename decltype(tag)::type>(lhs, rhs, out);
+    });
+}
+
+void transpose_file(const std::string& a, const std::string& out) {
+    const InputFile in(a);
+    check_distinct(out, a);
+    dispatch(in.info.element_type, [&](auto tag) {
+        transpose_tiles<typename decltype(tag)::type>(in, out);
+    });
+}
+
+void add_files(const std::string& a, const std::string& b,
+               const std::string& out) {
+    const InputFile lhs(a);
+    const InputFile rhs(b);
+    check_types(lhs, rhs);
+    if (lhs.info.rows != rhs.info.rows || lhs.info.cols != rhs.info.cols) {
+        throw std::invalid_argument(
+            "Matrix dimensions must match for addition");
+    }
+    check_distinct(out, a);
+    check_distinct(out, b);
+    dispatch(lhs.info.element_type, [&](auto tag) {
+        add_chunks<typename decltype(tag)::type>(lhs, rhs, out);
+    });
+}
+
+} // namespace matrixops
@@ -0,0 +1,157 @@
+#pragma once
+
+#include <complex>
+#include <cstddef>
+
+namespace matrixops {
+namespace detail {
+
+// Portable kernels, templated on the element type: the SCALAR entries of
+// the kernel table, and the only implementation for element types without
+// SIMD kernels.
+
+// Add a register tile held in acc (row-major, mr_tile x nr_tile) to C,
+// clipping it to the valid mr x nr corner.
+template <typename T>
+void store_tile(const T* acc, size_t nr_tile, T alpha, T* c, size_t ldc,
+                size_t mr, size_t nr) {
+    for (size_t i = 0; i < mr; ++i) {
+        for (size_t j = 0; j < nr; ++j) {
+            c[i * ldc + j] += alpha * acc[i * nr_tile + j];
+        }
+    }
+}
+
+template <typename T>
+void add_scalar(const T* a, const T* b, T* out, size_t n) {
+    for (size_t i = 0; i < n; ++i) {
+        out[i] = a[i] + b[i];
+    }
+}
+
+template <typename T>
+void scale_scalar(const T* a, T scalar, T* out, size_t n) {
+    for (size_t i = 0; i < n; ++i) {
+        out[i] = a[i] * scalar;
+    }
+}
+
+template <typename T>
+double sum_squares_scalar(const T* a, size_t n) {
+    // Four independent chains hide the FP add latency.
+    double s0 = 0.0;
+    double s1 = 0.0;
+    double s2 = 0.0;
+    double s3 = 0.0;
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        const double v0 = a[i];
+        const double v1 = a[i + 1];
+        const double v2 = a[i + 2];
+        const double v3 = a[i + 3];
+        s0 += v0 * v0;
+        s1 += v1 * v1;
+        s2 += v2 * v2;
+        s3 += v3 * v3;
+    }
+    for (; i < n; ++i) {
+        const double v = a[i];
+        s0 += v * v;
+    }
+    return (s0 + s1) + (s2 + s3);
+}
+
+// acc += a * b. The complex version skips the NaN and infinity recovery
+// of std::complex multiplication, a library call that would otherwise sit
+// in the innermost loop, as BLAS implementations do.
+template <typename T>
+void multiply_add(T& acc, T a, T b) {
+    acc += a * b;
+}
+
+template <typename R>
+void multiply_add(std::complex<R>& acc, std::complex<R> a,
+                  std::complex<R> b) {
+    acc = {acc.real() + a.real() * b.real() - a.imag() * b.imag(),
+           acc.imag() + a.real() * b.imag() + a.imag() * b.real()};
+}
+
+template <typename T>
+T dot_scalar(const T* a, const T* b, size_t n) {
+    T s0(0);
+    T s1(0);
+    T s2(0);
+    T s3(0);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        multiply_add(s0, a[i], b[i]);
+        multiply_add(s1, a[i + 1], b[i + 1]);
+        multiply_add(s2, a[i + 2], b[i + 2]);
+        multiply_add(s3, a[i + 3], b[i + 3]);
+    }
+    for (; i < n; ++i) {
+        multiply_add(s0, a[i], b[i]);
+    }
+    return (s0 + s1) + (s2 + s3);
+}
+
+template <typename T>
+void axpy_scalar(T alpha, const T* x, T* y, size_t n) {
+    for (size_t i = 0; i < n; ++i) {
+        multiply_add(y[i], alpha, x[i]);
+    }
+}
+
+template <typename T, size_t MR = 4, size_t NR = 8>
+void gemm_micro_scalar(size_t kc, T alpha, const T* a, const T* b, T* c,
+                       size_t ldc, size_t mr, size_t nr) {
+    T acc[MR * NR] = {};
+    for (size_t p = 0; p < kc; ++p) {
+        for (size_t i = 0; i < MR; ++i) {
+            const T a_ip = a[i];
+            for (size_t j = 0; j < NR; ++j) {
+                multiply_add(acc[i * NR + j], a_ip, b[j]);
+            }
+        }
+        a += MR;
+        b += NR;
+    }
+    store_tile(acc, NR, alpha, c, ldc, mr, nr);
+}
+
+// One group of L interleaved matrices: element (i, j) of all of them is
+// the L consecutive values at (i * n + j) * L, so every lane loop runs
+// the same operation on L independent products.
+template <typename T, size_t L>
+void gemm_batch_scalar(size_t m, size_t n, size_t k, T alpha, const T* a,
+                       const T* b, T beta, T* c) {
+    for (size_t i = 0; i < m; ++i) {
+        for (size_t j = 0; j < n; ++j) {
+            T acc[L] = {};
+            for (size_t p = 0; p < k; ++p) {
+                const T* a_ip = a + (i * k + p) * L;
+                const T* b_pj = b + (p * n + j) * L;
+                for (size_t l = 0; l < L; ++l) {
+                    multiply_add(acc[l], a_ip[l], b_pj[l]);
+                }
+            }
+            T* c_ij = c + (i * n + j) * L;
+            for (size_t l = 0; l < L; ++l) {
+                c_ij[l] = beta == T(0) ? alpha * acc[l]
+                                       : alpha * acc[l] + beta * c_ij[l];
+            }
+        }
+    }
+}
+
+template <typename T, size_t TILE = 4>
+void transpose_micro_scalar(const T* src, size_t lds, T* dst, size_t ldd) {
+    for (size_t i = 0; i < TILE; ++i) {
+        for (size_t j = 0; j < TILE; ++j) {
+            dst[j * ldd + i] = src[i * lds + j];
+        }
+    }
+}
+
+} // namespace detail
+} // namespace matrixops
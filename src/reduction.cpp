@@ -0,0 +1,505 @@
+#include "matrixops/reduction.h"
+
+#include "matrixops/half.h"
+#include "matrixops/matrix.h"
+#include "matrixops/parallel.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <complex>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include "env.h"
+#include "reduction.h"
+
+// The reproducible modes rely on every product and sum being rounded on
+// its own: this file is built with -ffp-contract=off, see CMakeLists.txt.
+
+namespace matrixops {
+
+namespace {
+
+using detail::ExactSum;
+
+std::atomic<ReductionMode>& mode_setting() {
+    static std::atomic<ReductionMode> mode{[] {
+        const std::string env = detail::get_env("MATRIXOPS_REDUCTION");
+        if (env == "reproducible") {
+            return ReductionMode::REPRODUCIBLE;
+        }
+        if (env == "compensated") {
+            return ReductionMode::COMPENSATED;
+        }
+        if (env == "exact") {
+            return ReductionMode::EXACT;
+        }
+        return ReductionMode::FAST;
+    }()};
+    return mode;
+}
+
+// Lanes of the block sums: term k of a block goes to lane k % LANES, and
+// the lanes are added pairwise. The compiler may vectorize the lanes, as
+// each one is still summed in order.
+constexpr size_t LANES = 8;
+
+// Bit weight of digit 0 of ExactSum: products of two subnormals reach
+// 2^-2148.
+constexpr int EXACT_BASE = -2176;
+constexpr int64_t DIGIT = int64_t{1} << 32;
+constexpr uint64_t DIGIT_MASK = 0xFFFFFFFFu;
+
+// |digit| < 2^63 as long as fewer than 2^31 loads of 2^32 are added.
+constexpr uint64_t MAX_LOAD = uint64_t{1} << 30;
+
+// Sources of the terms x(k) * y(k) of a sum, read as double.
+
+template <typename R>
+struct Squares {
+    const R* a;
+    double x(size_t k) const { return static_cast<double>(a[k]); }
+    double y(size_t k) const { return static_cast<double>(a[k]); }
+};
+
+template <typename R>
+struct Products {
+    const R* a;
+    const R* b;
+    double x(size_t k) const { return static_cast<double>(a[k]); }
+    double y(size_t k) const { return static_cast<double>(b[k]); }
+};
+
+// Imaginary part of conj(a) * b over interleaved (re, im) arrays: a_re *
+// b_im at even k, -a_im * b_re at odd k.
+template <typename R>
+struct ConjugateCross {
+    const R* a;
+    const R* b;
+    double x(size_t k) const {
+        const double v = static_cast<double>(a[k]);
+        return (k & 1) != 0 ? -v : v;
+    }
+    double y(size_t k) const { return static_cast<double>(b[k ^ 1]); }
+};
+
+// A sum and the rounding error it has accumulated.
+struct Compensated {
+    double sum = 0.0;
+    double error = 0.0;
+};
+
+// Knuth's TwoSum: s + e == a + b exactly, without branches.
+inline void two_sum(double a, double b, double& s, double& e) {
+    s = a + b;
+    const double z = s - a;
+    e = (a - (s - z)) + (b - z);
+}
+
+// Dekker's TwoProduct: p + e == a * b exactly, barring overflow, without
+// relying on a fused multiply-add.
+inline void two_product(double a, double b, double& p, double& e) {
+    constexpr double SPLIT = 134217729.0; // 2^27 + 1
+    p = a * b;
+    const double ca = SPLIT * a;
+    const double a_hi = ca - (ca - a);
+    const double a_lo = a - a_hi;
+    const double cb = SPLIT * b;
+    const double b_hi = cb - (cb - b);
+    const double b_lo = b - b_hi;
+    e = ((a_hi * b_hi - p) + a_hi * b_lo + a_lo * b_hi) + a_lo * b_lo;
+}
+
+inline Compensated merge(const Compensated& a, const Compensated& b) {
+    Compensated r;
+    double e = 0.0;
+    two_sum(a.sum, b.sum, r.sum, e);
+    r.error = (a.error + b.error) + e;
+    return r;
+}
+
+inline double merge(double a, double b) { return a + b; }
+
+inline ExactSum merge(ExactSum a, const ExactSum& b) {
+    a.add(b);
+    return a;
+}
+
+// Fixed pairwise combination of lanes or blocks [lo, hi).
+template <typename P>
+P pairwise(const P* parts, size_t lo, size_t hi) {
+    if (hi - lo == 1) {
+        return parts[lo];
+    }
+    const size_t mid = lo + (hi - lo) / 2;
+    return merge(pairwise(parts, lo, mid), pairwise(parts, mid, hi));
+}
+
+template <typename Terms>
+double plain_block(const Terms& t, size_t first, size_t last) {
+    double lanes[LANES] = {};
+    size_t k = first;
+    for (; k + LANES <= last; k += LANES) {
+        for (size_t j = 0; j < LANES; ++j) {
+            const double p = t.x(k + j) * t.y(k + j);
+            lanes[j] += p;
+        }
+    }
+    for (size_t j = 0; k < last; ++k, ++j) {
+        const double p = t.x(k) * t.y(k);
+        lanes[j] += p;
+    }
+    return pairwise(lanes, 0, LANES);
+}
+
+// Ogita, Rump and Oishi's Dot2 in every lane: the rounding errors of the
+// products and of the running sums are summed on the side.
+template <typename Terms>
+Compensated compensated_block(const Terms& t, size_t first, size_t last) {
+    Compensated lanes[LANES];
+    const auto step = [&](Compensated& lane, size_t k) {
+        double p = 0.0;
+        double product_error = 0.0;
+        two_product(t.x(k), t.y(k), p, product_error);
+        double sum_error = 0.0;
+        two_sum(lane.sum, p, lane.sum, sum_error);
+        lane.error += sum_error + product_error;
+    };
+    size_t k = first;
+    for (; k + LANES <= last; k += LANES) {
+        for (size_t j = 0; j < LANES; ++j) {
+            step(lanes[j], k + j);
+        }
+    }
+    for (size_t j = 0; k < last; ++k, ++j) {
+        step(lanes[j], k);
+    }
+    return pairwise(lanes, 0, LANES);
+}
+
+template <typename Terms>
+ExactSum exact_block(const Terms& t, size_t first, size_t last) {
+    ExactSum sum;
+    for (size_t k = first; k < last; ++k) {
+        sum.add_product(t.x(k), t.y(k));
+    }
+    return sum;
+}
+
+// The n terms in blocks of ELEMENTWISE_GRAIN, summed on the thread pool
+// and combined pairwise in block order.
+template <typename P, typename Block>
+P reduce_blocks(size_t n, const Block& block) {
+    const size_t blocks = std::max<size_t>(
+        (n + detail::ELEMENTWISE_GRAIN - 1) / detail::ELEMENTWISE_GRAIN, 1);
+    if (blocks == 1) {
+        return block(0, n);
+    }
+    std::vector<P> partial(blocks);
+    parallel_for(0, blocks, 1, [&](size_t lo, size_t hi) {
+        for (size_t b = lo; b < hi; ++b) {
+            const size_t first = b * detail::ELEMENTWISE_GRAIN;
+            partial[b] = block(
+                first, std::min(n, first + detail::ELEMENTWISE_GRAIN));
+        }
+    });
+    return pairwise(partial.data(), 0, blocks);
+}
+
+template <typename Terms>
+ExactSum exact_reduce(const Terms& t, size_t n) {
+    return reduce_blocks<ExactSum>(n, [&](size_t first, size_t last) {
+        return exact_block(t, first, last);
+    });
+}
+
+template <typename Terms>
+double reduce(const Terms& t, size_t n, ReductionMode mode) {
+    if (mode == ReductionMode::EXACT) {
+        return exact_reduce(t, n).value();
+    }
+    if (mode == ReductionMode::COMPENSATED) {
+        const Compensated sum = reduce_blocks<Compensated>(
+            n, [&](size_t first, size_t last) {
+                return compensated_block(t, first, last);
+            });
+        return sum.sum + sum.error;
+    }
+    return reduce_blocks<double>(n, [&](size_t first, size_t last) {
+        return plain_block(t, first, last);
+    });
+}
+
+// Elements as the real type they are made of, complex ones as (re, im)
+// pairs: std::complex<R> is laid out as R[2].
+template <typename T>
+struct Parts {
+    using type = T;
+    static const T* of(const T* a) { return a; }
+    static constexpr size_t PER_ELEMENT = 1;
+};
+
+template <typename R>
+struct Parts<std::complex<R>> {
+    using type = R;
+    static const R* of(const std::complex<R>* a) {
+        return reinterpret_cast<const R*>(a);
+    }
+    static constexpr size_t PER_ELEMENT = 2;
+};
+
+int leading_bit(uint64_t v) {
+    int bit = 63;
+    while ((v >> bit) == 0) {
+        --bit;
+    }
+    return bit;
+}
+
+} // namespace
+
+ReductionMode reduction_mode() { return mode_setting().load(); }
+
+void set_reduction_mode(ReductionMode mode) { mode_setting().store(mode); }
+
+const char* reduction_mode_name(ReductionMode mode) {
+    switch (mode) {
+    case ReductionMode::FAST:
+        return "fast";
+    case ReductionMode::REPRODUCIBLE:
+        return "reproducible";
+    case ReductionMode::COMPENSATED:
+        return "compensated";
+    case ReductionMode::EXACT:
+        return "exact";
+    }
+    return "unknown";
+}
+
+namespace detail {
+
+void ExactSum::add_product(double a, double b) {
+    if (!std::isfinite(a) || !std::isfinite(b)) {
+        special_ += a * b;
+        return;
+    }
+    uint64_t bits_a = 0;
+    uint64_t bits_b = 0;
+    std::memcpy(&bits_a, &a, sizeof(a));
+    std::memcpy(&bits_b, &b, sizeof(b));
+    constexpr uint64_t FRACTION = (uint64_t{1} << 52) - 1;
+    const int exp_a = static_cast<int>((bits_a >> 52) & 0x7FF);
+    const int exp_b = static_cast<int>((bits_b >> 52) & 0x7FF);
+    // a = m_a * 2^e_a with an integer m_a below 2^53, subnormals included
+    const uint64_t m_a = (bits_a & FRACTION) | (exp_a != 0 ? FRACTION + 1 : 0);
+    const uint64_t m_b = (bits_b & FRACTION) | (exp_b != 0 ? FRACTION + 1 : 0);
+    if (m_a == 0 || m_b == 0) {
+        return;
+    }
+    const int e = std::max(exp_a, 1) + std::max(exp_b, 1) - 2 * 1075;
+    const bool negative = ((bits_a ^ bits_b) >> 63) != 0;
+
+    // The 106-bit product m_a * m_b in 32-bit words w[0..3]
+    const uint64_t a0 = m_a & DIGIT_MASK;
+    const uint64_t a1 = m_a >> 32;
+    const uint64_t b0 = m_b & DIGIT_MASK;
+    const uint64_t b1 = m_b >> 32;
+    const uint64_t p00 = a0 * b0;
+    const uint64_t p01 = a0 * b1;
+    const uint64_t p10 = a1 * b0;
+    const uint64_t p11 = a1 * b1;
+    const uint64_t mid = (p00 >> 32) + (p01 & DIGIT_MASK) + (p10 & DIGIT_MASK);
+    const uint64_t high = p11 + (p01 >> 32) + (p10 >> 32) + (mid >> 32);
+    const uint64_t w[4] = {p00 & DIGIT_MASK, mid & DIGIT_MASK,
+                           high & DIGIT_MASK, high >> 32};
+
+    // Shifted into the digits from bit e - EXACT_BASE on
+    const int offset = e - EXACT_BASE;
+    const size_t first = static_cast<size_t>(offset / 32);
+    const int shift = offset % 32;
+    for (size_t i = 0; i < 5; ++i) {
+        uint64_t part = i < 4 ? (w[i] << shift) & DIGIT_MASK : 0;
+        if (i > 0) {
+            part |= w[i - 1] >> (32 - shift);
+        }
+        const int64_t value = static_cast<int64_t>(part);
+        digits_[first + i] += negative ? -value : value;
+    }
+    if (++load_ >= MAX_LOAD) {
+        normalize();
+    }
+}
+
+void ExactSum::add(const ExactSum& other) {
+    for (size_t i = 0; i < DIGITS; ++i) {
+        digits_[i] += other.digits_[i];
+    }
+    special_ += other.special_;
+    load_ += other.load_;
+    if (load_ >= MAX_LOAD) {
+        normalize();
+    }
+}
+
+void ExactSum::normalize() {
+    for (size_t i = 0; i + 1 < DIGITS; ++i) {
+        const int64_t low = digits_[i] & static_cast<int64_t>(DIGIT_MASK);
+        digits_[i + 1] += (digits_[i] - low) / DIGIT;
+        digits_[i] = low;
+    }
+    load_ = 1;
+}
+
+// The sum as +-mantissa * 2^exponent, rounded to nearest even on `bits`
+// bits, or on fewer if clamp_subnormal and it is below the normal range.
+void ExactSum::round(int bits, bool clamp_subnormal, bool& negative,
+                     uint64_t& mantissa, int& exponent) const {
+    ExactSum n = *this;
+    n.normalize();
+    negative = n.digits_[DIGITS - 1] < 0;
+    if (negative) {
+        for (int64_t& d : n.digits_) {
+            d = -d;
+        }
+        n.normalize();
+    }
+    size_t top = DIGITS;
+    while (top > 0 && n.digits_[top - 1] == 0) {
+        --top;
+    }
+    mantissa = 0;
+    exponent = 0;
+    if (top == 0) {
+        return;
+    }
+    const size_t h = top - 1;
+    const uint64_t d2 = static_cast<uint64_t>(n.digits_[h]);
+    const uint64_t d1 = h >= 1 ? static_cast<uint64_t>(n.digits_[h - 1]) : 0;
+    const uint64_t d0 = h >= 2 ? static_cast<uint64_t>(n.digits_[h - 2]) : 0;
+    const int msb = leading_bit(d2);
+    const int shift = 31 - msb;
+    // The 64 leading bits, and whether any bit below them is set
+    const uint64_t window =
+        (d2 << (32 + shift)) | (d1 << shift) | (d0 >> (32 - shift));
+    bool sticky = ((d0 << shift) & DIGIT_MASK) != 0;
+    for (size_t i = 0; i + 2 < h && !sticky; ++i) {
+        sticky = n.digits_[i] != 0;
+    }
+    // Weight of the leading bit
+    const int lead = static_cast<int>(32 * h) + msb + EXACT_BASE;
+    int kept = bits;
+    if (clamp_subnormal) {
+        kept = std::min(bits, lead + 1075);
+    }
+    if (kept <= 0) {
+        // Below half the smallest subnormal, or at least half of it
+        const bool up = kept == 0 && (window > (uint64_t{1} << 63) || sticky);
+        mantissa = up ? 1 : 0;
+        exponent = -1074;
+        return;
+    }
+    const int dropped = 64 - kept;
+    mantissa = window >> dropped;
+    const uint64_t rest = window & ((uint64_t{1} << dropped) - 1);
+    const uint64_t half = uint64_t{1} << (dropped - 1);
+    if (rest > half || (rest == half && (sticky || (mantissa & 1) != 0))) {
+        ++mantissa;
+    }
+    exponent = lead - kept + 1;
+    if (mantissa >> kept != 0) {
+        mantissa >>= 1;
+        ++exponent;
+    }
+}
+
+double ExactSum::value() const {
+    if (special_ != 0.0 || std::isnan(special_)) {
+        return special_;
+    }
+    bool negative = false;
+    uint64_t mantissa = 0;
+    int exponent = 0;
+    round(53, true, negative, mantissa, exponent);
+    const double magnitude =
+        std::ldexp(static_cast<double>(mantissa), exponent);
+    return negative ? -magnitude : magnitude;
+}
+
+double ExactSum::sqrt() const {
+    if (special_ != 0.0 || std::isnan(special_)) {
+        return std::sqrt(special_);
+    }
+    bool negative = false;
+    uint64_t mantissa = 0;
+    int exponent = 0;
+    round(53, false, negative, mantissa, exponent);
+    if (negative) {
+        return std::numeric_limits<double>::quiet_NaN();
+    }
+    // An even exponent halves exactly; mantissa * 2 stays exact in double.
+    if (exponent % 2 != 0) {
+        mantissa *= 2;
+        --exponent;
+    }
+    return std::ldexp(std::sqrt(static_cast<double>(mantissa)),
+                      exponent / 2);
+}
+
+template <typename T>
+double ordered_sum_squares(const T* a, size_t n, ReductionMode mode) {
+    using P = Parts<T>;
+    return reduce(Squares<typename P::type>{P::of(a)}, n * P::PER_ELEMENT,
+                  mode);
+}
+
+template <typename T>
+ExactSum exact_sum_squares(const T* a, size_t n) {
+    using P = Parts<T>;
+    return exact_reduce(Squares<typename P::type>{P::of(a)},
+                        n * P::PER_ELEMENT);
+}
+
+template <typename T>
+T ordered_dotc(const T* a, const T* b, size_t n, ReductionMode mode) {
+    using P = Parts<T>;
+    using R = typename P::type;
+    const double re = reduce(Products<R>{P::of(a), P::of(b)},
+                             n * P::PER_ELEMENT, mode);
+    if constexpr (P::PER_ELEMENT == 1) {
+        return static_cast<T>(re);
+    } else {
+        const double im =
+            reduce(ConjugateCross<R>{P::of(a), P::of(b)}, 2 * n, mode);
+        return T(static_cast<R>(re), static_cast<R>(im));
+    }
+}
+
+#define MATRIXOPS_INSTANTIATE_REDUCTION(T)                                     \
+    template double ordered_sum_squares(const T*, size_t, ReductionMode);      \
+    template ExactSum exact_sum_squares(const T*, size_t);
+
+MATRIXOPS_INSTANTIATE_REDUCTION(float)
+MATRIXOPS_INSTANTIATE_REDUCTION(double)
+MATRIXOPS_INSTANTIATE_REDUCTION(std::complex<float>)
+MATRIXOPS_INSTANTIATE_REDUCTION(std::complex<double>)
+MATRIXOPS_INSTANTIATE_REDUCTION(Half)
+MATRIXOPS_INSTANTIATE_REDUCTION(BFloat16)
+
+template float ordered_dotc(const float*, const float*, size_t,
+                            ReductionMode);
+template double ordered_dotc(const double*, const double*, size_t,
+                             ReductionMode);
+template std::complex<float> ordered_dotc(const std::complex<float>*,
+                                          const std::complex<float>*, size_t,
+                                          ReductionMode);
+template std::complex<double> ordered_dotc(const std::complex<double>*,
+                                           const std::complex<double>*,
+                                           size_t, ReductionMode);
+
+#undef MATRIXOPS_INSTANTIATE_REDUCTION
+
+} // namespace detail
+} // namespace matrixops
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "matrixops/reduction.h"
+
+namespace matrixops {
+namespace detail {
+
+/**
+ * @brief Sum of the squared magnitudes of a[0:n], accumulated in double
+ *
+ * Large arrays are split into ELEMENTWISE_GRAIN blocks on the thread
+ * pool, summed as reduction_mode() says. Instantiated in matrix.cpp for
+ * every Matrix element type.
+ */
+template <typename T>
+double sum_squares(const T* a, size_t n);
+
+/**
+ * @brief Euclidean norm of a[0:n], safe from overflow and underflow
+ *
+ * Takes the square root of sum_squares() when that is representable;
+ * otherwise, which needs double elements beyond about 1e154 or below
+ * 1e-146, the sum is redone scaled by the largest magnitude, on the
+ * calling thread. In EXACT mode the square root is taken from the exact
+ * sum, which cannot overflow.
+ */
+template <typename T>
+double euclidean_norm(const T* a, size_t n);
+
+/**
+ * @brief Exact sum of products of doubles, as a fixed-point integer
+ *
+ * Spans every product of two finite doubles, subnormals included, with
+ * 128 bits of headroom, in 32-bit digits held in 64-bit integers. Adding
+ * is then associative, so partial sums combine in any order with the same
+ * result. Products with an infinite or NaN factor are summed apart, in
+ * floating point, and take over the result.
+ */
+class ExactSum {
+public:
+    static constexpr size_t DIGITS = 136;
+
+    /**
+     * @brief Add a * b, exactly
+     */
+    void add_product(double a, double b);
+
+    /**
+     * @brief Add another partial sum, exactly
+     */
+    void add(const ExactSum& other);
+
+    /**
+     * @brief The sum, correctly rounded to double
+     */
+    double value() const;
+
+    /**
+     * @brief Square root of a sum of squares, without overflow or
+     * underflow: the sum is rounded to 53 bits, whatever its magnitude,
+     * and the root rounded once
+     */
+    double sqrt() const;
+
+    /**
+     * @brief Propagate the carries, leaving every digit but the top one
+     * in [0, 2^32)
+     *
+     * Normalized digits of up to 2^31 sums can be added as integers,
+     * for instance by MPI_Allreduce.
+     */
+    void normalize();
+
+    int64_t* digits() { return digits_; }
+    double& special() { return special_; }
+
+private:
+    int64_t digits_[DIGITS] = {};
+    double special_ = 0.0;
+    // Bound on the digit magnitudes, in units of 2^32
+    uint64_t load_ = 0;
+
+    void round(int bits, bool clamp_subnormal, bool& negative,
+               uint64_t& mantissa, int& exponent) const;
+};
+
+/**
+ * @brief Sum of the squared magnitudes of a[0:n] in one of the
+ * reproducible modes, REPRODUCIBLE, COMPENSATED or EXACT
+ */
+template <typename T>
+double ordered_sum_squares(const T* a, size_t n, ReductionMode mode);
+
+/**
+ * @brief Exact sum of the squared magnitudes of a[0:n]
+ */
+template <typename T>
+ExactSum exact_sum_squares(const T* a, size_t n);
+
+/**
+ * @brief The sum of conj(a[i]) * b[i] in one of the reproducible modes
+ */
+template <typename T>
+T ordered_dotc(const T* a, const T* b, size_t n, ReductionMode mode);
+
+} // namespace detail
+} // namespace matrixops
@@ -0,0 +1,2055 @@
+#include "matrixops/simd.h"
+
+#include "matrixops/batch.h"
+
+#include <atomic>
+#include <stdexcept>
+#include <string>
+
+#include "env.h"
+#include "kernels.h"
+#include "portable_kernels.h"
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define MATRIXOPS_ARCH_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define MATRIXOPS_ARCH_ARM64 1
+#include <arm_neon.h>
+#endif
+
+// Kernels for ISAs above the compilation baseline are compiled with a
+// per-function target so that one binary carries every variant. MSVC
+// accepts the intrinsics without it.
+#if defined(__GNUC__) || defined(__clang__)
+#define MATRIXOPS_TARGET(isa) __attribute__((target(isa)))
+#else
+#define MATRIXOPS_TARGET(isa)
+#endif
+
+namespace matrixops {
+namespace detail {
+namespace {
+
+// The batch kernels below are written for these group sizes.
+static_assert(BATCH_LANES<double> == 8 && BATCH_LANES<float> == 16,
+              "Batch kernels assume 64-byte groups");
+
+// ---------------------------------------------------------------------------
+// Portable kernels (see portable_kernels.h)
+// ---------------------------------------------------------------------------
+
+const Kernels SCALAR_KERNELS = {
+    SimdIsa::SCALAR,
+    {add_scalar<double>,
+     scale_scalar<double>,
+     sum_squares_scalar<double>,
+     dot_scalar<double>,
+     axpy_scalar<double>,
+     {4, 8, gemm_micro_scalar<double>},
+     gemm_batch_scalar<double, BATCH_LANES<double>>},
+    {add_scalar<float>,
+     scale_scalar<float>,
+     sum_squares_scalar<float>,
+     dot_scalar<float>,
+     axpy_scalar<float>,
+     {4, 8, gemm_micro_scalar<float>},
+     gemm_batch_scalar<float, BATCH_LANES<float>>},
+    4,
+    transpose_micro_scalar<double>};
+
+#if defined(MATRIXOPS_ARCH_X86)
+
+// ---------------------------------------------------------------------------
+// SSE2
+// ---------------------------------------------------------------------------
+
+void add_sse2(const double* a, const double* b, double* out, size_t n) {
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        _mm_storeu_pd(out + i,
+                      _mm_add_pd(_mm_loadu_pd(a + i), _mm_loadu_pd(b + i)));
+        _mm_storeu_pd(out + i + 2, _mm_add_pd(_mm_loadu_pd(a + i + 2),
+                                              _mm_loadu_pd(b + i + 2)));
+    }
+    for (; i < n; ++i) {
+        out[i] = a[i] + b[i];
+    }
+}
+
+void scale_sse2(const double* a, double scalar, double* out, size_t n) {
+    const __m128d s = _mm_set1_pd(scalar);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        _mm_storeu_pd(out + i, _mm_mul_pd(_mm_loadu_pd(a + i), s));
+        _mm_storeu_pd(out + i + 2, _mm_mul_pd(_mm_loadu_pd(a + i + 2), s));
+    }
+    for (; i < n; ++i) {
+        out[i] = a[i] * scalar;
+    }
+}
+
+double sum_squares_sse2(const double* a, size_t n) {
+    __m128d s0 = _mm_setzero_pd();
+    __m128d s1 = _mm_setzero_pd();
+    __m128d s2 = _mm_setzero_pd();
+    __m128d s3 = _mm_setzero_pd();
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        const __m128d v0 = _mm_loadu_pd(a + i);
+        const __m128d v1 = _mm_loadu_pd(a + i + 2);
+        const __m128d v2 = _mm_loadu_pd(a + i + 4);
+        const __m128d v3 = _mm_loadu_pd(a + i + 6);
+        s0 = _mm_add_pd(s0, _mm_mul_pd(v0, v0));
+        s1 = _mm_add_pd(s1, _mm_mul_pd(v1, v1));
+        s2 = _mm_add_pd(s2, _mm_mul_pd(v2, v2));
+        s3 = _mm_add_pd(s3, _mm_mul_pd(v3, v3));
+    }
+    const __m128d s = _mm_add_pd(_mm_add_pd(s0, s1), _mm_add_pd(s2, s3));
+    double lanes[2];
+    _mm_storeu_pd(lanes, s);
+    double sum = lanes[0] + lanes[1];
+    for (; i < n; ++i) {
+        sum += a[i] * a[i];
+    }
+    return sum;
+}
+
+double dot_sse2(const double* a, const double* b, size_t n) {
+    __m128d s0 = _mm_setzero_pd();
+    __m128d s1 = _mm_setzero_pd();
+    __m128d s2 = _mm_setzero_pd();
+    __m128d s3 = _mm_setzero_pd();
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        s0 = _mm_add_pd(s0, _mm_mul_pd(_mm_loadu_pd(a + i),
+                                       _mm_loadu_pd(b + i)));
+        s1 = _mm_add_pd(s1, _mm_mul_pd(_mm_loadu_pd(a + i + 2),
+                                       _mm_loadu_pd(b + i + 2)));
+        s2 = _mm_add_pd(s2, _mm_mul_pd(_mm_loadu_pd(a + i + 4),
+                                       _mm_loadu_pd(b + i + 4)));
+        s3 = _mm_add_pd(s3, _mm_mul_pd(_mm_loadu_pd(a + i + 6),
+                                       _mm_loadu_pd(b + i + 6)));
+    }
+    const __m128d s = _mm_add_pd(_mm_add_pd(s0, s1), _mm_add_pd(s2, s3));
+    double lanes[2];
+    _mm_storeu_pd(lanes, s);
+    double sum = lanes[0] + lanes[1];
+    for (; i < n; ++i) {
+        sum += a[i] * b[i];
+    }
+    return sum;
+}
+
+void axpy_sse2(double alpha, const double* x, double* y, size_t n) {
+    const __m128d s = _mm_set1_pd(alpha);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        _mm_storeu_pd(y + i, _mm_add_pd(_mm_loadu_pd(y + i),
+                                        _mm_mul_pd(s, _mm_loadu_pd(x + i))));
+        _mm_storeu_pd(y + i + 2,
+                      _mm_add_pd(_mm_loadu_pd(y + i + 2),
+                                 _mm_mul_pd(s, _mm_loadu_pd(x + i + 2))));
+    }
+    for (; i < n; ++i) {
+        y[i] += alpha * x[i];
+    }
+}
+
+void gemm_micro_sse2(size_t kc, double alpha, const double* a,
+                     const double* b, double* c, size_t ldc, size_t mr,
+                     size_t nr) {
+    constexpr size_t MR = 4;
+    constexpr size_t NR = 4;
+    __m128d acc[MR][2];
+    for (size_t i = 0; i < MR; ++i) {
+        acc[i][0] = _mm_setzero_pd();
+        acc[i][1] = _mm_setzero_pd();
+    }
+    for (size_t p = 0; p < kc; ++p) {
+        const __m128d b0 = _mm_loadu_pd(b);
+        const __m128d b1 = _mm_loadu_pd(b + 2);
+        for (size_t i = 0; i < MR; ++i) {
+            const __m128d a_ip = _mm_set1_pd(a[i]);
+            acc[i][0] = _mm_add_pd(acc[i][0], _mm_mul_pd(a_ip, b0));
+            acc[i][1] = _mm_add_pd(acc[i][1], _mm_mul_pd(a_ip, b1));
+        }
+        a += MR;
+        b += NR;
+    }
+    double tile[MR * NR];
+    for (size_t i = 0; i < MR; ++i) {
+        _mm_storeu_pd(tile + i * NR, acc[i][0]);
+        _mm_storeu_pd(tile + i * NR + 2, acc[i][1]);
+    }
+    store_tile(tile, NR, alpha, c, ldc, mr, nr);
+}
+
+// 4x4 tile as four 2x2 register transposes.
+void transpose_micro_sse2(const double* src, size_t lds, double* dst,
+                          size_t ldd) {
+    for (size_t i = 0; i < 4; i += 2) {
+        for (size_t j = 0; j < 4; j += 2) {
+            const __m128d r0 = _mm_loadu_pd(src + i * lds + j);
+            const __m128d r1 = _mm_loadu_pd(src + (i + 1) * lds + j);
+            _mm_storeu_pd(dst + j * ldd + i, _mm_unpacklo_pd(r0, r1));
+            _mm_storeu_pd(dst + (j + 1) * ldd + i, _mm_unpackhi_pd(r0, r1));
+        }
+    }
+}
+
+// Single precision: twice the lanes per register. The squares are summed
+// in double, as for the double kernels.
+
+void add_sse2(const float* a, const float* b, float* out, size_t n) {
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        _mm_storeu_ps(out + i,
+                      _mm_add_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+        _mm_storeu_ps(out + i + 4, _mm_add_ps(_mm_loadu_ps(a + i + 4),
+                                              _mm_loadu_ps(b + i + 4)));
+    }
+    for (; i < n; ++i) {
+        out[i] = a[i] + b[i];
+    }
+}
+
+void scale_sse2(const float* a, float scalar, float* out, size_t n) {
+    const __m128 s = _mm_set1_ps(scalar);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        _mm_storeu_ps(out + i, _mm_mul_ps(_mm_loadu_ps(a + i), s));
+        _mm_storeu_ps(out + i + 4, _mm_mul_ps(_mm_loadu_ps(a + i + 4), s));
+    }
+    for (; i < n; ++i) {
+        out[i] = a[i] * scalar;
+    }
+}
+
+double sum_squares_sse2(const float* a, size_t n) {
+    __m128d s0 = _mm_setzero_pd();
+    __m128d s1 = _mm_setzero_pd();
+    __m128d s2 = _mm_setzero_pd();
+    __m128d s3 = _mm_setzero_pd();
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        const __m128 v0 = _mm_loadu_ps(a + i);
+        const __m128 v1 = _mm_loadu_ps(a + i + 4);
+        const __m128d d0 = _mm_cvtps_pd(v0);
+        const __m128d d1 = _mm_cvtps_pd(_mm_movehl_ps(v0, v0));
+        const __m128d d2 = _mm_cvtps_pd(v1);
+        const __m128d d3 = _mm_cvtps_pd(_mm_movehl_ps(v1, v1));
+        s0 = _mm_add_pd(s0, _mm_mul_pd(d0, d0));
+        s1 = _mm_add_pd(s1, _mm_mul_pd(d1, d1));
+        s2 = _mm_add_pd(s2, _mm_mul_pd(d2, d2));
+        s3 = _mm_add_pd(s3, _mm_mul_pd(d3, d3));
+    }
+    const __m128d s = _mm_add_pd(_mm_add_pd(s0, s1), _mm_add_pd(s2, s3));
+    double lanes[2];
+    _mm_storeu_pd(lanes, s);
+    double sum = lanes[0] + lanes[1];
+    for (; i < n; ++i) {
+        const double v = a[i];
+        sum += v * v;
+    }
+    return sum;
+}
+
+float dot_sse2(const float* a, const float* b, size_t n) {
+    __m128 s0 = _mm_setzero_ps();
+    __m128 s1 = _mm_setzero_ps();
+    __m128 s2 = _mm_setzero_ps();
+    __m128 s3 = _mm_setzero_ps();
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        s0 = _mm_add_ps(s0, _mm_mul_ps(_mm_loadu_ps(a + i),
+                                       _mm_loadu_ps(b + i)));
+        s1 = _mm_add_ps(s1, _mm_mul_ps(_mm_loadu_ps(a + i + 4),
+                                       _mm_loadu_ps(b + i + 4)));
+        s2 = _mm_add_ps(s2, _mm_mul_ps(_mm_loadu_ps(a + i + 8),
+                                       _mm_loadu_ps(b + i + 8)));
+        s3 = _mm_add_ps(s3, _mm_mul_ps(_mm_loadu_ps(a + i + 12),
+                                       _mm_loadu_ps(b + i + 12)));
+    }
+    const __m128 s = _mm_add_ps(_mm_add_ps(s0, s1), _mm_add_ps(s2, s3));
+    float lanes[4];
+    _mm_storeu_ps(lanes, s);
+    float sum = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+    for (; i < n; ++i) {
+        sum += a[i] * b[i];
+    }
+    return sum;
+}
+
+void axpy_sse2(float alpha, const float* x, float* y, size_t n) {
+    const __m128 s = _mm_set1_ps(alpha);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        _mm_storeu_ps(y + i, _mm_add_ps(_mm_loadu_ps(y + i),
+                                        _mm_mul_ps(s, _mm_loadu_ps(x + i))));
+        _mm_storeu_ps(y + i + 4,
+                      _mm_add_ps(_mm_loadu_ps(y + i + 4),
+                                 _mm_mul_ps(s, _mm_loadu_ps(x + i + 4))));
+    }
+    for (; i < n; ++i) {
+        y[i] += alpha * x[i];
+    }
+}
+
+void gemm_micro_sse2(size_t kc, float alpha, const float* a, const float* b,
+                     float* c, size_t ldc, size_t mr, size_t nr) {
+    constexpr size_t MR = 4;
+    constexpr size_t NR = 8;
+    __m128 acc[MR][2];
+    for (size_t i = 0; i < MR; ++i) {
+        acc[i][0] = _mm_setzero_ps();
+        acc[i][1] = _mm_setzero_ps();
+    }
+    for (size_t p = 0; p < kc; ++p) {
+        const __m128 b0 = _mm_loadu_ps(b);
+        const __m128 b1 = _mm_loadu_ps(b + 4);
+        for (size_t i = 0; i < MR; ++i) {
+            const __m128 a_ip = _mm_set1_ps(a[i]);
+            acc[i][0] = _mm_add_ps(acc[i][0], _mm_mul_ps(a_ip, b0));
+            acc[i][1] = _mm_add_ps(acc[i][1], _mm_mul_ps(a_ip, b1));
+        }
+        a += MR;
+        b += NR;
+    }
+    float tile[MR * NR];
+    for (size_t i = 0; i < MR; ++i) {
+        _mm_storeu_ps(tile + i * NR, acc[i][0]);
+        _mm_storeu_ps(tile + i * NR + 4, acc[i][1]);
+    }
+    store_tile(tile, NR, alpha, c, ldc, mr, nr);
+}
+
+// c = alpha * acc + beta * c for one register of a batch product.
+void store_batch_sse2(double* out, __m128d acc, __m128d va,
+                      __m128d vb, double beta) {
+    const __m128d scaled = _mm_mul_pd(va, acc);
+    if (beta == 0.0) {
+        _mm_storeu_pd(out, scaled);
+    } else {
+        const __m128d old = _mm_loadu_pd(out);
+        _mm_storeu_pd(out, _mm_add_pd(scaled, _mm_mul_pd(vb, old)));
+    }
+}
+
+// Batched GEMM on one group of interleaved matrices (see batch.h): the
+// same element of every matrix in the group fills 4 registers, and
+// 2 columns of C are accumulated per pass over k.
+void gemm_batch_sse2(size_t m, size_t n, size_t k, double alpha,
+                     const double* a, const double* b, double beta,
+                     double* c) {
+    constexpr size_t L = 8;
+    constexpr size_t W = 2;
+    constexpr size_t R = L / W;
+    constexpr size_t NB = 2;
+    const __m128d va = _mm_set1_pd(alpha);
+    const __m128d vb = _mm_set1_pd(beta);
+    for (size_t i = 0; i < m; ++i) {
+        const double* a_row = a + i * k * L;
+        double* c_row = c + i * n * L;
+        size_t j = 0;
+        for (; j + NB <= n; j += NB) {
+            __m128d acc[NB][R];
+            for (size_t q = 0; q < NB; ++q) {
+                for (size_t r = 0; r < R; ++r) {
+                    acc[q][r] = _mm_setzero_pd();
+                }
+            }
+            for (size_t p = 0; p < k; ++p) {
+                const double* a_ip = a_row + p * L;
+                const double* b_p = b + (p * n + j) * L;
+                for (size_t r = 0; r < R; ++r) {
+                    const __m128d a_r = _mm_loadu_pd(a_ip + r * W);
+                    for (size_t q = 0; q < NB; ++q) {
+                        const __m128d b_qr = _mm_loadu_pd(b_p + q * L + r * W);
+                        acc[q][r] =
+                            _mm_add_pd(acc[q][r], _mm_mul_pd(a_r, b_qr));
+                    }
+                }
+            }
+            for (size_t q = 0; q < NB; ++q) {
+                double* c_q = c_row + (j + q) * L;
+                for (size_t r = 0; r < R; ++r) {
+                    store_batch_sse2(c_q + r * W, acc[q][r], va, vb, beta);
+                }
+            }
+        }
+        for (; j < n; ++j) {
+            __m128d acc[R];
+            for (size_t r = 0; r < R; ++r) {
+                acc[r] = _mm_setzero_pd();
+            }
+            for (size_t p = 0; p < k; ++p) {
+                const double* a_ip = a_row + p * L;
+                const double* b_pj = b + (p * n + j) * L;
+                for (size_t r = 0; r < R; ++r) {
+                    const __m128d a_r = _mm_loadu_pd(a_ip + r * W);
+                    const __m128d b_r = _mm_loadu_pd(b_pj + r * W);
+                    acc[r] = _mm_add_pd(acc[r], _mm_mul_pd(a_r, b_r));
+                }
+            }
+            for (size_t r = 0; r < R; ++r) {
+                store_batch_sse2(c_row + j * L + r * W, acc[r], va, vb, beta);
+            }
+        }
+    }
+}
+
+void store_batch_sse2(float* out, __m128 acc, __m128 va,
+                      __m128 vb, float beta) {
+    const __m128 scaled = _mm_mul_ps(va, acc);
+    if (beta == 0.0F) {
+        _mm_storeu_ps(out, scaled);
+    } else {
+        const __m128 old = _mm_loadu_ps(out);
+        _mm_storeu_ps(out, _mm_add_ps(scaled, _mm_mul_ps(vb, old)));
+    }
+}
+
+void gemm_batch_sse2(size_t m, size_t n, size_t k, float alpha,
+                     const float* a, const float* b, float beta,
+                     float* c) {
+    constexpr size_t L = 16;
+    constexpr size_t W = 4;
+    constexpr size_t R = L / W;
+    constexpr size_t NB = 2;
+    const __m128 va = _mm_set1_ps(alpha);
+    const __m128 vb = _mm_set1_ps(beta);
+    for (size_t i = 0; i < m; ++i) {
+        const float* a_row = a + i * k * L;
+        float* c_row = c + i * n * L;
+        size_t j = 0;
+        for (; j + NB <= n; j += NB) {
+            __m128 acc[NB][R];
+            for (size_t q = 0; q < NB; ++q) {
+                for (size_t r = 0; r < R; ++r) {
+                    acc[q][r] = _mm_setzero_ps();
+                }
+            }
+            for (size_t p = 0; p < k; ++p) {
+                const float* a_ip = a_row + p * L;
+                const float* b_p = b + (p * n + j) * L;
+                for (size_t r = 0; r < R; ++r) {
+                    const __m128 a_r = _mm_loadu_ps(a_ip + r * W);
+                    for (size_t q = 0; q < NB; ++q) {
+                        const __m128 b_qr = _mm_loadu_ps(b_p + q * L + r * W);
+                        acc[q][r] =
+                            _mm_add_ps(acc[q][r], _mm_mul_ps(a_r, b_qr));
+                    }
+                }
+            }
+            for (size_t q = 0; q < NB; ++q) {
+                float* c_q = c_row + (j + q) * L;
+                for (size_t r = 0; r < R; ++r) {
+                    store_batch_sse2(c_q + r * W, acc[q][r], va, vb, beta);
+                }
+            }
+        }
+        for (; j < n; ++j) {
+            __m128 acc[R];
+            for (size_t r = 0; r < R; ++r) {
+                acc[r] = _mm_setzero_ps();
+            }
+            for (size_t p = 0; p < k; ++p) {
+                const float* a_ip = a_row + p * L;
+                const float* b_pj = b + (p * n + j) * L;
+                for (size_t r = 0; r < R; ++r) {
+                    const __m128 a_r = _mm_loadu_ps(a_ip + r * W);
+                    const __m128 b_r = _mm_loadu_ps(b_pj + r * W);
+                    acc[r] = _mm_add_ps(acc[r], _mm_mul_ps(a_r, b_r));
+                }
+            }
+            for (size_t r = 0; r < R; ++r) {
+                store_batch_sse2(c_row + j * L + r * W, acc[r], va, vb, beta);
+            }
+        }
+    }
+}
+
+const Kernels SSE2_KERNELS = {
+    SimdIsa::SSE2,
+    {add_sse2,
+     scale_sse2,
+     sum_squares_sse2,
+     dot_sse2,
+     axpy_sse2,
+     {4, 4, gemm_micro_sse2},
+     gemm_batch_sse2},
+    {add_sse2,
+     scale_sse2,
+     sum_squares_sse2,
+     dot_sse2,
+     axpy_sse2,
+     {4, 8, gemm_micro_sse2},
+     gemm_batch_sse2},
+    4,
+    transpose_micro_sse2};
+
+// ---------------------------------------------------------------------------
+// AVX2 + FMA
+// ---------------------------------------------------------------------------
+
+MATRIXOPS_TARGET("avx2,fma")
+void add_avx2(const double* a, const double* b, double* out, size_t n) {
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        _mm256_storeu_pd(out + i, _mm256_add_pd(_mm256_loadu_pd(a + i),
+                                                _mm256_loadu_pd(b + i)));
+        _mm256_storeu_pd(out + i + 4,
+                         _mm256_add_pd(_mm256_loadu_pd(a + i + 4),
+                                       _mm256_loadu_pd(b + i + 4)));
+    }
+    for (; i < n; ++i) {
+        out[i] = a[i] + b[i];
+    }
+}
+
+MATRIXOPS_TARGET("avx2,fma")
+void scale_avx2(const double* a, double scalar, double* out, size_t n) {
+    const __m256d s = _mm256_set1_pd(scalar);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        _mm256_storeu_pd(out + i, _mm256_mul_pd(_mm256_loadu_pd(a + i), s));
+        _mm256_storeu_pd(out + i + 4,
+                         _mm256_mul_pd(_mm256_loadu_pd(a + i + 4), s));
+    }
+    for (; i < n; ++i) {
+        out[i] = a[i] * scalar;
+    }
+}
+
+MATRIXOPS_TARGET("avx2,fma")
+double sum_squares_avx2(const double* a, size_t n) {
+    __m256d s0 = _mm256_setzero_pd();
+    __m256d s1 = _mm256_setzero_pd();
+    __m256d s2 = _mm256_setzero_pd();
+    __m256d s3 = _mm256_setzero_pd();
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        const __m256d v0 = _mm256_loadu_pd(a + i);
+        const __m256d v1 = _mm256_loadu_pd(a + i + 4);
+        const __m256d v2 = _mm256_loadu_pd(a + i + 8);
+        const __m256d v3 = _mm256_loadu_pd(a + i + 12);
+        s0 = _mm256_fmadd_pd(v0, v0, s0);
+        s1 = _mm256_fmadd_pd(v1, v1, s1);
+        s2 = _mm256_fmadd_pd(v2, v2, s2);
+        s3 = _mm256_fmadd_pd(v3, v3, s3);
+    }
+    const __m256d s =
+        _mm256_add_pd(_mm256_add_pd(s0, s1), _mm256_add_pd(s2, s3));
+    const __m128d half =
+        _mm_add_pd(_mm256_castpd256_pd128(s), _mm256_extractf128_pd(s, 1));
+    double lanes[2];
+    _mm_storeu_pd(lanes, half);
+    double sum = lanes[0] + lanes[1];
+    for (; i < n; ++i) {
+        sum += a[i] * a[i];
+    }
+    return sum;
+}
+
+MATRIXOPS_TARGET("avx2,fma")
+double dot_avx2(const double* a, const double* b, size_t n) {
+    __m256d s0 = _mm256_setzero_pd();
+    __m256d s1 = _mm256_setzero_pd();
+    __m256d s2 = _mm256_setzero_pd();
+    __m256d s3 = _mm256_setzero_pd();
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        s0 = _mm256_fmadd_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i),
+                             s0);
+        s1 = _mm256_fmadd_pd(_mm256_loadu_pd(a + i + 4),
+                             _mm256_loadu_pd(b + i + 4), s1);
+        s2 = _mm256_fmadd_pd(_mm256_loadu_pd(a + i + 8),
+                             _mm256_loadu_pd(b + i + 8), s2);
+        s3 = _mm256_fmadd_pd(_mm256_loadu_pd(a + i + 12),
+                             _mm256_loadu_pd(b + i + 12), s3);
+    }
+    const __m256d s =
+        _mm256_add_pd(_mm256_add_pd(s0, s1), _mm256_add_pd(s2, s3));
+    const __m128d half =
+        _mm_add_pd(_mm256_castpd256_pd128(s), _mm256_extractf128_pd(s, 1));
+    double lanes[2];
+    _mm_storeu_pd(lanes, half);
+    double sum = lanes[0] + lanes[1];
+    for (; i < n; ++i) {
+        sum += a[i] * b[i];
+    }
+    return sum;
+}
+
+MATRIXOPS_TARGET("avx2,fma")
+void axpy_avx2(double alpha, const double* x, double* y, size_t n) {
+    const __m256d s = _mm256_set1_pd(alpha);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        _mm256_storeu_pd(y + i, _mm256_fmadd_pd(s, _mm256_loadu_pd(x + i),
+                                                _mm256_loadu_pd(y + i)));
+        _mm256_storeu_pd(y + i + 4,
+                         _mm256_fmadd_pd(s, _mm256_loadu_pd(x + i + 4),
+                                         _mm256_loadu_pd(y + i + 4)));
+    }
+    for (; i < n; ++i) {
+        y[i] += alpha * x[i];
+    }
+}
+
+MATRIXOPS_TARGET("avx2,fma")
+void gemm_micro_avx2(size_t kc, double alpha, const double* a,
+                     const double* b, double* c, size_t ldc, size_t mr,
+                     size_t nr) {
+    constexpr size_t MR = 4;
+    constexpr size_t NR = 8;
+    __m256d acc[MR][2];
+    for (size_t i = 0; i < MR; ++i) {
+        acc[i][0] = _mm256_setzero_pd();
+        acc[i][1] = _mm256_setzero_pd();
+    }
+    for (size_t p = 0; p < kc; ++p) {
+        const __m256d b0 = _mm256_loadu_pd(b);
+        const __m256d b1 = _mm256_loadu_pd(b + 4);
+        for (size_t i = 0; i < MR; ++i) {
+            const __m256d a_ip = _mm256_broadcast_sd(a + i);
+            acc[i][0] = _mm256_fmadd_pd(a_ip, b0, acc[i][0]);
+            acc[i][1] = _mm256_fmadd_pd(a_ip, b1, acc[i][1]);
+        }
+        a += MR;
+        b += NR;
+    }
+    if (mr == MR && nr == NR) {
+        const __m256d s = _mm256_set1_pd(alpha);
+        for (size_t i = 0; i < MR; ++i) {
+            double* c_row = c + i * ldc;
+            _mm256_storeu_pd(c_row, _mm256_fmadd_pd(s, acc[i][0],
+                                                    _mm256_loadu_pd(c_row)));
+            _mm256_storeu_pd(c_row + 4,
+                             _mm256_fmadd_pd(s, acc[i][1],
+                                             _mm256_loadu_pd(c_row + 4)));
+        }
+        return;
+    }
+    double tile[MR * NR];
+    for (size_t i = 0; i < MR; ++i) {
+        _mm256_storeu_pd(tile + i * NR, acc[i][0]);
+        _mm256_storeu_pd(tile + i * NR + 4, acc[i][1]);
+    }
+    store_tile(tile, NR, alpha, c, ldc, mr, nr);
+}
+
+MATRIXOPS_TARGET("avx2,fma")
+void transpose_micro_avx2(const double* src, size_t lds, double* dst,
+                          size_t ldd) {
+    const __m256d r0 = _mm256_loadu_pd(src);
+    const __m256d r1 = _mm256_loadu_pd(src + lds);
+    const __m256d r2 = _mm256_loadu_pd(src + 2 * lds);
+    const __m256d r3 = _mm256_loadu_pd(src + 3 * lds);
+    // Interleave pairs of rows within each 128-bit lane, then swap lanes.
+    const __m256d t0 = _mm256_unpacklo_pd(r0, r1);
+    const __m256d t1 = _mm256_unpackhi_pd(r0, r1);
+    const __m256d t2 = _mm256_unpacklo_pd(r2, r3);
+    const __m256d t3 = _mm256_unpackhi_pd(r2, r3);
+    _mm256_storeu_pd(dst, _mm256_permute2f128_pd(t0, t2, 0x20));
+    _mm256_storeu_pd(dst + ldd, _mm256_permute2f128_pd(t1, t3, 0x20));
+    _mm256_storeu_pd(dst + 2 * ldd, _mm256_permute2f128_pd(t0, t2, 0x31));
+    _mm256_storeu_pd(dst + 3 * ldd, _mm256_permute2f128_pd(t1, t3, 0x31));
+}
+
+MATRIXOPS_TARGET("avx2,fma")
+void add_avx2(const float* a, const float* b, float* out, size_t n) {
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        _mm256_storeu_ps(out + i, _mm256_add_ps(_mm256_loadu_ps(a + i),
+                                                _mm256_loadu_ps(b + i)));
+        _mm256_storeu_ps(out + i + 8,
+                         _mm256_add_ps(_mm256_loadu_ps(a + i + 8),
+                                       _mm256_loadu_ps(b + i + 8)));
+    }
+    for (; i < n; ++i) {
+        out[i] = a[i] + b[i];
+    }
+}
+
+MATRIXOPS_TARGET("avx2,fma")
+void scale_avx2(const float* a, float scalar, float* out, size_t n) {
+    const __m256 s = _mm256_set1_ps(scalar);
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        _mm256_storeu_ps(out + i, _mm256_mul_ps(_mm256_loadu_ps(a + i), s));
+        _mm256_storeu_ps(out + i + 8,
+                         _mm256_mul_ps(_mm256_loadu_ps(a + i + 8), s));
+    }
+    for (; i < n; ++i) {
+        out[i] = a[i] * scalar;
+    }
+}
+
+MATRIXOPS_TARGET("avx2,fma")
+double sum_squares_avx2(const float* a, size_t n) {
+    __m256d s0 = _mm256_setzero_pd();
+    __m256d s1 = _mm256_setzero_pd();
+    __m256d s2 = _mm256_setzero_pd();
+    __m256d s3 = _mm256_setzero_pd();
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        const __m256d v0 = _mm256_cvtps_pd(_mm_loadu_ps(a + i));
+        const __m256d v1 = _mm256_cvtps_pd(_mm_loadu_ps(a + i + 4));
+        const __m256d v2 = _mm256_cvtps_pd(_mm_loadu_ps(a + i + 8));
+        const __m256d v3 = _mm256_cvtps_pd(_mm_loadu_ps(a + i + 12));
+        s0 = _mm256_fmadd_pd(v0, v0, s0);
+        s1 = _mm256_fmadd_pd(v1, v1, s1);
+        s2 = _mm256_fmadd_pd(v2, v2, s2);
+        s3 = _mm256_fmadd_pd(v3, v3, s3);
+    }
+    const __m256d s =
+        _mm256_add_pd(_mm256_add_pd(s0, s1), _mm256_add_pd(s2, s3));
+    const __m128d half =
+        _mm_add_pd(_mm256_castpd256_pd128(s), _mm256_extractf128_pd(s, 1));
+    double lanes[2];
+    _mm_storeu_pd(lanes, half);
+    double sum = lanes[0] + lanes[1];
+    for (; i < n; ++i) {
+        const double v = a[i];
+        sum += v * v;
+    }
+    return sum;
+}
+
+MATRIXOPS_TARGET("avx2,fma")
+float dot_avx2(const float* a, const float* b, size_t n) {
+    __m256 s0 = _mm256_setzero_ps();
+    __m256 s1 = _mm256_setzero_ps();
+    __m256 s2 = _mm256_setzero_ps();
+    __m256 s3 = _mm256_setzero_ps();
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        s0 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i),
+                             s0);
+        s1 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i + 8),
+                             _mm256_loadu_ps(b + i + 8), s1);
+        s2 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i + 16),
+                             _mm256_loadu_ps(b + i + 16), s2);
+        s3 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i + 24),
+                             _mm256_loadu_ps(b + i + 24), s3);
+    }
+    const __m256 s =
+        _mm256_add_ps(_mm256_add_ps(s0, s1), _mm256_add_ps(s2, s3));
+    float lanes[8];
+    _mm256_storeu_ps(lanes, s);
+    float sum = ((lanes[0] + lanes[1]) + (lanes[2] + lanes[3])) +
+                ((lanes[4] + lanes[5]) + (lanes[6] + lanes[7]));
+    for (; i < n; ++i) {
+        sum += a[i] * b[i];
+    }
+    return sum;
+}
+
+MATRIXOPS_TARGET("avx2,fma")
+void axpy_avx2(float alpha, const float* x, float* y, size_t n) {
+    const __m256 s = _mm256_set1_ps(alpha);
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        _mm256_storeu_ps(y + i, _mm256_fmadd_ps(s, _mm256_loadu_ps(x + i),
+                                                _mm256_loadu_ps(y + i)));
+        _mm256_storeu_ps(y + i + 8,
+                         _mm256_fmadd_ps(s, _mm256_loadu_ps(x + i + 8),
+                                         _mm256_loadu_ps(y + i + 8)));
+    }
+    for (; i < n; ++i) {
+        y[i] += alpha * x[i];
+    }
+}
+
+MATRIXOPS_TARGET("avx2,fma")
+void gemm_micro_avx2(size_t kc, float alpha, const float* a, const float* b,
+                     float* c, size_t ldc, size_t mr, size_t nr) {
+    constexpr size_t MR = 4;
+    constexpr size_t NR = 16;
+    __m256 acc[MR][2];
+    for (size_t i = 0; i < MR; ++i) {
+        acc[i][0] = _mm256_setzero_ps();
+        acc[i][1] = _mm256_setzero_ps();
+    }
+    for (size_t p = 0; p < kc; ++p) {
+        const __m256 b0 = _mm256_loadu_ps(b);
+        const __m256 b1 = _mm256_loadu_ps(b + 8);
+        for (size_t i = 0; i < MR; ++i) {
+            const __m256 a_ip = _mm256_broadcast_ss(a + i);
+            acc[i][0] = _mm256_fmadd_ps(a_ip, b0, acc[i][0]);
+            acc[i][1] = _mm256_fmadd_ps(a_ip, b1, acc[i][1]);
+        }
+        a += MR;
+        b += NR;
+    }
+    if (mr == MR && nr == NR) {
+        const __m256 s = _mm256_set1_ps(alpha);
+        for (size_t i = 0; i < MR; ++i) {
+            float* c_row = c + i * ldc;
+            _mm256_storeu_ps(c_row, _mm256_fmadd_ps(s, acc[i][0],
+                                                    _mm256_loadu_ps(c_row)));
+            _mm256_storeu_ps(c_row + 8,
+                             _mm256_fmadd_ps(s, acc[i][1],
+                                             _mm256_loadu_ps(c_row + 8)));
+        }
+        return;
+    }
+    float tile[MR * NR];
+    for (size_t i = 0; i < MR; ++i) {
+        _mm256_storeu_ps(tile + i * NR, acc[i][0]);
+        _mm256_storeu_ps(tile + i * NR + 8, acc[i][1]);
+    }
+    store_tile(tile, NR, alpha, c, ldc, mr, nr);
+}
+
+// c = alpha * acc + beta * c for one register of a batch product.
+MATRIXOPS_TARGET("avx2,fma")
+void store_batch_avx2(double* out, __m256d acc, __m256d va,
+                      __m256d vb, double beta) {
+    const __m256d scaled = _mm256_mul_pd(va, acc);
+    if (beta == 0.0) {
+        _mm256_storeu_pd(out, scaled);
+    } else {
+        const __m256d old = _mm256_loadu_pd(out);
+        _mm256_storeu_pd(out, _mm256_fmadd_pd(vb, old, scaled));
+    }
+}
+
+// Batched GEMM on one group of interleaved matrices (see batch.h): the
+// same element of every matrix in the group fills 2 registers, and
+// 4 columns of C are accumulated per pass over k.
+MATRIXOPS_TARGET("avx2,fma")
+void gemm_batch_avx2(size_t m, size_t n, size_t k, double alpha,
+                     const double* a, const double* b, double beta,
+                     double* c) {
+    constexpr size_t L = 8;
+    constexpr size_t W = 4;
+    constexpr size_t R = L / W;
+    constexpr size_t NB = 4;
+    const __m256d va = _mm256_set1_pd(alpha);
+    const __m256d vb = _mm256_set1_pd(beta);
+    for (size_t i = 0; i < m; ++i) {
+        const double* a_row = a + i * k * L;
+        double* c_row = c + i * n * L;
+        size_t j = 0;
+        for (; j + NB <= n; j += NB) {
+            __m256d acc[NB][R];
+            for (size_t q = 0; q < NB; ++q) {
+                for (size_t r = 0; r < R; ++r) {
+                    acc[q][r] = _mm256_setzero_pd();
+                }
+            }
+            for (size_t p = 0; p < k; ++p) {
+                const double* a_ip = a_row + p * L;
+                const double* b_p = b + (p * n + j) * L;
+                for (size_t r = 0; r < R; ++r) {
+                    const __m256d a_r = _mm256_loadu_pd(a_ip + r * W);
+                    for (size_t q = 0; q < NB; ++q) {
+                        const __m256d b_qr =
+                            _mm256_loadu_pd(b_p + q * L + r * W);
+                        acc[q][r] = _mm256_fmadd_pd(a_r, b_qr, acc[q][r]);
+                    }
+                }
+            }
+            for (size_t q = 0; q < NB; ++q) {
+                double* c_q = c_row + (j + q) * L;
+                for (size_t r = 0; r < R; ++r) {
+                    store_batch_avx2(c_q + r * W, acc[q][r], va, vb, beta);
+                }
+            }
+        }
+        for (; j < n; ++j) {
+            __m256d acc[R];
+            for (size_t r = 0; r < R; ++r) {
+                acc[r] = _mm256_setzero_pd();
+            }
+            for (size_t p = 0; p < k; ++p) {
+                const double* a_ip = a_row + p * L;
+                const double* b_pj = b + (p * n + j) * L;
+                for (size_t r = 0; r < R; ++r) {
+                    const __m256d a_r = _mm256_loadu_pd(a_ip + r * W);
+                    const __m256d b_r = _mm256_loadu_pd(b_pj + r * W);
+                    acc[r] = _mm256_fmadd_pd(a_r, b_r, acc[r]);
+                }
+            }
+            for (size_t r = 0; r < R; ++r) {
+                store_batch_avx2(c_row + j * L + r * W, acc[r], va, vb, beta);
+            }
+        }
+    }
+}
+
+MATRIXOPS_TARGET("avx2,fma")
+void store_batch_avx2(float* out, __m256 acc, __m256 va,
+                      __m256 vb, float beta) {
+    const __m256 scaled = _mm256_mul_ps(va, acc);
+    if (beta == 0.0F) {
+        _mm256_storeu_ps(out, scaled);
+    } else {
+        const __m256 old = _mm256_loadu_ps(out);
+        _mm256_storeu_ps(out, _mm256_fmadd_ps(vb, old, scaled));
+    }
+}
+
+MATRIXOPS_TARGET("avx2,fma")
+void gemm_batch_avx2(size_t m, size_t n, size_t k, float alpha,
+                     const float* a, const float* b, float beta,
+                     float* c) {
+    constexpr size_t L = 16;
+    constexpr size_t W = 8;
+    constexpr size_t R = L / W;
+    constexpr size_t NB = 4;
+    const __m256 va = _mm256_set1_ps(alpha);
+    const __m256 vb = _mm256_set1_ps(beta);
+    for (size_t i = 0; i < m; ++i) {
+        const float* a_row = a + i * k * L;
+        float* c_row = c + i * n * L;
+        size_t j = 0;
+        for (; j + NB <= n; j += NB) {
+            __m256 acc[NB][R];
+            for (size_t q = 0; q < NB; ++q) {
+                for (size_t r = 0; r < R; ++r) {
+                    acc[q][r] = _mm256_setzero_ps();
+                }
+            }
+            for (size_t p = 0; p < k; ++p) {
+                const float* a_ip = a_row + p * L;
+                const float* b_p = b + (p * n + j) * L;
+                for (size_t r = 0; r < R; ++r) {
+                    const __m256 a_r = _mm256_loadu_ps(a_ip + r * W);
+                    for (size_t q = 0; q < NB; ++q) {
+                        const __m256 b_qr =
+                            _mm256_loadu_ps(b_p + q * L + r * W);
+                        acc[q][r] = _mm256_fmadd_ps(a_r, b_qr, acc[q][r]);
+                    }
+                }
+            }
+            for (size_t q = 0; q < NB; ++q) {
+                float* c_q = c_row + (j + q) * L;
+                for (size_t r = 0; r < R; ++r) {
+                    store_batch_avx2(c_q + r * W, acc[q][r], va, vb, beta);
+                }
+            }
+        }
+        for (; j < n; ++j) {
+            __m256 acc[R];
+            for (size_t r = 0; r < R; ++r) {
+                acc[r] = _mm256_setzero_ps();
+            }
+            for (size_t p = 0; p < k; ++p) {
+                const float* a_ip = a_row + p * L;
+                const float* b_pj = b + (p * n + j) * L;
+                for (size_t r = 0; r < R; ++r) {
+                    const __m256 a_r = _mm256_loadu_ps(a_ip + r * W);
+                    const __m256 b_r = _mm256_loadu_ps(b_pj + r * W);
+                    acc[r] = _mm256_fmadd_ps(a_r, b_r, acc[r]);
+                }
+            }
+            for (size_t r = 0; r < R; ++r) {
+                store_batch_avx2(c_row + j * L + r * W, acc[r], va, vb, beta);
+            }
+        }
+    }
+}
+
+const Kernels AVX2_KERNELS = {
+    SimdIsa::AVX2,
+    {add_avx2,
+     scale_avx2,
+     sum_squares_avx2,
+     dot_avx2,
+     axpy_avx2,
+     {4, 8, gemm_micro_avx2},
+     gemm_batch_avx2},
+    {add_avx2,
+     scale_avx2,
+     sum_squares_avx2,
+     dot_avx2,
+     axpy_avx2,
+     {4, 16, gemm_micro_avx2},
+     gemm_batch_avx2},
+    4,
+    transpose_micro_avx2};
+
+// ---------------------------------------------------------------------------
+// AVX-512F
+// ---------------------------------------------------------------------------
+
+MATRIXOPS_TARGET("avx512f")
+void add_avx512(const double* a, const double* b, double* out, size_t n) {
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        _mm512_storeu_pd(out + i, _mm512_add_pd(_mm512_loadu_pd(a + i),
+                                                _mm512_loadu_pd(b + i)));
+    }
+    if (i < n) {
+        const __mmask8 mask = static_cast<__mmask8>((1U << (n - i)) - 1U);
+        const __m512d sum = _mm512_add_pd(_mm512_maskz_loadu_pd(mask, a + i),
+                                          _mm512_maskz_loadu_pd(mask, b + i));
+        _mm512_mask_storeu_pd(out + i, mask, sum);
+    }
+}
+
+MATRIXOPS_TARGET("avx512f")
+void scale_avx512(const double* a, double scalar, double* out, size_t n) {
+    const __m512d s = _mm512_set1_pd(scalar);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        _mm512_storeu_pd(out + i, _mm512_mul_pd(_mm512_loadu_pd(a + i), s));
+    }
+    if (i < n) {
+        const __mmask8 mask = static_cast<__mmask8>((1U << (n - i)) - 1U);
+        const __m512d v = _mm512_maskz_loadu_pd(mask, a + i);
+        _mm512_mask_storeu_pd(out + i, mask, _mm512_mul_pd(v, s));
+    }
+}
+
+MATRIXOPS_TARGET("avx512f")
+double sum_squares_avx512(const double* a, size_t n) {
+    __m512d s0 = _mm512_setzero_pd();
+    __m512d s1 = _mm512_setzero_pd();
+    __m512d s2 = _mm512_setzero_pd();
+    __m512d s3 = _mm512_setzero_pd();
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        const __m512d v0 = _mm512_loadu_pd(a + i);
+        const __m512d v1 = _mm512_loadu_pd(a + i + 8);
+        const __m512d v2 = _mm512_loadu_pd(a + i + 16);
+        const __m512d v3 = _mm512_loadu_pd(a + i + 24);
+        s0 = _mm512_fmadd_pd(v0, v0, s0);
+        s1 = _mm512_fmadd_pd(v1, v1, s1);
+        s2 = _mm512_fmadd_pd(v2, v2, s2);
+        s3 = _mm512_fmadd_pd(v3, v3, s3);
+    }
+    for (; i + 8 <= n; i += 8) {
+        const __m512d v = _mm512_loadu_pd(a + i);
+        s0 = _mm512_fmadd_pd(v, v, s0);
+    }
+    if (i < n) {
+        const __mmask8 mask = static_cast<__mmask8>((1U << (n - i)) - 1U);
+        const __m512d v = _mm512_maskz_loadu_pd(mask, a + i);
+        s1 = _mm512_fmadd_pd(v, v, s1);
+    }
+    // _mm512_reduce_add_pd trips -Wuninitialized in some GCC headers.
+    double lanes[8];
+    _mm512_storeu_pd(lanes, _mm512_add_pd(_mm512_add_pd(s0, s1),
+                                          _mm512_add_pd(s2, s3)));
+    return ((lanes[0] + lanes[1]) + (lanes[2] + lanes[3])) +
+           ((lanes[4] + lanes[5]) + (lanes[6] + lanes[7]));
+}
+
+MATRIXOPS_TARGET("avx512f")
+double dot_avx512(const double* a, const double* b, size_t n) {
+    __m512d s0 = _mm512_setzero_pd();
+    __m512d s1 = _mm512_setzero_pd();
+    __m512d s2 = _mm512_setzero_pd();
+    __m512d s3 = _mm512_setzero_pd();
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        s0 = _mm512_fmadd_pd(_mm512_loadu_pd(a + i), _mm512_loadu_pd(b + i),
+                             s0);
+        s1 = _mm512_fmadd_pd(_mm512_loadu_pd(a + i + 8),
+                             _mm512_loadu_pd(b + i + 8), s1);
+        s2 = _mm512_fmadd_pd(_mm512_loadu_pd(a + i + 16),
+                             _mm512_loadu_pd(b + i + 16), s2);
+        s3 = _mm512_fmadd_pd(_mm512_loadu_pd(a + i + 24),
+                             _mm512_loadu_pd(b + i + 24), s3);
+    }
+    for (; i + 8 <= n; i += 8) {
+        s0 = _mm512_fmadd_pd(_mm512_loadu_pd(a + i), _mm512_loadu_pd(b + i),
+                             s0);
+    }
+    if (i < n) {
+        const __mmask8 mask = static_cast<__mmask8>((1U << (n - i)) - 1U);
+        s1 = _mm512_fmadd_pd(_mm512_maskz_loadu_pd(mask, a + i),
+                             _mm512_maskz_loadu_pd(mask, b + i), s1);
+    }
+    double lanes[8];
+    _mm512_storeu_pd(lanes, _mm512_add_pd(_mm512_add_pd(s0, s1),
+                                          _mm512_add_pd(s2, s3)));
+    return ((lanes[0] + lanes[1]) + (lanes[2] + lanes[3])) +
+           ((lanes[4] + lanes[5]) + (lanes[6] + lanes[7]));
+}
+
+MATRIXOPS_TARGET("avx512f")
+void axpy_avx512(double alpha, const double* x, double* y, size_t n) {
+    const __m512d s = _mm512_set1_pd(alpha);
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        _mm512_storeu_pd(y + i, _mm512_fmadd_pd(s, _mm512_loadu_pd(x + i),
+                                                _mm512_loadu_pd(y + i)));
+        _mm512_storeu_pd(y + i + 8,
+                         _mm512_fmadd_pd(s, _mm512_loadu_pd(x + i + 8),
+                                         _mm512_loadu_pd(y + i + 8)));
+    }
+    for (; i < n; i += 8) {
+        const size_t left = n - i < 8 ? n - i : 8;
+        const __mmask8 mask = static_cast<__mmask8>((1U << left) - 1U);
+        _mm512_mask_storeu_pd(
+            y + i, mask,
+            _mm512_fmadd_pd(s, _mm512_maskz_loadu_pd(mask, x + i),
+                            _mm512_maskz_loadu_pd(mask, y + i)));
+    }
+}
+
+MATRIXOPS_TARGET("avx512f")
+void gemm_micro_avx512(size_t kc, double alpha, const double* a,
+                       const double* b, double* c, size_t ldc, size_t mr,
+                       size_t nr) {
+    constexpr size_t MR = 8;
+    constexpr size_t NR = 8;
+    __m512d acc[MR];
+    for (size_t i = 0; i < MR; ++i) {
+        acc[i] = _mm512_setzero_pd();
+    }
+    for (size_t p = 0; p < kc; ++p) {
+        const __m512d b0 = _mm512_loadu_pd(b);
+        for (size_t i = 0; i < MR; ++i) {
+            acc[i] = _mm512_fmadd_pd(_mm512_set1_pd(a[i]), b0, acc[i]);
+        }
+        a += MR;
+        b += NR;
+    }
+    if (mr == MR && nr == NR) {
+        const __m512d s = _mm512_set1_pd(alpha);
+        for (size_t i = 0; i < MR; ++i) {
+            double* c_row = c + i * ldc;
+            const __m512d c_old = _mm512_loadu_pd(c_row);
+            _mm512_storeu_pd(c_row, _mm512_fmadd_pd(s, acc[i], c_old));
+        }
+        return;
+    }
+    double tile[MR * NR];
+    for (size_t i = 0; i < MR; ++i) {
+        _mm512_storeu_pd(tile + i * NR, acc[i]);
+    }
+    store_tile(tile, NR, alpha, c, ldc, mr, nr);
+}
+
+MATRIXOPS_TARGET("avx512f")
+void transpose_micro_avx512(const double* src, size_t lds, double* dst,
+                            size_t ldd) {
+    // Three butterfly stages exchanging 1, 2 and 4-element groups, all
+    // with two-source permutes: GCC 12 flags the unpack and shuffle
+    // intrinsics with -Wuninitialized (see sum_squares_avx512).
+    const __m512i lo1 = _mm512_set_epi64(14, 6, 12, 4, 10, 2, 8, 0);
+    const __m512i hi1 = _mm512_set_epi64(15, 7, 13, 5, 11, 3, 9, 1);
+    const __m512i lo2 = _mm512_set_epi64(13, 12, 5, 4, 9, 8, 1, 0);
+    const __m512i hi2 = _mm512_set_epi64(15, 14, 7, 6, 11, 10, 3, 2);
+    const __m512i lo4 = _mm512_set_epi64(11, 10, 9, 8, 3, 2, 1, 0);
+    const __m512i hi4 = _mm512_set_epi64(15, 14, 13, 12, 7, 6, 5, 4);
+
+    const __m512d r0 = _mm512_loadu_pd(src);
+    const __m512d r1 = _mm512_loadu_pd(src + lds);
+    const __m512d r2 = _mm512_loadu_pd(src + 2 * lds);
+    const __m512d r3 = _mm512_loadu_pd(src + 3 * lds);
+    const __m512d r4 = _mm512_loadu_pd(src + 4 * lds);
+    const __m512d r5 = _mm512_loadu_pd(src + 5 * lds);
+    const __m512d r6 = _mm512_loadu_pd(src + 6 * lds);
+    const __m512d r7 = _mm512_loadu_pd(src + 7 * lds);
+
+    const __m512d t0 = _mm512_permutex2var_pd(r0, lo1, r1);
+    const __m512d t1 = _mm512_permutex2var_pd(r0, hi1, r1);
+    const __m512d t2 = _mm512_permutex2var_pd(r2, lo1, r3);
+    const __m512d t3 = _mm512_permutex2var_pd(r2, hi1, r3);
+    const __m512d t4 = _mm512_permutex2var_pd(r4, lo1, r5);
+    const __m512d t5 = _mm512_permutex2var_pd(r4, hi1, r5);
+    const __m512d t6 = _mm512_permutex2var_pd(r6, lo1, r7);
+    const __m512d t7 = _mm512_permutex2var_pd(r6, hi1, r7);
+
+    const __m512d u0 = _mm512_permutex2var_pd(t0, lo2, t2);
+    const __m512d u1 = _mm512_permutex2var_pd(t1, lo2, t3);
+    const __m512d u2 = _mm512_permutex2var_pd(t0, hi2, t2);
+    const __m512d u3 = _mm512_permutex2var_pd(t1, hi2, t3);
+    const __m512d u4 = _mm512_permutex2var_pd(t4, lo2, t6);
+    const __m512d u5 = _mm512_permutex2var_pd(t5, lo2, t7);
+    const __m512d u6 = _mm512_permutex2var_pd(t4, hi2, t6);
+    const __m512d u7 = _mm512_permutex2var_pd(t5, hi2, t7);
+
+    _mm512_storeu_pd(dst, _mm512_permutex2var_pd(u0, lo4, u4));
+    _mm512_storeu_pd(dst + ldd, _mm512_permutex2var_pd(u1, lo4, u5));
+    _mm512_storeu_pd(dst + 2 * ldd, _mm512_permutex2var_pd(u2, lo4, u6));
+    _mm512_storeu_pd(dst + 3 * ldd, _mm512_permutex2var_pd(u3, lo4, u7));
+    _mm512_storeu_pd(dst + 4 * ldd, _mm512_permutex2var_pd(u0, hi4, u4));
+    _mm512_storeu_pd(dst + 5 * ldd, _mm512_permutex2var_pd(u1, hi4, u5));
+    _mm512_storeu_pd(dst + 6 * ldd, _mm512_permutex2var_pd(u2, hi4, u6));
+    _mm512_storeu_pd(dst + 7 * ldd, _mm512_permutex2var_pd(u3, hi4, u7));
+}
+
+MATRIXOPS_TARGET("avx512f")
+void add_avx512(const float* a, const float* b, float* out, size_t n) {
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        _mm512_storeu_ps(out + i, _mm512_add_ps(_mm512_loadu_ps(a + i),
+                                                _mm512_loadu_ps(b + i)));
+    }
+    if (i < n) {
+        const __mmask16 mask = static_cast<__mmask16>((1U << (n - i)) - 1U);
+        const __m512 sum = _mm512_add_ps(_mm512_maskz_loadu_ps(mask, a + i),
+                                         _mm512_maskz_loadu_ps(mask, b + i));
+        _mm512_mask_storeu_ps(out + i, mask, sum);
+    }
+}
+
+MATRIXOPS_TARGET("avx512f")
+void scale_avx512(const float* a, float scalar, float* out, size_t n) {
+    const __m512 s = _mm512_set1_ps(scalar);
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        _mm512_storeu_ps(out + i, _mm512_mul_ps(_mm512_loadu_ps(a + i), s));
+    }
+    if (i < n) {
+        const __mmask16 mask = static_cast<__mmask16>((1U << (n - i)) - 1U);
+        const __m512 v = _mm512_maskz_loadu_ps(mask, a + i);
+        _mm512_mask_storeu_ps(out + i, mask, _mm512_mul_ps(v, s));
+    }
+}
+
+MATRIXOPS_TARGET("avx512f")
+double sum_squares_avx512(const float* a, size_t n) {
+    // The zero-masked conversion, because the plain one also trips
+    // -Wuninitialized in GCC 12.
+    const __mmask8 all = 0xFF;
+    __m512d s0 = _mm512_setzero_pd();
+    __m512d s1 = _mm512_setzero_pd();
+    __m512d s2 = _mm512_setzero_pd();
+    __m512d s3 = _mm512_setzero_pd();
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        const __m512d v0 =
+            _mm512_maskz_cvtps_pd(all, _mm256_loadu_ps(a + i));
+        const __m512d v1 = _mm512_maskz_cvtps_pd(
+            all, _mm256_loadu_ps(a + i + 8));
+        const __m512d v2 = _mm512_maskz_cvtps_pd(
+            all, _mm256_loadu_ps(a + i + 16));
+        const __m512d v3 = _mm512_maskz_cvtps_pd(
+            all, _mm256_loadu_ps(a + i + 24));
+        s0 = _mm512_fmadd_pd(v0, v0, s0);
+        s1 = _mm512_fmadd_pd(v1, v1, s1);
+        s2 = _mm512_fmadd_pd(v2, v2, s2);
+        s3 = _mm512_fmadd_pd(v3, v3, s3);
+    }
+    for (; i + 8 <= n; i += 8) {
+        const __m512d v =
+            _mm512_maskz_cvtps_pd(all, _mm256_loadu_ps(a + i));
+        s0 = _mm512_fmadd_pd(v, v, s0);
+    }
+    double lanes[8];
+    _mm512_storeu_pd(lanes, _mm512_add_pd(_mm512_add_pd(s0, s1),
+                                          _mm512_add_pd(s2, s3)));
+    double sum = ((lanes[0] + lanes[1]) + (lanes[2] + lanes[3])) +
+                 ((lanes[4] + lanes[5]) + (lanes[6] + lanes[7]));
+    for (; i < n; ++i) {
+        const double v = a[i];
+        sum += v * v;
+    }
+    return sum;
+}
+
+MATRIXOPS_TARGET("avx512f")
+float dot_avx512(const float* a, const float* b, size_t n) {
+    __m512 s0 = _mm512_setzero_ps();
+    __m512 s1 = _mm512_setzero_ps();
+    __m512 s2 = _mm512_setzero_ps();
+    __m512 s3 = _mm512_setzero_ps();
+    size_t i = 0;
+    for (; i + 64 <= n; i += 64) {
+        s0 = _mm512_fmadd_ps(_mm512_loadu_ps(a + i), _mm512_loadu_ps(b + i),
+                             s0);
+        s1 = _mm512_fmadd_ps(_mm512_loadu_ps(a + i + 16),
+                             _mm512_loadu_ps(b + i + 16), s1);
+        s2 = _mm512_fmadd_ps(_mm512_loadu_ps(a + i + 32),
+                             _mm512_loadu_ps(b + i + 32), s2);
+        s3 = _mm512_fmadd_ps(_mm512_loadu_ps(a + i + 48),
+                             _mm512_loadu_ps(b + i + 48), s3);
+    }
+    for (; i + 16 <= n; i += 16) {
+        s0 = _mm512_fmadd_ps(_mm512_loadu_ps(a + i), _mm512_loadu_ps(b + i),
+                             s0);
+    }
+    if (i < n) {
+        const __mmask16 mask = static_cast<__mmask16>((1U << (n - i)) - 1U);
+        s1 = _mm512_fmadd_ps(_mm512_maskz_loadu_ps(mask, a + i),
+                             _mm512_maskz_loadu_ps(mask, b + i), s1);
+    }
+    float lanes[16];
+    _mm512_storeu_ps(lanes, _mm512_add_ps(_mm512_add_ps(s0, s1),
+                                          _mm512_add_ps(s2, s3)));
+    float sum = 0.0F;
+    for (float lane : lanes) {
+        sum += lane;
+    }
+    return sum;
+}
+
+MATRIXOPS_TARGET("avx512f")
+void axpy_avx512(float alpha, const float* x, float* y, size_t n) {
+    const __m512 s = _mm512_set1_ps(alpha);
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        _mm512_storeu_ps(y + i, _mm512_fmadd_ps(s, _mm512_loadu_ps(x + i),
+                                                _mm512_loadu_ps(y + i)));
+        _mm512_storeu_ps(y + i + 16,
+                         _mm512_fmadd_ps(s, _mm512_loadu_ps(x + i + 16),
+                                         _mm512_loadu_ps(y + i + 16)));
+    }
+    for (; i < n; i += 16) {
+        const size_t left = n - i < 16 ? n - i : 16;
+        const __mmask16 mask = static_cast<__mmask16>((1U << left) - 1U);
+        _mm512_mask_storeu_ps(
+            y + i, mask,
+            _mm512_fmadd_ps(s, _mm512_maskz_loadu_ps(mask, x + i),
+                            _mm512_maskz_loadu_ps(mask, y + i)));
+    }
+}
+
+MATRIXOPS_TARGET("avx512f")
+void gemm_micro_avx512(size_t kc, float alpha, const float* a,
+                       const float* b, float* c, size_t ldc, size_t mr,
+                       size_t nr) {
+    constexpr size_t MR = 8;
+    constexpr size_t NR = 16;
+    __m512 acc[MR];
+    for (size_t i = 0; i < MR; ++i) {
+        acc[i] = _mm512_setzero_ps();
+    }
+    for (size_t p = 0; p < kc; ++p) {
+        const __m512 b0 = _mm512_loadu_ps(b);
+        for (size_t i = 0; i < MR; ++i) {
+            acc[i] = _mm512_fmadd_ps(_mm512_set1_ps(a[i]), b0, acc[i]);
+        }
+        a += MR;
+        b += NR;
+    }
+    if (mr == MR && nr == NR) {
+        const __m512 s = _mm512_set1_ps(alpha);
+        for (size_t i = 0; i < MR; ++i) {
+            float* c_row = c + i * ldc;
+            const __m512 c_old = _mm512_loadu_ps(c_row);
+            _mm512_storeu_ps(c_row, _mm512_fmadd_ps(s, acc[i], c_old));
+        }
+        return;
+    }
+    float tile[MR * NR];
+    for (size_t i = 0; i < MR; ++i) {
+        _mm512_storeu_ps(tile + i * NR, acc[i]);
+    }
+    store_tile(tile, NR, alpha, c, ldc, mr, nr);
+}
+
+// c = alpha * acc + beta * c for one register of a batch product.
+MATRIXOPS_TARGET("avx512f")
+void store_batch_avx512(double* out, __m512d acc, __m512d va,
+                        __m512d vb, double beta) {
+    const __m512d scaled = _mm512_mul_pd(va, acc);
+    if (beta == 0.0) {
+        _mm512_storeu_pd(out, scaled);
+    } else {
+        const __m512d old = _mm512_loadu_pd(out);
+        _mm512_storeu_pd(out, _mm512_fmadd_pd(vb, old, scaled));
+    }
+}
+
+// Batched GEMM on one group of interleaved matrices (see batch.h): the
+// same element of every matrix in the group fills one register, and
+// 8 columns of C are accumulated per pass over k.
+MATRIXOPS_TARGET("avx512f")
+void gemm_batch_avx512(size_t m, size_t n, size_t k, double alpha,
+                       const double* a, const double* b, double beta,
+                       double* c) {
+    constexpr size_t L = 8;
+    constexpr size_t W = 8;
+    constexpr size_t R = L / W;
+    constexpr size_t NB = 8;
+    const __m512d va = _mm512_set1_pd(alpha);
+    const __m512d vb = _mm512_set1_pd(beta);
+    for (size_t i = 0; i < m; ++i) {
+        const double* a_row = a + i * k * L;
+        double* c_row = c + i * n * L;
+        size_t j = 0;
+        for (; j + NB <= n; j += NB) {
+            __m512d acc[NB][R];
+            for (size_t q = 0; q < NB; ++q) {
+                for (size_t r = 0; r < R; ++r) {
+                    acc[q][r] = _mm512_setzero_pd();
+                }
+            }
+            for (size_t p = 0; p < k; ++p) {
+                const double* a_ip = a_row + p * L;
+                const double* b_p = b + (p * n + j) * L;
+                for (size_t r = 0; r < R; ++r) {
+                    const __m512d a_r = _mm512_loadu_pd(a_ip + r * W);
+                    for (size_t q = 0; q < NB; ++q) {
+                        const __m512d b_qr =
+                            _mm512_loadu_pd(b_p + q * L + r * W);
+                        acc[q][r] = _mm512_fmadd_pd(a_r, b_qr, acc[q][r]);
+                    }
+                }
+            }
+            for (size_t q = 0; q < NB; ++q) {
+                double* c_q = c_row + (j + q) * L;
+                for (size_t r = 0; r < R; ++r) {
+                    store_batch_avx512(c_q + r * W, acc[q][r], va, vb, beta);
+                }
+            }
+        }
+        for (; j < n; ++j) {
+            __m512d acc[R];
+            for (size_t r = 0; r < R; ++r) {
+                acc[r] = _mm512_setzero_pd();
+            }
+            for (size_t p = 0; p < k; ++p) {
+                const double* a_ip = a_row + p * L;
+                const double* b_pj = b + (p * n + j) * L;
+                for (size_t r = 0; r < R; ++r) {
+                    const __m512d a_r = _mm512_loadu_pd(a_ip + r * W);
+                    const __m512d b_r = _mm512_loadu_pd(b_pj + r * W);
+                    acc[r] = _mm512_fmadd_pd(a_r, b_r, acc[r]);
+                }
+            }
+            for (size_t r = 0; r < R; ++r) {
+                store_batch_avx512(c_row + j * L + r * W, acc[r], va, vb, beta);
+            }
+        }
+    }
+}
+
+MATRIXOPS_TARGET("avx512f")
+void store_batch_avx512(float* out, __m512 acc, __m512 va,
+                        __m512 vb, float beta) {
+    const __m512 scaled = _mm512_mul_ps(va, acc);
+    if (beta == 0.0F) {
+        _mm512_storeu_ps(out, scaled);
+    } else {
+        const __m512 old = _mm512_loadu_ps(out);
+        _mm512_storeu_ps(out, _mm512_fmadd_ps(vb, old, scaled));
+    }
+}
+
+MATRIXOPS_TARGET("avx512f")
+void gemm_batch_avx512(size_t m, size_t n, size_t k, float alpha,
+                       const float* a, const float* b, float beta,
+                       float* c) {
+    constexpr size_t L = 16;
+    constexpr size_t W = 16;
+    constexpr size_t R = L / W;
+    constexpr size_t NB = 8;
+    const __m512 va = _mm512_set1_ps(alpha);
+    const __m512 vb = _mm512_set1_ps(beta);
+    for (size_t i = 0; i < m; ++i) {
+        const float* a_row = a + i * k * L;
+        float* c_row = c + i * n * L;
+        size_t j = 0;
+        for (; j + NB <= n; j += NB) {
+            __m512 acc[NB][R];
+            for (size_t q = 0; q < NB; ++q) {
+                for (size_t r = 0; r < R; ++r) {
+                    acc[q][r] = _mm512_setzero_ps();
+                }
+            }
+            for (size_t p = 0; p < k; ++p) {
+                const float* a_ip = a_row + p * L;
+                const float* b_p = b + (p * n + j) * L;
+                for (size_t r = 0; r < R; ++r) {
+                    const __m512 a_r = _mm512_loadu_ps(a_ip + r * W);
+                    for (size_t q = 0; q < NB; ++q) {
+                        const __m512 b_qr =
+                            _mm512_loadu_ps(b_p + q * L + r * W);
+                        acc[q][r] = _mm512_fmadd_ps(a_r, b_qr, acc[q][r]);
+                    }
+                }
+            }
+            for (size_t q = 0; q < NB; ++q) {
+                float* c_q = c_row + (j + q) * L;
+                for (size_t r = 0; r < R; ++r) {
+                    store_batch_avx512(c_q + r * W, acc[q][r], va, vb, beta);
+                }
+            }
+        }
+        for (; j < n; ++j) {
+            __m512 acc[R];
+            for (size_t r = 0; r < R; ++r) {
+                acc[r] = _mm512_setzero_ps();
+            }
+            for (size_t p = 0; p < k; ++p) {
+                const float* a_ip = a_row + p * L;
+                const float* b_pj = b + (p * n + j) * L;
+                for (size_t r = 0; r < R; ++r) {
+                    const __m512 a_r = _mm512_loadu_ps(a_ip + r * W);
+                    const __m512 b_r = _mm512_loadu_ps(b_pj + r * W);
+                    acc[r] = _mm512_fmadd_ps(a_r, b_r, acc[r]);
+                }
+            }
+            for (size_t r = 0; r < R; ++r) {
+                store_batch_avx512(c_row + j * L + r * W, acc[r], va, vb, beta);
+            }
+        }
+    }
+}
+
+const Kernels AVX512_KERNELS = {
+    SimdIsa::AVX512,
+    {add_avx512,
+     scale_avx512,
+     sum_squares_avx512,
+     dot_avx512,
+     axpy_avx512,
+     {8, 8, gemm_micro_avx512},
+     gemm_batch_avx512},
+    {add_avx512,
+     scale_avx512,
+     sum_squares_avx512,
+     dot_avx512,
+     axpy_avx512,
+     {8, 16, gemm_micro_avx512},
+     gemm_batch_avx512},
+    8,
+    transpose_micro_avx512};
+
+#if defined(_MSC_VER) && !defined(__clang__)
+bool msvc_cpu_supports(SimdIsa isa) {
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) {
+        return false;
+    }
+    __cpuid(info, 1);
+    const bool osxsave = (info[2] & (1 << 27)) != 0;
+    const bool fma = (info[2] & (1 << 12)) != 0;
+    if (!osxsave) {
+        return false;
+    }
+    const unsigned long long xcr0 = _xgetbv(0);
+    __cpuidex(info, 7, 0);
+    if (isa == SimdIsa::AVX2) {
+        return fma && (info[1] & (1 << 5)) != 0 && (xcr0 & 0x6) == 0x6;
+    }
+    return (info[1] & (1 << 16)) != 0 && (xcr0 & 0xE6) == 0xE6;
+}
+#endif
+
+#elif defined(MATRIXOPS_ARCH_ARM64)
+
+// ---------------------------------------------------------------------------
+// NEON (mandatory on AArch64, so no runtime check is needed)
+// ---------------------------------------------------------------------------
+
+void add_neon(const double* a, const double* b, double* out, size_t n) {
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        vst1q_f64(out + i, vaddq_f64(vld1q_f64(a + i), vld1q_f64(b + i)));
+        vst1q_f64(out + i + 2,
+                  vaddq_f64(vld1q_f64(a + i + 2), vld1q_f64(b + i + 2)));
+    }
+    for (; i < n; ++i) {
+        out[i] = a[i] + b[i];
+    }
+}
+
+void scale_neon(const double* a, double scalar, double* out, size_t n) {
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        vst1q_f64(out + i, vmulq_n_f64(vld1q_f64(a + i), scalar));
+        vst1q_f64(out + i + 2, vmulq_n_f64(vld1q_f64(a + i + 2), scalar));
+    }
+    for (; i < n; ++i) {
+        out[i] = a[i] * scalar;
+    }
+}
+
+double sum_squares_neon(const double* a, size_t n) {
+    float64x2_t s0 = vdupq_n_f64(0.0);
+    float64x2_t s1 = vdupq_n_f64(0.0);
+    float64x2_t s2 = vdupq_n_f64(0.0);
+    float64x2_t s3 = vdupq_n_f64(0.0);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        const float64x2_t v0 = vld1q_f64(a + i);
+        const float64x2_t v1 = vld1q_f64(a + i + 2);
+        const float64x2_t v2 = vld1q_f64(a + i + 4);
+        const float64x2_t v3 = vld1q_f64(a + i + 6);
+        s0 = vfmaq_f64(s0, v0, v0);
+        s1 = vfmaq_f64(s1, v1, v1);
+        s2 = vfmaq_f64(s2, v2, v2);
+        s3 = vfmaq_f64(s3, v3, v3);
+    }
+    double sum = vaddvq_f64(vaddq_f64(vaddq_f64(s0, s1), vaddq_f64(s2, s3)));
+    for (; i < n; ++i) {
+        sum += a[i] * a[i];
+    }
+    return sum;
+}
+
+double dot_neon(const double* a, const double* b, size_t n) {
+    float64x2_t s0 = vdupq_n_f64(0.0);
+    float64x2_t s1 = vdupq_n_f64(0.0);
+    float64x2_t s2 = vdupq_n_f64(0.0);
+    float64x2_t s3 = vdupq_n_f64(0.0);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        s0 = vfmaq_f64(s0, vld1q_f64(a + i), vld1q_f64(b + i));
+        s1 = vfmaq_f64(s1, vld1q_f64(a + i + 2), vld1q_f64(b + i + 2));
+        s2 = vfmaq_f64(s2, vld1q_f64(a + i + 4), vld1q_f64(b + i + 4));
+        s3 = vfmaq_f64(s3, vld1q_f64(a + i + 6), vld1q_f64(b + i + 6));
+    }
+    double sum = vaddvq_f64(vaddq_f64(vaddq_f64(s0, s1), vaddq_f64(s2, s3)));
+    for (; i < n; ++i) {
+        sum += a[i] * b[i];
+    }
+    return sum;
+}
+
+void axpy_neon(double alpha, const double* x, double* y, size_t n) {
+    const float64x2_t s = vdupq_n_f64(alpha);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        vst1q_f64(y + i, vfmaq_f64(vld1q_f64(y + i), s, vld1q_f64(x + i)));
+        vst1q_f64(y + i + 2,
+                  vfmaq_f64(vld1q_f64(y + i + 2), s, vld1q_f64(x + i + 2)));
+    }
+    for (; i < n; ++i) {
+        y[i] += alpha * x[i];
+    }
+}
+
+void gemm_micro_neon(size_t kc, double alpha, const double* a,
+                     const double* b, double* c, size_t ldc, size_t mr,
+                     size_t nr) {
+    constexpr size_t MR = 4;
+    constexpr size_t NR = 8;
+    float64x2_t acc[MR][4];
+    for (size_t i = 0; i < MR; ++i) {
+        for (size_t j = 0; j < 4; ++j) {
+            acc[i][j] = vdupq_n_f64(0.0);
+        }
+    }
+    for (size_t p = 0; p < kc; ++p) {
+        const float64x2_t b0 = vld1q_f64(b);
+        const float64x2_t b1 = vld1q_f64(b + 2);
+        const float64x2_t b2 = vld1q_f64(b + 4);
+        const float64x2_t b3 = vld1q_f64(b + 6);
+        for (size_t i = 0; i < MR; ++i) {
+            acc[i][0] = vfmaq_n_f64(acc[i][0], b0, a[i]);
+            acc[i][1] = vfmaq_n_f64(acc[i][1], b1, a[i]);
+            acc[i][2] = vfmaq_n_f64(acc[i][2], b2, a[i]);
+            acc[i][3] = vfmaq_n_f64(acc[i][3], b3, a[i]);
+        }
+        a += MR;
+        b += NR;
+    }
+    double tile[MR * NR];
+    for (size_t i = 0; i < MR; ++i) {
+        for (size_t j = 0; j < 4; ++j) {
+            vst1q_f64(tile + i * NR + 2 * j, acc[i][j]);
+        }
+    }
+    store_tile(tile, NR, alpha, c, ldc, mr, nr);
+}
+
+// 4x4 tile as four 2x2 register transposes.
+void transpose_micro_neon(const double* src, size_t lds, double* dst,
+                          size_t ldd) {
+    for (size_t i = 0; i < 4; i += 2) {
+        for (size_t j = 0; j < 4; j += 2) {
+            const float64x2_t r0 = vld1q_f64(src + i * lds + j);
+            const float64x2_t r1 = vld1q_f64(src + (i + 1) * lds + j);
+            vst1q_f64(dst + j * ldd + i, vtrn1q_f64(r0, r1));
+            vst1q_f64(dst + (j + 1) * ldd + i, vtrn2q_f64(r0, r1));
+        }
+    }
+}
+
+void add_neon(const float* a, const float* b, float* out, size_t n) {
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        vst1q_f32(out + i, vaddq_f32(vld1q_f32(a + i), vld1q_f32(b + i)));
+        vst1q_f32(out + i + 4,
+                  vaddq_f32(vld1q_f32(a + i + 4), vld1q_f32(b + i + 4)));
+    }
+    for (; i < n; ++i) {
+        out[i] = a[i] + b[i];
+    }
+}
+
+void scale_neon(const float* a, float scalar, float* out, size_t n) {
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        vst1q_f32(out + i, vmulq_n_f32(vld1q_f32(a + i), scalar));
+        vst1q_f32(out + i + 4, vmulq_n_f32(vld1q_f32(a + i + 4), scalar));
+    }
+    for (; i < n; ++i) {
+        out[i] = a[i] * scalar;
+    }
+}
+
+double sum_squares_neon(const float* a, size_t n) {
+    float64x2_t s0 = vdupq_n_f64(0.0);
+    float64x2_t s1 = vdupq_n_f64(0.0);
+    float64x2_t s2 = vdupq_n_f64(0.0);
+    float64x2_t s3 = vdupq_n_f64(0.0);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        const float32x4_t v0 = vld1q_f32(a + i);
+        const float32x4_t v1 = vld1q_f32(a + i + 4);
+        const float64x2_t d0 = vcvt_f64_f32(vget_low_f32(v0));
+        const float64x2_t d1 = vcvt_high_f64_f32(v0);
+        const float64x2_t d2 = vcvt_f64_f32(vget_low_f32(v1));
+        const float64x2_t d3 = vcvt_high_f64_f32(v1);
+        s0 = vfmaq_f64(s0, d0, d0);
+        s1 = vfmaq_f64(s1, d1, d1);
+        s2 = vfmaq_f64(s2, d2, d2);
+        s3 = vfmaq_f64(s3, d3, d3);
+    }
+    double sum = vaddvq_f64(vaddq_f64(vaddq_f64(s0, s1), vaddq_f64(s2, s3)));
+    for (; i < n; ++i) {
+        const double v = a[i];
+        sum += v * v;
+    }
+    return sum;
+}
+
+float dot_neon(const float* a, const float* b, size_t n) {
+    float32x4_t s0 = vdupq_n_f32(0.0F);
+    float32x4_t s1 = vdupq_n_f32(0.0F);
+    float32x4_t s2 = vdupq_n_f32(0.0F);
+    float32x4_t s3 = vdupq_n_f32(0.0F);
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        s0 = vfmaq_f32(s0, vld1q_f32(a + i), vld1q_f32(b + i));
+        s1 = vfmaq_f32(s1, vld1q_f32(a + i + 4), vld1q_f32(b + i + 4));
+        s2 = vfmaq_f32(s2, vld1q_f32(a + i + 8), vld1q_f32(b + i + 8));
+        s3 = vfmaq_f32(s3, vld1q_f32(a + i + 12), vld1q_f32(b + i + 12));
+    }
+    float sum = vaddvq_f32(vaddq_f32(vaddq_f32(s0, s1), vaddq_f32(s2, s3)));
+    for (; i < n; ++i) {
+        sum += a[i] * b[i];
+    }
+    return sum;
+}
+
+void axpy_neon(float alpha, const float* x, float* y, size_t n) {
+    const float32x4_t s = vdupq_n_f32(alpha);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        vst1q_f32(y + i, vfmaq_f32(vld1q_f32(y + i), s, vld1q_f32(x + i)));
+        vst1q_f32(y + i + 4,
+                  vfmaq_f32(vld1q_f32(y + i + 4), s, vld1q_f32(x + i + 4)));
+    }
+    for (; i < n; ++i) {
+        y[i] += alpha * x[i];
+    }
+}
+
+void gemm_micro_neon(size_t kc, float alpha, const float* a, const float* b,
+                     float* c, size_t ldc, size_t mr, size_t nr) {
+    constexpr size_t MR = 4;
+    constexpr size_t NR = 16;
+    float32x4_t acc[MR][4];
+    for (size_t i = 0; i < MR; ++i) {
+        for (size_t j = 0; j < 4; ++j) {
+            acc[i][j] = vdupq_n_f32(0.0F);
+        }
+    }
+    for (size_t p = 0; p < kc; ++p) {
+        const float32x4_t b0 = vld1q_f32(b);
+        const float32x4_t b1 = vld1q_f32(b + 4);
+        const float32x4_t b2 = vld1q_f32(b + 8);
+        const float32x4_t b3 = vld1q_f32(b + 12);
+        for (size_t i = 0; i < MR; ++i) {
+            acc[i][0] = vfmaq_n_f32(acc[i][0], b0, a[i]);
+            acc[i][1] = vfmaq_n_f32(acc[i][1], b1, a[i]);
+            acc[i][2] = vfmaq_n_f32(acc[i][2], b2, a[i]);
+            acc[i][3] = vfmaq_n_f32(acc[i][3], b3, a[i]);
+        }
+        a += MR;
+        b += NR;
+    }
+    float tile[MR * NR];
+    for (size_t i = 0; i < MR; ++i) {
+        for (size_t j = 0; j < 4; ++j) {
+            vst1q_f32(tile + i * NR + 4 * j, acc[i][j]);
+        }
+    }
+    store_tile(tile, NR, alpha, c, ldc, mr, nr);
+}
+
+// c = alpha * acc + beta * c for one register of a batch product.
+void store_batch_neon(double* out, float64x2_t acc, float64x2_t va,
+                      float64x2_t vb, double beta) {
+    const float64x2_t scaled = vmulq_f64(va, acc);
+    if (beta == 0.0) {
+        vst1q_f64(out, scaled);
+    } else {
+        const float64x2_t old = vld1q_f64(out);
+        vst1q_f64(out, vfmaq_f64(scaled, vb, old));
+    }
+}
+
+// Batched GEMM on one group of interleaved matrices (see batch.h): the
+// same element of every matrix in the group fills 4 registers, and
+// 4 columns of C are accumulated per pass over k.
+void gemm_batch_neon(size_t m, size_t n, size_t k, double alpha,
+                     const double* a, const double* b, double beta,
+                     double* c) {
+    constexpr size_t L = 8;
+    constexpr size_t W = 2;
+    constexpr size_t R = L / W;
+    constexpr size_t NB = 4;
+    const float64x2_t va = vdupq_n_f64(alpha);
+    const float64x2_t vb = vdupq_n_f64(beta);
+    for (size_t i = 0; i < m; ++i) {
+        const double* a_row = a + i * k * L;
+        double* c_row = c + i * n * L;
+        size_t j = 0;
+        for (; j + NB <= n; j += NB) {
+            float64x2_t acc[NB][R];
+            for (size_t q = 0; q < NB; ++q) {
+                for (size_t r = 0; r < R; ++r) {
+                    acc[q][r] = vdupq_n_f64(0.0);
+                }
+            }
+            for (size_t p = 0; p < k; ++p) {
+                const double* a_ip = a_row + p * L;
+                const double* b_p = b + (p * n + j) * L;
+                for (size_t r = 0; r < R; ++r) {
+                    const float64x2_t a_r = vld1q_f64(a_ip + r * W);
+                    for (size_t q = 0; q < NB; ++q) {
+                        const float64x2_t b_qr = vld1q_f64(b_p + q * L + r * W);
+                        acc[q][r] = vfmaq_f64(acc[q][r], a_r, b_qr);
+                    }
+                }
+            }
+            for (size_t q = 0; q < NB; ++q) {
+                double* c_q = c_row + (j + q) * L;
+                for (size_t r = 0; r < R; ++r) {
+                    store_batch_neon(c_q + r * W, acc[q][r], va, vb, beta);
+                }
+            }
+        }
+        for (; j < n; ++j) {
+            float64x2_t acc[R];
+            for (size_t r = 0; r < R; ++r) {
+                acc[r] = vdupq_n_f64(0.0);
+            }
+            for (size_t p = 0; p < k; ++p) {
+                const double* a_ip = a_row + p * L;
+                const double* b_pj = b + (p * n + j) * L;
+                for (size_t r = 0; r < R; ++r) {
+                    const float64x2_t a_r = vld1q_f64(a_ip + r * W);
+                    const float64x2_t b_r = vld1q_f64(b_pj + r * W);
+                    acc[r] = vfmaq_f64(acc[r], a_r, b_r);
+                }
+            }
+            for (size_t r = 0; r < R; ++r) {
+                store_batch_neon(c_row + j * L + r * W, acc[r], va, vb, beta);
+            }
+        }
+    }
+}
+
+void store_batch_neon(float* out, float32x4_t acc, float32x4_t va,
+                      float32x4_t vb, float beta) {
+    const float32x4_t scaled = vmulq_f32(va, acc);
+    if (beta == 0.0F) {
+        vst1q_f32(out, scaled);
+    } else {
+        const float32x4_t old = vld1q_f32(out);
+        vst1q_f32(out, vfmaq_f32(scaled, vb, old));
+    }
+}
+
+void gemm_batch_neon(size_t m, size_t n, size_t k, float alpha,
+                     const float* a, const float* b, float beta,
+                     float* c) {
+    constexpr size_t L = 16;
+    constexpr size_t W = 4;
+    constexpr size_t R = L / W;
+    constexpr size_t NB = 4;
+    const float32x4_t va = vdupq_n_f32(alpha);
+    const float32x4_t vb = vdupq_n_f32(beta);
+    for (size_t i = 0; i < m; ++i) {
+        const float* a_row = a + i * k * L;
+        float* c_row = c + i * n * L;
+        size_t j = 0;
+        for (; j + NB <= n; j += NB) {
+            float32x4_t acc[NB][R];
+            for (size_t q = 0; q < NB; ++q) {
+                for (size_t r = 0; r < R; ++r) {
+                    acc[q][r] = vdupq_n_f32(0.0F);
+                }
+            }
+            for (size_t p = 0; p < k; ++p) {
+                const float* a_ip = a_row + p * L;
+                const float* b_p = b + (p * n + j) * L;
+                for (size_t r = 0; r < R; ++r) {
+                    const float32x4_t a_r = vld1q_f32(a_ip + r * W);
+                    for (size_t q = 0; q < NB; ++q) {
+                        const float32x4_t b_qr = vld1q_f32(b_p + q * L + r * W);
+                        acc[q][r] = vfmaq_f32(acc[q][r], a_r, b_qr);
+                    }
+                }
+            }
+            for (size_t q = 0; q < NB; ++q) {
+                float* c_q = c_row + (j + q) * L;
+                for (size_t r = 0; r < R; ++r) {
+                    store_batch_neon(c_q + r * W, acc[q][r], va, vb, beta);
+                }
+            }
+        }
+        for (; j < n; ++j) {
+            float32x4_t acc[R];
+            for (size_t r = 0; r < R; ++r) {
+                acc[r] = vdupq_n_f32(0.0F);
+            }
+            for (size_t p = 0; p < k; ++p) {
+                const float* a_ip = a_row + p * L;
+                const float* b_pj = b + (p * n + j) * L;
+                for (size_t r = 0; r < R; ++r) {
+                    const float32x4_t a_r = vld1q_f32(a_ip + r * W);
+                    const float32x4_t b_r = vld1q_f32(b_pj + r * W);
+                    acc[r] = vfmaq_f32(acc[r], a_r, b_r);
+                }
+            }
+            for (size_t r = 0; r < R; ++r) {
+                store_batch_neon(c_row + j * L + r * W, acc[r], va, vb, beta);
+            }
+        }
+    }
+}
+
+const Kernels NEON_KERNELS = {
+    SimdIsa::NEON,
+    {add_neon,
+     scale_neon,
+     sum_squares_neon,
+     dot_neon,
+     axpy_neon,
+     {4, 8, gemm_micro_neon},
+     gemm_batch_neon},
+    {add_neon,
+     scale_neon,
+     sum_squares_neon,
+     dot_neon,
+     axpy_neon,
+     {4, 16, gemm_micro_neon},
+     gemm_batch_neon},
+    4,
+    transpose_micro_neon};
+
+#endif
+
+bool cpu_supports(SimdIsa isa) {
+    switch (isa) {
+    case SimdIsa::SCALAR:
+        return true;
+#if defined(MATRIXOPS_ARCH_X86)
+    case SimdIsa::SSE2:
+        return true;
+#if defined(_MSC_VER) && !defined(__clang__)
+    case SimdIsa::AVX2:
+    case SimdIsa::AVX512:
+        return msvc_cpu_supports(isa);
+#else
+    case SimdIsa::AVX2:
+        return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+    case SimdIsa::AVX512:
+        return __builtin_cpu_supports("avx512f");
+#endif
+#elif defined(MATRIXOPS_ARCH_ARM64)
+    case SimdIsa::NEON:
+        return true;
+#endif
+    default:
+        return false;
+    }
+}
+
+const Kernels& kernels_for(SimdIsa isa) {
+    switch (isa) {
+#if defined(MATRIXOPS_ARCH_X86)
+    case SimdIsa::SSE2:
+        return SSE2_KERNELS;
+    case SimdIsa::AVX2:
+        return AVX2_KERNELS;
+    case SimdIsa::AVX512:
+        return AVX512_KERNELS;
+#elif defined(MATRIXOPS_ARCH_ARM64)
+    case SimdIsa::NEON:
+        return NEON_KERNELS;
+#endif
+    default:
+        return SCALAR_KERNELS;
+    }
+}
+
+// Candidates from widest to narrowest.
+const SimdIsa PREFERENCE_ORDER[] = {SimdIsa::AVX512, SimdIsa::AVX2,
+                                    SimdIsa::NEON, SimdIsa::SSE2,
+                                    SimdIsa::SCALAR};
+
+SimdIsa select_isa() {
+    const std::string cap = get_env("MATRIXOPS_SIMD");
+    bool allowed = cap.empty();
+    for (SimdIsa isa : PREFERENCE_ORDER) {
+        allowed = allowed || cap == simd_isa_name(isa);
+        if (allowed && cpu_supports(isa)) {
+            return isa;
+        }
+    }
+    return SimdIsa::SCALAR;
+}
+
+std::atomic<const Kernels*> active_kernels{nullptr};
+
+// Resolve the dispatch during static initialization instead of on the
+// first kernel call.
+[[maybe_unused]] const Kernels& LOAD_TIME_KERNELS = kernels();
+
+} // namespace
+
+const Kernels& kernels() {
+    const Kernels* active = active_kernels.load(std::memory_order_acquire);
+    if (active == nullptr) {
+        active = &kernels_for(select_isa());
+        active_kernels.store(active, std::memory_order_release);
+    }
+    return *active;
+}
+
+} // namespace detail
+
+SimdIsa simd_isa() { return detail::kernels().isa; }
+
+bool simd_isa_supported(SimdIsa isa) { return detail::cpu_supports(isa); }
+
+void set_simd_isa(SimdIsa isa) {
+    if (!detail::cpu_supports(isa)) {
+        throw std::invalid_argument(
+            "SIMD instruction set not supported on this host");
+    }
+    detail::active_kernels.store(&detail::kernels_for(isa),
+                                 std::memory_order_release);
+}
+
+const char* simd_isa_name(SimdIsa isa) {
+    switch (isa) {
+    case SimdIsa::SCALAR:
+        return "scalar";
+    case SimdIsa::SSE2:
+        return "sse2";
+    case SimdIsa::AVX2:
+        return "avx2";
+    case SimdIsa::AVX512:
+        return "avx512";
+    case SimdIsa::NEON:
+        return "neon";
+    }
+    return "unknown";
+}
+
+} // namespace matrixops
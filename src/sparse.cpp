@@ -0,0 +1,529 @@
+#include "matrixops/sparse.h"
+#include "matrixops/parallel.h"
+#include <algorithm>
+#include <numeric>
+#include <stdexcept>
+
+#include "portable_kernels.h"
+#include "reduction.h"
+
+namespace matrixops {
+
+namespace {
+
+// Nonzeros per task in the products, comparable to ELEMENTWISE_GRAIN:
+// each entry costs one multiply-add and a gather.
+constexpr size_t SPARSE_GRAIN = size_t{1} << 15;
+
+// Compressed arrays under construction, in either layout.
+template <typename T>
+struct Compressed {
+    std::vector<size_t> offsets;
+    std::vector<size_t> indices;
+    std::vector<T> values;
+};
+
+// Counting sort of triplets on their major index into major_size slices;
+// the entries of each slice keep their input order.
+template <typename T>
+Compressed<T> compress(size_t major_size, const std::vector<size_t>& major,
+                       const std::vector<size_t>& minor,
+                       const std::vector<T>& values) {
+    const size_t n = values.size();
+    Compressed<T> out;
+    out.offsets.assign(major_size + 1, 0);
+    for (size_t m : major) {
+        ++out.offsets[m + 1];
+    }
+    std::partial_sum(out.offsets.begin(), out.offsets.end(),
+                     out.offsets.begin());
+
+    out.indices.resize(n);
+    out.values.resize(n);
+    std::vector<size_t> next(out.offsets.begin(), out.offsets.end() - 1);
+    for (size_t k = 0; k < n; ++k) {
+        const size_t p = next[major[k]]++;
+        out.indices[p] = minor[k];
+        out.values[p] = values[k];
+    }
+    return out;
+}
+
+// Swap the roles of the outer and inner indices of compressed arrays. The
+// slices are visited in order, so the inner indices of the result are
+// sorted within each slice, with duplicates next to each other.
+template <typename T>
+Compressed<T> transpose_compressed(size_t outer, size_t inner,
+                                   const size_t* offsets,
+                                   const size_t* indices, const T* values) {
+    const size_t nnz = offsets[outer];
+    Compressed<T> out;
+    out.offsets.assign(inner + 1, 0);
+    for (size_t k = 0; k < nnz; ++k) {
+        ++out.offsets[indices[k] + 1];
+    }
+    std::partial_sum(out.offsets.begin(), out.offsets.end(),
+                     out.offsets.begin());
+
+    out.indices.resize(nnz);
+    out.values.resize(nnz);
+    std::vector<size_t> next(out.offsets.begin(), out.offsets.end() - 1);
+    for (size_t o = 0; o < outer; ++o) {
+        for (size_t k = offsets[o]; k < offsets[o + 1]; ++k) {
+            const size_t p = next[indices[k]]++;
+            out.indices[p] = o;
+            out.values[p] = values[k];
+        }
+    }
+    return out;
+}
+
+// Merge adjacent entries of a slice with the same inner index, in place.
+template <typename T>
+void sum_duplicates(Compressed<T>& c) {
+    const size_t outer = c.offsets.size() - 1;
+    size_t out = 0;
+    size_t begin = 0;
+    for (size_t o = 0; o < outer; ++o) {
+        const size_t end = c.offsets[o + 1];
+        const size_t slice = out;
+        for (size_t k = begin; k < end; ++k) {
+            if (out > slice && c.indices[out - 1] == c.indices[k]) {
+                c.values[out - 1] += c.values[k];
+            } else {
+                c.indices[out] = c.indices[k];
+                c.values[out] = c.values[k];
+                ++out;
+            }
+        }
+        c.offsets[o + 1] = out;
+        begin = end;
+    }
+    c.indices.resize(out);
+    c.values.resize(out);
+}
+
+// First outer slice of chunk c, out of chunks of about the same number of
+// entries: chunk c covers [chunk_begin(c), chunk_begin(c + 1)). Balancing
+// entries rather than slices matters for power-law graphs, where a few
+// rows hold most of the entries.
+size_t chunk_begin(const size_t* offsets, size_t outer, size_t chunk,
+                   size_t chunks) {
+    if (chunk == chunks) {
+        return outer;
+    }
+    const size_t target = offsets[outer] * chunk / chunks;
+    return static_cast<size_t>(
+        std::lower_bound(offsets, offsets + outer, target) - offsets);
+}
+
+// Call body(first, last) over disjoint ranges of outer slices covering
+// all of them, in parallel chunks of about grain entries each.
+template <typename F>
+void for_each_chunk(const size_t* offsets, size_t outer, size_t grain,
+                    const F& body) {
+    const size_t chunks = std::clamp<size_t>(offsets[outer] / grain, 1,
+                                             outer);
+    if (chunks == 1) {
+        body(size_t{0}, outer);
+        return;
+    }
+    parallel_for(0, chunks, 1, [&](size_t lo, size_t hi) {
+        body(chunk_begin(offsets, outer, lo, chunks),
+             chunk_begin(offsets, outer, hi, chunks));
+    });
+}
+
+template <typename T>
+void spmv_csr(const BasicSparseMatrix<T>& a, const T* x, T* y) {
+    const size_t* offsets = a.offsets();
+    const size_t* indices = a.indices();
+    const T* values = a.values();
+    for_each_chunk(offsets, a.rows(), SPARSE_GRAIN,
+                   [&](size_t first, size_t last) {
+                       for (size_t i = first; i < last; ++i) {
+                           T sum(0);
+                           for (size_t k = offsets[i]; k < offsets[i + 1];
+                                ++k) {
+                               detail::multiply_add(sum, values[k],
+                                                    x[indices[k]]);
+                           }
+                           y[i] = sum;
+                       }
+                   });
+}
+
+// Columns scatter into y, so each parallel chunk accumulates into its own
+// copy of y (the first one into y itself) and the copies are summed.
+template <typename T>
+void spmv_csc(const BasicSparseMatrix<T>& a, const T* x, T* y) {
+    const size_t* offsets = a.offsets();
+    const size_t* indices = a.indices();
+    const T* values = a.values();
+    const size_t rows = a.rows();
+    const size_t cols = a.cols();
+    const auto scatter = [&](size_t first, size_t last, T* out) {
+        for (size_t j = first; j < last; ++j) {
+            const T x_j = x[j];
+            for (size_t k = offsets[j]; k < offsets[j + 1]; ++k) {
+                detail::multiply_add(out[indices[k]], values[k], x_j);
+            }
+        }
+    };
+
+    std::fill(y, y + rows, T(0));
+    const size_t chunks = std::min(
+        {std::max<size_t>(a.nnz() / SPARSE_GRAIN, 1), num_threads(), cols});
+    if (chunks == 1) {
+        scatter(0, cols, y);
+        return;
+    }
+
+    std::vector<T> partial((chunks - 1) * rows, T(0));
+    parallel_for(0, chunks, 1, [&](size_t lo, size_t hi) {
+        for (size_t c = lo; c < hi; ++c) {
+            T* out = c == 0 ? y : partial.data() + (c - 1) * rows;
+            scatter(chunk_begin(offsets, cols, c, chunks),
+                    chunk_begin(offsets, cols, c + 1, chunks), out);
+        }
+    });
+    parallel_for(0, rows, detail::ELEMENTWISE_GRAIN, [&](size_t lo,
+                                                         size_t hi) {
+        for (size_t c = 1; c < chunks; ++c) {
+            const T* p = partial.data() + (c - 1) * rows;
+            for (size_t i = lo; i < hi; ++i) {
+                y[i] += p[i];
+            }
+        }
+    });
+}
+
+// Row i of out is the sum of the rows of b selected by row i of a: each
+// entry is a contiguous multiply-add over n elements.
+template <typename T>
+void spmm_csr(const BasicSparseMatrix<T>& a, const BasicMatrix<T>& b,
+              BasicMatrix<T>& out) {
+    const size_t* offsets = a.offsets();
+    const size_t* indices = a.indices();
+    const T* values = a.values();
+    const size_t n = b.cols();
+    const size_t grain = std::max<size_t>(SPARSE_GRAIN / n, 1);
+    for_each_chunk(offsets, a.rows(), grain, [&](size_t first, size_t last) {
+        for (size_t i = first; i < last; ++i) {
+            T* c = out.data() + i * out.stride();
+            std::fill(c, c + n, T(0));
+            for (size_t k = offsets[i]; k < offsets[i + 1]; ++k) {
+                const T v = values[k];
+                const T* b_row = b.data() + indices[k] * b.stride();
+                for (size_t j = 0; j < n; ++j) {
+                    detail::multiply_add(c[j], v, b_row[j]);
+                }
+            }
+        }
+    });
+}
+
+// Columns of a scatter into every row of out, so the work is split over
+// the columns of b and out instead.
+template <typename T>
+void spmm_csc(const BasicSparseMatrix<T>& a, const BasicMatrix<T>& b,
+              BasicMatrix<T>& out) {
+    const size_t* offsets = a.offsets();
+    const size_t* indices = a.indices();
+    const T* values = a.values();
+    const size_t grain = std::max<size_t>(SPARSE_GRAIN / (a.nnz() + 1), 1);
+    parallel_for(0, b.cols(), grain, [&](size_t lo, size_t hi) {
+        for (size_t i = 0; i < out.rows(); ++i) {
+            T* c = out.data() + i * out.stride();
+            std::fill(c + lo, c + hi, T(0));
+        }
+        for (size_t p = 0; p < a.cols(); ++p) {
+            const T* b_row = b.data() + p * b.stride();
+            for (size_t k = offsets[p]; k < offsets[p + 1]; ++k) {
+                const T v = values[k];
+                T* c = out.data() + indices[k] * out.stride();
+                for (size_t j = lo; j < hi; ++j) {
+                    detail::multiply_add(c[j], v, b_row[j]);
+                }
+            }
+        }
+    });
+}
+
+template <typename T>
+void spmv(const BasicSparseMatrix<T>& a, const T* x, T* y) {
+    if (a.layout() == SparseLayout::CSR) {
+        spmv_csr(a, x, y);
+    } else {
+        spmv_csc(a, x, y);
+    }
+}
+
+void check_dimensions(size_t rows, size_t cols) {
+    if (rows == 0 || cols == 0) {
+        throw std::invalid_argument("Matrix dimensions must be positive");
+    }
+}
+
+} // namespace
+
+template <typename T>
+BasicSparseMatrix<T>::BasicSparseMatrix(size_t rows, size_t cols,
+                                        SparseLayout layout)
+    : rows_(rows), cols_(cols), layout_(layout) {
+    check_dimensions(rows, cols);
+    offsets_.assign(outer_size() + 1, 0);
+}
+
+template <typename T>
+BasicSparseMatrix<T>::BasicSparseMatrix(size_t rows, size_t cols,
+                                        SparseLayout layout,
+                                        std::vector<size_t> offsets,
+                                        std::vector<size_t> indices,
+                                        std::vector<T> values)
+    : rows_(rows), cols_(cols), layout_(layout),
+      offsets_(std::move(offsets)), indices_(std::move(indices)),
+      values_(std::move(values)) {
+    check_dimensions(rows, cols);
+    validate();
+}
+
+template <typename T>
+BasicSparseMatrix<T>::BasicSparseMatrix(const BasicMatrix<T>& dense,
+                                        SparseLayout layout)
+    : BasicSparseMatrix(dense.rows(), dense.cols(), layout) {
+    const bool csr = layout_ == SparseLayout::CSR;
+    for (size_t o = 0; o < outer_size(); ++o) {
+        for (size_t in = 0; in < inner_size(); ++in) {
+            const T v = csr ? dense.unchecked(o, in) : dense.unchecked(in, o);
+            if (v != T(0)) {
+                indices_.push_back(in);
+                values_.push_back(v);
+            }
+        }
+        offsets_[o + 1] = values_.size();
+    }
+}
+
+template <typename T>
+void BasicSparseMatrix<T>::validate() const {
+    const size_t outer = outer_size();
+    if (offsets_.size() != outer + 1 || offsets_.front() != 0 ||
+        offsets_.back() != indices_.size() ||
+        indices_.size() != values_.size()) {
+        throw std::invalid_argument(
+            "Sparse matrix offsets do not match the entries");
+    }
+    for (size_t o = 0; o < outer; ++o) {
+        if (offsets_[o + 1] < offsets_[o]) {
+            throw std::invalid_argument(
+                "Sparse matrix offsets do not match the entries");
+        }
+    }
+    for (size_t o = 0; o < outer; ++o) {
+        for (size_t k = offsets_[o]; k < offsets_[o + 1]; ++k) {
+            if (indices_[k] >= inner_size() ||
+                (k > offsets_[o] && indices_[k] <= indices_[k - 1])) {
+                throw std::invalid_argument(
+                    "Sparse matrix indices must be in range and increasing");
+            }
+        }
+    }
+}
+
+template <typename T>
+T BasicSparseMatrix<T>::operator()(size_t i, size_t j) const {
+    if (i >= rows_ || j >= cols_) {
+        throw std::out_of_range("Matrix indices out of range");
+    }
+    const bool csr = layout_ == SparseLayout::CSR;
+    const size_t outer = csr ? i : j;
+    const size_t inner = csr ? j : i;
+    const auto first = indices_.begin() + offsets_[outer];
+    const auto last = indices_.begin() + offsets_[outer + 1];
+    const auto it = std::lower_bound(first, last, inner);
+    if (it == last || *it != inner) {
+        return T(0);
+    }
+    return values_[static_cast<size_t>(it - indices_.begin())];
+}
+
+template <typename T>
+BasicMatrix<T> BasicSparseMatrix<T>::to_dense() const {
+    BasicMatrix<T> result(rows_, cols_);
+    const bool csr = layout_ == SparseLayout::CSR;
+    for (size_t o = 0; o < outer_size(); ++o) {
+        for (size_t k = offsets_[o]; k < offsets_[o + 1]; ++k) {
+            const size_t in = indices_[k];
+            (csr ? result.unchecked(o, in) : result.unchecked(in, o)) =
+                values_[k];
+        }
+    }
+    return result;
+}
+
+template <typename T>
+BasicSparseMatrix<T> BasicSparseMatrix<T>::convert(SparseLayout layout) const {
+    if (layout == layout_) {
+        return *this;
+    }
+    Compressed<T> t = transpose_compressed(outer_size(), inner_size(),
+                                           offsets(), indices(), values());
+    return BasicSparseMatrix(rows_, cols_, layout, std::move(t.offsets),
+                             std::move(t.indices), std::move(t.values));
+}
+
+// The arrays of a matrix in one layout, with outer and inner swapped, are
+// its transpose in the same layout.
+template <typename T>
+BasicSparseMatrix<T> BasicSparseMatrix<T>::transpose() const {
+    Compressed<T> t = transpose_compressed(outer_size(), inner_size(),
+                                           offsets(), indices(), values());
+    return BasicSparseMatrix(cols_, rows_, layout_, std::move(t.offsets),
+                             std::move(t.indices), std::move(t.values));
+}
+
+template <typename T>
+typename BasicSparseMatrix<T>::real_type BasicSparseMatrix<T>::norm() const {
+    return static_cast<real_type>(detail::euclidean_norm(values(), nnz()));
+}
+
+template <typename T>
+std::vector<T> BasicSparseMatrix<T>::operator*(const std::vector<T>& x) const {
+    std::vector<T> y(rows_);
+    multiply_into(*this, x, y);
+    return y;
+}
+
+template <typename T>
+BasicVector<T> BasicSparseMatrix<T>::operator*(
+    const BasicVector<T>& x) const {
+    BasicVector<T> y(rows_, UNINITIALIZED);
+    multiply_into(*this, x, y);
+    return y;
+}
+
+template <typename T>
+BasicMatrix<T> BasicSparseMatrix<T>::operator*(
+    const BasicMatrix<T>& dense) const {
+    BasicMatrix<T> result(rows_, dense.cols(), UNINITIALIZED);
+    multiply_into(*this, dense, result);
+    return result;
+}
+
+template <typename T>
+void multiply_into(const BasicSparseMatrix<T>& a, const std::vector<T>& x,
+                   std::vector<T>& y) {
+    if (x.size() != a.cols()) {
+        throw std::invalid_argument(
+            "Vector size incompatible for multiplication");
+    }
+    if (&x == &y) {
+        throw std::invalid_argument(
+            "Matrix multiplication output must not alias an operand");
+    }
+    y.resize(a.rows());
+    spmv(a, x.data(), y.data());
+}
+
+template <typename T>
+void multiply_into(const BasicSparseMatrix<T>& a, const BasicVector<T>& x,
+                   BasicVector<T>& y) {
+    if (x.size() != a.cols() || y.size() != a.rows()) {
+        throw std::invalid_argument(
+            "Vector size incompatible for multiplication");
+    }
+    if (&x == &y) {
+        throw std::invalid_argument(
+            "Matrix multiplication output must not alias an operand");
+    }
+    spmv(a, x.data(), y.data());
+}
+
+template <typename T>
+void multiply_into(const BasicSparseMatrix<T>& a, const BasicMatrix<T>& b,
+                   BasicMatrix<T>& out) {
+    if (a.cols() != b.rows() || out.rows() != a.rows() ||
+        out.cols() != b.cols()) {
+        throw std::invalid_argument(
+            "Matrix dimensions incompatible for multiplication");
+    }
+    if (&out == &b) {
+        throw std::invalid_argument(
+            "Matrix multiplication output must not alias an operand");
+    }
+    if (a.layout() == SparseLayout::CSR) {
+        spmm_csr(a, b, out);
+    } else {
+        spmm_csc(a, b, out);
+    }
+}
+
+template <typename T>
+BasicSparseBuilder<T>::BasicSparseBuilder(size_t rows, size_t cols)
+    : rows_(rows), cols_(cols) {
+    check_dimensions(rows, cols);
+}
+
+template <typename T>
+void BasicSparseBuilder<T>::reserve(size_t n) {
+    row_indices_.reserve(n);
+    col_indices_.reserve(n);
+    values_.reserve(n);
+}
+
+template <typename T>
+void BasicSparseBuilder<T>::add(size_t i, size_t j, T value) {
+    if (i >= rows_ || j >= cols_) {
+        throw std::out_of_range("Matrix indices out of range");
+    }
+    row_indices_.push_back(i);
+    col_indices_.push_back(j);
+    values_.push_back(value);
+}
+
+template <typename T>
+void BasicSparseBuilder<T>::clear() {
+    row_indices_.clear();
+    col_indices_.clear();
+    values_.clear();
+}
+
+// Sorting on the inner index first, then transposing, leaves the inner
+// indices of each slice sorted without a comparison sort.
+template <typename T>
+BasicSparseMatrix<T> BasicSparseBuilder<T>::build(SparseLayout layout) const {
+    const bool csr = layout == SparseLayout::CSR;
+    const size_t outer = csr ? rows_ : cols_;
+    const size_t inner = csr ? cols_ : rows_;
+    const Compressed<T> by_inner =
+        compress(inner, csr ? col_indices_ : row_indices_,
+                 csr ? row_indices_ : col_indices_, values_);
+    Compressed<T> result =
+        transpose_compressed(inner, outer, by_inner.offsets.data(),
+                             by_inner.indices.data(), by_inner.values.data());
+    sum_duplicates(result);
+    return BasicSparseMatrix<T>(rows_, cols_, layout,
+                                std::move(result.offsets),
+                                std::move(result.indices),
+                                std::move(result.values));
+}
+
+#define MATRIXOPS_INSTANTIATE_SPARSE(T)                                        \
+    template class BasicSparseMatrix<T>;                                       \
+    template class BasicSparseBuilder<T>;                                      \
+    template void multiply_into(const BasicSparseMatrix<T>&,                   \
+                                const std::vector<T>&, std::vector<T>&);       \
+    template void multiply_into(const BasicSparseMatrix<T>&,                   \
+                                const BasicVector<T>&, BasicVector<T>&);       \
+    template void multiply_into(const BasicSparseMatrix<T>&,                   \
+                                const BasicMatrix<T>&, BasicMatrix<T>&);
+
+MATRIXOPS_INSTANTIATE_SPARSE(float)
+MATRIXOPS_INSTANTIATE_SPARSE(double)
+MATRIXOPS_INSTANTIATE_SPARSE(std::complex<float>)
+MATRIXOPS_INSTANTIATE_SPARSE(std::complex<double>)
+
+#undef MATRIXOPS_INSTANTIATE_SPARSE
+
+} // namespace matrixops
@@ -0,0 +1,186 @@
+#include "matrixops/gemm.h"
+
+#include "matrixops/matrix.h"
+#include "matrixops/parallel.h"
+
+#include <algorithm>
+#include <complex>
+#include <functional>
+
+#include "strassen.h"
+#include "workspace.h"
+
+namespace matrixops {
+
+namespace {
+
+// Workspace tag of the temporaries and the product.
+struct StrassenTemporaries;
+
+// out = op(a, b) over a rows x cols block, split across the pool by rows.
+template <typename T, typename Op>
+void combine(size_t rows, size_t cols, const T* a, size_t lda, const T* b,
+             size_t ldb, T* out, size_t ldo, Op op) {
+    const size_t grain =
+        std::max<size_t>(detail::ELEMENTWISE_GRAIN / cols, 1);
+    parallel_for(0, rows, grain, [&](size_t lo, size_t hi) {
+        for (size_t i = lo; i < hi; ++i) {
+            const T* a_row = a + i * lda;
+            const T* b_row = b + i * ldb;
+            T* out_row = out + i * ldo;
+            for (size_t j = 0; j < cols; ++j) {
+                out_row[j] = op(a_row[j], b_row[j]);
+            }
+        }
+    });
+}
+
+template <typename T>
+void add(size_t rows, size_t cols, const T* a, size_t lda, const T* b,
+         size_t ldb, T* out, size_t ldo) {
+    combine(rows, cols, a, lda, b, ldb, out, ldo, std::plus<T>());
+}
+
+template <typename T>
+void sub(size_t rows, size_t cols, const T* a, size_t lda, const T* b,
+         size_t ldb, T* out, size_t ldo) {
+    combine(rows, cols, a, lda, b, ldb, out, ldo, std::minus<T>());
+}
+
+bool recurses(size_t m, size_t n, size_t k, size_t crossover) {
+    return std::min({m, n, k}) > crossover;
+}
+
+// Elements of workspace used by winograd() at this level and below: the
+// temporaries X (an S_i, then P1) and Y (a T_i) of every level.
+size_t workspace_size(size_t m, size_t n, size_t k, size_t crossover) {
+    size_t total = 0;
+    while (recurses(m, n, k, crossover)) {
+        m /= 2;
+        n /= 2;
+        k /= 2;
+        total += m * std::max(k, n) + k * n;
+    }
+    return total;
+}
+
+// C = A * B, overwriting C. The even-sized core uses the schedule of
+// Boyer, Dumas, Pernet and Zhou (ISSAC 2009), which needs only the two
+// temporaries besides the quadrants of C; 7 products and 15 additions.
+template <typename T>
+void winograd(size_t m, size_t n, size_t k, const T* a, size_t lda,
+              const T* b, size_t ldb, T* c, size_t ldc, size_t crossover,
+              T* work) {
+    if (!recurses(m, n, k, crossover)) {
+        gemm(m, n, k, T(1), a, lda, b, ldb, T(0), c, ldc);
+        return;
+    }
+
+    const size_t hm = m / 2;
+    const size_t hn = n / 2;
+    const size_t hk = k / 2;
+    const T* a11 = a;
+    const T* a12 = a + hk;
+    const T* a21 = a + hm * lda;
+    const T* a22 = a21 + hk;
+    const T* b11 = b;
+    const T* b12 = b + hn;
+    const T* b21 = b + hk * ldb;
+    const T* b22 = b21 + hn;
+    T* c11 = c;
+    T* c12 = c + hn;
+    T* c21 = c + hm * ldc;
+    T* c22 = c21 + hn;
+
+    const size_t ldx = std::max(hk, hn);
+    const size_t ldy = hn;
+    T* x = work;
+    T* y = x + hm * ldx;
+    T* next = y + hk * ldy;
+
+    auto multiply = [&](const T* p, size_t ldp, const T* q, size_t ldq,
+                        T* r, size_t ldr) {
+        winograd(hm, hn, hk, p, ldp, q, ldq, r, ldr, crossover, next);
+    };
+
+    sub(hm, hk, a11, lda, a21, lda, x, ldx);     // S3 = A11 - A21
+    sub(hk, hn, b22, ldb, b12, ldb, y, ldy);     // T3 = B22 - B12
+    multiply(x, ldx, y, ldy, c21, ldc);          // P7 = S3 * T3
+    add(hm, hk, a21, lda, a22, lda, x, ldx);     // S1 = A21 + A22
+    sub(hk, hn, b12, ldb, b11, ldb, y, ldy);     // T1 = B12 - B11
+    multiply(x, ldx, y, ldy, c22, ldc);          // P5 = S1 * T1
+    sub(hm, hk, x, ldx, a11, lda, x, ldx);       // S2 = S1 - A11
+    sub(hk, hn, b22, ldb, y, ldy, y, ldy);       // T2 = B22 - T1
+    multiply(x, ldx, y, ldy, c12, ldc);          // P6 = S2 * T2
+    sub(hm, hk, a12, lda, x, ldx, x, ldx);       // S4 = A12 - S2
+    multiply(x, ldx, b22, ldb, c11, ldc);        // P3 = S4 * B22
+    multiply(a11, lda, b11, ldb, x, ldx);        // P1 = A11 * B11
+    add(hm, hn, x, ldx, c12, ldc, c12, ldc);     // U2 = P1 + P6
+    add(hm, hn, c12, ldc, c21, ldc, c21, ldc);   // U3 = U2 + P7
+    add(hm, hn, c12, ldc, c22, ldc, c12, ldc);   // U4 = U2 + P5
+    add(hm, hn, c21, ldc, c22, ldc, c22, ldc);   // U7 = U3 + P5 = C22
+    add(hm, hn, c12, ldc, c11, ldc, c12, ldc);   // U5 = U4 + P3 = C12
+    sub(hk, hn, y, ldy, b21, ldb, y, ldy);       // T4 = T2 - B21
+    multiply(a22, lda, y, ldy, c11, ldc);        // P4 = A22 * T4
+    sub(hm, hn, c21, ldc, c11, ldc, c21, ldc);   // U6 = U3 - P4 = C21
+    multiply(a12, lda, b21, ldb, c11, ldc);      // P2 = A12 * B21
+    add(hm, hn, x, ldx, c11, ldc, c11, ldc);     // U1 = P1 + P2 = C11
+
+    // Peel the odd row, column and depth: O(mn + mk + kn) work.
+    const size_t m2 = 2 * hm;
+    const size_t n2 = 2 * hn;
+    if (k % 2 != 0) {
+        gemm(m2, n2, 1, T(1), a + (k - 1), lda, b + (k - 1) * ldb, ldb, T(1),
+             c, ldc);
+    }
+    if (n % 2 != 0) {
+        gemm(m, 1, k, T(1), a, lda, b + (n - 1), ldb, T(0), c + (n - 1),
+             ldc);
+    }
+    if (m % 2 != 0) {
+        gemm(1, n2, k, T(1), a + (m - 1) * lda, lda, b, ldb, T(0),
+             c + (m - 1) * ldc, ldc);
+    }
+}
+
+} // namespace
+
+namespace detail {
+
+template <typename T>
+void strassen_gemm(size_t m, size_t n, size_t k, T alpha, const T* a,
+                   size_t lda, const T* b, size_t ldb, T beta, T* c,
+                   size_t ldc, size_t crossover) {
+    // A plain product is computed in place; otherwise A * B goes to the
+    // workspace first and is folded into C at the end.
+    const bool direct = alpha == T(1) && beta == T(0);
+    const size_t temporaries = workspace_size(m, n, k, crossover);
+    Workspace<T, StrassenTemporaries> buffer;
+    T* const workspace = buffer.data(temporaries + (direct ? 0 : m * n));
+    T* product = direct ? c : workspace + temporaries;
+    const size_t ldp = direct ? ldc : n;
+
+    winograd(m, n, k, a, lda, b, ldb, product, ldp, crossover, workspace);
+    if (direct) {
+        return;
+    }
+    // beta = 0 must not read C.
+    combine(m, n, product, ldp, c, ldc, c, ldc, [&](T p, T c_ij) {
+        return beta == T(0) ? alpha * p : alpha * p + beta * c_ij;
+    });
+}
+
+#define MATRIXOPS_INSTANTIATE_STRASSEN(T)                                      \
+    template void strassen_gemm(size_t, size_t, size_t, T, const T*, size_t, \
+                                const T*, size_t, T, T*, size_t, size_t);
+
+MATRIXOPS_INSTANTIATE_STRASSEN(float)
+MATRIXOPS_INSTANTIATE_STRASSEN(double)
+MATRIXOPS_INSTANTIATE_STRASSEN(std::complex<float>)
+MATRIXOPS_INSTANTIATE_STRASSEN(std::complex<double>)
+
+#undef MATRIXOPS_INSTANTIATE_STRASSEN
+
+} // namespace detail
+
+} // namespace matrixops
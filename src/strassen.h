@@ -0,0 +1,25 @@
+#pragma once
+
+#include <cstddef>
+
+namespace matrixops {
+namespace detail {
+
+/**
+ * @brief C = alpha * A * B + beta * C by Strassen-Winograd recursion
+ *
+ * Row-major buffers as for gemm(). Each level splits all three dimensions
+ * in half and does 7 half-size products instead of 8; odd dimensions are
+ * peeled off and finished with rank-1 and matrix-vector updates. Products
+ * whose smallest dimension is at most crossover go to gemm(). The
+ * workspace is a per-thread Workspace, reused across calls.
+ */
+template <typename T>
+void strassen_gemm(size_t m, size_t n, size_t k, T alpha, const T* a,
+                   size_t lda, const T* b, size_t ldb, T beta, T* c,
+                   size_t ldc, size_t crossover);
+
+// Instantiated in strassen.cpp for float, double and the complex types.
+
+} // namespace detail
+} // namespace matrixops
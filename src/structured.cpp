@@ -0,0 +1,785 @@
+#include "matrixops/structured.h"
+#include "matrixops/gemm.h"
+#include "matrixops/parallel.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <utility>
+
+#include "instrumentation.h"
+#include "kernels.h"
+#include "portable_kernels.h"
+#include "reduction.h"
+
+namespace matrixops {
+
+namespace {
+
+// Rows or columns of a triangle unpacked per gemm() call: the temporary
+// slab is SLAB x n. Thin slabs skip most of the zero half, at the cost of
+// one packing of the dense operand per slab.
+constexpr size_t SLAB = 256;
+
+// Largest temporary a symmetric matrix, which has no zeros to skip, is
+// unpacked into: whole up to n = 4096 in double, so the dense operand is
+// packed once, and in a few slabs beyond.
+constexpr size_t UNPACK_BYTES = size_t{128} << 20;
+
+// Side of the tiles in which elements past the diagonal, stored down the
+// columns, are unpacked along the rows.
+constexpr size_t TILE = 32;
+
+template <typename T>
+void add_block(const T* a, const T* b, T* out, size_t n) {
+    if constexpr (detail::HAS_SIMD_KERNELS<T>) {
+        detail::typed_kernels<T>().add(a, b, out, n);
+    } else {
+        detail::add_scalar(a, b, out, n);
+    }
+}
+
+template <typename T>
+void scale_block(const T* a, T scalar, T* out, size_t n) {
+    if constexpr (detail::HAS_SIMD_KERNELS<T>) {
+        detail::typed_kernels<T>().scale(a, scalar, out, n);
+    } else {
+        detail::scale_scalar(a, scalar, out, n);
+    }
+}
+
+template <typename T>
+void axpy_block(T alpha, const T* x, T* y, size_t n) {
+    if constexpr (detail::HAS_SIMD_KERNELS<T>) {
+        detail::typed_kernels<T>().axpy(alpha, x, y, n);
+    } else {
+        detail::axpy_scalar(alpha, x, y, n);
+    }
+}
+
+template <typename T>
+T dot_block(const T* a, const T* b, size_t n) {
+    if constexpr (detail::HAS_SIMD_KERNELS<T>) {
+        return detail::typed_kernels<T>().dot(a, b, n);
+    } else {
+        return detail::dot_scalar(a, b, n);
+    }
+}
+
+template <typename T>
+void add_arrays(const T* a, const T* b, T* out, size_t n) {
+    parallel_for(0, n, detail::elementwise_grain(), [&](size_t lo,
+                                                         size_t hi) {
+        add_block(a + lo, b + lo, out + lo, hi - lo);
+    });
+}
+
+// Rows of a rows x cols matrix per task of about elementwise_grain()
+// elements.
+size_t row_grain(size_t cols) {
+    return std::max<size_t>(1, detail::elementwise_grain() / cols);
+}
+
+void check_square(size_t rows, size_t cols) {
+    if (rows != cols) {
+        throw std::invalid_argument("Structured matrices must be square");
+    }
+}
+
+void check_multiply(size_t inner, size_t other) {
+    if (inner != other) {
+        throw std::invalid_argument(
+            "Matrix dimensions incompatible for multiplication");
+    }
+}
+
+void check_add(size_t rows, size_t cols, size_t other_rows,
+               size_t other_cols) {
+    if (rows != other_rows || cols != other_cols) {
+        throw std::invalid_argument(
+            "Matrix dimensions must match for addition");
+    }
+}
+
+void check_triangles(Triangle a, Triangle b) {
+    if (a != b) {
+        throw std::invalid_argument(
+            "Triangular matrices must be in the same triangle");
+    }
+}
+
+void check_index(size_t i, size_t j, size_t n) {
+    if (i >= n || j >= n) {
+        throw std::out_of_range("Matrix indices out of range");
+    }
+}
+
+enum class Shape { LOWER, UPPER, SYMMETRIC };
+
+// An n x n matrix held as a packed lower triangle: that of the matrix for
+// LOWER and SYMMETRIC, that of its transpose for UPPER.
+template <typename T>
+struct Packed {
+    const T* data;
+    size_t n;
+    Shape shape;
+
+    // Columns [first, last) holding the nonzeros of rows [r0, r1)
+    std::pair<size_t, size_t> columns(size_t r0, size_t r1) const {
+        switch (shape) {
+        case Shape::LOWER:
+            return {0, r1};
+        case Shape::UPPER:
+            return {r0, n};
+        default:
+            return {0, n};
+        }
+    }
+
+    // Rows [first, last) holding the nonzeros of columns [c0, c1)
+    std::pair<size_t, size_t> rows(size_t c0, size_t c1) const {
+        switch (shape) {
+        case Shape::LOWER:
+            return {c0, n};
+        case Shape::UPPER:
+            return {0, c1};
+        default:
+            return {0, n};
+        }
+    }
+
+    // Write block [r0, r1) x [c0, c1) densely into out, with leading
+    // dimension ldo.
+    void unpack(size_t r0, size_t r1, size_t c0, size_t c1, T* out,
+                size_t ldo) const {
+        // Columns up to the diagonal are stored along row i
+        for (size_t i = r0; i < r1; ++i) {
+            T* row = out + (i - r0) * ldo;
+            const size_t split = std::clamp(i + 1, c0, c1);
+            if (shape == Shape::UPPER) {
+                std::fill(row, row + (split - c0), T(0));
+                if (split > c0 && split - 1 == i) {
+                    row[i - c0] = data[packed_index(i, i)];
+                }
+            } else if (split > c0) {
+                std::copy(data + packed_index(i, c0),
+                          data + packed_index(i, split), row);
+            }
+            if (shape == Shape::LOWER) {
+                std::fill(row + (split - c0), row + (c1 - c0), T(0));
+            }
+        }
+        if (shape == Shape::LOWER) {
+            return;
+        }
+        // Those past it down column i, a tile at a time so that rows of
+        // the triangle are read and rows of out written in cache
+        for (size_t i0 = r0; i0 < r1; i0 += TILE) {
+            const size_t i1 = std::min(r1, i0 + TILE);
+            for (size_t j0 = std::max(c0, i0 + 1); j0 < c1; j0 += TILE) {
+                const size_t j1 = std::min(c1, j0 + TILE);
+                for (size_t j = j0; j < j1; ++j) {
+                    const T* column = data + packed_index(j, 0);
+                    for (size_t i = i0; i < std::min(i1, j); ++i) {
+                        out[(i - r0) * ldo + (j - c0)] = column[i];
+                    }
+                }
+            }
+        }
+    }
+};
+
+template <typename T>
+Packed<T> packed_of(const BasicSymmetricMatrix<T>& a) {
+    return {a.packed(), a.rows(), Shape::SYMMETRIC};
+}
+
+template <typename T>
+Packed<T> packed_of(const BasicTriangularMatrix<T>& a) {
+    return {a.packed(), a.rows(),
+            a.triangle() == Triangle::LOWER ? Shape::LOWER : Shape::UPPER};
+}
+
+// Packed::unpack() on the thread pool, by rows.
+template <typename T>
+void unpack_parallel(const Packed<T>& a, size_t r0, size_t r1, size_t c0,
+                     size_t c1, T* out, size_t ldo) {
+    parallel_for(r0, r1, row_grain(c1 - c0), [&](size_t lo, size_t hi) {
+        a.unpack(lo, hi, c0, c1, out + (lo - r0) * ldo, ldo);
+    });
+}
+
+template <typename T>
+BasicMatrix<T> unpack_all(const Packed<T>& a) {
+    BasicMatrix<T> result(a.n, a.n, UNINITIALIZED);
+    unpack_parallel(a, 0, a.n, 0, a.n, result.data(), a.n);
+    return result;
+}
+
+// Rows or columns of a packed matrix unpacked per gemm() call.
+template <typename T>
+size_t slab_size(const Packed<T>& a) {
+    if (a.shape != Shape::SYMMETRIC) {
+        return SLAB;
+    }
+    return std::min(a.n,
+                    std::max(SLAB, UNPACK_BYTES / (a.n * sizeof(T))));
+}
+
+// Multiply-adds of a product with a packed n x n operand and an n x p or
+// p x n dense one.
+template <typename T>
+size_t packed_multiply_adds(const Packed<T>& a, size_t p) {
+    const size_t half = a.n * (a.n + 1) / 2;
+    return (a.shape == Shape::SYMMETRIC ? a.n * a.n : half) * p;
+}
+
+// C = A * B for packed A and dense n x p B, one slab of rows of A at a
+// time, over the columns that hold its nonzeros.
+template <typename T>
+BasicMatrix<T> multiply_left(const Packed<T>& a, const BasicMatrix<T>& b) {
+    check_multiply(a.n, b.rows());
+    const size_t p = b.cols();
+    MATRIXOPS_INSTRUMENT(MULTIPLY, a.n * p,
+                         detail::multiply_add_flops(a.data) *
+                             packed_multiply_adds(a, p),
+                         (a.n * (a.n + 1) / 2 + 2 * a.n * p) * sizeof(T));
+    BasicMatrix<T> result(a.n, p, UNINITIALIZED);
+    std::vector<T> slab;
+    const size_t rows = slab_size(a);
+    for (size_t r0 = 0; r0 < a.n; r0 += rows) {
+        const size_t r1 = std::min(a.n, r0 + rows);
+        const auto [c0, c1] = a.columns(r0, r1);
+        slab.resize((r1 - r0) * (c1 - c0));
+        unpack_parallel(a, r0, r1, c0, c1, slab.data(), c1 - c0);
+        gemm(r1 - r0, p, c1 - c0, T(1), slab.data(), c1 - c0,
+             b.data() + c0 * b.stride(), b.stride(), T(0),
+             result.data() + r0 * result.stride(), result.stride());
+    }
+    return result;
+}
+
+// C = A * B for dense m x n A and packed B, one slab of columns of B at a
+// time, over the rows that hold its nonzeros.
+template <typename T>
+BasicMatrix<T> multiply_right(const BasicMatrix<T>& a, const Packed<T>& b) {
+    check_multiply(a.cols(), b.n);
+    const size_t m = a.rows();
+    MATRIXOPS_INSTRUMENT(MULTIPLY, m * b.n,
+                         detail::multiply_add_flops(b.data) *
+                             packed_multiply_adds(b, m),
+                         (b.n * (b.n + 1) / 2 + 2 * m * b.n) * sizeof(T));
+    BasicMatrix<T> result(m, b.n, UNINITIALIZED);
+    std::vector<T> slab;
+    const size_t cols = slab_size(b);
+    for (size_t c0 = 0; c0 < b.n; c0 += cols) {
+        const size_t c1 = std::min(b.n, c0 + cols);
+        const auto [r0, r1] = b.rows(c0, c1);
+        slab.resize((r1 - r0) * (c1 - c0));
+        unpack_parallel(b, r0, r1, c0, c1, slab.data(), c1 - c0);
+        gemm(m, c1 - c0, r1 - r0, T(1), a.data() + r0, a.stride(),
+             slab.data(), c1 - c0, T(0), result.data() + c0,
+             result.stride());
+    }
+    return result;
+}
+
+// Packed lower triangle of A * B for lower triangular A and B, block by
+// block of the result: block (I, J) only depends on columns [J, I] of A
+// and the same rows of B, a sixth of the dense multiply-adds.
+template <typename T>
+void multiply_lower(const T* a, const T* b, size_t n, T* out) {
+    const Packed<T> pa{a, n, Shape::LOWER};
+    const Packed<T> pb{b, n, Shape::LOWER};
+    std::vector<T> left(SLAB * n);
+    std::vector<T> right(SLAB * n);
+    std::vector<T> block(SLAB * SLAB);
+    for (size_t r0 = 0; r0 < n; r0 += SLAB) {
+        const size_t r1 = std::min(n, r0 + SLAB);
+        for (size_t c0 = 0; c0 <= r0; c0 += SLAB) {
+            const size_t c1 = std::min(n, c0 + SLAB);
+            const size_t depth = r1 - c0;
+            pa.unpack(r0, r1, c0, r1, left.data(), depth);
+            pb.unpack(c0, r1, c0, c1, right.data(), c1 - c0);
+            gemm(r1 - r0, c1 - c0, depth, T(1), left.data(), depth,
+                 right.data(), c1 - c0, T(0), block.data(), c1 - c0);
+            for (size_t i = r0; i < r1; ++i) {
+                const size_t last = std::min(c1, i + 1);
+                std::copy(block.data() + (i - r0) * (c1 - c0),
+                          block.data() + (i - r0) * (c1 - c0) + last - c0,
+                          out + packed_index(i, c0));
+            }
+        }
+    }
+}
+
+} // namespace
+
+template <typename T>
+BasicIdentityMatrix<T>::BasicIdentityMatrix(size_t n) : n_(n) {
+    if (n == 0) {
+        throw std::invalid_argument("Matrix dimensions must be positive");
+    }
+}
+
+template <typename T>
+T BasicIdentityMatrix<T>::operator()(size_t i, size_t j) const {
+    check_index(i, j, n_);
+    return i == j ? T(1) : T(0);
+}
+
+template <typename T>
+BasicMatrix<T> BasicIdentityMatrix<T>::to_dense() const {
+    return identity<T>(n_);
+}
+
+template <typename T>
+typename BasicIdentityMatrix<T>::real_type
+BasicIdentityMatrix<T>::norm() const {
+    return static_cast<real_type>(std::sqrt(static_cast<double>(n_)));
+}
+
+template <typename T>
+BasicMatrix<T> BasicIdentityMatrix<T>::operator*(
+    const BasicMatrix<T>& other) const {
+    check_multiply(n_, other.rows());
+    return other;
+}
+
+template <typename T>
+BasicVector<T> BasicIdentityMatrix<T>::operator*(
+    const BasicVector<T>& x) const {
+    check_multiply(n_, x.size());
+    return x;
+}
+
+template <typename T>
+BasicMatrix<T> BasicIdentityMatrix<T>::operator+(
+    const BasicMatrix<T>& other) const {
+    check_add(n_, n_, other.rows(), other.cols());
+    BasicMatrix<T> result(other);
+    for (size_t i = 0; i < n_; ++i) {
+        result.unchecked(i, i) += T(1);
+    }
+    return result;
+}
+
+template <typename T>
+BasicDiagonalMatrix<T>::BasicDiagonalMatrix(size_t n, T value)
+    : data_(n, value) {
+    if (n == 0) {
+        throw std::invalid_argument("Matrix dimensions must be positive");
+    }
+}
+
+template <typename T>
+BasicDiagonalMatrix<T>::BasicDiagonalMatrix(const BasicVector<T>& diagonal)
+    : data_(diagonal.data(), diagonal.data() + diagonal.size()) {}
+
+template <typename T>
+T BasicDiagonalMatrix<T>::operator()(size_t i, size_t j) const {
+    check_index(i, j, rows());
+    return i == j ? data_[i] : T(0);
+}
+
+template <typename T>
+BasicMatrix<T> BasicDiagonalMatrix<T>::to_dense() const {
+    const size_t n = rows();
+    BasicMatrix<T> result(n, n, T(0));
+    for (size_t i = 0; i < n; ++i) {
+        result.unchecked(i, i) = data_[i];
+    }
+    return result;
+}
+
+template <typename T>
+typename BasicDiagonalMatrix<T>::real_type BasicDiagonalMatrix<T>::norm()
+    const {
+    return static_cast<real_type>(
+        detail::euclidean_norm(data_.data(), data_.size()));
+}
+
+template <typename T>
+BasicDiagonalMatrix<T> BasicDiagonalMatrix<T>::operator*(
+    const BasicDiagonalMatrix& other) const {
+    check_multiply(cols(), other.rows());
+    BasicDiagonalMatrix result(*this);
+    for (size_t i = 0; i < rows(); ++i) {
+        result.data_[i] *= other.data_[i];
+    }
+    return result;
+}
+
+template <typename T>
+BasicMatrix<T> BasicDiagonalMatrix<T>::operator*(
+    const BasicMatrix<T>& other) const {
+    check_multiply(cols(), other.rows());
+    const size_t p = other.cols();
+    MATRIXOPS_INSTRUMENT(SCALE, rows() * p, rows() * p,
+                         2 * rows() * p * sizeof(T));
+    BasicMatrix<T> result(rows(), p, UNINITIALIZED);
+    parallel_for(0, rows(), row_grain(p), [&](size_t lo, size_t hi) {
+        for (size_t i = lo; i < hi; ++i) {
+            scale_block(other.data() + i * other.stride(), data_[i],
+                        result.data() + i * result.stride(), p);
+        }
+    });
+    return result;
+}
+
+template <typename T>
+BasicVector<T> BasicDiagonalMatrix<T>::operator*(
+    const BasicVector<T>& x) const {
+    check_multiply(cols(), x.size());
+    BasicVector<T> result(x.size(), UNINITIALIZED);
+    for (size_t i = 0; i < x.size(); ++i) {
+        result.unchecked(i) = data_[i] * x.unchecked(i);
+    }
+    return result;
+}
+
+template <typename T>
+BasicDiagonalMatrix<T> BasicDiagonalMatrix<T>::operator+(
+    const BasicDiagonalMatrix& other) const {
+    check_add(rows(), cols(), other.rows(), other.cols());
+    BasicDiagonalMatrix result(*this);
+    add_block(data_.data(), other.data_.data(), result.data_.data(),
+              rows());
+    return result;
+}
+
+template <typename T>
+BasicMatrix<T> BasicDiagonalMatrix<T>::operator+(
+    const BasicMatrix<T>& other) const {
+    check_add(rows(), cols(), other.rows(), other.cols());
+    BasicMatrix<T> result(other);
+    for (size_t i = 0; i < rows(); ++i) {
+        result.unchecked(i, i) += data_[i];
+    }
+    return result;
+}
+
+template <typename T>
+BasicSymmetricMatrix<T>::BasicSymmetricMatrix(size_t n, T init_value)
+    : n_(n), data_(n * (n + 1) / 2, init_value) {
+    if (n == 0) {
+        throw std::invalid_argument("Matrix dimensions must be positive");
+    }
+}
+
+template <typename T>
+BasicSymmetricMatrix<T>::BasicSymmetricMatrix(const BasicMatrix<T>& dense)
+    : n_(dense.rows()) {
+    check_square(dense.rows(), dense.cols());
+    data_.resize(n_ * (n_ + 1) / 2);
+    for (size_t i = 0; i < n_; ++i) {
+        std::copy(dense.data() + i * dense.stride(),
+                  dense.data() + i * dense.stride() + i + 1,
+                  data_.data() + packed_index(i, 0));
+    }
+}
+
+template <typename T>
+T& BasicSymmetricMatrix<T>::operator()(size_t i, size_t j) {
+    check_index(i, j, n_);
+    return data_[packed_index(std::max(i, j), std::min(i, j))];
+}
+
+template <typename T>
+T BasicSymmetricMatrix<T>::operator()(size_t i, size_t j) const {
+    check_index(i, j, n_);
+    return data_[packed_index(std::max(i, j), std::min(i, j))];
+}
+
+template <typename T>
+BasicMatrix<T> BasicSymmetricMatrix<T>::to_dense() const {
+    return unpack_all(packed_of(*this));
+}
+
+template <typename T>
+typename BasicSymmetricMatrix<T>::real_type
+BasicSymmetricMatrix<T>::norm() const {
+    // sqrt(2 |A|^2 - |diag|^2), from the norm of the packed triangle,
+    // which counts every element once
+    MATRIXOPS_INSTRUMENT(NORM, data_.size(), 2 * data_.size(),
+                         data_.size() * sizeof(T));
+    const double triangle =
+        detail::euclidean_norm(data_.data(), data_.size());
+    if (triangle == 0.0 || !std::isfinite(triangle)) {
+        return static_cast<real_type>(triangle);
+    }
+    std::vector<T> diagonal(n_);
+    for (size_t i = 0; i < n_; ++i) {
+        diagonal[i] = data_[packed_index(i, i)];
+    }
+    const double ratio =
+        detail::euclidean_norm(diagonal.data(), n_) / triangle;
+    return static_cast<real_type>(triangle *
+                                  std::sqrt(2.0 - ratio * ratio));
+}
+
+template <typename T>
+BasicMatrix<T> BasicSymmetricMatrix<T>::operator*(
+    const BasicMatrix<T>& other) const {
+    return multiply_left(packed_of(*this), other);
+}
+
+template <typename T>
+BasicVector<T> BasicSymmetricMatrix<T>::operator*(
+    const BasicVector<T>& x) const {
+    check_multiply(n_, x.size());
+    // Row i of the triangle gives the lower part of y[i] and, down column
+    // i, the upper part of y[0:i]
+    BasicVector<T> y(n_);
+    const T* in = x.data();
+    T* out = y.data();
+    for (size_t i = 0; i < n_; ++i) {
+        const T* row = data_.data() + packed_index(i, 0);
+        out[i] += dot_block(row, in, i + 1);
+        axpy_block(in[i], row, out, i);
+    }
+    return y;
+}
+
+template <typename T>
+BasicSymmetricMatrix<T> BasicSymmetricMatrix<T>::operator+(
+    const BasicSymmetricMatrix& other) const {
+    check_add(n_, n_, other.n_, other.n_);
+    BasicSymmetricMatrix result(*this);
+    add_arrays(data_.data(), other.data_.data(), result.data_.data(),
+               data_.size());
+    return result;
+}
+
+template <typename T>
+BasicMatrix<T> BasicSymmetricMatrix<T>::operator+(
+    const BasicMatrix<T>& other) const {
+    check_add(n_, n_, other.rows(), other.cols());
+    BasicMatrix<T> result = to_dense();
+    result += other;
+    return result;
+}
+
+template <typename T>
+BasicTriangularMatrix<T>::BasicTriangularMatrix(size_t n, Triangle triangle,
+                                                T init_value)
+    : n_(n), triangle_(triangle), data_(n * (n + 1) / 2, init_value) {
+    if (n == 0) {
+        throw std::invalid_argument("Matrix dimensions must be positive");
+    }
+}
+
+template <typename T>
+BasicTriangularMatrix<T>::BasicTriangularMatrix(const BasicMatrix<T>& dense,
+                                                Triangle triangle)
+    : n_(dense.rows()), triangle_(triangle) {
+    check_square(dense.rows(), dense.cols());
+    data_.resize(n_ * (n_ + 1) / 2);
+    for (size_t i = 0; i < n_; ++i) {
+        T* row = data_.data() + packed_index(i, 0);
+        for (size_t j = 0; j <= i; ++j) {
+            row[j] = triangle == Triangle::LOWER ? dense.unchecked(i, j)
+                                                 : dense.unchecked(j, i);
+        }
+    }
+}
+
+template <typename T>
+T BasicTriangularMatrix<T>::operator()(size_t i, size_t j) const {
+    check_index(i, j, n_);
+    if (triangle_ == Triangle::LOWER ? j > i : j < i) {
+        return T(0);
+    }
+    return data_[packed_index(std::max(i, j), std::min(i, j))];
+}
+
+template <typename T>
+BasicMatrix<T> BasicTriangularMatrix<T>::to_dense() const {
+    return unpack_all(packed_of(*this));
+}
+
+template <typename T>
+BasicTriangularMatrix<T> BasicTriangularMatrix<T>::transpose() const {
+    BasicTriangularMatrix result(*this);
+    result.triangle_ =
+        triangle_ == Triangle::LOWER ? Triangle::UPPER : Triangle::LOWER;
+    return result;
+}
+
+template <typename T>
+typename BasicTriangularMatrix<T>::real_type
+BasicTriangularMatrix<T>::norm() const {
+    MATRIXOPS_INSTRUMENT(NORM, data_.size(), 2 * data_.size(),
+                         data_.size() * sizeof(T));
+    return static_cast<real_type>(
+        detail::euclidean_norm(data_.data(), data_.size()));
+}
+
+template <typename T>
+BasicTriangularMatrix<T> BasicTriangularMatrix<T>::operator*(
+    const BasicTriangularMatrix& other) const {
+    check_multiply(n_, other.n_);
+    check_triangles(triangle_, other.triangle_);
+    MATRIXOPS_INSTRUMENT(MULTIPLY, data_.size(),
+                         detail::multiply_add_flops(data_.data()) * n_ *
+                             (n_ + 1) * (n_ + 2) / 6,
+                         3 * data_.size() * sizeof(T));
+    BasicTriangularMatrix result(n_, triangle_);
+    // The packed triangle of an upper U is that of the lower U^T, and the
+    // transpose of U V is V^T U^T
+    if (triangle_ == Triangle::LOWER) {
+        multiply_lower(data_.data(), other.data_.data(), n_,
+                       result.data_.data());
+    } else {
+        multiply_lower(other.data_.data(), data_.data(), n_,
+                       result.data_.data());
+    }
+    return result;
+}
+
+template <typename T>
+BasicMatrix<T> BasicTriangularMatrix<T>::operator*(
+    const BasicMatrix<T>& other) const {
+    return multiply_left(packed_of(*this), other);
+}
+
+template <typename T>
+BasicVector<T> BasicTriangularMatrix<T>::operator*(
+    const BasicVector<T>& x) const {
+    check_multiply(n_, x.size());
+    BasicVector<T> y(n_);
+    const T* in = x.data();
+    T* out = y.data();
+    for (size_t i = 0; i < n_; ++i) {
+        const T* row = data_.data() + packed_index(i, 0);
+        if (triangle_ == Triangle::LOWER) {
+            out[i] = dot_block(row, in, i + 1);
+        } else {
+            // Row i of the packed triangle is column i of the matrix
+            axpy_block(in[i], row, out, i + 1);
+        }
+    }
+    return y;
+}
+
+template <typename T>
+BasicTriangularMatrix<T> BasicTriangularMatrix<T>::operator+(
+    const BasicTriangularMatrix& other) const {
+    check_add(n_, n_, other.n_, other.n_);
+    check_triangles(triangle_, other.triangle_);
+    BasicTriangularMatrix result(*this);
+    add_arrays(data_.data(), other.data_.data(), result.data_.data(),
+               data_.size());
+    return result;
+}
+
+template <typename T>
+BasicMatrix<T> BasicTriangularMatrix<T>::operator+(
+    const BasicMatrix<T>& other) const {
+    check_add(n_, n_, other.rows(), other.cols());
+    BasicMatrix<T> result(other);
+    const Packed<T> a = packed_of(*this);
+    parallel_for(0, n_, row_grain(n_), [&](size_t lo, size_t hi) {
+        for (size_t i = lo; i < hi; ++i) {
+            T* row = result.data() + i * result.stride();
+            for (size_t j = 0; j <= i; ++j) {
+                if (a.shape == Shape::LOWER) {
+                    row[j] += a.data[packed_index(i, j)];
+                } else {
+                    result.unchecked(j, i) += a.data[packed_index(i, j)];
+                }
+            }
+        }
+    });
+    return result;
+}
+
+template <typename T>
+BasicMatrix<T> operator*(const BasicMatrix<T>& a,
+                         const BasicIdentityMatrix<T>& b) {
+    check_multiply(a.cols(), b.rows());
+    return a;
+}
+
+template <typename T>
+BasicMatrix<T> operator*(const BasicMatrix<T>& a,
+                         const BasicDiagonalMatrix<T>& b) {
+    check_multiply(a.cols(), b.rows());
+    const size_t m = a.rows();
+    const size_t n = a.cols();
+    MATRIXOPS_INSTRUMENT(SCALE, m * n, m * n, 2 * m * n * sizeof(T));
+    BasicMatrix<T> result(m, n, UNINITIALIZED);
+    const T* d = b.data();
+    parallel_for(0, m, row_grain(n), [&](size_t lo, size_t hi) {
+        for (size_t i = lo; i < hi; ++i) {
+            const T* in = a.data() + i * a.stride();
+            T* out = result.data() + i * result.stride();
+            for (size_t j = 0; j < n; ++j) {
+                out[j] = in[j] * d[j];
+            }
+        }
+    });
+    return result;
+}
+
+template <typename T>
+BasicMatrix<T> operator*(const BasicMatrix<T>& a,
+                         const BasicSymmetricMatrix<T>& b) {
+    return multiply_right(a, packed_of(b));
+}
+
+template <typename T>
+BasicMatrix<T> operator*(const BasicMatrix<T>& a,
+                         const BasicTriangularMatrix<T>& b) {
+    return multiply_right(a, packed_of(b));
+}
+
+template <typename T>
+BasicSymmetricMatrix<T> gram(const BasicMatrix<T>& a) {
+    const size_t k = a.rows();
+    const size_t n = a.cols();
+    MATRIXOPS_INSTRUMENT(MULTIPLY, n * (n + 1) / 2,
+                         detail::multiply_add_flops(a.data()) * n *
+                             (n + 1) / 2 * k,
+                         (k * n + n * (n + 1) / 2) * sizeof(T));
+    BasicSymmetricMatrix<T> result(n);
+    std::vector<T> slab;
+    // Rows [r0, r1) of the lower triangle are columns [r0, r1) of A,
+    // as a column-major A^T, times columns [0, r1) of A
+    for (size_t r0 = 0; r0 < n; r0 += SLAB) {
+        const size_t r1 = std::min(n, r0 + SLAB);
+        slab.resize((r1 - r0) * r1);
+        gemm(r1 - r0, r1, k, T(1), a.data() + r0, a.stride(), a.data(),
+             a.stride(), T(0), slab.data(), r1, Layout::COLUMN_MAJOR,
+             Layout::ROW_MAJOR);
+        for (size_t i = r0; i < r1; ++i) {
+            std::copy(slab.data() + (i - r0) * r1,
+                      slab.data() + (i - r0) * r1 + i + 1,
+                      result.packed() + packed_index(i, 0));
+        }
+    }
+    return result;
+}
+
+#define MATRIXOPS_INSTANTIATE_STRUCTURED(T)                                    \
+    template class BasicIdentityMatrix<T>;                                     \
+    template class BasicDiagonalMatrix<T>;                                     \
+    template class BasicSymmetricMatrix<T>;                                    \
+    template class BasicTriangularMatrix<T>;                                   \
+    template BasicMatrix<T> operator*(const BasicMatrix<T>&,                   \
+                                      const BasicIdentityMatrix<T>&);          \
+    template BasicMatrix<T> operator*(const BasicMatrix<T>&,                   \
+                                      const BasicDiagonalMatrix<T>&);          \
+    template BasicMatrix<T> operator*(const BasicMatrix<T>&,                   \
+                                      const BasicSymmetricMatrix<T>&);         \
+    template BasicMatrix<T> operator*(const BasicMatrix<T>&,                   \
+                                      const BasicTriangularMatrix<T>&);        \
+    template BasicSymmetricMatrix<T> gram(const BasicMatrix<T>&);
+
+MATRIXOPS_INSTANTIATE_STRUCTURED(float)
+MATRIXOPS_INSTANTIATE_STRUCTURED(double)
+MATRIXOPS_INSTANTIATE_STRUCTURED(std::complex<float>)
+MATRIXOPS_INSTANTIATE_STRUCTURED(std::complex<double>)
+
+#undef MATRIXOPS_INSTANTIATE_STRUCTURED
+
+} // namespace matrixops
@@ -0,0 +1,386 @@
+#include "thread_pool.h"
+#include "matrixops/parallel.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <exception>
+#include <string>
+
+#include "env.h"
+#include "numa.h"
+
+namespace matrixops {
+namespace detail {
+
+namespace {
+
+// Worker identity of the current thread, so that nested submissions go to
+// the worker's own deque.
+thread_local ThreadPool* current_pool = nullptr;
+thread_local size_t current_worker = 0;
+
+size_t default_num_threads() {
+    const std::string env = get_env("MATRIXOPS_NUM_THREADS");
+    if (!env.empty()) {
+        char* end = nullptr;
+        const unsigned long long value = std::strtoull(env.c_str(), &end, 10);
+        if (end != nullptr && *end == '\0' && value > 0) {
+            return static_cast<size_t>(value);
+        }
+    }
+    return std::max(1U, std::thread::hardware_concurrency());
+}
+
+struct PoolState {
+    std::mutex mutex;
+    size_t threads = 0; // 0 until first use
+    std::shared_ptr<ThreadPool> pool;
+};
+
+PoolState& pool_state() {
+    static PoolState state;
+    return state;
+}
+
+// Caller must hold state.mutex.
+void resize_pool(PoolState& state, size_t threads) {
+    state.threads = threads;
+    state.pool =
+        threads > 1 ? std::make_shared<ThreadPool>(threads - 1) : nullptr;
+}
+
+} // namespace
+
+void ThreadPool::WorkQueue::push_back(Task task) {
+    if (count == ring.size()) {
+        std::vector<Task> grown(std::max<size_t>(16, ring.size() * 2));
+        for (size_t i = 0; i < count; ++i) {
+            grown[i] = std::move(ring[(head + i) % ring.size()]);
+        }
+        ring = std::move(grown);
+        head = 0;
+    }
+    ring[(head + count) % ring.size()] = std::move(task);
+    ++count;
+}
+
+bool ThreadPool::WorkQueue::pop_back(Task& task) {
+    if (count == 0) {
+        return false;
+    }
+    --count;
+    Task& slot = ring[(head + count) % ring.size()];
+    task = std::move(slot);
+    slot = nullptr;
+    return true;
+}
+
+bool ThreadPool::WorkQueue::pop_front(Task& task) {
+    if (count == 0) {
+        return false;
+    }
+    Task& slot = ring[head];
+    task = std::move(slot);
+    slot = nullptr;
+    head = (head + 1) % ring.size();
+    --count;
+    return true;
+}
+
+ThreadPool::ThreadPool(size_t num_workers) {
+    queues_.reserve(num_workers);
+    for (size_t i = 0; i < num_workers; ++i) {
+        queues_.push_back(std::make_unique<WorkQueue>());
+    }
+    workers_.reserve(num_workers);
+    const bool pinned = pin_threads();
+    for (size_t i = 0; i < num_workers; ++i) {
+        workers_.emplace_back([this, i, pinned, num_workers] {
+            if (pinned) {
+                pin_to_slot(i + 1, num_workers + 1);
+            }
+            worker_loop(i);
+        });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(sleep_mutex_);
+        stop_ = true;
+    }
+    wake_.notify_all();
+    for (std::thread& worker : workers_) {
+        worker.join();
+    }
+}
+
+void ThreadPool::submit(Task task) {
+    if (workers_.empty()) {
+        task();
+        return;
+    }
+    const size_t index =
+        current_pool == this
+            ? current_worker
+            : next_queue_.fetch_add(1, std::memory_order_relaxed) %
+                  queues_.size();
+    {
+        std::lock_guard<std::mutex> lock(queues_[index]->mutex);
+        queues_[index]->push_back(std::move(task));
+    }
+    wake_one();
+}
+
+void ThreadPool::submit_job(Task task) {
+    if (workers_.empty()) {
+        task();
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(jobs_.mutex);
+        jobs_.push_back(std::move(task));
+    }
+    wake_one();
+}
+
+void ThreadPool::wake_one() {
+    pending_.fetch_add(1, std::memory_order_release);
+    {
+        // Pairs with the predicate check in worker_loop so that the
+        // notification cannot be lost.
+        std::lock_guard<std::mutex> lock(sleep_mutex_);
+    }
+    wake_.notify_one();
+}
+
+bool ThreadPool::on_worker() const { return current_pool == this; }
+
+size_t ThreadPool::slot() const {
+    return current_pool == this ? current_worker + 1 : 0;
+}
+
+bool ThreadPool::try_run_one(bool include_jobs) {
+    Task task;
+    const size_t index = current_pool == this ? current_worker : 0;
+    if (!pop_task(index, include_jobs, task)) {
+        return false;
+    }
+    task();
+    return true;
+}
+
+bool ThreadPool::pop_task(size_t index, bool include_jobs, Task& task) {
+    if (queues_.empty()) {
+        return false;
+    }
+    {
+        WorkQueue& own = *queues_[index];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (own.pop_back(task)) {
+            pending_.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+    for (size_t offset = 1; offset < queues_.size(); ++offset) {
+        WorkQueue& victim = *queues_[(index + offset) % queues_.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (victim.pop_front(task)) {
+            pending_.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+    if (!include_jobs) {
+        return false;
+    }
+    // New jobs only once the running ones have no queued work left.
+    std::lock_guard<std::mutex> lock(jobs_.mutex);
+    if (jobs_.pop_front(task)) {
+        pending_.fetch_sub(1, std::memory_order_relaxed);
+        return true;
+    }
+    return false;
+}
+
+void ThreadPool::worker_loop(size_t index) {
+    current_pool = this;
+    current_worker = index;
+    for (;;) {
+        Task task;
+        if (pop_task(index, true, task)) {
+            task();
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(sleep_mutex_);
+        wake_.wait(lock, [this] {
+            return stop_ || pending_.load(std::memory_order_acquire) > 0;
+        });
+        if (stop_ && pending_.load(std::memory_order_acquire) == 0) {
+            return;
+        }
+    }
+}
+
+std::shared_ptr<ThreadPool> thread_pool() {
+    PoolState& state = pool_state();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    if (state.threads == 0) {
+        resize_pool(state, default_num_threads());
+    }
+    return state.pool;
+}
+
+void restart_thread_pool() {
+    // Destroyed after the lock is released, as in set_num_threads().
+    std::shared_ptr<ThreadPool> old_pool;
+    PoolState& state = pool_state();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    if (state.threads != 0) {
+        old_pool = std::move(state.pool);
+        resize_pool(state, state.threads);
+    }
+}
+
+} // namespace detail
+
+size_t num_threads() {
+    detail::PoolState& state = detail::pool_state();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    if (state.threads == 0) {
+        detail::resize_pool(state, detail::default_num_threads());
+    }
+    return state.threads;
+}
+
+void set_num_threads(size_t n) {
+    const size_t threads = n == 0 ? detail::default_num_threads() : n;
+    std::shared_ptr<detail::ThreadPool> old_pool;
+    {
+        detail::PoolState& state = detail::pool_state();
+        std::lock_guard<std::mutex> lock(state.mutex);
+        if (state.threads == threads) {
+            return;
+        }
+        old_pool = std::move(state.pool);
+        detail::resize_pool(state, threads);
+    }
+    // The old workers are joined here, outside the lock, once no running
+    // operation holds the pool any more.
+}
+
+namespace {
+
+// Chunks per thread: enough slack to balance uneven chunks without
+// drowning small ranges in task overhead.
+constexpr size_t CHUNKS_PER_THREAD = 4;
+
+// Most threads that get a share of their own with pinned workers; larger
+// pools share one cursor as when unpinned.
+constexpr size_t MAX_SHARES = 64;
+
+// The chunks are split into shares of consecutive chunks, one per thread
+// slot when workers are pinned and a single one otherwise. Each thread
+// takes from its own share first and then from the others, in order.
+struct ForState {
+    std::atomic<size_t> next[MAX_SHARES];
+    std::atomic<size_t> helpers{0};
+    size_t shares = 1;
+    size_t share = 0; // chunks per share
+    size_t chunks = 0;
+    size_t chunk = 0;
+    size_t begin = 0;
+    size_t end = 0;
+    const RangeFunction* body = nullptr;
+    std::mutex mutex;
+    std::condition_variable finished;
+    std::exception_ptr error;
+};
+
+void run_chunks(ForState& state, size_t slot) {
+    for (size_t offset = 0; offset < state.shares; ++offset) {
+        const size_t s = (slot + offset) % state.shares;
+        const size_t last = std::min(state.chunks, (s + 1) * state.share);
+        for (;;) {
+            const size_t c = state.next[s].fetch_add(1);
+            if (c >= last) {
+                break;
+            }
+            const size_t lo = state.begin + c * state.chunk;
+            const size_t hi = std::min(state.end, lo + state.chunk);
+            try {
+                (*state.body)(lo, hi);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(state.mutex);
+                if (!state.error) {
+                    state.error = std::current_exception();
+                }
+            }
+        }
+    }
+}
+
+} // namespace
+
+void parallel_for(size_t begin, size_t end, size_t grain,
+                  RangeFunction body) {
+    if (begin >= end) {
+        return;
+    }
+    grain = std::max<size_t>(grain, 1);
+    const size_t n = end - begin;
+    std::shared_ptr<detail::ThreadPool> pool =
+        n > grain ? detail::thread_pool() : nullptr;
+    if (!pool) {
+        body(begin, end);
+        return;
+    }
+
+    const size_t threads = pool->size() + 1;
+    const size_t target =
+        std::min((n + grain - 1) / grain, threads * CHUNKS_PER_THREAD);
+
+    // The state lives on this stack frame: the call does not return before
+    // every helper has finished with it, so dispatch never allocates.
+    ForState state;
+    state.chunk = (n + target - 1) / target;
+    state.chunks = (n + state.chunk - 1) / state.chunk;
+    state.begin = begin;
+    state.end = end;
+    state.body = &body;
+    state.shares =
+        detail::pin_threads() && threads <= MAX_SHARES ? threads : 1;
+    state.share = (state.chunks + state.shares - 1) / state.shares;
+    for (size_t s = 0; s < state.shares; ++s) {
+        state.next[s].store(s * state.share, std::memory_order_relaxed);
+    }
+
+    const size_t helpers = std::min(pool->size(), state.chunks - 1);
+    state.helpers.store(helpers);
+    ForState* shared = &state;
+    const detail::ThreadPool* owner = pool.get();
+    for (size_t i = 0; i < helpers; ++i) {
+        pool->submit([shared, owner] {
+            run_chunks(*shared, owner->slot());
+            // Decrement under the lock: the caller acquires it before
+            // destroying the state.
+            std::lock_guard<std::mutex> lock(shared->mutex);
+            if (shared->helpers.fetch_sub(1) == 1) {
+                shared->finished.notify_all();
+            }
+        });
+    }
+    run_chunks(state, pool->slot());
+
+    // Helpers still queued behind other work are run here rather than
+    // waited for. Once nothing is queued, the remaining helpers are running
+    // and signal when they are done.
+    while (state.helpers.load() > 0 && pool->try_run_one()) {
+    }
+    std::unique_lock<std::mutex> lock(state.mutex);
+    state.finished.wait(lock, [&] { return state.helpers.load() == 0; });
+    if (state.error) {
+        std::rethrow_exception(state.error);
+    }
+}
+
+} // namespace matrixops
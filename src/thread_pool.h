@@ -0,0 +1,118 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace matrixops {
+namespace detail {
+
+/**
+ * @brief Work-stealing thread pool
+ *
+ * Every worker owns a double-ended queue: tasks submitted from a worker go
+ * to the back of its own queue and are popped LIFO for locality, tasks
+ * submitted from outside are spread round-robin, and idle workers steal
+ * from the front of the other queues.
+ *
+ * Jobs, the independent operations of the async API, wait in a separate
+ * FIFO queue that workers only take from when no queued task of a
+ * running operation is left: jobs start in submission order, and a job
+ * that has started is finished before new ones are admitted, which keeps
+ * the latency of each bounded by the work submitted before it.
+ */
+class ThreadPool {
+public:
+    using Task = std::function<void()>;
+
+    explicit ThreadPool(size_t num_workers);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    /**
+     * @brief Number of worker threads (not counting callers)
+     */
+    size_t size() const { return workers_.size(); }
+
+    /**
+     * @brief Queue a task for execution on a worker
+     */
+    void submit(Task task);
+
+    /**
+     * @brief Queue a job, run after the jobs submitted before it
+     */
+    void submit_job(Task task);
+
+    /**
+     * @brief Run one queued task on the calling thread, if there is any
+     *
+     * Jobs are only taken with include_jobs: a thread waiting for the
+     * tasks of its own operation should not start a whole new one.
+     * @return true if a task was run
+     */
+    bool try_run_one(bool include_jobs = false);
+
+    /**
+     * @brief Check if the calling thread is one of the workers
+     */
+    bool on_worker() const;
+
+    /**
+     * @brief Slot of the calling thread: 1 + its index on a worker, 0 on
+     * any other thread
+     */
+    size_t slot() const;
+
+private:
+    // Growable ring buffer: unlike std::deque it keeps its capacity, so
+    // steady-state submissions do not allocate.
+    struct WorkQueue {
+        std::mutex mutex;
+        std::vector<Task> ring;
+        size_t head = 0;
+        size_t count = 0;
+
+        void push_back(Task task);
+        bool pop_back(Task& task);
+        bool pop_front(Task& task);
+    };
+
+    void worker_loop(size_t index);
+    bool pop_task(size_t index, bool include_jobs, Task& task);
+    void wake_one();
+
+    std::vector<std::unique_ptr<WorkQueue>> queues_;
+    WorkQueue jobs_;
+    std::vector<std::thread> workers_;
+    std::atomic<size_t> pending_{0};
+    std::atomic<size_t> next_queue_{0};
+    std::mutex sleep_mutex_;
+    std::condition_variable wake_;
+    bool stop_ = false;
+};
+
+/**
+ * @brief Get the library thread pool
+ *
+ * Returns nullptr when operations run single-threaded. The pool stays
+ * alive for as long as the returned pointer is held, even if
+ * set_num_threads() replaces it meanwhile.
+ */
+std::shared_ptr<ThreadPool> thread_pool();
+
+/**
+ * @brief Replace the thread pool with a new one of the same size, so that
+ * placement settings apply to its workers
+ */
+void restart_thread_pool();
+
+} // namespace detail
+} // namespace matrixops
@@ -0,0 +1,306 @@
+#include "matrixops/tiled_matrix.h"
+#include "matrixops/gemm.h"
+#include "matrixops/parallel.h"
+#include <algorithm>
+#include <cstdint>
+#include <numeric>
+
+#include "kernels.h"
+#include "portable_kernels.h"
+#include "reduction.h"
+#include "transpose.h"
+#include "workspace.h"
+
+namespace matrixops {
+
+using detail::ELEMENTWISE_GRAIN;
+
+namespace {
+
+// Workspace tags of the panels and result block of a product.
+struct APanel;
+struct BPanel;
+struct CBlock;
+
+// Tiles per task for element-wise work, about ELEMENTWISE_GRAIN elements.
+constexpr size_t TILE_GRAIN =
+    std::max<size_t>(ELEMENTWISE_GRAIN / (MATRIX_TILE * MATRIX_TILE), 1);
+
+// Z-order key of tile (ti, tj): the bits of ti and tj interleaved.
+uint64_t morton_key(size_t ti, size_t tj) {
+    uint64_t key = 0;
+    for (unsigned bit = 0; bit < 32; ++bit) {
+        key |= (static_cast<uint64_t>(ti) >> bit & 1U) << (2 * bit + 1);
+        key |= (static_cast<uint64_t>(tj) >> bit & 1U) << (2 * bit);
+    }
+    return key;
+}
+
+template <typename T>
+void add_arrays(const T* a, const T* b, T* out, size_t n) {
+    parallel_for(0, n, ELEMENTWISE_GRAIN, [&](size_t lo, size_t hi) {
+        if constexpr (detail::HAS_SIMD_KERNELS<T>) {
+            detail::typed_kernels<T>().add(a + lo, b + lo, out + lo, hi - lo);
+        } else {
+            detail::add_scalar(a + lo, b + lo, out + lo, hi - lo);
+        }
+    });
+}
+
+// Side, in tiles, of the blocks of a product computed by one gemm() call.
+constexpr size_t PRODUCT_TILES = 8;
+
+template <typename T>
+using ComputeType = typename detail::ScalarTraits<T>::compute_type;
+
+} // namespace
+
+template <typename T>
+BasicTiledMatrix<T>::BasicTiledMatrix(size_t rows, size_t cols,
+                                      UninitializedTag)
+    : rows_(rows), cols_(cols),
+      tile_rows_((rows + MATRIX_TILE - 1) / MATRIX_TILE),
+      tile_cols_((cols + MATRIX_TILE - 1) / MATRIX_TILE),
+      slot_(tile_rows_ * tile_cols_), order_(tile_rows_ * tile_cols_),
+      data_(tile_rows_ * tile_cols_ * TILE_ELEMENTS) {
+    if (rows == 0 || cols == 0) {
+        throw std::invalid_argument("Matrix dimensions must be positive");
+    }
+    std::iota(order_.begin(), order_.end(), size_t{0});
+    std::sort(order_.begin(), order_.end(), [this](size_t a, size_t b) {
+        return morton_key(a / tile_cols_, a % tile_cols_) <
+               morton_key(b / tile_cols_, b % tile_cols_);
+    });
+    for (size_t s = 0; s < order_.size(); ++s) {
+        slot_[order_[s]] = s;
+    }
+    // Only the last tile row and column have padding.
+    if (rows_ % MATRIX_TILE != 0) {
+        for (size_t tj = 0; tj < tile_cols_; ++tj) {
+            T* tile = tile_data(tile_rows_ - 1, tj);
+            std::fill(tile, tile + TILE_ELEMENTS, T(0));
+        }
+    }
+    if (cols_ % MATRIX_TILE != 0) {
+        for (size_t ti = 0; ti < tile_rows_; ++ti) {
+            T* tile = tile_data(ti, tile_cols_ - 1);
+            std::fill(tile, tile + TILE_ELEMENTS, T(0));
+        }
+    }
+}
+
+template <typename T>
+template <typename F>
+void BasicTiledMatrix<T>::for_each_tile(size_t grain, const F& f) const {
+    parallel_for(0, order_.size(), grain, [&](size_t lo, size_t hi) {
+        for (size_t s = lo; s < hi; ++s) {
+            f(order_[s] / tile_cols_, order_[s] % tile_cols_);
+        }
+    });
+}
+
+template <typename T>
+BasicTiledMatrix<T>::BasicTiledMatrix(size_t rows, size_t cols)
+    : BasicTiledMatrix(rows, cols, T(0)) {}
+
+template <typename T>
+BasicTiledMatrix<T>::BasicTiledMatrix(size_t rows, size_t cols,
+                                      const T& value)
+    : BasicTiledMatrix(rows, cols, UNINITIALIZED) {
+    for_each_tile(TILE_GRAIN, [&](size_t ti, size_t tj) {
+        T* tile = tile_data(ti, tj);
+        for (size_t i = 0; i < tile_height(ti); ++i) {
+            std::fill_n(tile + i * MATRIX_TILE, tile_width(tj), value);
+        }
+    });
+}
+
+template <typename T>
+BasicTiledMatrix<T>::BasicTiledMatrix(BasicMatrixView<const T> m)
+    : BasicTiledMatrix(m.rows(), m.cols(), UNINITIALIZED) {
+    for_each_tile(TILE_GRAIN, [&](size_t ti, size_t tj) {
+        const size_t height = tile_height(ti);
+        const size_t width = tile_width(tj);
+        BasicMatrixView<T>(tile_data(ti, tj), height, width, MATRIX_TILE)
+            .copy_from(m.block(ti * MATRIX_TILE, tj * MATRIX_TILE, height,
+                               width));
+    });
+}
+
+template <typename T>
+BasicMatrix<T> BasicTiledMatrix<T>::to_matrix() const {
+    BasicMatrix<T> result(rows_, cols_, UNINITIALIZED);
+    copy_to(result);
+    return result;
+}
+
+template <typename T>
+void BasicTiledMatrix<T>::copy_to(BasicMatrixView<T> dst) const {
+    if (dst.rows() != rows_ || dst.cols() != cols_) {
+        throw std::invalid_argument(
+            "Matrix dimensions must match for assignment");
+    }
+    for_each_tile(TILE_GRAIN, [&](size_t ti, size_t tj) {
+        const size_t height = tile_height(ti);
+        const size_t width = tile_width(tj);
+        dst.block(ti * MATRIX_TILE, tj * MATRIX_TILE, height, width)
+            .copy_from(BasicMatrixView<const T>(tile_data(ti, tj), height,
+                                                width, MATRIX_TILE));
+    });
+}
+
+template <typename T>
+BasicMatrixView<T> BasicTiledMatrix<T>::tile(size_t ti, size_t tj) {
+    if (ti >= tile_rows_ || tj >= tile_cols_) {
+        throw std::out_of_range("Matrix tile out of range");
+    }
+    return BasicMatrixView<T>(tile_data(ti, tj), tile_height(ti),
+                              tile_width(tj), MATRIX_TILE);
+}
+
+template <typename T>
+BasicMatrixView<const T> BasicTiledMatrix<T>::tile(size_t ti,
+                                                   size_t tj) const {
+    if (ti >= tile_rows_ || tj >= tile_cols_) {
+        throw std::out_of_range("Matrix tile out of range");
+    }
+    return BasicMatrixView<const T>(tile_data(ti, tj), tile_height(ti),
+                                    tile_width(tj), MATRIX_TILE);
+}
+
+template <typename T>
+BasicTiledMatrix<T> BasicTiledMatrix<T>::transpose() const {
+    BasicTiledMatrix result(cols_, rows_, UNINITIALIZED);
+    // Whole tiles, padding included: the padding of a tile transposes to
+    // the padding of its mirror.
+    for_each_tile(TILE_GRAIN, [&](size_t ti, size_t tj) {
+        detail::transpose(MATRIX_TILE, MATRIX_TILE, tile_data(ti, tj),
+                          MATRIX_TILE, result.tile_data(tj, ti), MATRIX_TILE);
+    });
+    return result;
+}
+
+template <typename T>
+BasicTiledMatrix<T>
+BasicTiledMatrix<T>::operator+(const BasicTiledMatrix& other) const {
+    if (rows_ != other.rows_ || cols_ != other.cols_) {
+        throw std::invalid_argument(
+            "Matrix dimensions must match for addition");
+    }
+    BasicTiledMatrix result(rows_, cols_, UNINITIALIZED);
+    add_arrays(data_.data(), other.data_.data(), result.data_.data(),
+               data_.size());
+    return result;
+}
+
+template <typename T>
+BasicTiledMatrix<T>&
+BasicTiledMatrix<T>::operator+=(const BasicTiledMatrix& other) {
+    if (rows_ != other.rows_ || cols_ != other.cols_) {
+        throw std::invalid_argument(
+            "Matrix dimensions must match for addition");
+    }
+    add_arrays(data_.data(), other.data_.data(), data_.data(), data_.size());
+    return *this;
+}
+
+template <typename T>
+BasicTiledMatrix<T>
+BasicTiledMatrix<T>::operator*(const BasicTiledMatrix& other) const {
+    if (cols_ != other.rows_) {
+        throw std::invalid_argument(
+            "Matrix dimensions incompatible for multiplication");
+    }
+    using Compute = ComputeType<T>;
+    BasicTiledMatrix result(rows_, other.cols_, UNINITIALIZED);
+    // The result is computed in blocks of PRODUCT_TILES x PRODUCT_TILES
+    // tiles, each from one gemm() call on the rows of tiles of this matrix
+    // and the columns of tiles of other, gathered into row-major panels.
+    // Tile-by-tile calls would be too small for the packed kernel to reach
+    // its peak. Padding is zero, so the panels span whole tiles.
+    const size_t depth = tile_cols_ * MATRIX_TILE;
+    const size_t block_rows = (tile_rows_ + PRODUCT_TILES - 1) / PRODUCT_TILES;
+    const size_t block_cols =
+        (other.tile_cols_ + PRODUCT_TILES - 1) / PRODUCT_TILES;
+    parallel_for(0, block_rows * block_cols, 1, [&](size_t lo, size_t hi) {
+        // gemm() may run other blocks on this thread while it waits.
+        detail::Workspace<T, APanel> a_workspace;
+        detail::Workspace<T, BPanel> b_workspace;
+        detail::Workspace<Compute, CBlock> c_workspace;
+        for (size_t block = lo; block < hi; ++block) {
+            const size_t ti0 = block / block_cols * PRODUCT_TILES;
+            const size_t tj0 = block % block_cols * PRODUCT_TILES;
+            const size_t tiles_down =
+                std::min(PRODUCT_TILES, tile_rows_ - ti0);
+            const size_t tiles_across =
+                std::min(PRODUCT_TILES, other.tile_cols_ - tj0);
+            const size_t lda = depth;
+            const size_t ldb = tiles_across * MATRIX_TILE;
+            T* const a_panel =
+                a_workspace.data(tiles_down * MATRIX_TILE * lda);
+            T* const b_panel = b_workspace.data(depth * ldb);
+            Compute* const c_block =
+                c_workspace.data(tiles_down * MATRIX_TILE * ldb);
+
+            for (size_t p = 0; p < tile_cols_; ++p) {
+                for (size_t t = 0; t < tiles_down; ++t) {
+                    const T* tile = tile_data(ti0 + t, p);
+                    T* dst = a_panel + t * MATRIX_TILE * lda + p * MATRIX_TILE;
+                    for (size_t i = 0; i < MATRIX_TILE; ++i) {
+                        std::copy_n(tile + i * MATRIX_TILE, MATRIX_TILE,
+                                    dst + i * lda);
+                    }
+                }
+                for (size_t t = 0; t < tiles_across; ++t) {
+                    const T* tile = other.tile_data(p, tj0 + t);
+                    T* dst = b_panel + p * MATRIX_TILE * ldb + t * MATRIX_TILE;
+                    for (size_t i = 0; i < MATRIX_TILE; ++i) {
+                        std::copy_n(tile + i * MATRIX_TILE, MATRIX_TILE,
+                                    dst + i * ldb);
+                    }
+                }
+            }
+
+            // Half and BFloat16 are accumulated in float and rounded once.
+            gemm(tiles_down * MATRIX_TILE, ldb, depth, Compute(1),
+                 a_panel, lda, b_panel, ldb, Compute(0),
+                 c_block, ldb);
+
+            for (size_t t = 0; t < tiles_down; ++t) {
+                for (size_t u = 0; u < tiles_across; ++u) {
+                    T* tile = result.tile_data(ti0 + t, tj0 + u);
+                    const Compute* src =
+                        c_block + t * MATRIX_TILE * ldb + u * MATRIX_TILE;
+                    for (size_t i = 0; i < MATRIX_TILE; ++i) {
+                        for (size_t j = 0; j < MATRIX_TILE; ++j) {
+                            tile[i * MATRIX_TILE + j] =
+                                static_cast<T>(src[i * ldb + j]);
+                        }
+                    }
+                }
+            }
+        }
+    });
+    return result;
+}
+
+template <typename T>
+typename BasicTiledMatrix<T>::real_type BasicTiledMatrix<T>::norm() const {
+    // The padding adds nothing to the sum of squares.
+    return static_cast<real_type>(
+        detail::euclidean_norm(data_.data(), data_.size()));
+}
+
+#define MATRIXOPS_INSTANTIATE_TILED_MATRIX(T)                                  \
+    template class BasicTiledMatrix<T>;
+
+MATRIXOPS_INSTANTIATE_TILED_MATRIX(float)
+MATRIXOPS_INSTANTIATE_TILED_MATRIX(double)
+MATRIXOPS_INSTANTIATE_TILED_MATRIX(std::complex<float>)
+MATRIXOPS_INSTANTIATE_TILED_MATRIX(std::complex<double>)
+MATRIXOPS_INSTANTIATE_TILED_MATRIX(Half)
+MATRIXOPS_INSTANTIATE_TILED_MATRIX(BFloat16)
+
+#undef MATRIXOPS_INSTANTIATE_TILED_MATRIX
+
+} // namespace matrixops
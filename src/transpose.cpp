@@ -0,0 +1,190 @@
+#include "transpose.h"
+
+#include "matrixops/matrix.h"
+#include "matrixops/parallel.h"
+
+#include <algorithm>
+#include <complex>
+#include <type_traits>
+#include <utility>
+
+#include "matrixops/half.h"
+
+#include "kernels.h"
+#include "portable_kernels.h"
+#include "tuning.h"
+
+namespace matrixops {
+namespace detail {
+
+namespace {
+
+// Largest transpose_tile of any kernel variant (see kernels.h).
+constexpr size_t MAX_TILE = 8;
+
+// How far ahead, in elements along a destination row, the strip walk
+// prefetches.
+constexpr size_t PREFETCH_DISTANCE = 16;
+
+// Destination lines are written but never read, so without a prefetch
+// every store of the strip walk misses and waits for its line. Prefetching
+// them for writing roughly doubles the throughput on large matrices.
+inline void prefetch_for_write(const void* p) {
+#if defined(__GNUC__) || defined(__clang__)
+    __builtin_prefetch(p, 1);
+#else
+    (void)p;
+#endif
+}
+
+// Square register tile used for the element type T.
+template <typename T>
+struct TileKernel {
+    size_t tile;
+    void (*micro)(const T* src, size_t lds, T* dst, size_t ldd);
+};
+
+template <typename T>
+TileKernel<T> tile_kernel() {
+    if constexpr (std::is_same_v<T, double>) {
+        const Kernels& k = kernels();
+        return {k.transpose_tile, k.transpose_micro};
+    } else {
+        return {4, transpose_micro_scalar<T, 4>};
+    }
+}
+
+template <typename T>
+void transpose_scalar(const T* src, size_t lds, T* dst, size_t ldd,
+                      size_t i0, size_t i1, size_t j0, size_t j1) {
+    for (size_t i = i0; i < i1; ++i) {
+        for (size_t j = j0; j < j1; ++j) {
+            dst[j * ldd + i] = src[i * lds + j];
+        }
+    }
+}
+
+// Transpose source columns [j0, j0 + t) into destination rows: the
+// micro-kernel walks down the source, so the t destination rows are
+// written sequentially and each source cache line is reused by the next
+// strip while it is still in cache.
+template <typename T>
+void transpose_strip(const TileKernel<T>& k, size_t rows, const T* src,
+                     size_t lds, T* dst, size_t ldd, size_t j0) {
+    const size_t t = k.tile;
+    size_t i = 0;
+    for (; i + t <= rows; i += t) {
+        for (size_t r = 0; r < t; ++r) {
+            prefetch_for_write(dst + (j0 + r) * ldd + i + PREFETCH_DISTANCE);
+        }
+        k.micro(src + i * lds + j0, lds, dst + j0 * ldd + i, ldd);
+    }
+    transpose_scalar(src, lds, dst, ldd, i, rows, j0, j0 + t);
+}
+
+// Exchange tile (i, j) with the transpose of tile (j, i) in place, going
+// through a register-sized buffer. i == j transposes a diagonal tile.
+template <typename T>
+void swap_tiles(const TileKernel<T>& k, T* a, size_t lda, size_t i,
+                size_t j) {
+    const size_t t = k.tile;
+    T buffer[MAX_TILE * MAX_TILE];
+    k.micro(a + i * lda + j, lda, buffer, t);
+    if (i != j) {
+        k.micro(a + j * lda + i, lda, a + i * lda + j, lda);
+    }
+    for (size_t r = 0; r < t; ++r) {
+        std::copy(buffer + r * t, buffer + (r + 1) * t, a + (j + r) * lda + i);
+    }
+}
+
+// Handle the block pair (bi, bj), bi <= bj, of the tiled region [0, m),
+// in blocks of side block.
+template <typename T>
+void swap_blocks(const TileKernel<T>& k, T* a, size_t lda, size_t m,
+                 size_t block, size_t bi, size_t bj) {
+    const size_t t = k.tile;
+    const size_t i1 = std::min(m, (bi + 1) * block);
+    const size_t j1 = std::min(m, (bj + 1) * block);
+    for (size_t i = bi * block; i < i1; i += t) {
+        for (size_t j = bi == bj ? i : bj * block; j < j1; j += t) {
+            swap_tiles(k, a, lda, i, j);
+        }
+    }
+}
+
+} // namespace
+
+template <typename T>
+void transpose(size_t rows, size_t cols, const T* src, size_t lds, T* dst,
+               size_t ldd) {
+    const TileKernel<T> k = tile_kernel<T>();
+    const size_t t = k.tile;
+    const size_t strips = cols / t;
+    // Tasks own disjoint bands of destination rows; smaller transposes run
+    // on the calling thread.
+    const size_t grain =
+        std::max<size_t>(1, elementwise_grain() / (t * rows));
+    parallel_for(0, strips, grain, [&](size_t lo, size_t hi) {
+        for (size_t s = lo; s < hi; ++s) {
+            transpose_strip(k, rows, src, lds, dst, ldd, s * t);
+        }
+    });
+    transpose_scalar(src, lds, dst, ldd, 0, rows, strips * t, cols);
+}
+
+template <typename T>
+void transpose_inplace(size_t n, T* a, size_t lda) {
+    const TileKernel<T> k = tile_kernel<T>();
+    const size_t t = k.tile;
+    const size_t m = n / t * t;
+
+    // The two blocks of a pair stay in L1 while their tiles are exchanged
+    // (2 x 8 KiB with the default side of 32). Enumerate the upper-
+    // triangular block pairs so that tasks get an even share: row bi of
+    // the block grid holds blocks - bi pairs.
+    const size_t block = transpose_block();
+    const size_t blocks = (m + block - 1) / block;
+    const size_t pairs = blocks * (blocks + 1) / 2;
+    const size_t grain =
+        std::max<size_t>(1, elementwise_grain() / (block * block));
+    parallel_for(0, pairs, grain, [&](size_t lo, size_t hi) {
+        size_t bi = 0;
+        size_t first = lo;
+        while (first >= blocks - bi) {
+            first -= blocks - bi;
+            ++bi;
+        }
+        size_t bj = bi + first;
+        for (size_t p = lo; p < hi; ++p) {
+            swap_blocks(k, a, lda, m, block, bi, bj);
+            if (++bj == blocks) {
+                ++bi;
+                bj = bi;
+            }
+        }
+    });
+
+    // Rows and columns past the last full tile.
+    for (size_t i = 0; i < n; ++i) {
+        for (size_t j = std::max(i + 1, m); j < n; ++j) {
+            std::swap(a[i * lda + j], a[j * lda + i]);
+        }
+    }
+}
+
+#define MATRIXOPS_INSTANTIATE_TRANSPOSE(T)                                     \
+    template void transpose(size_t, size_t, const T*, size_t, T*, size_t);    \
+    template void transpose_inplace(size_t, T*, size_t);
+
+MATRIXOPS_INSTANTIATE_TRANSPOSE(float)
+MATRIXOPS_INSTANTIATE_TRANSPOSE(double)
+MATRIXOPS_INSTANTIATE_TRANSPOSE(std::complex<float>)
+MATRIXOPS_INSTANTIATE_TRANSPOSE(std::complex<double>)
+MATRIXOPS_INSTANTIATE_TRANSPOSE(Half)
+MATRIXOPS_INSTANTIATE_TRANSPOSE(BFloat16)
+
+#undef MATRIXOPS_INSTANTIATE_TRANSPOSE
+
+} // namespace detail
+} // namespace matrixops
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstddef>
+
+namespace matrixops {
+namespace detail {
+
+/**
+ * @brief Write the transpose of the rows x cols matrix src into dst
+ *
+ * Both are row-major with leading dimensions lds and ldd; dst is
+ * cols x rows and must not overlap src.
+ */
+template <typename T>
+void transpose(size_t rows, size_t cols, const T* src, size_t lds, T* dst,
+               size_t ldd);
+
+/**
+ * @brief Transpose the n x n matrix a, with leading dimension lda, in place
+ */
+template <typename T>
+void transpose_inplace(size_t n, T* a, size_t lda);
+
+// Instantiated in transpose.cpp for every Matrix element type; double uses
+// the SIMD tile of the kernel table, the others a portable one.
+
+} // namespace detail
+} // namespace matrixops
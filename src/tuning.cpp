@@ -0,0 +1,555 @@
+#include "matrixops/tuning.h"
+
+#include "matrixops/matrix.h"
+#include "matrixops/parallel.h"
+#include "matrixops/simd.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <initializer_list>
+#include <limits>
+#include <locale>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+#include "env.h"
+#include "tuning.h"
+
+#if defined(__x86_64__) || defined(_M_X64)
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#define MATRIXOPS_TUNING_CPUID 1
+#endif
+
+#if !defined(_WIN32)
+#include <unistd.h>
+#endif
+
+namespace matrixops {
+
+namespace {
+
+// Largest transpose_tile of any kernel variant (see kernels.h).
+constexpr size_t TRANSPOSE_TILE_MULTIPLE = 8;
+
+std::atomic<size_t> grain{TuningProfile{}.elementwise_grain};
+std::atomic<size_t> block{TuningProfile{}.transpose_block};
+std::atomic<const char*> source{"builtin"};
+std::atomic<bool> autotune_pending{false};
+
+size_t round_up(size_t value, size_t multiple) {
+    return (value + multiple - 1) / multiple * multiple;
+}
+
+size_t round_down(size_t value, size_t multiple) {
+    return std::max(value / multiple * multiple, multiple);
+}
+
+size_t floor_power_of_two(size_t value) {
+    size_t p = 1;
+    while (p <= value / 2) {
+        p *= 2;
+    }
+    return p;
+}
+
+#ifdef MATRIXOPS_TUNING_CPUID
+void cpuid(unsigned leaf, unsigned subleaf, unsigned regs[4]) {
+#if defined(_MSC_VER) && !defined(__clang__)
+    int info[4];
+    __cpuidex(info, static_cast<int>(leaf), static_cast<int>(subleaf));
+    for (int i = 0; i < 4; ++i) {
+        regs[i] = static_cast<unsigned>(info[i]);
+    }
+#else
+    __cpuid_count(leaf, subleaf, regs[0], regs[1], regs[2], regs[3]);
+#endif
+}
+
+// Deterministic cache parameters: leaf 4 on Intel, 0x8000001D on AMD,
+// which share one layout. Returns false if neither is available.
+bool cpuid_caches(CacheTopology& topology) {
+    unsigned regs[4];
+    cpuid(0, 0, regs);
+    const unsigned max_leaf = regs[0];
+    cpuid(0x80000000U, 0, regs);
+    const unsigned max_extended = regs[0];
+    for (unsigned leaf : {4U, 0x8000001DU}) {
+        if ((leaf < 0x80000000U ? max_leaf : max_extended) < leaf) {
+            continue;
+        }
+        bool found = false;
+        for (unsigned index = 0; index < 16; ++index) {
+            cpuid(leaf, index, regs);
+            const unsigned type = regs[0] & 0x1f;
+            if (type == 0) {
+                break;
+            }
+            if (type != 1 && type != 3) {
+                continue; // instruction cache
+            }
+            const unsigned level = (regs[0] >> 5) & 0x7;
+            const size_t ways = ((regs[1] >> 22) & 0x3ff) + 1;
+            const size_t partitions = ((regs[1] >> 12) & 0x3ff) + 1;
+            const size_t line = (regs[1] & 0xfff) + 1;
+            const size_t sets = size_t{regs[2]} + 1;
+            const size_t size = ways * partitions * line * sets;
+            if (level == 1) {
+                topology.l1d = size;
+            } else if (level == 2) {
+                topology.l2 = size;
+            } else if (level == 3) {
+                topology.l3 = size;
+            }
+            found = true;
+        }
+        if (found) {
+            return true;
+        }
+    }
+    return false;
+}
+#endif
+
+CacheTopology detect_topology() {
+    CacheTopology topology;
+    topology.cores = std::max(1U, std::thread::hardware_concurrency());
+#ifdef MATRIXOPS_TUNING_CPUID
+    if (cpuid_caches(topology)) {
+        return topology;
+    }
+#endif
+#if defined(__linux__) && defined(_SC_LEVEL1_DCACHE_SIZE)
+    const long l1d = sysconf(_SC_LEVEL1_DCACHE_SIZE);
+    const long l2 = sysconf(_SC_LEVEL2_CACHE_SIZE);
+    const long l3 = sysconf(_SC_LEVEL3_CACHE_SIZE);
+    if (l1d > 0) {
+        topology.l1d = static_cast<size_t>(l1d);
+    }
+    if (l2 > 0) {
+        topology.l2 = static_cast<size_t>(l2);
+    }
+    if (l3 > 0) {
+        topology.l3 = static_cast<size_t>(l3);
+    }
+#endif
+    return topology;
+}
+
+void apply(const TuningProfile& profile, const char* from) {
+    set_tuning_profile(profile);
+    source.store(from, std::memory_order_relaxed);
+}
+
+std::string host_name() {
+#if defined(_WIN32)
+    return detail::get_env("COMPUTERNAME");
+#else
+    char name[256] = {};
+    if (gethostname(name, sizeof(name) - 1) != 0) {
+        return {};
+    }
+    return name;
+#endif
+}
+
+std::runtime_error profile_error(const std::string& path,
+                                 const std::string& reason) {
+    return std::runtime_error("Tuning profile '" + path + "': " + reason);
+}
+
+template <typename F>
+double best_seconds(int trials, F&& run) {
+    double best = std::numeric_limits<double>::infinity();
+    for (int t = 0; t < std::max(trials, 1); ++t) {
+        const auto start = std::chrono::steady_clock::now();
+        run();
+        const std::chrono::duration<double> elapsed =
+            std::chrono::steady_clock::now() - start;
+        best = std::min(best, elapsed.count());
+    }
+    return best;
+}
+
+// The candidate of values with the smallest time(value), current first so
+// that it wins ties.
+template <typename F>
+size_t fastest(size_t current, std::initializer_list<size_t> values,
+               F&& time) {
+    size_t best = current;
+    double best_time = time(current);
+    for (size_t value : values) {
+        if (value == current) {
+            continue;
+        }
+        const double t = time(value);
+        if (t < best_time) {
+            best = value;
+            best_time = t;
+        }
+    }
+    return best;
+}
+
+Matrix tuning_operand(size_t rows, size_t cols, size_t seed) {
+    Matrix m(rows, cols, UNINITIALIZED);
+    for (size_t i = 0; i < rows; ++i) {
+        for (size_t j = 0; j < cols; ++j) {
+            m(i, j) = static_cast<double>((i * 7 + j * 3 + seed) % 11) - 5.0;
+        }
+    }
+    return m;
+}
+
+// Apply the profile the environment asks for when the library is loaded.
+bool apply_startup_tuning() {
+    const std::string mode = detail::get_env("MATRIXOPS_AUTOTUNE");
+    if (mode == "off") {
+        return false;
+    }
+    const std::string path = tuning_profile_path();
+    std::error_code error;
+    if (!path.empty() && std::filesystem::exists(path, error)) {
+        try {
+            apply(load_tuning_profile(path), "profile");
+            return true;
+        } catch (const std::exception&) {
+            // Unreadable or stale: fall back as if there were none.
+        }
+    }
+    apply(heuristic_tuning(cache_topology()), "heuristic");
+    if (mode == "on" && !path.empty()) {
+        autotune_pending.store(true, std::memory_order_release);
+    }
+    return true;
+}
+
+[[maybe_unused]] const bool startup_tuning = apply_startup_tuning();
+
+} // namespace
+
+namespace detail {
+
+size_t elementwise_grain() {
+    return grain.load(std::memory_order_relaxed);
+}
+
+size_t transpose_block() {
+    return block.load(std::memory_order_relaxed);
+}
+
+void tune_on_first_use() {
+    if (!autotune_pending.load(std::memory_order_acquire) ||
+        !autotune_pending.exchange(false)) {
+        return;
+    }
+    const TuningProfile profile = autotune();
+    try {
+        save_tuning_profile(tuning_profile_path(), profile);
+    } catch (const std::runtime_error&) {
+        // The tuned values stay in use for this process.
+    }
+}
+
+} // namespace detail
+
+CacheTopology cache_topology() {
+    static const CacheTopology topology = detect_topology();
+    return topology;
+}
+
+TuningProfile tuning_profile() {
+    TuningProfile profile;
+    profile.blocking = gemm_blocking();
+    profile.strassen_crossover = strassen_settings().crossover;
+    profile.blas_threshold = blas_threshold();
+    profile.elementwise_grain = grain.load(std::memory_order_relaxed);
+    profile.transpose_block = block.load(std::memory_order_relaxed);
+    return profile;
+}
+
+void set_tuning_profile(const TuningProfile& profile) {
+    if (profile.strassen_crossover == 0 || profile.blas_threshold == 0 ||
+        profile.elementwise_grain == 0 || profile.transpose_block == 0) {
+        throw std::invalid_argument("Tuning parameters must be positive");
+    }
+    set_gemm_blocking(profile.blocking);
+    StrassenSettings strassen = strassen_settings();
+    strassen.crossover = profile.strassen_crossover;
+    set_strassen_settings(strassen);
+    set_blas_threshold(profile.blas_threshold);
+    grain.store(profile.elementwise_grain, std::memory_order_relaxed);
+    block.store(round_up(profile.transpose_block, TRANSPOSE_TILE_MULTIPLE),
+                std::memory_order_relaxed);
+    source.store("user", std::memory_order_relaxed);
+}
+
+TuningProfile heuristic_tuning(const CacheTopology& topology) {
+    // Sized for double, whose widest micro-kernel tile is 8 x 8.
+    constexpr size_t element = sizeof(double);
+    constexpr size_t nr = 8;
+    TuningProfile profile = tuning_profile();
+    GemmBlocking& b = profile.blocking;
+    b.kc = std::clamp<size_t>(round_down(topology.l1d / 2 / (nr * element),
+                                         16),
+                              64, 512);
+    b.mc = std::clamp<size_t>(round_down(topology.l2 / 2 / (b.kc * element),
+                                         16),
+                              32, 512);
+    b.nc = std::clamp<size_t>(round_down(topology.l3 / 2 / (b.kc * element),
+                                         16),
+                              256, 8192);
+    profile.elementwise_grain = std::clamp<size_t>(
+        floor_power_of_two(topology.l2 / 2 / element), size_t{1} << 12,
+        size_t{1} << 18);
+    // Two blocks of a pair in half of L1.
+    size_t side = TRANSPOSE_TILE_MULTIPLE;
+    while (2 * (2 * side) * (2 * side) * element <= topology.l1d / 2 &&
+           side < 128) {
+        side *= 2;
+    }
+    profile.transpose_block = side;
+    return profile;
+}
+
+TuningProfile autotune(const AutotuneOptions& options) {
+    const int trials = options.trials;
+    const StrassenSettings saved_strassen = strassen_settings();
+    const size_t saved_threshold = blas_threshold();
+    TuningProfile profile = heuristic_tuning(cache_topology());
+    set_tuning_profile(profile);
+
+    // Classic native products only while the blocking is searched.
+    StrassenSettings classic = saved_strassen;
+    classic.enabled = false;
+    set_strassen_settings(classic);
+    set_blas_threshold(std::numeric_limits<size_t>::max());
+
+    const size_t n = std::max<size_t>(options.gemm_size, 64);
+    const Matrix a = tuning_operand(n, n, 1);
+    const Matrix b = tuning_operand(n, n, 2);
+    Matrix c(n, n, UNINITIALIZED);
+    GemmBlocking& blocking = profile.blocking;
+    auto time_blocking = [&](const GemmBlocking& candidate) {
+        set_gemm_blocking(candidate);
+        return best_seconds(trials, [&] { multiply_into(a, b, c); });
+    };
+    blocking.kc = fastest(blocking.kc, {128, 192, 256, 320, 384, 512},
+                          [&](size_t kc) {
+                              GemmBlocking candidate = blocking;
+                              candidate.kc = kc;
+                              return time_blocking(candidate);
+                          });
+    blocking.mc = fastest(blocking.mc, {32, 48, 64, 96, 128, 192, 256, 384},
+                          [&](size_t mc) {
+                              GemmBlocking candidate = blocking;
+                              candidate.mc = mc;
+                              return time_blocking(candidate);
+                          });
+    blocking.nc = fastest(blocking.nc, {512, 1024, 2048, 4096, 8192},
+                          [&](size_t nc) {
+                              GemmBlocking candidate = blocking;
+                              candidate.nc = nc;
+                              return time_blocking(candidate);
+                          });
+    set_gemm_blocking(blocking);
+
+    // The grain only matters with more than one thread.
+    const size_t e = std::max<size_t>(options.elementwise_size, 256);
+    Matrix x = tuning_operand(e, e, 3);
+    const Matrix y = tuning_operand(e, e, 4);
+    Matrix sum(e, e, UNINITIALIZED);
+    if (num_threads() > 1) {
+        profile.elementwise_grain = fastest(
+            profile.elementwise_grain,
+            {size_t{1} << 12, size_t{1} << 13, size_t{1} << 14,
+             size_t{1} << 15, size_t{1} << 16, size_t{1} << 17,
+             size_t{1} << 18},
+            [&](size_t candidate) {
+                grain.store(candidate, std::memory_order_relaxed);
+                return best_seconds(trials, [&] {
+                    add_into(x, y, sum);
+                    sum *= 0.5;
+                    const Matrix t = x.transpose();
+                });
+            });
+        grain.store(profile.elementwise_grain, std::memory_order_relaxed);
+    }
+    profile.transpose_block =
+        fastest(profile.transpose_block, {8, 16, 32, 64, 128},
+                [&](size_t candidate) {
+                    block.store(candidate, std::memory_order_relaxed);
+                    return best_seconds(trials, [&] {
+                        x.transpose_inplace();
+                        x.transpose_inplace();
+                    });
+                });
+
+    // One level of Strassen against the classic product, from 256 up: the
+    // crossover is half the first size on which it wins.
+    profile.strassen_crossover = saved_strassen.crossover;
+    if (options.strassen) {
+        for (size_t s = 256; s <= options.max_strassen_size; s *= 2) {
+            const Matrix sa = tuning_operand(s, s, 5);
+            const Matrix sb = tuning_operand(s, s, 6);
+            Matrix sc(s, s, UNINITIALIZED);
+            set_strassen_settings(classic);
+            const double classic_time =
+                best_seconds(trials, [&] { multiply_into(sa, sb, sc); });
+            set_strassen_settings({true, s / 2});
+            const double strassen_time =
+                best_seconds(trials, [&] { multiply_into(sa, sb, sc); });
+            profile.strassen_crossover = s;
+            if (strassen_time < classic_time) {
+                profile.strassen_crossover = s / 2;
+                break;
+            }
+        }
+        set_strassen_settings(classic);
+    }
+
+    // The smallest cube on which the vendor BLAS beats the native kernels.
+    profile.blas_threshold = saved_threshold;
+    if (std::string(blas_backend()) != "none") {
+        for (size_t s : {16, 24, 32, 48, 64, 96, 128, 192, 256}) {
+            const Matrix ba = tuning_operand(s, s, 7);
+            const Matrix bb = tuning_operand(s, s, 8);
+            Matrix bc(s, s, UNINITIALIZED);
+            auto time_threshold = [&](size_t threshold) {
+                set_blas_threshold(threshold);
+                return best_seconds(std::max(trials, 10),
+                                    [&] { multiply_into(ba, bb, bc); });
+            };
+            const double native =
+                time_threshold(std::numeric_limits<size_t>::max());
+            if (time_threshold(0) < native) {
+                profile.blas_threshold = s * s * s;
+                break;
+            }
+        }
+    }
+
+    set_strassen_settings(saved_strassen);
+    apply(profile, "autotune");
+    return tuning_profile();
+}
+
+std::string tuning_profile_path() {
+    const std::string explicit_path =
+        detail::get_env("MATRIXOPS_TUNING_PROFILE");
+    if (!explicit_path.empty()) {
+        return explicit_path;
+    }
+    std::string base = detail::get_env("XDG_CACHE_HOME");
+    if (base.empty() && !detail::get_env("HOME").empty()) {
+        base = detail::get_env("HOME") + "/.cache";
+    }
+    if (base.empty()) {
+        base = detail::get_env("LOCALAPPDATA");
+    }
+    if (base.empty()) {
+        return {};
+    }
+    std::string host = host_name();
+    if (host.empty()) {
+        host = "localhost";
+    }
+    return (std::filesystem::path(base) / "matrixops" / (host + ".profile"))
+        .string();
+}
+
+void save_tuning_profile(const std::string& path,
+                         const TuningProfile& profile) {
+    const std::filesystem::path target(path);
+    std::error_code error;
+    if (target.has_parent_path()) {
+        std::filesystem::create_directories(target.parent_path(), error);
+    }
+    // Written aside and renamed, so that concurrent readers never see a
+    // partial file.
+    const std::string temporary = path + ".tmp";
+    {
+        std::ofstream out(temporary, std::ios::trunc);
+        out.imbue(std::locale::classic());
+        out << "# MatrixOps tuning profile\n"
+            << "# host " << host_name() << ", "
+            << simd_isa_name(simd_isa()) << ", " << num_threads()
+            << " threads\n"
+            << "mc = " << profile.blocking.mc << "\n"
+            << "kc = " << profile.blocking.kc << "\n"
+            << "nc = " << profile.blocking.nc << "\n"
+            << "strassen_crossover = " << profile.strassen_crossover << "\n"
+            << "blas_threshold = " << profile.blas_threshold << "\n"
+            << "elementwise_grain = " << profile.elementwise_grain << "\n"
+            << "transpose_block = " << profile.transpose_block << "\n";
+        out.flush();
+        if (!out) {
+            throw profile_error(path, "cannot be written");
+        }
+    }
+    std::filesystem::rename(temporary, target, error);
+    if (error) {
+        std::filesystem::remove(temporary, error);
+        throw profile_error(path, "cannot be written");
+    }
+}
+
+TuningProfile load_tuning_profile(const std::string& path) {
+    std::ifstream in(path);
+    if (!in) {
+        throw profile_error(path, "cannot be opened");
+    }
+    TuningProfile profile = tuning_profile();
+    std::string line;
+    size_t number = 0;
+    while (std::getline(in, line)) {
+        ++number;
+        line = line.substr(0, line.find('#'));
+        if (line.find_first_not_of(" \t\r") == std::string::npos) {
+            continue;
+        }
+        std::istringstream fields(line);
+        fields.imbue(std::locale::classic());
+        std::string key;
+        char equals = 0;
+        unsigned long long value = 0;
+        std::string rest;
+        if (!(fields >> key >> equals >> value) || equals != '=' ||
+            (fields >> rest) || value == 0) {
+            throw profile_error(path, "malformed line " +
+                                          std::to_string(number));
+        }
+        const size_t v = static_cast<size_t>(value);
+        if (key == "mc") {
+            profile.blocking.mc = v;
+        } else if (key == "kc") {
+            profile.blocking.kc = v;
+        } else if (key == "nc") {
+            profile.blocking.nc = v;
+        } else if (key == "strassen_crossover") {
+            profile.strassen_crossover = v;
+        } else if (key == "blas_threshold") {
+            profile.blas_threshold = v;
+        } else if (key == "elementwise_grain") {
+            profile.elementwise_grain = v;
+        } else if (key == "transpose_block") {
+            profile.transpose_block = v;
+        }
+    }
+    return profile;
+}
+
+const char* tuning_source() {
+    return source.load(std::memory_order_relaxed);
+}
+
+} // namespace matrixops
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <cstddef>
+
+namespace matrixops {
+namespace detail {
+
+/**
+ * @brief Side of the square blocks transpose_inplace() swaps pairwise, a
+ * multiple of every transpose tile
+ */
+size_t transpose_block();
+
+/**
+ * @brief Run the autotuning that MATRIXOPS_AUTOTUNE=on deferred to the
+ * first product, if it is still pending
+ *
+ * Only the first caller tunes; concurrent and nested callers go on with
+ * the parameters already in place.
+ */
+void tune_on_first_use();
+
+} // namespace detail
+} // namespace matrixops
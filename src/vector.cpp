@@ -0,0 +1,302 @@
+#include "matrixops/vector.h"
+#include "matrixops/parallel.h"
+#include <algorithm>
+#include <numeric>
+
+#include "kernels.h"
+#include "portable_kernels.h"
+#include "reduction.h"
+
+namespace matrixops {
+
+using detail::ELEMENTWISE_GRAIN;
+
+namespace {
+
+// Single-threaded kernels over one block; the element types without SIMD
+// kernels go through the portable templates.
+
+template <typename T>
+void add_block(const T* a, const T* b, T* out, size_t n) {
+    if constexpr (detail::HAS_SIMD_KERNELS<T>) {
+        detail::typed_kernels<T>().add(a, b, out, n);
+    } else {
+        detail::add_scalar(a, b, out, n);
+    }
+}
+
+template <typename T>
+void scale_block(const T* a, T scalar, T* out, size_t n) {
+    if constexpr (detail::HAS_SIMD_KERNELS<T>) {
+        detail::typed_kernels<T>().scale(a, scalar, out, n);
+    } else {
+        detail::scale_scalar(a, scalar, out, n);
+    }
+}
+
+template <typename T>
+void axpy_block(T alpha, const T* x, T* y, size_t n) {
+    if constexpr (detail::HAS_SIMD_KERNELS<T>) {
+        detail::typed_kernels<T>().axpy(alpha, x, y, n);
+    } else {
+        detail::axpy_scalar(alpha, x, y, n);
+    }
+}
+
+// Unconjugated sum of a[i] * b[i], the row-times-vector step of gemv.
+template <typename T>
+T dot_block(const T* a, const T* b, size_t n) {
+    if constexpr (detail::HAS_SIMD_KERNELS<T>) {
+        return detail::typed_kernels<T>().dot(a, b, n);
+    } else {
+        return detail::dot_scalar(a, b, n);
+    }
+}
+
+template <typename T>
+T dotc_block(const T* a, const T* b, size_t n) {
+    return dot_block(a, b, n);
+}
+
+template <typename R>
+std::complex<R> dotc_block(const std::complex<R>* a,
+                           const std::complex<R>* b, size_t n) {
+    std::complex<R> sum(0);
+    for (size_t i = 0; i < n; ++i) {
+        detail::multiply_add(sum, std::conj(a[i]), b[i]);
+    }
+    return sum;
+}
+
+template <typename T>
+void add_arrays(const T* a, const T* b, T* out, size_t n) {
+    parallel_for(0, n, ELEMENTWISE_GRAIN, [&](size_t lo, size_t hi) {
+        add_block(a + lo, b + lo, out + lo, hi - lo);
+    });
+}
+
+template <typename T>
+void scale_array(const T* a, T scalar, T* out, size_t n) {
+    parallel_for(0, n, ELEMENTWISE_GRAIN, [&](size_t lo, size_t hi) {
+        scale_block(a + lo, scalar, out + lo, hi - lo);
+    });
+}
+
+template <typename T>
+void axpy_array(T alpha, const T* x, T* y, size_t n) {
+    parallel_for(0, n, ELEMENTWISE_GRAIN, [&](size_t lo, size_t hi) {
+        axpy_block(alpha, x + lo, y + lo, hi - lo);
+    });
+}
+
+template <typename T>
+void check_same_size(const BasicVector<T>& x, const BasicVector<T>& y) {
+    if (x.size() != y.size()) {
+        throw std::invalid_argument("Vector sizes must match");
+    }
+}
+
+} // namespace
+
+template <typename T>
+BasicVector<T>::BasicVector(size_t size, T init_value)
+    : data_(size, init_value) {
+    if (size == 0) {
+        throw std::invalid_argument("Vector size must be positive");
+    }
+}
+
+template <typename T>
+BasicVector<T>::BasicVector(size_t size, UninitializedTag) : data_(size) {
+    if (size == 0) {
+        throw std::invalid_argument("Vector size must be positive");
+    }
+}
+
+template <typename T>
+BasicVector<T>::BasicVector(std::initializer_list<T> values)
+    : data_(values.begin(), values.end()) {
+    if (values.size() == 0) {
+        throw std::invalid_argument("Vector size must be positive");
+    }
+}
+
+template <typename T>
+T& BasicVector<T>::operator()(size_t i) {
+    if (i >= data_.size()) {
+        throw std::out_of_range("Vector index out of range");
+    }
+    return data_[i];
+}
+
+template <typename T>
+T BasicVector<T>::operator()(size_t i) const {
+    if (i >= data_.size()) {
+        throw std::out_of_range("Vector index out of range");
+    }
+    return data_[i];
+}
+
+template <typename T>
+BasicVector<T> BasicVector<T>::operator+(const BasicVector& other) const {
+    check_same_size(*this, other);
+    BasicVector result(size(), UNINITIALIZED);
+    add_arrays(data(), other.data(), result.data(), size());
+    return result;
+}
+
+template <typename T>
+BasicVector<T> BasicVector<T>::operator-(const BasicVector& other) const {
+    BasicVector result = *this;
+    result -= other;
+    return result;
+}
+
+template <typename T>
+BasicVector<T> BasicVector<T>::operator*(T scalar) const {
+    BasicVector result(size(), UNINITIALIZED);
+    scale_array(data(), scalar, result.data(), size());
+    return result;
+}
+
+template <typename T>
+BasicVector<T>& BasicVector<T>::operator+=(const BasicVector& other) {
+    check_same_size(*this, other);
+    add_arrays(data(), other.data(), data(), size());
+    return *this;
+}
+
+// y + (-1) * x is exactly y - x.
+template <typename T>
+BasicVector<T>& BasicVector<T>::operator-=(const BasicVector& other) {
+    check_same_size(*this, other);
+    axpy_array(T(-1), other.data(), data(), size());
+    return *this;
+}
+
+template <typename T>
+BasicVector<T>& BasicVector<T>::operator*=(T scalar) {
+    scale_array(data(), scalar, data(), size());
+    return *this;
+}
+
+template <typename T>
+typename BasicVector<T>::real_type BasicVector<T>::norm() const {
+    return nrm2(*this);
+}
+
+template <typename T>
+T dot(const BasicVector<T>& x, const BasicVector<T>& y) {
+    check_same_size(x, y);
+    const T* a = x.data();
+    const T* b = y.data();
+    const size_t n = x.size();
+    const ReductionMode mode = reduction_mode();
+    if (mode != ReductionMode::FAST) {
+        return detail::ordered_dotc(a, b, n, mode);
+    }
+    const size_t blocks = (n + ELEMENTWISE_GRAIN - 1) / ELEMENTWISE_GRAIN;
+    if (blocks == 1) {
+        return dotc_block(a, b, n);
+    }
+
+    std::vector<T> partial(blocks);
+    parallel_for(0, blocks, 1, [&](size_t lo, size_t hi) {
+        for (size_t block = lo; block < hi; ++block) {
+            const size_t offset = block * ELEMENTWISE_GRAIN;
+            partial[block] =
+                dotc_block(a + offset, b + offset,
+                           std::min(ELEMENTWISE_GRAIN, n - offset));
+        }
+    });
+    return std::accumulate(partial.begin(), partial.end(), T(0));
+}
+
+template <typename T>
+void axpy(T alpha, const BasicVector<T>& x, BasicVector<T>& y) {
+    check_same_size(x, y);
+    axpy_array(alpha, x.data(), y.data(), x.size());
+}
+
+template <typename T>
+typename BasicVector<T>::real_type nrm2(const BasicVector<T>& x) {
+    using Real = typename BasicVector<T>::real_type;
+    return static_cast<Real>(detail::euclidean_norm(x.data(), x.size()));
+}
+
+// Row-major a: each y[i] is the dot product of row i with x, and x stays
+// in cache while the rows stream through.
+template <typename T>
+void gemv(T alpha, const BasicMatrix<T>& a, const BasicVector<T>& x, T beta,
+          BasicVector<T>& y) {
+    if (x.size() != a.cols() || y.size() != a.rows()) {
+        throw std::invalid_argument(
+            "Vector size incompatible for multiplication");
+    }
+    if (&x == &y) {
+        throw std::invalid_argument(
+            "Matrix multiplication output must not alias an operand");
+    }
+    const size_t n = a.cols();
+    const size_t grain = std::max<size_t>(ELEMENTWISE_GRAIN / n, 1);
+    parallel_for(0, a.rows(), grain, [&](size_t lo, size_t hi) {
+        for (size_t i = lo; i < hi; ++i) {
+            const T d = dot_block(a.data() + i * a.stride(), x.data(), n);
+            T& y_i = y.unchecked(i);
+            y_i = beta == T(0) ? alpha * d : alpha * d + beta * y_i;
+        }
+    });
+}
+
+template <typename T>
+void ger(T alpha, const BasicVector<T>& x, const BasicVector<T>& y,
+         BasicMatrix<T>& a) {
+    if (x.size() != a.rows() || y.size() != a.cols()) {
+        throw std::invalid_argument(
+            "Vector size incompatible for rank-1 update");
+    }
+    const size_t n = a.cols();
+    const size_t grain = std::max<size_t>(ELEMENTWISE_GRAIN / n, 1);
+    parallel_for(0, a.rows(), grain, [&](size_t lo, size_t hi) {
+        for (size_t i = lo; i < hi; ++i) {
+            axpy_block(alpha * x.unchecked(i), y.data(),
+                       a.data() + i * a.stride(), n);
+        }
+    });
+}
+
+template <typename T>
+void multiply_into(const BasicMatrix<T>& a, const BasicVector<T>& x,
+                   BasicVector<T>& y) {
+    gemv(T(1), a, x, T(0), y);
+}
+
+template <typename T>
+BasicVector<T> operator*(const BasicMatrix<T>& a, const BasicVector<T>& x) {
+    BasicVector<T> y(a.rows(), UNINITIALIZED);
+    gemv(T(1), a, x, T(0), y);
+    return y;
+}
+
+#define MATRIXOPS_INSTANTIATE_VECTOR(T)                                        \
+    template class BasicVector<T>;                                             \
+    template T dot(const BasicVector<T>&, const BasicVector<T>&);             \
+    template void axpy(T, const BasicVector<T>&, BasicVector<T>&);            \
+    template BasicVector<T>::real_type nrm2(const BasicVector<T>&);           \
+    template void gemv(T, const BasicMatrix<T>&, const BasicVector<T>&, T,    \
+                       BasicVector<T>&);                                       \
+    template void ger(T, const BasicVector<T>&, const BasicVector<T>&,        \
+                      BasicMatrix<T>&);                                        \
+    template void multiply_into(const BasicMatrix<T>&, const BasicVector<T>&, \
+                                BasicVector<T>&);                              \
+    template BasicVector<T> operator*(const BasicMatrix<T>&,                   \
+                                      const BasicVector<T>&);
+
+MATRIXOPS_INSTANTIATE_VECTOR(float)
+MATRIXOPS_INSTANTIATE_VECTOR(double)
+MATRIXOPS_INSTANTIATE_VECTOR(std::complex<float>)
+MATRIXOPS_INSTANTIATE_VECTOR(std::complex<double>)
+
+#undef MATRIXOPS_INSTANTIATE_VECTOR
+
+} // namespace matrixops
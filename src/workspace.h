@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstddef>
+#include <deque>
+#include <vector>
+
+namespace matrixops {
+namespace detail {
+
+/**
+ * @brief Per-thread scratch buffer, reused across calls
+ *
+ * A thread that waits in parallel_for() or on a future runs other queued
+ * tasks meanwhile, and those may need the same kind of buffer while the
+ * waiting call still uses its own. Each Workspace therefore takes the next
+ * level of its thread's stack of buffers for its lifetime: nested calls
+ * get buffers of their own, and steady-state calls still do not allocate.
+ * Tag tells apart the buffers of one element type. Workspaces are local
+ * variables, so a thread releases its levels in reverse order.
+ */
+template <typename T, typename Tag>
+class Workspace {
+public:
+    Workspace() : buffer_(take_level()) {}
+    ~Workspace() { --levels().used; }
+
+    Workspace(const Workspace&) = delete;
+    Workspace& operator=(const Workspace&) = delete;
+
+    /**
+     * @brief The buffer, grown to at least size elements
+     *
+     * Growing invalidates pointers returned before.
+     */
+    T* data(size_t size) {
+        if (buffer_.size() < size) {
+            buffer_.resize(size);
+        }
+        return buffer_.data();
+    }
+
+private:
+    // A deque, so that adding a level leaves the others in place.
+    struct Levels {
+        std::deque<std::vector<T>> buffers;
+        size_t used = 0;
+    };
+
+    static Levels& levels() {
+        thread_local Levels stack;
+        return stack;
+    }
+
+    static std::vector<T>& take_level() {
+        Levels& stack = levels();
+        if (stack.used == stack.buffers.size()) {
+            stack.buffers.emplace_back();
+        }
+        return stack.buffers[stack.used++];
+    }
+
+    std::vector<T>& buffer_;
+};
+
+} // namespace detail
+} // namespace matrixops
@@ -0,0 +1,76 @@
+#include <catch2/catch_test_macros.hpp>
+#include "matrixops/matrix.h"
+#include "test_helpers.h"
+#include <algorithm>
+#include <numeric>
+
+using namespace matrixops;
+using namespace matrixops::testing;
+
+TEST_CASE("Unchecked access and raw data", "[access]") {
+    Matrix m = make_index_matrix(3, 4, 10);
+    const Matrix& cm = m;
+
+    REQUIRE(m.stride() == 4);
+    REQUIRE(m.unchecked(2, 3) == m(2, 3));
+    REQUIRE(cm.unchecked(1, 2) == 12.0);
+
+    m.unchecked(0, 1) = -1.0;
+    REQUIRE(m(0, 1) == -1.0);
+
+    for (size_t i = 0; i < 3; ++i) {
+        for (size_t j = 0; j < 4; ++j) {
+            REQUIRE(cm.data()[i * cm.stride() + j] == cm(i, j));
+        }
+    }
+
+    m.data()[m.stride() + 1] = 99.0;
+    REQUIRE(m(1, 1) == 99.0);
+}
+
+TEST_CASE("Row and column views", "[access]") {
+    Matrix m = make_index_matrix(3, 4, 10);
+
+    SECTION("Rows are contiguous") {
+        StridedSpan<double> r = m.row(1);
+        REQUIRE(r.size() == 4);
+        REQUIRE(r.stride() == 1);
+        REQUIRE(r.is_contiguous());
+        REQUIRE(r.data() == &m(1, 0));
+        REQUIRE(r[3] == m(1, 3));
+        r[2] = 7.5;
+        REQUIRE(m(1, 2) == 7.5);
+    }
+
+    SECTION("Columns step by the leading dimension") {
+        StridedSpan<double> c = m.col(2);
+        REQUIRE(c.size() == 3);
+        REQUIRE(c.stride() == m.stride());
+        REQUIRE_FALSE(c.is_contiguous());
+        REQUIRE(c[0] == m(0, 2));
+        REQUIRE(c[2] == m(2, 2));
+        std::fill(c.begin(), c.end(), 0.0);
+        for (size_t i = 0; i < 3; ++i) {
+            REQUIRE(m(i, 2) == 0.0);
+        }
+    }
+
+    SECTION("Views work with standard algorithms") {
+        const Matrix& cm = m;
+        StridedSpan<const double> c = cm.col(1);
+        REQUIRE(std::accumulate(c.begin(), c.end(), 0.0) == 1.0 + 11.0 + 21.0);
+        REQUIRE(c.end() - c.begin() == 3);
+        REQUIRE(*std::max_element(cm.row(2).begin(), cm.row(2).end()) ==
+                23.0);
+    }
+
+    SECTION("Mutable views convert to const views") {
+        StridedSpan<const double> r = m.row(0);
+        REQUIRE(r[1] == 1.0);
+    }
+
+    SECTION("Out of range views throw") {
+        REQUIRE_THROWS_AS(m.row(3), std::out_of_range);
+        REQUIRE_THROWS_AS(m.col(4), std::out_of_range);
+    }
+}
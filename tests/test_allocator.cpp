@@ -0,0 +1,209 @@
+#include <catch2/catch_test_macros.hpp>
+#include "matrixops/allocator.h"
+#include "matrixops/matrix.h"
+
+#include <complex>
+#include <cstdint>
+#include <stdexcept>
+#include <utility>
+
+using namespace matrixops;
+
+namespace {
+
+bool is_aligned(const void* p, size_t alignment) {
+    return reinterpret_cast<std::uintptr_t>(p) % alignment == 0;
+}
+
+// Counts the traffic reaching the heap through it.
+class CountingResource : public MemoryResource {
+public:
+    void* allocate(size_t bytes) override {
+        ++allocations;
+        return heap_resource().allocate(bytes);
+    }
+
+    void deallocate(void* p, size_t bytes) noexcept override {
+        ++deallocations;
+        heap_resource().deallocate(p, bytes);
+    }
+
+    int allocations = 0;
+    int deallocations = 0;
+};
+
+} // namespace
+
+TEST_CASE("Matrix storage is cache-line aligned", "[allocator]") {
+    for (size_t n : {1, 3, 17, 1000}) {
+        Matrix m(n, 3);
+        REQUIRE(is_aligned(m.data(), STORAGE_ALIGNMENT));
+    }
+    Matrix sum = Matrix(5, 7, 1.0) + Matrix(5, 7, 2.0);
+    REQUIRE(is_aligned(sum.data(), STORAGE_ALIGNMENT));
+
+    // Large buffers are placed so that they can use huge pages.
+    const bool saved = huge_pages();
+    set_huge_pages(true);
+    Matrix big(1024, 512, 1.0);
+    REQUIRE(is_aligned(big.data(), size_t{2} << 20));
+    REQUIRE(big(1023, 511) == 1.0);
+    set_huge_pages(saved);
+}
+
+TEST_CASE("Scoped resources route matrix storage", "[allocator]") {
+    // Larger than SMALL_MATRIX_BYTES, so that the storage is on the heap.
+    CountingResource counting;
+    Matrix outside(5, 5, 1.0);
+    {
+        ScopedResource scope(counting);
+        REQUIRE(&current_resource() == &counting);
+
+        Matrix a(6, 6, 1.0);
+        Matrix b = a + a; // Temporaries follow the scope too
+        Matrix copied = outside;
+        REQUIRE(counting.allocations == 3);
+        REQUIRE(b(2, 2) == 2.0);
+        REQUIRE(copied(1, 1) == 1.0);
+
+        // A move keeps the source's storage.
+        Matrix moved = std::move(outside);
+        REQUIRE(counting.allocations == 3);
+    }
+    REQUIRE(&current_resource() == &heap_resource());
+    REQUIRE(counting.deallocations == 3);
+}
+
+TEST_CASE("Scoped resources nest", "[allocator]") {
+    CountingResource outer;
+    CountingResource inner;
+    {
+        ScopedResource outer_scope(outer);
+        {
+            ScopedResource inner_scope(inner);
+            Matrix m(6, 6);
+            REQUIRE(&current_resource() == &inner);
+        }
+        REQUIRE(&current_resource() == &outer);
+    }
+    REQUIRE(inner.allocations == 1);
+    REQUIRE(outer.allocations == 0);
+}
+
+TEST_CASE("Arena allocation and reset", "[allocator]") {
+    CountingResource upstream;
+    Arena arena(4096, upstream);
+
+    SECTION("Bump allocation is aligned and reuses chunks after reset") {
+        void* p = arena.allocate(10);
+        void* q = arena.allocate(100);
+        REQUIRE(is_aligned(p, STORAGE_ALIGNMENT));
+        REQUIRE(is_aligned(q, STORAGE_ALIGNMENT));
+        REQUIRE(p != q);
+        REQUIRE(arena.bytes_used() == 64 + 128);
+        REQUIRE(upstream.allocations == 1);
+
+        arena.reset();
+        REQUIRE(arena.bytes_used() == 0);
+        REQUIRE(arena.allocate(10) == p);
+        REQUIRE(upstream.allocations == 1);
+    }
+
+    SECTION("Growth and oversized requests") {
+        arena.allocate(3000);
+        arena.allocate(3000);
+        REQUIRE(upstream.allocations == 2);
+        arena.allocate(10000);
+        REQUIRE(upstream.allocations == 3);
+        REQUIRE(arena.capacity() == 4096 + 4096 + 10048);
+
+        // After a reset the same sequence fits in the existing chunks.
+        arena.reset();
+        arena.allocate(3000);
+        arena.allocate(3000);
+        arena.allocate(10000);
+        REQUIRE(upstream.allocations == 3);
+    }
+
+    SECTION("Matrices and temporaries from an arena") {
+        {
+            ScopedResource scope(arena);
+            for (int step = 0; step < 10; ++step) {
+                Matrix a(8, 8, 1.0);
+                Matrix b = a * 2.0 + a;
+                REQUIRE(b(7, 7) == 3.0);
+            }
+        }
+        // The buffers die in LIFO order, so each step reuses the first.
+        REQUIRE(upstream.allocations == 1);
+        REQUIRE(arena.bytes_used() == 0);
+    }
+
+    SECTION("Only the most recent allocation is reclaimed") {
+        void* p = arena.allocate(64);
+        void* q = arena.allocate(64);
+        arena.deallocate(p, 64);
+        REQUIRE(arena.bytes_used() == 128);
+        arena.deallocate(q, 64);
+        REQUIRE(arena.bytes_used() == 64);
+        REQUIRE(arena.allocate(64) == q);
+    }
+
+    SECTION("Chunk size must be positive") {
+        REQUIRE_THROWS_AS(Arena(0), std::invalid_argument);
+    }
+}
+
+TEST_CASE("Arena releases its chunks on destruction", "[allocator]") {
+    CountingResource upstream;
+    {
+        Arena arena(1024, upstream);
+        arena.allocate(10);
+        arena.allocate(2000);
+    }
+    REQUIRE(upstream.allocations == 2);
+    REQUIRE(upstream.deallocations == 2);
+}
+
+TEST_CASE("Small matrices are stored inline", "[allocator]") {
+    CountingResource counting;
+    {
+        ScopedResource scope(counting);
+        Matrix a(4, 4, 1.0);
+        Matrix b = a;
+        Matrix c = a * b + a;
+        Matrix moved = std::move(c);
+        REQUIRE(moved(3, 3) == 5.0);
+        REQUIRE(is_aligned(moved.data(), STORAGE_ALIGNMENT));
+        BasicMatrix<std::complex<double>> z(2, 4);
+        REQUIRE(z(1, 3) == std::complex<double>(0.0));
+
+        // One element past the inline capacity goes to the resource.
+        Matrix large(1, SMALL_MATRIX_BYTES / sizeof(double) + 1, 1.0);
+        REQUIRE(counting.allocations == 1);
+    }
+    REQUIRE(counting.deallocations == 1);
+}
+
+TEST_CASE("Moved-from matrices are empty", "[allocator]") {
+    // Inline and heap storage
+    for (size_t cols : {size_t{4}, SMALL_MATRIX_BYTES / sizeof(double) + 1}) {
+        Matrix a(3, cols, 2.0);
+        const Matrix moved = std::move(a);
+        REQUIRE(moved.rows() == 3);
+        REQUIRE(moved(2, cols - 1) == 2.0);
+        REQUIRE(a.rows() == 0);
+        REQUIRE(a.cols() == 0);
+        REQUIRE_THROWS_AS(a(0, 0), std::out_of_range);
+
+        Matrix b(3, cols, 1.0);
+        b = std::move(a);
+        REQUIRE(b.rows() == 0);
+        REQUIRE(b.cols() == 0);
+
+        // A moved-from matrix can be assigned again
+        a = moved;
+        REQUIRE(a.rows() == 3);
+        REQUIRE(a(2, cols - 1) == 2.0);
+    }
+}
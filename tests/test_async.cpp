@@ -0,0 +1,179 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_approx.hpp>
+#include "matrixops/async.h"
+#include "matrixops/parallel.h"
+#include "test_helpers.h"
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+using namespace matrixops;
+using namespace matrixops::testing;
+using Catch::Approx;
+
+namespace {
+
+// Sets the thread count for the scope of a test.
+class ScopedThreads {
+public:
+    explicit ScopedThreads(size_t n) : saved_(num_threads()) {
+        set_num_threads(n);
+    }
+    ~ScopedThreads() { set_num_threads(saved_); }
+
+private:
+    size_t saved_;
+};
+
+// Spins until flag is set, for at most a few seconds.
+bool wait_for_flag(const std::atomic<bool>& flag) {
+    const auto deadline =
+        std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (!flag.load()) {
+        if (std::chrono::steady_clock::now() > deadline) {
+            return false;
+        }
+        std::this_thread::yield();
+    }
+    return true;
+}
+
+} // namespace
+
+TEST_CASE("Async operations chain through their futures", "[async]") {
+    for (const size_t threads : {size_t{1}, size_t{4}}) {
+        ScopedThreads scope(threads);
+        const Matrix a = make_matrix(120, 80, 1);
+        const Matrix b = make_matrix(120, 90, 2);
+        const Matrix c = make_matrix(80, 90, 3);
+
+        // (a^T * b) + c, with a shared by reference and b moved in.
+        const Future<Matrix> at = async_transpose(std::cref(a));
+        const Future<Matrix> product = async_multiply(at, Matrix(b));
+        const Future<Matrix> sum = async_add(product, c);
+        REQUIRE(sum.valid());
+        REQUIRE(same_elements(sum.get(), Matrix(a.transpose() * b + c)));
+        REQUIRE(product.ready());
+        REQUIRE(same_elements(product.get(), a.transpose() * b));
+
+        const Future<double> norm = async_call(
+            [](const Matrix& m, double scale) { return scale * m.norm(); },
+            sum, 2.0);
+        REQUIRE(norm.get() == Approx(2.0 * sum.get().norm()));
+    }
+}
+
+TEST_CASE("Async errors reach the futures depending on them", "[async]") {
+    ScopedThreads scope(4);
+    const Future<Matrix> bad =
+        async_multiply(Matrix(3, 4, 1.0), Matrix(3, 4, 1.0));
+    const Future<Matrix> dependent = async_add(bad, Matrix(3, 4, 1.0));
+    REQUIRE_THROWS_AS(bad.get(), std::invalid_argument);
+    REQUIRE_THROWS_AS(dependent.get(), std::invalid_argument);
+
+    const Future<Matrix> none;
+    REQUIRE_FALSE(none.valid());
+    REQUIRE_THROWS_AS(none.get(), std::future_error);
+    REQUIRE_THROWS_AS(async_transpose(none), std::future_error);
+}
+
+TEST_CASE("Independent async jobs run concurrently",
+          "[async][parallel]") {
+    ScopedThreads scope(4);
+    // Each job waits for the other to have started: this only completes
+    // if both are running at the same time.
+    std::atomic<bool> first{false};
+    std::atomic<bool> second{false};
+    const Future<bool> a = async_call([&] {
+        first = true;
+        return wait_for_flag(second);
+    });
+    const Future<bool> b = async_call([&] {
+        second = true;
+        return wait_for_flag(first);
+    });
+    REQUIRE(a.get());
+    REQUIRE(b.get());
+}
+
+TEST_CASE("Async jobs start in submission order", "[async][parallel]") {
+    // One worker: the caller only waits, so the worker runs every job.
+    ScopedThreads scope(2);
+    std::atomic<bool> release{false};
+    const Future<bool> blocker =
+        async_call([&] { return wait_for_flag(release); });
+
+    std::mutex mutex;
+    std::vector<int> order;
+    std::vector<Future<int>> jobs;
+    for (int i = 0; i < 16; ++i) {
+        jobs.push_back(async_call([&, i] {
+            // The parallel work of a running job goes before new jobs.
+            const Matrix m = make_matrix(200, 200, 0);
+            const Matrix sum = m + m;
+            std::lock_guard<std::mutex> lock(mutex);
+            order.push_back(i);
+            return static_cast<int>(sum(0, 0));
+        }));
+    }
+    release = true;
+    REQUIRE(blocker.get());
+    for (const Future<int>& job : jobs) {
+        REQUIRE(job.get() == -10);
+    }
+    for (int i = 0; i < 16; ++i) {
+        REQUIRE(order[i] == i);
+    }
+}
+
+TEST_CASE("Async jobs may wait for later jobs", "[async][parallel]") {
+    // The only worker runs the outer job, so it has to run the inner one
+    // while it waits.
+    ScopedThreads scope(2);
+    std::atomic<bool> started{false};
+    std::promise<Future<Matrix>> inner;
+    std::shared_future<Future<Matrix>> inner_future = inner.get_future();
+    const Future<double> outer = async_call([&] {
+        started = true;
+        return inner_future.get().get()(0, 0);
+    });
+    REQUIRE(wait_for_flag(started));
+    inner.set_value(async_call([] { return Matrix(2, 2, 3.0); }));
+    REQUIRE(outer.get() == 3.0);
+}
+
+TEST_CASE("Async jobs multiply while waiting for other jobs",
+          "[async][parallel]") {
+    // A worker waiting for a future runs other jobs meanwhile, each with
+    // products of its own that go parallel, nested on the same thread.
+    const Matrix a = make_matrix(200, 190, 1);
+    const Matrix b = make_matrix(190, 210, 2);
+    const Matrix expected = [&] {
+        ScopedThreads serial(1);
+        return Matrix(a * b);
+    }();
+
+    ScopedThreads scope(8);
+    std::vector<Future<bool>> outer;
+    for (int i = 0; i < 12; ++i) {
+        outer.push_back(async_call([&] {
+            const Future<Matrix> inner =
+                async_multiply(std::cref(a), std::cref(b));
+            const Matrix before = a * b;
+            const Matrix& waited = inner.get();
+            const Matrix after = a * b;
+            return same_elements(before, expected) &&
+                   same_elements(waited, expected) &&
+                   same_elements(after, expected);
+        }));
+    }
+    for (const Future<bool>& result : outer) {
+        REQUIRE(result.get());
+    }
+}
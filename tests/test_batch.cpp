@@ -0,0 +1,269 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_approx.hpp>
+#include "matrixops/batch.h"
+#include "matrixops/parallel.h"
+#include "matrixops/simd.h"
+#include "test_helpers.h"
+
+#include <complex>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+using namespace matrixops;
+using namespace matrixops::testing;
+using Catch::Approx;
+
+namespace {
+
+const SimdIsa ALL_ISAS[] = {SimdIsa::SCALAR, SimdIsa::SSE2, SimdIsa::AVX2,
+                            SimdIsa::AVX512, SimdIsa::NEON};
+
+template <typename T>
+BasicMatrixBatch<T> make_batch(size_t count, size_t rows, size_t cols,
+                               size_t seed) {
+    BasicMatrixBatch<T> batch(count, rows, cols);
+    for (size_t b = 0; b < count; ++b) {
+        batch.set_matrix(b, make_matrix<T>(rows, cols, seed + b));
+    }
+    return batch;
+}
+
+template <typename T>
+void require_equal(const BasicMatrix<T>& actual,
+                   const BasicMatrix<T>& expected) {
+    REQUIRE(actual.rows() == expected.rows());
+    REQUIRE(actual.cols() == expected.cols());
+    for (size_t i = 0; i < expected.rows(); ++i) {
+        for (size_t j = 0; j < expected.cols(); ++j) {
+            REQUIRE(actual(i, j) == expected(i, j));
+        }
+    }
+}
+
+} // namespace
+
+TEST_CASE("MatrixBatch layout and access", "[batch]") {
+    MatrixBatch batch(11, 2, 3, 1.5);
+    REQUIRE(batch.count() == 11);
+    REQUIRE(batch.rows() == 2);
+    REQUIRE(batch.cols() == 3);
+    REQUIRE(MatrixBatch::LANES == 8);
+    REQUIRE(BasicMatrixBatch<float>::LANES == 16);
+    REQUIRE(batch.groups() == 2);
+    REQUIRE(reinterpret_cast<uintptr_t>(batch.data()) % STORAGE_ALIGNMENT ==
+            0);
+
+    // Element (i, j) of matrix b, with b split into group and lane.
+    batch(10, 1, 2) = 4.0;
+    REQUIRE(batch.data()[(1 * 6 + 1 * 3 + 2) * 8 + 2] == 4.0);
+    REQUIRE(batch.unchecked(10, 1, 2) == 4.0);
+    REQUIRE(batch(0, 0, 0) == 1.5);
+    // The padding matrices of the last group are zero.
+    REQUIRE(batch.data()[(6 + 0) * 8 + 3] == 0.0);
+
+    const Matrix m = make_matrix<double>(2, 3, 4);
+    batch.set_matrix(7, m);
+    require_equal(batch.matrix(7), m);
+
+    REQUIRE_THROWS_AS(batch(11, 0, 0), std::out_of_range);
+    REQUIRE_THROWS_AS(batch(0, 2, 0), std::out_of_range);
+    REQUIRE_THROWS_AS(batch.matrix(11), std::out_of_range);
+    REQUIRE_THROWS_AS(batch.set_matrix(0, Matrix(3, 2)),
+                      std::invalid_argument);
+    REQUIRE_THROWS_AS(MatrixBatch(0, 2, 2), std::invalid_argument);
+}
+
+TEST_CASE("Batched GEMM matches per-matrix products on every ISA",
+          "[batch][simd]") {
+    const SimdIsa saved = simd_isa();
+
+    // Counts that leave partial groups, and widths that exercise both the
+    // column blocks and the remainder of every kernel.
+    const size_t shapes[][4] = {
+        {1, 1, 1, 1}, {5, 3, 4, 2}, {19, 16, 16, 16}, {33, 7, 9, 13}};
+    for (SimdIsa isa : ALL_ISAS) {
+        if (!simd_isa_supported(isa)) {
+            continue;
+        }
+        INFO("ISA: " << simd_isa_name(isa));
+        set_simd_isa(isa);
+        for (const auto& shape : shapes) {
+            const size_t count = shape[0];
+            const size_t m = shape[1];
+            const size_t k = shape[2];
+            const size_t n = shape[3];
+            INFO(count << " x " << m << " x " << k << " x " << n);
+
+            const MatrixBatch a = make_batch<double>(count, m, k, 1);
+            const MatrixBatch b = make_batch<double>(count, k, n, 2);
+            MatrixBatch c(count, m, n);
+            multiply_into(a, b, c);
+
+            const auto af = make_batch<float>(count, m, k, 1);
+            const auto bf = make_batch<float>(count, k, n, 2);
+            BasicMatrixBatch<float> cf(count, m, n, 1.0F);
+            gemm(2.0F, af, bf, -1.0F, cf);
+
+            for (size_t i = 0; i < count; ++i) {
+                require_equal(c.matrix(i), a.matrix(i) * b.matrix(i));
+                BasicMatrix<float> expected = af.matrix(i) * bf.matrix(i);
+                expected *= 2.0F;
+                expected += BasicMatrix<float>(m, n, -1.0F);
+                require_equal(cf.matrix(i), expected);
+            }
+        }
+    }
+    set_simd_isa(saved);
+}
+
+TEST_CASE("Batched GEMM handles beta and complex types", "[batch]") {
+    // beta = 0 overwrites c without reading it.
+    const MatrixBatch a = make_batch<double>(9, 4, 4, 3);
+    MatrixBatch c(9, 4, 4, std::numeric_limits<double>::quiet_NaN());
+    gemm(1.0, a, a, 0.0, c);
+    for (size_t i = 0; i < 9; ++i) {
+        require_equal(c.matrix(i), a.matrix(i) * a.matrix(i));
+    }
+
+    using Complex = std::complex<double>;
+    BasicMatrixBatch<Complex> z(6, 3, 3);
+    for (size_t b = 0; b < 6; ++b) {
+        for (size_t i = 0; i < 3; ++i) {
+            for (size_t j = 0; j < 3; ++j) {
+                z(b, i, j) = Complex(static_cast<double>(i + b),
+                                     static_cast<double>(j) - 1.0);
+            }
+        }
+    }
+    BasicMatrixBatch<Complex> zz(6, 3, 3);
+    multiply_into(z, z, zz);
+    for (size_t b = 0; b < 6; ++b) {
+        require_equal(zz.matrix(b), z.matrix(b) * z.matrix(b));
+    }
+
+    MatrixBatch wrong_count(8, 4, 4);
+    MatrixBatch wrong_shape(9, 4, 3);
+    REQUIRE_THROWS_AS(multiply_into(a, wrong_count, c),
+                      std::invalid_argument);
+    REQUIRE_THROWS_AS(multiply_into(a, wrong_shape, c),
+                      std::invalid_argument);
+    REQUIRE_THROWS_AS(multiply_into(a, c, c), std::invalid_argument);
+}
+
+TEST_CASE("Batched addition and transpose", "[batch]") {
+    const MatrixBatch a = make_batch<double>(10, 3, 5, 1);
+    const MatrixBatch b = make_batch<double>(10, 3, 5, 7);
+    MatrixBatch sum(10, 3, 5);
+    add_into(a, b, sum);
+    MatrixBatch t(10, 5, 3);
+    transpose_into(a, t);
+    for (size_t i = 0; i < 10; ++i) {
+        require_equal(sum.matrix(i), Matrix(a.matrix(i) + b.matrix(i)));
+        require_equal(t.matrix(i), a.matrix(i).transpose());
+    }
+
+    REQUIRE_THROWS_AS(add_into(a, t, sum), std::invalid_argument);
+    REQUIRE_THROWS_AS(transpose_into(a, sum), std::invalid_argument);
+}
+
+TEST_CASE("Pointer-array batches use existing matrices", "[batch]") {
+    // Mixed sizes: each product only has to be valid by itself.
+    std::vector<Matrix> a, b, c, t;
+    for (size_t i = 0; i < 12; ++i) {
+        const size_t n = 2 + i % 5;
+        a.push_back(make_matrix<double>(n, n + 1, i));
+        b.push_back(make_matrix<double>(n + 1, n, i + 3));
+        c.emplace_back(n, n);
+        t.emplace_back(n + 1, n);
+    }
+    std::vector<const Matrix*> pa, pb;
+    std::vector<Matrix*> pc, pt;
+    for (size_t i = 0; i < a.size(); ++i) {
+        pa.push_back(&a[i]);
+        pb.push_back(&b[i]);
+        pc.push_back(&c[i]);
+        pt.push_back(&t[i]);
+    }
+
+    multiply_into(pa.data(), pb.data(), pc.data(), a.size());
+    transpose_into(pa.data(), pt.data(), a.size());
+    for (size_t i = 0; i < a.size(); ++i) {
+        require_equal(c[i], a[i] * b[i]);
+        require_equal(t[i], a[i].transpose());
+    }
+
+    // The sums are written in place, through the same pointers.
+    std::vector<const Matrix*> pc_const(pc.begin(), pc.end());
+    add_into(pc_const.data(), pc_const.data(), pc.data(), c.size());
+    for (size_t i = 0; i < a.size(); ++i) {
+        require_equal(c[i], Matrix((a[i] * b[i]) * 2.0));
+    }
+
+    // An invalid member is reported before any output is written.
+    const Matrix before = c[0];
+    std::swap(pb[5], pb[6]);
+    REQUIRE_THROWS_AS(multiply_into(pa.data(), pb.data(), pc.data(), 12),
+                      std::invalid_argument);
+    require_equal(c[0], before);
+    REQUIRE_THROWS_AS(add_into(pa.data(), pb.data(), pc.data(), 12),
+                      std::invalid_argument);
+    REQUIRE_THROWS_AS(transpose_into(pa.data(), pc.data(), 12),
+                      std::invalid_argument);
+    multiply_into(pa.data(), pb.data(), pc.data(), 0);
+}
+
+TEST_CASE("Parallel batches match single-threaded results",
+          "[batch][parallel]") {
+    const size_t saved = num_threads();
+    const MatrixBatch a = make_batch<double>(1000, 16, 16, 1);
+    const MatrixBatch b = make_batch<double>(1000, 16, 16, 2);
+    MatrixBatch serial(1000, 16, 16);
+    MatrixBatch parallel(1000, 16, 16);
+
+    set_num_threads(1);
+    multiply_into(a, b, serial);
+    set_num_threads(4);
+    multiply_into(a, b, parallel);
+    set_num_threads(saved);
+
+    for (size_t i = 0; i < a.count(); i += 37) {
+        require_equal(parallel.matrix(i), serial.matrix(i));
+    }
+}
+
+TEST_CASE("Pointer-array products large enough to run in parallel",
+          "[batch][parallel]") {
+    // Each product goes parallel inside the batch's own parallel_for, so a
+    // waiting thread runs other products of the batch meanwhile.
+    const size_t count = 96;
+    std::vector<Matrix> a, b, c;
+    for (size_t i = 0; i < count; ++i) {
+        a.push_back(make_matrix<double>(160, 160, i));
+        b.push_back(make_matrix<double>(160, 160, i + 5));
+        c.emplace_back(160, 160);
+    }
+    std::vector<const Matrix*> pa, pb;
+    std::vector<Matrix*> pc;
+    for (size_t i = 0; i < count; ++i) {
+        pa.push_back(&a[i]);
+        pb.push_back(&b[i]);
+        pc.push_back(&c[i]);
+    }
+
+    const size_t saved = num_threads();
+    set_num_threads(1);
+    std::vector<Matrix> expected;
+    for (size_t i = 0; i < count; ++i) {
+        expected.push_back(a[i] * b[i]);
+    }
+    set_num_threads(8);
+    for (int run = 0; run < 3; ++run) {
+        multiply_into(pa.data(), pb.data(), pc.data(), count);
+        for (size_t i = 0; i < count; ++i) {
+            REQUIRE(same_elements(c[i], expected[i]));
+        }
+    }
+    set_num_threads(saved);
+}
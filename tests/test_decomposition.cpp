@@ -0,0 +1,314 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_approx.hpp>
+#include "matrixops/decomposition.h"
+#include "matrixops/parallel.h"
+
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <cstdint>
+#include <initializer_list>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+using namespace matrixops;
+using Catch::Approx;
+
+namespace {
+
+template <typename T>
+using Real = typename BasicMatrix<T>::real_type;
+
+// Deterministic entries in [-1, 1), with an imaginary part for complex T.
+double pseudo_random(uint64_t& state) {
+    state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+    return static_cast<double>(state >> 11) * 0x1.0p-52 - 1.0;
+}
+
+template <typename T>
+BasicMatrix<T> random_matrix(size_t rows, size_t cols, uint64_t seed) {
+    BasicMatrix<T> m(rows, cols);
+    uint64_t state = seed;
+    for (size_t i = 0; i < rows; ++i) {
+        for (size_t j = 0; j < cols; ++j) {
+            const double re = pseudo_random(state);
+            if constexpr (std::is_same_v<T, Real<T>>) {
+                m(i, j) = static_cast<T>(re);
+            } else {
+                m(i, j) = T(static_cast<Real<T>>(re),
+                            static_cast<Real<T>>(pseudo_random(state)));
+            }
+        }
+    }
+    return m;
+}
+
+// Small literal matrices, e.g. from_rows({{1, 2}, {3, 4}}).
+Matrix from_rows(std::initializer_list<std::initializer_list<double>> rows) {
+    Matrix m(rows.size(), rows.begin()->size());
+    size_t i = 0;
+    for (const auto& row : rows) {
+        size_t j = 0;
+        for (double value : row) {
+            m(i, j++) = value;
+        }
+        ++i;
+    }
+    return m;
+}
+
+template <typename T>
+BasicMatrix<T> adjoint(const BasicMatrix<T>& a) {
+    BasicMatrix<T> result(a.cols(), a.rows());
+    for (size_t i = 0; i < a.rows(); ++i) {
+        for (size_t j = 0; j < a.cols(); ++j) {
+            if constexpr (std::is_same_v<T, Real<T>>) {
+                result(j, i) = a(i, j);
+            } else {
+                result(j, i) = std::conj(a(i, j));
+            }
+        }
+    }
+    return result;
+}
+
+template <typename T>
+double max_difference(const BasicMatrix<T>& a, const BasicMatrix<T>& b) {
+    REQUIRE(a.rows() == b.rows());
+    REQUIRE(a.cols() == b.cols());
+    double largest = 0.0;
+    for (size_t i = 0; i < a.rows(); ++i) {
+        for (size_t j = 0; j < a.cols(); ++j) {
+            largest = std::max(
+                largest, static_cast<double>(std::abs(a(i, j) - b(i, j))));
+        }
+    }
+    return largest;
+}
+
+// Backward-stable results are within a small multiple of n eps.
+template <typename T>
+double tolerance(size_t n) {
+    return 64.0 * static_cast<double>(n) *
+           static_cast<double>(std::numeric_limits<Real<T>>::epsilon());
+}
+
+template <typename T>
+void check_lu(size_t n) {
+    INFO("n = " << n);
+    const BasicMatrix<T> a = random_matrix<T>(n, n, n);
+    const BasicLU<T> lu(a);
+    REQUIRE_FALSE(lu.is_singular());
+
+    // P A: the interchanges applied in order.
+    BasicMatrix<T> pa(a);
+    for (size_t i = 0; i < n; ++i) {
+        for (size_t j = 0; j < n; ++j) {
+            std::swap(pa(i, j), pa(lu.pivots()[i], j));
+        }
+    }
+    REQUIRE(max_difference(BasicMatrix<T>(lu.lower() * lu.upper()), pa) <
+            tolerance<T>(n));
+
+    const BasicMatrix<T> x = random_matrix<T>(n, 3, n + 1);
+    const BasicMatrix<T> b = a * x;
+    REQUIRE(max_difference(BasicMatrix<T>(a * lu.solve(b)), b) <
+            tolerance<T>(n) * 4);
+}
+
+template <typename T>
+void check_cholesky(size_t n) {
+    INFO("n = " << n);
+    // B B^H + n I is Hermitian positive definite and well conditioned.
+    const BasicMatrix<T> g = random_matrix<T>(n, n, n + 2);
+    BasicMatrix<T> a = g * adjoint(g);
+    for (size_t i = 0; i < n; ++i) {
+        a(i, i) += T(static_cast<Real<T>>(n));
+    }
+    // Only the lower triangle is read.
+    BasicMatrix<T> lower_only(a);
+    for (size_t i = 0; i < n; ++i) {
+        for (size_t j = i + 1; j < n; ++j) {
+            lower_only(i, j) = T(std::numeric_limits<Real<T>>::quiet_NaN());
+        }
+    }
+    const BasicCholesky<T> chol(lower_only);
+    const BasicMatrix<T>& l = chol.lower();
+    for (size_t i = 0; i < n; ++i) {
+        REQUIRE(std::imag(l(i, i)) == 0);
+        REQUIRE(std::real(l(i, i)) > 0);
+        for (size_t j = i + 1; j < n; ++j) {
+            REQUIRE(l(i, j) == T(0));
+        }
+    }
+    REQUIRE(max_difference(BasicMatrix<T>(l * adjoint(l)), a) <
+            tolerance<T>(n) * static_cast<double>(n));
+
+    const BasicMatrix<T> x = random_matrix<T>(n, 5, n + 3);
+    const BasicMatrix<T> b = a * x;
+    REQUIRE(max_difference(chol.solve(b), x) < tolerance<T>(n));
+}
+
+template <typename T>
+void check_qr(size_t m, size_t n) {
+    INFO(m << " x " << n);
+    const BasicMatrix<T> a = random_matrix<T>(m, n, m * 7 + n);
+    const BasicQR<T> qr(a);
+    const BasicMatrix<T> q = qr.q();
+    const BasicMatrix<T> r = qr.r();
+    REQUIRE(q.rows() == m);
+    REQUIRE(q.cols() == n);
+    REQUIRE(max_difference(BasicMatrix<T>(adjoint(q) * q), identity<T>(n)) <
+            tolerance<T>(m));
+    REQUIRE(max_difference(BasicMatrix<T>(q * r), a) < tolerance<T>(m));
+    for (size_t i = 0; i < n; ++i) {
+        for (size_t j = 0; j < i; ++j) {
+            REQUIRE(r(i, j) == T(0));
+        }
+    }
+
+    // The least-squares residual is orthogonal to the columns of A.
+    const BasicMatrix<T> b = random_matrix<T>(m, 2, m + n);
+    const BasicMatrix<T> x = qr.solve(b);
+    REQUIRE(x.rows() == n);
+    BasicMatrix<T> residual = a * x;
+    residual *= T(-1);
+    residual += b;
+    const BasicMatrix<T> normal = adjoint(a) * residual;
+    REQUIRE(max_difference(normal, BasicMatrix<T>(n, 2)) <
+            tolerance<T>(m) * static_cast<double>(m));
+}
+
+// Sizes around the substitution and panel leaves, and with a small block
+// size several panels and block rows.
+const size_t SIZES[] = {1, 2, 15, 17, 65, 130};
+
+class BlockSizeGuard {
+public:
+    explicit BlockSizeGuard(size_t block)
+        : saved_(decomposition_block_size()) {
+        set_decomposition_block_size(block);
+    }
+    ~BlockSizeGuard() { set_decomposition_block_size(saved_); }
+
+private:
+    size_t saved_;
+};
+
+} // namespace
+
+TEST_CASE("LU with partial pivoting", "[decomposition]") {
+    for (size_t block : {size_t{8}, size_t{128}}) {
+        INFO("block = " << block);
+        BlockSizeGuard guard(block);
+        for (size_t n : SIZES) {
+            check_lu<double>(n);
+            check_lu<float>(n);
+            check_lu<std::complex<double>>(n);
+            check_lu<std::complex<float>>(n);
+        }
+    }
+
+    // The pivoting is what makes this one work.
+    const Matrix a = from_rows({{0.0, 1.0}, {1.0, 1.0}});
+    const LU lu(a);
+    REQUIRE(lu.pivots()[0] == 1);
+    REQUIRE(lu.determinant() == Approx(-1.0));
+    const Vector x = lu.solve(Vector{2.0, 3.0});
+    REQUIRE(x(0) == Approx(1.0));
+    REQUIRE(x(1) == Approx(2.0));
+}
+
+TEST_CASE("LU of singular and non-square matrices", "[decomposition]") {
+    const Matrix singular = from_rows({{1.0, 2.0}, {2.0, 4.0}});
+    const LU lu(singular);
+    REQUIRE(lu.is_singular());
+    REQUIRE(lu.determinant() == 0.0);
+    REQUIRE_THROWS_AS(lu.solve(Matrix(2, 1, 1.0)), std::domain_error);
+
+    REQUIRE_THROWS_AS(LU(Matrix(2, 3)), std::invalid_argument);
+    const LU ok(identity(3));
+    REQUIRE_THROWS_AS(ok.solve(Matrix(2, 1)), std::invalid_argument);
+    REQUIRE_THROWS_AS(ok.solve(Vector(4)), std::invalid_argument);
+    REQUIRE_THROWS_AS(set_decomposition_block_size(0),
+                      std::invalid_argument);
+}
+
+TEST_CASE("Cholesky factorization", "[decomposition]") {
+    for (size_t block : {size_t{8}, size_t{128}}) {
+        INFO("block = " << block);
+        BlockSizeGuard guard(block);
+        for (size_t n : SIZES) {
+            check_cholesky<double>(n);
+            check_cholesky<float>(n);
+            check_cholesky<std::complex<double>>(n);
+            check_cholesky<std::complex<float>>(n);
+        }
+    }
+
+    const Matrix indefinite = from_rows({{1.0, 2.0}, {2.0, 1.0}});
+    REQUIRE_THROWS_AS(Cholesky(indefinite), std::domain_error);
+    REQUIRE_THROWS_AS(Cholesky(Matrix(3, 3)), std::domain_error);
+    REQUIRE_THROWS_AS(Cholesky(Matrix(2, 3)), std::invalid_argument);
+
+    const Cholesky chol(from_rows({{4.0, 2.0}, {2.0, 3.0}}));
+    const Vector x = chol.solve(Vector{8.0, 7.0});
+    REQUIRE(x(0) == Approx(1.25));
+    REQUIRE(x(1) == Approx(1.5));
+}
+
+TEST_CASE("Householder QR and least squares", "[decomposition]") {
+    for (size_t block : {size_t{8}, size_t{128}}) {
+        INFO("block = " << block);
+        BlockSizeGuard guard(block);
+        const size_t shapes[][2] = {
+            {1, 1}, {5, 1}, {17, 17}, {40, 33}, {130, 65}, {200, 130}};
+        for (const auto& shape : shapes) {
+            check_qr<double>(shape[0], shape[1]);
+            check_qr<float>(shape[0], shape[1]);
+            check_qr<std::complex<double>>(shape[0], shape[1]);
+            check_qr<std::complex<float>>(shape[0], shape[1]);
+        }
+    }
+
+    // Fit y = c0 + c1 t exactly through collinear points.
+    const Matrix a =
+        from_rows({{1.0, 0.0}, {1.0, 1.0}, {1.0, 2.0}, {1.0, 3.0}});
+    const Vector c = QR(a).solve(Vector{1.0, 3.0, 5.0, 7.0});
+    REQUIRE(c(0) == Approx(1.0));
+    REQUIRE(c(1) == Approx(2.0));
+
+    REQUIRE_THROWS_AS(QR(Matrix(2, 3)), std::invalid_argument);
+    REQUIRE_THROWS_AS(QR(a).solve(Vector(3)), std::invalid_argument);
+    const Matrix rank_deficient = from_rows({{1.0, 0.0}, {1.0, 0.0}});
+    REQUIRE_THROWS_AS(QR(rank_deficient).solve(Matrix(2, 1)),
+                      std::domain_error);
+}
+
+TEST_CASE("Parallel factorizations match single-threaded results",
+          "[decomposition][parallel]") {
+    const size_t saved = num_threads();
+    const size_t n = 300;
+    const Matrix a = random_matrix<double>(n, n, 1);
+    Matrix spd = a * a.transpose();
+    for (size_t i = 0; i < n; ++i) {
+        spd(i, i) += static_cast<double>(n);
+    }
+    const Matrix b = random_matrix<double>(n, 4, 2);
+
+    set_num_threads(1);
+    const Matrix lu_serial = LU(a).solve(b);
+    const Matrix chol_serial = Cholesky(spd).solve(b);
+    const Matrix qr_serial = QR(a).solve(b);
+    set_num_threads(4);
+    const Matrix lu_parallel = LU(a).solve(b);
+    const Matrix chol_parallel = Cholesky(spd).solve(b);
+    const Matrix qr_parallel = QR(a).solve(b);
+    set_num_threads(saved);
+
+    REQUIRE(max_difference(lu_parallel, lu_serial) < 1e-10);
+    REQUIRE(max_difference(chol_parallel, chol_serial) < 1e-10);
+    REQUIRE(max_difference(qr_parallel, qr_serial) < 1e-10);
+}
@@ -0,0 +1,101 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_approx.hpp>
+#include "matrixops/device.h"
+#include "test_helpers.h"
+
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace matrixops;
+using namespace matrixops::testing;
+using Catch::Approx;
+
+// The device cases only check results when the library has a backend and
+// the machine a device; otherwise they check that nothing can be created.
+
+namespace {
+
+// Small integers keep every sum and product exact on any device.
+template <typename T>
+void check_device_operations() {
+    const BasicMatrix<T> a = make_matrix<T>(130, 70);
+    const BasicMatrix<T> b = make_matrix<T>(70, 150);
+    const BasicDeviceMatrix<T> da(a);
+    const BasicDeviceMatrix<T> db(b);
+
+    REQUIRE(same_elements(da.to_matrix(), a));
+    REQUIRE(same_elements((da * db).to_matrix(), a * b));
+    REQUIRE(same_elements(da.transpose().to_matrix(), a.transpose()));
+    REQUIRE(same_elements((da + da).to_matrix(), BasicMatrix<T>(a + a)));
+    REQUIRE(same_elements((da * T(2)).to_matrix(), BasicMatrix<T>(a * T(2))));
+    REQUIRE(da.norm() == Approx(a.norm()));
+
+    // A chain that stays on the device, and in-place operations.
+    BasicDeviceMatrix<T> chain = (da * db).transpose();
+    chain += chain;
+    chain *= T(3);
+    REQUIRE(same_elements(chain.to_matrix(),
+                          BasicMatrix<T>((a * b).transpose() * T(6))));
+
+    BasicDeviceMatrix<T> copy = da;
+    copy += da;
+    REQUIRE(same_elements(da.to_matrix(), a));
+    copy = db;
+    REQUIRE(copy.rows() == 70);
+    REQUIRE(same_elements(copy.to_matrix(), b));
+}
+
+} // namespace
+
+TEST_CASE("DeviceMatrix needs a device backend", "[device]") {
+    if (std::string(device_backend()) != "none") {
+        return;
+    }
+    REQUIRE(device_count() == 0);
+    REQUIRE_THROWS_AS(DeviceMatrix(4, 4), std::runtime_error);
+    REQUIRE_THROWS_AS(DeviceMatrix(Matrix(4, 4, 1.0)), std::runtime_error);
+    device_synchronize();
+}
+
+TEST_CASE("DeviceMatrix operations match Matrix", "[device]") {
+    if (device_count() == 0) {
+        return;
+    }
+    check_device_operations<float>();
+    check_device_operations<double>();
+
+    const DeviceMatrix d(3, 4);
+    REQUIRE_THROWS_AS(DeviceMatrix(0, 4), std::invalid_argument);
+    REQUIRE_THROWS_AS(d + DeviceMatrix(4, 3), std::invalid_argument);
+    REQUIRE_THROWS_AS(d * d, std::invalid_argument);
+}
+
+TEST_CASE("DeviceMatrix transfers views and queued copies", "[device]") {
+    if (device_count() == 0) {
+        return;
+    }
+    const Matrix m = make_matrix<double>(90, 60);
+
+    // A block is uploaded with its row stride, a column-major view through
+    // a packed copy.
+    const Matrix big = make_matrix<double>(200, 100);
+    REQUIRE(same_elements(DeviceMatrix(big.block(10, 20, 90, 60)).to_matrix(),
+                          Matrix(big.block(10, 20, 90, 60))));
+    std::vector<double> buffer(m.rows() * m.cols());
+    const MatrixView column_major(buffer.data(), m.rows(), m.cols(),
+                                  Layout::COLUMN_MAJOR);
+    column_major.copy_from(m);
+    REQUIRE(same_elements(DeviceMatrix(column_major).to_matrix(), m));
+
+    DeviceMatrix d(90, 60);
+    d.upload_async(m);
+    Matrix out(90, 60);
+    (d * 2.0).download_async(out);
+    device_synchronize();
+    REQUIRE(same_elements(out, Matrix(m * 2.0)));
+
+    REQUIRE_THROWS_AS(d.upload_async(column_major), std::invalid_argument);
+    Matrix wrong_shape(60, 90);
+    REQUIRE_THROWS_AS(d.download_async(wrong_shape), std::invalid_argument);
+}
@@ -0,0 +1,127 @@
+#include <catch2/catch_session.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_approx.hpp>
+#include "matrixops/distributed.h"
+#include "test_helpers.h"
+
+#include <complex>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+// Built as its own executable, run under mpiexec: every process runs every
+// test case, so each collective call is matched on the whole grid.
+
+using namespace matrixops;
+using namespace matrixops::testing;
+using Catch::Approx;
+
+namespace {
+
+int world_size() {
+    int size = 0;
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+    return size;
+}
+
+// The near-square grid and both one-dimensional ones.
+std::vector<std::shared_ptr<const ProcessGrid>> grids() {
+    const int size = world_size();
+    return {std::make_shared<const ProcessGrid>(MPI_COMM_WORLD),
+            std::make_shared<const ProcessGrid>(MPI_COMM_WORLD, 1, size),
+            std::make_shared<const ProcessGrid>(MPI_COMM_WORLD, size, 1)};
+}
+
+// Sizes that leave partial tiles and more tiles than processes; small
+// integers keep every product exact whatever the summation order.
+template <typename T>
+void check_distributed_operations(
+    const std::shared_ptr<const ProcessGrid>& grid, size_t block) {
+    const BasicMatrix<T> a = make_matrix<T>(150, 95, 1);
+    const BasicMatrix<T> b = make_matrix<T>(95, 120, 2);
+    const auto da = BasicDistributedMatrix<T>::from_global(grid, a, block);
+    const auto db = BasicDistributedMatrix<T>::scatter(grid, &b, 0, block);
+
+    REQUIRE(same_elements(da.to_matrix(), a));
+    REQUIRE(same_elements(db.to_matrix(), b));
+    REQUIRE(same_elements((da * db).to_matrix(), a * b));
+    REQUIRE(same_elements(da.transpose().to_matrix(), a.transpose()));
+    REQUIRE(da.norm() == Approx(a.norm()));
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    MPI_Init(&argc, &argv);
+    const int result = Catch::Session().run(argc, argv);
+    MPI_Finalize();
+    return result;
+}
+
+TEST_CASE("ProcessGrid arranges the ranks of a communicator",
+          "[distributed]") {
+    int rank = 0;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    for (const auto& grid : grids()) {
+        REQUIRE(grid->rows() * grid->cols() == world_size());
+        REQUIRE(grid->row() * grid->cols() + grid->col() == rank);
+        int row_rank = 0;
+        int col_rank = 0;
+        MPI_Comm_rank(grid->row_comm(), &row_rank);
+        MPI_Comm_rank(grid->col_comm(), &col_rank);
+        REQUIRE(row_rank == grid->col());
+        REQUIRE(col_rank == grid->row());
+    }
+    REQUIRE_THROWS_AS(ProcessGrid(MPI_COMM_WORLD, world_size() + 1, 1),
+                      std::invalid_argument);
+}
+
+TEST_CASE("DistributedMatrix deals tiles out block-cyclically",
+          "[distributed]") {
+    const Matrix m = make_matrix<double>(130, 70, 0);
+    for (const auto& grid : grids()) {
+        const auto d = DistributedMatrix::from_global(grid, m, 32);
+        for (size_t li = 0; li < d.local_rows(); ++li) {
+            for (size_t lj = 0; lj < d.local_cols(); ++lj) {
+                REQUIRE(d.local()(li, lj) ==
+                        m(d.global_row(li), d.global_col(lj)));
+            }
+        }
+        unsigned long long elements = d.local_rows() * d.local_cols();
+        MPI_Allreduce(MPI_IN_PLACE, &elements, 1, MPI_UNSIGNED_LONG_LONG,
+                      MPI_SUM, MPI_COMM_WORLD);
+        REQUIRE(elements == m.rows() * m.cols());
+
+        const std::optional<Matrix> gathered = d.gather(0);
+        REQUIRE(gathered.has_value() == (grid->row() + grid->col() == 0));
+        if (gathered) {
+            REQUIRE(same_elements(*gathered, m));
+        }
+        REQUIRE(DistributedMatrix(grid, 40, 50).norm() == 0.0);
+    }
+}
+
+TEST_CASE("DistributedMatrix operations match Matrix", "[distributed]") {
+    for (const auto& grid : grids()) {
+        check_distributed_operations<float>(grid, 32);
+        check_distributed_operations<double>(grid, 32);
+        check_distributed_operations<std::complex<float>>(grid, 40);
+        check_distributed_operations<std::complex<double>>(grid, 40);
+        // One tile: every process but the first holds nothing.
+        check_distributed_operations<double>(grid, 256);
+    }
+}
+
+TEST_CASE("DistributedMatrix rejects mismatched operands", "[distributed]") {
+    const auto grid = std::make_shared<const ProcessGrid>(MPI_COMM_WORLD);
+    const DistributedMatrix a(grid, 60, 40, 16);
+    REQUIRE_THROWS_AS(a * a, std::invalid_argument);
+    REQUIRE_THROWS_AS(a * DistributedMatrix(grid, 40, 60, 8),
+                      std::invalid_argument);
+    const auto other = std::make_shared<const ProcessGrid>(MPI_COMM_WORLD);
+    REQUIRE_THROWS_AS(a * DistributedMatrix(other, 40, 60, 16),
+                      std::invalid_argument);
+    REQUIRE_THROWS_AS(DistributedMatrix(grid, 0, 60), std::invalid_argument);
+    REQUIRE_THROWS_AS(DistributedMatrix(grid, 60, 60, 0),
+                      std::invalid_argument);
+}
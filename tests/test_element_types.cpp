@@ -0,0 +1,290 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_approx.hpp>
+#include "matrixops/gemm.h"
+#include "matrixops/matrix.h"
+#include "matrixops/simd.h"
+#include "test_helpers.h"
+
+#include <cmath>
+#include <complex>
+#include <limits>
+#include <vector>
+
+using namespace matrixops;
+using namespace matrixops::testing;
+using Catch::Approx;
+
+namespace {
+
+const SimdIsa ALL_ISAS[] = {SimdIsa::SCALAR, SimdIsa::SSE2, SimdIsa::AVX2,
+                            SimdIsa::AVX512, SimdIsa::NEON};
+
+using Complex = std::complex<double>;
+
+BasicMatrix<Complex> make_complex(size_t rows, size_t cols) {
+    BasicMatrix<Complex> m(rows, cols);
+    for (size_t i = 0; i < rows; ++i) {
+        for (size_t j = 0; j < cols; ++j) {
+            m(i, j) = Complex(static_cast<double>((i + 2 * j) % 5) - 2.0,
+                              static_cast<double>((3 * i + j) % 7) * 0.5);
+        }
+    }
+    return m;
+}
+
+} // namespace
+
+TEST_CASE("Half converts with round-to-nearest-even", "[types][half]") {
+    REQUIRE(Half(1.0F).bits() == 0x3C00);
+    REQUIRE(Half(-2.0F).bits() == 0xC000);
+    REQUIRE(Half(0.0F).bits() == 0x0000);
+    REQUIRE(Half(-0.0F).bits() == 0x8000);
+    REQUIRE(Half(65504.0F).bits() == 0x7BFF);
+    REQUIRE(static_cast<float>(Half(0.333251953125F)) == 0.333251953125F);
+
+    SECTION("Ties go to the even neighbour") {
+        REQUIRE(Half(1.0F + 0x1p-11F).bits() == 0x3C00);
+        REQUIRE(Half(1.0F + 3 * 0x1p-11F).bits() == 0x3C02);
+    }
+
+    SECTION("Out-of-range values become infinity") {
+        REQUIRE(Half(65519.0F).bits() == 0x7BFF);
+        REQUIRE(Half(65520.0F).bits() == 0x7C00);
+        REQUIRE(std::isinf(static_cast<float>(Half(1e10F))));
+        REQUIRE(Half(-std::numeric_limits<float>::infinity()).bits() ==
+                0xFC00);
+    }
+
+    SECTION("Subnormals round trip") {
+        REQUIRE(Half(0x1p-24F).bits() == 0x0001);
+        REQUIRE(static_cast<float>(Half::from_bits(0x0001)) == 0x1p-24F);
+        REQUIRE(static_cast<float>(Half::from_bits(0x03FF)) ==
+                1023 * 0x1p-24F);
+        REQUIRE(Half(0x1p-25F).bits() == 0x0000);
+        REQUIRE(Half(0x1.8p-25F).bits() == 0x0001);
+        REQUIRE(Half(0x1.FF8p-15F).bits() == 0x03FF);
+        REQUIRE(Half(0x1.FFCp-15F).bits() == 0x0400);
+    }
+
+    SECTION("NaN stays NaN") {
+        const float nan = std::numeric_limits<float>::quiet_NaN();
+        REQUIRE(std::isnan(static_cast<float>(Half(nan))));
+    }
+
+    SECTION("Every finite half converts back to itself") {
+        size_t mismatches = 0;
+        for (uint32_t bits = 0; bits < 0x10000; ++bits) {
+            if ((bits & 0x7C00) == 0x7C00) {
+                continue;
+            }
+            const Half h = Half::from_bits(static_cast<uint16_t>(bits));
+            mismatches += Half(static_cast<float>(h)).bits() != bits;
+        }
+        REQUIRE(mismatches == 0);
+    }
+}
+
+TEST_CASE("BFloat16 keeps the upper half of a float", "[types][half]") {
+    REQUIRE(BFloat16(1.0F).bits() == 0x3F80);
+    REQUIRE(BFloat16(-2.0F).bits() == 0xC000);
+    REQUIRE(static_cast<float>(BFloat16(3.0e38F)) ==
+            Approx(3.0e38F).epsilon(0.01));
+    REQUIRE(BFloat16(1.0F + 0x1p-8F).bits() == 0x3F80);
+    REQUIRE(BFloat16(1.0F + 3 * 0x1p-8F).bits() == 0x3F82);
+    REQUIRE(std::isnan(static_cast<float>(
+        BFloat16(std::numeric_limits<float>::quiet_NaN()))));
+}
+
+TEST_CASE("Float matrices match double arithmetic on every ISA",
+          "[types][simd]") {
+    const SimdIsa saved = simd_isa();
+
+    // Odd sizes exercise the vector remainders and partial GEMM tiles; the
+    // product is large enough to be packed.
+    const Matrix a = make_scaled_matrix(37, 61, 0.5);
+    const Matrix b = make_scaled_matrix(37, 61, -0.25);
+    const Matrix c = make_scaled_matrix(61, 43, 0.75);
+    const BasicMatrix<float> af(a);
+    const BasicMatrix<float> bf(b);
+    const BasicMatrix<float> cf(c);
+
+    const Matrix fused = a + b * 3.0;
+    const Matrix product = a * c;
+
+    for (SimdIsa isa : ALL_ISAS) {
+        if (!simd_isa_supported(isa)) {
+            continue;
+        }
+        INFO("ISA: " << simd_isa_name(isa));
+        set_simd_isa(isa);
+
+        const BasicMatrix<float> sum = af + bf;
+        const BasicMatrix<float> scaled = af * 2.0F;
+        const BasicMatrix<float> f = af + bf * 3.0F;
+        const BasicMatrix<float> p = af * cf;
+        for (size_t i = 0; i < a.rows(); ++i) {
+            for (size_t j = 0; j < a.cols(); ++j) {
+                // The inputs are exact in float, so are the sums.
+                REQUIRE(sum(i, j) == static_cast<float>(a(i, j) + b(i, j)));
+                REQUIRE(scaled(i, j) == static_cast<float>(a(i, j) * 2.0));
+                REQUIRE(f(i, j) == static_cast<float>(fused(i, j)));
+            }
+            for (size_t j = 0; j < c.cols(); ++j) {
+                REQUIRE(p(i, j) == Approx(product(i, j)).epsilon(1e-5));
+            }
+        }
+        REQUIRE(af.norm() == Approx(a.norm()).epsilon(1e-6));
+    }
+
+    set_simd_isa(saved);
+}
+
+TEST_CASE("Float products take the parallel path", "[types][gemm]") {
+    const Matrix a = make_scaled_matrix(130, 97, 0.5);
+    const Matrix b = make_scaled_matrix(97, 111, 0.25);
+    const BasicMatrix<float> p =
+        BasicMatrix<float>(a) * BasicMatrix<float>(b);
+    const Matrix expected = a * b;
+    for (size_t i = 0; i < p.rows(); ++i) {
+        for (size_t j = 0; j < p.cols(); ++j) {
+            REQUIRE(p(i, j) == Approx(expected(i, j)).epsilon(1e-5));
+        }
+    }
+}
+
+TEST_CASE("Complex matrices", "[types][complex]") {
+    const BasicMatrix<Complex> a = make_complex(23, 41);
+    const BasicMatrix<Complex> b = make_complex(41, 19);
+
+    SECTION("Multiplication") {
+        const BasicMatrix<Complex> p = a * b;
+        for (size_t i = 0; i < a.rows(); ++i) {
+            for (size_t j = 0; j < b.cols(); ++j) {
+                Complex expected = 0.0;
+                for (size_t k = 0; k < a.cols(); ++k) {
+                    expected += a(i, k) * b(k, j);
+                }
+                REQUIRE(p(i, j).real() == Approx(expected.real()));
+                REQUIRE(p(i, j).imag() == Approx(expected.imag()));
+            }
+        }
+    }
+
+    SECTION("Element-wise expressions") {
+        const Complex s(0.5, -1.0);
+        const BasicMatrix<Complex> e = a + a * s;
+        for (size_t i = 0; i < a.rows(); ++i) {
+            for (size_t j = 0; j < a.cols(); ++j) {
+                REQUIRE(e(i, j) == a(i, j) + a(i, j) * s);
+            }
+        }
+    }
+
+    SECTION("Norm uses the modulus") {
+        double sum = 0.0;
+        for (size_t i = 0; i < a.rows(); ++i) {
+            for (size_t j = 0; j < a.cols(); ++j) {
+                sum += std::norm(a(i, j));
+            }
+        }
+        REQUIRE(a.norm() == Approx(std::sqrt(sum)));
+    }
+
+    SECTION("Transpose") {
+        const BasicMatrix<Complex> t = a.transpose();
+        for (size_t i = 0; i < a.rows(); ++i) {
+            for (size_t j = 0; j < a.cols(); ++j) {
+                REQUIRE(t(j, i) == a(i, j));
+            }
+        }
+    }
+}
+
+TEST_CASE("Half products accumulate in float", "[types][half][gemm]") {
+    // 4096 ones: a half-precision accumulator would stall at 2048.
+    const size_t k = 4096;
+
+    SECTION("Unpacked") {
+        const BasicMatrix<Half> a(1, k, 1.0F);
+        const BasicMatrix<Half> b(k, 1, 1.0F);
+        REQUIRE(static_cast<float>((a * b)(0, 0)) == 4096.0F);
+    }
+
+    SECTION("Packed") {
+        const BasicMatrix<Half> a(20, k, 1.0F);
+        const BasicMatrix<Half> b(k, 24, 1.0F);
+        const BasicMatrix<Half> p = a * b;
+        for (size_t i = 0; i < p.rows(); ++i) {
+            for (size_t j = 0; j < p.cols(); ++j) {
+                REQUIRE(static_cast<float>(p(i, j)) == 4096.0F);
+            }
+        }
+    }
+
+    SECTION("Mixed precision, float output") {
+        // 3001 is not representable in half precision.
+        const BasicMatrix<Half> a(20, 3001, 1.0F);
+        const BasicMatrix<Half> b(3001, 24, 1.0F);
+        BasicMatrix<float> out(20, 24);
+        multiply_into(a, b, out);
+        REQUIRE(out(0, 0) == 3001.0F);
+        REQUIRE(out(19, 23) == 3001.0F);
+
+        BasicMatrix<float> wrong(24, 20);
+        REQUIRE_THROWS_AS(multiply_into(a, b, wrong), std::invalid_argument);
+    }
+
+    SECTION("bfloat16") {
+        const BasicMatrix<BFloat16> a(20, 3001, 1.0F);
+        const BasicMatrix<BFloat16> b(3001, 24, 1.0F);
+        BasicMatrix<float> out(20, 24);
+        multiply_into(a, b, out);
+        REQUIRE(out(7, 5) == 3001.0F);
+    }
+
+    SECTION("Raw gemm with beta") {
+        std::vector<Half> a(4, Half(1.0F));
+        std::vector<Half> b(4, Half(2.0F));
+        std::vector<Half> c(4, Half(1.0F));
+        gemm(2, 2, 2, 0.5F, a.data(), 2, b.data(), 2, 3.0F, c.data(), 2);
+        for (Half v : c) {
+            REQUIRE(static_cast<float>(v) == 5.0F);
+        }
+    }
+}
+
+TEST_CASE("Half and bfloat16 matrices", "[types][half]") {
+    const Matrix a = make_scaled_matrix(33, 70, 0.5);
+    const BasicMatrix<Half> h(a);
+    const BasicMatrix<BFloat16> bf(a);
+
+    SECTION("Conversion round trip is exact for representable values") {
+        const Matrix back(h);
+        for (size_t i = 0; i < a.rows(); ++i) {
+            for (size_t j = 0; j < a.cols(); ++j) {
+                REQUIRE(back(i, j) == a(i, j));
+                REQUIRE(static_cast<float>(bf(i, j)) == a(i, j));
+            }
+        }
+    }
+
+    SECTION("Element-wise arithmetic, norm and transpose") {
+        const BasicMatrix<Half> sum = h + h * Half(0.5F);
+        const BasicMatrix<Half> t = h.transpose();
+        for (size_t i = 0; i < a.rows(); ++i) {
+            for (size_t j = 0; j < a.cols(); ++j) {
+                REQUIRE(static_cast<float>(sum(i, j)) ==
+                        static_cast<float>(a(i, j) * 1.5));
+                REQUIRE(t(j, i).bits() == h(i, j).bits());
+            }
+        }
+        REQUIRE(h.norm() == Approx(a.norm()));
+        REQUIRE(bf.norm() == Approx(a.norm()));
+    }
+
+    SECTION("Identity") {
+        const BasicMatrix<Half> eye = identity<Half>(3);
+        REQUIRE(static_cast<float>(eye(1, 1)) == 1.0F);
+        REQUIRE(static_cast<float>(eye(1, 2)) == 0.0F);
+    }
+}
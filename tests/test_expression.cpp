@@ -0,0 +1,106 @@
+#include <catch2/catch_test_macros.hpp>
+#include "matrixops/matrix.h"
+#include "test_helpers.h"
+
+#include <utility>
+
+using namespace matrixops;
+using namespace matrixops::testing;
+
+TEST_CASE("Fused expressions match eager evaluation", "[expression]") {
+    Matrix a = make_ramp_matrix(4, 5, 1.0);
+    Matrix b = make_ramp_matrix(4, 5, 2.0);
+    Matrix c = make_ramp_matrix(4, 5, -0.5);
+
+    SECTION("Three terms") {
+        Matrix fused = a + b * 2.0 + c;
+        for (size_t i = 0; i < 4; ++i) {
+            for (size_t j = 0; j < 5; ++j) {
+                REQUIRE(fused(i, j) == a(i, j) + b(i, j) * 2.0 + c(i, j));
+            }
+        }
+    }
+
+    SECTION("Nested scaling") {
+        Matrix fused = (a + b) * 0.5 * 4.0;
+        for (size_t i = 0; i < 4; ++i) {
+            for (size_t j = 0; j < 5; ++j) {
+                REQUIRE(fused(i, j) == (a(i, j) + b(i, j)) * 0.5 * 4.0);
+            }
+        }
+    }
+
+    SECTION("Large expressions take the parallel path") {
+        Matrix x = make_ramp_matrix(300, 250, 0.25);
+        Matrix y = make_ramp_matrix(300, 250, 3.0);
+        Matrix fused = x * 3.0 + y + x;
+        REQUIRE(fused(299, 249) == x(299, 249) * 3.0 + y(299, 249) +
+                                       x(299, 249));
+        REQUIRE(fused(0, 0) == x(0, 0) * 3.0 + y(0, 0) + x(0, 0));
+    }
+}
+
+TEST_CASE("Expression assignment", "[expression]") {
+    Matrix a = make_ramp_matrix(3, 3, 1.0);
+    Matrix b = make_ramp_matrix(3, 3, 2.0);
+
+    SECTION("Aliasing the destination") {
+        const Matrix original = a;
+        a = a + b * 2.0;
+        for (size_t i = 0; i < 3; ++i) {
+            for (size_t j = 0; j < 3; ++j) {
+                REQUIRE(a(i, j) == original(i, j) + b(i, j) * 2.0);
+            }
+        }
+    }
+
+    SECTION("Destination with different dimensions is resized") {
+        Matrix d(1, 7);
+        d = a + b;
+        REQUIRE(d.rows() == 3);
+        REQUIRE(d.cols() == 3);
+        REQUIRE(d(2, 2) == a(2, 2) + b(2, 2));
+    }
+
+    SECTION("Moved-from destination gets new storage") {
+        // Both inline and heap storage
+        for (size_t n : {3, 50}) {
+            const Matrix x = make_ramp_matrix(n, n, 1.0);
+            const Matrix y = make_ramp_matrix(n, n, 2.0);
+            Matrix d(n, n);
+            const Matrix moved = std::move(d);
+            d = x + y;
+            REQUIRE(d.rows() == n);
+            REQUIRE(d.cols() == n);
+            REQUIRE(d(n - 1, n - 1) == x(n - 1, n - 1) + y(n - 1, n - 1));
+            REQUIRE(moved.rows() == n);
+        }
+    }
+}
+
+TEST_CASE("Expressions as multiplication operands", "[expression]") {
+    Matrix a = make_ramp_matrix(2, 3, 1.0);
+    Matrix b = make_ramp_matrix(3, 2, 1.0);
+
+    Matrix expected = (a * 2.0) * b;
+    Matrix explicit_lhs = a * 2.0;
+    Matrix reference = explicit_lhs * b;
+    for (size_t i = 0; i < 2; ++i) {
+        for (size_t j = 0; j < 2; ++j) {
+            REQUIRE(expected(i, j) == reference(i, j));
+        }
+    }
+
+    Matrix both = (a + a) * (b * 0.5);
+    Matrix both_reference = Matrix(a + a) * Matrix(b * 0.5);
+    REQUIRE(both(1, 1) == both_reference(1, 1));
+}
+
+TEST_CASE("Dimension mismatch inside an expression throws",
+          "[expression]") {
+    Matrix a(2, 2, 1.0);
+    Matrix b(2, 2, 2.0);
+    Matrix d(2, 3, 1.0);
+    REQUIRE_THROWS_AS(a + b * 2.0 + d, std::invalid_argument);
+    REQUIRE_THROWS_AS((a + d) * 2.0, std::invalid_argument);
+}
@@ -0,0 +1,146 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_approx.hpp>
+#include "matrixops/fixed_matrix.h"
+#include "matrixops/matrix.h"
+
+#include <complex>
+#include <type_traits>
+
+using namespace matrixops;
+using Catch::Approx;
+
+namespace {
+
+using Mat2 = FixedMatrix<double, 2, 2>;
+using Mat3 = FixedMatrix<double, 3, 3>;
+
+// Everything except norm() is usable in constant expressions.
+constexpr Mat2 A(1, 2, 3, 4);
+constexpr Mat2 B(5, 6, 7, 8);
+constexpr Mat2 PRODUCT = A * B;
+static_assert(PRODUCT(0, 0) == 19 && PRODUCT(0, 1) == 22);
+static_assert(PRODUCT(1, 0) == 43 && PRODUCT(1, 1) == 50);
+static_assert((A + B).get<1, 1>() == 12);
+static_assert(A.transpose()(0, 1) == 3);
+static_assert(A.squared_norm() == 30);
+static_assert(Mat3::identity()(2, 2) == 1 && Mat3::identity()(0, 2) == 0);
+static_assert(Mat2::rows() == 2 && FixedMatrix<float, 2, 5>::cols() == 5);
+
+// Storage is inline: nothing but the elements.
+static_assert(sizeof(FixedMatrix<double, 3, 4>) == 12 * sizeof(double));
+static_assert(std::is_trivially_copyable_v<Mat3>);
+
+template <size_t R, size_t C>
+FixedMatrix<double, R, C> make_fixed(double seed) {
+    FixedMatrix<double, R, C> m;
+    for (size_t i = 0; i < R; ++i) {
+        for (size_t j = 0; j < C; ++j) {
+            m(i, j) = static_cast<double>((i * 7 + j * 13) % 17) * seed - 3.0;
+        }
+    }
+    return m;
+}
+
+} // namespace
+
+TEST_CASE("FixedMatrix construction", "[fixed]") {
+    const Mat3 zero;
+    const Mat3 filled(2.5);
+    for (size_t i = 0; i < 3; ++i) {
+        for (size_t j = 0; j < 3; ++j) {
+            REQUIRE(zero(i, j) == 0.0);
+            REQUIRE(filled(i, j) == 2.5);
+        }
+    }
+    REQUIRE(Mat3::is_square());
+    REQUIRE_FALSE((FixedMatrix<double, 2, 3>::is_square()));
+}
+
+TEST_CASE("FixedMatrix arithmetic matches Matrix", "[fixed]") {
+    const auto a = make_fixed<4, 3>(0.5);
+    const auto b = make_fixed<4, 3>(-0.25);
+    const auto c = make_fixed<3, 5>(0.75);
+    const Matrix da = a;
+    const Matrix db = b;
+    const Matrix dc = c;
+
+    const FixedMatrix<double, 4, 5> product = a * c;
+    const Matrix expected_product = da * dc;
+    const FixedMatrix<double, 4, 3> sum = a + b;
+    const FixedMatrix<double, 4, 3> scaled = a * 3.0;
+    const FixedMatrix<double, 3, 4> transposed = a.transpose();
+    for (size_t i = 0; i < 4; ++i) {
+        for (size_t j = 0; j < 5; ++j) {
+            REQUIRE(product(i, j) == Approx(expected_product(i, j)));
+        }
+        for (size_t j = 0; j < 3; ++j) {
+            REQUIRE(sum(i, j) == da(i, j) + db(i, j));
+            REQUIRE(scaled(i, j) == da(i, j) * 3.0);
+            REQUIRE(transposed(j, i) == da(i, j));
+        }
+    }
+    REQUIRE(a.norm() == Approx(da.norm()));
+
+    SECTION("In-place operations") {
+        auto m = a;
+        m += b;
+        m *= 2.0;
+        auto square = make_fixed<3, 3>(1.5);
+        const auto original = square;
+        square.transpose_inplace();
+        for (size_t i = 0; i < 3; ++i) {
+            for (size_t j = 0; j < 3; ++j) {
+                REQUIRE(m(i, j) == (da(i, j) + db(i, j)) * 2.0);
+                REQUIRE(square(i, j) == original(j, i));
+            }
+        }
+    }
+}
+
+TEST_CASE("FixedMatrix interoperates with Matrix", "[fixed]") {
+    const auto f = make_fixed<3, 3>(0.5);
+
+    SECTION("Conversion in both directions") {
+        const Matrix m = f;
+        REQUIRE(m.rows() == 3);
+        REQUIRE(m.cols() == 3);
+        const Mat3 back(m);
+        for (size_t i = 0; i < 3; ++i) {
+            for (size_t j = 0; j < 3; ++j) {
+                REQUIRE(back(i, j) == f(i, j));
+            }
+        }
+    }
+
+    SECTION("Wrong dynamic size") {
+        REQUIRE_THROWS_AS(Mat3(Matrix(3, 4)), std::invalid_argument);
+    }
+
+    SECTION("Mixed expressions") {
+        const Matrix m(3, 3, 1.0);
+        const Matrix sum = m + f * 2.0;
+        const Matrix product = m * f;
+        for (size_t i = 0; i < 3; ++i) {
+            for (size_t j = 0; j < 3; ++j) {
+                REQUIRE(sum(i, j) == 1.0 + f(i, j) * 2.0);
+                REQUIRE(product(i, j) == Approx(f(0, j) + f(1, j) + f(2, j)));
+            }
+        }
+        REQUIRE_THROWS_AS(Matrix(Matrix(2, 3) + f), std::invalid_argument);
+    }
+}
+
+TEST_CASE("FixedMatrix with other element types", "[fixed][types]") {
+    using Complex = std::complex<double>;
+    const FixedMatrix<Complex, 2, 2> z(Complex(1, 1), Complex(0, 2),
+                                       Complex(3, 0), Complex(1, -1));
+    const auto p = z * z;
+    REQUIRE(p(0, 0) == Complex(1, 1) * Complex(1, 1) +
+                           Complex(0, 2) * Complex(3, 0));
+    REQUIRE(z.norm() == Approx(std::sqrt(2.0 + 4.0 + 9.0 + 2.0)));
+
+    const FixedMatrix<float, 2, 3> f(1, 2, 3, 4, 5, 6);
+    const FixedMatrix<float, 3, 2> t = f.transpose();
+    REQUIRE(t(2, 1) == 6.0F);
+    REQUIRE(f.norm() == Approx(std::sqrt(91.0F)));
+}
@@ -0,0 +1,305 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_approx.hpp>
+#include "matrixops/gemm.h"
+#include "matrixops/matrix.h"
+#include "test_helpers.h"
+
+#include <complex>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+using namespace matrixops;
+using namespace matrixops::testing;
+using Catch::Approx;
+
+namespace {
+
+Matrix naive_multiply(const Matrix& a, const Matrix& b) {
+    Matrix c(a.rows(), b.cols(), 0.0);
+    for (size_t i = 0; i < a.rows(); ++i) {
+        for (size_t j = 0; j < b.cols(); ++j) {
+            for (size_t k = 0; k < a.cols(); ++k) {
+                c(i, j) += a(i, k) * b(k, j);
+            }
+        }
+    }
+    return c;
+}
+
+void require_equal(const Matrix& actual, const Matrix& expected) {
+    REQUIRE(actual.rows() == expected.rows());
+    REQUIRE(actual.cols() == expected.cols());
+    for (size_t i = 0; i < expected.rows(); ++i) {
+        for (size_t j = 0; j < expected.cols(); ++j) {
+            REQUIRE(actual(i, j) == Approx(expected(i, j)));
+        }
+    }
+}
+
+} // namespace
+
+TEST_CASE("Blocked multiplication matches naive product", "[gemm]") {
+    SECTION("Sizes not multiple of the register tile") {
+        Matrix a = make_scaled_matrix(67, 45, 0.5);
+        Matrix b = make_scaled_matrix(45, 71, 0.25);
+        require_equal(a * b, naive_multiply(a, b));
+    }
+
+    SECTION("Several cache blocks in every dimension") {
+        const GemmBlocking saved = gemm_blocking();
+        set_gemm_blocking({8, 16, 24});
+
+        Matrix a = make_scaled_matrix(50, 40, 1.0);
+        Matrix b = make_scaled_matrix(40, 33, 2.0);
+        Matrix c = a * b;
+
+        set_gemm_blocking(saved);
+        require_equal(c, naive_multiply(a, b));
+    }
+
+    SECTION("Rectangular shapes") {
+        Matrix tall = make_scaled_matrix(150, 3, 1.5);
+        Matrix wide = make_scaled_matrix(3, 150, 0.75);
+        require_equal(tall * wide, naive_multiply(tall, wide));
+        require_equal(wide * tall, naive_multiply(wide, tall));
+    }
+}
+
+TEST_CASE("Raw gemm applies alpha and beta", "[gemm]") {
+    const size_t n = 40;
+    Matrix a = make_scaled_matrix(n, n, 1.0);
+    Matrix b = make_scaled_matrix(n, n, 0.5);
+    Matrix expected = naive_multiply(a, b);
+
+    std::vector<double> c(n * n, 1.0);
+    std::vector<double> a_data(n * n);
+    std::vector<double> b_data(n * n);
+    for (size_t i = 0; i < n; ++i) {
+        for (size_t j = 0; j < n; ++j) {
+            a_data[i * n + j] = a(i, j);
+            b_data[i * n + j] = b(i, j);
+        }
+    }
+
+    gemm(n, n, n, 2.0, a_data.data(), n, b_data.data(), n, 3.0, c.data(), n);
+
+    for (size_t i = 0; i < n; ++i) {
+        for (size_t j = 0; j < n; ++j) {
+            REQUIRE(c[i * n + j] == Approx(2.0 * expected(i, j) + 3.0));
+        }
+    }
+}
+
+TEST_CASE("Raw gemm reads column-major operands in place",
+          "[gemm][layout]") {
+    // Small products take the unpacked loops, large ones the packed path.
+    for (const size_t n : {size_t{9}, size_t{70}}) {
+        const size_t m = n + 3, k = n + 5, ld = k + 7;
+        const Matrix a = make_scaled_matrix(m, k, 1.0);
+        const Matrix b = make_scaled_matrix(k, n, 0.5);
+        const Matrix expected = naive_multiply(a, b);
+
+        // Each operand in both layouts, with padded leading dimensions.
+        std::vector<double> a_row(m * ld), a_col(k * ld);
+        std::vector<double> b_row(k * ld), b_col(n * ld);
+        for (size_t i = 0; i < m; ++i) {
+            for (size_t p = 0; p < k; ++p) {
+                a_row[i * ld + p] = a(i, p);
+                a_col[p * ld + i] = a(i, p);
+            }
+        }
+        for (size_t p = 0; p < k; ++p) {
+            for (size_t j = 0; j < n; ++j) {
+                b_row[p * ld + j] = b(p, j);
+                b_col[j * ld + p] = b(p, j);
+            }
+        }
+
+        const Layout layouts[] = {Layout::ROW_MAJOR, Layout::COLUMN_MAJOR};
+        for (const Layout layout_a : layouts) {
+            for (const Layout layout_b : layouts) {
+                const double* pa = layout_a == Layout::ROW_MAJOR
+                                       ? a_row.data()
+                                       : a_col.data();
+                const double* pb = layout_b == Layout::ROW_MAJOR
+                                       ? b_row.data()
+                                       : b_col.data();
+                // The native kernels, then the vendor BLAS if there is one.
+                const size_t saved = blas_threshold();
+                for (const size_t threshold : {SIZE_MAX, size_t{0}}) {
+                    set_blas_threshold(threshold);
+                    Matrix c(m, n, 1.0);
+                    gemm(m, n, k, 2.0, pa, ld, pb, ld, -1.0, c.data(), n,
+                         layout_a, layout_b);
+                    for (size_t i = 0; i < m; ++i) {
+                        for (size_t j = 0; j < n; ++j) {
+                            REQUIRE(c(i, j) ==
+                                    Approx(2.0 * expected(i, j) - 1.0));
+                        }
+                    }
+                }
+                set_blas_threshold(saved);
+            }
+        }
+    }
+}
+
+TEST_CASE("GEMM blocking configuration", "[gemm][config]") {
+    const GemmBlocking saved = gemm_blocking();
+
+    SECTION("Block sizes are rounded to the register tile") {
+        set_gemm_blocking({5, 100, 9});
+        const GemmBlocking blocking = gemm_blocking();
+        REQUIRE(blocking.mc % 4 == 0);
+        REQUIRE(blocking.mc >= 5);
+        REQUIRE(blocking.kc == 100);
+        REQUIRE(blocking.nc % 8 == 0);
+        REQUIRE(blocking.nc >= 9);
+    }
+
+    SECTION("Zero block sizes throw") {
+        REQUIRE_THROWS_AS(set_gemm_blocking({0, 256, 4096}),
+                          std::invalid_argument);
+        REQUIRE_THROWS_AS(set_gemm_blocking({96, 0, 4096}),
+                          std::invalid_argument);
+        REQUIRE_THROWS_AS(set_gemm_blocking({96, 256, 0}),
+                          std::invalid_argument);
+    }
+
+    set_gemm_blocking(saved);
+}
+
+TEST_CASE("Strassen-Winograd matches the classic product",
+          "[gemm][strassen]") {
+    const StrassenSettings saved = strassen_settings();
+
+    // A small crossover recurses several levels and peels odd sizes at
+    // different depths.
+    const size_t shapes[][3] = {
+        {64, 64, 64}, {67, 45, 71}, {101, 99, 103}, {130, 33, 257}};
+    for (const auto& shape : shapes) {
+        INFO(shape[0] << " x " << shape[1] << " x " << shape[2]);
+        const Matrix a = make_scaled_matrix(shape[0], shape[1], 0.5);
+        const Matrix b = make_scaled_matrix(shape[1], shape[2], 0.25);
+        const Matrix expected = naive_multiply(a, b);
+
+        set_strassen_settings({true, 8});
+        const Matrix c = a * b;
+        Matrix scaled(a.rows(), b.cols(), 1.0);
+        gemm(a.rows(), b.cols(), a.cols(), 2.0, a.data(), a.stride(),
+             b.data(), b.stride(), -1.0, scaled.data(), scaled.stride());
+        set_strassen_settings(saved);
+
+        require_equal(c, expected);
+        for (size_t i = 0; i < expected.rows(); ++i) {
+            for (size_t j = 0; j < expected.cols(); ++j) {
+                REQUIRE(scaled(i, j) == Approx(2.0 * expected(i, j) - 1.0));
+            }
+        }
+    }
+
+    SECTION("Complex and float") {
+        using Complex = std::complex<double>;
+        BasicMatrix<Complex> a(40, 40);
+        BasicMatrix<float> f(40, 40);
+        for (size_t i = 0; i < 40; ++i) {
+            for (size_t j = 0; j < 40; ++j) {
+                a(i, j) = Complex(static_cast<double>((i + j) % 5),
+                                  static_cast<double>(i % 3) - 1.0);
+                f(i, j) = static_cast<float>((i * j) % 7) - 3.0F;
+            }
+        }
+        const BasicMatrix<Complex> expected = a * a;
+        const BasicMatrix<float> f_expected = f * f;
+        set_strassen_settings({true, 4});
+        const BasicMatrix<Complex> c = a * a;
+        const BasicMatrix<float> g = f * f;
+        set_strassen_settings(saved);
+        for (size_t i = 0; i < 40; ++i) {
+            for (size_t j = 0; j < 40; ++j) {
+                REQUIRE(c(i, j).real() ==
+                        Approx(expected(i, j).real()).margin(1e-9));
+                REQUIRE(c(i, j).imag() ==
+                        Approx(expected(i, j).imag()).margin(1e-9));
+                REQUIRE(g(i, j) == Approx(f_expected(i, j)).margin(1e-3));
+            }
+        }
+    }
+
+    SECTION("Settings") {
+        REQUIRE_FALSE(StrassenSettings{}.enabled);
+        REQUIRE_THROWS_AS(set_strassen_settings({true, 0}),
+                          std::invalid_argument);
+        set_strassen_settings({true, 77});
+        REQUIRE(strassen_settings().enabled);
+        REQUIRE(strassen_settings().crossover == 77);
+        set_strassen_settings(saved);
+    }
+}
+
+TEST_CASE("Vendor BLAS and native kernels agree", "[gemm][blas]") {
+    const size_t saved = blas_threshold();
+    const std::string backend = blas_backend();
+    REQUIRE((backend == "none" || backend == "openblas" || backend == "mkl" ||
+             backend == "blis"));
+
+    set_blas_threshold(12345);
+    REQUIRE(blas_threshold() == 12345);
+
+    // Padded leading dimensions and a nonzero beta exercise the operand
+    // swap of the row-major to column-major translation.
+    const size_t m = 37, n = 29, k = 23, ld = 41;
+    std::vector<double> a(m * ld), b(k * ld), c0(m * ld);
+    for (size_t i = 0; i < a.size(); ++i) {
+        a[i] = static_cast<double>(i % 13) - 6.0;
+        c0[i] = static_cast<double>(i % 5);
+    }
+    for (size_t i = 0; i < b.size(); ++i) {
+        b[i] = static_cast<double>(i % 7) * 0.5;
+    }
+    std::vector<std::complex<double>> za(a.begin(), a.end());
+    std::vector<std::complex<double>> zb(b.begin(), b.end());
+    std::vector<std::complex<double>> zc0(c0.begin(), c0.end());
+    std::vector<float> fa(a.begin(), a.end()), fb(b.begin(), b.end());
+    std::vector<float> fc0(c0.begin(), c0.end());
+
+    std::vector<double> native = c0, vendor = c0;
+    std::vector<float> f_native = fc0, f_vendor = fc0;
+    std::vector<std::complex<double>> z_native = zc0, z_vendor = zc0;
+    const std::complex<double> z_alpha(1.0, 2.0), z_beta(0.5, -1.0);
+
+    set_blas_threshold(SIZE_MAX);
+    gemm(m, n, k, 1.5, a.data(), ld, b.data(), ld, -2.0, native.data(), ld);
+    gemm(m, n, k, 1.5F, fa.data(), ld, fb.data(), ld, -2.0F, f_native.data(),
+         ld);
+    gemm(m, n, k, z_alpha, za.data(), ld, zb.data(), ld, z_beta,
+         z_native.data(), ld);
+
+    set_blas_threshold(0);
+    gemm(m, n, k, 1.5, a.data(), ld, b.data(), ld, -2.0, vendor.data(), ld);
+    gemm(m, n, k, 1.5F, fa.data(), ld, fb.data(), ld, -2.0F, f_vendor.data(),
+         ld);
+    gemm(m, n, k, z_alpha, za.data(), ld, zb.data(), ld, z_beta,
+         z_vendor.data(), ld);
+    const Matrix x = make_scaled_matrix(m, k, 1.0);
+    const Matrix y = make_scaled_matrix(k, n, 0.5);
+    require_equal(x * y, naive_multiply(x, y));
+
+    set_blas_threshold(saved);
+
+    for (size_t i = 0; i < m; ++i) {
+        for (size_t j = 0; j < ld; ++j) {
+            const size_t idx = i * ld + j;
+            // Padding columns must be left alone.
+            if (j >= n) {
+                REQUIRE(vendor[idx] == c0[idx]);
+                continue;
+            }
+            REQUIRE(vendor[idx] == Approx(native[idx]));
+            REQUIRE(f_vendor[idx] == Approx(f_native[idx]));
+            REQUIRE(z_vendor[idx].real() == Approx(z_native[idx].real()));
+            REQUIRE(z_vendor[idx].imag() == Approx(z_native[idx].imag()));
+        }
+    }
+}
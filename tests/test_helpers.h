@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+
+#include "matrixops/matrix.h"
+
+namespace matrixops::testing {
+
+// rows x cols matrix with element (i, j) = value(i, j), converted to T.
+template <typename T = double, typename F>
+BasicMatrix<T> generate_matrix(size_t rows, size_t cols, F value) {
+    BasicMatrix<T> m(rows, cols);
+    for (size_t i = 0; i < rows; ++i) {
+        for (size_t j = 0; j < cols; ++j) {
+            m(i, j) = static_cast<T>(value(i, j));
+        }
+    }
+    return m;
+}
+
+// Small integers from -5 to 5, so that sums and products of test operands
+// are exact in every element type and whatever the summation order.
+template <typename T = double>
+BasicMatrix<T> make_matrix(size_t rows, size_t cols, size_t seed = 0) {
+    return generate_matrix<T>(rows, cols, [seed](size_t i, size_t j) {
+        return static_cast<double>((i * 7 + j * 3 + seed) % 11) - 5.0;
+    });
+}
+
+// Element (i, j) = (i * row_step + j) * scale, so that values name their
+// position; with row_step = cols, its row-major offset.
+template <typename T = double>
+BasicMatrix<T> make_index_matrix(size_t rows, size_t cols, size_t row_step,
+                                 double scale = 1.0) {
+    return generate_matrix<T>(
+        rows, cols, [row_step, scale](size_t i, size_t j) {
+            return static_cast<double>(i * row_step + j) * scale;
+        });
+}
+
+// Multiples of scale offset by -3, seventeen distinct values.
+inline Matrix make_scaled_matrix(size_t rows, size_t cols, double scale) {
+    return generate_matrix(rows, cols, [scale](size_t i, size_t j) {
+        return static_cast<double>((i * 7 + j * 13) % 17) * scale - 3.0;
+    });
+}
+
+// Element (i, j) = slope * (i + 1) - j.
+inline Matrix make_ramp_matrix(size_t rows, size_t cols, double slope) {
+    return generate_matrix(rows, cols, [slope](size_t i, size_t j) {
+        return slope * static_cast<double>(i + 1) - static_cast<double>(j);
+    });
+}
+
+// Bit for bit equality of dimensions and elements.
+template <typename T>
+bool same_elements(const BasicMatrix<T>& a, const BasicMatrix<T>& b) {
+    return a.rows() == b.rows() && a.cols() == b.cols() &&
+           std::memcmp(a.data(), b.data(), a.rows() * a.cols() * sizeof(T)) ==
+               0;
+}
+
+// Expressions of double matrices convert through this one.
+inline bool same_elements(const Matrix& a, const Matrix& b) {
+    return same_elements<double>(a, b);
+}
+
+} // namespace matrixops::testing
@@ -0,0 +1,105 @@
+#include <catch2/catch_test_macros.hpp>
+#include "matrixops/matrix.h"
+#include "matrixops/parallel.h"
+#include "test_helpers.h"
+
+using namespace matrixops;
+using namespace matrixops::testing;
+
+TEST_CASE("Uninitialized construction", "[inplace]") {
+    Matrix m(3, 4, UNINITIALIZED);
+    REQUIRE(m.rows() == 3);
+    REQUIRE(m.cols() == 4);
+    REQUIRE_THROWS_AS(Matrix(0, 4, UNINITIALIZED), std::invalid_argument);
+}
+
+TEST_CASE("Compound assignment", "[inplace]") {
+    Matrix a = make_ramp_matrix(3, 4, 1.0);
+    Matrix b = make_ramp_matrix(3, 4, 2.0);
+    const Matrix original = a;
+
+    SECTION("Adding a matrix") {
+        a += b;
+        for (size_t i = 0; i < 3; ++i) {
+            for (size_t j = 0; j < 4; ++j) {
+                REQUIRE(a(i, j) == original(i, j) + b(i, j));
+            }
+        }
+    }
+
+    SECTION("Adding an expression") {
+        a += b * 2.0 + b;
+        for (size_t i = 0; i < 3; ++i) {
+            for (size_t j = 0; j < 4; ++j) {
+                REQUIRE(a(i, j) == original(i, j) + (b(i, j) * 2.0 + b(i, j)));
+            }
+        }
+    }
+
+    SECTION("Adding itself") {
+        a += a;
+        REQUIRE(a(2, 3) == 2.0 * original(2, 3));
+    }
+
+    SECTION("Scaling") {
+        a *= -1.5;
+        for (size_t i = 0; i < 3; ++i) {
+            for (size_t j = 0; j < 4; ++j) {
+                REQUIRE(a(i, j) == original(i, j) * -1.5);
+            }
+        }
+    }
+
+    SECTION("Dimension mismatch throws") {
+        Matrix d(4, 3, 1.0);
+        REQUIRE_THROWS_AS(a += d, std::invalid_argument);
+        REQUIRE_THROWS_AS(a += d * 2.0, std::invalid_argument);
+    }
+}
+
+TEST_CASE("Output-parameter operations", "[inplace]") {
+    Matrix a = make_ramp_matrix(5, 3, 1.0);
+    Matrix b = make_ramp_matrix(3, 4, -0.5);
+
+    SECTION("multiply_into matches operator*") {
+        Matrix out(5, 4, UNINITIALIZED);
+        multiply_into(a, b, out);
+        Matrix expected = a * b;
+        for (size_t i = 0; i < 5; ++i) {
+            for (size_t j = 0; j < 4; ++j) {
+                REQUIRE(out(i, j) == expected(i, j));
+            }
+        }
+    }
+
+    SECTION("multiply_into checks shapes and aliasing") {
+        Matrix wrong(4, 5);
+        REQUIRE_THROWS_AS(multiply_into(a, b, wrong), std::invalid_argument);
+        REQUIRE_THROWS_AS(multiply_into(b, a, wrong), std::invalid_argument);
+        Matrix sq = make_ramp_matrix(3, 3, 1.0);
+        REQUIRE_THROWS_AS(multiply_into(sq, sq, sq), std::invalid_argument);
+    }
+
+    SECTION("add_into, including into an operand") {
+        Matrix c = make_ramp_matrix(5, 3, 3.0);
+        Matrix out(5, 3, UNINITIALIZED);
+        add_into(a, c, out);
+        REQUIRE(out(4, 2) == a(4, 2) + c(4, 2));
+        add_into(a, c, a);
+        REQUIRE(a(4, 2) == out(4, 2));
+        REQUIRE_THROWS_AS(add_into(a, c, b), std::invalid_argument);
+        REQUIRE_THROWS_AS(add_into(a, b, out), std::invalid_argument);
+    }
+}
+
+TEST_CASE("In-place operations on the parallel path", "[inplace][parallel]") {
+    set_num_threads(4);
+    Matrix a = make_ramp_matrix(300, 250, 0.25);
+    Matrix b = make_ramp_matrix(300, 250, 3.0);
+    const Matrix original = a;
+    a += b;
+    a *= 0.5;
+    REQUIRE(a(299, 249) == (original(299, 249) + b(299, 249)) * 0.5);
+    REQUIRE(a(0, 0) == (original(0, 0) + b(0, 0)) * 0.5);
+    set_num_threads(0);
+}
@@ -0,0 +1,131 @@
+#include <catch2/catch_test_macros.hpp>
+#include "matrixops/gemm.h"
+#include "matrixops/instrumentation.h"
+#include "matrixops/matrix.h"
+
+#include <string>
+#include <vector>
+
+using namespace matrixops;
+
+namespace {
+
+// The buckets recorded for one operation.
+std::vector<OperationStats> stats_for(const std::string& operation) {
+    std::vector<OperationStats> result;
+    for (const OperationStats& s : instrumentation_stats()) {
+        if (s.operation == operation) {
+            result.push_back(s);
+        }
+    }
+    return result;
+}
+
+struct ZoneCounts {
+    int begun = 0;
+    int ended = 0;
+    std::string last;
+};
+
+void* count_begin(const char* name, void* user) {
+    auto* counts = static_cast<ZoneCounts*>(user);
+    ++counts->begun;
+    counts->last = name;
+    return counts;
+}
+
+void count_end(void* zone, void* user) {
+    if (zone == user) {
+        ++static_cast<ZoneCounts*>(user)->ended;
+    }
+}
+
+} // namespace
+
+TEST_CASE("Instrumentation reports nothing when compiled out",
+          "[instrumentation]") {
+    if (instrumentation_available()) {
+        return;
+    }
+    const Matrix a(64, 64, 1.0);
+    const Matrix product = a * a;
+    REQUIRE(product(0, 0) == 64.0);
+    REQUIRE_FALSE(instrumentation_enabled());
+    REQUIRE(instrumentation_stats().empty());
+    REQUIRE(instrumentation_json().find("\"available\": false") !=
+            std::string::npos);
+}
+
+TEST_CASE("Instrumentation records the outermost operation",
+          "[instrumentation]") {
+    if (!instrumentation_available()) {
+        return;
+    }
+    const Matrix a(64, 32, 1.0);
+    const Matrix b(32, 48, 2.0);
+    reset_instrumentation();
+    const Matrix product = a * b;
+
+    const std::vector<OperationStats> multiply = stats_for("multiply");
+    REQUIRE(multiply.size() == 1);
+    REQUIRE(multiply[0].calls == 1);
+    // 64 x 48 = 3072 result elements fall in [2048, 4096).
+    REQUIRE(multiply[0].min_elements == 2048);
+    REQUIRE(multiply[0].flops == 2.0 * 64 * 48 * 32);
+    REQUIRE(multiply[0].bytes == (64 * 32 + 32 * 48 + 64 * 48) * 8.0);
+    REQUIRE(multiply[0].bytes_allocated >= 64 * 48 * sizeof(double));
+    // The gemm() inside operator* is part of the multiply.
+    REQUIRE(stats_for("gemm").empty());
+
+    Matrix c(64, 48, UNINITIALIZED);
+    gemm(64, 48, 32, 1.0, a.data(), a.stride(), b.data(), b.stride(), 0.0,
+         c.data(), c.stride());
+    REQUIRE(stats_for("gemm").size() == 1);
+    REQUIRE(stats_for("allocate").at(0).bytes_allocated >=
+            64 * 48 * sizeof(double));
+
+    reset_instrumentation();
+    REQUIRE(instrumentation_stats().empty());
+}
+
+TEST_CASE("Instrumentation can be paused", "[instrumentation]") {
+    if (!instrumentation_available()) {
+        return;
+    }
+    const Matrix a(16, 16, 1.0);
+    reset_instrumentation();
+    set_instrumentation_enabled(false);
+    REQUIRE_FALSE(instrumentation_enabled());
+    const Matrix sum = a + a;
+    set_instrumentation_enabled(true);
+    REQUIRE(sum(0, 0) == 2.0);
+    REQUIRE(instrumentation_stats().empty());
+
+    const double n = a.norm();
+    REQUIRE(n == 16.0);
+    REQUIRE(stats_for("norm").size() == 1);
+    REQUIRE(instrumentation_json().find("\"operation\": \"norm\"") !=
+            std::string::npos);
+    reset_instrumentation();
+}
+
+TEST_CASE("Zone hooks bracket every recorded operation",
+          "[instrumentation]") {
+    if (!instrumentation_available()) {
+        return;
+    }
+    ZoneCounts counts;
+    ZoneHooks hooks;
+    hooks.begin = count_begin;
+    hooks.end = count_end;
+    hooks.user = &counts;
+    set_zone_hooks(hooks);
+    Matrix a(32, 32, 1.0);
+    a.transpose_inplace();
+    a *= 2.0;
+    set_zone_hooks(ZoneHooks{});
+    REQUIRE(counts.begun == 2);
+    REQUIRE(counts.ended == 2);
+    REQUIRE(counts.last == "scale");
+    reset_instrumentation();
+}
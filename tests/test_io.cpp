@@ -0,0 +1,141 @@
+#include <catch2/catch_test_macros.hpp>
+#include "matrixops/io.h"
+#include "test_helpers.h"
+
+#include <complex>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace matrixops;
+using namespace matrixops::testing;
+
+namespace {
+
+// A file in the temporary directory, removed when the test ends.
+class TempFile {
+public:
+    explicit TempFile(const std::string& name)
+        : path_((std::filesystem::temp_directory_path() /
+                 ("matrixops_test_" + name))
+                    .string()) {}
+    ~TempFile() { std::filesystem::remove(path_); }
+
+    const std::string& path() const { return path_; }
+
+private:
+    std::string path_;
+};
+
+template <typename T>
+void check_round_trip(const std::string& name) {
+    TempFile file(name);
+    const BasicMatrix<T> m = make_index_matrix<T>(7, 13, 13, 0.5);
+    save_matrix(file.path(), m);
+
+    const BasicMatrix<T> loaded = load_matrix<T>(file.path());
+    REQUIRE(loaded.rows() == 7);
+    REQUIRE(loaded.cols() == 13);
+    REQUIRE(std::memcmp(loaded.data(), m.data(), 7 * 13 * sizeof(T)) == 0);
+
+    const BasicMappedMatrix<T> mapped(file.path());
+    REQUIRE(mapped.rows() == 7);
+    REQUIRE(mapped.cols() == 13);
+    REQUIRE(std::memcmp(mapped.data(), m.data(), 7 * 13 * sizeof(T)) == 0);
+}
+
+// Overwrite bytes of the file at offset.
+void patch(const std::string& path, size_t offset, const void* bytes,
+           size_t size) {
+    std::fstream f(path, std::ios::binary | std::ios::in | std::ios::out);
+    f.seekp(static_cast<std::streamoff>(offset));
+    f.write(static_cast<const char*>(bytes),
+            static_cast<std::streamsize>(size));
+}
+
+} // namespace
+
+TEST_CASE("Matrix files round-trip every element type", "[io]") {
+    check_round_trip<float>("float.mat");
+    check_round_trip<double>("double.mat");
+    check_round_trip<std::complex<float>>("complex64.mat");
+    check_round_trip<std::complex<double>>("complex128.mat");
+    check_round_trip<Half>("half.mat");
+    check_round_trip<BFloat16>("bfloat16.mat");
+}
+
+TEST_CASE("Mapped matrices read the file in place", "[io]") {
+    TempFile file("mapped.mat");
+    const Matrix m = make_index_matrix(100, 30, 30, 0.5);
+    save_matrix(file.path(), m);
+
+    const MatrixFileInfo info = read_matrix_file_info(file.path());
+    REQUIRE(info.version == MATRIX_FILE_VERSION);
+    REQUIRE(info.element_type == ElementType::FLOAT64);
+    REQUIRE(info.rows == 100);
+    REQUIRE(info.cols == 30);
+    REQUIRE(info.data_offset % STORAGE_ALIGNMENT == 0);
+    REQUIRE(std::filesystem::file_size(file.path()) ==
+            info.data_offset + 100 * 30 * sizeof(double));
+
+    const MappedMatrix mapped(file.path());
+    REQUIRE(reinterpret_cast<uintptr_t>(mapped.data()) % STORAGE_ALIGNMENT ==
+            0);
+    REQUIRE(mapped(99, 29) == m(99, 29));
+    REQUIRE(mapped.unchecked(3, 4) == m(3, 4));
+    REQUIRE_THROWS_AS(mapped(100, 0), std::out_of_range);
+
+    // Mapped matrices take part in expressions and products.
+    const Matrix sum = mapped + m;
+    REQUIRE(sum(5, 7) == 2.0 * m(5, 7));
+    const Matrix copy(mapped);
+    REQUIRE(copy(42, 17) == m(42, 17));
+    const Matrix product = mapped * m.transpose();
+    REQUIRE(product.rows() == 100);
+    REQUIRE(product(1, 2) == (m * m.transpose())(1, 2));
+}
+
+TEST_CASE("Matrix file headers are checked", "[io]") {
+    TempFile file("corrupt.mat");
+    const Matrix m = make_index_matrix(4, 4, 4, 0.5);
+    auto reset = [&] { save_matrix(file.path(), m); };
+
+    reset();
+    REQUIRE_THROWS_AS(load_matrix<float>(file.path()), std::runtime_error);
+    REQUIRE_THROWS_AS(BasicMappedMatrix<float>(file.path()),
+                      std::runtime_error);
+
+    const uint32_t newer = MATRIX_FILE_VERSION + 1;
+    patch(file.path(), 8, &newer, sizeof(newer));
+    REQUIRE_THROWS_AS(load_matrix<double>(file.path()), std::runtime_error);
+
+    reset();
+    const uint32_t swapped = 0x04030201;
+    patch(file.path(), 12, &swapped, sizeof(swapped));
+    REQUIRE_THROWS_AS(MappedMatrix(file.path()), std::runtime_error);
+
+    reset();
+    const uint64_t rows = 5;
+    patch(file.path(), 24, &rows, sizeof(rows));
+    REQUIRE_THROWS_AS(read_matrix_file_info(file.path()), std::runtime_error);
+
+    reset();
+    patch(file.path(), 0, "NOTAMATX", 8);
+    REQUIRE_THROWS_AS(MappedMatrix(file.path()), std::runtime_error);
+
+    reset();
+    std::filesystem::resize_file(file.path(), 64 + 15 * sizeof(double));
+    REQUIRE_THROWS_AS(load_matrix<double>(file.path()), std::runtime_error);
+    REQUIRE_THROWS_AS(MappedMatrix(file.path()), std::runtime_error);
+    std::filesystem::resize_file(file.path(), 10);
+    REQUIRE_THROWS_AS(MappedMatrix(file.path()), std::runtime_error);
+
+    REQUIRE_THROWS_AS(load_matrix<double>(file.path() + ".missing"),
+                      std::runtime_error);
+    REQUIRE_THROWS_AS(MappedMatrix(file.path() + ".missing"),
+                      std::runtime_error);
+}
@@ -2,6 +2,9 @@
 #include <catch2/catch_approx.hpp>
 #include "matrixops/matrix.h"
 
+#include <complex>
+#include <stdexcept>
+
 using namespace matrixops;
 using Catch::Approx;
 
@@ -25,6 +28,18 @@ TEST_CASE("Matrix construction", "[matrix][construction]") {
         REQUIRE_THROWS_AS(Matrix(0, 5), std::invalid_argument);
         REQUIRE_THROWS_AS(Matrix(5, 0), std::invalid_argument);
     }
+
+    SECTION("Sizes past the address space throw exception") {
+        // The byte count overflows, then the element count
+        REQUIRE_THROWS_AS(Matrix(size_t{1} << 31, size_t{1} << 30),
+                          std::length_error);
+        REQUIRE_THROWS_AS(Matrix(size_t{1} << 40, size_t{1} << 40, 1.0),
+                          std::length_error);
+        REQUIRE_THROWS_AS(BasicMatrix<std::complex<double>>(
+                              size_t{1} << 30, size_t{1} << 30,
+                              UNINITIALIZED),
+                          std::length_error);
+    }
 }
 
 TEST_CASE("Matrix element access", "[matrix][access]") {
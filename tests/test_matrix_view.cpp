@@ -0,0 +1,199 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_approx.hpp>
+#include "matrixops/matrix.h"
+#include "matrixops/parallel.h"
+#include "test_helpers.h"
+
+#include <complex>
+#include <stdexcept>
+#include <vector>
+
+using namespace matrixops;
+using namespace matrixops::testing;
+using Catch::Approx;
+
+namespace {
+
+// Copy of the rows x cols block at (i, j), element by element.
+template <typename T>
+BasicMatrix<T> copy_block(const BasicMatrix<T>& m, size_t i, size_t j,
+                          size_t rows, size_t cols) {
+    BasicMatrix<T> block(rows, cols);
+    for (size_t r = 0; r < rows; ++r) {
+        for (size_t c = 0; c < cols; ++c) {
+            block(r, c) = m(i + r, j + c);
+        }
+    }
+    return block;
+}
+
+template <typename T>
+void check_view_operations() {
+    const BasicMatrix<T> m = make_matrix<T>(40, 50);
+    const BasicMatrixView<const T> a = m.block(3, 5, 20, 30);
+    const BasicMatrixView<const T> b = m.block(10, 12, 30, 25);
+    const BasicMatrix<T> a_copy = copy_block(m, 3, 5, 20, 30);
+    const BasicMatrix<T> b_copy = copy_block(m, 10, 12, 30, 25);
+
+    REQUIRE(same_elements(BasicMatrix<T>(a), a_copy));
+    REQUIRE(same_elements(BasicMatrix<T>(a * b), a_copy * b_copy));
+    REQUIRE(same_elements(BasicMatrix<T>(a + m.block(0, 0, 20, 30)),
+                          BasicMatrix<T>(a_copy +
+                                         copy_block(m, 0, 0, 20, 30))));
+    REQUIRE(same_elements(a.transpose(), a_copy.transpose()));
+    REQUIRE(a.norm() == a_copy.norm());
+
+    // A transposed view is strided; every operation packs or walks it.
+    const BasicMatrixView<const T> t = b.transposed();
+    REQUIRE(t.col_stride() == m.stride());
+    REQUIRE(same_elements(BasicMatrix<T>(t), b_copy.transpose()));
+    REQUIRE(same_elements(t.transpose(), b_copy));
+    REQUIRE(same_elements(BasicMatrix<T>(t * a.transposed()),
+                          b_copy.transpose() * a_copy.transpose()));
+    REQUIRE(same_elements(BasicMatrix<T>(t + t), BasicMatrix<T>(
+                                                     b_copy.transpose() +
+                                                     b_copy.transpose())));
+}
+
+} // namespace
+
+TEST_CASE("MatrixView refers to a block without copying",
+          "[matrix_view]") {
+    Matrix m = make_matrix<double>(6, 8);
+    MatrixView block = m.block(1, 2, 3, 4);
+    REQUIRE(block.rows() == 3);
+    REQUIRE(block.cols() == 4);
+    REQUIRE(block.stride() == 8);
+    REQUIRE(block.data() == &m(1, 2));
+    REQUIRE_FALSE(block.is_contiguous());
+    REQUIRE(MatrixView(m).is_contiguous());
+
+    block(2, 3) = 42.0;
+    REQUIRE(m(3, 5) == 42.0);
+    REQUIRE(block.row(2)[3] == 42.0);
+    REQUIRE(block.col(3)[2] == 42.0);
+    REQUIRE(block.block(1, 1, 2, 3)(1, 2) == 42.0);
+    REQUIRE(block.transposed()(3, 2) == 42.0);
+
+    const ConstMatrixView read_only = block;
+    REQUIRE(read_only(2, 3) == 42.0);
+
+    REQUIRE_THROWS_AS(block(3, 0), std::out_of_range);
+    REQUIRE_THROWS_AS(m.block(4, 0, 3, 1), std::out_of_range);
+    REQUIRE_THROWS_AS(m.block(0, 8, 1, 1), std::out_of_range);
+    REQUIRE_THROWS_AS(block.block(0, 0, 4, 1), std::out_of_range);
+    REQUIRE_THROWS_AS(MatrixView(m.data(), 0, 3, 3), std::invalid_argument);
+}
+
+TEST_CASE("MatrixView wraps external memory", "[matrix_view]") {
+    // Column-major storage, as from Fortran or a NumPy array with
+    // order='F', is a row-major view with swapped strides.
+    std::vector<double> column_major = {1, 2, 3, 4, 5, 6};
+    const ConstMatrixView v(column_major.data(), 2, 3, 1, 2);
+    REQUIRE(v(0, 1) == 3.0);
+    REQUIRE(v(1, 2) == 6.0);
+
+    Matrix expected(2, 3);
+    for (size_t i = 0; i < 2; ++i) {
+        for (size_t j = 0; j < 3; ++j) {
+            expected(i, j) = column_major[j * 2 + i];
+        }
+    }
+    REQUIRE(same_elements(Matrix(v), expected));
+    REQUIRE(v.norm() == Approx(expected.norm()));
+    REQUIRE_THROWS_AS(v * v, std::invalid_argument);
+    REQUIRE_THROWS_AS(Matrix(v + v.transposed()), std::invalid_argument);
+}
+
+TEST_CASE("MatrixView converts between row-major and column-major",
+          "[matrix_view][layout]") {
+    const Matrix m = make_matrix<double>(70, 45);
+    std::vector<double> buffer(m.rows() * m.cols());
+    const MatrixView column_major(buffer.data(), m.rows(), m.cols(),
+                                  Layout::COLUMN_MAJOR);
+    REQUIRE(column_major.stride() == 1);
+    REQUIRE(column_major.col_stride() == m.rows());
+
+    column_major.copy_from(m);
+    REQUIRE(buffer[44 * 70 + 69] == m(69, 44));
+    REQUIRE(buffer[3 * 70 + 5] == m(5, 3));
+    REQUIRE(same_elements(Matrix(column_major), m));
+
+    // Products read both layouts without packing a copy first.
+    const Matrix b = make_matrix<double>(45, 30);
+    REQUIRE(same_elements(Matrix(column_major * b), m * b));
+    REQUIRE(same_elements(Matrix(b.transpose() * column_major.transposed()),
+                          b.transpose() * m.transpose()));
+
+    Matrix back(70, 45, 0.0);
+    MatrixView(back).copy_from(column_major);
+    REQUIRE(same_elements(back, m));
+    MatrixView(back).block(0, 0, 45, 45).copy_from(
+        column_major.block(0, 0, 45, 45).transposed());
+    REQUIRE(back(3, 5) == m(5, 3));
+    REQUIRE(back(5, 3) == m(3, 5));
+
+    REQUIRE_THROWS_AS(MatrixView(back).copy_from(b), std::invalid_argument);
+}
+
+TEST_CASE("MatrixView operations match copies for every element type",
+          "[matrix_view]") {
+    check_view_operations<float>();
+    check_view_operations<double>();
+    check_view_operations<std::complex<float>>();
+    check_view_operations<std::complex<double>>();
+    check_view_operations<Half>();
+    check_view_operations<BFloat16>();
+}
+
+TEST_CASE("Matrix assignment from a view of itself", "[matrix_view]") {
+    Matrix m = make_matrix<double>(6, 8);
+    const Matrix expected = copy_block(m, 2, 1, 3, 4);
+    m = m.block(2, 1, 3, 4);
+    REQUIRE(same_elements(m, expected));
+
+    Matrix a = make_matrix<double>(5, 5);
+    const Matrix doubled = Matrix(a + a);
+    a += MatrixView(a);
+    REQUIRE(same_elements(a, doubled));
+
+    // A transposed view reads the target out of place; large enough for
+    // the tiled transpose and the parallel paths.
+    for (size_t n : {size_t{5}, size_t{64}, size_t{300}}) {
+        Matrix t = make_matrix<double>(n, n, 1);
+        const Matrix original = t;
+        t = MatrixView(t).transposed();
+        REQUIRE(same_elements(t, original.transpose()));
+
+        t = original;
+        t = t + MatrixView(t).transposed();
+        REQUIRE(same_elements(t, Matrix(original + original.transpose())));
+
+        t = original;
+        t = MatrixView(t).transposed() * 2.0 + t;
+        REQUIRE(same_elements(
+            t, Matrix(original.transpose() * 2.0 + original)));
+
+        t = original;
+        t = MatrixView(t);
+        REQUIRE(same_elements(t, original));
+    }
+}
+
+TEST_CASE("MatrixView operations on large blocks run in parallel",
+          "[matrix_view][parallel]") {
+    const Matrix m = make_matrix<double>(700, 600);
+    const ConstMatrixView a = m.block(50, 40, 600, 500);
+    const Matrix a_copy = copy_block(m, 50, 40, 600, 500);
+
+    const size_t saved = num_threads();
+    set_num_threads(4);
+    const Matrix sum = a + a;
+    const Matrix product = a * a.transposed();
+    const double norm = a.norm();
+    set_num_threads(saved);
+
+    REQUIRE(same_elements(sum, Matrix(a_copy + a_copy)));
+    REQUIRE(same_elements(product, a_copy * a_copy.transpose()));
+    REQUIRE(norm == a_copy.norm());
+}
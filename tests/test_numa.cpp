@@ -0,0 +1,138 @@
+#include <catch2/catch_test_macros.hpp>
+#include "matrixops/matrix.h"
+#include "matrixops/numa.h"
+#include "matrixops/parallel.h"
+#include "test_helpers.h"
+
+#include <atomic>
+#include <complex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace matrixops;
+using namespace matrixops::testing;
+
+namespace {
+
+bool all_equal(const Matrix& m, double value) {
+    for (size_t i = 0; i < m.rows() * m.cols(); ++i) {
+        if (m.data()[i] != value) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Restores the placement and thread count in place before the test.
+class ScopedPlacement {
+public:
+    ScopedPlacement() : saved_(numa_settings()), threads_(num_threads()) {}
+    ~ScopedPlacement() {
+        set_numa_settings(saved_);
+        set_num_threads(threads_);
+    }
+
+    ScopedPlacement(const ScopedPlacement&) = delete;
+    ScopedPlacement& operator=(const ScopedPlacement&) = delete;
+
+private:
+    NumaSettings saved_;
+    size_t threads_;
+};
+
+} // namespace
+
+TEST_CASE("NUMA settings configuration", "[numa][config]") {
+    const ScopedPlacement scoped;
+    REQUIRE(numa_nodes() >= 1);
+
+    NumaSettings settings;
+    settings.policy = NumaPolicy::INTERLEAVE;
+    set_numa_settings(settings);
+    REQUIRE(numa_settings().policy == NumaPolicy::INTERLEAVE);
+    REQUIRE(std::string(numa_policy_name(numa_settings().policy)) ==
+            "interleave");
+
+    settings.policy = NumaPolicy::BIND;
+    settings.node = numa_nodes() - 1;
+    set_numa_settings(settings);
+    REQUIRE(numa_settings().node == numa_nodes() - 1);
+
+    settings.node = numa_nodes();
+    REQUIRE_THROWS_AS(set_numa_settings(settings), std::invalid_argument);
+    REQUIRE(numa_settings().node == numa_nodes() - 1);
+}
+
+TEST_CASE("Large buffers are filled and copied in parallel", "[numa]") {
+    const ScopedPlacement scoped;
+    set_num_threads(4);
+    // 4 MiB of double and 8 MiB of complex, past PARALLEL_INIT_BYTES
+    const size_t rows = 1024;
+    const size_t cols = 512;
+
+    const Matrix filled(rows, cols, 2.5);
+    REQUIRE(all_equal(filled, 2.5));
+
+    const Matrix source = make_matrix(rows, cols, 1);
+    const Matrix copy(source);
+    REQUIRE(same_elements(copy, source));
+    Matrix assigned(rows, cols);
+    assigned = source;
+    REQUIRE(same_elements(assigned, source));
+
+    const BasicMatrix<std::complex<double>> zeros(rows, cols, UNINITIALIZED);
+    bool zero = true;
+    for (size_t i = 0; i < rows * cols; ++i) {
+        zero = zero && zeros.data()[i] == std::complex<double>();
+    }
+    REQUIRE(zero);
+}
+
+TEST_CASE("Pinned workers cover ranges once and keep results", "[numa]") {
+    const ScopedPlacement scoped;
+    set_num_threads(4);
+    const Matrix a = make_matrix(180, 150, 1);
+    const Matrix b = make_matrix(150, 170, 2);
+    const Matrix product = a * b;
+    const Matrix sum = a + a;
+
+    NumaSettings settings = numa_settings();
+    settings.pin_threads = true;
+    set_numa_settings(settings);
+    REQUIRE(numa_settings().pin_threads);
+
+    // Uneven ranges leave some shares short or empty
+    for (size_t n : {10007, 13, 5}) {
+        std::vector<std::atomic<int>> visits(n);
+        parallel_for(0, n, 1, [&](size_t lo, size_t hi) {
+            for (size_t i = lo; i < hi; ++i) {
+                visits[i].fetch_add(1);
+            }
+            parallel_for(0, 8, 1, [](size_t, size_t) {});
+        });
+        bool once = true;
+        for (const auto& v : visits) {
+            once = once && v.load() == 1;
+        }
+        REQUIRE(once);
+    }
+
+    REQUIRE(same_elements(a * b, product));
+    REQUIRE(same_elements(a + a, sum));
+    set_num_threads(7);
+    REQUIRE(same_elements(a * b, product));
+}
+
+TEST_CASE("Placement policies keep buffers usable", "[numa]") {
+    const ScopedPlacement scoped;
+    for (NumaPolicy policy : {NumaPolicy::INTERLEAVE, NumaPolicy::BIND,
+                              NumaPolicy::FIRST_TOUCH}) {
+        NumaSettings settings;
+        settings.policy = policy;
+        set_numa_settings(settings);
+        const Matrix m(1024, 1024, 1.5);
+        const Matrix doubled = m + m;
+        REQUIRE(all_equal(doubled, 3.0));
+    }
+}
@@ -0,0 +1,150 @@
+#include <catch2/catch_test_macros.hpp>
+#include "matrixops/io.h"
+#include "matrixops/out_of_core.h"
+#include "test_helpers.h"
+
+#include <complex>
+#include <cstring>
+#include <filesystem>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+
+using namespace matrixops;
+using namespace matrixops::testing;
+
+namespace {
+
+// A file in the temporary directory, removed when the test ends.
+class TempFile {
+public:
+    explicit TempFile(const std::string& name)
+        : path_((std::filesystem::temp_directory_path() /
+                 ("matrixops_test_ooc_" + name))
+                    .string()) {}
+    ~TempFile() { std::filesystem::remove(path_); }
+
+    const std::string& path() const { return path_; }
+
+private:
+    std::string path_;
+};
+
+// Sets the out-of-core budget for one test and restores it afterwards.
+class BudgetGuard {
+public:
+    explicit BudgetGuard(size_t bytes) : saved_(out_of_core_budget()) {
+        set_out_of_core_budget(bytes);
+    }
+    ~BudgetGuard() { set_out_of_core_budget(saved_); }
+
+private:
+    size_t saved_;
+};
+
+// Quarter-integer entries: every product and partial sum below is exact
+// in every element type, so a tiled result must match bit for bit.
+template <typename T>
+BasicMatrix<T> make_quarter_matrix(size_t rows, size_t cols, size_t seed) {
+    return generate_matrix<T>(rows, cols, [seed](size_t i, size_t j) {
+        const size_t k = (i * 7 + j * 13 + seed) % 17;
+        const float re = (static_cast<float>(k) - 8.0F) * 0.25F;
+        if constexpr (std::is_constructible_v<T, float, float>) {
+            return T(re, 0.5F * re + 0.25F);
+        } else {
+            return re;
+        }
+    });
+}
+
+template <typename T>
+void require_file_equals(const std::string& path, const BasicMatrix<T>& m) {
+    const BasicMappedMatrix<T> mapped(path);
+    REQUIRE(mapped.rows() == m.rows());
+    REQUIRE(mapped.cols() == m.cols());
+    REQUIRE(std::memcmp(mapped.data(), m.data(),
+                        m.rows() * m.cols() * sizeof(T)) == 0);
+}
+
+template <typename T>
+void check_operations(const std::string& name) {
+    // Several tiles of every operation, with ragged edges.
+    BudgetGuard budget(MIN_OUT_OF_CORE_BUDGET);
+    TempFile a_file(name + "_a");
+    TempFile b_file(name + "_b");
+    TempFile c_file(name + "_c");
+    TempFile out(name + "_out");
+    const BasicMatrix<T> a = make_quarter_matrix<T>(410, 300, 1);
+    const BasicMatrix<T> b = make_quarter_matrix<T>(300, 350, 2);
+    const BasicMatrix<T> c = make_quarter_matrix<T>(410, 300, 3);
+    save_matrix(a_file.path(), a);
+    save_matrix(b_file.path(), b);
+    save_matrix(c_file.path(), c);
+
+    multiply_files(a_file.path(), b_file.path(), out.path());
+    require_file_equals(out.path(), BasicMatrix<T>(a * b));
+
+    transpose_file(a_file.path(), out.path());
+    require_file_equals(out.path(), a.transpose());
+
+    add_files(a_file.path(), c_file.path(), out.path());
+    require_file_equals(out.path(), BasicMatrix<T>(a + c));
+}
+
+} // namespace
+
+TEST_CASE("Out-of-core operations match the in-memory ones",
+          "[out_of_core]") {
+    check_operations<float>("float");
+    check_operations<double>("double");
+    check_operations<std::complex<float>>("complex64");
+    check_operations<std::complex<double>>("complex128");
+    check_operations<Half>("half");
+    check_operations<BFloat16>("bfloat16");
+}
+
+TEST_CASE("Out-of-core operations fit in one tile under a large budget",
+          "[out_of_core]") {
+    TempFile a_file("small_a");
+    TempFile b_file("small_b");
+    TempFile out("small_out");
+    const Matrix a = make_quarter_matrix<double>(5, 3, 1);
+    const Matrix b = make_quarter_matrix<double>(3, 4, 2);
+    save_matrix(a_file.path(), a);
+    save_matrix(b_file.path(), b);
+
+    multiply_files(a_file.path(), b_file.path(), out.path());
+    require_file_equals(out.path(), Matrix(a * b));
+    transpose_file(b_file.path(), out.path());
+    require_file_equals(out.path(), b.transpose());
+}
+
+TEST_CASE("Out-of-core budget and operands are validated", "[out_of_core]") {
+    REQUIRE(out_of_core_budget() == size_t{1} << 30);
+    REQUIRE_THROWS_AS(set_out_of_core_budget(MIN_OUT_OF_CORE_BUDGET - 1),
+                      std::invalid_argument);
+    REQUIRE(out_of_core_budget() == size_t{1} << 30);
+
+    TempFile a_file("check_a");
+    TempFile b_file("check_b");
+    TempFile f_file("check_f");
+    TempFile out("check_out");
+    save_matrix(a_file.path(), make_quarter_matrix<double>(4, 3, 1));
+    save_matrix(b_file.path(), make_quarter_matrix<double>(4, 3, 2));
+    save_matrix(f_file.path(), make_quarter_matrix<float>(3, 4, 3));
+
+    REQUIRE_THROWS_AS(multiply_files(a_file.path(), b_file.path(), out.path()),
+                      std::invalid_argument);
+    REQUIRE_THROWS_AS(multiply_files(a_file.path(), f_file.path(), out.path()),
+                      std::invalid_argument);
+    REQUIRE_THROWS_AS(add_files(a_file.path(), f_file.path(), out.path()),
+                      std::invalid_argument);
+    REQUIRE_THROWS_AS(add_files(a_file.path(), b_file.path(), a_file.path()),
+                      std::invalid_argument);
+    REQUIRE_THROWS_AS(transpose_file(a_file.path(), a_file.path()),
+                      std::invalid_argument);
+    REQUIRE_THROWS_AS(transpose_file(out.path(), a_file.path()),
+                      std::runtime_error);
+    // The rejected calls left the inputs intact.
+    REQUIRE(read_matrix_file_info(a_file.path()).rows == 4);
+}
@@ -0,0 +1,148 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_approx.hpp>
+#include "matrixops/gemm.h"
+#include "matrixops/matrix.h"
+#include "matrixops/parallel.h"
+#include "test_helpers.h"
+
+#include <atomic>
+#include <stdexcept>
+#include <vector>
+
+using namespace matrixops;
+using namespace matrixops::testing;
+using Catch::Approx;
+
+TEST_CASE("Thread count configuration", "[parallel][config]") {
+    const size_t saved = num_threads();
+
+    set_num_threads(3);
+    REQUIRE(num_threads() == 3);
+
+    set_num_threads(1);
+    REQUIRE(num_threads() == 1);
+
+    set_num_threads(0);
+    REQUIRE(num_threads() >= 1);
+
+    set_num_threads(saved);
+}
+
+TEST_CASE("parallel_for covers the range exactly once", "[parallel]") {
+    const size_t saved = num_threads();
+    set_num_threads(4);
+
+    SECTION("Every index is visited once") {
+        std::vector<std::atomic<int>> visits(10007);
+        parallel_for(0, visits.size(), 64, [&](size_t lo, size_t hi) {
+            for (size_t i = lo; i < hi; ++i) {
+                visits[i].fetch_add(1);
+            }
+        });
+        for (const auto& v : visits) {
+            REQUIRE(v.load() == 1);
+        }
+    }
+
+    SECTION("Ranges within the grain run as a single chunk") {
+        std::atomic<int> calls{0};
+        parallel_for(5, 105, 100, [&](size_t lo, size_t hi) {
+            REQUIRE(lo == 5);
+            REQUIRE(hi == 105);
+            calls.fetch_add(1);
+        });
+        REQUIRE(calls.load() == 1);
+    }
+
+    SECTION("Nested loops complete") {
+        std::atomic<size_t> total{0};
+        parallel_for(0, 8, 1, [&](size_t lo, size_t hi) {
+            for (size_t i = lo; i < hi; ++i) {
+                parallel_for(0, 1000, 10, [&](size_t a, size_t b) {
+                    total.fetch_add(b - a);
+                });
+            }
+        });
+        REQUIRE(total.load() == 8000);
+    }
+
+    SECTION("Exceptions propagate to the caller") {
+        REQUIRE_THROWS_AS(parallel_for(0, 1000, 1,
+                                       [](size_t lo, size_t) {
+                                           if (lo >= 500) {
+                                               throw std::runtime_error("x");
+                                           }
+                                       }),
+                          std::runtime_error);
+    }
+
+    set_num_threads(saved);
+}
+
+TEST_CASE("Parallel operations match single-threaded results",
+          "[parallel][matrix]") {
+    const size_t saved = num_threads();
+
+    // Large enough to cross every parallel threshold.
+    Matrix a = make_matrix(300, 260);
+    Matrix b = make_matrix(300, 260);
+    Matrix c = make_matrix(260, 210);
+
+    set_num_threads(1);
+    const Matrix sum = a + b;
+    const Matrix scaled = a * 0.5;
+    const Matrix product = a * c;
+    const Matrix transposed = a.transpose();
+    const double norm = a.norm();
+
+    set_num_threads(4);
+    const Matrix p_sum = a + b;
+    const Matrix p_scaled = a * 0.5;
+    const Matrix p_product = a * c;
+    const Matrix p_transposed = a.transpose();
+
+    for (size_t i = 0; i < a.rows(); ++i) {
+        for (size_t j = 0; j < a.cols(); ++j) {
+            REQUIRE(p_sum(i, j) == sum(i, j));
+            REQUIRE(p_scaled(i, j) == scaled(i, j));
+            REQUIRE(p_transposed(j, i) == transposed(j, i));
+        }
+        for (size_t j = 0; j < c.cols(); ++j) {
+            REQUIRE(p_product(i, j) == product(i, j));
+        }
+    }
+    REQUIRE(a.norm() == Approx(norm));
+
+    set_num_threads(saved);
+}
+
+TEST_CASE("Parallel products nested in parallel_for", "[parallel][gemm]") {
+    // A thread waiting for the helpers of its product runs other queued
+    // tasks meanwhile, here whole other products, which must not share its
+    // packing buffers or Strassen temporaries.
+    const size_t saved = num_threads();
+    const StrassenSettings saved_strassen = strassen_settings();
+    const Matrix a = make_matrix(200, 190, 1);
+    const Matrix b = make_matrix(190, 210, 2);
+    set_num_threads(1);
+    const Matrix expected = a * b;
+
+    set_num_threads(8);
+    for (const StrassenSettings& settings :
+         {StrassenSettings{false, 1024}, StrassenSettings{true, 96}}) {
+        set_strassen_settings(settings);
+        for (int run = 0; run < 3; ++run) {
+            std::vector<Matrix> products(64, Matrix(a.rows(), b.cols()));
+            parallel_for(0, products.size(), 1, [&](size_t lo, size_t hi) {
+                for (size_t i = lo; i < hi; ++i) {
+                    products[i] = a * b;
+                }
+            });
+            for (const Matrix& product : products) {
+                REQUIRE(same_elements(product, expected));
+            }
+        }
+    }
+    set_strassen_settings(saved_strassen);
+    set_num_threads(saved);
+}
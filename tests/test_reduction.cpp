@@ -0,0 +1,212 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_approx.hpp>
+#include "matrixops/matrix.h"
+#include "matrixops/matrix_view.h"
+#include "matrixops/parallel.h"
+#include "matrixops/reduction.h"
+#include "matrixops/simd.h"
+#include "matrixops/vector.h"
+
+#include <cmath>
+#include <complex>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <vector>
+
+using namespace matrixops;
+using Catch::Approx;
+
+namespace {
+
+const ReductionMode ORDERED_MODES[] = {ReductionMode::REPRODUCIBLE,
+                                       ReductionMode::COMPENSATED,
+                                       ReductionMode::EXACT};
+
+// Values spread over many magnitudes and signs, so that the rounding of
+// the sums depends on their order.
+template <typename T>
+BasicVector<T> wide_vector(size_t n, uint64_t seed) {
+    BasicVector<T> v(n);
+    uint64_t state = seed;
+    for (size_t i = 0; i < n; ++i) {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        const double mantissa =
+            static_cast<double>(state >> 11) / 9007199254740992.0 - 0.5;
+        const int exponent = static_cast<int>((state >> 3) % 40) - 20;
+        v(i) = static_cast<T>(std::ldexp(mantissa, exponent));
+    }
+    return v;
+}
+
+template <typename T>
+bool same_bits(T a, T b) {
+    return std::memcmp(&a, &b, sizeof(T)) == 0;
+}
+
+Vector vector_of(std::initializer_list<double> values) {
+    Vector v(values.size());
+    size_t i = 0;
+    for (double value : values) {
+        v(i++) = value;
+    }
+    return v;
+}
+
+Vector ones(size_t n) {
+    Vector v(n);
+    for (size_t i = 0; i < n; ++i) {
+        v(i) = 1.0;
+    }
+    return v;
+}
+
+// Restores the reduction mode and thread count in place before the test.
+class ScopedReduction {
+public:
+    ScopedReduction() : mode_(reduction_mode()), threads_(num_threads()) {}
+    ~ScopedReduction() {
+        set_reduction_mode(mode_);
+        set_num_threads(threads_);
+    }
+
+    ScopedReduction(const ScopedReduction&) = delete;
+    ScopedReduction& operator=(const ScopedReduction&) = delete;
+
+private:
+    ReductionMode mode_;
+    size_t threads_;
+};
+
+} // namespace
+
+TEST_CASE("Reduction mode configuration", "[reduction][config]") {
+    const ScopedReduction scoped;
+    set_reduction_mode(ReductionMode::COMPENSATED);
+    REQUIRE(reduction_mode() == ReductionMode::COMPENSATED);
+    REQUIRE(std::string(reduction_mode_name(reduction_mode())) ==
+            "compensated");
+    REQUIRE(std::string(reduction_mode_name(ReductionMode::EXACT)) ==
+            "exact");
+}
+
+TEST_CASE("Ordered reductions give the same bits on every configuration",
+          "[reduction]") {
+    const ScopedReduction scoped;
+    const SimdIsa saved_isa = simd_isa();
+    const size_t n = 200003; // several blocks and a ragged tail
+    const Vector x = wide_vector<double>(n, 1);
+    const Vector y = wide_vector<double>(n, 2);
+    const BasicVector<std::complex<float>> cx =
+        wide_vector<std::complex<float>>(n, 3);
+    const BasicVector<std::complex<float>> cy =
+        wide_vector<std::complex<float>>(n, 4);
+
+    for (ReductionMode mode : ORDERED_MODES) {
+        set_reduction_mode(mode);
+        set_num_threads(1);
+        const double norm = nrm2(x);
+        const double product = dot(x, y);
+        const std::complex<float> complex_product = dot(cx, cy);
+
+        for (SimdIsa isa : {SimdIsa::SCALAR, SimdIsa::SSE2, SimdIsa::AVX2,
+                            SimdIsa::AVX512, SimdIsa::NEON}) {
+            if (!simd_isa_supported(isa)) {
+                continue;
+            }
+            set_simd_isa(isa);
+            for (size_t threads : {2, 5, 8}) {
+                set_num_threads(threads);
+                REQUIRE(same_bits(nrm2(x), norm));
+                REQUIRE(same_bits(dot(x, y), product));
+                REQUIRE(same_bits(dot(cx, cy), complex_product));
+            }
+        }
+        set_simd_isa(saved_isa);
+        REQUIRE(norm == Approx(std::sqrt(dot(x, x))));
+    }
+}
+
+TEST_CASE("Compensated and exact sums survive cancellation",
+          "[reduction]") {
+    const ScopedReduction scoped;
+    // 1 is lost to 1e16 in a plain sum.
+    const Vector big = vector_of({1e16, 1.0, -1e16});
+    // 1 + 2^-53 + 2^-53 = 1 + 2^-52, but each addition alone ties to 1.
+    const double u = std::ldexp(1.0, -53);
+    const Vector ties = vector_of({1.0, u, u});
+
+    set_reduction_mode(ReductionMode::REPRODUCIBLE);
+    REQUIRE(dot(big, ones(3)) == 0.0);
+    REQUIRE(dot(ties, ones(3)) == 1.0);
+
+    for (ReductionMode mode :
+         {ReductionMode::COMPENSATED, ReductionMode::EXACT}) {
+        set_reduction_mode(mode);
+        REQUIRE(dot(big, ones(3)) == 1.0);
+        REQUIRE(dot(ties, ones(3)) == 1.0 + 2 * u);
+    }
+
+    // A long ill-conditioned sum: values of every magnitude that cancel in
+    // mirrored pairs, around a known total of 3.75.
+    const size_t n = 100001;
+    Vector x = wide_vector<double>(n, 5);
+    for (size_t i = 0; i < n / 2; ++i) {
+        x(i) = std::ldexp(x(i), static_cast<int>(i % 61));
+        x(n - 2 - i) = -x(i);
+    }
+    x(n - 1) = 3.75;
+    set_reduction_mode(ReductionMode::EXACT);
+    REQUIRE(dot(x, ones(n)) == 3.75);
+}
+
+TEST_CASE("Exact sums round once, to nearest even", "[reduction]") {
+    const ScopedReduction scoped;
+    set_reduction_mode(ReductionMode::EXACT);
+    const double u = std::ldexp(1.0, -53);
+    const double denorm = std::numeric_limits<double>::denorm_min();
+
+    // A tie rounds to even, anything past it rounds up.
+    REQUIRE(dot(vector_of({1.0, u}), ones(2)) == 1.0);
+    REQUIRE(dot(vector_of({1.0, u, std::ldexp(1.0, -100)}), ones(3)) ==
+            1.0 + 2 * u);
+    REQUIRE(dot(vector_of({-3.0, 1.0}), ones(2)) == -2.0);
+    REQUIRE(dot(vector_of({denorm, denorm, denorm}), ones(3)) == 3 * denorm);
+    // Products below the double range still count
+    REQUIRE(dot(vector_of({denorm, denorm}), vector_of({0.5, 0.5})) ==
+            denorm);
+    REQUIRE(std::isnan(
+        dot(vector_of({std::numeric_limits<double>::infinity(), 0.0}),
+            vector_of({0.0, 1.0}))));
+
+    // Squares beyond the double range need no rescaling
+    Matrix a(40, 50, 1e200);
+    const double expected = 1e200 * std::sqrt(2000.0);
+    REQUIRE(a.norm() == Approx(expected));
+    a = Matrix(40, 50, 1e-200);
+    REQUIRE(a.norm() == Approx(1e-200 * std::sqrt(2000.0)));
+}
+
+TEST_CASE("Ordered norms agree with the fast ones", "[reduction]") {
+    const ScopedReduction scoped;
+    Matrix a(300, 257);
+    for (size_t i = 0; i < a.rows(); ++i) {
+        for (size_t j = 0; j < a.cols(); ++j) {
+            a(i, j) = std::sin(static_cast<double>(i * a.cols() + j));
+        }
+    }
+    const BasicMatrix<float> af(a);
+    set_reduction_mode(ReductionMode::FAST);
+    const double fast = a.norm();
+    const float fast_float = af.norm();
+
+    for (ReductionMode mode : ORDERED_MODES) {
+        set_reduction_mode(mode);
+        REQUIRE(a.norm() == Approx(fast).epsilon(1e-14));
+        REQUIRE(af.norm() == Approx(fast_float).epsilon(1e-6));
+        // Strided views give the bits of their packed copy
+        const MatrixView view = a.block(10, 3, 200, 250);
+        REQUIRE(same_bits(view.norm(), Matrix(view).norm()));
+    }
+}
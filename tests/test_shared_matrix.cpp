@@ -0,0 +1,104 @@
+#include <catch2/catch_test_macros.hpp>
+#include "matrixops/allocator.h"
+#include "matrixops/shared_matrix.h"
+
+#include <thread>
+#include <utility>
+#include <vector>
+
+using namespace matrixops;
+
+namespace {
+
+// Counts the allocations reaching the heap through it.
+class CountingResource : public MemoryResource {
+public:
+    void* allocate(size_t bytes) override {
+        ++allocations;
+        return heap_resource().allocate(bytes);
+    }
+
+    void deallocate(void* p, size_t bytes) noexcept override {
+        ++deallocations;
+        heap_resource().deallocate(p, bytes);
+    }
+
+    int allocations = 0;
+    int deallocations = 0;
+};
+
+double trace(const Matrix& m) {
+    double sum = 0.0;
+    for (size_t i = 0; i < m.rows(); ++i) {
+        sum += m(i, i);
+    }
+    return sum;
+}
+
+} // namespace
+
+TEST_CASE("Shared matrices are copied on write", "[shared_matrix]") {
+    CountingResource counting;
+    {
+        ScopedResource scope(counting);
+        const SharedMatrix original(Matrix(10, 10, 1.0));
+        REQUIRE_FALSE(original.is_shared());
+
+        SharedMatrix copy = original;
+        SharedMatrix writer = copy;
+        REQUIRE(counting.allocations == 1);
+        REQUIRE(original.is_shared());
+        REQUIRE(copy.data() == original.data());
+
+        // Reads keep sharing; the first write detaches the writer.
+        REQUIRE(copy(9, 9) == 1.0);
+        REQUIRE(trace(copy) == 10.0);
+        writer.write()(0, 0) = 2.0;
+        REQUIRE(counting.allocations == 2);
+        REQUIRE(writer.data() != original.data());
+        REQUIRE(original(0, 0) == 1.0);
+        REQUIRE(copy(0, 0) == 1.0);
+        REQUIRE(writer(0, 0) == 2.0);
+
+        // The only handle to its elements writes in place.
+        REQUIRE_FALSE(writer.is_shared());
+        writer.write() *= 3.0;
+        REQUIRE(counting.allocations == 2);
+        REQUIRE(writer(5, 5) == 3.0);
+
+        // Handles are operands like Matrix.
+        const Matrix sum = copy + writer;
+        REQUIRE(sum(5, 5) == 4.0);
+        const Matrix product = copy * writer;
+        REQUIRE(product(0, 0) == 6.0 + 27.0);
+        REQUIRE(counting.allocations == 4);
+    }
+    REQUIRE(counting.deallocations == counting.allocations);
+}
+
+TEST_CASE("Shared matrices are copied and written from many threads",
+          "[shared_matrix][parallel]") {
+    const SharedMatrix config(Matrix(64, 64, 1.0));
+
+    std::vector<std::thread> workers;
+    std::vector<double> results(8);
+    for (size_t t = 0; t < results.size(); ++t) {
+        workers.emplace_back([&config, &results, t] {
+            SharedMatrix local = config;
+            if (t % 2 == 0) {
+                local.write()(0, 0) = static_cast<double>(t);
+            }
+            results[t] = local(0, 0) + local(63, 63);
+        });
+    }
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+
+    for (size_t t = 0; t < results.size(); ++t) {
+        const double first = t % 2 == 0 ? static_cast<double>(t) : 1.0;
+        REQUIRE(results[t] == first + 1.0);
+    }
+    REQUIRE(config(0, 0) == 1.0);
+    REQUIRE_FALSE(config.is_shared());
+}
@@ -0,0 +1,72 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_approx.hpp>
+#include "matrixops/matrix.h"
+#include "matrixops/simd.h"
+#include "test_helpers.h"
+
+#include <string>
+
+using namespace matrixops;
+using namespace matrixops::testing;
+using Catch::Approx;
+
+namespace {
+
+const SimdIsa ALL_ISAS[] = {SimdIsa::SCALAR, SimdIsa::SSE2, SimdIsa::AVX2,
+                            SimdIsa::AVX512, SimdIsa::NEON};
+
+} // namespace
+
+TEST_CASE("SIMD dispatch selects a supported ISA", "[simd]") {
+    REQUIRE(simd_isa_supported(simd_isa()));
+    REQUIRE(simd_isa_supported(SimdIsa::SCALAR));
+    REQUIRE(std::string(simd_isa_name(SimdIsa::AVX512)) == "avx512");
+}
+
+TEST_CASE("Every SIMD variant matches the scalar kernels", "[simd]") {
+    const SimdIsa saved = simd_isa();
+
+    // Odd sizes exercise the vector remainders and partial GEMM tiles.
+    Matrix a = make_matrix(37, 29, 1);
+    Matrix b = make_matrix(37, 29, 2);
+    Matrix c = make_matrix(29, 41, 3);
+
+    set_simd_isa(SimdIsa::SCALAR);
+    const Matrix sum = a + b;
+    const Matrix scaled = a * 3.0;
+    const Matrix product = a * c;
+    const double norm = a.norm();
+
+    for (SimdIsa isa : ALL_ISAS) {
+        if (!simd_isa_supported(isa)) {
+            continue;
+        }
+        INFO("ISA: " << simd_isa_name(isa));
+        set_simd_isa(isa);
+        REQUIRE(simd_isa() == isa);
+
+        const Matrix s = a + b;
+        const Matrix m = a * 3.0;
+        const Matrix p = a * c;
+        for (size_t i = 0; i < a.rows(); ++i) {
+            for (size_t j = 0; j < a.cols(); ++j) {
+                REQUIRE(s(i, j) == sum(i, j));
+                REQUIRE(m(i, j) == scaled(i, j));
+            }
+            for (size_t j = 0; j < c.cols(); ++j) {
+                REQUIRE(p(i, j) == Approx(product(i, j)));
+            }
+        }
+        REQUIRE(a.norm() == Approx(norm));
+    }
+
+    set_simd_isa(saved);
+}
+
+TEST_CASE("Unsupported SIMD variant throws", "[simd]") {
+    for (SimdIsa isa : ALL_ISAS) {
+        if (!simd_isa_supported(isa)) {
+            REQUIRE_THROWS_AS(set_simd_isa(isa), std::invalid_argument);
+        }
+    }
+}
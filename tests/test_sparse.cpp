@@ -0,0 +1,284 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_approx.hpp>
+#include "matrixops/sparse.h"
+#include "matrixops/parallel.h"
+
+#include <complex>
+#include <stdexcept>
+#include <vector>
+
+using namespace matrixops;
+using Catch::Approx;
+
+namespace {
+
+const SparseLayout LAYOUTS[] = {SparseLayout::CSR, SparseLayout::CSC};
+
+// Roughly one element in five is nonzero, with some empty rows and
+// columns.
+Matrix make_sparse_dense(size_t rows, size_t cols) {
+    Matrix m(rows, cols);
+    for (size_t i = 0; i < rows; ++i) {
+        for (size_t j = 0; j < cols; ++j) {
+            const size_t h = (i * 131 + j * 71 + i * j) % 97;
+            if (h % 5 == 0 && i % 7 != 3 && j % 11 != 5) {
+                m(i, j) = static_cast<double>(h) / 8.0 - 6.0;
+            }
+        }
+    }
+    return m;
+}
+
+// 5-point Laplacian of an n x n grid, the pattern of a 2D finite
+// difference discretization.
+SparseMatrix laplacian_2d(size_t n, SparseLayout layout) {
+    SparseBuilder builder(n * n, n * n);
+    for (size_t i = 0; i < n; ++i) {
+        for (size_t j = 0; j < n; ++j) {
+            const size_t row = i * n + j;
+            builder.add(row, row, 4.0);
+            if (i > 0) {
+                builder.add(row, row - n, -1.0);
+            }
+            if (i + 1 < n) {
+                builder.add(row, row + n, -1.0);
+            }
+            if (j > 0) {
+                builder.add(row, row - 1, -1.0);
+            }
+            if (j + 1 < n) {
+                builder.add(row, row + 1, -1.0);
+            }
+        }
+    }
+    return builder.build(layout);
+}
+
+bool same_elements(const Matrix& a, const Matrix& b) {
+    if (a.rows() != b.rows() || a.cols() != b.cols()) {
+        return false;
+    }
+    for (size_t i = 0; i < a.rows(); ++i) {
+        for (size_t j = 0; j < a.cols(); ++j) {
+            if (a(i, j) != b(i, j)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+TEST_CASE("COO assembly sums duplicates", "[sparse]") {
+    for (SparseLayout layout : LAYOUTS) {
+        SparseBuilder builder(3, 4);
+        builder.add(2, 3, 1.0);
+        builder.add(0, 1, 2.0);
+        builder.add(2, 0, 3.0);
+        builder.add(0, 1, 0.5);
+        builder.add(1, 2, 4.0);
+        builder.add(1, 2, -4.0);
+        REQUIRE(builder.size() == 6);
+
+        const SparseMatrix s = builder.build(layout);
+        REQUIRE(s.layout() == layout);
+        REQUIRE(s.rows() == 3);
+        REQUIRE(s.cols() == 4);
+        // The cancelled entry (1, 2) stays in the pattern.
+        REQUIRE(s.nnz() == 4);
+        REQUIRE(s(0, 1) == 2.5);
+        REQUIRE(s(2, 0) == 3.0);
+        REQUIRE(s(2, 3) == 1.0);
+        REQUIRE(s(1, 2) == 0.0);
+        REQUIRE(s(0, 0) == 0.0);
+        REQUIRE_THROWS_AS(s(3, 0), std::out_of_range);
+
+        // Inner indices come out sorted within each slice.
+        const size_t outer = layout == SparseLayout::CSR ? 3 : 4;
+        for (size_t o = 0; o < outer; ++o) {
+            for (size_t k = s.offsets()[o] + 1; k < s.offsets()[o + 1];
+                 ++k) {
+                REQUIRE(s.indices()[k - 1] < s.indices()[k]);
+            }
+        }
+    }
+
+    SparseBuilder builder(2, 2);
+    REQUIRE_THROWS_AS(builder.add(2, 0, 1.0), std::out_of_range);
+    REQUIRE_THROWS_AS(SparseBuilder(0, 3), std::invalid_argument);
+    builder.add(1, 1, 1.0);
+    builder.clear();
+    REQUIRE(builder.build().nnz() == 0);
+}
+
+TEST_CASE("Sparse construction from compressed arrays", "[sparse]") {
+    // [[1, 0, 2], [0, 0, 3]]
+    const SparseMatrix s(2, 3, SparseLayout::CSR, {0, 2, 3}, {0, 2, 2},
+                         {1.0, 2.0, 3.0});
+    REQUIRE(s(0, 2) == 2.0);
+    REQUIRE(s(1, 2) == 3.0);
+
+    const SparseMatrix empty(4, 5);
+    REQUIRE(empty.nnz() == 0);
+    REQUIRE(empty(3, 4) == 0.0);
+
+    REQUIRE_THROWS_AS(SparseMatrix(0, 3), std::invalid_argument);
+    // Wrong number of offsets.
+    REQUIRE_THROWS_AS(SparseMatrix(2, 3, SparseLayout::CSR, {0, 3}, {0, 1, 2},
+                                   {1.0, 2.0, 3.0}),
+                      std::invalid_argument);
+    // Column out of range, and unsorted columns.
+    REQUIRE_THROWS_AS(SparseMatrix(2, 3, SparseLayout::CSR, {0, 1, 2}, {0, 3},
+                                   {1.0, 2.0}),
+                      std::invalid_argument);
+    REQUIRE_THROWS_AS(SparseMatrix(2, 3, SparseLayout::CSR, {0, 2, 2}, {2, 0},
+                                   {1.0, 2.0}),
+                      std::invalid_argument);
+    // Decreasing offsets.
+    REQUIRE_THROWS_AS(SparseMatrix(2, 3, SparseLayout::CSC, {0, 2, 1, 2},
+                                   {0, 1}, {1.0, 2.0}),
+                      std::invalid_argument);
+}
+
+TEST_CASE("Sparse conversion and transpose", "[sparse]") {
+    const Matrix dense = make_sparse_dense(37, 23);
+    for (SparseLayout layout : LAYOUTS) {
+        const SparseMatrix s(dense, layout);
+        REQUIRE(same_elements(s.to_dense(), dense));
+
+        const SparseMatrix csr = s.convert(SparseLayout::CSR);
+        const SparseMatrix csc = s.convert(SparseLayout::CSC);
+        REQUIRE(csr.layout() == SparseLayout::CSR);
+        REQUIRE(csc.layout() == SparseLayout::CSC);
+        REQUIRE(csr.nnz() == s.nnz());
+        REQUIRE(same_elements(csr.to_dense(), dense));
+        REQUIRE(same_elements(csc.to_dense(), dense));
+
+        const SparseMatrix t = s.transpose();
+        REQUIRE(t.layout() == layout);
+        REQUIRE(same_elements(t.to_dense(), dense.transpose()));
+
+        REQUIRE(s.norm() == Approx(dense.norm()));
+    }
+}
+
+TEST_CASE("Sparse products match dense", "[sparse]") {
+    const Matrix dense = make_sparse_dense(41, 29);
+    Matrix b(29, 13);
+    for (size_t i = 0; i < b.rows(); ++i) {
+        for (size_t j = 0; j < b.cols(); ++j) {
+            b(i, j) = static_cast<double>((i * 3 + j * 5) % 7) - 3.0;
+        }
+    }
+    std::vector<double> x(29);
+    for (size_t j = 0; j < x.size(); ++j) {
+        x[j] = static_cast<double>(j % 5) - 2.0;
+    }
+    const Matrix expected = dense * b;
+
+    for (SparseLayout layout : LAYOUTS) {
+        const SparseMatrix s(dense, layout);
+
+        const std::vector<double> y = s * x;
+        REQUIRE(y.size() == 41);
+        for (size_t i = 0; i < y.size(); ++i) {
+            double sum = 0.0;
+            for (size_t j = 0; j < x.size(); ++j) {
+                sum += dense(i, j) * x[j];
+            }
+            REQUIRE(y[i] == Approx(sum));
+        }
+
+        const Matrix product = s * b;
+        for (size_t i = 0; i < product.rows(); ++i) {
+            for (size_t j = 0; j < product.cols(); ++j) {
+                REQUIRE(product(i, j) == Approx(expected(i, j)));
+            }
+        }
+
+        // Output parameters are overwritten, not accumulated into.
+        std::vector<double> y2(41, 99.0);
+        multiply_into(s, x, y2);
+        REQUIRE(y2 == y);
+        Matrix out(41, 13, 99.0);
+        multiply_into(s, b, out);
+        REQUIRE(same_elements(out, product));
+
+        REQUIRE_THROWS_AS(s * std::vector<double>(28),
+                          std::invalid_argument);
+        REQUIRE_THROWS_AS(s * Matrix(28, 2), std::invalid_argument);
+        Matrix wrong(40, 13);
+        REQUIRE_THROWS_AS(multiply_into(s, b, wrong), std::invalid_argument);
+        std::vector<double> square(29, 1.0);
+        const SparseMatrix s_square = SparseMatrix(make_sparse_dense(29, 29),
+                                                   layout);
+        REQUIRE_THROWS_AS(multiply_into(s_square, square, square),
+                          std::invalid_argument);
+    }
+}
+
+TEST_CASE("Parallel sparse products match single-threaded results",
+          "[sparse][parallel]") {
+    const size_t saved = num_threads();
+
+    // Large enough to split into several chunks.
+    const size_t n = 160;
+    std::vector<double> x(n * n);
+    for (size_t k = 0; k < x.size(); ++k) {
+        x[k] = static_cast<double>(k % 13) - 6.0;
+    }
+    Matrix b(n * n, 3);
+    for (size_t i = 0; i < b.rows(); ++i) {
+        for (size_t j = 0; j < 3; ++j) {
+            b(i, j) = static_cast<double>((i + j) % 9);
+        }
+    }
+
+    for (SparseLayout layout : LAYOUTS) {
+        const SparseMatrix s = laplacian_2d(n, layout);
+        REQUIRE(s.nnz() == 5 * n * n - 4 * n);
+
+        set_num_threads(1);
+        const std::vector<double> y = s * x;
+        const Matrix product = s * b;
+        const double norm = s.norm();
+
+        set_num_threads(4);
+        const std::vector<double> p_y = s * x;
+        const Matrix p_product = s * b;
+
+        // The stencil has small integer values, so every order of
+        // summation is exact.
+        REQUIRE(p_y == y);
+        REQUIRE(same_elements(p_product, product));
+        REQUIRE(s.norm() == Approx(norm));
+        REQUIRE(norm == Approx(std::sqrt(16.0 * n * n + 4.0 * n * n -
+                                         4.0 * n)));
+    }
+
+    set_num_threads(saved);
+}
+
+TEST_CASE("Sparse matrices of other element types", "[sparse][types]") {
+    using Complex = std::complex<double>;
+    BasicSparseBuilder<Complex> builder(2, 2);
+    builder.add(0, 0, Complex(1, 1));
+    builder.add(1, 0, Complex(0, 2));
+    builder.add(1, 1, Complex(3, -1));
+    const auto s = builder.build();
+    const std::vector<Complex> y = s * std::vector<Complex>{{1, 0}, {0, 1}};
+    REQUIRE(y[0] == Complex(1, 1));
+    REQUIRE(y[1] == Complex(0, 2) + Complex(3, -1) * Complex(0, 1));
+    REQUIRE(s.norm() == Approx(std::sqrt(2.0 + 4.0 + 10.0)));
+
+    BasicMatrix<float> dense(3, 3);
+    dense(0, 2) = 2.0F;
+    dense(2, 1) = -1.5F;
+    const BasicSparseMatrix<float> f(dense, SparseLayout::CSC);
+    REQUIRE(f.nnz() == 2);
+    const BasicMatrix<float> product = f * identity<float>(3);
+    REQUIRE(product(0, 2) == 2.0F);
+    REQUIRE(product(2, 1) == -1.5F);
+    REQUIRE(f.transpose()(1, 2) == -1.5F);
+}
@@ -0,0 +1,216 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_approx.hpp>
+#include "matrixops/structured.h"
+#include "test_helpers.h"
+
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <stdexcept>
+
+using namespace matrixops;
+using namespace matrixops::testing;
+using Catch::Approx;
+
+namespace {
+
+const Triangle TRIANGLES[] = {Triangle::LOWER, Triangle::UPPER};
+
+// Dense products and sums round differently from the structured ones.
+template <typename T, typename E>
+bool close(const BasicMatrix<T>& a, const E& expected) {
+    const BasicMatrix<T> b(expected);
+    if (a.rows() != b.rows() || a.cols() != b.cols()) {
+        return false;
+    }
+    double scale = 1.0;
+    double error = 0.0;
+    for (size_t i = 0; i < a.rows(); ++i) {
+        for (size_t j = 0; j < a.cols(); ++j) {
+            const double expected_value = std::abs(b(i, j));
+            const double difference = std::abs(a(i, j) - b(i, j));
+            scale = std::max(scale, expected_value);
+            error = std::max(error, difference);
+        }
+    }
+    return error <= 1e-5 * scale;
+}
+
+Matrix dense_of(const Vector& v) {
+    Matrix m(v.size(), 1);
+    for (size_t i = 0; i < v.size(); ++i) {
+        m(i, 0) = v(i);
+    }
+    return m;
+}
+
+} // namespace
+
+TEST_CASE("Identity and diagonal products scale without a full product",
+          "[structured]") {
+    const Matrix a = make_matrix<double>(70, 70, 1);
+    const Matrix b = make_matrix<double>(70, 45, 2);
+    const IdentityMatrix eye(70);
+    REQUIRE(eye(3, 3) == 1.0);
+    REQUIRE(eye(3, 4) == 0.0);
+    REQUIRE(close(eye.to_dense(), identity(70)));
+    REQUIRE(close(eye * b, b));
+    REQUIRE(close(a * eye, a));
+    REQUIRE(close(eye + a, a + identity(70)));
+    REQUIRE(close(a + eye, a + identity(70)));
+    REQUIRE(eye.norm() == Approx(std::sqrt(70.0)));
+
+    Vector values(70);
+    for (size_t i = 0; i < 70; ++i) {
+        values(i) = static_cast<double>(i) - 20.5;
+    }
+    const DiagonalMatrix d(values);
+    const Matrix dense = d.to_dense();
+    REQUIRE(d(5, 5) == values(5));
+    REQUIRE(d(5, 6) == 0.0);
+    REQUIRE(close(d * b, dense * b));
+    REQUIRE(close(a * d, a * dense));
+    REQUIRE(close(d + a, dense + a));
+    REQUIRE(close(a + d, a + dense));
+    REQUIRE(close((d * d).to_dense(), dense * dense));
+    REQUIRE(close((d + d).to_dense(), dense + dense));
+    REQUIRE(close(dense_of(d * values), dense * dense_of(values)));
+    REQUIRE(close(d.transpose().to_dense(), dense));
+    REQUIRE(d.norm() == Approx(dense.norm()));
+    REQUIRE(close(DiagonalMatrix(eye).to_dense(), identity(70)));
+    REQUIRE(close(DiagonalMatrix(70, 2.5) * b, b * 2.5));
+}
+
+TEST_CASE("Symmetric matrices in packed storage", "[structured]") {
+    // Past one slab of rows, with a ragged last one
+    const size_t n = 300;
+    const Matrix lower = make_matrix<double>(n, n, 3);
+    SymmetricMatrix s(lower);
+    Matrix dense = s.to_dense();
+    REQUIRE(close(dense, dense.transpose()));
+    REQUIRE(dense(7, 2) == lower(7, 2));
+    REQUIRE(dense(2, 7) == lower(7, 2));
+
+    s(4, 9) = 12.0;
+    REQUIRE(s(9, 4) == 12.0);
+    dense = s.to_dense();
+    REQUIRE(dense(4, 9) == 12.0);
+    REQUIRE(dense(9, 4) == 12.0);
+
+    const Matrix b = make_matrix<double>(n, 77, 4);
+    const Matrix c = make_matrix<double>(33, n, 5);
+    REQUIRE(close(s * b, dense * b));
+    REQUIRE(close(c * s, c * dense));
+    REQUIRE(close(s + b * b.transpose(), dense + b * b.transpose()));
+    REQUIRE(close((s + s).to_dense(), dense + dense));
+    REQUIRE(close(s.transpose().to_dense(), dense));
+    REQUIRE(s.norm() == Approx(dense.norm()));
+
+    Vector x(n);
+    for (size_t i = 0; i < n; ++i) {
+        x(i) = std::cos(static_cast<double>(i));
+    }
+    REQUIRE(close(dense_of(s * x), dense * dense_of(x)));
+}
+
+TEST_CASE("Triangular matrices skip their zero half", "[structured]") {
+    const size_t n = 530;
+    const Matrix full = make_matrix<double>(n, n, 6);
+    const Matrix other = make_matrix<double>(n, n, 7);
+    const Matrix b = make_matrix<double>(n, 40, 8);
+    const Matrix c = make_matrix<double>(21, n, 9);
+    Vector x(n);
+    for (size_t i = 0; i < n; ++i) {
+        x(i) = std::sin(static_cast<double>(i));
+    }
+
+    for (Triangle triangle : TRIANGLES) {
+        const TriangularMatrix t(full, triangle);
+        const TriangularMatrix u(other, triangle);
+        const Matrix dense = t.to_dense();
+        const bool lower = triangle == Triangle::LOWER;
+        REQUIRE(t.triangle() == triangle);
+        REQUIRE(dense(10, 3) == (lower ? full(10, 3) : 0.0));
+        REQUIRE(dense(3, 10) == (lower ? 0.0 : full(3, 10)));
+        REQUIRE(t(3, 10) == dense(3, 10));
+        REQUIRE(dense(8, 8) == full(8, 8));
+
+        REQUIRE(close(t * b, dense * b));
+        REQUIRE(close(c * t, c * dense));
+        REQUIRE(close((t * u).to_dense(), dense * u.to_dense()));
+        REQUIRE((t * u).triangle() == triangle);
+        REQUIRE(close(dense_of(t * x), dense * dense_of(x)));
+        REQUIRE(close((t + u).to_dense(), dense + u.to_dense()));
+        REQUIRE(close(t + other, dense + other));
+        REQUIRE(close(other + t, other + dense));
+        REQUIRE(t.norm() == Approx(dense.norm()));
+
+        const TriangularMatrix transposed = t.transpose();
+        REQUIRE(transposed.triangle() != triangle);
+        REQUIRE(close(transposed.to_dense(), dense.transpose()));
+        REQUIRE(close(transposed * b, dense.transpose() * b));
+    }
+
+    const TriangularMatrix l(full, Triangle::LOWER);
+    const TriangularMatrix r(full, Triangle::UPPER);
+    REQUIRE_THROWS_AS(l * r, std::invalid_argument);
+    REQUIRE_THROWS_AS(l + r, std::invalid_argument);
+}
+
+TEST_CASE("Gram matrices match the dense product", "[structured]") {
+    // Tall-skinny samples and a wide matrix over several slabs
+    for (const auto& shape : {std::pair<size_t, size_t>{1000, 13},
+                              std::pair<size_t, size_t>{90, 600}}) {
+        const Matrix a = make_matrix<double>(shape.first, shape.second, 10);
+        const SymmetricMatrix g = gram(a);
+        REQUIRE(g.rows() == shape.second);
+        REQUIRE(close(g.to_dense(), a.transpose() * a));
+    }
+
+    const BasicMatrix<std::complex<double>> z =
+        make_matrix<std::complex<double>>(40, 300, 11) *
+        std::complex<double>(1.0, -2.0);
+    REQUIRE(close(gram(z).to_dense(), z.transpose() * z));
+}
+
+TEST_CASE("Structured dimension errors", "[structured]") {
+    const Matrix square(4, 4, 1.0);
+    const Matrix wrong(5, 3, 1.0);
+    REQUIRE_THROWS_AS(SymmetricMatrix(wrong), std::invalid_argument);
+    REQUIRE_THROWS_AS(TriangularMatrix(wrong, Triangle::LOWER),
+                      std::invalid_argument);
+    REQUIRE_THROWS_AS(IdentityMatrix(0), std::invalid_argument);
+
+    REQUIRE_THROWS_AS(IdentityMatrix(4) * wrong, std::invalid_argument);
+    REQUIRE_THROWS_AS(DiagonalMatrix(4) * wrong, std::invalid_argument);
+    REQUIRE_THROWS_AS(SymmetricMatrix(square) * wrong,
+                      std::invalid_argument);
+    REQUIRE_THROWS_AS(wrong * TriangularMatrix(square, Triangle::UPPER),
+                      std::invalid_argument);
+    REQUIRE_THROWS_AS(DiagonalMatrix(4) + wrong, std::invalid_argument);
+    REQUIRE_THROWS_AS(SymmetricMatrix(4) + SymmetricMatrix(5),
+                      std::invalid_argument);
+    REQUIRE_THROWS_AS(SymmetricMatrix(4)(4, 0), std::out_of_range);
+}
+
+TEST_CASE("Structured matrices of other element types",
+          "[structured][types]") {
+    const size_t n = 270;
+    const BasicMatrix<float> a = make_matrix<float>(n, n, 12);
+    const BasicMatrix<float> b = make_matrix<float>(n, 30, 13);
+    const BasicSymmetricMatrix<float> s(a);
+    const BasicTriangularMatrix<float> t(a, Triangle::UPPER);
+    REQUIRE(close(s * b, s.to_dense() * b));
+    REQUIRE(close(t * b, t.to_dense() * b));
+    REQUIRE(close(gram(b).to_dense(), b.transpose() * b));
+
+    using C = std::complex<float>;
+    const BasicMatrix<C> z = make_matrix<C>(n, n, 14) * C(0.5F, 1.0F);
+    const BasicMatrix<C> w = make_matrix<C>(n, 20, 15);
+    const BasicTriangularMatrix<C> tz(z, Triangle::LOWER);
+    const BasicDiagonalMatrix<C> dz(n, C(0.0F, 1.0F));
+    REQUIRE(close(tz * w, tz.to_dense() * w));
+    REQUIRE(close(dz * w, w * C(0.0F, 1.0F)));
+    REQUIRE(BasicSymmetricMatrix<C>(z).norm() ==
+            Approx(BasicSymmetricMatrix<C>(z).to_dense().norm()));
+}
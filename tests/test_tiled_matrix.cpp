@@ -0,0 +1,137 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_approx.hpp>
+#include "matrixops/parallel.h"
+#include "matrixops/tiled_matrix.h"
+#include "test_helpers.h"
+
+#include <complex>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+using namespace matrixops;
+using namespace matrixops::testing;
+using Catch::Approx;
+
+namespace {
+
+// Sizes that leave partial tiles in both directions: small integers make
+// every sum and product exact, so results are compared bit for bit.
+template <typename T>
+void check_tiled_operations() {
+    const BasicMatrix<T> a = make_matrix<T>(130, 70);
+    const BasicMatrix<T> b = make_matrix<T>(70, 150);
+    const BasicTiledMatrix<T> ta(a);
+    const BasicTiledMatrix<T> tb(b);
+
+    REQUIRE(same_elements(ta.to_matrix(), a));
+    REQUIRE(same_elements(ta.transpose().to_matrix(), a.transpose()));
+    REQUIRE(same_elements((ta + ta).to_matrix(), BasicMatrix<T>(a + a)));
+    REQUIRE(same_elements((ta * tb).to_matrix(), a * b));
+    REQUIRE(ta.norm() == Approx(a.norm()));
+}
+
+} // namespace
+
+TEST_CASE("TiledMatrix stores tiles in Morton order", "[tiled_matrix]") {
+    const Matrix m = make_matrix<double>(200, 100);
+    TiledMatrix t(m);
+    REQUIRE(t.rows() == 200);
+    REQUIRE(t.cols() == 100);
+    REQUIRE(t.tile_rows() == 4);
+    REQUIRE(t.tile_cols() == 2);
+
+    // Tiles (0, 0), (0, 1), (1, 0) and (1, 1) come first, each contiguous.
+    const ConstMatrixView first = std::as_const(t).tile(0, 0);
+    REQUIRE(first.stride() == MATRIX_TILE);
+    REQUIRE(t.tile(0, 1).data() == first.data() + MATRIX_TILE * MATRIX_TILE);
+    REQUIRE(t.tile(1, 0).data() ==
+            first.data() + 2 * MATRIX_TILE * MATRIX_TILE);
+    REQUIRE(t.tile(1, 1).data() ==
+            first.data() + 3 * MATRIX_TILE * MATRIX_TILE);
+
+    // Edge tiles are clipped to the matrix.
+    REQUIRE(t.tile(3, 1).rows() == 200 - 3 * MATRIX_TILE);
+    REQUIRE(t.tile(3, 1).cols() == 100 - MATRIX_TILE);
+    REQUIRE(t.tile(3, 1)(7, 35) == m(3 * MATRIX_TILE + 7, MATRIX_TILE + 35));
+
+    t(150, 80) = 42.0;
+    REQUIRE(t(150, 80) == 42.0);
+    REQUIRE(t.tile(2, 1)(150 - 2 * MATRIX_TILE, 80 - MATRIX_TILE) == 42.0);
+
+    REQUIRE(TiledMatrix(3, 5, 2.0).to_matrix()(2, 4) == 2.0);
+    REQUIRE(TiledMatrix(3, 5).norm() == 0.0);
+
+    REQUIRE_THROWS_AS(t(200, 0), std::out_of_range);
+    REQUIRE_THROWS_AS(t.tile(4, 0), std::out_of_range);
+    REQUIRE_THROWS_AS(TiledMatrix(0, 5), std::invalid_argument);
+    REQUIRE_THROWS_AS(t + TiledMatrix(100, 200), std::invalid_argument);
+    REQUIRE_THROWS_AS(t * t, std::invalid_argument);
+}
+
+TEST_CASE("TiledMatrix converts from and to column-major buffers",
+          "[tiled_matrix][layout]") {
+    const Matrix m = make_matrix<double>(150, 90);
+    std::vector<double> buffer(m.rows() * m.cols());
+    const MatrixView column_major(buffer.data(), m.rows(), m.cols(),
+                                  Layout::COLUMN_MAJOR);
+    column_major.copy_from(m);
+
+    const TiledMatrix t(column_major);
+    REQUIRE(same_elements(t.to_matrix(), m));
+
+    std::vector<double> out(buffer.size());
+    t.copy_to(MatrixView(out.data(), m.rows(), m.cols(),
+                         Layout::COLUMN_MAJOR));
+    REQUIRE(out == buffer);
+    Matrix wrong_shape(90, 150);
+    REQUIRE_THROWS_AS(t.copy_to(wrong_shape), std::invalid_argument);
+}
+
+TEST_CASE("TiledMatrix operations match Matrix for every element type",
+          "[tiled_matrix]") {
+    check_tiled_operations<float>();
+    check_tiled_operations<double>();
+    check_tiled_operations<std::complex<float>>();
+    check_tiled_operations<std::complex<double>>();
+    check_tiled_operations<Half>();
+    check_tiled_operations<BFloat16>();
+}
+
+TEST_CASE("TiledMatrix operations run in parallel",
+          "[tiled_matrix][parallel]") {
+    const Matrix a = make_matrix<double>(300, 260);
+    const Matrix b = make_matrix<double>(260, 280);
+
+    const size_t saved = num_threads();
+    set_num_threads(4);
+    const TiledMatrix ta(a);
+    const TiledMatrix tb(b);
+    const Matrix product = (ta * tb).to_matrix();
+    const Matrix transposed = ta.transpose().to_matrix();
+    TiledMatrix sum = ta;
+    sum += ta;
+    set_num_threads(saved);
+
+    REQUIRE(same_elements(product, a * b));
+    REQUIRE(same_elements(transposed, a.transpose()));
+    REQUIRE(same_elements(sum.to_matrix(), Matrix(a + a)));
+}
+
+TEST_CASE("TiledMatrix products with parallel block products",
+          "[tiled_matrix][parallel]") {
+    // Each block of the result is a gemm() large enough to go parallel
+    // inside the parallel loop over the blocks.
+    const Matrix a = make_matrix<double>(1100, 1100, 1);
+    const Matrix b = make_matrix<double>(1100, 1100, 2);
+    const Matrix expected = a * b;
+
+    const size_t saved = num_threads();
+    set_num_threads(8);
+    const TiledMatrix ta(a);
+    const TiledMatrix tb(b);
+    for (int run = 0; run < 3; ++run) {
+        REQUIRE(same_elements((ta * tb).to_matrix(), expected));
+    }
+    set_num_threads(saved);
+}
@@ -0,0 +1,90 @@
+#include <catch2/catch_test_macros.hpp>
+#include "matrixops/matrix.h"
+#include "matrixops/parallel.h"
+#include "matrixops/simd.h"
+#include "test_helpers.h"
+
+using namespace matrixops;
+using namespace matrixops::testing;
+
+namespace {
+
+const SimdIsa ALL_ISAS[] = {SimdIsa::SCALAR, SimdIsa::SSE2, SimdIsa::AVX2,
+                            SimdIsa::AVX512, SimdIsa::NEON};
+
+bool is_transpose_of(const Matrix& t, const Matrix& m) {
+    if (t.rows() != m.cols() || t.cols() != m.rows()) {
+        return false;
+    }
+    for (size_t i = 0; i < m.rows(); ++i) {
+        for (size_t j = 0; j < m.cols(); ++j) {
+            if (t(j, i) != m(i, j)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+TEST_CASE("Blocked transpose across tile and block edges", "[transpose]") {
+    const SimdIsa saved = simd_isa();
+    // Shapes straddle the 4x4 and 8x8 register tiles and the cache blocks.
+    const size_t shapes[][2] = {{1, 1},   {1, 9},    {3, 5},   {4, 4},
+                                {8, 8},   {7, 17},   {64, 64}, {65, 130},
+                                {129, 3}, {300, 257}};
+    for (SimdIsa isa : ALL_ISAS) {
+        if (!simd_isa_supported(isa)) {
+            continue;
+        }
+        INFO("ISA: " << simd_isa_name(isa));
+        set_simd_isa(isa);
+        for (const auto& shape : shapes) {
+            INFO("Shape: " << shape[0] << "x" << shape[1]);
+            Matrix m = make_index_matrix(shape[0], shape[1], shape[1]);
+            REQUIRE(is_transpose_of(m.transpose(), m));
+        }
+    }
+    set_simd_isa(saved);
+}
+
+TEST_CASE("In-place transpose of square matrices", "[transpose]") {
+    const SimdIsa saved = simd_isa();
+    const size_t sizes[] = {1, 2, 3, 4, 7, 8, 9, 63, 64, 65, 130, 257};
+    for (SimdIsa isa : ALL_ISAS) {
+        if (!simd_isa_supported(isa)) {
+            continue;
+        }
+        INFO("ISA: " << simd_isa_name(isa));
+        set_simd_isa(isa);
+        for (size_t n : sizes) {
+            INFO("Size: " << n);
+            const Matrix original = make_index_matrix(n, n, n);
+            Matrix m = original;
+            const double* storage = m.data();
+            m.transpose_inplace();
+            REQUIRE(m.data() == storage);
+            REQUIRE(is_transpose_of(m, original));
+        }
+    }
+    set_simd_isa(saved);
+}
+
+TEST_CASE("In-place transpose rejects rectangular matrices",
+          "[transpose]") {
+    Matrix m(2, 3);
+    REQUIRE_THROWS_AS(m.transpose_inplace(), std::invalid_argument);
+}
+
+TEST_CASE("Parallel transposes", "[transpose][parallel]") {
+    set_num_threads(4);
+    Matrix m = make_index_matrix(517, 389, 389);
+    REQUIRE(is_transpose_of(m.transpose(), m));
+
+    const Matrix original = make_index_matrix(517, 517, 517);
+    Matrix square = original;
+    square.transpose_inplace();
+    REQUIRE(is_transpose_of(square, original));
+    set_num_threads(0);
+}
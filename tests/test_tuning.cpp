@@ -0,0 +1,136 @@
+#include <catch2/catch_test_macros.hpp>
+#include "matrixops/matrix.h"
+#include "matrixops/tuning.h"
+#include "test_helpers.h"
+
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+
+using namespace matrixops;
+using namespace matrixops::testing;
+
+namespace {
+
+bool same_profile(const TuningProfile& a, const TuningProfile& b) {
+    return a.blocking.mc == b.blocking.mc && a.blocking.kc == b.blocking.kc &&
+           a.blocking.nc == b.blocking.nc &&
+           a.strassen_crossover == b.strassen_crossover &&
+           a.blas_threshold == b.blas_threshold &&
+           a.elementwise_grain == b.elementwise_grain &&
+           a.transpose_block == b.transpose_block;
+}
+
+// Restores the tuning in place before the test.
+class ScopedTuning {
+public:
+    ScopedTuning() : saved_(tuning_profile()) {}
+    ~ScopedTuning() { set_tuning_profile(saved_); }
+
+    ScopedTuning(const ScopedTuning&) = delete;
+    ScopedTuning& operator=(const ScopedTuning&) = delete;
+
+private:
+    TuningProfile saved_;
+};
+
+std::string temporary_profile(const char* name) {
+    return (std::filesystem::temp_directory_path() / "matrixops_tuning" /
+            name)
+        .string();
+}
+
+} // namespace
+
+TEST_CASE("Cache heuristics give usable parameters", "[tuning]") {
+    const CacheTopology topology = cache_topology();
+    REQUIRE(topology.l1d > 0);
+    REQUIRE(topology.l2 >= topology.l1d);
+    REQUIRE(topology.cores >= 1);
+
+    CacheTopology small;
+    small.l1d = size_t{32} << 10;
+    small.l2 = size_t{256} << 10;
+    small.l3 = size_t{8} << 20;
+    const TuningProfile p = heuristic_tuning(small);
+    // B micro-panels in half of L1, A blocks in half of L2 and B panels in
+    // half of L3, for double and an 8-wide tile.
+    REQUIRE(p.blocking.kc == 256);
+    REQUIRE(p.blocking.mc == 64);
+    REQUIRE(p.blocking.nc == 2048);
+    REQUIRE(p.elementwise_grain == size_t{1} << 14);
+    REQUIRE(p.transpose_block == 32);
+    REQUIRE(p.strassen_crossover == tuning_profile().strassen_crossover);
+}
+
+TEST_CASE("Tuning parameters change speed, not results", "[tuning]") {
+    const ScopedTuning scoped;
+    const Matrix a = make_matrix(150, 130, 1);
+    const Matrix b = make_matrix(130, 170, 2);
+    const Matrix square = make_matrix(203, 203, 3);
+    const Matrix product = a * b;
+    const Matrix transposed = square.transpose();
+
+    TuningProfile p = tuning_profile();
+    p.blocking = {16, 24, 32};
+    p.elementwise_grain = 100;
+    p.transpose_block = 12;
+    set_tuning_profile(p);
+    REQUIRE(std::string(tuning_source()) == "user");
+    REQUIRE(tuning_profile().transpose_block == 16);
+    REQUIRE(same_elements(a * b, product));
+    REQUIRE(same_elements(square.transpose(), transposed));
+    Matrix inplace = square;
+    inplace.transpose_inplace();
+    REQUIRE(same_elements(inplace, transposed));
+    REQUIRE(same_elements(square + square, square * 2.0));
+
+    p.elementwise_grain = 0;
+    REQUIRE_THROWS_AS(set_tuning_profile(p), std::invalid_argument);
+}
+
+TEST_CASE("Tuning profiles round-trip through files", "[tuning]") {
+    const std::string path = temporary_profile("roundtrip.profile");
+    TuningProfile p = tuning_profile();
+    p.blocking = {64, 128, 1024};
+    p.elementwise_grain = 8192;
+    p.transpose_block = 64;
+    save_tuning_profile(path, p);
+    REQUIRE(same_profile(load_tuning_profile(path), p));
+
+    // Missing keys keep the current values; unknown ones are skipped.
+    {
+        std::ofstream out(path, std::ios::trunc);
+        out << "# partial\nkc = 192\nfuture_key = 7\n";
+    }
+    const TuningProfile partial = load_tuning_profile(path);
+    REQUIRE(partial.blocking.kc == 192);
+    REQUIRE(partial.blocking.mc == tuning_profile().blocking.mc);
+
+    {
+        std::ofstream out(path, std::ios::trunc);
+        out << "kc = many\n";
+    }
+    REQUIRE_THROWS_AS(load_tuning_profile(path), std::runtime_error);
+    std::filesystem::remove_all(std::filesystem::path(path).parent_path());
+    REQUIRE_THROWS_AS(load_tuning_profile(path), std::runtime_error);
+}
+
+TEST_CASE("Autotuning applies the fastest candidates", "[tuning]") {
+    const ScopedTuning scoped;
+    AutotuneOptions options;
+    options.gemm_size = 96;
+    options.elementwise_size = 256;
+    options.trials = 1;
+    const TuningProfile tuned = autotune(options);
+    REQUIRE(same_profile(tuned, tuning_profile()));
+    REQUIRE(std::string(tuning_source()) == "autotune");
+    REQUIRE(tuned.transpose_block % 8 == 0);
+
+    const Matrix a = make_matrix(100, 90, 1);
+    const Matrix b = make_matrix(90, 80, 2);
+    const Matrix product = a * b;
+    set_tuning_profile(TuningProfile{});
+    REQUIRE(same_elements(a * b, product));
+}
@@ -0,0 +1,246 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_approx.hpp>
+#include "matrixops/vector.h"
+#include "matrixops/parallel.h"
+#include "matrixops/simd.h"
+#include "matrixops/sparse.h"
+#include "test_helpers.h"
+
+#include <cmath>
+#include <complex>
+#include <cstdint>
+#include <initializer_list>
+#include <limits>
+#include <stdexcept>
+
+using namespace matrixops;
+using namespace matrixops::testing;
+using Catch::Approx;
+
+namespace {
+
+const SimdIsa ALL_ISAS[] = {SimdIsa::SCALAR, SimdIsa::SSE2, SimdIsa::AVX2,
+                            SimdIsa::AVX512, SimdIsa::NEON};
+
+template <typename T>
+BasicVector<T> make_vector(size_t n, double offset) {
+    BasicVector<T> v(n);
+    for (size_t i = 0; i < n; ++i) {
+        v(i) = static_cast<T>(static_cast<double>((i * 7) % 11) * 0.25 -
+                              offset);
+    }
+    return v;
+}
+
+} // namespace
+
+TEST_CASE("Vector construction and access", "[vector]") {
+    const Vector zero(4);
+    REQUIRE(zero.size() == 4);
+    REQUIRE(zero(3) == 0.0);
+
+    Vector v{1.0, 2.0, 3.0};
+    REQUIRE(v.size() == 3);
+    REQUIRE(v(1) == 2.0);
+    v(1) = 5.0;
+    REQUIRE(v.unchecked(1) == 5.0);
+    REQUIRE(v.data()[1] == 5.0);
+    REQUIRE(reinterpret_cast<uintptr_t>(v.data()) % STORAGE_ALIGNMENT == 0);
+
+    REQUIRE_THROWS_AS(v(3), std::out_of_range);
+    REQUIRE_THROWS_AS(Vector(0), std::invalid_argument);
+    REQUIRE_THROWS_AS(Vector(std::initializer_list<double>{}),
+                      std::invalid_argument);
+}
+
+TEST_CASE("Vector arithmetic", "[vector]") {
+    const Vector a{1.0, 2.0, 3.0};
+    const Vector b{0.5, -1.0, 4.0};
+
+    const Vector sum = a + b;
+    const Vector difference = a - b;
+    const Vector scaled = a * 2.0;
+    for (size_t i = 0; i < 3; ++i) {
+        REQUIRE(sum(i) == a(i) + b(i));
+        REQUIRE(difference(i) == a(i) - b(i));
+        REQUIRE(scaled(i) == a(i) * 2.0);
+    }
+
+    Vector c = a;
+    c += b;
+    c -= a;
+    c *= 3.0;
+    for (size_t i = 0; i < 3; ++i) {
+        REQUIRE(c(i) == b(i) * 3.0);
+    }
+
+    REQUIRE_THROWS_AS(a + Vector(2), std::invalid_argument);
+    REQUIRE_THROWS_AS(c -= Vector(4), std::invalid_argument);
+}
+
+TEST_CASE("BLAS kernels match the reference on every ISA", "[vector][simd]") {
+    const SimdIsa saved = simd_isa();
+
+    for (SimdIsa isa : ALL_ISAS) {
+        if (!simd_isa_supported(isa)) {
+            continue;
+        }
+        INFO("ISA: " << simd_isa_name(isa));
+        set_simd_isa(isa);
+
+        // Every remainder of the widest vector loops.
+        for (size_t n = 1; n <= 70; ++n) {
+            INFO("n = " << n);
+            const Vector x = make_vector<double>(n, 1.0);
+            const Vector y = make_vector<double>(n, -0.5);
+            const BasicVector<float> xf = make_vector<float>(n, 1.0);
+            const BasicVector<float> yf = make_vector<float>(n, -0.5);
+
+            double expected_dot = 0.0;
+            for (size_t i = 0; i < n; ++i) {
+                expected_dot += x(i) * y(i);
+            }
+            REQUIRE(dot(x, y) == Approx(expected_dot));
+            REQUIRE(dot(xf, yf) == Approx(expected_dot));
+
+            Vector z = y;
+            axpy(0.75, x, z);
+            BasicVector<float> zf = yf;
+            axpy(0.75F, xf, zf);
+            for (size_t i = 0; i < n; ++i) {
+                REQUIRE(z(i) == Approx(y(i) + 0.75 * x(i)));
+                REQUIRE(zf(i) == Approx(yf(i) + 0.75F * xf(i)));
+            }
+        }
+
+        const Matrix a = make_matrix<double>(37, 29);
+        const Vector x = make_vector<double>(29, 1.0);
+        Vector y = make_vector<double>(37, 0.0);
+        const Vector y0 = y;
+        gemv(2.0, a, x, -1.0, y);
+        for (size_t i = 0; i < a.rows(); ++i) {
+            double expected = 0.0;
+            for (size_t j = 0; j < a.cols(); ++j) {
+                expected += a(i, j) * x(j);
+            }
+            REQUIRE(y(i) == Approx(2.0 * expected - y0(i)));
+        }
+
+        Matrix b = a;
+        const Vector u = make_vector<double>(37, 2.0);
+        ger(0.5, u, x, b);
+        for (size_t i = 0; i < b.rows(); ++i) {
+            for (size_t j = 0; j < b.cols(); ++j) {
+                REQUIRE(b(i, j) == Approx(a(i, j) + 0.5 * u(i) * x(j)));
+            }
+        }
+    }
+    set_simd_isa(saved);
+}
+
+TEST_CASE("Matrix-vector products", "[vector]") {
+    const Matrix a = make_matrix<double>(5, 3);
+    const Vector x{1.0, -2.0, 0.5};
+
+    const Vector y = a * x;
+    REQUIRE(y.size() == 5);
+    for (size_t i = 0; i < 5; ++i) {
+        REQUIRE(y(i) == a(i, 0) - 2.0 * a(i, 1) + 0.5 * a(i, 2));
+    }
+
+    // beta = 0 overwrites y without reading it, NaN included.
+    Vector out(5, std::numeric_limits<double>::quiet_NaN());
+    multiply_into(a, x, out);
+    for (size_t i = 0; i < 5; ++i) {
+        REQUIRE(out(i) == y(i));
+    }
+
+    REQUIRE_THROWS_AS(a * Vector(4), std::invalid_argument);
+    Vector wrong(4);
+    REQUIRE_THROWS_AS(multiply_into(a, x, wrong), std::invalid_argument);
+    Matrix square = make_matrix<double>(3, 3);
+    Vector v{1.0, 2.0, 3.0};
+    REQUIRE_THROWS_AS(gemv(1.0, square, v, 0.0, v), std::invalid_argument);
+    Matrix short_matrix = make_matrix<double>(2, 3);
+    REQUIRE_THROWS_AS(ger(1.0, x, x, short_matrix), std::invalid_argument);
+
+    SparseBuilder builder(2, 3);
+    builder.add(0, 2, 4.0);
+    builder.add(1, 0, -1.0);
+    for (SparseLayout layout : {SparseLayout::CSR, SparseLayout::CSC}) {
+        const SparseMatrix s = builder.build(layout);
+        const Vector sy = s * x;
+        REQUIRE(sy(0) == 2.0);
+        REQUIRE(sy(1) == -1.0);
+        REQUIRE_THROWS_AS(multiply_into(s, x, wrong), std::invalid_argument);
+    }
+}
+
+TEST_CASE("nrm2 is safe from overflow and underflow", "[vector]") {
+    const double inf = std::numeric_limits<double>::infinity();
+
+    REQUIRE(nrm2(Vector{3.0, 4.0}) == 5.0);
+    REQUIRE(nrm2(Vector{3e200, 4e200}) == Approx(5e200));
+    REQUIRE(nrm2(Vector{3e-200, -4e-200}) == Approx(5e-200));
+    REQUIRE(nrm2(Vector{1e300, 1.0, 1e-300}) == Approx(1e300));
+    REQUIRE(nrm2(Vector{0.0, 0.0}) == 0.0);
+    REQUIRE(nrm2(Vector{1.0, inf}) == inf);
+    REQUIRE(std::isnan(
+        nrm2(Vector{1e300, std::numeric_limits<double>::quiet_NaN()})));
+    REQUIRE(Vector{3e-320, 4e-320}.norm() == Approx(5e-320).epsilon(1e-3));
+
+    using Complex = std::complex<double>;
+    REQUIRE(nrm2(BasicVector<Complex>{Complex(3e200, 4e200)}) ==
+            Approx(5e200));
+    // float squares never leave the double range.
+    REQUIRE(nrm2(BasicVector<float>{3e30F, 4e30F}) == Approx(5e30F));
+
+    // Matrix::norm shares the implementation.
+    REQUIRE(Matrix(2, 2, 1e200).norm() == Approx(2e200));
+    REQUIRE(Matrix(2, 2, 1e-200).norm() == Approx(2e-200));
+}
+
+TEST_CASE("Complex dot conjugates the first argument", "[vector][types]") {
+    using Complex = std::complex<double>;
+    const BasicVector<Complex> x{Complex(1, 2), Complex(0, 1)};
+    const BasicVector<Complex> y{Complex(3, -1), Complex(2, 2)};
+    REQUIRE(dot(x, y) == std::conj(x(0)) * y(0) + std::conj(x(1)) * y(1));
+    REQUIRE(dot(x, x) == Complex(6, 0));
+
+    const BasicMatrix<Complex> a(2, 2, Complex(0, 1));
+    const BasicVector<Complex> ax = a * x;
+    REQUIRE(ax(0) == Complex(0, 1) * (x(0) + x(1)));
+}
+
+TEST_CASE("Parallel BLAS operations match single-threaded results",
+          "[vector][parallel]") {
+    const size_t saved = num_threads();
+
+    // Large enough to cross the element-wise and gemv thresholds.
+    const Vector x = make_vector<double>(100003, 1.0);
+    const Vector y = make_vector<double>(100003, -0.5);
+    const Matrix a = make_matrix<double>(300, 260);
+    const Vector v = make_vector<double>(260, 0.5);
+
+    set_num_threads(1);
+    const double d = dot(x, y);
+    Vector z = y;
+    axpy(1.5, x, z);
+    const Vector av = a * v;
+    const double norm = nrm2(x);
+
+    set_num_threads(4);
+    Vector p_z = y;
+    axpy(1.5, x, p_z);
+    const Vector p_av = a * v;
+    REQUIRE(dot(x, y) == Approx(d));
+    REQUIRE(nrm2(x) == Approx(norm));
+    for (size_t i = 0; i < x.size(); ++i) {
+        REQUIRE(p_z(i) == z(i));
+    }
+    for (size_t i = 0; i < av.size(); ++i) {
+        REQUIRE(p_av(i) == av(i));
+    }
+
+    set_num_threads(saved);
+}
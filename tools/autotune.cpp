@@ -0,0 +1,58 @@
+// Tunes the kernels for this host and writes the per-host profile that the
+// library loads at startup.
+//
+//     matrixops_autotune [--strassen] [--quick] [profile-path]
+
+#include "matrixops/parallel.h"
+#include "matrixops/tuning.h"
+
+#include <cstring>
+#include <exception>
+#include <iostream>
+#include <string>
+
+using namespace matrixops;
+
+int main(int argc, char** argv) {
+    AutotuneOptions options;
+    std::string path = tuning_profile_path();
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--strassen") == 0) {
+            options.strassen = true;
+        } else if (std::strcmp(argv[i], "--quick") == 0) {
+            options.gemm_size = 512;
+            options.elementwise_size = 1024;
+            options.max_strassen_size = 1024;
+        } else if (argv[i][0] == '-') {
+            std::cerr << "usage: " << argv[0]
+                      << " [--strassen] [--quick] [profile-path]\n";
+            return 2;
+        } else {
+            path = argv[i];
+        }
+    }
+    if (path.empty()) {
+        std::cerr << "No profile path: set MATRIXOPS_TUNING_PROFILE or "
+                     "pass one\n";
+        return 2;
+    }
+
+    const CacheTopology topology = cache_topology();
+    std::cout << "L1d " << (topology.l1d >> 10) << " KiB, L2 "
+              << (topology.l2 >> 10) << " KiB, L3 " << (topology.l3 >> 10)
+              << " KiB, " << num_threads() << " threads\n";
+    try {
+        const TuningProfile p = autotune(options);
+        save_tuning_profile(path, p);
+        std::cout << "mc " << p.blocking.mc << ", kc " << p.blocking.kc
+                  << ", nc " << p.blocking.nc << ", strassen_crossover "
+                  << p.strassen_crossover << ", blas_threshold "
+                  << p.blas_threshold << ", elementwise_grain "
+                  << p.elementwise_grain << ", transpose_block "
+                  << p.transpose_block << "\nWritten to " << path << "\n";
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}